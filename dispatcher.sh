@@ -323,6 +323,12 @@ Generic options:
                                 main configuration file(s).
   --cs-print-trees              Print configurator trees.
   --cs-log-diff                 Log backup diff unconditionally.
+  --cs-binary-backups           Create backups in compact binary format.
+  --cs-compress-backups         Compress binary backups.
+  --cs-op-stats                 Log latency statistics of configurator
+                                operations on shutdown.
+  --cs-conf-cache=<dir>         Directory to cache results of processing
+                                YAML configuration files in.
 
   --builder-debug               Be more verbose when build.
 
@@ -346,6 +352,8 @@ Generic options:
   --profile-build=<logfile>     Gather timings for the build process into <logfile>.
 
   --no-rcf-cc-simple            Do not execute simple RCF consistency checks.
+  --rcf-op-stats                Log latency statistics of RCF requests
+                                on shutdown.
 
   --tester-suite=<name>:<path>  Specify path to the Test Suite.
   --tester-no-run               Don't run any tests.
@@ -863,6 +871,7 @@ process_opts()
                 ;;
 
             --no-rcf-cc-simple) RCF_CONSISTENCY_CHECKS_SIMPLE= ;;
+            --rcf-op-stats) RCF_OPTS="${RCF_OPTS} --op-stats" ;;
 
             *)  echo "Unknown option: $1" >&2;
                 usage
@@ -8,6 +8,7 @@
  */
 
 #include "conf_defs.h"
+#include "conf_backup_bin.h"
 #include "te_alloc.h"
 
 /**
@@ -967,12 +968,13 @@ finish:
  * @param list_size   Number of instances in the list
  * @param subtrees    Vector of the subtrees to restore. May be @c NULL for
  *                    the root subtree
+ * @param sorted      Whether the list is already in topological order
  *
  * @return Status code (see te_errno.h).
  */
 static int
 restore_entries(cfg_instance *list, unsigned int list_size,
-                const te_vec *subtrees)
+                const te_vec *subtrees, bool sorted)
 {
     int           rc;
     bool change_made = false;
@@ -992,7 +994,8 @@ restore_entries(cfg_instance *list, unsigned int list_size,
     if (rc != 0)
         return rc;
 
-    list = topo_sort_instances(list, list_size);
+    if (!sorted)
+        list = topo_sort_instances(list, list_size);
 
     while (deps_might_fire)
     {
@@ -1087,7 +1090,7 @@ cfg_backup_process_file(xmlNodePtr node, bool restore,
         }
     }
 
-    return restore_entries(list, list_size, subtrees);
+    return restore_entries(list, list_size, subtrees, false);
 }
 
 /**
@@ -1154,7 +1157,7 @@ cfg_backup_restore_ta(char *ta)
         prev = tmp;
     }
 
-    return restore_entries(list, list_size, NULL);
+    return restore_entries(list, list_size, NULL, false);
 }
 
 /**
@@ -1354,6 +1357,426 @@ cfg_backup_create_filter_file(const char *filename, const te_vec *subtrees)
     return 0;
 }
 
+/**
+ * Put description of the object and its (grand-...)children to
+ * the binary backup.
+ *
+ * @param w      binary backup builder
+ * @param obj    object
+ */
+static void
+put_bin_object(cfg_bkp_writer *w, cfg_object *obj)
+{
+    if (obj != &cfg_obj_root && !cfg_object_agent(obj))
+    {
+        cfg_bkp_dep    *deps = NULL;
+        cfg_dependency *dep;
+        unsigned int    n_deps = 0;
+
+        for (dep = obj->depends_on; dep != NULL; dep = dep->next)
+            n_deps++;
+
+        if (n_deps > 0)
+        {
+            deps = TE_ALLOC(n_deps * sizeof(*deps));
+            for (n_deps = 0, dep = obj->depends_on; dep != NULL;
+                 dep = dep->next, n_deps++)
+            {
+                deps[n_deps].oid = dep->depends->oid;
+                deps[n_deps].object_wide = dep->object_wide;
+            }
+        }
+
+        cfg_bkp_writer_add_obj(w, obj->oid,
+                               te_enum_map_from_value(cfg_cva_mapping,
+                                                      obj->access),
+                               te_enum_map_from_value(cfg_cvt_mapping,
+                                                      obj->type),
+                               obj->def_val, obj->unit, deps, n_deps);
+        free(deps);
+    }
+    for (obj = obj->son; obj != NULL; obj = obj->brother)
+        put_bin_object(w, obj);
+}
+
+/**
+ * Collect instances to be put to a backup in order of the tree traversal.
+ *
+ * @param inst          object instance
+ * @param subtrees      subtrees to collect instances of
+ * @param insts         vector to append instances to
+ */
+static void
+collect_bin_instances(cfg_instance *inst, const te_vec *subtrees,
+                      te_vec *insts)
+{
+    if (inst != &cfg_inst_root && !cfg_inst_agent(inst) &&
+        !cfg_instance_volatile(inst) &&
+        check_oid_contains_subtrees(subtrees, inst->oid))
+        TE_VEC_APPEND(insts, inst);
+
+    for (inst = inst->son; inst != NULL; inst = inst->brother)
+        collect_bin_instances(inst, subtrees, insts);
+}
+
+/**
+ * Put an instance to the binary backup.
+ *
+ * @param w      binary backup builder
+ * @param inst   object instance
+ *
+ * @return Status code.
+ */
+static te_errno
+put_bin_instance(cfg_bkp_writer *w, cfg_instance *inst)
+{
+    const char   *names[CFG_OID_LEN_MAX];
+    unsigned int  depth = 0;
+    unsigned int  i;
+    cfg_instance *tmp;
+    char         *val_str = NULL;
+    te_errno      rc;
+
+    for (tmp = inst; tmp != &cfg_inst_root; tmp = tmp->father)
+        depth++;
+    if (depth > CFG_OID_LEN_MAX)
+        return TE_EINVAL;
+    for (i = depth, tmp = inst; tmp != &cfg_inst_root; tmp = tmp->father)
+        names[--i] = tmp->name;
+
+    if (inst->obj->type != CVT_NONE)
+    {
+        rc = cfg_types[inst->obj->type].val2str(inst->val, &val_str);
+        if (rc != 0)
+        {
+            ERROR("Conversion failed for instance %s type %d",
+                  inst->oid, inst->obj->type);
+            return rc;
+        }
+    }
+
+    rc = cfg_bkp_writer_add_inst(w, inst->obj->oid, names, depth, val_str);
+    free(val_str);
+
+    return rc;
+}
+
+/**
+ * Build a binary backup of the database. Instances are put in
+ * topological order of their objects, so that they can be restored
+ * without sorting.
+ *
+ * @param w             binary backup builder
+ * @param subtrees      subtrees to put instances of, @c NULL for all
+ *
+ * @return Status code.
+ */
+static te_errno
+cfg_backup_bin_build(cfg_bkp_writer *w, const te_vec *subtrees)
+{
+    te_vec         insts = TE_VEC_INIT(cfg_instance *);
+    cfg_instance **sorted = NULL;
+    unsigned int  *counts = NULL;
+    unsigned int   max_ordinal = 0;
+    cfg_instance **inst;
+    char * const  *subtree;
+    size_t         i;
+    te_errno       rc = 0;
+
+    if (subtrees != NULL)
+    {
+        TE_VEC_FOREACH(subtrees, subtree)
+        {
+            if (cfg_get_ins_by_ins_id_str(*subtree) == NULL)
+            {
+                ERROR("Failed to find instance with OID %s", *subtree);
+                return TE_ENOENT;
+            }
+        }
+    }
+
+    put_bin_object(w, &cfg_obj_root);
+    collect_bin_instances(&cfg_inst_root, subtrees, &insts);
+
+    /* Counting sort by ordinal numbers keeps the traversal order */
+    TE_VEC_FOREACH(&insts, inst)
+        max_ordinal = MAX(max_ordinal, (*inst)->obj->ordinal_number);
+
+    counts = TE_ALLOC((max_ordinal + 2) * sizeof(*counts));
+    TE_VEC_FOREACH(&insts, inst)
+        counts[(*inst)->obj->ordinal_number + 1]++;
+    for (i = 1; i <= max_ordinal + 1; i++)
+        counts[i] += counts[i - 1];
+
+    sorted = TE_ALLOC(MAX(te_vec_size(&insts), 1) * sizeof(*sorted));
+    TE_VEC_FOREACH(&insts, inst)
+        sorted[counts[(*inst)->obj->ordinal_number]++] = *inst;
+
+    for (i = 0; i < te_vec_size(&insts) && rc == 0; i++)
+        rc = put_bin_instance(w, sorted[i]);
+
+    free(sorted);
+    free(counts);
+    te_vec_free(&insts);
+    return rc;
+}
+
+/* See the description in conf_backup.h */
+te_errno
+cfg_backup_create_bin_file(const char *filename, const te_vec *subtrees,
+                           bool compress)
+{
+    cfg_bkp_writer w = CFG_BKP_WRITER_INIT;
+    te_errno       rc;
+
+    rc = cfg_backup_bin_build(&w, subtrees);
+    if (rc == 0)
+        rc = cfg_bkp_writer_save(&w, filename, compress);
+
+    cfg_bkp_writer_free(&w);
+    return rc;
+}
+
+/* See the description in conf_backup.h */
+te_errno
+cfg_backup_process_bin_file(const char *filename, const te_vec *subtrees)
+{
+    cfg_bkp_image   img = CFG_BKP_IMAGE_INIT;
+    cfg_object    **objs;
+    cfg_bkp_inst   *bkp;
+    cfg_instance   *list = NULL;
+    cfg_instance   *prev = NULL;
+    unsigned int    list_size = 0;
+    bool            sorted = true;
+    te_errno        rc;
+
+    RING("Processing binary backup file %s", filename);
+
+    rc = cfg_bkp_image_load(filename, &img);
+    if (rc != 0)
+        return rc;
+
+    objs = TE_ALLOC(MAX(te_vec_size(&img.objs), 1) * sizeof(*objs));
+
+    TE_VEC_FOREACH(&img.insts, bkp)
+    {
+        const char   *oid = cfg_bkp_inst_oid(&img, bkp);
+        cfg_instance *tmp;
+
+        if (!check_oid_contains_subtrees(subtrees, oid))
+            continue;
+
+        /* Objects are looked up once for all their instances */
+        if (objs[bkp->obj] == NULL &&
+            (objs[bkp->obj] = cfg_get_object(oid)) == NULL)
+        {
+            ERROR("Cannot find the object for instance %s", oid);
+            rc = TE_EINVAL;
+            break;
+        }
+
+        tmp = TE_ALLOC(sizeof(*tmp));
+        tmp->obj = objs[bkp->obj];
+        tmp->oid = TE_STRDUP(oid);
+        if (prev != NULL)
+            prev->bkp_next = tmp;
+        else
+            list = tmp;
+
+        if (prev != NULL &&
+            prev->obj->ordinal_number > tmp->obj->ordinal_number)
+            sorted = false;
+        prev = tmp;
+        list_size++;
+
+        if (cfg_db_find(oid, &tmp->handle) != 0)
+            tmp->handle = CFG_HANDLE_INVALID;
+
+        if (tmp->obj->type != CVT_NONE)
+        {
+            if (bkp->val == NULL)
+            {
+                ERROR("Value is necessary for %s", oid);
+                rc = TE_ENOENT;
+                break;
+            }
+            rc = cfg_types[tmp->obj->type].str2val((char *)bkp->val,
+                                                   &tmp->val);
+            if (rc != 0)
+            {
+                ERROR("Value conversion error for %s", oid);
+                break;
+            }
+        }
+        else if (bkp->val != NULL)
+        {
+            ERROR("Value is prohibited for %s", oid);
+            rc = TE_EINVAL;
+            break;
+        }
+    }
+
+    free(objs);
+    cfg_bkp_image_free(&img);
+
+    if (rc != 0)
+    {
+        free_instances(list);
+        return rc;
+    }
+
+    if (!sorted)
+        WARN("Instances of binary backup %s are not in topological order",
+             filename);
+
+    return restore_entries(list, list_size, subtrees, sorted);
+}
+
+/* Compare optional strings */
+static bool
+bin_str_equal(const char *s1, const char *s2)
+{
+    return s1 == s2 || (s1 != NULL && s2 != NULL && strcmp(s1, s2) == 0);
+}
+
+/**
+ * Compare a binary backup with a binary snapshot of the database.
+ *
+ * @param bkp           backup image
+ * @param cur           database snapshot image
+ * @param subtrees      subtrees to compare instances of
+ *
+ * @return @c true if there are no differences.
+ */
+static bool
+bin_images_equal(const cfg_bkp_image *bkp, const cfg_bkp_image *cur,
+                 const te_vec *subtrees)
+{
+    const cfg_bkp_inst *inst;
+    size_t              i;
+    size_t              j = 0;
+
+    if (te_vec_size(&bkp->objs) != te_vec_size(&cur->objs))
+        return false;
+
+    for (i = 0; i < te_vec_size(&bkp->objs); i++)
+    {
+        const cfg_bkp_obj *o1 = &TE_VEC_GET(cfg_bkp_obj, &bkp->objs, i);
+        const cfg_bkp_obj *o2 = &TE_VEC_GET(cfg_bkp_obj, &cur->objs, i);
+        unsigned int       k;
+
+        if (strcmp(o1->oid, o2->oid) != 0 ||
+            !bin_str_equal(o1->access, o2->access) ||
+            !bin_str_equal(o1->type, o2->type) ||
+            !bin_str_equal(o1->def_val, o2->def_val) ||
+            o1->unit != o2->unit || o1->n_deps != o2->n_deps)
+            return false;
+
+        for (k = 0; k < o1->n_deps; k++)
+        {
+            const cfg_bkp_dep *d1 = &TE_VEC_GET(cfg_bkp_dep, &bkp->deps,
+                                                o1->first_dep + k);
+            const cfg_bkp_dep *d2 = &TE_VEC_GET(cfg_bkp_dep, &cur->deps,
+                                                o2->first_dep + k);
+
+            if (strcmp(d1->oid, d2->oid) != 0 ||
+                d1->object_wide != d2->object_wide)
+                return false;
+        }
+    }
+
+    TE_VEC_FOREACH(&bkp->insts, inst)
+    {
+        const char         *oid = cfg_bkp_inst_oid(bkp, inst);
+        const cfg_bkp_inst *other;
+
+        if (!check_oid_contains_subtrees(subtrees, oid))
+            continue;
+        if (j == te_vec_size(&cur->insts))
+            return false;
+
+        other = &TE_VEC_GET(cfg_bkp_inst, &cur->insts, j++);
+        if (strcmp(oid, cfg_bkp_inst_oid(cur, other)) != 0 ||
+            !bin_str_equal(inst->val, other->val))
+            return false;
+    }
+
+    return j == te_vec_size(&cur->insts);
+}
+
+/**
+ * Write differences between a binary backup and a snapshot of
+ * the database in the form of XML backups diff.
+ *
+ * @param bkp           backup image
+ * @param cur           database snapshot image
+ * @param subtrees      subtrees to compare instances of
+ * @param diff_file     name of the file to write diff to
+ */
+static void
+bin_images_diff(const cfg_bkp_image *bkp, const cfg_bkp_image *cur,
+                const te_vec *subtrees, const char *diff_file)
+{
+    te_string bkp_xml = TE_STRING_INIT;
+    te_string cur_xml = TE_STRING_INIT;
+    te_string cmd = TE_STRING_INIT;
+
+    te_string_append(&bkp_xml, "%s.backup.xml", diff_file);
+    te_string_append(&cur_xml, "%s.current.xml", diff_file);
+
+    if (cfg_bkp_image_save_xml(bkp, bkp_xml.ptr, subtrees) == 0 &&
+        cfg_bkp_image_save_xml(cur, cur_xml.ptr, NULL) == 0)
+    {
+        te_string_append(&cmd, "diff -u %s %s >%s 2>&1",
+                         bkp_xml.ptr, cur_xml.ptr, diff_file);
+        if (system(cmd.ptr) < 0)
+            ERROR("Failed to get backup diff");
+    }
+
+    unlink(bkp_xml.ptr);
+    unlink(cur_xml.ptr);
+    te_string_free(&bkp_xml);
+    te_string_free(&cur_xml);
+    te_string_free(&cmd);
+}
+
+/* See the description in conf_backup.h */
+te_errno
+cfg_backup_verify_bin_file(const char *filename, const te_vec *subtrees,
+                           const char *diff_file)
+{
+    cfg_bkp_writer w = CFG_BKP_WRITER_INIT;
+    cfg_bkp_image  bkp = CFG_BKP_IMAGE_INIT;
+    cfg_bkp_image  cur = CFG_BKP_IMAGE_INIT;
+    te_dbuf        payload = TE_DBUF_INIT(0);
+    te_errno       rc;
+
+    rc = cfg_bkp_image_load(filename, &bkp);
+    if (rc != 0)
+        return rc;
+
+    rc = cfg_backup_bin_build(&w, subtrees);
+    if (rc != 0)
+        goto out;
+
+    cfg_bkp_writer_payload(&w, &payload);
+    rc = cfg_bkp_image_parse(payload.ptr, payload.len, &cur);
+    if (rc != 0)
+        goto out;
+
+    if (!bin_images_equal(&bkp, &cur, subtrees))
+    {
+        bin_images_diff(&bkp, &cur, subtrees, diff_file);
+        rc = TE_EBACKUP;
+    }
+
+out:
+    cfg_bkp_writer_free(&w);
+    cfg_bkp_image_free(&bkp);
+    cfg_bkp_image_free(&cur);
+    return rc;
+}
+
 static te_errno
 cfg_backup_wrapper(const char *filename, const te_vec *subtrees, uint8_t op)
 {
@@ -52,6 +52,48 @@ extern int cfg_backup_restore_ta(char *ta);
 extern int cfg_backup_create_file(const char *filename,
                                   const te_vec *subtrees);
 
+/**
+ * Create binary backup file with specified name.
+ *
+ * @param filename   name of the file to be created
+ * @param subtrees   Vector of the subtrees to create a backup file.
+ *                   @c NULL to create backup for all the subtrees
+ * @param compress   compress the backup if zlib is available
+ *
+ * @return Status code
+ */
+extern te_errno cfg_backup_create_bin_file(const char *filename,
+                                           const te_vec *subtrees,
+                                           bool compress);
+
+/**
+ * Restore configuration from binary backup file.
+ *
+ * @param filename   name of the backup file
+ * @param subtrees   Vector of the subtrees to restore. May be @c NULL for
+ *                   the root.
+ *
+ * @return Status code
+ */
+extern te_errno cfg_backup_process_bin_file(const char *filename,
+                                            const te_vec *subtrees);
+
+/**
+ * Check if the current DB differs from binary backup.
+ *
+ * @param filename   name of the backup file
+ * @param subtrees   Vector of the subtrees to verify. May be @c NULL for
+ *                   the root.
+ * @param diff_file  name of the file to write differences in the form of
+ *                   XML backups diff to
+ *
+ * @return Status code
+ * @retval TE_EBACKUP   DB state differs from the backup
+ */
+extern te_errno cfg_backup_verify_bin_file(const char *filename,
+                                           const te_vec *subtrees,
+                                           const char *diff_file);
+
 /**
  * Create file XML file with subtrees to filter backup file
  *
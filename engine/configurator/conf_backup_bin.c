@@ -0,0 +1,938 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/** @file
+ * @brief Configurator
+ *
+ * Compact binary format of backup files
+ *
+ * Copyright (C) 2004-2023 OKTET Labs Ltd. All rights reserved.
+ */
+
+#include "te_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <libxml/xmlmemory.h>
+#include <libxml/parser.h>
+#include <libxml/entities.h>
+
+#if WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#include "te_errno.h"
+#include "te_defs.h"
+#include "te_alloc.h"
+#include "logger_api.h"
+#include "conf_oid.h"
+#include "conf_backup_bin.h"
+
+/** Length of the magic including the version byte */
+#define CFG_BKP_BIN_MAGIC_LEN   (sizeof(CFG_BKP_BIN_MAGIC) - 1 + 1)
+
+/** Initial size of the strings hash table */
+#define CFG_BKP_HASH_INIT_SIZE  1024
+
+/** Position in a binary backup payload being decoded */
+typedef struct cfg_bkp_reader {
+    const uint8_t *p;       /**< Current position */
+    const uint8_t *end;     /**< End of the payload */
+} cfg_bkp_reader;
+
+/* Append an unsigned LEB128 number to the buffer */
+static void
+cfg_bkp_put_uint(te_dbuf *buf, uint64_t val)
+{
+    uint8_t      bytes[10];
+    unsigned int n = 0;
+
+    do {
+        bytes[n] = val & 0x7f;
+        val >>= 7;
+        if (val != 0)
+            bytes[n] |= 0x80;
+        n++;
+    } while (val != 0);
+
+    te_dbuf_append(buf, bytes, n);
+}
+
+/* Read an unsigned LEB128 number */
+static te_errno
+cfg_bkp_get_uint(cfg_bkp_reader *r, uint64_t *val)
+{
+    unsigned int shift = 0;
+
+    *val = 0;
+    while (r->p < r->end && shift < 64)
+    {
+        uint8_t byte = *r->p++;
+
+        *val |= (uint64_t)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+            return 0;
+        shift += 7;
+    }
+
+    return TE_EBADMSG;
+}
+
+/* Read an index which should be less than @p limit */
+static te_errno
+cfg_bkp_get_index(cfg_bkp_reader *r, size_t limit, unsigned int *index)
+{
+    uint64_t val;
+    te_errno rc;
+
+    rc = cfg_bkp_get_uint(r, &val);
+    if (rc != 0)
+        return rc;
+    if (val >= limit)
+        return TE_EBADMSG;
+
+    *index = val;
+    return 0;
+}
+
+/* Read an optional string stored as string index plus one */
+static te_errno
+cfg_bkp_get_opt_str(cfg_bkp_reader *r, const cfg_bkp_image *img,
+                    const char **str)
+{
+    unsigned int index;
+    te_errno     rc;
+
+    rc = cfg_bkp_get_index(r, te_vec_size(&img->strs) + 1, &index);
+    if (rc != 0)
+        return rc;
+
+    *str = index == 0 ? NULL :
+           TE_VEC_GET(const char *, &img->strs, index - 1);
+    return 0;
+}
+
+/* FNV-1a hash of a string */
+static uint32_t
+cfg_bkp_hash(const char *str)
+{
+    uint32_t hash = 2166136261u;
+
+    for (; *str != '\0'; str++)
+    {
+        hash ^= (uint8_t)*str;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/* Get interned string by index */
+static const char *
+cfg_bkp_writer_str(const cfg_bkp_writer *w, unsigned int index)
+{
+    return (const char *)w->strs.ptr +
+           TE_VEC_GET(size_t, &w->offs, index);
+}
+
+/* Find the hash table slot of the string or an empty one to put it */
+static uint32_t *
+cfg_bkp_writer_slot(const cfg_bkp_writer *w, const char *str)
+{
+    size_t mask = w->hash_size - 1;
+    size_t i = cfg_bkp_hash(str) & mask;
+
+    while (w->hash[i] != 0 &&
+           strcmp(cfg_bkp_writer_str(w, w->hash[i] - 1), str) != 0)
+        i = (i + 1) & mask;
+
+    return &w->hash[i];
+}
+
+/* Grow the hash table to keep its load factor below one half */
+static void
+cfg_bkp_writer_rehash(cfg_bkp_writer *w)
+{
+    size_t       n_strs = te_vec_size(&w->offs);
+    unsigned int i;
+
+    if ((n_strs + 1) * 2 <= w->hash_size)
+        return;
+
+    free(w->hash);
+    w->hash_size = MAX(w->hash_size * 2, CFG_BKP_HASH_INIT_SIZE);
+    w->hash = TE_ALLOC(w->hash_size * sizeof(*w->hash));
+
+    for (i = 0; i < n_strs; i++)
+        *cfg_bkp_writer_slot(w, cfg_bkp_writer_str(w, i)) = i + 1;
+}
+
+/* Get index of the string adding it to the string table if necessary */
+static unsigned int
+cfg_bkp_writer_intern(cfg_bkp_writer *w, const char *str)
+{
+    uint32_t *slot;
+    size_t    off = w->strs.len;
+
+    cfg_bkp_writer_rehash(w);
+    slot = cfg_bkp_writer_slot(w, str);
+    if (*slot == 0)
+    {
+        te_dbuf_append(&w->strs, str, strlen(str) + 1);
+        TE_VEC_APPEND(&w->offs, off);
+        *slot = te_vec_size(&w->offs);
+    }
+
+    return *slot - 1;
+}
+
+/* Put an optional string as string index plus one */
+static void
+cfg_bkp_writer_put_opt_str(cfg_bkp_writer *w, te_dbuf *buf,
+                           const char *str)
+{
+    cfg_bkp_put_uint(buf, str == NULL ? 0 :
+                          cfg_bkp_writer_intern(w, str) + 1);
+}
+
+/* Get number of subids in an object OID */
+static unsigned int
+cfg_bkp_oid_depth(const char *oid)
+{
+    unsigned int depth = 0;
+
+    if (strcmp(oid, "/") == 0)
+        return 0;
+
+    for (; *oid != '\0'; oid++)
+    {
+        if (*oid == '/')
+            depth++;
+    }
+
+    return depth;
+}
+
+/* See the description in conf_backup_bin.h */
+void
+cfg_bkp_writer_add_obj(cfg_bkp_writer *w, const char *oid,
+                       const char *access, const char *type,
+                       const char *def_val, bool unit,
+                       const cfg_bkp_dep *deps, unsigned int n_deps)
+{
+    unsigned int id = cfg_bkp_writer_intern(w, oid);
+    unsigned int zero = 0;
+    unsigned int i;
+
+    cfg_bkp_put_uint(&w->objs, id);
+    cfg_bkp_writer_put_opt_str(w, &w->objs, access);
+    cfg_bkp_writer_put_opt_str(w, &w->objs, type);
+    cfg_bkp_writer_put_opt_str(w, &w->objs, def_val);
+    cfg_bkp_put_uint(&w->objs, unit);
+    cfg_bkp_put_uint(&w->objs, n_deps);
+    for (i = 0; i < n_deps; i++)
+    {
+        cfg_bkp_put_uint(&w->objs, cfg_bkp_writer_intern(w, deps[i].oid));
+        cfg_bkp_put_uint(&w->objs, deps[i].object_wide);
+    }
+
+    while (te_vec_size(&w->str2obj) < te_vec_size(&w->offs))
+        TE_VEC_APPEND(&w->str2obj, zero);
+    TE_VEC_GET(unsigned int, &w->str2obj, id) = ++w->n_objs;
+}
+
+/* See the description in conf_backup_bin.h */
+te_errno
+cfg_bkp_writer_add_inst(cfg_bkp_writer *w, const char *obj_oid,
+                        const char * const *names, unsigned int depth,
+                        const char *val)
+{
+    uint32_t     *slot;
+    unsigned int  obj = 0;
+    unsigned int  i;
+
+    if (w->hash_size != 0)
+    {
+        slot = cfg_bkp_writer_slot(w, obj_oid);
+        if (*slot != 0 && *slot - 1 < te_vec_size(&w->str2obj))
+            obj = TE_VEC_GET(unsigned int, &w->str2obj, *slot - 1);
+    }
+    if (obj == 0)
+    {
+        ERROR("Object %s is not described in the backup", obj_oid);
+        return TE_ENOENT;
+    }
+    if (depth == 0 || depth != cfg_bkp_oid_depth(obj_oid))
+        return TE_EINVAL;
+
+    cfg_bkp_put_uint(&w->insts, obj - 1);
+    for (i = 0; i < depth; i++)
+        cfg_bkp_put_uint(&w->insts, cfg_bkp_writer_intern(w, names[i]));
+    cfg_bkp_writer_put_opt_str(w, &w->insts, val);
+    w->n_insts++;
+
+    return 0;
+}
+
+/* See the description in conf_backup_bin.h */
+void
+cfg_bkp_writer_payload(const cfg_bkp_writer *w, te_dbuf *payload)
+{
+    cfg_bkp_put_uint(payload, te_vec_size(&w->offs));
+    te_dbuf_append(payload, w->strs.ptr, w->strs.len);
+    cfg_bkp_put_uint(payload, w->n_objs);
+    te_dbuf_append(payload, w->objs.ptr, w->objs.len);
+    cfg_bkp_put_uint(payload, w->n_insts);
+    te_dbuf_append(payload, w->insts.ptr, w->insts.len);
+}
+
+/* See the description in conf_backup_bin.h */
+te_errno
+cfg_bkp_writer_save(const cfg_bkp_writer *w, const char *filename,
+                    bool compress)
+{
+    te_dbuf  payload = TE_DBUF_INIT(TE_DBUF_DEFAULT_GROW_FACTOR);
+    te_dbuf  file = TE_DBUF_INIT(0);
+    uint8_t  version = CFG_BKP_BIN_VERSION;
+    uint8_t  flags = 0;
+    FILE    *f;
+    te_errno rc = 0;
+
+    cfg_bkp_writer_payload(w, &payload);
+
+#if !WITH_ZLIB
+    compress = false;
+#endif
+    if (compress)
+        flags |= CFG_BKP_BIN_F_ZLIB;
+
+    te_dbuf_append(&file, CFG_BKP_BIN_MAGIC, sizeof(CFG_BKP_BIN_MAGIC) - 1);
+    te_dbuf_append(&file, &version, sizeof(version));
+    te_dbuf_append(&file, &flags, sizeof(flags));
+    cfg_bkp_put_uint(&file, payload.len);
+
+#if WITH_ZLIB
+    if (compress)
+    {
+        size_t hdr_len = file.len;
+        uLongf zlen = compressBound(payload.len);
+
+        te_dbuf_append(&file, NULL, zlen);
+        if (compress2(file.ptr + hdr_len, &zlen, payload.ptr, payload.len,
+                      Z_DEFAULT_COMPRESSION) != Z_OK)
+        {
+            ERROR("Failed to compress backup %s", filename);
+            rc = TE_EFAULT;
+            goto out;
+        }
+        file.len = hdr_len + zlen;
+    }
+    else
+#endif
+    {
+        te_dbuf_append(&file, payload.ptr, payload.len);
+    }
+
+    f = fopen(filename, "w");
+    if (f == NULL)
+    {
+        rc = TE_OS_RC(TE_CS, errno);
+        goto out;
+    }
+    if (fwrite(file.ptr, file.len, 1, f) != 1)
+        rc = TE_OS_RC(TE_CS, errno);
+    if (fclose(f) != 0 && rc == 0)
+        rc = TE_OS_RC(TE_CS, errno);
+    if (rc != 0)
+        unlink(filename);
+
+out:
+    te_dbuf_free(&payload);
+    te_dbuf_free(&file);
+    return rc;
+}
+
+/* See the description in conf_backup_bin.h */
+void
+cfg_bkp_writer_free(cfg_bkp_writer *w)
+{
+    te_dbuf_free(&w->strs);
+    te_vec_free(&w->offs);
+    te_vec_free(&w->str2obj);
+    free(w->hash);
+    w->hash = NULL;
+    w->hash_size = 0;
+    te_dbuf_free(&w->objs);
+    te_dbuf_free(&w->insts);
+    w->n_objs = 0;
+    w->n_insts = 0;
+}
+
+/* See the description in conf_backup_bin.h */
+bool
+cfg_bkp_is_bin_file(const char *filename)
+{
+    char  magic[sizeof(CFG_BKP_BIN_MAGIC) - 1];
+    FILE *f = fopen(filename, "r");
+    bool  result;
+
+    if (f == NULL)
+        return false;
+
+    result = fread(magic, sizeof(magic), 1, f) == 1 &&
+             memcmp(magic, CFG_BKP_BIN_MAGIC, sizeof(magic)) == 0;
+    fclose(f);
+
+    return result;
+}
+
+/* Decode object descriptions */
+static te_errno
+cfg_bkp_image_parse_objs(cfg_bkp_reader *r, cfg_bkp_image *img)
+{
+    size_t       n_strs = te_vec_size(&img->strs);
+    uint64_t     n_objs;
+    uint64_t     i;
+    uint64_t     j;
+    uint64_t     val;
+    unsigned int index;
+    te_errno     rc;
+
+#define GET(_expr) \
+    do {                            \
+        rc = (_expr);               \
+        if (rc != 0)                \
+            return rc;              \
+    } while (0)
+
+    GET(cfg_bkp_get_uint(r, &n_objs));
+    for (i = 0; i < n_objs; i++)
+    {
+        cfg_bkp_obj obj;
+
+        GET(cfg_bkp_get_index(r, n_strs, &index));
+        obj.oid = TE_VEC_GET(const char *, &img->strs, index);
+        GET(cfg_bkp_get_opt_str(r, img, &obj.access));
+        GET(cfg_bkp_get_opt_str(r, img, &obj.type));
+        GET(cfg_bkp_get_opt_str(r, img, &obj.def_val));
+        GET(cfg_bkp_get_uint(r, &val));
+        obj.unit = val != 0;
+        obj.depth = cfg_bkp_oid_depth(obj.oid);
+        if (obj.depth > CFG_OID_LEN_MAX)
+            return TE_EBADMSG;
+        GET(cfg_bkp_get_uint(r, &val));
+        obj.first_dep = te_vec_size(&img->deps);
+        obj.n_deps = val;
+
+        for (j = 0; j < val; j++)
+        {
+            cfg_bkp_dep dep;
+            uint64_t    wide;
+
+            GET(cfg_bkp_get_index(r, n_strs, &index));
+            dep.oid = TE_VEC_GET(const char *, &img->strs, index);
+            GET(cfg_bkp_get_uint(r, &wide));
+            dep.object_wide = wide != 0;
+            TE_VEC_APPEND(&img->deps, dep);
+        }
+
+        TE_VEC_APPEND(&img->objs, obj);
+    }
+#undef GET
+
+    return 0;
+}
+
+/* Decode instances reconstructing their OIDs */
+static te_errno
+cfg_bkp_image_parse_insts(cfg_bkp_reader *r, cfg_bkp_image *img)
+{
+    size_t       n_strs = te_vec_size(&img->strs);
+    uint64_t     n_insts;
+    uint64_t     i;
+    unsigned int k;
+    unsigned int index;
+    te_errno     rc;
+
+    rc = cfg_bkp_get_uint(r, &n_insts);
+    if (rc != 0)
+        return rc;
+
+    for (i = 0; i < n_insts; i++)
+    {
+        const cfg_bkp_obj *obj;
+        const char        *subid;
+        cfg_bkp_inst       inst;
+
+        rc = cfg_bkp_get_index(r, te_vec_size(&img->objs), &inst.obj);
+        if (rc != 0)
+            return rc;
+
+        obj = &TE_VEC_GET(cfg_bkp_obj, &img->objs, inst.obj);
+        if (obj->depth == 0)
+            return TE_EBADMSG;
+
+        inst.oid = img->oids.len;
+        subid = obj->oid;
+        for (k = 0; k < obj->depth; k++)
+        {
+            const char *next = strchr(subid + 1, '/');
+            size_t      len = next == NULL ? strlen(subid) :
+                                             (size_t)(next - subid);
+            const char *name;
+
+            rc = cfg_bkp_get_index(r, n_strs, &index);
+            if (rc != 0)
+                return rc;
+            name = TE_VEC_GET(const char *, &img->strs, index);
+
+            te_string_append_buf(&img->oids, subid, len);
+            te_string_append_buf(&img->oids, ":", 1);
+            te_string_append_buf(&img->oids, name, strlen(name));
+            subid += len;
+        }
+        te_string_append_buf(&img->oids, NULL, 1);
+
+        rc = cfg_bkp_get_opt_str(r, img, &inst.val);
+        if (rc != 0)
+            return rc;
+
+        TE_VEC_APPEND(&img->insts, inst);
+    }
+
+    return 0;
+}
+
+/* See the description in conf_backup_bin.h */
+te_errno
+cfg_bkp_image_parse(uint8_t *data, size_t len, cfg_bkp_image *img)
+{
+    cfg_bkp_reader r = { .p = data, .end = data + len };
+    uint64_t       n_strs;
+    uint64_t       i;
+    te_errno       rc;
+
+    img->data = data;
+    img->len = len;
+
+    rc = cfg_bkp_get_uint(&r, &n_strs);
+    if (rc != 0)
+        goto fail;
+
+    for (i = 0; i < n_strs; i++)
+    {
+        const char *str = (const char *)r.p;
+        const uint8_t *nul = memchr(r.p, '\0', r.end - r.p);
+
+        if (nul == NULL)
+        {
+            rc = TE_EBADMSG;
+            goto fail;
+        }
+        TE_VEC_APPEND(&img->strs, str);
+        r.p = nul + 1;
+    }
+
+    rc = cfg_bkp_image_parse_objs(&r, img);
+    if (rc != 0)
+        goto fail;
+
+    rc = cfg_bkp_image_parse_insts(&r, img);
+    if (rc != 0)
+        goto fail;
+
+    if (r.p != r.end)
+    {
+        rc = TE_EBADMSG;
+        goto fail;
+    }
+
+    return 0;
+
+fail:
+    ERROR("Malformed binary backup: %r", rc);
+    cfg_bkp_image_free(img);
+    return TE_RC(TE_CS, rc);
+}
+
+/* See the description in conf_backup_bin.h */
+te_errno
+cfg_bkp_image_load(const char *filename, cfg_bkp_image *img)
+{
+    cfg_bkp_reader  r;
+    struct stat     st;
+    uint8_t        *file = NULL;
+    uint8_t        *data = NULL;
+    uint64_t        len;
+    size_t          done = 0;
+    int             fd;
+    te_errno        rc = 0;
+
+    fd = open(filename, O_RDONLY);
+    if (fd < 0 || fstat(fd, &st) != 0)
+    {
+        rc = TE_OS_RC(TE_CS, errno);
+        ERROR("Cannot open backup file %s: %r", filename, rc);
+        if (fd >= 0)
+            close(fd);
+        return rc;
+    }
+
+    file = TE_ALLOC(MAX(st.st_size, 1));
+    while (done < (size_t)st.st_size)
+    {
+        ssize_t n = read(fd, file + done, st.st_size - done);
+
+        if (n <= 0)
+        {
+            rc = n == 0 ? TE_RC(TE_CS, TE_EIO) : TE_OS_RC(TE_CS, errno);
+            ERROR("Cannot read backup file %s: %r", filename, rc);
+            close(fd);
+            free(file);
+            return rc;
+        }
+        done += n;
+    }
+    close(fd);
+
+    r.p = file + CFG_BKP_BIN_MAGIC_LEN + 1;
+    r.end = file + done;
+    if (done < CFG_BKP_BIN_MAGIC_LEN + 1 ||
+        memcmp(file, CFG_BKP_BIN_MAGIC, sizeof(CFG_BKP_BIN_MAGIC) - 1) != 0 ||
+        file[CFG_BKP_BIN_MAGIC_LEN - 1] != CFG_BKP_BIN_VERSION ||
+        cfg_bkp_get_uint(&r, &len) != 0 || len > SIZE_MAX)
+    {
+        ERROR("File %s is not a binary backup of version %u",
+              filename, CFG_BKP_BIN_VERSION);
+        free(file);
+        return TE_RC(TE_CS, TE_EINVAL);
+    }
+
+    if (file[CFG_BKP_BIN_MAGIC_LEN] & CFG_BKP_BIN_F_ZLIB)
+    {
+#if WITH_ZLIB
+        uLongf dlen = len;
+
+        data = TE_ALLOC(MAX(len, 1));
+        if (uncompress(data, &dlen, r.p, r.end - r.p) != Z_OK ||
+            dlen != len)
+        {
+            ERROR("Failed to decompress backup file %s", filename);
+            rc = TE_RC(TE_CS, TE_EBADMSG);
+        }
+#else
+        ERROR("Backup file %s is compressed, but zlib is not available",
+              filename);
+        rc = TE_RC(TE_CS, TE_EOPNOTSUPP);
+#endif
+        free(file);
+    }
+    else if ((size_t)(r.end - r.p) != len)
+    {
+        ERROR("Backup file %s is truncated", filename);
+        rc = TE_RC(TE_CS, TE_EBADMSG);
+        free(file);
+    }
+    else
+    {
+        /* Uncompressed payload is used in place */
+        data = file;
+        memmove(data, r.p, len);
+    }
+
+    if (rc != 0)
+    {
+        free(data);
+        return rc;
+    }
+
+    return cfg_bkp_image_parse(data, len, img);
+}
+
+/* See the description in conf_backup_bin.h */
+void
+cfg_bkp_image_free(cfg_bkp_image *img)
+{
+    free(img->data);
+    img->data = NULL;
+    img->len = 0;
+    te_vec_free(&img->strs);
+    te_vec_free(&img->objs);
+    te_vec_free(&img->deps);
+    te_vec_free(&img->insts);
+    te_string_free(&img->oids);
+}
+
+/* Put an XML attribute with encoded value */
+static void
+cfg_bkp_put_xml_attr(FILE *f, const char *name, const char *val)
+{
+    xmlChar *xml_str = xmlEncodeEntitiesReentrant(NULL,
+                                                  (const xmlChar *)val);
+
+    if (xml_str == NULL)
+    {
+        ERROR("xmlEncodeEntitiesReentrant() failed");
+        return;
+    }
+    fprintf(f, " %s=\"%s\"", name, xml_str);
+    xmlFree(xml_str);
+}
+
+/* See the description in conf_backup_bin.h */
+te_errno
+cfg_bkp_image_save_xml(const cfg_bkp_image *img, const char *filename,
+                       const te_vec *subtrees)
+{
+    const cfg_bkp_obj  *obj;
+    const cfg_bkp_inst *inst;
+    unsigned int        i;
+    FILE               *f = fopen(filename, "w");
+
+    if (f == NULL)
+    {
+        te_errno rc = TE_OS_RC(TE_CS, errno);
+
+        ERROR("Cannot create %s: %r", filename, rc);
+        return rc;
+    }
+
+    fprintf(f, "<?xml version=\"1.0\"?>\n");
+    fprintf(f, "<backup>\n");
+
+    TE_VEC_FOREACH(&img->objs, obj)
+    {
+        fprintf(f, "\n  <object oid=\"%s\"", obj->oid);
+        if (obj->access != NULL)
+            fprintf(f, " access=\"%s\"", obj->access);
+        if (obj->type != NULL)
+            fprintf(f, " type=\"%s\"", obj->type);
+        if (obj->def_val != NULL)
+            cfg_bkp_put_xml_attr(f, "default", obj->def_val);
+        if (obj->unit)
+            fprintf(f, " unit=\"true\"");
+
+        if (obj->n_deps == 0)
+        {
+            fprintf(f, "/>\n");
+            continue;
+        }
+
+        fputs(">\n", f);
+        for (i = obj->first_dep; i < obj->first_dep + obj->n_deps; i++)
+        {
+            const cfg_bkp_dep *dep = &TE_VEC_GET(cfg_bkp_dep,
+                                                 &img->deps, i);
+
+            fprintf(f, "    <depends oid=\"%s\" scope=\"%s\"/>\n",
+                    dep->oid, dep->object_wide ? "object" : "instance");
+        }
+        fputs("  </object>\n", f);
+    }
+
+    TE_VEC_FOREACH(&img->insts, inst)
+    {
+        const char   *oid = cfg_bkp_inst_oid(img, inst);
+        char * const *subtree;
+        bool          match = subtrees == NULL ||
+                              te_vec_size(subtrees) == 0;
+
+        if (!match)
+        {
+            TE_VEC_FOREACH(subtrees, subtree)
+            {
+                if (strcmp_start(*subtree, oid) == 0)
+                {
+                    match = true;
+                    break;
+                }
+            }
+        }
+        if (!match)
+            continue;
+
+        fprintf(f, "\n  <instance oid=\"%s\"", oid);
+        if (inst->val != NULL)
+            cfg_bkp_put_xml_attr(f, "value", inst->val);
+        fprintf(f, "/>\n");
+    }
+
+    fprintf(f, "\n</backup>\n");
+    if (fclose(f) != 0)
+        return TE_OS_RC(TE_CS, errno);
+
+    return 0;
+}
+
+/* See the description in conf_backup_bin.h */
+te_errno
+cfg_bkp_bin_to_xml(const char *bin_file, const char *xml_file)
+{
+    cfg_bkp_image img = CFG_BKP_IMAGE_INIT;
+    te_errno      rc;
+
+    rc = cfg_bkp_image_load(bin_file, &img);
+    if (rc != 0)
+        return rc;
+
+    rc = cfg_bkp_image_save_xml(&img, xml_file, NULL);
+
+    cfg_bkp_image_free(&img);
+    return rc;
+}
+
+/* Add an XML object description to a binary backup */
+static te_errno
+cfg_bkp_xml_object(cfg_bkp_writer *w, xmlNodePtr node)
+{
+    te_vec      deps = TE_VEC_INIT(cfg_bkp_dep);
+    xmlChar    *oid = xmlGetProp(node, (const xmlChar *)"oid");
+    xmlChar    *access = xmlGetProp(node, (const xmlChar *)"access");
+    xmlChar    *type = xmlGetProp(node, (const xmlChar *)"type");
+    xmlChar    *def_val = xmlGetProp(node, (const xmlChar *)"default");
+    xmlChar    *unit = xmlGetProp(node, (const xmlChar *)"unit");
+    cfg_bkp_dep *dep;
+    te_errno     rc = 0;
+
+    if (oid == NULL)
+    {
+        ERROR("Incorrect description of the object %s", node->name);
+        rc = TE_EINVAL;
+        goto out;
+    }
+
+    for (node = node->children; node != NULL; node = node->next)
+    {
+        xmlChar    *scope;
+        cfg_bkp_dep new_dep;
+
+        if (xmlStrcmp(node->name, (const xmlChar *)"depends") != 0)
+            continue;
+
+        new_dep.oid = (const char *)xmlGetProp(node,
+                                               (const xmlChar *)"oid");
+        if (new_dep.oid == NULL)
+        {
+            ERROR("Missing OID attribute in <depends>");
+            rc = TE_EINVAL;
+            goto out;
+        }
+        scope = xmlGetProp(node, (const xmlChar *)"scope");
+        new_dep.object_wide = scope != NULL &&
+                              xmlStrcmp(scope,
+                                        (const xmlChar *)"object") == 0;
+        xmlFree(scope);
+        TE_VEC_APPEND(&deps, new_dep);
+    }
+
+    cfg_bkp_writer_add_obj(w, (const char *)oid, (const char *)access,
+                           (const char *)type, (const char *)def_val,
+                           unit != NULL &&
+                           xmlStrcmp(unit, (const xmlChar *)"true") == 0,
+                           te_vec_size(&deps) == 0 ? NULL :
+                           te_vec_get(&deps, 0),
+                           te_vec_size(&deps));
+
+out:
+    TE_VEC_FOREACH(&deps, dep)
+        xmlFree((xmlChar *)dep->oid);
+    te_vec_free(&deps);
+    xmlFree(oid);
+    xmlFree(access);
+    xmlFree(type);
+    xmlFree(def_val);
+    xmlFree(unit);
+    return rc;
+}
+
+/* Add an XML instance to a binary backup */
+static te_errno
+cfg_bkp_xml_instance(cfg_bkp_writer *w, xmlNodePtr node)
+{
+    te_string       obj_oid = TE_STRING_INIT;
+    const char     *names[CFG_OID_LEN_MAX];
+    cfg_inst_subid *ids;
+    cfg_oid        *parsed = NULL;
+    xmlChar        *oid = xmlGetProp(node, (const xmlChar *)"oid");
+    xmlChar        *val = xmlGetProp(node, (const xmlChar *)"value");
+    unsigned int    i;
+    te_errno        rc;
+
+    if (oid == NULL ||
+        (parsed = cfg_convert_oid_str((const char *)oid)) == NULL ||
+        !parsed->inst || parsed->len < 2 || parsed->len > CFG_OID_LEN_MAX)
+    {
+        ERROR("Incorrect description of the object instance %s",
+              oid == NULL ? (const char *)node->name : (const char *)oid);
+        rc = TE_EINVAL;
+        goto out;
+    }
+
+    ids = parsed->ids;
+    for (i = 1; i < parsed->len; i++)
+    {
+        te_string_append(&obj_oid, "/%s", ids[i].subid);
+        names[i - 1] = ids[i].name;
+    }
+
+    rc = cfg_bkp_writer_add_inst(w, obj_oid.ptr, names, parsed->len - 1,
+                                 (const char *)val);
+    if (rc != 0)
+        ERROR("Cannot add instance %s to the backup: %r", oid, rc);
+
+out:
+    cfg_free_oid(parsed);
+    te_string_free(&obj_oid);
+    xmlFree(oid);
+    xmlFree(val);
+    return rc;
+}
+
+/* See the description in conf_backup_bin.h */
+te_errno
+cfg_bkp_xml_to_bin(const char *xml_file, const char *bin_file,
+                   bool compress)
+{
+    cfg_bkp_writer w = CFG_BKP_WRITER_INIT;
+    xmlDocPtr      doc;
+    xmlNodePtr     root;
+    xmlNodePtr     cur;
+    te_errno       rc = 0;
+
+    doc = xmlParseFile(xml_file);
+    if (doc == NULL)
+    {
+        ERROR("Cannot parse XML backup %s", xml_file);
+        return TE_RC(TE_CS, TE_EINVAL);
+    }
+
+    root = xmlDocGetRootElement(doc);
+    if (root == NULL ||
+        xmlStrcmp(root->name, (const xmlChar *)"backup") != 0)
+    {
+        ERROR("File %s is not a backup", xml_file);
+        rc = TE_RC(TE_CS, TE_EINVAL);
+        goto out;
+    }
+
+    for (cur = root->children; cur != NULL && rc == 0; cur = cur->next)
+    {
+        if (xmlStrcmp(cur->name, (const xmlChar *)"object") == 0)
+            rc = cfg_bkp_xml_object(&w, cur);
+        else if (xmlStrcmp(cur->name, (const xmlChar *)"instance") == 0)
+            rc = cfg_bkp_xml_instance(&w, cur);
+    }
+
+    if (rc == 0)
+        rc = cfg_bkp_writer_save(&w, bin_file, compress);
+
+out:
+    cfg_bkp_writer_free(&w);
+    xmlFreeDoc(doc);
+    xmlCleanupParser();
+    return rc;
+}
@@ -0,0 +1,290 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/** @file
+ * @brief Configurator
+ *
+ * Compact binary format of backup files
+ *
+ * A binary backup keeps the same information as an XML one: object
+ * descriptions with dependencies and instances with values converted
+ * to strings. All strings (OIDs, instance names, values) are interned
+ * in a table and referred by index, an instance is stored as a reference
+ * to its object plus own names of the instance and its ancestors.
+ * Instances are stored in order of their restoration, so the file may
+ * be loaded with a single sequential read without sorting.
+ *
+ * The file consists of a header (magic, version, flags, length of
+ * the payload) and the payload which may be compressed if the
+ * Configurator is built with zlib. All integers in the payload are
+ * unsigned LEB128 numbers, optional strings are stored as string index
+ * plus one (zero for absent string):
+ *
+ * @code
+ * strings:   count, count * (NUL-terminated string)
+ * objects:   count, count * (oid, access + 1, type + 1, default + 1,
+ *                            unit, deps count, deps * (oid, object_wide))
+ * instances: count, count * (object index, depth * name, value + 1)
+ * @endcode
+ *
+ * Copyright (C) 2004-2023 OKTET Labs Ltd. All rights reserved.
+ */
+
+#ifndef __TE_CONF_BACKUP_BIN_H__
+#define __TE_CONF_BACKUP_BIN_H__
+
+#include "te_dbuf.h"
+#include "te_string.h"
+#include "te_vector.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Magic bytes at the beginning of a binary backup file */
+#define CFG_BKP_BIN_MAGIC       "TECSBKP"
+/** Current version of the binary backup format */
+#define CFG_BKP_BIN_VERSION     1
+/** The payload of a binary backup is compressed with zlib */
+#define CFG_BKP_BIN_F_ZLIB      0x1
+
+/** Dependency of an object in a binary backup */
+typedef struct cfg_bkp_dep {
+    const char *oid;            /**< Master object OID */
+    bool        object_wide;    /**< Dependency scope is "object" */
+} cfg_bkp_dep;
+
+/** Object description in a binary backup */
+typedef struct cfg_bkp_obj {
+    const char   *oid;          /**< Object OID */
+    const char   *access;       /**< Access rights name or @c NULL */
+    const char   *type;         /**< Value type name or @c NULL */
+    const char   *def_val;      /**< Default value or @c NULL */
+    bool          unit;         /**< Object is a logical unit */
+    unsigned int  depth;        /**< Number of subids in the OID */
+    unsigned int  first_dep;    /**< Index of the first dependency */
+    unsigned int  n_deps;       /**< Number of dependencies */
+} cfg_bkp_obj;
+
+/** Instance in a binary backup */
+typedef struct cfg_bkp_inst {
+    unsigned int  obj;          /**< Index of the object */
+    size_t        oid;          /**< Offset of the instance OID in
+                                     the image OIDs buffer */
+    const char   *val;          /**< Value or @c NULL */
+} cfg_bkp_inst;
+
+/** Decoded binary backup */
+typedef struct cfg_bkp_image {
+    uint8_t    *data;       /**< Payload keeping all the strings */
+    size_t      len;        /**< Length of the payload */
+    te_vec      strs;       /**< String table (const char *) */
+    te_vec      objs;       /**< Objects (cfg_bkp_obj) */
+    te_vec      deps;       /**< Dependencies of all objects
+                                 (cfg_bkp_dep) */
+    te_vec      insts;      /**< Instances (cfg_bkp_inst) */
+    te_string   oids;       /**< Reconstructed instance OIDs */
+} cfg_bkp_image;
+
+/** On-stack initializer for cfg_bkp_image */
+#define CFG_BKP_IMAGE_INIT { \
+    .data = NULL,                               \
+    .len = 0,                                   \
+    .strs = TE_VEC_INIT(const char *),          \
+    .objs = TE_VEC_INIT(cfg_bkp_obj),           \
+    .deps = TE_VEC_INIT(cfg_bkp_dep),           \
+    .insts = TE_VEC_INIT(cfg_bkp_inst),         \
+    .oids = TE_STRING_INIT,                     \
+}
+
+/** Builder of a binary backup */
+typedef struct cfg_bkp_writer {
+    te_dbuf         strs;       /**< Interned strings */
+    te_vec          offs;       /**< Offsets of interned strings
+                                     (size_t) */
+    te_vec          str2obj;    /**< Object index plus one by index of
+                                     its OID string (unsigned int) */
+    uint32_t       *hash;       /**< Hash table of interned strings:
+                                     string index plus one or zero */
+    size_t          hash_size;  /**< Size of the hash table (power of
+                                     two) */
+    te_dbuf         objs;       /**< Encoded objects */
+    unsigned int    n_objs;     /**< Number of objects */
+    te_dbuf         insts;      /**< Encoded instances */
+    unsigned int    n_insts;    /**< Number of instances */
+} cfg_bkp_writer;
+
+/** On-stack initializer for cfg_bkp_writer */
+#define CFG_BKP_WRITER_INIT { \
+    .strs = TE_DBUF_INIT(TE_DBUF_DEFAULT_GROW_FACTOR),  \
+    .offs = TE_VEC_INIT(size_t),                        \
+    .str2obj = TE_VEC_INIT(unsigned int),               \
+    .hash = NULL,                                       \
+    .hash_size = 0,                                     \
+    .objs = TE_DBUF_INIT(TE_DBUF_DEFAULT_GROW_FACTOR),  \
+    .n_objs = 0,                                        \
+    .insts = TE_DBUF_INIT(TE_DBUF_DEFAULT_GROW_FACTOR), \
+    .n_insts = 0,                                       \
+}
+
+/**
+ * Add an object description to a binary backup.
+ * Objects should be added before their instances.
+ *
+ * @param w             backup builder
+ * @param oid           object OID
+ * @param access        access rights name or @c NULL
+ * @param type          value type name or @c NULL
+ * @param def_val       default value or @c NULL
+ * @param unit          object is a logical unit
+ * @param deps          dependencies
+ * @param n_deps        number of dependencies
+ */
+extern void cfg_bkp_writer_add_obj(cfg_bkp_writer *w, const char *oid,
+                                   const char *access, const char *type,
+                                   const char *def_val, bool unit,
+                                   const cfg_bkp_dep *deps,
+                                   unsigned int n_deps);
+
+/**
+ * Add an instance to a binary backup.
+ *
+ * @param w             backup builder
+ * @param obj_oid       OID of the object of the instance
+ * @param names         own names of the instance ancestors and
+ *                      the instance itself starting from the top
+ * @param depth         number of names
+ * @param val           value or @c NULL
+ *
+ * @return Status code.
+ * @retval TE_ENOENT    The object is not added to the backup.
+ * @retval TE_EINVAL    @p depth does not match the object OID.
+ */
+extern te_errno cfg_bkp_writer_add_inst(cfg_bkp_writer *w,
+                                        const char *obj_oid,
+                                        const char * const *names,
+                                        unsigned int depth,
+                                        const char *val);
+
+/**
+ * Get the payload of a binary backup (without the file header).
+ *
+ * @param w             backup builder
+ * @param payload       buffer to append the payload to
+ */
+extern void cfg_bkp_writer_payload(const cfg_bkp_writer *w,
+                                   te_dbuf *payload);
+
+/**
+ * Write a binary backup to a file.
+ *
+ * @param w             backup builder
+ * @param filename      name of the file to be created
+ * @param compress      compress the payload (ignored if zlib is not
+ *                      available)
+ *
+ * @return Status code.
+ */
+extern te_errno cfg_bkp_writer_save(const cfg_bkp_writer *w,
+                                    const char *filename, bool compress);
+
+/**
+ * Release resources of a binary backup builder.
+ *
+ * @param w             backup builder
+ */
+extern void cfg_bkp_writer_free(cfg_bkp_writer *w);
+
+/**
+ * Check whether a file is a binary backup.
+ *
+ * @param filename      name of the file
+ *
+ * @return @c true if the file starts with the binary backup magic.
+ */
+extern bool cfg_bkp_is_bin_file(const char *filename);
+
+/**
+ * Decode the payload of a binary backup.
+ *
+ * @param data          payload, owned by @p img (released on failure)
+ * @param len           length of the payload
+ * @param img           image to fill in
+ *
+ * @return Status code.
+ */
+extern te_errno cfg_bkp_image_parse(uint8_t *data, size_t len,
+                                    cfg_bkp_image *img);
+
+/**
+ * Load a binary backup file with a single read.
+ *
+ * @param filename      name of the file
+ * @param img           image to fill in
+ *
+ * @return Status code.
+ */
+extern te_errno cfg_bkp_image_load(const char *filename,
+                                   cfg_bkp_image *img);
+
+/**
+ * Get OID of an instance of a binary backup image.
+ *
+ * @param img           image
+ * @param inst          instance of the image
+ *
+ * @return Instance OID.
+ */
+static inline const char *
+cfg_bkp_inst_oid(const cfg_bkp_image *img, const cfg_bkp_inst *inst)
+{
+    return img->oids.ptr + inst->oid;
+}
+
+/**
+ * Release resources of a binary backup image.
+ *
+ * @param img           image
+ */
+extern void cfg_bkp_image_free(cfg_bkp_image *img);
+
+/**
+ * Save a binary backup image to a file in the XML backup format.
+ *
+ * @param img           image
+ * @param filename      name of the file to be created
+ * @param subtrees      subtrees to output instances of, @c NULL for
+ *                      all instances
+ *
+ * @return Status code.
+ */
+extern te_errno cfg_bkp_image_save_xml(const cfg_bkp_image *img,
+                                       const char *filename,
+                                       const te_vec *subtrees);
+
+/**
+ * Convert a binary backup to an XML one.
+ *
+ * @param bin_file      name of the binary backup file
+ * @param xml_file      name of the XML file to be created
+ *
+ * @return Status code.
+ */
+extern te_errno cfg_bkp_bin_to_xml(const char *bin_file,
+                                   const char *xml_file);
+
+/**
+ * Convert an XML backup to a binary one. Instances are stored in
+ * order of the XML file, it is checked when the backup is restored.
+ *
+ * @param xml_file      name of the XML backup file
+ * @param bin_file      name of the binary file to be created
+ * @param compress      compress the payload
+ *
+ * @return Status code.
+ */
+extern te_errno cfg_bkp_xml_to_bin(const char *xml_file,
+                                   const char *bin_file, bool compress);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __TE_CONF_BACKUP_BIN_H__ */
@@ -0,0 +1,85 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/** @file
+ * @brief Configurator
+ *
+ * Conversion of backups between XML and binary formats
+ *
+ * Copyright (C) 2004-2023 OKTET Labs Ltd. All rights reserved.
+ */
+
+#include "te_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <popt.h>
+
+#include "logger_api.h"
+#include "logger_file.h"
+#include "conf_backup_bin.h"
+
+/**
+ * Convert a binary backup to XML or an XML backup to binary format
+ * depending on format of the input file.
+ *
+ * @param argc      number of arguments
+ * @param argv      arguments
+ *
+ * @retval EXIT_SUCCESS - success
+ * @retval EXIT_FAILURE - failure
+ */
+int
+main(int argc, const char **argv)
+{
+    int          compress = 0;
+    const char  *input;
+    const char  *output;
+    poptContext  optCon;
+    te_errno     rc;
+    int          opt;
+
+    struct poptOption options_table[] = {
+        { "compress", 'z', POPT_ARG_NONE, &compress, 0,
+          "Compress binary backup.", NULL },
+
+        POPT_AUTOHELP
+        POPT_TABLEEND
+    };
+
+    te_log_init("Backup Converter", te_log_message_file);
+
+    optCon = poptGetContext(NULL, argc, argv, options_table, 0);
+    poptSetOtherOptionHelp(optCon, "[OPTIONS] <input> <output>");
+
+    opt = poptGetNextOpt(optCon);
+    if (opt != -1)
+    {
+        ERROR("%s: %s", poptBadOption(optCon, POPT_BADOPTION_NOALIAS),
+              poptStrerror(opt));
+        poptFreeContext(optCon);
+        return EXIT_FAILURE;
+    }
+
+    input = poptGetArg(optCon);
+    output = poptGetArg(optCon);
+    if (input == NULL || output == NULL || poptGetArg(optCon) != NULL)
+    {
+        poptPrintUsage(optCon, stderr, 0);
+        poptFreeContext(optCon);
+        return EXIT_FAILURE;
+    }
+
+    if (cfg_bkp_is_bin_file(input))
+        rc = cfg_bkp_bin_to_xml(input, output);
+    else
+        rc = cfg_bkp_xml_to_bin(input, output, compress != 0);
+
+    poptFreeContext(optCon);
+
+    if (rc != 0)
+    {
+        ERROR("Failed to convert %s to %s: %r", input, output, rc);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -8,13 +8,18 @@
  * Copyright (C) 2004-2022 OKTET Labs Ltd. All rights reserved.
  */
 
+#include <fcntl.h>
+#include <sys/mman.h>
+
 #include "conf_defs.h"
 #include "te_alloc.h"
 #include "te_string.h"
+#include "te_vector.h"
 
 /* These must not be greater than CFG_HANDLE_MAX_INDEX + 1 */
 #define CFG_OBJ_NUM     64      /**< Number of objects */
-#define CFG_INST_NUM    128     /**< Number of object instances */
+#define CFG_INST_NUM    128     /**< Initial number of object
+                                     instances */
 
 /** Internal Configurator object handles */
 enum cfg_obj_reserved_handles {
@@ -115,8 +120,20 @@ cfg_instance **cfg_all_inst = NULL;
 /** Size of instances pool */
 uint64_t cfg_all_inst_size;
 
-/** Maximum index ever used in the cfg_all_inst */
-static uint64_t cfg_all_inst_max = 1;
+/** The first index in the cfg_all_inst which has never been used */
+static uint64_t cfg_all_inst_next = 1;
+
+/** Indexes of deleted instances in the cfg_all_inst (uint32_t) */
+static te_vec cfg_all_inst_free = TE_VEC_INIT(uint32_t);
+
+/** Database generation used until it is published */
+static cfg_db_gen_shared cfg_db_gen_local = { .gen = 1 };
+
+/** Database generation (shared with clients when published) */
+static cfg_db_gen_shared *cfg_db_gen = &cfg_db_gen_local;
+
+/** Path to the file with the published database generation */
+static char *cfg_db_gen_path = NULL;
 
 /** Unique sequence number of the next instance */
 uint32_t cfg_inst_seq_num = 1;
@@ -434,6 +451,79 @@ cfg_destroy_deps(cfg_dependency *deps)
     }
 }
 
+/* See the description in conf_db.h */
+void
+cfg_db_changed(void)
+{
+    __atomic_add_fetch(&cfg_db_gen->gen, 1, __ATOMIC_RELEASE);
+}
+
+/* See the description in conf_db.h */
+te_errno
+cfg_db_gen_publish(const char *tmp_dir)
+{
+    cfg_db_gen_shared *shared;
+    char              *path;
+    int                fd;
+    te_errno           rc;
+
+    path = te_string_fmt(CFG_DB_GEN_FILE_FMT, tmp_dir, CONFIGURATOR_SERVER);
+
+    fd = open(path, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (fd < 0)
+    {
+        rc = TE_OS_RC(TE_CS, errno);
+        ERROR("Failed to create '%s': %r", path, rc);
+        free(path);
+        return rc;
+    }
+
+    if (ftruncate(fd, sizeof(*shared)) != 0)
+    {
+        rc = TE_OS_RC(TE_CS, errno);
+        ERROR("Failed to resize '%s': %r", path, rc);
+        close(fd);
+        unlink(path);
+        free(path);
+        return rc;
+    }
+
+    shared = mmap(NULL, sizeof(*shared), PROT_READ | PROT_WRITE,
+                  MAP_SHARED, fd, 0);
+    close(fd);
+    if (shared == MAP_FAILED)
+    {
+        rc = TE_OS_RC(TE_CS, errno);
+        ERROR("Failed to map '%s': %r", path, rc);
+        unlink(path);
+        free(path);
+        return rc;
+    }
+
+    __atomic_store_n(&shared->gen, cfg_db_gen_local.gen, __ATOMIC_RELEASE);
+    cfg_db_gen = shared;
+    cfg_db_gen_path = path;
+
+    return 0;
+}
+
+/* See the description in conf_db.h */
+void
+cfg_db_gen_unpublish(void)
+{
+    if (cfg_db_gen_path == NULL)
+        return;
+
+    /* Tell clients which keep the file mapped to drop their caches */
+    __atomic_store_n(&cfg_db_gen->gen, CFG_DB_GEN_INVALID, __ATOMIC_RELEASE);
+    munmap(cfg_db_gen, sizeof(*cfg_db_gen));
+    cfg_db_gen = &cfg_db_gen_local;
+
+    unlink(cfg_db_gen_path);
+    free(cfg_db_gen_path);
+    cfg_db_gen_path = NULL;
+}
+
 /**
  * Initialize the database during startup or re-initialization.
  *
@@ -462,6 +552,8 @@ cfg_db_init(void)
 
     cfg_all_inst = TE_ALLOC(CFG_INST_NUM * sizeof(void *));
     cfg_all_inst_size = CFG_INST_NUM;
+    cfg_all_inst_next = 1;
+    te_vec_reset(&cfg_all_inst_free);
     cfg_all_inst[0] = &cfg_inst_root;
     cfg_inst_root.son = NULL;
 
@@ -470,6 +562,8 @@ cfg_db_init(void)
     cfg_create_dep(&cfg_obj_agent_rsrc, &cfg_obj_agent_rsrc_fallback_shared,
                    true);
 
+    cfg_db_changed();
+
     return cfg_ta_add_agent_instances();
 }
 
@@ -491,12 +585,12 @@ cfg_db_destroy(void)
         {
             cfg_types[cfg_all_inst[i]->obj->type].
                 free(cfg_all_inst[i]->val);
-            free(cfg_all_inst[i]->oid);
             free(cfg_all_inst[i]);
         }
     }
     free(cfg_all_inst);
     cfg_all_inst = NULL;
+    te_vec_free(&cfg_all_inst_free);
 
     INFO("Destroy objects");
     for (i = CFG_OBJ_HANDLE_NUM_RSRVD; i < cfg_all_obj_size; i++)
@@ -512,6 +606,8 @@ cfg_db_destroy(void)
     }
     free(cfg_all_obj);
     cfg_all_obj = NULL;
+
+    cfg_db_changed();
 }
 
 static void
@@ -678,6 +774,7 @@ cfg_process_msg_register(cfg_register_msg *msg)
     cfg_all_obj[i]->son = NULL;
     cfg_all_obj[i]->brother = father->son;
     father->son = cfg_all_obj[i];
+    cfg_db_changed();
 
     cfg_all_obj[i]->substitution = msg->substitution;
 
@@ -928,6 +1025,7 @@ cfg_db_unregister_obj_by_id_str(char *id,
 
     /* Delete from the array of objects */
     cfg_all_obj[obj->handle] = NULL;
+    cfg_db_changed();
 
     free(obj->oid);
     free(obj->def_val);
@@ -1175,6 +1273,31 @@ cfg_process_msg_pattern(cfg_pattern_msg *msg)
 #undef RETERR
 }   /* cfg_process_msg_pattern() */
 
+/* See the description in conf_db.h */
+bool
+cfg_db_inst_oid_match(const cfg_oid *pattern, const cfg_oid *oid)
+{
+    cfg_inst_subid *s1 = (cfg_inst_subid *)(pattern->ids);
+    cfg_inst_subid *s2 = (cfg_inst_subid *)(oid->ids);
+    int             k;
+
+    if (!oid->inst || oid->len != pattern->len)
+        return false;
+
+    for (k = 0; k < pattern->len; k++, s1++, s2++)
+    {
+        if ((s1->subid[0] != '*' &&
+             pattern_match(s1->subid, s2->subid) != 0) ||
+            (s1->name[0] != '*' &&
+             pattern_match(s1->name, s2->name) != 0))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 /**
  * Find all objects or object instances matching a pattern.
  *
@@ -1233,9 +1356,8 @@ cfg_db_find_pattern(const char *pattern,
 
         for (i = 0; i < cfg_all_inst_size; i++)
         {
-            cfg_inst_subid *s1;
-            cfg_inst_subid *s2;
             cfg_oid        *tmp_idsplit;
+            bool            match;
 
             if (cfg_all_inst[i] == NULL)
                 continue;
@@ -1250,25 +1372,9 @@ cfg_db_find_pattern(const char *pattern,
             if (tmp_idsplit == NULL)
                 RETERR(TE_ENOMEM);
 
-            if (tmp_idsplit->len != idsplit->len)
-            {
-                cfg_free_oid(tmp_idsplit);
-                continue;
-            }
-            s1 = (cfg_inst_subid *)(idsplit->ids);
-            s2 = (cfg_inst_subid *)(tmp_idsplit->ids);
-            for (k = 0; k < idsplit->len; k++, s1++, s2++)
-            {
-                if ((s1->subid[0] != '*' &&
-                     pattern_match(s1->subid, s2->subid) != 0) ||
-                    (s1->name[0] != '*' &&
-                     pattern_match(s1->name, s2->name) != 0))
-                {
-                    break;
-                }
-            }
+            match = cfg_db_inst_oid_match(idsplit, tmp_idsplit);
             cfg_free_oid(tmp_idsplit);
-            if (k == idsplit->len)
+            if (match)
                 matches[nof_matches++] = cfg_all_inst[i]->handle;
         }
     }
@@ -1327,89 +1433,134 @@ cfg_db_find_pattern(const char *pattern,
 #undef RETERR
 }   /* cfg_db_find_pattern() */
 
-/*
- * Add instance with given object and parent
+/**
+ * Get an index in the pool of instances for a new instance.
  *
- * @param par_inst      Parent instance
- * @param obj           Object of a new instance
- * @param inst          Pointer for the new instance
+ * @param idx           location for the index
  *
- * @return Status code
+ * @return Status code.
  */
-static int
-cfg_add_with_obj_and_parent(cfg_instance *par_inst, cfg_object *obj,
-                            cfg_instance **inst)
+static te_errno
+cfg_db_inst_idx_alloc(uint64_t *idx)
 {
-    char  *oid_s;
-    char  *par_oid;
-    size_t oid_s_len;
-    int    ret;
-
-    uint64_t i;
+    size_t   n_free = te_vec_size(&cfg_all_inst_free);
+    uint64_t size;
 
-    if (strcmp(par_inst->oid, "/:") != 0)
-        par_oid = par_inst->oid;
-    else
-        par_oid = "";
-
-    oid_s_len = strlen(par_oid) + 1 /* forward slash */ +
-                strlen(obj->subid) + 1 /* colon */;
-    oid_s = TE_ALLOC(oid_s_len + 1 /* \0 */);
-
-    ret = snprintf(oid_s, oid_s_len + 1, "%s/%s:", par_oid, obj->subid);
-    if (ret != (int)oid_s_len)
-        return TE_ENOBUFS;
-
-    for (i = 0; i < cfg_all_inst_size && cfg_all_inst[i] != NULL; i++);
+    if (n_free > 0)
+    {
+        *idx = TE_VEC_GET(uint32_t, &cfg_all_inst_free, n_free - 1);
+        te_vec_remove_index(&cfg_all_inst_free, n_free - 1);
+        return 0;
+    }
 
-    if (i > CFG_HANDLE_MAX_INDEX)
+    if (cfg_all_inst_next > CFG_HANDLE_MAX_INDEX)
     {
         ERROR("%s(): no more instance indexes is available",
               __FUNCTION__);
-        free(oid_s);
         return TE_ETOOMANY;
     }
 
-    if (i == cfg_all_inst_size)
+    if (cfg_all_inst_next == cfg_all_inst_size)
     {
-        TE_REALLOC(cfg_all_inst,
-                   sizeof(void *) * (cfg_all_inst_size + CFG_INST_NUM));
-        memset((void *)cfg_all_inst + sizeof(void *) * cfg_all_inst_size, 0,
-             sizeof(void *) * CFG_INST_NUM);
-
-        cfg_all_inst_size += CFG_INST_NUM;
+        /* Grow geometrically to keep amortized cost of additions O(1) */
+        size = MIN(cfg_all_inst_size * 2,
+                   (uint64_t)CFG_HANDLE_MAX_INDEX + 1);
+        TE_REALLOC(cfg_all_inst, sizeof(void *) * size);
+        memset(cfg_all_inst + cfg_all_inst_size, 0,
+               sizeof(void *) * (size - cfg_all_inst_size));
+        cfg_all_inst_size = size;
     }
 
-    cfg_all_inst[i] = TE_ALLOC(sizeof(cfg_instance));
-    cfg_all_inst[i]->oid = oid_s;
+    *idx = cfg_all_inst_next++;
+    return 0;
+}
+
+/* See the description in conf_db.h */
+te_errno
+cfg_db_inst_alloc(cfg_instance *father, cfg_object *obj,
+                  const char *name, cfg_instance **inst)
+{
+    const char   *par_oid = (father == &cfg_inst_root) ? "" : father->oid;
+    size_t        prefix_len = strlen(par_oid) + 1 /* forward slash */ +
+                               strlen(obj->subid) + 1 /* colon */;
+    size_t        name_len = strlen(name);
+    cfg_instance *new_inst;
+    uint64_t      idx;
+    te_errno      rc;
+
+    rc = cfg_db_inst_idx_alloc(&idx);
+    if (rc != 0)
+        return rc;
+
+    /* The OID follows the instance in the same memory block */
+    new_inst = TE_ALLOC(sizeof(*new_inst) + prefix_len + name_len + 1);
+    new_inst->oid = (char *)(new_inst + 1);
+    sprintf(new_inst->oid, "%s/%s:%s", par_oid, obj->subid, name);
+    new_inst->name = new_inst->oid + prefix_len;
+
+    CFG_NEW_INST_HANDLE(new_inst->handle, idx);
+    new_inst->obj = obj;
+    new_inst->father = father;
+    cfg_all_inst[idx] = new_inst;
+
+    *inst = new_inst;
+    return 0;
+}
+
+/* See the description in conf_db.h */
+void
+cfg_db_inst_free(cfg_instance *inst)
+{
+    uint32_t idx = CFG_INST_HANDLE_TO_INDEX(inst->handle);
+
+    cfg_all_inst[idx] = NULL;
+    TE_VEC_APPEND(&cfg_all_inst_free, idx);
+    free(inst);
+}
+
+/*
+ * Add instance with given object and parent
+ *
+ * @param par_inst      Parent instance
+ * @param obj           Object of a new instance
+ * @param inst          Pointer for the new instance
+ *
+ * @return Status code
+ */
+static int
+cfg_add_with_obj_and_parent(cfg_instance *par_inst, cfg_object *obj,
+                            cfg_instance **inst)
+{
+    cfg_instance *new_inst;
+    te_errno      rc;
+
+    rc = cfg_db_inst_alloc(par_inst, obj, "", &new_inst);
+    if (rc != 0)
+        return rc;
+
     if (obj->type != CVT_NONE)
     {
         int err;
 
         if (obj->def_val != NULL)
             err = cfg_types[obj->type].str2val(obj->def_val,
-                                           &(cfg_all_inst[i]->val));
+                                               &new_inst->val);
         else
-            err =
-                cfg_types[obj->type].def_val(&(cfg_all_inst[i]->val));
+            err = cfg_types[obj->type].def_val(&new_inst->val);
 
         if (err)
         {
-            free(cfg_all_inst[i]->oid);
-            free(cfg_all_inst[i]);
-            cfg_all_inst[i] = NULL;
+            cfg_db_inst_free(new_inst);
             return err;
         }
     }
 
-    CFG_NEW_INST_HANDLE(cfg_all_inst[i]->handle, i);
-    cfg_all_inst[i]->name[0] = '\0';
-    cfg_all_inst[i]->obj = obj;
-    cfg_all_inst[i]->father = par_inst;
-    cfg_all_inst[i]->son = NULL;
-    cfg_all_inst[i]->brother = par_inst->son;
-    par_inst->son =  cfg_all_inst[i];
-    *inst = cfg_all_inst[i];
+    new_inst->son = NULL;
+    new_inst->brother = par_inst->son;
+    par_inst->son = new_inst;
+    cfg_db_changed();
+    cfg_subscr_notify(CFG_CHANGE_ADD, new_inst->oid);
+    *inst = new_inst;
 
     return 0;
 }
@@ -1482,7 +1633,7 @@ get_delay_by_oid(const char *oid)
     if (*oid_obj == 0)
         return 0;
 
-    for (i = 0; i < cfg_all_inst_max; i++)
+    for (i = 0; i < cfg_all_inst_next; i++)
     {
         cfg_instance *tmp = cfg_all_inst[i];
 
@@ -1535,6 +1686,7 @@ cfg_db_add(const char *oid_s, cfg_handle *handle,
     cfg_instance   *prev;
     cfg_inst_subid *s;
     uint64_t        i = 0;
+    te_errno        rc;
 
     if (oid == NULL)
     {
@@ -1609,34 +1761,9 @@ cfg_db_add(const char *oid_s, cfg_handle *handle,
     if (inst != NULL && strcmp(inst->oid, oid_s) == 0)
         RET(TE_EEXIST);
 
-    /* Now look for empty slot in the object instances array */
-    for (i = 0; i < cfg_all_inst_size && cfg_all_inst[i] != NULL; i++);
-
-    if (i > CFG_HANDLE_MAX_INDEX)
-    {
-        ERROR("%s(): no more instance indexes is available",
-              __FUNCTION__);
-        RET(TE_ETOOMANY);
-    }
-
-    if (i == cfg_all_inst_size)
-    {
-        TE_REALLOC(cfg_all_inst,
-                   sizeof(void *) * (cfg_all_inst_size + CFG_INST_NUM));
-
-        memset((void *)cfg_all_inst + sizeof(void *) * cfg_all_inst_size, 0,
-               sizeof(void *) * CFG_INST_NUM);
-
-        cfg_all_inst_size += CFG_INST_NUM;
-    }
-
-    inst = cfg_all_inst[i] = TE_ALLOC(sizeof(cfg_instance));
-    if ((inst->oid = strdup(oid_s)) == NULL)
-    {
-        free(inst);
-        cfg_all_inst[i] = NULL;
-        RET(TE_ENOMEM);
-    }
+    rc = cfg_db_inst_alloc(father, obj, s->name, &inst);
+    if (rc != 0)
+        RET(rc);
 
     if (obj->type != CVT_NONE)
     {
@@ -1651,9 +1778,7 @@ cfg_db_add(const char *oid_s, cfg_handle *handle,
 
         if (err)
         {
-            free(inst->oid);
-            free(inst);
-            cfg_all_inst[i] = NULL;
+            cfg_db_inst_free(inst);
             RET(err);
         }
     }
@@ -1665,10 +1790,6 @@ cfg_db_add(const char *oid_s, cfg_handle *handle,
      * when this object is added to the Test Agent.
      */
     inst->added = false;
-    CFG_NEW_INST_HANDLE(inst->handle, i);
-    strcpy(inst->name, s->name);
-    inst->obj = obj;
-    inst->father = father;
     inst->son = NULL;
 
     if (prev)
@@ -1681,10 +1802,10 @@ cfg_db_add(const char *oid_s, cfg_handle *handle,
         inst->brother = father->son;
         father->son = inst;
     }
+    cfg_db_changed();
+    cfg_subscr_notify(CFG_CHANGE_ADD, inst->oid);
 
     *handle = inst->handle;
-    if (cfg_all_inst_max < i)
-        cfg_all_inst_max = i;
 
     cfg_free_oid(oid);
     if (strcmp_start(CFG_TA_PREFIX, inst->oid) != 0)
@@ -1771,15 +1892,14 @@ delete_son(cfg_instance *father, cfg_instance *son)
         brother->brother = son->brother;
     }
 
-    /* Delete from the array of object instances */
-    cfg_all_inst[CFG_INST_HANDLE_TO_INDEX(son->handle)] = NULL;
+    cfg_subscr_notify(CFG_CHANGE_DEL, son->oid);
 
     /* Free memory allocated for the instance */
     if (son->obj->type != CVT_NONE)
         cfg_types[son->obj->type].free(son->val);
 
-    free(son->oid);
-    free(son);
+    /* Delete from the array of object instances */
+    cfg_db_inst_free(son);
 }
 
 /**
@@ -1791,6 +1911,7 @@ void
 cfg_db_del(cfg_handle handle)
 {
     delete_son(CFG_GET_INST(handle)->father, CFG_GET_INST(handle));
+    cfg_db_changed();
 }
 
 /**
@@ -1810,6 +1931,7 @@ cfg_db_set(cfg_handle handle, cfg_inst_val val)
     if (inst->obj->type != CVT_NONE)
     {
         cfg_inst_val val0;
+        bool changed = !cfg_types[inst->obj->type].is_equal(inst->val, val);
         int err = cfg_types[inst->obj->type].copy(val, &val0);
 
         if (err)
@@ -1817,6 +1939,12 @@ cfg_db_set(cfg_handle handle, cfg_inst_val val)
 
         cfg_types[inst->obj->type].free(inst->val);
         inst->val = val0;
+        /* Synchronization sets values which are mostly unchanged */
+        if (changed)
+        {
+            cfg_db_changed();
+            cfg_subscr_notify(CFG_CHANGE_SET, inst->oid);
+        }
     }
 
     return 0;
@@ -113,8 +113,11 @@ cfg_object_agent(cfg_object *obj)
 /** Configurator object instance */
 typedef struct cfg_instance {
     cfg_handle  handle;             /**< Handle of the instance */
-    char       *oid;                /**< OID of the instance */
-    char        name[CFG_INST_NAME_MAX];    /**< Own name of the instance */
+    char       *oid;                /**< OID of the instance (kept in
+                                         the same memory block as
+                                         the instance) */
+    const char *name;               /**< Own name of the instance
+                                         (the tail of the OID) */
     cfg_object *obj;                /**< Object of the instance */
     bool added;              /**< Whether this instance was added
                                          to the Test Agent or not
@@ -269,6 +272,32 @@ extern cfg_instance *cfg_get_ins_by_ins_id_str(const char *ins_id_str);
  */
 extern te_errno cfg_add_all_inst_by_obj(cfg_object *obj);
 
+/**
+ * Allocate an instance in the pool of instances. The instance OID
+ * is built of the father OID, the object sub-identifier and the own
+ * name, value and family links except the father are not filled in.
+ * Indexes of deleted instances are reused first, so that allocation
+ * does not depend on the size of the database.
+ *
+ * @param father        father instance
+ * @param obj           object of the instance
+ * @param name          own name of the instance
+ * @param inst          location for the new instance
+ *
+ * @return Status code.
+ * @retval TE_ETOOMANY  No more instance indexes are available.
+ */
+extern te_errno cfg_db_inst_alloc(cfg_instance *father, cfg_object *obj,
+                                  const char *name, cfg_instance **inst);
+
+/**
+ * Release an instance allocated with cfg_db_inst_alloc() and return
+ * its index to the pool. The value of the instance is not released.
+ *
+ * @param inst          instance
+ */
+extern void cfg_db_inst_free(cfg_instance *inst);
+
 /**
  * Add instance to the database.
  *
@@ -344,6 +373,40 @@ extern int cfg_db_find(const char *oid_s, cfg_handle *handle);
 extern te_errno cfg_db_find_pattern(const char *pattern,
                                     unsigned int *p_nmatches,
                                     cfg_handle **p_matches);
+
+/**
+ * Check whether an object instance identifier matches a pattern.
+ *
+ * @param pattern       parsed instance identifier pattern (subidentifiers
+ *                      and names may contain '*')
+ * @param oid           parsed object instance identifier
+ *
+ * @return @c true if the identifier matches the pattern
+ */
+extern bool cfg_db_inst_oid_match(const cfg_oid *pattern,
+                                  const cfg_oid *oid);
+
+/**
+ * Notify clients that the database is changed: results of read requests
+ * cached by them are no longer valid.
+ */
+extern void cfg_db_changed(void);
+
+/**
+ * Publish the database generation in a file mapped by clients,
+ * so that they may cache results of read requests.
+ *
+ * @param tmp_dir   directory for the file (TE_TMP)
+ *
+ * @return Status code.
+ */
+extern te_errno cfg_db_gen_publish(const char *tmp_dir);
+
+/**
+ * Invalidate the published database generation and remove the file.
+ */
+extern void cfg_db_gen_unpublish(void);
+
 /**
  * Initialize the database during startup or re-initialization.
  *
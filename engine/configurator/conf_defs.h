@@ -59,6 +59,8 @@
 #include "conf_ta.h"
 
 #include "ipc_server.h"
+#include "conf_subscr.h"
+#include "conf_stats.h"
 
 /** Check if the instance is volatile */
 static inline bool
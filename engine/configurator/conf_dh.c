@@ -34,12 +34,34 @@ typedef struct cfg_dh_entry {
     int                  seq;     /**< Sequence number for debugging */
     bool committed; /**< Whether the command kept in this
                                          entry is committed or not */
+    struct cfg_dh_entry *add_below; /**< Pending add command pushed
+                                         before this one (for pending
+                                         add commands) */
+    struct cfg_dh_entry *add_saved; /**< The last pending add command
+                                         when this entry was pushed */
 } cfg_dh_entry;
 
 static cfg_dh_entry *first = NULL;
 static cfg_dh_entry *last = NULL;
 static cfg_backup   *begin_backup = NULL;
 
+/**
+ * The last pending add command. Pending add commands may be cancelled
+ * together with all the following commands by delete command for
+ * the same instance. All commands after a pending add command are
+ * in the subtree of its instance and have no backups attached, so
+ * pending add commands form a stack of nested instances linked by
+ * add_below.
+ */
+static cfg_dh_entry *pending_add = NULL;
+/**
+ * The last command which is delete command for the instance added by
+ * @ref pending_add. Cancellation is postponed until the next history
+ * operation since the delete command may be rolled back by
+ * cfg_dh_delete_last_command().
+ */
+static cfg_dh_entry *pending_del = NULL;
+
 /** Release memory allocated for backup list */
 static inline void
 free_entry_backup(cfg_dh_entry *entry)
@@ -69,6 +91,97 @@ free_dh_entry(cfg_dh_entry *entry)
     free(entry);
 }
 
+/** Get OID of the instance changed by the command or @c NULL */
+static inline const char *
+dh_entry_oid(const cfg_dh_entry *entry)
+{
+    if (entry->cmd->type == CFG_ADD)
+    {
+        return (const char *)(entry->cmd) +
+               ((const cfg_add_msg *)(entry->cmd))->oid_offset;
+    }
+
+    return entry->old_oid;
+}
+
+/** Check whether @p oid is @p root or an instance in its subtree */
+static inline bool
+dh_oid_in_subtree(const char *oid, const char *root)
+{
+    size_t len = strlen(root);
+
+    return strncmp(oid, root, len) == 0 &&
+           (oid[len] == '\0' || oid[len] == '/');
+}
+
+/**
+ * Remove the pending add command and all the following commands
+ * if the last command deletes the added instance.
+ */
+static void
+dh_cancel_pending(void)
+{
+    cfg_dh_entry *tmp;
+    cfg_dh_entry *next;
+
+    if (pending_del == NULL)
+        return;
+
+    assert(pending_del == last && pending_add != NULL);
+
+    tmp = pending_add;
+    pending_add = tmp->add_below;
+    pending_del = NULL;
+
+    last = tmp->prev;
+    if (last != NULL)
+        last->next = NULL;
+    else
+        first = NULL;
+
+    for (; tmp != NULL; tmp = next)
+    {
+        next = tmp->next;
+        VERB("Optimize: delete command %d", tmp->seq);
+        free_dh_entry(tmp);
+    }
+}
+
+/**
+ * Update pending add commands with the command pushed to the history.
+ *
+ * @param entry     the last entry of the history
+ */
+static void
+dh_track_pending(cfg_dh_entry *entry)
+{
+    const char *oid = dh_entry_oid(entry);
+
+    entry->add_saved = pending_add;
+
+    if (oid == NULL)
+    {
+        pending_add = NULL;
+        return;
+    }
+
+    /* Commands out of the subtree stop cancellation of the add command */
+    while (pending_add != NULL &&
+           !dh_oid_in_subtree(oid, dh_entry_oid(pending_add)))
+        pending_add = pending_add->add_below;
+
+    if (entry->cmd->type == CFG_ADD)
+    {
+        entry->add_below = pending_add;
+        pending_add = entry;
+    }
+    else if (entry->cmd->type == CFG_DEL && pending_add != NULL &&
+             strcmp(oid, dh_entry_oid(pending_add)) == 0)
+    {
+        pending_del = entry;
+    }
+}
+
 /**
  * Skip 'comment' nodes.
  *
@@ -1120,6 +1233,11 @@ cfg_dh_attach_backup(char *filename)
         free(tmp);
         return TE_ENOMEM;
     }
+
+    /* Commands before a backup cannot be cancelled */
+    dh_cancel_pending();
+    pending_add = NULL;
+
     if (last == NULL)
     {
         if (begin_backup == NULL)
@@ -1403,6 +1521,7 @@ cfg_dh_restore_backup_ext(char *filename, bool hard_check, bool shutdown)
                         else
                         {
                             inst->remove = false;
+                            cfg_db_changed();
                         }
                     }
                 }
@@ -1425,6 +1544,7 @@ cfg_dh_restore_backup_ext(char *filename, bool hard_check, bool shutdown)
     }
     if (limit == NULL)
         first = NULL;
+    pending_add = NULL;
 
     return result;
 }
@@ -1461,7 +1581,11 @@ cfg_dh_restore_backup_on_shutdown()
 int
 cfg_dh_push_command(cfg_msg *msg, bool local, const cfg_inst_val *old_val)
 {
-    cfg_dh_entry *entry = TE_ALLOC(sizeof(cfg_dh_entry));
+    cfg_dh_entry *entry;
+
+    dh_cancel_pending();
+
+    entry = TE_ALLOC(sizeof(cfg_dh_entry));
 
     entry->cmd = TE_ALLOC(msg->len);
 
@@ -1535,6 +1659,8 @@ cfg_dh_push_command(cfg_msg *msg, bool local, const cfg_inst_val *old_val)
         last = entry;
     }
 
+    dh_track_pending(entry);
+
     VERB("Add command %d", last->seq);
 
     return 0;
@@ -1552,18 +1678,18 @@ cfg_dh_delete_last_command(void)
     if (first == NULL)
         return;
 
+    if (pending_del == tmp)
+        pending_del = NULL;
+    pending_add = tmp->add_saved;
+
     if (first == last)
     {
         first = last = NULL;
     }
     else
     {
-        cfg_dh_entry *prev;
-
-        for (prev = first; prev->next != last; prev = prev->next);
-
-        prev->next = NULL;
-        last = prev;
+        last = tmp->prev;
+        last->next = NULL;
     }
 
     VERB("Delete last command %d", tmp->seq);
@@ -1585,92 +1711,23 @@ cfg_dh_destroy(void)
     }
 
     last = first = NULL;
+    pending_add = pending_del = NULL;
 }
 
 /**
  * Remove useless command sequences.
+ *
+ * Pairs of add and delete commands together with commands in the subtree
+ * of the instance between them are cancelled when they are pushed, so
+ * only the pending cancellation and sequences of set commands are
+ * processed here.
  */
 void
 cfg_dh_optimize(void)
 {
     cfg_dh_entry *tmp;
 
-    /* Optimize add/delete commands */
-    for (tmp = first; tmp != NULL; )
-    {
-        cfg_dh_entry *tmp_del = NULL;
-        char         *oid;
-        bool found = false;
-        unsigned int  len;
-
-        if (tmp->cmd->type != CFG_ADD || tmp->backup != NULL)
-        {
-            tmp = tmp->next;
-            continue;
-        }
-
-        oid = (char *)(tmp->cmd) + ((cfg_add_msg *)(tmp->cmd))->oid_offset;
-        len = strlen(oid);
-
-        /*
-         * Look for delete command for this instance.
-         * If command with backup or reboot command or
-         * command changing the object, which is not in tmp subtree is
-         * met, break the search.
-         */
-         for (tmp_del = tmp->next; tmp_del != NULL; tmp_del = tmp_del->next)
-         {
-             char *tmp_oid;
-
-             if (tmp_del->backup != NULL ||
-                 tmp_del->cmd->type == CFG_REBOOT)
-                 break;
-
-             if (tmp_del->cmd->type == CFG_DEL &&
-                 strcmp(tmp_del->old_oid, oid) == 0)
-             {
-                 found = true;
-                 break;
-             }
-
-             tmp_oid = tmp_del->cmd->type == CFG_ADD ?
-                       (char *)(tmp_del->cmd) +
-                       ((cfg_add_msg *)(tmp_del->cmd))->oid_offset :
-                       tmp_del->old_oid;
-
-             if (tmp_oid == NULL || strlen(tmp_oid) > len ||
-                 strncmp(tmp_oid, oid, len) != 0)
-             {
-                 break;
-             }
-         }
-
-         if (!found)
-         {
-             tmp = tmp->next;
-             continue;
-         }
-
-         /* Now we need to remove [tmp ... tmp_del] commands */
-         if (tmp->prev != NULL)
-             tmp->prev->next = tmp_del->next;
-         else
-             first = tmp_del->next;
-
-         if (tmp_del->next != NULL)
-             tmp_del->next->prev = tmp->prev;
-         else
-             last = tmp->prev;
-
-         tmp_del->next = NULL;
-
-         for (; tmp != NULL; tmp = tmp_del)
-         {
-             tmp_del = tmp->next;
-             VERB("Optimize: delete command %d", tmp->seq);
-             free_dh_entry(tmp);
-         }
-    }
+    dh_cancel_pending();
 
     /* Optimize set commands */
     for (tmp = first; tmp != NULL && tmp->next != NULL; )
@@ -1721,6 +1778,8 @@ cfg_dh_release_after(char *filename)
     if (filename == NULL)
         return;
 
+    dh_cancel_pending();
+
     for (limit = last; limit != NULL; limit = limit->prev)
     {
         if (limit->backup != NULL)
@@ -1741,6 +1800,8 @@ cfg_dh_release_after(char *filename)
     }
     last = limit;
     last->next = NULL;
+    /* The backup attached to the limit stops cancellation */
+    pending_add = NULL;
 }
 
 /**
@@ -2023,6 +2084,8 @@ cfg_dh_restore_agents(const te_vec *ta_list)
     cfg_dh_entry *entry;
     te_errno rc;
 
+    dh_cancel_pending();
+
     for (entry = first; entry != NULL; entry = entry->next)
     {
         switch (entry->cmd->type)
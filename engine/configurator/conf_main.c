@@ -15,6 +15,7 @@
 #endif /* WITH_CONF_YAML */
 #include "conf_rcf.h"
 #include "conf_ipc.h"
+#include "conf_backup_bin.h"
 
 #include <libxml/xinclude.h>
 #include "te_kvpair.h"
@@ -23,6 +24,7 @@
 #include "te_str.h"
 #include "te_string.h"
 #include "te_vector.h"
+#include "te_dbuf.h"
 
 #if HAVE_SIGNAL_H
 #include <signal.h>
@@ -31,6 +33,9 @@
 /** Format for backup file name */
 #define CONF_BACKUP_NAME         "%s/te_cfg_backup_%d_%llu.xml"
 
+/** Format for binary backup file name */
+#define CONF_BIN_BACKUP_NAME     "%s/te_cfg_backup_%d_%llu.bin"
+
 /** Format for backup file name for subtree*/
 #define CONF_SUBTREE_BACKUP_NAME "%s/te_cfg_subree_backup_%d_%llu.xml"
 
@@ -63,6 +68,9 @@ static const char *cs_dirs_cfg = NULL;
 /** Configuration files to processed after main config(s) */
 static char **cs_includes = NULL;
 
+/** Directory to cache results of processing YAML configuration files */
+static const char *cs_conf_cache_dir = NULL;
+
 /** @name Configurator global options */
 #define CS_PRINT_TREES  0x1     /**< Print objects and object instances
                                      trees after initialization */
@@ -70,8 +78,18 @@ static char **cs_includes = NULL;
                                      failed */
 #define CS_FOREGROUND   0x4     /**< Run Configurator in foreground */
 #define CS_SHUTDOWN     0x8     /**< Shutdown after message processing */
+#define CS_BIN_BACKUP   0x10    /**< Create backups in binary format */
+#define CS_ZIP_BACKUP   0x20    /**< Compress binary backups */
+#define CS_OP_STATS     0x40    /**< Log latency statistics of operations
+                                     on shutdown */
 /*@}*/
 
+/**
+ * Maximum number of requests pipelined by a client which are served
+ * in a row without checking other clients.
+ */
+#define CFG_PIPELINE_MAX    64
+
 /** Configurator global flags */
 static unsigned int cs_flags = 0;
 
@@ -937,7 +955,8 @@ process_add(cfg_add_msg *msg, bool update_dh)
     char         *oid = (char *)msg + msg->oid_offset;
     cfg_inst_val  val;
     char         *val_str = "";
-    char         *ta;
+    const char   *ta;
+    uint64_t      start;
 
     if (cfg_avoid_local_cmd_problem("add", oid, (cfg_msg *)msg,
                                     update_dh) != 0)
@@ -1058,7 +1077,9 @@ process_add(cfg_add_msg *msg, bool update_dh)
         }
     }
 
+    start = cfg_stats_now();
     msg->rc = rcf_ta_cfg_add(ta, 0, oid, val_str);
+    cfg_stats_rcf("rcf_add", ta, oid, start);
     if (msg->rc != 0)
     {
         cfg_db_del(handle);
@@ -1197,6 +1218,7 @@ process_set(cfg_set_msg *msg, bool update_dh)
     char         *val_str = NULL;
     cfg_inst_val  val;
     cfg_inst_val  old_val;
+    uint64_t      start;
 
     if ((inst = CFG_GET_INST(handle)) == NULL)
     {
@@ -1322,8 +1344,10 @@ process_set(cfg_set_msg *msg, bool update_dh)
         }
     }
 
+    start = cfg_stats_now();
     msg->rc = rcf_ta_cfg_set(inst->name, 0,
                              CFG_GET_INST(handle)->oid, val_str);
+    cfg_stats_rcf("rcf_set", inst->name, CFG_GET_INST(handle)->oid, start);
 
     if (msg->rc != 0)
     {
@@ -1463,6 +1487,7 @@ process_del(cfg_del_msg *msg, bool update_dh)
             return;
         }
         inst->remove = true;
+        cfg_db_changed();
         return;
     }
 
@@ -1479,11 +1504,14 @@ process_del(cfg_del_msg *msg, bool update_dh)
     if (inst->added)
     {
         cfg_instance *inst_aux = inst;
+        uint64_t      start;
 
         while (inst_aux->father != &cfg_inst_root)
             inst_aux = inst_aux->father;
 
+        start = cfg_stats_now();
         msg->rc = rcf_ta_cfg_del(inst_aux->name, 0, inst->oid);
+        cfg_stats_rcf("rcf_del", inst_aux->name, inst->oid, start);
 
         if (msg->rc == 0)
         {
@@ -1578,6 +1606,8 @@ process_get(cfg_get_msg *msg)
 
     msg->val_type = obj->type;
     msg->len = sizeof(*msg);
+    /* Volatile values are synchronized with the TA on every get */
+    msg->cacheable = !obj->vol;
 
     /*
      * Some instances have a substitution in its values.
@@ -1594,6 +1624,361 @@ process_get(cfg_get_msg *msg)
     cfg_types[obj->type].free(val);
 }
 
+/**
+ * Check whether a request may be a sub-message of CFG_BATCH message.
+ *
+ * @param type          message type
+ * @param atomic        whether the batch is atomic
+ *
+ * @return @c true if the request is allowed.
+ */
+static bool
+batch_req_allowed(uint8_t type, bool atomic)
+{
+    switch (type)
+    {
+        case CFG_FIND:
+        case CFG_GET_DESCR:
+        case CFG_GET_OID:
+        case CFG_GET_ID:
+        case CFG_FAMILY:
+        case CFG_GET:
+        case CFG_SET:
+            return true;
+
+        case CFG_ADD:
+        case CFG_DEL:
+            /* Only values are restored on failure of an atomic batch */
+            return !atomic;
+
+        default:
+            return false;
+    }
+}
+
+/**
+ * Get location of the input handle of a request.
+ *
+ * @param msg           message pointer
+ *
+ * @return Location of the handle or @c NULL if the request has no
+ *         input handle.
+ */
+static cfg_handle *
+batch_req_handle(cfg_msg *msg)
+{
+    switch (msg->type)
+    {
+        case CFG_GET_DESCR:
+            return &((cfg_get_descr_msg *)msg)->handle;
+        case CFG_GET_OID:
+            return &((cfg_get_oid_msg *)msg)->handle;
+        case CFG_GET_ID:
+            return &((cfg_get_id_msg *)msg)->handle;
+        case CFG_FAMILY:
+            return &((cfg_family_msg *)msg)->handle;
+        case CFG_GET:
+            return &((cfg_get_msg *)msg)->handle;
+        case CFG_SET:
+            return &((cfg_set_msg *)msg)->handle;
+        case CFG_DEL:
+            return &((cfg_del_msg *)msg)->handle;
+        default:
+            return NULL;
+    }
+}
+
+/**
+ * Get handle returned in the answer to a request.
+ *
+ * @param msg           answer pointer
+ * @param handle        location for the handle
+ *
+ * @return @c true if the request returns a handle.
+ */
+static bool
+batch_ans_handle(const cfg_msg *msg, cfg_handle *handle)
+{
+    switch (msg->type)
+    {
+        case CFG_FIND:
+            *handle = ((const cfg_find_msg *)msg)->handle;
+            return true;
+        case CFG_ADD:
+            *handle = ((const cfg_add_msg *)msg)->handle;
+            return true;
+        case CFG_FAMILY:
+            *handle = ((const cfg_family_msg *)msg)->handle;
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * Prepare a set request which restores the current value of an instance.
+ *
+ * @param set           set request to be processed
+ *
+ * @return Allocated request or @c NULL if the instance does not exist.
+ */
+static cfg_set_msg *
+batch_mk_undo(const cfg_set_msg *set)
+{
+    cfg_instance *inst = CFG_GET_INST(set->handle);
+    cfg_set_msg  *undo;
+    size_t        size;
+
+    if (inst == NULL || inst->obj->type != set->val_type)
+        return NULL;
+
+    size = sizeof(*undo) + cfg_types[inst->obj->type].value_size(inst->val);
+    undo = TE_ALLOC(size);
+    if (cfg_ipc_mk_set(undo, size, set->handle, set->local,
+                       inst->obj->type, inst->val) != 0)
+    {
+        free(undo);
+        return NULL;
+    }
+
+    return undo;
+}
+
+/**
+ * Process a batch of user requests.
+ *
+ * @param msg           location of message pointer (it is replaced
+ *                      with an allocated answer)
+ * @param update_dh     if @c true, add commands to dynamic history
+ */
+static void
+process_batch(cfg_batch_msg **msg, bool update_dh)
+{
+    cfg_batch_msg *req = *msg;
+    cfg_batch_msg *ans;
+    cfg_msg       *sub;
+    cfg_msg       *scratch;
+    cfg_msg       *result;
+    cfg_handle    *handle;
+    cfg_handle     found;
+    cfg_handle     prev_handle = CFG_HANDLE_INVALID;
+    te_errno       prev_rc = TE_RC(TE_CS, TE_EINVAL);
+    te_errno       rc = 0;
+    uint8_t       *end = (uint8_t *)req + req->len;
+    uint32_t       i;
+
+    te_dbuf        answer = TE_DBUF_INIT(TE_DBUF_DEFAULT_GROW_FACTOR);
+    te_vec         undo = TE_VEC_INIT(cfg_set_msg *);
+    cfg_set_msg  **undo_msg;
+
+    /* Validate the batch before anything is changed */
+    for (i = 0, sub = CFG_BATCH_FIRST(req); i < req->num;
+         i++, sub = CFG_BATCH_NEXT(sub))
+    {
+        if ((uint8_t *)sub + sizeof(*sub) > end ||
+            sub->len < sizeof(*sub) || sub->len > CFG_BUF_LEN ||
+            (uint8_t *)sub + sub->len > end)
+        {
+            ERROR("Malformed batch of requests");
+            break;
+        }
+
+        if (!batch_req_allowed(sub->type, req->atomic))
+        {
+            ERROR("Request of type %u is not allowed in %sbatch",
+                  sub->type, req->atomic ? "atomic " : "");
+            break;
+        }
+    }
+    if (i < req->num)
+    {
+        /* Nothing is processed, so no answers are sent back */
+        req->rc = TE_EINVAL;
+        req->num = 0;
+        req->len = sizeof(*req);
+        return;
+    }
+
+    scratch = TE_ALLOC(CFG_BUF_LEN);
+    te_dbuf_append(&answer, req, sizeof(*req));
+    te_dbuf_append(&answer, NULL,
+                   TE_ALIGN(sizeof(*req), CFG_BATCH_ALIGN) - sizeof(*req));
+
+    for (i = 0, sub = CFG_BATCH_FIRST(req); i < req->num;
+         i++, sub = CFG_BATCH_NEXT(sub))
+    {
+        memcpy(scratch, sub, sub->len);
+        result = scratch;
+
+        handle = batch_req_handle(result);
+        if (handle != NULL && *handle == CFG_HANDLE_INVALID &&
+            prev_rc != 0)
+        {
+            /*
+             * The instance is not found by the previous request; this
+             * is checked first to report why an atomic batch failed.
+             */
+            result->rc = prev_rc;
+        }
+        else if (rc != 0)
+        {
+            result->rc = TE_RC(TE_CS, TE_ECANCELED);
+        }
+        else
+        {
+            if (handle != NULL && *handle == CFG_HANDLE_INVALID)
+                *handle = prev_handle;
+
+            if (req->atomic && result->type == CFG_SET)
+            {
+                cfg_set_msg *undo_set = batch_mk_undo((cfg_set_msg *)result);
+
+                if (undo_set != NULL)
+                    TE_VEC_APPEND(&undo, undo_set);
+            }
+
+            result->rc = 0;
+            cfg_process_msg(&result, update_dh);
+
+            if (req->atomic && result->rc != 0)
+                rc = result->rc;
+        }
+
+        if (batch_ans_handle(result, &found))
+        {
+            prev_rc = result->rc;
+            prev_handle = (prev_rc == 0) ? found : CFG_HANDLE_INVALID;
+        }
+
+        te_dbuf_append(&answer, result, result->len);
+        te_dbuf_append(&answer, NULL,
+                       TE_ALIGN(result->len, CFG_BATCH_ALIGN) - result->len);
+        if (result != scratch)
+            free(result);
+    }
+
+    if (rc != 0)
+    {
+        /* Restore values in the reverse order */
+        for (i = te_vec_size(&undo); i > 0; i--)
+        {
+            result = (cfg_msg *)TE_VEC_GET(cfg_set_msg *, &undo, i - 1);
+            cfg_process_msg(&result, update_dh);
+            if (result->rc != 0)
+            {
+                ERROR("Failed to restore value of %s: %r",
+                      CFG_GET_INST(((cfg_set_msg *)result)->handle) == NULL ?
+                      "unknown instance" :
+                      CFG_GET_INST(((cfg_set_msg *)result)->handle)->oid,
+                      result->rc);
+            }
+        }
+    }
+    TE_VEC_FOREACH(&undo, undo_msg)
+        free(*undo_msg);
+    te_vec_free(&undo);
+    free(scratch);
+
+    ans = (cfg_batch_msg *)answer.ptr;
+    ans->len = answer.len;
+    ans->rc = rc;
+    *msg = ans;
+}
+
+/**
+ * Process get subtree user request.
+ *
+ * @param msg           location of message pointer (it is replaced
+ *                      with an allocated answer on success)
+ */
+static void
+process_get_subtree(cfg_get_subtree_msg **msg)
+{
+    cfg_get_subtree_msg *req = *msg;
+    cfg_batch_msg       *ans;
+    cfg_instance        *inst;
+    cfg_handle           root;
+    cfg_handle          *handle;
+    cfg_msg             *result;
+    te_errno             rc;
+
+    te_dbuf              answer = TE_DBUF_INIT(TE_DBUF_DEFAULT_GROW_FACTOR);
+    te_vec               handles = TE_VEC_INIT(cfg_handle);
+    cfg_batch_msg        header;
+
+    rc = cfg_db_find(req->oid, &root);
+    if (rc != 0)
+    {
+        req->rc = rc;
+        return;
+    }
+
+    /*
+     * Handles are collected first since values of volatile instances
+     * are synchronized on get and the tree may be changed.
+     */
+    TE_VEC_APPEND(&handles, root);
+    for (inst = CFG_GET_INST(root)->son; inst != NULL; )
+    {
+        TE_VEC_APPEND(&handles, inst->handle);
+        if (inst->son != NULL)
+        {
+            inst = inst->son;
+            continue;
+        }
+        while (inst->brother == NULL && inst->father->handle != root)
+            inst = inst->father;
+        inst = inst->brother;
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.type = req->type;
+    te_dbuf_append(&answer, &header, sizeof(header));
+    te_dbuf_append(&answer, NULL,
+                   TE_ALIGN(sizeof(header), CFG_BATCH_ALIGN) - sizeof(header));
+
+    result = TE_ALLOC(CFG_BUF_LEN);
+    TE_VEC_FOREACH(&handles, handle)
+    {
+        cfg_get_oid_msg *oid_msg = (cfg_get_oid_msg *)result;
+        size_t           oid_start = answer.len;
+
+        if (CFG_GET_INST(*handle) == NULL)
+            continue;
+
+        memset(oid_msg, 0, sizeof(*oid_msg));
+        oid_msg->type = CFG_GET_OID;
+        oid_msg->handle = *handle;
+        cfg_process_msg_get_oid(oid_msg);
+        te_dbuf_append(&answer, oid_msg, oid_msg->len);
+        te_dbuf_append(&answer, NULL,
+                       TE_ALIGN(oid_msg->len, CFG_BATCH_ALIGN) -
+                       oid_msg->len);
+
+        (void)cfg_ipc_mk_get((cfg_get_msg *)result, CFG_BUF_LEN, *handle,
+                             false);
+        process_get((cfg_get_msg *)result);
+        if (TE_RC_GET_ERROR(result->rc) == TE_ENOENT)
+        {
+            /* The instance is removed on synchronization */
+            te_dbuf_cut(&answer, oid_start, answer.len - oid_start);
+            continue;
+        }
+        result->rc = TE_RC(TE_CS, result->rc);
+        te_dbuf_append(&answer, result, result->len);
+        te_dbuf_append(&answer, NULL,
+                       TE_ALIGN(result->len, CFG_BATCH_ALIGN) - result->len);
+
+        ((cfg_batch_msg *)answer.ptr)->num += 2;
+    }
+    free(result);
+    te_vec_free(&handles);
+
+    ans = (cfg_batch_msg *)answer.ptr;
+    ans->len = answer.len;
+    *msg = (cfg_get_subtree_msg *)ans;
+}
+
 /* Returns time since Epoche in milliseconds */
 static unsigned long long
 get_time_ms(void)
@@ -1634,6 +2019,12 @@ log_msg(cfg_msg *msg, bool before)
         level = TE_LL_VERB;
         addon = " local sequence started";
     }
+    else if (msg->type == CFG_WAIT_EVENTS &&
+             msg->rc == TE_RC(TE_CS, TE_ETIMEDOUT))
+    {
+        level = TE_LL_VERB;
+        addon = " no changes";
+    }
     else if (msg->rc == TE_RC(TE_RCF_PCH, TE_EPERM))
     {
         level = TE_LL_WARN;
@@ -1934,6 +2325,51 @@ log_msg(cfg_msg *msg, bool before)
             cfg_db_tree_print_msg_log((cfg_tree_print_msg *)msg, level);
             break;
 
+        case CFG_BATCH:
+            LOG_MSG(level, "Batch of %u requests%s%s",
+                    ((cfg_batch_msg *)msg)->num,
+                    ((cfg_batch_msg *)msg)->atomic ? " (atomic)" : "", addon);
+            break;
+
+        case CFG_GET_SUBTREE:
+            if (before || msg->rc != 0)
+            {
+                /*
+                 * After successful processing the request is replaced
+                 * with the answer which does not contain the OID.
+                 */
+                LOG_MSG(level, "Get subtree %s%s",
+                        ((cfg_get_subtree_msg *)msg)->oid, addon);
+            }
+            break;
+
+        case CFG_SUBSCRIBE:
+            if (before || msg->rc != 0)
+            {
+                LOG_MSG(level, "Subscribe to changes of %s%s",
+                        ((cfg_subscribe_msg *)msg)->pattern, addon);
+            }
+            else
+            {
+                LOG_MSG(level, "Subscription %u is created%s",
+                        ((cfg_subscribe_msg *)msg)->id, addon);
+            }
+            break;
+
+        case CFG_UNSUBSCRIBE:
+            LOG_MSG(level, "Cancel subscription %u%s",
+                    ((cfg_unsubscribe_msg *)msg)->id, addon);
+            break;
+
+        case CFG_WAIT_EVENTS:
+            LOG_MSG(level, "Wait for changes of subscription %u%s",
+                    ((cfg_wait_events_msg *)msg)->id, addon);
+            break;
+
+        case CFG_OP_STATS:
+            LOG_MSG(level, "Operation statistics request%s", addon);
+            break;
+
         default:
             ERROR("Unknown command %x", msg->type);
     }
@@ -1957,14 +2393,24 @@ verify_backup(const char *backup, bool log, const char *msg,
     char diff_file[RCF_MAX_PATH];
     int  rc;
 
-    if ((rc = cfg_backup_create_file(filename, subtrees)) != 0)
-        return rc;
-
     TE_SPRINTF(diff_file, "%s/te_cs.diff", getenv("TE_TMP"));
-    sprintf(tmp_buf, "diff -u %s %s >%s 2>&1", backup,
-            filename, diff_file);
 
-    rc = ((system(tmp_buf) == 0) ? 0 : TE_EBACKUP);
+    if (cfg_bkp_is_bin_file(backup))
+    {
+        rc = cfg_backup_verify_bin_file(backup, subtrees, diff_file);
+        if (rc != 0 && rc != TE_EBACKUP)
+            return rc;
+    }
+    else
+    {
+        if ((rc = cfg_backup_create_file(filename, subtrees)) != 0)
+            return rc;
+
+        sprintf(tmp_buf, "diff -u %s %s >%s 2>&1", backup,
+                filename, diff_file);
+
+        rc = ((system(tmp_buf) == 0) ? 0 : TE_EBACKUP);
+    }
     if (rc != 0)
     {
         if (msg != NULL)
@@ -2075,7 +2521,9 @@ filter_backup_by_subtrees(const char *current_backup, const te_vec *subtrees,
     te_string filter_filename = TE_STRING_INIT;
     te_errno rc;
 
-    if (subtrees == NULL || te_vec_size(subtrees) == 0)
+    /* Binary backups are filtered when they are processed */
+    if (subtrees == NULL || te_vec_size(subtrees) == 0 ||
+        cfg_bkp_is_bin_file(current_backup))
     {
         te_string_append(target_backup, "%s", current_backup);
         return 0;
@@ -2288,14 +2736,23 @@ process_backup(cfg_backup_msg *msg, bool release_dh)
     {
         case CFG_BACKUP_CREATE:
         {
-            sprintf(backup_filename, CONF_BACKUP_NAME,
-                    tmp_dir, getpid(), get_time_ms());
-
-            if ((msg->rc = cfg_backup_create_file(backup_filename,
-                                                  &subtrees_vec)) != 0)
+            if (cs_flags & CS_BIN_BACKUP)
             {
-                break;;
+                sprintf(backup_filename, CONF_BIN_BACKUP_NAME,
+                        tmp_dir, getpid(), get_time_ms());
+                msg->rc = cfg_backup_create_bin_file(backup_filename,
+                                                     &subtrees_vec,
+                                                     cs_flags & CS_ZIP_BACKUP);
             }
+            else
+            {
+                sprintf(backup_filename, CONF_BACKUP_NAME,
+                        tmp_dir, getpid(), get_time_ms());
+                msg->rc = cfg_backup_create_file(backup_filename,
+                                                 &subtrees_vec);
+            }
+            if (msg->rc != 0)
+                break;
 
             if ((msg->rc = cfg_dh_attach_backup(backup_filename)) != 0)
                 unlink(backup_filename);
@@ -2360,7 +2817,16 @@ process_backup(cfg_backup_msg *msg, bool release_dh)
                 break;
             }
 
-            msg->rc = parse_config_xml(backup.ptr, NULL, false, &subtrees_vec);
+            if (cfg_bkp_is_bin_file(backup.ptr))
+            {
+                msg->rc = cfg_backup_process_bin_file(backup.ptr,
+                                                      &subtrees_vec);
+            }
+            else
+            {
+                msg->rc = parse_config_xml(backup.ptr, NULL, false,
+                                           &subtrees_vec);
+            }
             rcf_log_cfg_changes(false);
 
             if (release_dh)
@@ -2622,6 +3088,9 @@ process_register(cfg_register_msg *msg, bool update_dh)
 void
 cfg_process_msg(cfg_msg **msg, bool update_dh)
 {
+    cfg_stats_entry *stats = cfg_stats_msg_entry(*msg);
+    uint64_t         start = cfg_stats_now();
+
     log_msg(*msg, true);
 
     switch ((*msg)->type)
@@ -2773,6 +3242,8 @@ cfg_process_msg(cfg_msg **msg, bool update_dh)
             rcf_log_cfg_changes(true);
             cfg_dh_restore_backup_on_shutdown();
             rcf_log_cfg_changes(false);
+            if (cs_flags & CS_OP_STATS)
+                cfg_stats_log();
             cs_flags |= CS_SHUTDOWN;
             break;
 
@@ -2780,6 +3251,36 @@ cfg_process_msg(cfg_msg **msg, bool update_dh)
             cfg_process_msg_tree_print((cfg_tree_print_msg *)*msg);
             break;
 
+        case CFG_BATCH:
+            process_batch((cfg_batch_msg **)msg, update_dh);
+            break;
+
+        case CFG_GET_SUBTREE:
+            /* Synchronize /agent/volatile subtree if necessary */
+            if (cfg_sync_agt_volatile(*msg,
+                                      ((cfg_get_subtree_msg *)*msg)->oid) != 0)
+            {
+                break;
+            }
+            process_get_subtree((cfg_get_subtree_msg **)msg);
+            break;
+
+        case CFG_SUBSCRIBE:
+            cfg_subscr_process_subscribe((cfg_subscribe_msg *)*msg);
+            break;
+
+        case CFG_UNSUBSCRIBE:
+            cfg_subscr_process_unsubscribe((cfg_unsubscribe_msg *)*msg);
+            break;
+
+        case CFG_WAIT_EVENTS:
+            cfg_subscr_process_wait((cfg_wait_events_msg **)msg);
+            break;
+
+        case CFG_OP_STATS:
+            cfg_stats_process_msg((cfg_op_stats_msg **)msg);
+            break;
+
         default: /* Should not occur */
             ERROR("Unknown message is received");
             break;
@@ -2788,6 +3289,8 @@ cfg_process_msg(cfg_msg **msg, bool update_dh)
     (*msg)->rc = TE_RC(TE_CS, (*msg)->rc);
 
     log_msg(*msg, false);
+
+    cfg_stats_add(stats, start);
 }
 
 /**
@@ -2799,8 +3302,15 @@ free_resources(void)
     VERB("Destroy history");
     cfg_dh_destroy();
 
+    VERB("Destroy subscriptions");
+    cfg_subscr_destroy();
+
+    VERB("Destroy operation statistics");
+    cfg_stats_destroy();
+
     VERB("Destroy database");
     cfg_db_destroy();
+    cfg_db_gen_unpublish();
 
     VERB("Free resources");
     free(cfg_get_buf);
@@ -2847,6 +3357,17 @@ process_cmd_line_opts(int argc, char **argv)
           CS_FOREGROUND,
           "Run in foreground (useful for debugging).", NULL },
 
+        { "binary-backups", '\0', POPT_ARG_NONE | POPT_BIT_SET, &cs_flags,
+          CS_BIN_BACKUP, "Create backups in compact binary format.", NULL },
+
+        { "compress-backups", '\0', POPT_ARG_NONE | POPT_BIT_SET,
+          &cs_flags, CS_ZIP_BACKUP,
+          "Compress binary backups (if built with zlib).", NULL },
+
+        { "op-stats", '\0', POPT_ARG_NONE | POPT_BIT_SET, &cs_flags,
+          CS_OP_STATS, "Log latency statistics of operations "
+          "as MI artifact on shutdown.", NULL },
+
         { "sniff-conf", '\0', POPT_ARG_STRING, &cs_sniff_cfg_file, 0,
           "Auxiliary conf file for the sniffer framework.", NULL },
 
@@ -2857,6 +3378,10 @@ process_cmd_line_opts(int argc, char **argv)
         { "include", '\0', POPT_ARG_ARGV, &cs_includes, 0,
           "Configuration file to be processed after main config(s).", NULL },
 
+        { "conf-cache", '\0', POPT_ARG_STRING, &cs_conf_cache_dir, 0,
+          "Directory to cache results of processing YAML configuration "
+          "files in.", NULL },
+
         POPT_AUTOHELP
         POPT_TABLEEND
     };
@@ -2877,6 +3402,11 @@ process_cmd_line_opts(int argc, char **argv)
         return EXIT_FAILURE;
     }
 
+#if !WITH_ZLIB
+    if (cs_flags & CS_ZIP_BACKUP)
+        WARN("Configurator is built without zlib, backups are not compressed");
+#endif
+
     cfgs = poptGetArg(optCon);
     if (cfgs == NULL)
     {
@@ -2980,13 +3510,94 @@ parse_config(const char *fname, te_kvpair_h *expand_vars)
         return parse_config_xml(fname, expand_vars, true, NULL);
 #if WITH_CONF_YAML
     else if (strcmp(str, "---") == 0)
-        return parse_config_yaml(fname, expand_vars, NULL, cs_dirs_cfg);
+        return parse_config_yaml(fname, expand_vars, cs_dirs_cfg,
+                                 cs_conf_cache_dir);
 #endif /* !WITH_CONF_YAML */
 
     ERROR("Failed to recognise the format of configuration file '%s'", fname);
     return TE_RC(TE_CS, TE_EOPNOTSUPP);
 }
 
+/**
+ * Receive a request from a user, process it and send the answer.
+ *
+ * @param user          location of the user to receive the request from
+ *                      or @c NULL to receive from any user (updated
+ *                      with the user the request is received from)
+ *
+ * @return Status code.
+ */
+static te_errno
+serve_request(struct ipc_server_client **user)
+{
+    cfg_msg  *msg = (cfg_msg *)buf;
+    cfg_msg  *req = msg;
+    size_t    len = CFG_BUF_LEN;
+    bool      deferred = false;
+    te_errno  rc;
+
+    rc = ipc_receive_message(server, buf, &len, user);
+    if (TE_RC_GET_ERROR(rc) == TE_ESMALLBUF)
+    {
+        /* Batches of requests may be longer than the buffer */
+        size_t rest = len;
+
+        req = TE_ALLOC(CFG_BUF_LEN + rest);
+        memcpy(req, buf, CFG_BUF_LEN);
+        rc = ipc_receive_message(server, (char *)req + CFG_BUF_LEN,
+                                 &rest, user);
+        msg = req;
+    }
+    if (rc != 0)
+    {
+        ERROR("Failed receive user request: errno=%r", rc);
+        if ((char *)req != buf)
+            free(req);
+        return rc;
+    }
+
+    if (cs_inconsistency_state && msg->type != CFG_SHUTDOWN)
+    {
+        ERROR("Configurator is in inconsistent state");
+        msg->rc = TE_RC(TE_CS, TE_EFAULT);
+    }
+    else if (msg->len > CFG_BUF_LEN && msg->type != CFG_BATCH)
+    {
+        ERROR("Too long request of type %u", msg->type);
+        msg->rc = TE_RC(TE_CS, TE_EMSGSIZE);
+        msg->len = sizeof(*msg);
+    }
+    else if (msg->type == CFG_WAIT_EVENTS &&
+             cfg_subscr_defer_wait((cfg_wait_events_msg *)msg, *user))
+    {
+        /* The answer is sent by cfg_subscr_dispatch() */
+        deferred = true;
+    }
+    else
+    {
+        msg->rc = 0;
+        cfg_process_msg(&msg, true);
+        if (msg->type == CFG_SUBSCRIBE && msg->rc == 0)
+            cfg_subscr_set_owner(((cfg_subscribe_msg *)msg)->id, *user);
+    }
+
+    if (!deferred)
+    {
+        rc = ipc_send_answer(server, *user, (char *)msg, msg->len);
+        if (rc != 0)
+        {
+            ERROR("Cannot send an answer to user: errno=%r", rc);
+        }
+    }
+
+    if ((char *)msg != buf && msg != req)
+        free(msg);
+    if ((char *)req != buf)
+        free(req);
+
+    return rc;
+}
+
 /**
  * Main loop of the Configurator: initialization and processing user
  * requests.
@@ -3043,6 +3654,9 @@ main(int argc, char **argv)
     filename = TE_ALLOC(strlen(tmp_dir) + strlen("/te_cfg_tmp.xml") + 1);
     sprintf(filename, "%s/te_cfg_tmp.xml", tmp_dir);
 
+    /* Clients work without caching if the generation is not published */
+    (void)cfg_db_gen_publish(tmp_dir);
+
     if ((rc = cfg_db_init()) != 0)
     {
         ERROR("Fatal error: cannot initialize database");
@@ -3120,35 +3734,46 @@ main(int argc, char **argv)
     while (true)
     {
         struct ipc_server_client *user = NULL;
+        struct timeval            tv;
+        fd_set                    set;
+        int                       select_rc;
+        unsigned int              served;
 
-        cfg_msg *msg = (cfg_msg *)buf;
-        size_t   len = CFG_BUF_LEN;
-
-        if ((rc = ipc_receive_message(server, buf, &len, &user)) != 0)
-        {
-            ERROR("Failed receive user request: errno=%r", rc);
+        /*
+         * Send answers to subscribers which are ready and wait for
+         * a request no longer than the nearest answer deadline.
+         */
+        cfg_subscr_dispatch(server);
+
+        FD_ZERO(&set);
+        (void)ipc_get_server_fds(server, &set);
+        select_rc = select(FD_SETSIZE, &set, NULL, NULL,
+                           cfg_subscr_timeout(&tv));
+        if (select_rc < 0 && errno != EINTR)
+            ERROR("Unexpected failure of select(): errno=%d", errno);
+        if (select_rc <= 0 || !ipc_is_server_ready(server, &set, FD_SETSIZE))
             continue;
-        }
-
-        if (cs_inconsistency_state && msg->type != CFG_SHUTDOWN)
-        {
-            ERROR("Configurator is in inconsistent state");
-            msg->rc = TE_RC(TE_CS, TE_EFAULT);
-        }
-        else
-        {
-            msg->rc = 0;
-            cfg_process_msg(&msg, true);
-        }
 
-        rc = ipc_send_answer(server, user, (char *)msg, msg->len);
-        if (rc != 0)
-        {
-            ERROR("Cannot send an answer to user: errno=%r", rc);
-        }
+        /*
+         * New connection is accepted here since receiving of a request
+         * would wait for a message from the new client ignoring
+         * deadlines of subscribers.
+         */
+        ipc_server_accept(server);
+        if (!ipc_server_clients_ready(server))
+            continue;
 
-        if ((char *)msg != buf)
-            free(msg);
+        /*
+         * Requests pipelined by the client are served without returning
+         * to select(), other clients get their turn after
+         * CFG_PIPELINE_MAX requests.
+         */
+        served = 0;
+        do {
+            rc = serve_request(&user);
+        } while (rc == 0 && !(cs_flags & CS_SHUTDOWN) &&
+                 ++served < CFG_PIPELINE_MAX &&
+                 ipc_server_client_has_data(server, user));
 
         if (cs_flags & CS_SHUTDOWN)
         {
@@ -0,0 +1,482 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/** @file
+ * @brief Configurator
+ *
+ * Latency statistics of operations
+ *
+ * Copyright (C) 2004-2023 OKTET Labs Ltd. All rights reserved.
+ */
+
+#include "conf_defs.h"
+#include "te_alloc.h"
+#include "te_dbuf.h"
+#include "te_enum.h"
+#include "te_string.h"
+#include "te_mi_log.h"
+
+/** Number of chains in the hash table of statistics entries */
+#define CFG_STATS_HASH_SIZE     1024
+
+/** Statistics of an operation applied to an object */
+struct cfg_stats_entry {
+    cfg_stats_entry    *next;       /**< Next entry in the hash chain */
+    const char         *op;         /**< Operation name (not allocated) */
+    char               *ta;         /**< Test Agent name or empty string */
+    char               *obj;        /**< Object identifier or empty
+                                         string */
+    uint64_t            count;      /**< Number of operations */
+    uint64_t            sum_ns;     /**< Total time of operations */
+    uint64_t            min_ns;     /**< Minimum time of an operation */
+    uint64_t            max_ns;     /**< Maximum time of an operation */
+    uint64_t            hist[CFG_OP_STATS_BUCKETS]; /**< Histogram */
+};
+
+/** Hash table of statistics entries */
+static cfg_stats_entry *cfg_stats_hash[CFG_STATS_HASH_SIZE];
+
+/** Names of operations corresponding to request types */
+static const te_enum_map cfg_stats_msg_ops[] = {
+    { .name = "register",       .value = CFG_REGISTER },
+    { .name = "unregister",     .value = CFG_UNREGISTER },
+    { .name = "find",           .value = CFG_FIND },
+    { .name = "get_descr",      .value = CFG_GET_DESCR },
+    { .name = "get_oid",        .value = CFG_GET_OID },
+    { .name = "get_id",         .value = CFG_GET_ID },
+    { .name = "pattern",        .value = CFG_PATTERN },
+    { .name = "family",         .value = CFG_FAMILY },
+    { .name = "add",            .value = CFG_ADD },
+    { .name = "del",            .value = CFG_DEL },
+    { .name = "set",            .value = CFG_SET },
+    { .name = "commit",         .value = CFG_COMMIT },
+    { .name = "get",            .value = CFG_GET },
+    { .name = "copy",           .value = CFG_COPY },
+    { .name = "sync",           .value = CFG_SYNC },
+    { .name = "reboot",         .value = CFG_REBOOT },
+    { .name = "backup",         .value = CFG_BACKUP },
+    { .name = "config",         .value = CFG_CONFIG },
+    { .name = "conf_touch",     .value = CFG_CONF_TOUCH },
+    { .name = "conf_delay",     .value = CFG_CONF_DELAY },
+    { .name = "shutdown",       .value = CFG_SHUTDOWN },
+    { .name = "add_dependency", .value = CFG_ADD_DEPENDENCY },
+    { .name = "tree_print",     .value = CFG_TREE_PRINT },
+    { .name = "process_history", .value = CFG_PROCESS_HISTORY },
+    { .name = "batch",          .value = CFG_BATCH },
+    { .name = "get_subtree",    .value = CFG_GET_SUBTREE },
+    { .name = "subscribe",      .value = CFG_SUBSCRIBE },
+    { .name = "unsubscribe",    .value = CFG_UNSUBSCRIBE },
+    { .name = "wait_events",    .value = CFG_WAIT_EVENTS },
+    { .name = "op_stats",       .value = CFG_OP_STATS },
+    TE_ENUM_MAP_END
+};
+
+/* See the description in conf_stats.h */
+uint64_t
+cfg_stats_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* Hash of the string continuing the hash @p hash (FNV-1a) */
+static uint32_t
+cfg_stats_hash_str(uint32_t hash, const char *str)
+{
+    do {
+        hash ^= (uint8_t)*str;
+        hash *= 16777619;
+    } while (*str++ != '\0');
+
+    return hash;
+}
+
+/**
+ * Convert an instance identifier or a pattern to the identifier of
+ * the object. Object identifiers are returned as is.
+ *
+ * @param oid           identifier
+ * @param max_len       maximum length of the identifier
+ *
+ * @return Object identifier in a static buffer.
+ */
+static const char *
+cfg_stats_obj_oid(const char *oid, size_t max_len)
+{
+    static char obj[CFG_OID_MAX];
+
+    char   *p = obj;
+    bool    name = false;
+    size_t  i;
+
+    for (i = 0; i < max_len && oid[i] != '\0' &&
+                p < obj + sizeof(obj) - 1; i++)
+    {
+        if (oid[i] == '/')
+            name = false;
+        else if (oid[i] == ':')
+            name = true;
+
+        if (!name)
+            *p++ = oid[i];
+    }
+    *p = '\0';
+
+    return obj;
+}
+
+/* Get object identifier of a handle or empty string if it is unknown */
+static const char *
+cfg_stats_handle_obj(cfg_handle handle)
+{
+    cfg_instance *inst;
+    cfg_object   *obj;
+
+    if (CFG_IS_INST(handle))
+    {
+        inst = CFG_GET_INST(handle);
+        return inst == NULL ? "" : inst->obj->oid;
+    }
+
+    obj = CFG_GET_OBJ(handle);
+    return obj == NULL ? "" : obj->oid;
+}
+
+/**
+ * Find statistics entry and create it if it does not exist.
+ *
+ * @param op            operation name (it is not copied)
+ * @param ta            Test Agent name or empty string
+ * @param obj           object identifier or empty string
+ *
+ * @return Statistics entry.
+ */
+static cfg_stats_entry *
+cfg_stats_lookup(const char *op, const char *ta, const char *obj)
+{
+    uint32_t         hash = 2166136261;
+    cfg_stats_entry *entry;
+
+    hash = cfg_stats_hash_str(hash, op);
+    hash = cfg_stats_hash_str(hash, ta);
+    hash = cfg_stats_hash_str(hash, obj);
+    hash %= CFG_STATS_HASH_SIZE;
+
+    for (entry = cfg_stats_hash[hash]; entry != NULL; entry = entry->next)
+    {
+        if (strcmp(entry->op, op) == 0 && strcmp(entry->ta, ta) == 0 &&
+            strcmp(entry->obj, obj) == 0)
+            return entry;
+    }
+
+    entry = TE_ALLOC(sizeof(*entry));
+    entry->op = op;
+    entry->ta = TE_STRDUP(ta);
+    entry->obj = TE_STRDUP(obj);
+    entry->min_ns = UINT64_MAX;
+    entry->next = cfg_stats_hash[hash];
+    cfg_stats_hash[hash] = entry;
+
+    return entry;
+}
+
+/** Get object identifier from a string field of a request */
+#define CFG_STATS_MSG_OID(_type, _field) \
+    cfg_stats_obj_oid(((const _type *)msg)->_field,                 \
+                      msg->len > offsetof(_type, _field) ?          \
+                      msg->len - offsetof(_type, _field) : 0)
+
+/* See the description in conf_stats.h */
+cfg_stats_entry *
+cfg_stats_msg_entry(const cfg_msg *msg)
+{
+    const char *op = te_enum_map_from_any_value(cfg_stats_msg_ops,
+                                                msg->type, "unknown");
+    const char *obj = "";
+
+    switch (msg->type)
+    {
+        case CFG_FIND:
+            obj = CFG_STATS_MSG_OID(cfg_find_msg, oid);
+            break;
+
+        case CFG_PATTERN:
+            obj = CFG_STATS_MSG_OID(cfg_pattern_msg, pattern);
+            break;
+
+        case CFG_ADD:
+        {
+            const cfg_add_msg *add = (const cfg_add_msg *)msg;
+
+            if (add->oid_offset < msg->len)
+            {
+                obj = cfg_stats_obj_oid((const char *)msg + add->oid_offset,
+                                        msg->len - add->oid_offset);
+            }
+            break;
+        }
+
+        case CFG_COMMIT:
+            obj = CFG_STATS_MSG_OID(cfg_commit_msg, oid);
+            break;
+
+        case CFG_SYNC:
+            obj = CFG_STATS_MSG_OID(cfg_sync_msg, oid);
+            break;
+
+        case CFG_GET_SUBTREE:
+            obj = CFG_STATS_MSG_OID(cfg_get_subtree_msg, oid);
+            break;
+
+        case CFG_GET:
+            if (((const cfg_get_msg *)msg)->sync)
+                op = "get_sync";
+            obj = cfg_stats_handle_obj(((const cfg_get_msg *)msg)->handle);
+            break;
+
+        case CFG_SET:
+            obj = cfg_stats_handle_obj(((const cfg_set_msg *)msg)->handle);
+            break;
+
+        case CFG_DEL:
+            obj = cfg_stats_handle_obj(((const cfg_del_msg *)msg)->handle);
+            break;
+
+        case CFG_FAMILY:
+            obj = cfg_stats_handle_obj(
+                      ((const cfg_family_msg *)msg)->handle);
+            break;
+
+        default:
+            break;
+    }
+
+    return cfg_stats_lookup(op, "", obj);
+}
+
+#undef CFG_STATS_MSG_OID
+
+/* See the description in conf_stats.h */
+void
+cfg_stats_add(cfg_stats_entry *entry, uint64_t start)
+{
+    uint64_t     ns = cfg_stats_now() - start;
+    uint64_t     us = ns / 1000;
+    unsigned int bucket = 0;
+
+    while (us != 0 && bucket < CFG_OP_STATS_BUCKETS - 1)
+    {
+        us >>= 1;
+        bucket++;
+    }
+
+    entry->count++;
+    entry->sum_ns += ns;
+    entry->min_ns = MIN(entry->min_ns, ns);
+    entry->max_ns = MAX(entry->max_ns, ns);
+    entry->hist[bucket]++;
+}
+
+/* See the description in conf_stats.h */
+void
+cfg_stats_rcf(const char *op, const char *ta, const char *oid,
+              uint64_t start)
+{
+    cfg_stats_add(cfg_stats_lookup(op, ta, cfg_stats_obj_oid(oid, SIZE_MAX)),
+                  start);
+}
+
+/**
+ * Reset statistics. Entries are kept since they may be referred to
+ * by operations in progress.
+ */
+static void
+cfg_stats_reset(void)
+{
+    cfg_stats_entry *entry;
+    unsigned int     i;
+
+    for (i = 0; i < CFG_STATS_HASH_SIZE; i++)
+    {
+        for (entry = cfg_stats_hash[i]; entry != NULL; entry = entry->next)
+        {
+            entry->count = 0;
+            entry->sum_ns = 0;
+            entry->min_ns = UINT64_MAX;
+            entry->max_ns = 0;
+            memset(entry->hist, 0, sizeof(entry->hist));
+        }
+    }
+}
+
+/* See the description in conf_stats.h */
+void
+cfg_stats_log(void)
+{
+    te_mi_logger    *logger;
+    te_string        name = TE_STRING_INIT;
+    te_string        hist = TE_STRING_INIT;
+    cfg_stats_entry *entry;
+    unsigned int     i;
+    unsigned int     j;
+    te_errno         rc;
+
+    rc = te_mi_logger_meas_create("te_cs", &logger);
+    if (rc != 0)
+    {
+        ERROR("Failed to create MI logger for operation statistics: %r",
+              rc);
+        return;
+    }
+
+    for (i = 0; i < CFG_STATS_HASH_SIZE; i++)
+    {
+        for (entry = cfg_stats_hash[i]; entry != NULL; entry = entry->next)
+        {
+            if (entry->count == 0)
+                continue;
+
+            te_string_reset(&name);
+            te_string_append(&name, "%s", entry->op);
+            if (*entry->ta != '\0')
+                te_string_append(&name, " %s", entry->ta);
+            if (*entry->obj != '\0')
+                te_string_append(&name, " %s", entry->obj);
+
+            te_mi_logger_add_meas(logger, NULL, TE_MI_MEAS_LATENCY,
+                                  name.ptr, TE_MI_MEAS_AGGR_MIN,
+                                  entry->min_ns,
+                                  TE_MI_MEAS_MULTIPLIER_NANO);
+            te_mi_logger_add_meas(logger, NULL, TE_MI_MEAS_LATENCY,
+                                  name.ptr, TE_MI_MEAS_AGGR_MEAN,
+                                  (double)entry->sum_ns / entry->count,
+                                  TE_MI_MEAS_MULTIPLIER_NANO);
+            te_mi_logger_add_meas(logger, NULL, TE_MI_MEAS_LATENCY,
+                                  name.ptr, TE_MI_MEAS_AGGR_MAX,
+                                  entry->max_ns,
+                                  TE_MI_MEAS_MULTIPLIER_NANO);
+            te_mi_logger_add_meas(logger, NULL, TE_MI_MEAS_UNITLESS_VALUE,
+                                  name.ptr, TE_MI_MEAS_AGGR_SINGLE,
+                                  entry->count,
+                                  TE_MI_MEAS_MULTIPLIER_PLAIN);
+
+            /* Histogram as "<lower bound in us>:<count>" pairs */
+            te_string_reset(&hist);
+            for (j = 0; j < CFG_OP_STATS_BUCKETS; j++)
+            {
+                if (entry->hist[j] == 0)
+                    continue;
+                te_string_append(&hist, "%s%llu:%llu",
+                                 hist.len == 0 ? "" : " ",
+                                 j == 0 ? 0ULL : 1ULL << (j - 1),
+                                 (unsigned long long)entry->hist[j]);
+            }
+            te_mi_logger_add_comment(logger, NULL, name.ptr, "%s",
+                                     hist.ptr);
+        }
+    }
+
+    te_mi_logger_destroy(logger);
+    te_string_free(&name);
+    te_string_free(&hist);
+}
+
+/**
+ * Make the answer to CFG_OP_STATS message with collected statistics.
+ *
+ * @param req           request
+ *
+ * @return Allocated answer.
+ */
+static cfg_op_stats_msg *
+cfg_stats_answer(const cfg_op_stats_msg *req)
+{
+    te_dbuf             answer = TE_DBUF_INIT(TE_DBUF_DEFAULT_GROW_FACTOR);
+    cfg_op_stats_msg   *ans;
+    cfg_op_stats_entry  hdr;
+    cfg_stats_entry    *entry;
+    uint32_t            num = 0;
+    unsigned int        i;
+
+    te_dbuf_append(&answer, req, sizeof(*req));
+    te_dbuf_append(&answer, NULL,
+                   TE_ALIGN(sizeof(*req), CFG_OP_STATS_ALIGN) -
+                   sizeof(*req));
+
+    for (i = 0; i < CFG_STATS_HASH_SIZE; i++)
+    {
+        for (entry = cfg_stats_hash[i]; entry != NULL; entry = entry->next)
+        {
+            size_t op_len = strlen(entry->op) + 1;
+            size_t ta_len = strlen(entry->ta) + 1;
+            size_t obj_len = strlen(entry->obj) + 1;
+
+            if (entry->count == 0)
+                continue;
+
+            memset(&hdr, 0, sizeof(hdr));
+            hdr.len = sizeof(hdr) + op_len + ta_len + obj_len;
+            hdr.count = entry->count;
+            hdr.sum_ns = entry->sum_ns;
+            hdr.min_ns = entry->min_ns;
+            hdr.max_ns = entry->max_ns;
+            memcpy(hdr.hist, entry->hist, sizeof(hdr.hist));
+
+            te_dbuf_append(&answer, &hdr, sizeof(hdr));
+            te_dbuf_append(&answer, entry->op, op_len);
+            te_dbuf_append(&answer, entry->ta, ta_len);
+            te_dbuf_append(&answer, entry->obj, obj_len);
+            te_dbuf_append(&answer, NULL,
+                           TE_ALIGN(hdr.len, CFG_OP_STATS_ALIGN) - hdr.len);
+            num++;
+        }
+    }
+
+    ans = (cfg_op_stats_msg *)answer.ptr;
+    ans->len = answer.len;
+    ans->num = num;
+
+    return ans;
+}
+
+/* See the description in conf_stats.h */
+void
+cfg_stats_process_msg(cfg_op_stats_msg **msg)
+{
+    cfg_op_stats_msg *req = *msg;
+
+    if (req->len < sizeof(*req))
+    {
+        req->rc = TE_EINVAL;
+        return;
+    }
+
+    if (req->get)
+        *msg = cfg_stats_answer(req);
+    else
+        req->len = sizeof(*req);
+
+    if (req->log)
+        cfg_stats_log();
+    if (req->reset)
+        cfg_stats_reset();
+}
+
+/* See the description in conf_stats.h */
+void
+cfg_stats_destroy(void)
+{
+    cfg_stats_entry *entry;
+    unsigned int     i;
+
+    for (i = 0; i < CFG_STATS_HASH_SIZE; i++)
+    {
+        while ((entry = cfg_stats_hash[i]) != NULL)
+        {
+            cfg_stats_hash[i] = entry->next;
+            free(entry->ta);
+            free(entry->obj);
+            free(entry);
+        }
+    }
+}
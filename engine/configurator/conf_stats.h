@@ -0,0 +1,78 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/** @file
+ * @brief Configurator
+ *
+ * Latency statistics of operations
+ *
+ * Copyright (C) 2004-2023 OKTET Labs Ltd. All rights reserved.
+ */
+
+#ifndef __TE_CONF_STATS_H__
+#define __TE_CONF_STATS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Statistics of an operation applied to an object */
+typedef struct cfg_stats_entry cfg_stats_entry;
+
+/**
+ * Get the time to be passed as start of an operation.
+ *
+ * @return Monotonic time in nanoseconds.
+ */
+extern uint64_t cfg_stats_now(void);
+
+/**
+ * Find or create statistics entry for a request. It should be called
+ * before the request is processed, since processing may destroy
+ * the object instance the request refers to.
+ *
+ * @param msg           request
+ *
+ * @return Statistics entry.
+ */
+extern cfg_stats_entry *cfg_stats_msg_entry(const cfg_msg *msg);
+
+/**
+ * Account an operation which is completed.
+ *
+ * @param entry         statistics entry of the operation
+ * @param start         time when the operation is started
+ */
+extern void cfg_stats_add(cfg_stats_entry *entry, uint64_t start);
+
+/**
+ * Account an RCF call made by the Configurator which is completed.
+ *
+ * @param op            name of the call (a string literal)
+ * @param ta            Test Agent name
+ * @param oid           instance or object identifier
+ * @param start         time when the call is started
+ */
+extern void cfg_stats_rcf(const char *op, const char *ta, const char *oid,
+                          uint64_t start);
+
+/**
+ * Log collected statistics as an MI artifact.
+ */
+extern void cfg_stats_log(void);
+
+/**
+ * Process CFG_OP_STATS message.
+ *
+ * @param msg           location of message pointer (the message may be
+ *                      re-allocated by the function)
+ */
+extern void cfg_stats_process_msg(cfg_op_stats_msg **msg);
+
+/**
+ * Release all statistics.
+ */
+extern void cfg_stats_destroy(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __TE_CONF_STATS_H__ */
@@ -0,0 +1,406 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/** @file
+ * @brief Configurator
+ *
+ * Subscriptions to configuration changes
+ *
+ * Copyright (C) 2004-2023 OKTET Labs Ltd. All rights reserved.
+ */
+
+#include "conf_defs.h"
+#include "te_alloc.h"
+#include "te_dbuf.h"
+#include "te_vector.h"
+
+/** Subscription to configuration changes */
+typedef struct cfg_subscr {
+    uint32_t        id;         /**< Subscription identifier */
+    cfg_oid        *pattern;    /**< Parsed instance identifier pattern */
+    char           *sync_oid;   /**< Root of the subtree to be
+                                     resynchronized */
+    uint32_t        sync_ms;    /**< Resynchronization interval or 0 */
+    uint64_t        next_sync;  /**< Time of the next resynchronization */
+    bool            sync_failed; /**< The last resynchronization failed */
+    te_dbuf         events;     /**< Queued changes in the format of
+                                     cfg_wait_events_msg */
+    uint32_t        num;        /**< Number of queued changes */
+    bool            overflow;   /**< Some changes are lost */
+
+    /** Client which made the subscription or @c NULL */
+    struct ipc_server_client   *owner;
+    /** Identifier of the owner */
+    uint64_t                    owner_id;
+    /** Client waiting for changes or @c NULL */
+    struct ipc_server_client   *waiter;
+    /** Identifier of the waiting client */
+    uint64_t                    waiter_id;
+    /** Time when the waiter gets @c TE_ETIMEDOUT */
+    uint64_t                    deadline;
+} cfg_subscr;
+
+/** Active subscriptions */
+static te_vec cfg_subscrs = TE_VEC_INIT(cfg_subscr *);
+/** The last allocated subscription identifier */
+static uint32_t cfg_subscr_last_id = 0;
+
+/* Get monotonic time in milliseconds */
+static uint64_t
+cfg_subscr_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* Find subscription by identifier */
+static cfg_subscr *
+cfg_subscr_find(uint32_t id, size_t *index)
+{
+    cfg_subscr **subscr;
+
+    TE_VEC_FOREACH(&cfg_subscrs, subscr)
+    {
+        if ((*subscr)->id == id)
+        {
+            if (index != NULL)
+                *index = te_vec_get_index(&cfg_subscrs, subscr);
+            return *subscr;
+        }
+    }
+
+    return NULL;
+}
+
+/* Free subscription */
+static void
+cfg_subscr_free(cfg_subscr *subscr)
+{
+    cfg_free_oid(subscr->pattern);
+    free(subscr->sync_oid);
+    te_dbuf_free(&subscr->events);
+    free(subscr);
+}
+
+/**
+ * Make the answer to CFG_WAIT_EVENTS message with changes queued for
+ * the subscription and flush the queue.
+ *
+ * @param subscr        subscription
+ *
+ * @return Allocated answer.
+ */
+static cfg_wait_events_msg *
+cfg_subscr_answer(cfg_subscr *subscr)
+{
+    size_t               len = sizeof(cfg_wait_events_msg) +
+                               subscr->events.len;
+    cfg_wait_events_msg *ans = TE_ALLOC(len);
+
+    ans->type = CFG_WAIT_EVENTS;
+    ans->len = len;
+    ans->id = subscr->id;
+    ans->num = subscr->num;
+    ans->overflow = subscr->overflow;
+    if (subscr->num == 0 && !subscr->overflow)
+        ans->rc = TE_RC(TE_CS, TE_ETIMEDOUT);
+    if (subscr->events.len > 0)
+        memcpy(ans->events, subscr->events.ptr, subscr->events.len);
+
+    te_dbuf_reset(&subscr->events);
+    subscr->num = 0;
+    subscr->overflow = false;
+
+    return ans;
+}
+
+/* See the description in conf_subscr.h */
+void
+cfg_subscr_notify(cfg_change_kind kind, const char *oid)
+{
+    cfg_subscr **subscr;
+    cfg_oid     *parsed;
+    uint8_t      kind_byte = kind;
+
+    if (te_vec_size(&cfg_subscrs) == 0)
+        return;
+
+    parsed = cfg_convert_oid_str(oid);
+    if (parsed == NULL)
+        return;
+
+    TE_VEC_FOREACH(&cfg_subscrs, subscr)
+    {
+        cfg_subscr *s = *subscr;
+
+        if (!cfg_db_inst_oid_match(s->pattern, parsed))
+            continue;
+
+        if (s->num >= CFG_SUBSCR_EVENTS_MAX)
+        {
+            s->overflow = true;
+            continue;
+        }
+
+        te_dbuf_append(&s->events, &kind_byte, sizeof(kind_byte));
+        te_dbuf_append(&s->events, oid, strlen(oid) + 1);
+        s->num++;
+    }
+
+    cfg_free_oid(parsed);
+}
+
+/* See the description in conf_subscr.h */
+void
+cfg_subscr_process_subscribe(cfg_subscribe_msg *msg)
+{
+    cfg_subscr *subscr;
+    cfg_oid    *pattern;
+    char       *wildcard;
+    char       *sync_oid;
+
+    if (msg->len <= sizeof(*msg) ||
+        ((char *)msg)[msg->len - 1] != '\0')
+    {
+        msg->rc = TE_EINVAL;
+        return;
+    }
+
+    pattern = cfg_convert_oid_str(msg->pattern);
+    if (pattern == NULL || !pattern->inst)
+    {
+        ERROR("Invalid subscription pattern '%s'", msg->pattern);
+        cfg_free_oid(pattern);
+        msg->rc = TE_EINVAL;
+        return;
+    }
+
+    /* The longest prefix without wildcards is resynchronized */
+    sync_oid = TE_STRDUP(msg->pattern);
+    wildcard = strchr(sync_oid, '*');
+    if (wildcard != NULL)
+    {
+        *wildcard = '\0';
+        wildcard = strrchr(sync_oid, '/');
+        *wildcard = '\0';
+    }
+    if (*sync_oid == '\0')
+    {
+        /* Wildcard in the first component, e.g. /agent:*, or "/:" */
+        free(sync_oid);
+        sync_oid = TE_STRDUP("/:");
+    }
+
+    subscr = TE_ALLOC(sizeof(*subscr));
+    subscr->id = ++cfg_subscr_last_id;
+    subscr->pattern = pattern;
+    subscr->sync_oid = sync_oid;
+    subscr->sync_ms = msg->sync_ms;
+    subscr->events = (te_dbuf)TE_DBUF_INIT(TE_DBUF_DEFAULT_GROW_FACTOR);
+    TE_VEC_APPEND(&cfg_subscrs, subscr);
+
+    msg->id = subscr->id;
+    msg->len = sizeof(*msg);
+}
+
+/* See the description in conf_subscr.h */
+void
+cfg_subscr_process_unsubscribe(cfg_unsubscribe_msg *msg)
+{
+    cfg_subscr *subscr;
+    size_t      index;
+
+    subscr = cfg_subscr_find(msg->id, &index);
+    if (subscr == NULL)
+    {
+        msg->rc = TE_ENOENT;
+        return;
+    }
+    if (subscr->waiter != NULL)
+    {
+        msg->rc = TE_EBUSY;
+        return;
+    }
+
+    te_vec_remove_index(&cfg_subscrs, index);
+    cfg_subscr_free(subscr);
+}
+
+/* See the description in conf_subscr.h */
+void
+cfg_subscr_set_owner(uint32_t id, struct ipc_server_client *owner)
+{
+    cfg_subscr *subscr = cfg_subscr_find(id, NULL);
+
+    if (subscr == NULL)
+        return;
+
+    subscr->owner = owner;
+    subscr->owner_id = ipc_server_client_id(owner);
+}
+
+/* See the description in conf_subscr.h */
+void
+cfg_subscr_process_wait(cfg_wait_events_msg **msg)
+{
+    cfg_subscr *subscr = cfg_subscr_find((*msg)->id, NULL);
+
+    if (subscr == NULL)
+    {
+        (*msg)->rc = TE_ENOENT;
+        (*msg)->len = sizeof(**msg);
+        return;
+    }
+    if (subscr->waiter != NULL)
+    {
+        (*msg)->rc = TE_EBUSY;
+        (*msg)->len = sizeof(**msg);
+        return;
+    }
+
+    *msg = cfg_subscr_answer(subscr);
+}
+
+/* See the description in conf_subscr.h */
+bool
+cfg_subscr_defer_wait(const cfg_wait_events_msg *msg,
+                      struct ipc_server_client *user)
+{
+    cfg_subscr *subscr;
+    uint64_t    now;
+
+    if (msg->len < sizeof(*msg) || msg->timeout_ms == 0)
+        return false;
+
+    subscr = cfg_subscr_find(msg->id, NULL);
+    if (subscr == NULL || subscr->waiter != NULL ||
+        subscr->num > 0 || subscr->overflow)
+        return false;
+
+    now = cfg_subscr_now();
+    subscr->waiter = user;
+    subscr->waiter_id = ipc_server_client_id(user);
+    subscr->deadline = now + msg->timeout_ms;
+    subscr->next_sync = now + subscr->sync_ms;
+
+    return true;
+}
+
+/* See the description in conf_subscr.h */
+struct timeval *
+cfg_subscr_timeout(struct timeval *tv)
+{
+    cfg_subscr **subscr;
+    uint64_t     nearest = UINT64_MAX;
+    uint64_t     now;
+
+    TE_VEC_FOREACH(&cfg_subscrs, subscr)
+    {
+        if ((*subscr)->waiter == NULL)
+            continue;
+
+        nearest = MIN(nearest, (*subscr)->deadline);
+        if ((*subscr)->sync_ms != 0)
+            nearest = MIN(nearest, (*subscr)->next_sync);
+    }
+
+    if (nearest == UINT64_MAX)
+        return NULL;
+
+    now = cfg_subscr_now();
+    nearest = nearest > now ? nearest - now : 0;
+    tv->tv_sec = nearest / 1000;
+    tv->tv_usec = TE_MS2US(nearest % 1000);
+
+    return tv;
+}
+
+/* See the description in conf_subscr.h */
+void
+cfg_subscr_dispatch(struct ipc_server *server)
+{
+    cfg_subscr **subscr;
+    uint64_t     now = cfg_subscr_now();
+    size_t       i;
+    int          rc;
+
+    /*
+     * Subscriptions of clients which are gone are dropped. A postponed
+     * answer is sent to the waiting client first.
+     */
+    for (i = 0; i < te_vec_size(&cfg_subscrs); )
+    {
+        cfg_subscr *s = TE_VEC_GET(cfg_subscr *, &cfg_subscrs, i);
+
+        if (s->owner == NULL || s->waiter != NULL ||
+            ipc_server_client_valid(server, s->owner, s->owner_id))
+        {
+            i++;
+            continue;
+        }
+
+        VERB("Client of subscription %u is gone, drop it", s->id);
+        te_vec_remove_index(&cfg_subscrs, i);
+        cfg_subscr_free(s);
+    }
+
+    /*
+     * Changes on Test Agents are learnt on synchronization, so
+     * subscribed subtrees are resynchronized while somebody waits.
+     * Synchronization is not allowed in the middle of local commands
+     * sequence.
+     */
+    TE_VEC_FOREACH(&cfg_subscrs, subscr)
+    {
+        cfg_subscr *s = *subscr;
+
+        if (s->waiter == NULL || s->sync_ms == 0 || now < s->next_sync ||
+            local_cmd_seq)
+            continue;
+
+        rc = cfg_ta_sync(s->sync_oid, true);
+        if (rc != 0 && !s->sync_failed)
+        {
+            WARN("Failed to synchronize subscribed subtree '%s': %r",
+                 s->sync_oid, rc);
+        }
+        s->sync_failed = (rc != 0);
+        s->next_sync = now + s->sync_ms;
+    }
+
+    TE_VEC_FOREACH(&cfg_subscrs, subscr)
+    {
+        cfg_subscr          *s = *subscr;
+        cfg_wait_events_msg *ans;
+
+        if (s->waiter == NULL ||
+            (s->num == 0 && !s->overflow && now < s->deadline))
+            continue;
+
+        ans = cfg_subscr_answer(s);
+        if (!ipc_server_client_valid(server, s->waiter, s->waiter_id))
+        {
+            WARN("Client waiting for changes of subscription %u is gone",
+                 s->id);
+        }
+        else
+        {
+            rc = ipc_send_answer(server, s->waiter, ans, ans->len);
+            if (rc != 0)
+                ERROR("Cannot send an answer to user: errno=%r", rc);
+        }
+        s->waiter = NULL;
+        free(ans);
+    }
+}
+
+/* See the description in conf_subscr.h */
+void
+cfg_subscr_destroy(void)
+{
+    cfg_subscr **subscr;
+
+    TE_VEC_FOREACH(&cfg_subscrs, subscr)
+        cfg_subscr_free(*subscr);
+    te_vec_free(&cfg_subscrs);
+}
@@ -0,0 +1,99 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/** @file
+ * @brief Configurator
+ *
+ * Subscriptions to configuration changes
+ *
+ * Copyright (C) 2004-2023 OKTET Labs Ltd. All rights reserved.
+ */
+
+#ifndef __TE_CONF_SUBSCR_H__
+#define __TE_CONF_SUBSCR_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Report a change of the database to subscribers whose patterns
+ * match the instance.
+ *
+ * @param kind          kind of the change
+ * @param oid           object instance identifier
+ */
+extern void cfg_subscr_notify(cfg_change_kind kind, const char *oid);
+
+/**
+ * Process CFG_SUBSCRIBE message.
+ *
+ * @param msg           message
+ */
+extern void cfg_subscr_process_subscribe(cfg_subscribe_msg *msg);
+
+/**
+ * Process CFG_UNSUBSCRIBE message.
+ *
+ * @param msg           message
+ */
+extern void cfg_subscr_process_unsubscribe(cfg_unsubscribe_msg *msg);
+
+/**
+ * Bind the subscription to the client which made it, so that the
+ * subscription is dropped when the client disconnects.
+ *
+ * @param id            subscription identifier
+ * @param owner         client which sent CFG_SUBSCRIBE message
+ */
+extern void cfg_subscr_set_owner(uint32_t id,
+                                 struct ipc_server_client *owner);
+
+/**
+ * Process CFG_WAIT_EVENTS message which may be answered immediately:
+ * changes are already queued for the subscription, the timeout is zero
+ * or the request is invalid.
+ *
+ * @param msg           location of message pointer (the message may be
+ *                      re-allocated by the function)
+ */
+extern void cfg_subscr_process_wait(cfg_wait_events_msg **msg);
+
+/**
+ * Postpone the answer to CFG_WAIT_EVENTS message until changes are
+ * queued for the subscription or the timeout expires.
+ *
+ * @param msg           message
+ * @param user          client waiting for the answer
+ *
+ * @return @c true if the answer is postponed, @c false if the message
+ *         should be processed with cfg_process_msg() immediately
+ */
+extern bool cfg_subscr_defer_wait(const cfg_wait_events_msg *msg,
+                                  struct ipc_server_client *user);
+
+/**
+ * Get time until the nearest postponed answer deadline or
+ * resynchronization of a subscribed subtree.
+ *
+ * @param tv            location for the time
+ *
+ * @return @p tv or @c NULL if there are no postponed answers
+ */
+extern struct timeval *cfg_subscr_timeout(struct timeval *tv);
+
+/**
+ * Resynchronize subscribed subtrees if their intervals expire and
+ * send postponed answers which are ready.
+ *
+ * @param server        IPC server
+ */
+extern void cfg_subscr_dispatch(struct ipc_server *server);
+
+/**
+ * Drop all subscriptions.
+ */
+extern void cfg_subscr_destroy(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __TE_CONF_SUBSCR_H__ */
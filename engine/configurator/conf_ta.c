@@ -6,11 +6,9 @@
  * TA interaction auxiliary routines
  */
 
-#include <search.h>
 #include "te_str.h"
 #include "conf_defs.h"
 #include "rcf_api.h"
-#include "te_queue.h"
 #include "te_alloc.h"
 
 #define TA_LIST_SIZE    64
@@ -83,56 +81,38 @@ ta_list_get(ta_list_t *ta_list)
 int
 cfg_ta_add_agent_instances()
 {
-    const char *ta;
-    int         rc;
-    uint64_t    i = 1;
-    ta_list_t   ta_list = TA_LIST_INITIALIZER;
+    const char   *ta;
+    int           rc;
+    ta_list_t     ta_list = TA_LIST_INITIALIZER;
+    cfg_instance *inst;
+    cfg_instance *prev = NULL;
 
     if ((rc = ta_list_get(&ta_list)) != 0)
         return rc;
 
     for (ta = ta_list.list;
          ta < ta_list.list + ta_list.list_size;
-         ta += strlen(ta) + 1, ++i)
+         ta += strlen(ta) + 1)
     {
-        if (i > CFG_HANDLE_MAX_INDEX || i >= cfg_all_inst_size)
-        {
-            rc = TE_ETOOMANY;
-            i--;
-        }
-        else
-        {
-            cfg_all_inst[i] = TE_ALLOC(sizeof(cfg_instance));
-            cfg_all_inst[i]->oid = TE_ALLOC(strlen(CFG_TA_PREFIX) +
-                                            strlen(ta) + 1);
-        }
-
+        rc = cfg_db_inst_alloc(&cfg_inst_root, cfg_all_obj[1], ta, &inst);
         if (rc != 0)
         {
-            for (; i > 0; i--)
+            while ((inst = cfg_inst_root.son) != NULL)
             {
-                free(cfg_all_inst[i]->oid);
-                free(cfg_all_inst[i]);
+                cfg_inst_root.son = inst->brother;
+                cfg_db_inst_free(inst);
             }
             free(ta_list.list);
 
-            if (rc == TE_ETOOMANY)
-                ERROR("%s(): out of instance handles", __FUNCTION__);
-            else
-                ERROR("%s(): out of memory", __FUNCTION__);
-
+            ERROR("%s(): out of instance handles", __FUNCTION__);
             return rc;
         }
 
-        strcpy(cfg_all_inst[i]->name, ta);
-        sprintf(cfg_all_inst[i]->oid, CFG_TA_PREFIX"%s", ta);
-        CFG_NEW_INST_HANDLE(cfg_all_inst[i]->handle, i);
-        cfg_all_inst[i]->obj = cfg_all_obj[1];
-        if (i == 1)
-            cfg_all_inst[0]->son = cfg_all_inst[i];
+        if (prev == NULL)
+            cfg_inst_root.son = inst;
         else
-            cfg_all_inst[i - 1]->brother = cfg_all_inst[i];
-        cfg_all_inst[i]->father = &cfg_inst_root;
+            prev->brother = inst;
+        prev = inst;
     }
     free(ta_list.list);
     return 0;
@@ -168,52 +148,50 @@ cfg_ta_log_syncing(bool flag)
 }
 
 /**
- * Synchronize one object instance on the TA.
+ * Synchronize one object instance on the TA when its object and
+ * local handle are already known.
  *
  * @param ta      Test Agent name
  * @param oid     object instance identifier
+ * @param obj     object of the instance
+ * @param handle  handle of the instance in the local database or
+ *                @c CFG_HANDLE_INVALID if there is no such instance
  *
  * @return status code (see te_errno.h)
  */
 static int
-sync_ta_instance(const char *ta, const char *oid)
+sync_ta_instance_value(const char *ta, const char *oid, cfg_object *obj,
+                       cfg_handle handle)
 {
-    cfg_object   *obj = cfg_get_object(oid);
-    cfg_handle    handle = CFG_HANDLE_INVALID;
     cfg_inst_val  val;
     int           rc;
 
-    if (obj == NULL)
-        return 0;
-
-    rc = cfg_db_find(oid, &handle);
-    if (rc != 0 && TE_RC_GET_ERROR(rc) != TE_ENOENT)
-        return rc;
-
     VERB("Add TA '%s' object instance '%s'", ta, oid);
 
     if (obj->type == CVT_NONE)
     {
-        if (rc != 0)
+        if (handle != CFG_HANDLE_INVALID)
+            return 0;
+
+        /*
+         * There is new instance on Test Agent, which we should
+         * put into our local DB.
+         */
+        rc = cfg_db_add(oid, &handle, CVT_NONE, (cfg_inst_val)0);
+        if (rc == 0)
         {
-            /*
-             * There is new instance on Test Agent, which we should
-             * put into our local DB.
-             */
-            rc = cfg_db_add(oid, &handle, CVT_NONE,
-                            (cfg_inst_val)0);
-            if (rc == 0)
-            {
-                /* Mark it as synchronized */
-                CFG_GET_INST(handle)->added = true;
-            }
+            /* Mark it as synchronized */
+            CFG_GET_INST(handle)->added = true;
         }
         return rc;
     }
 
     while (true)
     {
+        uint64_t start = cfg_stats_now();
+
         rc = rcf_ta_cfg_get(ta, 0, oid, cfg_get_buf, cfg_get_buf_len);
+        cfg_stats_rcf("rcf_get", ta, oid, start);
         if (TE_RC_GET_ERROR(rc) == TE_ESMALLBUF)
         {
             cfg_get_buf_len <<= 1;
@@ -277,117 +255,136 @@ sync_ta_instance(const char *ta, const char *oid)
     return rc;
 }
 
-/* Remove entries, which do not mention in the list, from database */
-static void
-remove_excessive(cfg_instance *inst, char *list)
+/**
+ * Synchronize one object instance on the TA.
+ *
+ * @param ta      Test Agent name
+ * @param oid     object instance identifier
+ *
+ * @return status code (see te_errno.h)
+ */
+static int
+sync_ta_instance(const char *ta, const char *oid)
 {
-    cfg_instance *tmp;
-    cfg_instance *next;
-    int len = strlen(inst->oid);
-    char *s;
+    cfg_object   *obj = cfg_get_object(oid);
+    cfg_handle    handle = CFG_HANDLE_INVALID;
+    int           rc;
 
-    for (tmp = inst->son; tmp != NULL; tmp = next)
-    {
-        next = tmp->brother;
-        remove_excessive(tmp, list);
-    }
+    if (obj == NULL)
+        return 0;
 
-    if (cfg_inst_agent(inst))
-        return;
+    rc = cfg_db_find(oid, &handle);
+    if (rc != 0 && TE_RC_GET_ERROR(rc) != TE_ENOENT)
+        return rc;
 
-    for (s = strstr(list, inst->oid);
-         s != NULL;
-         s = strstr(s + 1, inst->oid))
-    {
-        if (*(s + len) == ' ' || *(s + len) == 0)
-            break;
-    }
-    if (s == NULL)
-        cfg_db_del(inst->handle);
+    return sync_ta_instance_value(ta, oid, obj,
+                                  rc == 0 ? handle : CFG_HANDLE_INVALID);
 }
 
-/* Element of OID queue */
-typedef struct oid_queue_entry_t {
-    TAILQ_ENTRY(oid_queue_entry_t) links;
-    char oid[CFG_OID_MAX];
-} oid_queue_entry_t;
+/** OID reported by the TA and the matching local instance */
+typedef struct sync_entry {
+    const char *oid;        /**< Instance identifier reported by the TA */
+    cfg_handle  handle;     /**< Handle of the local instance with
+                                 the same identifier or
+                                 @c CFG_HANDLE_INVALID */
+} sync_entry;
+
+/* Comparison function for sorting OIDs reported by the TA */
+static int
+sync_entry_compare(const void *pa, const void *pb)
+{
+    const sync_entry *a = pa;
+    const sync_entry *b = pb;
 
-/* Head of OID queue */
-typedef TAILQ_HEAD(oid_queue_head_t, oid_queue_entry_t) oid_queue_head_t;
+    return strcmp(a->oid, b->oid);
+}
 
 /*
- * TODO: get rid of this global variable once we stop support
- * of glibc earlier than 2.30 (released in 08.2019) for TE.
- * In glibc 2.30 twalk_r() was added which allows to pass user data
- * to action callback.
- *
- * WARNING: here it is assumed that Configurator does not use
- * multithreading.
+ * Comparison function for sorting local instances by OID.
+ * Instances scheduled for removal may share OID with a new instance,
+ * so handle is used to get the order stable.
  */
-static oid_queue_head_t oid_queue = TAILQ_HEAD_INITIALIZER(oid_queue);
-
-/* Insert OID to queue */
-static void
-insert_entry(const char *oid, oid_queue_head_t *queue)
+static int
+sync_inst_compare(const void *pa, const void *pb)
 {
-    oid_queue_entry_t *new_elm;
+    const cfg_instance *a = *(const cfg_instance * const *)pa;
+    const cfg_instance *b = *(const cfg_instance * const *)pb;
+    int                 rc = strcmp(a->oid, b->oid);
 
-    new_elm = TE_ALLOC(sizeof(*new_elm));
+    if (rc != 0)
+        return rc;
 
-    te_strlcpy(new_elm->oid, oid, CFG_OID_MAX);
-    TAILQ_INSERT_TAIL(queue, new_elm, links);
+    return a->handle < b->handle ? -1 : a->handle > b->handle;
 }
 
-/* Remove and release all entries in OID queue */
-static inline void
-free_oid_queue(oid_queue_head_t *head)
+/* Put the instance and all its descendants to the vector */
+static void
+sync_collect_subtree(cfg_instance *inst, te_vec *insts)
 {
-    oid_queue_entry_t *cur;
-    oid_queue_entry_t *aux;
-
-    TAILQ_FOREACH_SAFE(cur, head, links, aux)
-    {
-        TAILQ_REMOVE(head, cur, links);
-        free(cur);
-    }
-}
+    cfg_instance *tmp;
 
-/* Comparison function for creating tree of OIDs */
-static int
-oid_tree_compare(const void *pa, const void *pb)
-{
-    return strcmp((char *)pa, (char *)pb);
+    TE_VEC_APPEND(insts, inst);
+    for (tmp = inst->son; tmp != NULL; tmp = tmp->brother)
+        sync_collect_subtree(tmp, insts);
 }
 
-/* Callback to use with twalk() to fill sorted queue of OIDs */
+/**
+ * Merge sorted list of OIDs reported by the TA with the sorted list
+ * of local instances in a single pass. Local instances which are
+ * not reported by the TA are put to @p excessive, handles of local
+ * instances which are reported by the TA are stored in @p ta_oids.
+ *
+ * @param ta_oids       sorted vector of sync_entry
+ * @param insts         sorted vector of local instances
+ * @param excessive     vector for handles of instances to be deleted
+ */
 static void
-oid_tree_action(const void *elm, VISIT which, int depth)
+sync_merge(te_vec *ta_oids, const te_vec *insts, te_vec *excessive)
 {
-    UNUSED(depth);
+    size_t n_ta = te_vec_size(ta_oids);
+    size_t n_inst = te_vec_size(insts);
+    size_t i = 0;
+    size_t j = 0;
 
-    switch (which)
+    while (i < n_inst)
     {
-        case preorder:
-            return;
-        case endorder:
-            return;
-        default:
-            break;
-    }
+        cfg_instance *inst = TE_VEC_GET(cfg_instance *, insts, i);
+        sync_entry   *entry = NULL;
+        int           cmp = -1;
 
-    insert_entry(*(char **)elm, &oid_queue);
-}
+        if (j < n_ta)
+        {
+            entry = &TE_VEC_GET(sync_entry, ta_oids, j);
+            cmp = strcmp(inst->oid, entry->oid);
+        }
 
-/* Dummy free function for tdestroy() */
-static void
-oid_tree_free(void *unused)
-{
-    UNUSED(unused);
+        if (cmp > 0)
+        {
+            j++;
+            continue;
+        }
+
+        if (cmp < 0)
+        {
+            if (!cfg_inst_agent(inst))
+                TE_VEC_APPEND(excessive, inst->handle);
+        }
+        else if (!inst->remove)
+        {
+            /* Instances scheduled for removal are not looked up */
+            entry->handle = inst->handle;
+        }
+        i++;
+    }
 }
 
 /**
  * Synchronize tree of object instances on the TA.
  *
+ * The list of OIDs reported by the TA and the list of local instances
+ * are sorted once and merged, so that the whole synchronization takes
+ * O(N * log(N)) of OID comparisons.
+ *
  * @param ta      Test Agent name
  * @param oid     root object instance identifier
  *
@@ -396,18 +393,22 @@ oid_tree_free(void *unused)
 static int
 sync_ta_subtree(const char *ta, const char *oid)
 {
+    char  *list;
     char  *tmp;
     char  *next;
-    char  *limit;
     char  *wildcard_oid;
     int    rc;
 
-    void *oid_tree_root = NULL;
-    oid_queue_entry_t *entry = NULL;
+    te_vec      ta_oids = TE_VEC_INIT(sync_entry);
+    te_vec      insts = TE_VEC_INIT(cfg_instance *);
+    te_vec      excessive = TE_VEC_INIT(cfg_handle);
+    sync_entry  new_entry = { .handle = CFG_HANDLE_INVALID };
+    sync_entry *entry;
+    sync_entry *prev = NULL;
 
-    cfg_handle *handles = NULL;
-    int         h_num;
-    int         i;
+    cfg_handle  *handles = NULL;
+    unsigned int h_num;
+    unsigned int i;
 
     if (do_log_syncing)
         RING("Synchronize TA '%s' subtree '%s'", ta, oid);
@@ -427,8 +428,11 @@ sync_ta_subtree(const char *ta, const char *oid)
     cfg_get_buf[0] = 0;
     while (true)
     {
+        uint64_t start = cfg_stats_now();
+
         rc = rcf_ta_cfg_get(ta, 0, wildcard_oid, cfg_get_buf,
                             cfg_get_buf_len);
+        cfg_stats_rcf("rcf_get_subtree", ta, oid, start);
         if (TE_RC_GET_ERROR(rc) == TE_ESMALLBUF)
         {
             cfg_get_buf_len <<= 1;
@@ -449,61 +453,94 @@ sync_ta_subtree(const char *ta, const char *oid)
 
     VERB("%s instances:\n%s", ta, cfg_get_buf);
 
-    rc = cfg_db_find_pattern(oid, (unsigned int *)&h_num, &handles);
+    rc = cfg_db_find_pattern(oid, &h_num, &handles);
     if (rc != 0)
     {
         rcf_ta_cfg_group(ta, 0, false);
         return rc;
     }
 
-    if (cfg_get_buf_len < (int)strlen(cfg_get_buf) + (int)strlen(oid) + 2)
+    /*
+     * The buffer is reused by the instance values synchronization,
+     * so the list of OIDs is kept in a copy.
+     */
+    list = TE_STRDUP(cfg_get_buf);
+    for (tmp = list; *tmp != '\0'; tmp = next)
     {
-        cfg_get_buf_len <<= 1;
+        next = strchr(tmp, ' ');
+        if (next != NULL)
+            *next++ = '\0';
+        else
+            next = tmp + strlen(tmp);
 
-        TE_REALLOC(cfg_get_buf, cfg_get_buf_len);
+        if (*tmp != '\0')
+        {
+            new_entry.oid = tmp;
+            TE_VEC_APPEND(&ta_oids, new_entry);
+        }
     }
+    /* The root itself must never be removed */
+    new_entry.oid = oid;
+    TE_VEC_APPEND(&ta_oids, new_entry);
 
-    limit = cfg_get_buf + strlen(cfg_get_buf);
-    sprintf(limit, " %s", oid);
+    te_vec_sort(&ta_oids, sync_entry_compare);
 
     for (i = 0; i < h_num; i++)
-        remove_excessive(CFG_GET_INST(handles[i]), cfg_get_buf);
+    {
+        cfg_instance *inst = CFG_GET_INST(handles[i]);
+
+        if (inst != NULL)
+            sync_collect_subtree(inst, &insts);
+    }
+    free(handles);
+
+    te_vec_sort(&insts, sync_inst_compare);
 
-    /* Calculate number of OIDs to be synchronized */
-    for (tmp = cfg_get_buf; tmp < limit; tmp = next)
+    sync_merge(&ta_oids, &insts, &excessive);
+    te_vec_free(&insts);
+
+    /*
+     * Descendants go after their ancestors in the sorted order, so
+     * they are removed first when the list is walked backwards.
+     */
+    for (i = te_vec_size(&excessive); i > 0; i--)
     {
-        void *tree_entry;
+        cfg_handle handle = TE_VEC_GET(cfg_handle, &excessive, i - 1);
 
-        next = strchr(tmp, ' ');
-        if (next != NULL)
-            *next++ = 0;
-        else
-            next = limit;
+        if (CFG_INST_HANDLE_VALID(handle))
+            cfg_db_del(handle);
+    }
+    te_vec_free(&excessive);
+
+    TE_VEC_FOREACH(&ta_oids, entry)
+    {
+        if (prev != NULL && strcmp(prev->oid, entry->oid) == 0)
+            continue;
+        prev = entry;
 
-        tree_entry = tsearch(tmp, &oid_tree_root, oid_tree_compare);
-        if (tree_entry == NULL)
+        /*
+         * An instance may be removed together with its ancestor
+         * or on synchronization of the ancestor value.
+         */
+        if (CFG_INST_HANDLE_VALID(entry->handle))
         {
-            ERROR("%s(): failed to add OID to a search tree",
-                  __FUNCTION__);
-            tdestroy(oid_tree_root, oid_tree_free);
-            free(handles);
-            rcf_ta_cfg_group(ta, 0, false);
-            return rc;
+            rc = sync_ta_instance_value(ta, entry->oid,
+                                        CFG_GET_INST(entry->handle)->obj,
+                                        entry->handle);
+        }
+        else
+        {
+            rc = sync_ta_instance(ta, entry->oid);
         }
-    }
 
-    twalk(oid_tree_root, oid_tree_action);
-    TAILQ_FOREACH(entry, &oid_queue, links)
-    {
-        if ((rc = sync_ta_instance(ta, entry->oid)) != 0)
+        if (rc != 0)
             break;
     }
 
     rcf_ta_cfg_group(ta, 0, false);
 
-    tdestroy(oid_tree_root, oid_tree_free);
-    free_oid_queue(&oid_queue);
-    free(handles);
+    te_vec_free(&ta_oids);
+    free(list);
 
     return rc;
 }
@@ -678,15 +715,18 @@ cfg_ta_sync_dependants(cfg_instance *inst, bool no_children)
 }
 
 /**
- * Commit local changes in Configurator database to Test Agent.
+ * Prepare the change of the object instance to be committed to
+ * Test Agent.
  *
  * @param ta    - Test Agent name
  * @param inst  - object instance
+ * @param op    - location for the change (its OID is @c NULL if
+ *                the instance should not be committed)
  *
  * @return status code (see te_errno.h)
  */
 static int
-cfg_ta_commit_instance(const char *ta, cfg_instance *inst)
+cfg_ta_commit_instance(const char *ta, cfg_instance *inst, rcf_cfg_op *op)
 {
     int             rc;
     cfg_object     *obj = inst->obj;
@@ -695,6 +735,8 @@ cfg_ta_commit_instance(const char *ta, cfg_instance *inst)
 
     ENTRY("ta=%s inst=0x%X", ta, inst);
     VERB("Commit to '%s' instance '%s'", ta, inst->oid);
+
+    memset(op, 0, sizeof(*op));
     if ((inst->added && obj->type == CVT_NONE && !inst->remove) ||
         (obj->access != CFG_READ_WRITE && obj->access != CFG_READ_CREATE))
     {
@@ -732,90 +774,69 @@ cfg_ta_commit_instance(const char *ta, cfg_instance *inst)
 
     if (inst->remove)
     {
-        if ((rc = rcf_ta_cfg_del(ta, 0, inst->oid)) != 0)
-        {
-            ERROR("Cannot del '%s' via RCF, rc = %r",
-                  inst->oid, rc);
-        }
-        else
-        {
-            cfg_db_del(inst->handle);
-        }
+        op->type = RCF_CFG_OP_DEL;
+    }
+    else if (!inst->added && obj->access == CFG_READ_CREATE)
+    {
+        /*
+         * We need to add a new instance to the Test Agent -
+         * postponed add operation.
+         */
+        op->type = RCF_CFG_OP_ADD;
     }
     else
     {
-        if (!inst->added && obj->access == CFG_READ_CREATE)
-        {
-            /*
-             * We need to add a new instance to the Test Agent -
-             * postponed add operation.
-             */
-            if ((rc = rcf_ta_cfg_add(ta, 0, inst->oid, val_str)) != 0)
-            {
-                ERROR("Cannot add '%s' with value '%s' via RCF, rc = %r",
-                      inst->oid, val_str, rc);
-            }
-        }
-        else
-        {
-            assert(obj->type != CVT_NONE);
-
-            if ((rc = rcf_ta_cfg_set(ta, 0, inst->oid, val_str)) != 0)
-            {
-                ERROR("Failed to set '%s' to value '%s' via RCF, rc = %r",
-                      inst->oid, val_str, rc);
-            }
-        }
-        if (rc == 0)
-        {
-            inst->added = true;
-        }
+        assert(obj->type != CVT_NONE);
+        op->type = RCF_CFG_OP_SET;
     }
 
-    free(val_str);
+    op->ta_name = ta;
+    op->oid = inst->oid;
+    op->val = val_str;
 
-    EXIT("%r", rc);
-    return rc;
+    EXIT("0");
+    return 0;
 }
 
+/** Commit of the local changes in a subtree to Test Agent */
+typedef struct cfg_ta_commit_req {
+    const char     *ta;         /**< Test Agent name */
+    cfg_instance   *inst;       /**< Commit subtree root */
+    size_t          first;      /**< Index of the first change */
+    size_t          num;        /**< Number of changes */
+    bool            need_sync;  /**< Whether the subtree should be
+                                     synchronized after the commit */
+    int             rc;         /**< Status of the commit */
+} cfg_ta_commit_req;
+
 /**
- * Commit changes in local Configurator database to the Test Agent.
+ * Collect changes in the commit subtree in the order they should be
+ * applied on Test Agent. Collection stops on the first instance
+ * which cannot be committed, the changes collected before it are
+ * still applied.
  *
- * @param ta    - Test Agent name
- * @param inst  - object instance of the commit subtree root
- *
- * @return status code (see te_errno.h)
+ * @param req       - commit request
+ * @param ops       - vector of rcf_cfg_op to put changes to
+ * @param handles   - vector of handles of changed instances
  */
-static int
-cfg_ta_commit(const char *ta, cfg_instance *inst)
+static void
+cfg_ta_commit_prepare(cfg_ta_commit_req *req, te_vec *ops, te_vec *handles)
 {
-    int           rc, ret = 0;
+    int           rc;
     cfg_instance *commit_root;
     cfg_instance *p;
     bool forward;
-    bool need_sync = false;
+    rcf_cfg_op op;
 
     cfg_instance *father;
     cfg_instance *son;
     cfg_instance *brother;
     bool is_commit_root;
 
-    assert(ta != NULL);
-    assert(inst != NULL);
-
-    ENTRY("ta=%s inst=0x%X", ta, inst);
-    VERB("Commit to TA '%s' start at '%s'", ta, inst->oid);
-
-    rc = rcf_ta_cfg_group(ta, 0, true);
-    if (rc != 0)
-    {
-        ERROR("Failed(%r) to start group on TA '%s'", rc, ta);
-        EXIT("%r", rc);
-        ret = rc;
-        goto handle_result;
-    }
+    VERB("Commit to TA '%s' start at '%s'", req->ta, req->inst->oid);
 
-    for (commit_root = inst, p = inst, forward = true; p != NULL; )
+    req->first = te_vec_size(ops);
+    for (commit_root = req->inst, p = req->inst, forward = true; p != NULL; )
     {
         father = p->father;
         son = p->son;
@@ -830,18 +851,24 @@ cfg_ta_commit(const char *ta, cfg_instance *inst)
              */
             if ((!p->added && p->obj->access == CFG_READ_CREATE) ||
                 p->remove)
-                need_sync = true;
+                req->need_sync = true;
 
+            /* Children are deleted together with the instance */
             if (p->remove)
                 son = NULL;
 
-            rc = cfg_ta_commit_instance(ta, p);
+            rc = cfg_ta_commit_instance(req->ta, p, &op);
             if (rc != 0)
             {
                 ERROR("Failed(%r) to commit '%s'", rc, p->oid);
-                ret = rc;
+                req->rc = rc;
                 break;
             }
+            if (op.oid != NULL)
+            {
+                TE_VEC_APPEND(ops, op);
+                TE_VEC_APPEND(handles, p->handle);
+            }
         }
 
         if (forward && (son != NULL))
@@ -866,44 +893,167 @@ cfg_ta_commit(const char *ta, cfg_instance *inst)
             p = NULL;
         }
     }
+    req->num = te_vec_size(ops) - req->first;
+}
 
-    rc = rcf_ta_cfg_group(ta, 0, false);
-    if (rc != 0)
+/**
+ * Update local Configurator database according to the results of
+ * the changes committed to Test Agent and synchronize the subtree
+ * if required.
+ *
+ * @param req       - commit request
+ * @param ops       - vector of rcf_cfg_op with results
+ * @param handles   - vector of handles of changed instances
+ */
+static void
+cfg_ta_commit_finish(cfg_ta_commit_req *req, te_vec *ops, te_vec *handles)
+{
+    size_t  i;
+    int     rc;
+
+    if (req->num > 0)
     {
-        ERROR("Failed(%r) to end group on TA '%s'", rc, ta);
-        if (ret == 0)
-            ret = rc;
+        /* Status of the group is the same for all changes of the TA */
+        rc = TE_VEC_GET(rcf_cfg_op, ops, req->first).ta_rc;
+        if (rc != 0)
+        {
+            ERROR("Failed(%r) to commit changes to TA '%s'", rc, req->ta);
+            req->rc = rc;
+        }
     }
 
-    if (ret == 0 && need_sync)
+    for (i = req->first; i < req->first + req->num; i++)
     {
-        if ((rc = sync_ta_subtree(ta, inst->oid)) != 0)
+        rcf_cfg_op *op = &TE_VEC_GET(rcf_cfg_op, ops, i);
+        cfg_handle  handle = TE_VEC_GET(cfg_handle, handles, i);
+
+        if (op->rc == 0)
         {
-            ERROR("Failed(%r) to synchronize %s instance", rc, inst->oid);
-            if (ret == 0)
-                ret = rc;
+            if (!CFG_INST_HANDLE_VALID(handle))
+                continue;
+
+            if (op->type == RCF_CFG_OP_DEL)
+                cfg_db_del(handle);
+            else
+                CFG_GET_INST(handle)->added = true;
+            continue;
+        }
+
+        if (TE_RC_GET_ERROR(op->rc) != TE_ECANCELED)
+        {
+            switch (op->type)
+            {
+                case RCF_CFG_OP_DEL:
+                    ERROR("Cannot del '%s' via RCF, rc = %r",
+                          op->oid, op->rc);
+                    break;
+
+                case RCF_CFG_OP_ADD:
+                    ERROR("Cannot add '%s' with value '%s' via RCF, "
+                          "rc = %r", op->oid, op->val, op->rc);
+                    break;
+
+                default:
+                    ERROR("Failed to set '%s' to value '%s' via RCF, "
+                          "rc = %r", op->oid, op->val, op->rc);
+                    break;
+            }
+            ERROR("Failed(%r) to commit '%s'", op->rc, op->oid);
         }
+
+        if (req->rc == 0)
+            req->rc = op->rc;
     }
 
-    VERB("Commit to TA '%s' end %r - %s", ta, ret,
-         (ret == 0) ? "success" : "failed");
+    if (req->rc == 0 && req->need_sync)
+    {
+        if ((rc = sync_ta_subtree(req->ta, req->inst->oid)) != 0)
+        {
+            ERROR("Failed(%r) to synchronize %s instance",
+                  rc, req->inst->oid);
+            req->rc = rc;
+        }
+    }
 
-handle_result:
+    VERB("Commit to TA '%s' end %r - %s", req->ta, req->rc,
+         (req->rc == 0) ? "success" : "failed");
 
-    if (ret == 0 && local_cmd_seq)
+    if (req->rc == 0 && local_cmd_seq)
     {
         /* Call DH function to tell that local operations are commit */
-        cfg_dh_apply_commit(inst->oid);
+        cfg_dh_apply_commit(req->inst->oid);
+    }
+}
+
+/**
+ * Commit changes in local Configurator database to Test Agents.
+ *
+ * Changes are collected for all requests first and then applied
+ * on all Test Agents concurrently, the order of the changes on each
+ * Test Agent is preserved.
+ *
+ * @param reqs      - commit requests, at most one per Test Agent
+ * @param n_reqs    - number of requests
+ *
+ * @return status code of the first failed request
+ */
+static int
+cfg_ta_commit(cfg_ta_commit_req *reqs, size_t n_reqs)
+{
+    te_vec      ops = TE_VEC_INIT(rcf_cfg_op);
+    te_vec      handles = TE_VEC_INIT(cfg_handle);
+    rcf_cfg_op *op;
+    size_t      i;
+    uint64_t    start;
+    int         rc;
+    int         ret = 0;
+
+    for (i = 0; i < n_reqs; i++)
+        cfg_ta_commit_prepare(&reqs[i], &ops, &handles);
+
+    start = cfg_stats_now();
+    rc = rcf_ta_cfg_commit((rcf_cfg_op *)ops.data.ptr, te_vec_size(&ops));
+    /*
+     * Changes are applied on Test Agents concurrently, so the time of
+     * the whole commit is accounted for each of them.
+     */
+    for (i = 0; i < n_reqs; i++)
+    {
+        if (reqs[i].num > 0)
+            cfg_stats_rcf("rcf_commit", reqs[i].ta, reqs[i].inst->oid,
+                          start);
+    }
+    if (rc != 0)
+    {
+        /* Nothing is sent to Test Agents */
+        ERROR("Failed(%r) to commit changes to Test Agents", rc);
+        for (i = 0; i < n_reqs; i++)
+        {
+            if (reqs[i].rc == 0)
+                reqs[i].rc = rc;
+        }
     }
 
-    EXIT("%r", ret);
+    for (i = 0; i < n_reqs; i++)
+    {
+        cfg_ta_commit_finish(&reqs[i], &ops, &handles);
+        if (ret == 0)
+            ret = reqs[i].rc;
+    }
+
+    TE_VEC_FOREACH(&ops, op)
+        free((char *)op->val);
+    te_vec_free(&ops);
+    te_vec_free(&handles);
+
     return ret;
 }
 
 /**
  * Commit changes in local Configurator database to all Test Agents.
  *
- * @param oid   subtree OID or NULL if whole database should be synchronized
+ * @param oid   subtree OID or NULL (or empty string) if whole database
+ *              should be committed
  *
  * @return Status code (see te_errno.h)
  */
@@ -914,13 +1064,14 @@ cfg_tas_commit(const char *oid)
     cfg_instance   *inst;
 
     ENTRY("oid=%s", (oid == NULL) ? "(null)" : oid);
-    if (oid == NULL)
+    if (oid == NULL || *oid == '\0')
     {
+        te_vec              reqs = TE_VEC_INIT(cfg_ta_commit_req);
+        cfg_ta_commit_req   req = { .rc = 0 };
+
         VERB("Commit all configuration tree");
         /* OID is unspecified - commit all Configurator DB */
-        for (inst = cfg_inst_root.son;
-             (inst != NULL) && (rc == 0);
-             inst = inst->brother)
+        for (inst = cfg_inst_root.son; inst != NULL; inst = inst->brother)
         {
             if (!cfg_inst_agent(inst))
             {
@@ -928,14 +1079,21 @@ cfg_tas_commit(const char *oid)
             }
             else
             {
-                rc = cfg_ta_commit(inst->name, inst);
+                req.ta = inst->name;
+                req.inst = inst;
+                TE_VEC_APPEND(&reqs, req);
             }
         }
+
+        rc = cfg_ta_commit((cfg_ta_commit_req *)reqs.data.ptr,
+                           te_vec_size(&reqs));
+        te_vec_free(&reqs);
     }
     else
     {
-        cfg_instance   *ta_inst;
-        cfg_handle      handle;
+        cfg_instance       *ta_inst;
+        cfg_handle          handle;
+        cfg_ta_commit_req   req = { .rc = 0 };
 
         VERB("Commit in subtree '%s'", oid);
         rc = cfg_db_find(oid, &handle);
@@ -976,7 +1134,9 @@ cfg_tas_commit(const char *oid)
         }
         VERB("Found name of TA to commit to: %s", ta_inst->name);
 
-        rc = cfg_ta_commit(ta_inst->name, inst);
+        req.ta = ta_inst->name;
+        req.inst = inst;
+        rc = cfg_ta_commit(&req, 1);
     }
 
     if (local_cmd_seq)
@@ -987,7 +1147,19 @@ cfg_tas_commit(const char *oid)
         {
             /* Save configuration changes */
             cfg_dh_release_backup(local_cmd_bkp);
-            cfg_conf_delay_update(inst->oid);
+            if (inst != NULL)
+            {
+                cfg_conf_delay_update(inst->oid);
+            }
+            else
+            {
+                for (inst = cfg_inst_root.son; inst != NULL;
+                     inst = inst->brother)
+                {
+                    if (cfg_inst_agent(inst))
+                        cfg_conf_delay_update(inst->oid);
+                }
+            }
         }
         else
         {
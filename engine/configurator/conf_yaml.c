@@ -16,8 +16,12 @@
 #include "te_alloc.h"
 #include "te_expand.h"
 #include "te_file.h"
+#include "te_string.h"
+#include "te_vector.h"
 
 #include <ctype.h>
+#include <inttypes.h>
+#include <sys/stat.h>
 #include <libxml/xinclude.h>
 #include <libgen.h>
 #include <yaml.h>
@@ -39,12 +43,45 @@
       .deps = SLIST_HEAD_INITIALIZER(deps), \
       .cond = true }
 
+/** Version of the format of cached YAML processing results */
+#define CS_YAML_CACHE_VERSION   "1"
+
+/** Kind of a dependency of YAML configuration file processing result */
+typedef enum cs_yaml_dep_kind {
+    CS_YAML_DEP_FILE,       /**< Content of a processed file */
+    CS_YAML_DEP_INCLUDE,    /**< Resolution of an included file name */
+    CS_YAML_DEP_EXPAND,     /**< Expansion of a value in a condition */
+} cs_yaml_dep_kind;
+
+/** Names of dependency nodes in the cache file */
+static const char * const cs_yaml_dep_names[] = {
+    [CS_YAML_DEP_FILE] = "file",
+    [CS_YAML_DEP_INCLUDE] = "include",
+    [CS_YAML_DEP_EXPAND] = "expand",
+};
+
+/**
+ * Dependency of YAML configuration file processing result: the result
+ * may be reused only if all its dependencies are the same.
+ */
+typedef struct cs_yaml_dep {
+    cs_yaml_dep_kind    kind;   /**< Kind of the dependency */
+    char               *key;    /**< File path, included file name or
+                                     value to expand */
+    char               *base;   /**< Including file path for includes,
+                                     @c NULL otherwise */
+    char               *val;    /**< Content hash, resolved path or
+                                     expansion result */
+} cs_yaml_dep;
+
 typedef struct parse_config_yaml_ctx {
     char            *file_path;
     yaml_document_t *doc;
     xmlNodePtr       xn_history;
     te_kvpair_h     *expand_vars;
     const char      *conf_dirs;
+    te_vec          *deps;      /**< Dependencies of the result or
+                                     @c NULL if they are not collected */
 } parse_config_yaml_ctx;
 
 typedef struct config_yaml_target_s {
@@ -77,21 +114,82 @@ get_yaml_cmd_target(const char *cmd)
     return target->target_name;
 }
 
-static te_errno
-get_val(const logic_expr *parsed, void *expand_vars, logic_expr_res *res)
+/**
+ * Add a dependency of YAML configuration file processing result.
+ *
+ * @param deps          dependencies or @c NULL if they are not collected
+ * @param kind          kind of the dependency
+ * @param key           file path, included file name or value to expand
+ * @param base          including file path or @c NULL
+ * @param val           content hash, resolved path or expansion result
+ */
+static void
+cs_yaml_dep_add(te_vec *deps, cs_yaml_dep_kind kind, const char *key,
+                const char *base, const char *val)
 {
-    te_errno rc;
+    cs_yaml_dep dep;
+
+    if (deps == NULL)
+        return;
+
+    dep.kind = kind;
+    dep.key = TE_STRDUP(key);
+    dep.base = base == NULL ? NULL : TE_STRDUP(base);
+    dep.val = TE_STRDUP(val);
+    TE_VEC_APPEND(deps, dep);
+}
+
+/**
+ * Release dependencies.
+ *
+ * @param deps          dependencies
+ */
+static void
+cs_yaml_deps_free(te_vec *deps)
+{
+    cs_yaml_dep *dep;
 
+    TE_VEC_FOREACH(deps, dep)
+    {
+        free(dep->key);
+        free(dep->base);
+        free(dep->val);
+    }
+    te_vec_free(deps);
+}
+
+/**
+ * Expand a value in the same way as values of conditions.
+ *
+ * @param value             value to expand
+ * @param expand_vars       List of key-value pairs for expansion,
+ *                          @c NULL if environment variables are used
+ * @param result            location for the allocated result
+ *
+ * @return Status code.
+ */
+static te_errno
+cs_yaml_expand(const char *value, te_kvpair_h *expand_vars, char **result)
+{
     if (expand_vars != NULL)
-        rc = te_expand_kvpairs(parsed->u.value, NULL,
-                               (te_kvpair_h *)expand_vars,
-                               &res->value.simple);
-    else
-        rc = te_expand_env_vars(parsed->u.value, NULL,
-                                &res->value.simple);
+        return te_expand_kvpairs(value, NULL, expand_vars, result);
+
+    return te_expand_env_vars(value, NULL, result);
+}
+
+static te_errno
+get_val(const logic_expr *parsed, void *opaque, logic_expr_res *res)
+{
+    parse_config_yaml_ctx *ctx = opaque;
+    te_errno               rc;
+
+    rc = cs_yaml_expand(parsed->u.value, ctx->expand_vars,
+                        &res->value.simple);
     if (rc != 0)
         goto out;
 
+    cs_yaml_dep_add(ctx->deps, CS_YAML_DEP_EXPAND, parsed->u.value, NULL,
+                    res->value.simple);
     res->res_type = LOGIC_EXPR_RES_SIMPLE;
 
 out:
@@ -103,14 +201,12 @@ out:
  *
  * @param str               String representation of the expression
  * @param res               Location for the result
- * @param expand_vars       List of key-value pairs for expansion in file,
- *                          @c NULL if environment variables are used for
- *                          substitutions
+ * @param ctx               Current doc context
  *
  * @return Status code.
  */
 static te_errno
-parse_logic_expr_str(const char *str, bool *res, te_kvpair_h *expand_vars)
+parse_logic_expr_str(const char *str, bool *res, parse_config_yaml_ctx *ctx)
 {
     logic_expr *parsed = NULL;
     logic_expr_res parsed_res;
@@ -123,7 +219,7 @@ parse_logic_expr_str(const char *str, bool *res, te_kvpair_h *expand_vars)
         goto out;
     }
 
-    rc = logic_expr_eval(parsed, get_val, expand_vars, &parsed_res);
+    rc = logic_expr_eval(parsed, get_val, ctx, &parsed_res);
     if (rc != 0)
     {
         ERROR("Failed to evaluate expression '%s'", str);
@@ -146,7 +242,8 @@ out:
 }
 
 static te_errno
-parse_config_if_expr(yaml_node_t *n, bool *if_expr, te_kvpair_h *expand_vars)
+parse_config_if_expr(yaml_node_t *n, bool *if_expr,
+                     parse_config_yaml_ctx *ctx)
 {
     const char *str = NULL;
     te_errno    rc = 0;
@@ -162,7 +259,7 @@ parse_config_if_expr(yaml_node_t *n, bool *if_expr, te_kvpair_h *expand_vars)
             return TE_EINVAL;
         }
 
-        rc = parse_logic_expr_str(str, if_expr, expand_vars);
+        rc = parse_logic_expr_str(str, if_expr, ctx);
         if (rc != 0)
         {
             ERROR(CS_YAML_ERR_PREFIX "failed to evaluate the expression "
@@ -421,7 +518,7 @@ parse_config_yaml_cmd_add_target_attribute(yaml_document_t        *d,
                                        yaml_node_t                *k,
                                        yaml_node_t                *v,
                                        cs_yaml_target_context_t   *c,
-                                       te_kvpair_h                *expand_vars)
+                                       parse_config_yaml_ctx      *ctx)
 {
     cs_yaml_node_attribute_type_t attribute_type;
     te_errno                      rc = 0;
@@ -438,7 +535,7 @@ parse_config_yaml_cmd_add_target_attribute(yaml_document_t        *d,
     switch (attribute_type)
     {
         case CS_YAML_NODE_ATTRIBUTE_CONDITION:
-            rc = parse_config_if_expr(v, &c->cond, expand_vars);
+            rc = parse_config_if_expr(v, &c->cond, ctx);
             if (rc != 0)
             {
               ERROR(CS_YAML_ERR_PREFIX "failed to process the condition "
@@ -686,6 +783,12 @@ embed_yaml_target_in_xml(xmlNodePtr xn_cmd, xmlNodePtr xn_target,
     }
 }
 
+static te_errno parse_config_yaml_file(const char *filename,
+                                       te_kvpair_h *expand_vars,
+                                       xmlNodePtr xn_history,
+                                       const char *conf_dirs,
+                                       te_vec *deps);
+
 static te_errno
 parse_config_yaml_include_doc(parse_config_yaml_ctx *ctx, yaml_node_t *n)
 {
@@ -706,8 +809,11 @@ parse_config_yaml_include_doc(parse_config_yaml_ctx *ctx, yaml_node_t *n)
                                                    &resolved_file_name);
     if (rc_resolve_pathname == 0)
     {
-        rc = parse_config_yaml(resolved_file_name, ctx->expand_vars,
-                               ctx->xn_history, ctx->conf_dirs);
+        cs_yaml_dep_add(ctx->deps, CS_YAML_DEP_INCLUDE, file_name,
+                        ctx->file_path, resolved_file_name);
+        rc = parse_config_yaml_file(resolved_file_name, ctx->expand_vars,
+                                    ctx->xn_history, ctx->conf_dirs,
+                                    ctx->deps);
     }
     else
     {
@@ -755,7 +861,6 @@ parse_config_yaml_cmd_process_target(parse_config_yaml_ctx *ctx, yaml_node_t *n,
                                      xmlNodePtr xn_cmd, const char *cmd)
 {
     yaml_document_t            *d = ctx->doc;
-    te_kvpair_h                *expand_vars = ctx->expand_vars;
     xmlNodePtr                  xn_target = NULL;
     cs_yaml_target_context_t    c = YAML_TARGET_CONTEXT_INIT;
     const char                 *target;
@@ -807,7 +912,7 @@ parse_config_yaml_cmd_process_target(parse_config_yaml_ctx *ctx, yaml_node_t *n,
             yaml_node_t *v = yaml_document_get_node(d, pair->value);
 
             rc = parse_config_yaml_cmd_add_target_attribute(d, k, v, &c,
-                                                            expand_vars);
+                                                            ctx);
             if (rc != 0)
             {
                 ERROR(CS_YAML_ERR_PREFIX "failed to process %s"
@@ -902,7 +1007,6 @@ parse_config_yaml_specified_cmd(parse_config_yaml_ctx *ctx, yaml_node_t *n,
                                 const char *cmd)
 {
     yaml_document_t *d = ctx->doc;
-    te_kvpair_h     *expand_vars = ctx->expand_vars;
     xmlNodePtr       xn_history = ctx->xn_history;
 
     xmlNodePtr  xn_cmd = NULL;
@@ -954,7 +1058,7 @@ parse_config_yaml_specified_cmd(parse_config_yaml_ctx *ctx, yaml_node_t *n,
 
             if (strcmp(k_label, "if") == 0)
             {
-                rc = parse_config_if_expr(v, &cond, expand_vars);
+                rc = parse_config_if_expr(v, &cond, ctx);
             }
             else if (strcmp(k_label, "then") == 0)
             {
@@ -1114,55 +1218,97 @@ parse_config_yaml_cmd(parse_config_yaml_ctx *ctx,
     return rc;
 }
 
-/* See description in 'conf_yaml.h' */
-te_errno
-parse_config_yaml(const char *filename, te_kvpair_h *expand_vars,
-                  xmlNodePtr xn_history_root, const char *conf_dirs)
+/**
+ * Compute hash of data (64-bit FNV-1a).
+ *
+ * @param hash              hash of preceding data or @c 0
+ * @param data              data
+ * @param len               length of the data
+ *
+ * @return Hash of the preceding data and @p data.
+ */
+static uint64_t
+cs_yaml_hash(uint64_t hash, const void *data, size_t len)
+{
+    const uint8_t *p = data;
+    size_t         i;
+
+    if (hash == 0)
+        hash = UINT64_C(14695981039346656037);
+
+    for (i = 0; i < len; i++)
+    {
+        hash ^= p[i];
+        hash *= UINT64_C(1099511628211);
+    }
+
+    return hash;
+}
+
+/**
+ * Get string representation of content hash of a file.
+ *
+ * @param content           content of the file
+ * @param result            location for the allocated string
+ */
+static void
+cs_yaml_content_hash(const te_string *content, char **result)
+{
+    te_string str = TE_STRING_INIT;
+
+    te_string_append(&str, "%016" PRIx64 "-%zu",
+                     cs_yaml_hash(0, content->ptr, content->len),
+                     content->len);
+    *result = str.ptr;
+}
+
+/**
+ * Parse YAML configuration file and embed commands in XML document.
+ *
+ * @param filename          The input file path
+ * @param expand_vars       List of key-value pairs for expansion in file,
+ *                          @c NULL if environment variables are used for
+ *                          substitutions
+ * @param xn_history        XML node to add commands to
+ * @param conf_dirs         Directories where additionally Configurator should
+ *                          search files via include directive
+ * @param deps              Location for dependencies of the result or
+ *                          @c NULL
+ *
+ * @return Status code.
+ */
+static te_errno
+parse_config_yaml_file(const char *filename, te_kvpair_h *expand_vars,
+                       xmlNodePtr xn_history, const char *conf_dirs,
+                       te_vec *deps)
 {
-    FILE                   *f = NULL;
+    te_string               content = TE_STRING_INIT;
     yaml_parser_t           parser;
     yaml_document_t         dy;
-    xmlNodePtr              xn_history = NULL;
     yaml_node_t            *root = NULL;
     te_errno                rc = 0;
-    char                   *current_yaml_file_path;
+    char                   *hash;
     parse_config_yaml_ctx   ctx;
 
-    f = fopen(filename, "rb");
-    if (f == NULL)
+    rc = te_file_read_string(&content, true, 0, "%s", filename);
+    if (rc != 0)
     {
-        ERROR(CS_YAML_ERR_PREFIX "failed to open the target file '%s'",
+        ERROR(CS_YAML_ERR_PREFIX "failed to read the target file '%s'",
               filename);
-        return TE_OS_RC(TE_CS, errno);
+        return TE_RC(TE_CS, rc);
     }
 
-    yaml_parser_initialize(&parser);
-    yaml_parser_set_input_file(&parser, f);
-    yaml_parser_load(&parser, &dy);
-    fclose(f);
-
-    current_yaml_file_path = strdup(filename);
-    if (current_yaml_file_path == NULL)
+    if (deps != NULL)
     {
-        rc = TE_ENOMEM;
-        goto out;
+        cs_yaml_content_hash(&content, &hash);
+        cs_yaml_dep_add(deps, CS_YAML_DEP_FILE, filename, NULL, hash);
+        free(hash);
     }
 
-    if (xn_history_root == NULL)
-    {
-        xn_history = xmlNewNode(NULL, BAD_CAST "history");
-        if (xn_history == NULL)
-        {
-            ERROR(CS_YAML_ERR_PREFIX "failed to allocate "
-                  "main history node for XML output");
-            rc = TE_ENOMEM;
-            goto out;
-        }
-    }
-    else
-    {
-        xn_history = xn_history_root;
-    }
+    yaml_parser_initialize(&parser);
+    yaml_parser_set_input_string(&parser, (const unsigned char *)content.ptr,
+                                 content.len);
+    yaml_parser_load(&parser, &dy);
 
     root = yaml_document_get_root_node(&dy);
     if (root == NULL)
@@ -1182,21 +1328,291 @@ parse_config_yaml(const char *filename, te_kvpair_h *expand_vars,
     }
 
     memset(&ctx, 0, sizeof(ctx));
-    ctx.file_path = current_yaml_file_path;
+    ctx.file_path = TE_STRDUP(filename);
     ctx.doc = &dy;
     ctx.xn_history = xn_history;
     ctx.expand_vars = expand_vars;
     ctx.conf_dirs = conf_dirs;
+    ctx.deps = deps;
     rc = parse_config_yaml_cmd(&ctx, root);
+    free(ctx.file_path);
     if (rc != 0)
     {
         ERROR(CS_YAML_ERR_PREFIX
               "encountered some error(s) on file '%s' processing",
               filename);
+    }
+
+out:
+    yaml_document_delete(&dy);
+    yaml_parser_delete(&parser);
+    te_string_free(&content);
+
+    return rc;
+}
+
+/**
+ * Get the name of the file with cached result of processing of
+ * a YAML configuration file.
+ *
+ * @param cache_dir         Cache directory
+ * @param filename          The input file path
+ * @param expand_vars       List of key-value pairs for expansion in file
+ * @param conf_dirs         Directories to search included files
+ *
+ * @return Allocated file name.
+ */
+static char *
+cs_yaml_cache_file(const char *cache_dir, const char *filename,
+                   te_kvpair_h *expand_vars, const char *conf_dirs)
+{
+    te_string   path = TE_STRING_INIT;
+    char       *real = realpath(filename, NULL);
+    const char *mode = expand_vars == NULL ? "env" : "kvpairs";
+    uint64_t    key;
+
+    if (conf_dirs == NULL)
+        conf_dirs = "";
+
+    key = cs_yaml_hash(0, real != NULL ? real : filename,
+                       strlen(real != NULL ? real : filename) + 1);
+    key = cs_yaml_hash(key, conf_dirs, strlen(conf_dirs) + 1);
+    key = cs_yaml_hash(key, mode, strlen(mode) + 1);
+    free(real);
+
+    te_string_append(&path, "%s/yaml-%016" PRIx64 ".xml", cache_dir, key);
+
+    return path.ptr;
+}
+
+/**
+ * Check that a dependency recorded in the cache file still holds.
+ *
+ * @param node              Dependency node
+ * @param expand_vars       List of key-value pairs for expansion in file
+ * @param conf_dirs         Directories to search included files
+ *
+ * @return @c true if the dependency holds.
+ */
+static bool
+cs_yaml_cache_dep_valid(xmlNodePtr node, te_kvpair_h *expand_vars,
+                        const char *conf_dirs)
+{
+    char       *key = (char *)xmlGetProp(node, BAD_CAST "key");
+    char       *base = (char *)xmlGetProp(node, BAD_CAST "base");
+    char       *val = (char *)xmlGetProp(node, BAD_CAST "val");
+    char       *actual = NULL;
+    te_string   content = TE_STRING_INIT;
+    bool        valid = false;
+
+    if (key == NULL || val == NULL)
         goto out;
+
+    if (xmlStrcmp(node->name,
+                  BAD_CAST cs_yaml_dep_names[CS_YAML_DEP_FILE]) == 0)
+    {
+        if (te_file_read_string(&content, true, 0, "%s", key) == 0)
+            cs_yaml_content_hash(&content, &actual);
+    }
+    else if (xmlStrcmp(node->name,
+                       BAD_CAST cs_yaml_dep_names[CS_YAML_DEP_INCLUDE]) == 0)
+    {
+        if (base != NULL &&
+            te_file_resolve_pathname(key, conf_dirs, F_OK, base,
+                                     &actual) != 0)
+        {
+            actual = NULL;
+        }
+    }
+    else if (xmlStrcmp(node->name,
+                       BAD_CAST cs_yaml_dep_names[CS_YAML_DEP_EXPAND]) == 0)
+    {
+        if (cs_yaml_expand(key, expand_vars, &actual) != 0)
+            actual = NULL;
+    }
+
+    valid = actual != NULL && strcmp(actual, val) == 0;
+
+out:
+    if (!valid)
+    {
+        INFO(CS_YAML_ERR_PREFIX "cached result is outdated: %s '%s' "
+             "is changed", (const char *)node->name,
+             key == NULL ? "" : key);
+    }
+    free(actual);
+    te_string_free(&content);
+    xmlFree(key);
+    xmlFree(base);
+    xmlFree(val);
+
+    return valid;
+}
+
+/**
+ * Load cached result of processing of a YAML configuration file
+ * if all its dependencies hold.
+ *
+ * @param cache_file        Cache file name
+ * @param expand_vars       List of key-value pairs for expansion in file
+ * @param conf_dirs         Directories to search included files
+ * @param doc               Location for the cache document
+ * @param xn_history        Location for the history node of the document
+ *
+ * @return @c true if the cached result is loaded.
+ */
+static bool
+cs_yaml_cache_load(const char *cache_file, te_kvpair_h *expand_vars,
+                   const char *conf_dirs, xmlDocPtr *doc,
+                   xmlNodePtr *xn_history)
+{
+    xmlNodePtr  root;
+    xmlNodePtr  node;
+    xmlChar    *version;
+    bool        valid;
+
+    if (access(cache_file, R_OK) != 0)
+        return false;
+
+    *doc = xmlParseFile(cache_file);
+    if (*doc == NULL)
+    {
+        WARN(CS_YAML_ERR_PREFIX "failed to parse cache file '%s'",
+             cache_file);
+        return false;
+    }
+
+    *xn_history = NULL;
+    root = xmlDocGetRootElement(*doc);
+    version = root == NULL ? NULL : xmlGetProp(root, BAD_CAST "version");
+    valid = version != NULL &&
+            xmlStrcmp(root->name, BAD_CAST "yaml_cache") == 0 &&
+            xmlStrcmp(version, BAD_CAST CS_YAML_CACHE_VERSION) == 0;
+    xmlFree(version);
+
+    for (node = valid ? root->children : NULL; node != NULL && valid;
+         node = node->next)
+    {
+        if (node->type != XML_ELEMENT_NODE)
+            continue;
+
+        if (xmlStrcmp(node->name, BAD_CAST "history") == 0)
+            *xn_history = node;
+        else
+            valid = cs_yaml_cache_dep_valid(node, expand_vars, conf_dirs);
+    }
+
+    if (!valid || *xn_history == NULL)
+    {
+        xmlFreeDoc(*doc);
+        *doc = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Save result of processing of a YAML configuration file with its
+ * dependencies. Failures are not fatal, they are only reported.
+ *
+ * @param cache_dir         Cache directory
+ * @param cache_file        Cache file name
+ * @param deps              Dependencies of the result
+ * @param xn_history        Result of processing
+ */
+static void
+cs_yaml_cache_save(const char *cache_dir, const char *cache_file,
+                   const te_vec *deps, xmlNodePtr xn_history)
+{
+    te_string    tmp_file = TE_STRING_INIT;
+    xmlDocPtr    doc = xmlNewDoc(BAD_CAST "1.0");
+    xmlNodePtr   root;
+    xmlNodePtr   node;
+
+    const cs_yaml_dep *dep;
+
+    if (mkdir(cache_dir, 0755) != 0 && errno != EEXIST)
+    {
+        WARN(CS_YAML_ERR_PREFIX "failed to create cache directory '%s': %r",
+             cache_dir, TE_OS_RC(TE_CS, errno));
+        xmlFreeDoc(doc);
+        return;
     }
 
-    if (xn_history_root == NULL && xn_history->children != NULL)
+    root = xmlNewDocNode(doc, NULL, BAD_CAST "yaml_cache", NULL);
+    xmlDocSetRootElement(doc, root);
+    xmlNewProp(root, BAD_CAST "version", BAD_CAST CS_YAML_CACHE_VERSION);
+
+    TE_VEC_FOREACH(deps, dep)
+    {
+        node = xmlNewChild(root, NULL, BAD_CAST cs_yaml_dep_names[dep->kind],
+                           NULL);
+        xmlNewProp(node, BAD_CAST "key", BAD_CAST dep->key);
+        if (dep->base != NULL)
+            xmlNewProp(node, BAD_CAST "base", BAD_CAST dep->base);
+        xmlNewProp(node, BAD_CAST "val", BAD_CAST dep->val);
+    }
+    xmlAddChild(root, xmlDocCopyNode(xn_history, doc, 1));
+
+    /* Readers never see partially written cache files */
+    te_string_append(&tmp_file, "%s.%d.tmp", cache_file, (int)getpid());
+    if (xmlSaveFile(tmp_file.ptr, doc) < 0 ||
+        rename(tmp_file.ptr, cache_file) != 0)
+    {
+        WARN(CS_YAML_ERR_PREFIX "failed to save cache file '%s'",
+             cache_file);
+        unlink(tmp_file.ptr);
+    }
+
+    te_string_free(&tmp_file);
+    xmlFreeDoc(doc);
+}
+
+/* See description in 'conf_yaml.h' */
+te_errno
+parse_config_yaml(const char *filename, te_kvpair_h *expand_vars,
+                  const char *conf_dirs, const char *cache_dir)
+{
+    te_vec       deps = TE_VEC_INIT(cs_yaml_dep);
+    xmlDocPtr    cache_doc = NULL;
+    xmlNodePtr   xn_history = NULL;
+    char        *cache_file = NULL;
+    te_errno     rc = 0;
+
+    if (cache_dir != NULL)
+    {
+        cache_file = cs_yaml_cache_file(cache_dir, filename, expand_vars,
+                                        conf_dirs);
+        if (cs_yaml_cache_load(cache_file, expand_vars, conf_dirs,
+                               &cache_doc, &xn_history))
+        {
+            RING("Using cached result of processing '%s'", filename);
+        }
+    }
+
+    if (xn_history == NULL)
+    {
+        xn_history = xmlNewNode(NULL, BAD_CAST "history");
+        if (xn_history == NULL)
+        {
+            ERROR(CS_YAML_ERR_PREFIX "failed to allocate "
+                  "main history node for XML output");
+            rc = TE_ENOMEM;
+            goto out;
+        }
+
+        rc = parse_config_yaml_file(filename, expand_vars, xn_history,
+                                    conf_dirs,
+                                    cache_file == NULL ? NULL : &deps);
+        if (rc != 0)
+            goto out;
+
+        if (cache_file != NULL)
+            cs_yaml_cache_save(cache_dir, cache_file, &deps, xn_history);
+    }
+
+    if (xn_history->children != NULL)
     {
         rcf_log_cfg_changes(true);
         rc = parse_config_dh_sync(xn_history, expand_vars);
@@ -1204,12 +1620,12 @@ parse_config_yaml(const char *filename, te_kvpair_h *expand_vars,
     }
 
 out:
-    if (xn_history_root == NULL)
+    if (cache_doc != NULL)
+        xmlFreeDoc(cache_doc);
+    else
         xmlFreeNode(xn_history);
-    yaml_document_delete(&dy);
-    yaml_parser_delete(&parser);
-    free(current_yaml_file_path);
+    free(cache_file);
+    cs_yaml_deps_free(&deps);
 
     return rc;
 }
-
@@ -24,21 +24,27 @@
  *
  * The XML document will be consumed directly by cfg_dh_process_file().
  *
+ * If @p cache_dir is specified, the XML document is saved there together
+ * with content hashes of the file and all included files and results of
+ * expansion of variables in the conditions. Next time the document is
+ * loaded from the cache instead of processing YAML files if none of
+ * them is changed.
+ *
  * @param filename          The input file path
  * @param expand_vars       List of key-value pairs for expansion in file,
  *                          @c NULL if environment variables are used for
  *                          substitutions
- * @param xn_history_root   XML node containing translated yaml file content,
- *                          @c NULL if yaml file is not being included
  * @param conf_dirs         Directories where additionally Configurator should
  *                          search files via include directive
  *                          @c NULL if there are no configuration directories.
+ * @param cache_dir         Directory to cache results of processing in or
+ *                          @c NULL
  *
  * @return Status code.
  */
 extern te_errno parse_config_yaml(const char *filename,
                                   te_kvpair_h *expand_vars,
-                                  xmlNodePtr xn_history_root,
-                                  const char *conf_dirs);
+                                  const char *conf_dirs,
+                                  const char *cache_dir);
 
 #endif /* __TE_CONF_YAML_H__ */
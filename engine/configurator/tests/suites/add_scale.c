@@ -0,0 +1,239 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/** @file
+ * @brief Configurator Tester
+ *
+ * Scalability of instance addition and deletion
+ *
+ * Populate the database with @c ADD_SCALE_SMALL and then with
+ * @c ADD_SCALE_LARGE instances reported by the emulated agent, measure
+ * the average time of adding and deleting an instance and the memory
+ * consumed by the Configurator, and check that the time of addition
+ * and deletion does not depend on the size of the database.
+ *
+ * Copyright (C) 2004-2023 OKTET Labs Ltd. All rights reserved.
+ */
+
+#define LOG_LEVEL 0xff
+#define TE_LOG_LEVEL 0xff
+
+#include <sys/time.h>
+#include <dirent.h>
+
+#include "te_string.h"
+#include "logger_file.h"
+#include "test.h"
+#include "../paths.c"
+
+/** Number of instances in the small database */
+#define ADD_SCALE_SMALL         1000
+/** Number of instances in the large database */
+#define ADD_SCALE_LARGE         100000
+/** Number of network addresses per interface */
+#define ADD_SCALE_ADDRS         1000
+/** Number of instances added and deleted in a measurement */
+#define ADD_SCALE_OPS           1000
+/**
+ * Maximum allowed ratio of the average time of addition and deletion
+ * in the large and small databases.
+ */
+#define ADD_SCALE_MAX_RATIO     3
+
+#define RC(expr_) \
+    do {                                                \
+        int rc_ = 0;                                    \
+                                                        \
+        rc_ = (expr_);                                  \
+        if (rc_ != 0)                                   \
+        {                                               \
+            printf("%s returned %d\n", # expr_, rc_);   \
+            goto cleanup;                               \
+        }                                               \
+    } while (0)
+
+/** Number of instances reported by the agent */
+static unsigned int add_scale_num;
+/** Buffer with the agent reply */
+static te_string add_scale_reply = TE_STRING_INIT;
+
+/**
+ * Conf get request handler which reports @c add_scale_num
+ * network addresses spread over a number of interfaces.
+ */
+static int
+add_scale_conf_get(char *ta_name, char *oid, char **answer, int *ans_len)
+{
+    unsigned int i;
+
+    UNUSED(ta_name);
+
+    te_string_reset(&add_scale_reply);
+    if (strstr(oid, "...") != NULL)
+    {
+        te_string_append(&add_scale_reply, "/agent:Agt_T");
+        for (i = 0; i < add_scale_num; i++)
+        {
+            if (i % ADD_SCALE_ADDRS == 0)
+            {
+                te_string_append(&add_scale_reply,
+                                 " /agent:Agt_T/interface:if%u",
+                                 i / ADD_SCALE_ADDRS);
+            }
+            te_string_append(&add_scale_reply,
+                             " /agent:Agt_T/interface:if%u/net_addr:%u",
+                             i / ADD_SCALE_ADDRS, i % ADD_SCALE_ADDRS);
+        }
+    }
+
+    *answer = add_scale_reply.ptr;
+    *ans_len = add_scale_reply.len + 1;
+    return 0;
+}
+
+/**
+ * Get resident memory size of the Configurator process.
+ *
+ * @return Size in kilobytes or @c 0 if the process is not found.
+ */
+static unsigned long
+add_scale_cs_rss(void)
+{
+    DIR            *dir = opendir("/proc");
+    struct dirent  *ent;
+    unsigned long   rss = 0;
+    char            path[PATH_MAX];
+    char            line[128];
+    FILE           *f;
+
+    if (dir == NULL)
+        return 0;
+
+    while (rss == 0 && (ent = readdir(dir)) != NULL)
+    {
+        snprintf(path, sizeof(path), "/proc/%s/comm", ent->d_name);
+        f = fopen(path, "r");
+        if (f == NULL)
+            continue;
+        if (fgets(line, sizeof(line), f) == NULL ||
+            strcmp(line, "te_cs\n") != 0)
+        {
+            fclose(f);
+            continue;
+        }
+        fclose(f);
+
+        snprintf(path, sizeof(path), "/proc/%s/status", ent->d_name);
+        f = fopen(path, "r");
+        if (f == NULL)
+            continue;
+        while (fgets(line, sizeof(line), f) != NULL)
+        {
+            if (sscanf(line, "VmRSS: %lu", &rss) == 1)
+                break;
+        }
+        fclose(f);
+    }
+    closedir(dir);
+
+    return rss;
+}
+
+/**
+ * Populate the database with @p num instances and measure the average
+ * time of adding and deleting an instance.
+ *
+ * @param num       number of instances
+ * @param usec      location for the average time of addition and deletion
+ * @param rss       location for the memory consumed by the Configurator
+ *
+ * @return Status code.
+ */
+static te_errno
+add_scale_run(unsigned int num, long *usec, unsigned long *rss)
+{
+    static cfg_handle   handles[ADD_SCALE_OPS];
+    struct timeval      tv_start;
+    struct timeval      tv_end;
+    unsigned int        i;
+    te_errno            rc;
+
+    add_scale_num = num;
+    rc = cfg_synchronize("/agent:Agt_T", true);
+    if (rc != 0)
+        return rc;
+
+    *rss = add_scale_cs_rss();
+
+    gettimeofday(&tv_start, NULL);
+    for (i = 0; i < ADD_SCALE_OPS; i++)
+    {
+        rc = cfg_add_instance_fmt(&handles[i], CFG_VAL(NONE, NULL),
+                                  "/agent:Agt_T/user:u%u", i);
+        if (rc != 0)
+            return rc;
+    }
+    for (i = 0; i < ADD_SCALE_OPS; i++)
+    {
+        rc = cfg_del_instance(handles[i], false);
+        if (rc != 0)
+            return rc;
+    }
+    gettimeofday(&tv_end, NULL);
+
+    *usec = (TE_SEC2US(tv_end.tv_sec - tv_start.tv_sec) +
+             tv_end.tv_usec - tv_start.tv_usec) / ADD_SCALE_OPS;
+    printf("Addition and deletion with %u instances took %ld us, "
+           "Configurator RSS is %lu kB\n", num, *usec, *rss);
+
+    return 0;
+}
+
+int
+main(void)
+{
+    COMMON_TEST_PARAMS;
+    int                     conf;
+    long                    small_usec;
+    long                    large_usec;
+    unsigned long           small_rss;
+    unsigned long           large_rss;
+
+    te_log_init("add_scale", te_log_message_file);
+
+    EXPORT_ENV;
+
+    START_LOGGER("logger.conf");
+    START_RCF_EMULATOR("config.db");
+    RCFRH_CONFIGURATION_CREATE(conf);
+    RCFRH_SET_DEFAULT_HANDLERS(conf);
+    rcf_get_cfg_by_id(conf)->conf_get = add_scale_conf_get;
+    RCFRH_CONFIGURATION_SET_CURRENT(conf);
+
+    START_CONFIGURATOR("test.conf");
+
+    RC(add_scale_run(ADD_SCALE_SMALL, &small_usec, &small_rss));
+    RC(add_scale_run(ADD_SCALE_LARGE, &large_usec, &large_rss));
+
+    if (large_rss > small_rss)
+    {
+        printf("Memory per network address instance is about %lu bytes\n",
+               (large_rss - small_rss) * 1024 /
+               (ADD_SCALE_LARGE - ADD_SCALE_SMALL));
+    }
+
+    if (large_usec > ADD_SCALE_MAX_RATIO * MAX(small_usec, 1))
+    {
+        printf("Addition and deletion do not scale: %ld us for %u "
+               "instances, %ld us for %u instances\n",
+               small_usec, ADD_SCALE_SMALL, large_usec, ADD_SCALE_LARGE);
+        goto cleanup;
+    }
+
+    CONFIGURATOR_TEST_SUCCESS;
+cleanup:
+    STOP_CONFIGURATOR;
+    STOP_RCF_EMULATOR;
+    STOP_LOGGER;
+
+    te_string_free(&add_scale_reply);
+    CONFIGURATOR_TEST_END;
+}
@@ -0,0 +1,150 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/** @file
+ * @brief Configurator Tester
+ *
+ * Pipelined requests
+ *
+ * Find and get a number of instances through cfg_async context
+ * without waiting for completions and check that completions are
+ * reported in order of requests with their results.
+ *
+ * Copyright (C) 2004-2023 OKTET Labs Ltd. All rights reserved.
+ */
+
+#define LOG_LEVEL 0xff
+#define TE_LOG_LEVEL 0xff
+
+#include "logger_file.h"
+#include "test.h"
+#include "../paths.c"
+
+/** Number of instances */
+#define ASYNC_INSTS     100
+
+#define RC(expr_) \
+    do {                                                \
+        int rc_ = 0;                                    \
+                                                        \
+        rc_ = (expr_);                                  \
+        if (rc_ != 0)                                   \
+        {                                               \
+            printf("%s returned %d\n", # expr_, rc_);   \
+            goto cleanup;                               \
+        }                                               \
+    } while (0)
+
+/**
+ * Collect completions of @c ASYNC_INSTS requests tagged with
+ * @p first_tag and following numbers.
+ *
+ * @param async         context
+ * @param first_tag     tag of the first request
+ * @param check_val     whether values obtained by get should be checked
+ *                      (handles are checked otherwise)
+ *
+ * @return Status code.
+ */
+static te_errno
+async_collect(cfg_async *async, uint64_t first_tag, bool check_val)
+{
+    cfg_async_compl  compl;
+    char             expected[32];
+    unsigned int     i;
+    te_errno         rc;
+
+    for (i = 0; i < ASYNC_INSTS; i++)
+    {
+        rc = cfg_async_wait(async, &compl);
+        if (rc != 0)
+            return rc;
+
+        if (compl.tag != first_tag + i)
+        {
+            printf("Completion of request %llu instead of %llu\n",
+                   (unsigned long long)compl.tag,
+                   (unsigned long long)(first_tag + i));
+            return TE_EFAIL;
+        }
+        if (compl.rc != 0)
+            return compl.rc;
+        if (!check_val)
+        {
+            if (compl.handle == CFG_HANDLE_INVALID)
+            {
+                printf("Invalid handle of instance %u\n", i);
+                return TE_EFAIL;
+            }
+            continue;
+        }
+
+        snprintf(expected, sizeof(expected), "value%u", i);
+        rc = (compl.type == CVT_STRING &&
+              strcmp(compl.val.val_str, expected) == 0) ? 0 : TE_EFAIL;
+        if (compl.type == CVT_STRING)
+            free(compl.val.val_str);
+        if (rc != 0)
+        {
+            printf("Unexpected value of instance %u\n", i);
+            return rc;
+        }
+    }
+
+    return 0;
+}
+
+int
+main(void)
+{
+    COMMON_TEST_PARAMS;
+    int                     conf;
+    cfg_async              *async = NULL;
+    char                    str[32];
+    unsigned int            i;
+
+    te_log_init("async", te_log_message_file);
+
+    EXPORT_ENV;
+
+    START_LOGGER("logger.conf");
+    START_RCF_EMULATOR("config.db");
+    RCFRH_CONFIGURATION_CREATE(conf);
+    RCFRH_SET_DEFAULT_HANDLERS(conf);
+    RCFRH_CONFIGURATION_SET_CURRENT(conf);
+
+    START_CONFIGURATOR("test.conf");
+
+    for (i = 0; i < ASYNC_INSTS; i++)
+    {
+        snprintf(str, sizeof(str), "value%u", i);
+        RC(cfg_add_instance_fmt(NULL, CVT_STRING, str,
+                                "/agent:Agt_T/env:VAR%u", i));
+    }
+
+    RC(cfg_async_open(&async));
+
+    for (i = 0; i < ASYNC_INSTS; i++)
+        RC(cfg_async_find_fmt(async, i, "/agent:Agt_T/env:VAR%u", i));
+    RC(async_collect(async, 0, false));
+
+    for (i = 0; i < ASYNC_INSTS; i++)
+    {
+        RC(cfg_async_get_fmt(async, ASYNC_INSTS + i, CVT_STRING,
+                             "/agent:Agt_T/env:VAR%u", i));
+    }
+    RC(async_collect(async, ASYNC_INSTS, true));
+
+    if (cfg_async_pending(async) != 0)
+    {
+        printf("Requests are pending after all completions\n");
+        goto cleanup;
+    }
+
+    CONFIGURATOR_TEST_SUCCESS;
+cleanup:
+    cfg_async_close(async);
+    STOP_CONFIGURATOR;
+    STOP_RCF_EMULATOR;
+    STOP_LOGGER;
+
+    CONFIGURATOR_TEST_END;
+}
@@ -0,0 +1,162 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/** @file
+ * @brief Configurator Tester
+ *
+ * Latency statistics of operations
+ *
+ * Find, add, get and delete instances, check that the operations and
+ * RCF calls made by the Configurator are accounted in statistics and
+ * that statistics are reset on request.
+ *
+ * Copyright (C) 2004-2023 OKTET Labs Ltd. All rights reserved.
+ */
+
+#define LOG_LEVEL 0xff
+#define TE_LOG_LEVEL 0xff
+
+#include "logger_file.h"
+#include "test.h"
+#include "../paths.c"
+
+/** Number of find requests */
+#define OP_STATS_FINDS      10
+
+#define RC(expr_) \
+    do {                                                \
+        int rc_ = 0;                                    \
+                                                        \
+        rc_ = (expr_);                                  \
+        if (rc_ != 0)                                   \
+        {                                               \
+            printf("%s returned %d\n", # expr_, rc_);   \
+            goto cleanup;                               \
+        }                                               \
+    } while (0)
+
+/**
+ * Find statistics entry.
+ *
+ * @param stats         array of statistics
+ * @param num           number of entries
+ * @param op            operation name
+ * @param ta            Test Agent name or empty string
+ * @param obj           object identifier or empty string
+ *
+ * @return Statistics entry or @c NULL.
+ */
+static const cfg_op_stats *
+op_stats_find(const cfg_op_stats *stats, unsigned int num, const char *op,
+              const char *ta, const char *obj)
+{
+    unsigned int i;
+
+    for (i = 0; i < num; i++)
+    {
+        if (strcmp(stats[i].op, op) == 0 && strcmp(stats[i].ta, ta) == 0 &&
+            strcmp(stats[i].obj, obj) == 0)
+            return &stats[i];
+    }
+
+    return NULL;
+}
+
+/**
+ * Check that statistics entry exists and accounts enough operations.
+ *
+ * @param stats         array of statistics
+ * @param num           number of entries
+ * @param op            operation name
+ * @param ta            Test Agent name or empty string
+ * @param obj           object identifier or empty string
+ * @param count         minimum number of operations
+ *
+ * @return Status code.
+ */
+static te_errno
+op_stats_check(const cfg_op_stats *stats, unsigned int num, const char *op,
+               const char *ta, const char *obj, uint64_t count)
+{
+    const cfg_op_stats *entry = op_stats_find(stats, num, op, ta, obj);
+    uint64_t            hist_count = 0;
+    unsigned int        i;
+
+    if (entry == NULL || entry->count < count)
+    {
+        printf("Operation '%s' '%s' '%s' is not accounted\n", op, ta, obj);
+        return TE_EFAIL;
+    }
+
+    for (i = 0; i < CFG_OP_STATS_BUCKETS; i++)
+        hist_count += entry->hist[i];
+
+    if (hist_count != entry->count || entry->min_ns > entry->max_ns ||
+        entry->sum_ns < entry->max_ns)
+    {
+        printf("Inconsistent statistics of '%s' '%s' '%s'\n", op, ta, obj);
+        return TE_EFAIL;
+    }
+
+    return 0;
+}
+
+int
+main(void)
+{
+    COMMON_TEST_PARAMS;
+    int                     conf;
+    cfg_handle              handle;
+    cfg_op_stats           *stats = NULL;
+    unsigned int            num = 0;
+    char                   *val = NULL;
+    unsigned int            i;
+
+    te_log_init("op_stats", te_log_message_file);
+
+    EXPORT_ENV;
+
+    START_LOGGER("logger.conf");
+    START_RCF_EMULATOR("config.db");
+    RCFRH_CONFIGURATION_CREATE(conf);
+    RCFRH_SET_DEFAULT_HANDLERS(conf);
+    RCFRH_CONFIGURATION_SET_CURRENT(conf);
+
+    START_CONFIGURATOR("test.conf");
+
+    for (i = 0; i < OP_STATS_FINDS; i++)
+        RC(cfg_find_str("/agent:Agt_T", &handle));
+
+    RC(cfg_add_instance_str("/agent:Agt_T/env:OP_STATS", &handle,
+                            CVT_STRING, "value"));
+    RC(cfg_get_string_sync(&val, "/agent:Agt_T/env:OP_STATS"));
+    RC(cfg_del_instance(handle, false));
+
+    RC(cfg_get_op_stats(&stats, &num, true));
+    RC(op_stats_check(stats, num, "find", "", "/agent", OP_STATS_FINDS));
+    RC(op_stats_check(stats, num, "add", "", "/agent/env", 1));
+    RC(op_stats_check(stats, num, "get_sync", "", "/agent/env", 1));
+    RC(op_stats_check(stats, num, "del", "", "/agent/env", 1));
+    RC(op_stats_check(stats, num, "rcf_add", "Agt_T", "/agent/env", 1));
+    RC(op_stats_check(stats, num, "rcf_get", "Agt_T", "/agent/env", 1));
+    RC(op_stats_check(stats, num, "rcf_del", "Agt_T", "/agent/env", 1));
+    cfg_op_stats_free(stats, num);
+    stats = NULL;
+
+    RC(cfg_get_op_stats(&stats, &num, false));
+    if (op_stats_find(stats, num, "find", "", "/agent") != NULL)
+    {
+        printf("Statistics are not reset\n");
+        goto cleanup;
+    }
+
+    RC(cfg_log_op_stats(false));
+
+    CONFIGURATOR_TEST_SUCCESS;
+cleanup:
+    cfg_op_stats_free(stats, num);
+    free(val);
+    STOP_CONFIGURATOR;
+    STOP_RCF_EMULATOR;
+    STOP_LOGGER;
+
+    CONFIGURATOR_TEST_END;
+}
@@ -0,0 +1,138 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/** @file
+ * @brief Configurator Tester
+ *
+ * Subscription to configuration changes
+ *
+ * Subscribe to network addresses of all agents, make the emulated agent
+ * report new addresses and check that the waiting subscriber gets
+ * the changes found by the resynchronization of the whole database
+ * in the Configurator.
+ *
+ * Copyright (C) 2004-2023 OKTET Labs Ltd. All rights reserved.
+ */
+
+#define LOG_LEVEL 0xff
+#define TE_LOG_LEVEL 0xff
+
+#include "te_string.h"
+#include "logger_file.h"
+#include "test.h"
+#include "../paths.c"
+
+/** Number of addresses reported by the agent */
+#define SUBSCR_ADDRS        3
+/** Interval of the subtree resynchronization */
+#define SUBSCR_SYNC_MS      100
+/** Maximum time to wait for changes */
+#define SUBSCR_TIMEOUT_MS   5000
+
+#define RC(expr_) \
+    do {                                                \
+        int rc_ = 0;                                    \
+                                                        \
+        rc_ = (expr_);                                  \
+        if (rc_ != 0)                                   \
+        {                                               \
+            printf("%s returned %d\n", # expr_, rc_);   \
+            goto cleanup;                               \
+        }                                               \
+    } while (0)
+
+/** Number of addresses currently reported by the agent */
+static unsigned int subscr_addrs;
+/** Buffer with the agent reply */
+static te_string subscr_reply = TE_STRING_INIT;
+
+/**
+ * Conf get request handler which reports @c subscr_addrs
+ * network addresses of a single interface.
+ */
+static int
+subscr_conf_get(char *ta_name, char *oid, char **answer, int *ans_len)
+{
+    unsigned int i;
+
+    UNUSED(ta_name);
+
+    te_string_reset(&subscr_reply);
+    if (strstr(oid, "...") != NULL)
+    {
+        te_string_append(&subscr_reply,
+                         "/agent:Agt_T /agent:Agt_T/interface:if0");
+        for (i = 0; i < subscr_addrs; i++)
+        {
+            te_string_append(&subscr_reply,
+                             " /agent:Agt_T/interface:if0/net_addr:%u", i);
+        }
+    }
+
+    *answer = subscr_reply.ptr;
+    *ans_len = subscr_reply.len + 1;
+    return 0;
+}
+
+int
+main(void)
+{
+    COMMON_TEST_PARAMS;
+    int                     conf;
+    unsigned int            id = 0;
+    cfg_change             *changes = NULL;
+    unsigned int            num = 0;
+    unsigned int            added = 0;
+    unsigned int            i;
+
+    te_log_init("subscr", te_log_message_file);
+
+    EXPORT_ENV;
+
+    START_LOGGER("logger.conf");
+    START_RCF_EMULATOR("config.db");
+    RCFRH_CONFIGURATION_CREATE(conf);
+    RCFRH_SET_DEFAULT_HANDLERS(conf);
+    rcf_get_cfg_by_id(conf)->conf_get = subscr_conf_get;
+    RCFRH_CONFIGURATION_SET_CURRENT(conf);
+
+    START_CONFIGURATOR("test.conf");
+
+    RC(cfg_synchronize("/agent:Agt_T", true));
+    RC(cfg_subscribe_fmt(&id, SUBSCR_SYNC_MS,
+                         "/agent:*/interface:*/net_addr:*"));
+
+    if (cfg_wait_changes_subscr(id, 0, &changes, &num) !=
+        TE_RC(TE_CONF_API, TE_ETIMEDOUT))
+    {
+        printf("Changes are reported before they happen\n");
+        goto cleanup;
+    }
+
+    subscr_addrs = SUBSCR_ADDRS;
+    while (added < SUBSCR_ADDRS)
+    {
+        RC(cfg_wait_changes_subscr(id, SUBSCR_TIMEOUT_MS, &changes, &num));
+        for (i = 0; i < num; i++)
+        {
+            if (changes[i].kind != CFG_CHANGE_ADD)
+            {
+                printf("Unexpected change of kind %d\n", changes[i].kind);
+                goto cleanup;
+            }
+            added++;
+        }
+        cfg_changes_free(changes, num);
+        changes = NULL;
+    }
+
+    CONFIGURATOR_TEST_SUCCESS;
+cleanup:
+    cfg_changes_free(changes, num);
+    if (id != 0)
+        cfg_unsubscribe(id);
+    STOP_CONFIGURATOR;
+    STOP_RCF_EMULATOR;
+    STOP_LOGGER;
+
+    te_string_free(&subscr_reply);
+    CONFIGURATOR_TEST_END;
+}
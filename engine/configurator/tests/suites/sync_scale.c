@@ -0,0 +1,189 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/** @file
+ * @brief Configurator Tester
+ *
+ * Scalability of the TA subtree synchronization
+ *
+ * Synchronize a subtree of @c SYNC_SCALE_SMALL and then of
+ * @c SYNC_SCALE_LARGE instances reported by the emulated agent and
+ * check that time of the resynchronization grows (nearly) linearly
+ * with the number of instances.
+ *
+ * Copyright (C) 2004-2023 OKTET Labs Ltd. All rights reserved.
+ */
+
+#define LOG_LEVEL 0xff
+#define TE_LOG_LEVEL 0xff
+
+#include <sys/time.h>
+
+#include "te_string.h"
+#include "logger_file.h"
+#include "test.h"
+#include "../paths.c"
+
+/** Number of instances in the small database */
+#define SYNC_SCALE_SMALL        10000
+/** Number of instances in the large database */
+#define SYNC_SCALE_LARGE        100000
+/** Number of network addresses per interface */
+#define SYNC_SCALE_ADDRS        1000
+/** Number of instances replaced on the agent between synchronizations */
+#define SYNC_SCALE_CHANGED      100
+/**
+ * Maximum allowed ratio of the large and small resynchronization
+ * time: it is about 10 for linear algorithm and about 100 for
+ * the quadratic one.
+ */
+#define SYNC_SCALE_MAX_RATIO    30
+
+#define RC(expr_) \
+    do {                                                \
+        int rc_ = 0;                                    \
+                                                        \
+        rc_ = (expr_);                                  \
+        if (rc_ != 0)                                   \
+        {                                               \
+            printf("%s returned %d\n", # expr_, rc_);   \
+            goto cleanup;                               \
+        }                                               \
+    } while (0)
+
+/** Number of instances reported by the agent */
+static unsigned int sync_scale_num;
+/** Whether the last SYNC_SCALE_CHANGED instances are replaced */
+static bool sync_scale_changed;
+/** Buffer with the agent reply */
+static te_string sync_scale_reply = TE_STRING_INIT;
+
+/**
+ * Conf get request handler which reports @c sync_scale_num
+ * network addresses spread over a number of interfaces.
+ */
+static int
+sync_scale_conf_get(char *ta_name, char *oid, char **answer, int *ans_len)
+{
+    unsigned int i;
+
+    UNUSED(ta_name);
+
+    te_string_reset(&sync_scale_reply);
+    if (strstr(oid, "...") != NULL)
+    {
+        te_string_append(&sync_scale_reply, "/agent:Agt_T");
+        for (i = 0; i < sync_scale_num; i++)
+        {
+            unsigned int addr = i % SYNC_SCALE_ADDRS;
+
+            if (addr == 0)
+            {
+                te_string_append(&sync_scale_reply,
+                                 " /agent:Agt_T/interface:if%u",
+                                 i / SYNC_SCALE_ADDRS);
+            }
+            if (sync_scale_changed &&
+                i + SYNC_SCALE_CHANGED >= sync_scale_num)
+                addr += SYNC_SCALE_ADDRS;
+
+            te_string_append(&sync_scale_reply,
+                             " /agent:Agt_T/interface:if%u/net_addr:%u",
+                             i / SYNC_SCALE_ADDRS, addr);
+        }
+    }
+
+    *answer = sync_scale_reply.ptr;
+    *ans_len = sync_scale_reply.len + 1;
+    return 0;
+}
+
+/**
+ * Populate the database with @p num instances and measure
+ * the time of the resynchronization after a few instances are replaced.
+ *
+ * @param num       number of instances
+ * @param usec      location for the resynchronization time
+ *
+ * @return Status code.
+ */
+static te_errno
+sync_scale_run(unsigned int num, long *usec)
+{
+    struct timeval  tv_start;
+    struct timeval  tv_end;
+    unsigned int    n_found;
+    cfg_handle     *found;
+    te_errno        rc;
+
+    sync_scale_num = num;
+    sync_scale_changed = false;
+    rc = cfg_synchronize("/agent:Agt_T", true);
+    if (rc != 0)
+        return rc;
+
+    sync_scale_changed = true;
+    gettimeofday(&tv_start, NULL);
+    rc = cfg_synchronize("/agent:Agt_T", true);
+    gettimeofday(&tv_end, NULL);
+    if (rc != 0)
+        return rc;
+
+    *usec = TE_SEC2US(tv_end.tv_sec - tv_start.tv_sec) +
+            tv_end.tv_usec - tv_start.tv_usec;
+    printf("Resynchronization of %u instances took %ld us\n", num, *usec);
+
+    rc = cfg_find_pattern("/agent:Agt_T/interface:*/net_addr:*",
+                          &n_found, &found);
+    if (rc != 0)
+        return rc;
+    free(found);
+
+    if (n_found != num)
+    {
+        printf("%u instances are found instead of %u\n", n_found, num);
+        return TE_EFAIL;
+    }
+
+    return 0;
+}
+
+int
+main(void)
+{
+    COMMON_TEST_PARAMS;
+    int                     conf;
+    long                    small_usec;
+    long                    large_usec;
+
+    te_log_init("sync_scale", te_log_message_file);
+
+    EXPORT_ENV;
+
+    START_LOGGER("logger.conf");
+    START_RCF_EMULATOR("config.db");
+    RCFRH_CONFIGURATION_CREATE(conf);
+    RCFRH_SET_DEFAULT_HANDLERS(conf);
+    rcf_get_cfg_by_id(conf)->conf_get = sync_scale_conf_get;
+    RCFRH_CONFIGURATION_SET_CURRENT(conf);
+
+    START_CONFIGURATOR("test.conf");
+
+    RC(sync_scale_run(SYNC_SCALE_SMALL, &small_usec));
+    RC(sync_scale_run(SYNC_SCALE_LARGE, &large_usec));
+
+    if (large_usec > SYNC_SCALE_MAX_RATIO * MAX(small_usec, 1))
+    {
+        printf("Synchronization does not scale: %ld us for %u instances, "
+               "%ld us for %u instances\n", small_usec, SYNC_SCALE_SMALL,
+               large_usec, SYNC_SCALE_LARGE);
+        goto cleanup;
+    }
+
+    CONFIGURATOR_TEST_SUCCESS;
+cleanup:
+    STOP_CONFIGURATOR;
+    STOP_RCF_EMULATOR;
+    STOP_LOGGER;
+
+    te_string_free(&sync_scale_reply);
+    CONFIGURATOR_TEST_END;
+}
@@ -46,11 +46,22 @@
 #ifdef HAVE_SIGNAL_H
 #include <signal.h>
 #endif
+#if HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
 #if HAVE_POPT_H
 #include <popt.h>
 #else
 #error popt library (development version) is required for RCF
 #endif
+#if HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+#if HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#else
+#error epoll is required for RCF
+#endif
 
 #include <libxml/xmlmemory.h>
 #include <libxml/parser.h>
@@ -68,9 +79,11 @@
 #define RCF_NEED_TYPES      1
 #define RCF_NEED_TYPE_LEN   1
 #include "te_proto.h"
+#include "te_proto_bin.h"
 
 #include "logger_api.h"
 #include "logger_ten.h"
+#include "te_file.h"
 
 #define TE_EXPAND_XML 1
 #include "te_expand.h"
@@ -96,6 +109,8 @@ ta_check ta_checker;
 
 
 #define RCF_FOREGROUND  0x01    /**< Flag to run RCF in foreground */
+#define RCF_OP_STATS    0x02    /**< Flag to log latency statistics of
+                                     requests on shutdown */
 static unsigned int flags = 0;  /**< Global flags */
 
 static const char *tce_conf_file = NULL;    /**< The TCE configuration file. */
@@ -117,6 +132,12 @@ static int  names_len = 0;      /**< Length of TA name list */
 struct timeval tv0;
 fd_set set0;
 
+/** Maximum number of events got by the event loop at once */
+#define RCF_EPOLL_EVENTS    64
+
+/** epoll instance watching Test Agent connections and IPC server */
+static int epoll_fd = -1;
+
 /** Name of directory for temporary files */
 static char *tmp_dir;
 
@@ -208,6 +229,7 @@ static int
 resolve_ta_methods(ta *agent, char *libname)
 {
     struct rcf_talib_methods *m;
+    rcf_talib_get_fd         *get_fd;
     char                      name[RCF_MAX_NAME];
     void                     *handle;
 
@@ -233,6 +255,11 @@ resolve_ta_methods(ta *agent, char *libname)
     memcpy(&agent->m, m, sizeof(agent->m));
     agent->dlhandle = handle;
 
+    /* The method is optional */
+    snprintf(name, sizeof(name), "%s_get_fd_method", libname);
+    get_fd = dlsym(handle, name);
+    agent->get_fd = (get_fd != NULL) ? *get_fd : NULL;
+
     return 0;
 }
 
@@ -330,6 +357,8 @@ parse_config_ta(xmlNodePtr ta_node)
 
     agent->enable_synch_time =
             attribute_contains_yes(ta_node, "synch_time");
+    agent->binary_proto_req =
+            attribute_contains_yes(ta_node, "binary_proto");
 
     if (attribute_contains_yes(ta_node, "rebootable"))
         agent->flags |= TA_REBOOTABLE;
@@ -698,18 +727,14 @@ parse_config(const char *filename)
 static int
 consume_answer(ta *agent)
 {
-    struct timeval tv;
-    fd_set         set;
-    time_t         t0, t;
+    time_t t0, t;
 
     t = t0 = time(NULL);
     while (t - t0 < RCF_SHUTDOWN_TIMEOUT)
     {
         char *ba;
 
-        set = set0;
-        tv = tv0;
-        select(FD_SETSIZE, &set, NULL, NULL, &tv);
+        rcf_wait_events(&tv0);
         if ((agent->m.is_ready)(agent->handle))
         {
             size_t len = sizeof(cmd);
@@ -848,8 +873,21 @@ rcf_answer_user_request(usrreq *req)
              rcf_op_to_string(req->message->opcode),
              ipc_server_client_name(req->user));
 
-        rc = ipc_send_answer(server, req->user, (char *)req->message,
-                             sizeof(rcf_msg) + req->message->data_len);
+        if (req->attach_fd >= 0 && req->message->error == 0)
+        {
+            req->message->flags |= ATTACHMENT_FD;
+            rc = ipc_send_answer_fd(server, req->user, (char *)req->message,
+                                    sizeof(rcf_msg) +
+                                    req->message->data_len,
+                                    req->attach_fd);
+        }
+        else
+        {
+            /* The flag may be left from the request, e.g. on early error */
+            req->message->flags &= ~ATTACHMENT_FD;
+            rc = ipc_send_answer(server, req->user, (char *)req->message,
+                                 sizeof(rcf_msg) + req->message->data_len);
+        }
         if (rc != 0)
         {
             ERROR("Cannot send an answer to user: error=%r", rc);
@@ -868,6 +906,13 @@ rcf_answer_user_request(usrreq *req)
             ERROR("Unexpected answer with TA checker SID=%d",
                   req->message->sid);
     }
+    if (req->attach_fd >= 0)
+    {
+        close(req->attach_fd);
+        req->attach_fd = -1;
+        req->message->flags &= ~ATTACHMENT_FD;
+    }
+
     if (!(req->message->flags & INTERMEDIATE_ANSWER))
     {
         free(req->message);
@@ -948,6 +993,126 @@ startup_tasks(ta *agent)
     return 0;
 }
 
+/**
+ * Start watching the Test Agent connection in the event loop.
+ *
+ * @param agent         Test Agent structure
+ * @param set_before    select set before connection establishment
+ *                      (used to find the connection descriptor if
+ *                      the library does not provide it)
+ */
+static void
+rcf_watch_ta(ta *agent, const fd_set *set_before)
+{
+    struct epoll_event  ev;
+    int                 fd = -1;
+
+    if (agent->get_fd != NULL)
+    {
+        fd = agent->get_fd(agent->handle);
+    }
+    else
+    {
+        for (fd = 0; fd < FD_SETSIZE; fd++)
+        {
+            if (FD_ISSET(fd, &set0) && !FD_ISSET(fd, set_before))
+                break;
+        }
+        if (fd == FD_SETSIZE)
+            fd = -1;
+    }
+
+    agent->watched = false;
+    agent->io_ready = false;
+    if (fd < 0)
+    {
+        WARN("Connection descriptor of TA '%s' is unknown, it is polled",
+             agent->name);
+        return;
+    }
+
+    memset(&ev, 0, sizeof(ev));
+    /* All pending data are processed on event, see main loop */
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.ptr = agent;
+    /*
+     * The descriptor number may be still registered if the previous
+     * connection socket is inherited by a child process.
+     */
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0 &&
+        (errno != EEXIST ||
+         epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev) != 0))
+    {
+        WARN("Failed to watch connection of TA '%s', it is polled: %r",
+             agent->name, TE_OS_RC(TE_RCF, errno));
+        return;
+    }
+
+    agent->fd = fd;
+    agent->watched = true;
+}
+
+/**
+ * Stop watching the Test Agent connection in the event loop.
+ *
+ * @param agent         Test Agent structure
+ */
+static void
+rcf_unwatch_ta(ta *agent)
+{
+    if (!agent->watched)
+        return;
+
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_DEL, agent->fd, NULL) != 0)
+    {
+        WARN("Failed to stop watching connection of TA '%s': %r",
+             agent->name, TE_OS_RC(TE_RCF, errno));
+    }
+    agent->watched = false;
+    agent->io_ready = false;
+}
+
+/* See description in rcf.h */
+te_errno
+rcf_close_ta_conn(ta *agent)
+{
+    rcf_unwatch_ta(agent);
+    return (agent->m.close)(agent->handle, &set0);
+}
+
+/* See description in rcf.h */
+bool
+rcf_wait_events(const struct timeval *tv)
+{
+    struct epoll_event  events[RCF_EPOLL_EVENTS];
+    bool                ipc_ready = false;
+    int                 n;
+    int                 i;
+
+    n = epoll_wait(epoll_fd, events, TE_ARRAY_LEN(events),
+                   tv->tv_sec * 1000 + tv->tv_usec / 1000);
+    if (n < 0)
+    {
+        if (errno != EINTR)
+            ERROR("Unexpected failure of epoll_wait(): errno=%d", errno);
+        else
+            INFO("epoll_wait() has been interrupted by signal");
+        return false;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        ta *agent = events[i].data.ptr;
+
+        if (agent == NULL)
+            ipc_ready = true;
+        else
+            agent->io_ready = true;
+    }
+
+    return ipc_ready;
+}
+
 /* See description in rcf.h */
 void
 rcf_set_ta_dead(ta *agent)
@@ -959,7 +1124,7 @@ rcf_set_ta_dead(ta *agent)
         ERROR("TA '%s' is dead", agent->name);
         rcf_answer_all_requests(&(agent->sent), TE_ETADEAD);
         rcf_answer_all_requests(&(agent->waiting), TE_ETADEAD);
-        rc = (agent->m.close)(agent->handle, &set0);
+        rc = rcf_close_ta_conn(agent);
         if (rc != 0)
             ERROR("Failed to close connection with TA '%s': rc=%r",
                   agent->name, rc);
@@ -984,7 +1149,7 @@ rcf_set_ta_unrecoverable(ta *agent)
 
             if (~agent->flags & TA_DEAD)
             {
-                rc = (agent->m.close)(agent->handle, &set0);
+                rc = rcf_close_ta_conn(agent);
                 if (rc != 0)
                     ERROR("Failed to close connection with TA '%s': "
                           "rc=%r", agent->name, rc);
@@ -999,11 +1164,58 @@ rcf_set_ta_unrecoverable(ta *agent)
     }
 }
 
-/* See description in rcf.h */
-int
-rcf_init_agent(ta *agent)
+/**
+ * Negotiate binary mode of the Test Protocol with the Test Agent.
+ * If the Test Agent does not support it, text mode is used.
+ *
+ * @param agent         Test Agent structure
+ *
+ * @return 0 (success) or -1 (failure)
+ */
+static int
+negotiate_binary_proto(ta *agent)
 {
-    int       rc;
+    int   rc;
+    char *ptr;
+
+    TE_SPRINTF(cmd, "%s", TE_PROTO_BINARY);
+    if ((rc = (agent->m.transmit)(agent->handle,
+                                  cmd, strlen(cmd) + 1)) != 0)
+    {
+        ERROR("Failed to transmit command to TA '%s' error=%r",
+              agent->name, rc);
+        return -1;
+    }
+
+    if (consume_answer(agent) != 0)
+        return -1;
+
+    rc = strtol(cmd, &ptr, 10);
+    if (cmd == ptr || rc != 0)
+    {
+        WARN("Binary protocol mode is not supported by TA '%s', "
+             "text mode is used", agent->name);
+        return 0;
+    }
+
+    INFO("Binary protocol mode is used for TA '%s'", agent->name);
+    agent->binary_proto = true;
+    return 0;
+}
+
+/**
+ * Start the Test Agent process using its communication library.
+ * The function does not touch global RCF state, so it may be called
+ * for different agents in parallel.
+ *
+ * @param agent         Test Agent structure
+ *
+ * @return Status code.
+ */
+static te_errno
+rcf_start_agent(ta *agent)
+{
+    te_errno  rc;
     te_string str = TE_STRING_INIT;
     rcf_talib_param param = {
         .tce_conf = tce_conf,
@@ -1031,23 +1243,34 @@ rcf_init_agent(ta *agent)
     {
         RING("Cannot (re-)initialize TA '%s' error=%r",
               agent->name, rc);
-
-        /*
-         * It's OK if the agent can't initialize in the REBOOTING state,
-         * since it can do it so in the next reboot type.
-         */
-        if (agent->reboot_ctx.state != TA_REBOOT_STATE_REBOOTING)
-            rcf_set_ta_unrecoverable(agent);
-
         return rc;
     }
+
     INFO("TA '%s' started, trying to connect", agent->name);
+    return 0;
+}
+
+/**
+ * Connect to the started Test Agent and prepare it for operation.
+ *
+ * @param agent         Test Agent structure
+ *
+ * @return Status code.
+ */
+static int
+rcf_connect_agent(ta *agent)
+{
+    int       rc;
+    fd_set    set_before;
+
+    set_before = set0;
     if ((rc = (agent->m.connect)(agent->handle, &set0, &tv0)) != 0)
     {
         ERROR("Cannot connect to TA '%s' error=%r", agent->name, rc);
         rcf_set_ta_unrecoverable(agent);
         return rc;
     }
+    rcf_watch_ta(agent, &set_before);
     agent->flags &= ~(TA_DEAD | TA_REBOOTING);
     INFO("Connected with TA '%s'", agent->name);
 
@@ -1057,6 +1280,14 @@ rcf_init_agent(ta *agent)
         return rc;
     }
 
+    agent->binary_proto = false;
+    if (agent->binary_proto_req &&
+        (rc = negotiate_binary_proto(agent)) != 0)
+    {
+        rcf_set_ta_unrecoverable(agent);
+        return rc;
+    }
+
     rc = (agent->enable_synch_time ? synchronize_time(agent) : 0);
     if (rc == 0)
     {
@@ -1071,33 +1302,234 @@ rcf_init_agent(ta *agent)
     return rc;
 }
 
+/* See description in rcf.h */
+int
+rcf_init_agent(ta *agent)
+{
+    int rc;
+
+    if ((rc = rcf_start_agent(agent)) != 0)
+    {
+        /*
+         * It's OK if the agent can't initialize in the REBOOTING state,
+         * since it can do it so in the next reboot type.
+         */
+        if (agent->reboot_ctx.state != TA_REBOOT_STATE_REBOOTING)
+            rcf_set_ta_unrecoverable(agent);
+
+        return rc;
+    }
+
+    return rcf_connect_agent(agent);
+}
+
+/** Context of the Test Agent started in a separate thread */
+typedef struct rcf_start_job {
+    ta         *agent;      /**< Test Agent */
+    pthread_t   thread;     /**< Thread starting the agent */
+    bool        spawned;    /**< The thread is created */
+    te_errno    rc;         /**< Status of the start */
+} rcf_start_job;
+
 /**
- * Save binary attachment to the local file.
+ * Thread routine starting a Test Agent.
+ *
+ * @param arg           start job (rcf_start_job)
+ *
+ * @return @c NULL.
+ */
+static void *
+rcf_start_agent_thread(void *arg)
+{
+    rcf_start_job *job = arg;
+
+    job->rc = rcf_start_agent(job->agent);
+    return NULL;
+}
+
+/**
+ * Initialize all Test Agents. Agents are started (that mostly means
+ * copying of images to their hosts) in parallel, then RCF connects
+ * to them one by one. All threads are joined before the function returns.
+ *
+ * @return Status code.
+ */
+static int
+rcf_init_agents(void)
+{
+    rcf_start_job  *jobs;
+    unsigned int    n_agents = 0;
+    unsigned int    i;
+    ta             *agent;
+    int             rc = 0;
+
+    for (agent = agents; agent != NULL; agent = agent->next)
+        n_agents++;
+
+    if (n_agents == 0)
+        return 0;
+
+    jobs = TE_ALLOC(n_agents * sizeof(*jobs));
+
+    for (agent = agents, i = 0; agent != NULL; agent = agent->next, i++)
+    {
+        int ret;
+
+        jobs[i].agent = agent;
+        ret = pthread_create(&jobs[i].thread, NULL,
+                             rcf_start_agent_thread, &jobs[i]);
+        if (ret != 0)
+        {
+            WARN("Cannot create thread to start TA '%s': %s - "
+                 "start it in place", agent->name, strerror(ret));
+            jobs[i].rc = rcf_start_agent(agent);
+        }
+        else
+        {
+            jobs[i].spawned = true;
+        }
+    }
+
+    for (i = 0; i < n_agents; i++)
+    {
+        if (jobs[i].spawned)
+            pthread_join(jobs[i].thread, NULL);
+    }
+
+    for (i = 0; i < n_agents; i++)
+    {
+        agent = jobs[i].agent;
+
+        if (jobs[i].rc != 0)
+        {
+            rcf_set_ta_unrecoverable(agent);
+            if (rc == 0)
+                rc = jobs[i].rc;
+            continue;
+        }
+
+        if (rc == 0)
+            rc = rcf_connect_agent(agent);
+    }
+
+    free(jobs);
+    return rc;
+}
+
+/**
+ * Generate the name of the file for binary attachment if it is not
+ * specified in the message.
  *
  * @param agent         Test Agent structure
  * @param msg           message where filename is contained in file field
- *                      (is file name is empty file is created in
- *                       ${TE_TMP}/rcf_<taname>_<time>_<unique mark>
- *                      and its name is put to file parameter)
- * @param cmdlen        command length (including binary attachment)
- * @param ba            pointer to the first byte after end marker
+ *                      (is file name is empty, it is set to
+ *                       ${TE_TMP}/rcf_<taname>_<time>_<unique mark>)
  */
 static void
-save_attachment(ta *agent, rcf_msg *msg, size_t cmdlen, char *ba)
+attachment_file_name(ta *agent, rcf_msg *msg)
 {
     /** Unique mark for temporary file names */
     static unsigned int unique_mark = 0;
 
-    int file = -1;
-    size_t write_len;
-    int len;
-
     if (strlen(msg->file) == 0)
     {
         TE_SPRINTF(msg->file, "%s/rcf_%s_%u_%u",
                    tmp_dir, agent->name,
                    (unsigned int)time(NULL), unique_mark++);
     }
+}
+
+/**
+ * Open the file to save binary attachment to.
+ *
+ * If a file is received in chunks, the file opened for the first
+ * chunk is continued at the offset of the next chunk.
+ *
+ * If the file name is not specified in the message and the user
+ * accepts attachments as file descriptors, an anonymous memory file
+ * is created instead of a file in ${TE_TMP}. The memory file is kept
+ * in the request and passed to the user with the answer.
+ *
+ * @param agent         Test Agent structure
+ * @param req           user request
+ *
+ * @return File descriptor to be closed by the caller or @c -1.
+ */
+static int
+attachment_open(ta *agent, usrreq *req)
+{
+    rcf_msg *msg = req->message;
+    int      fd;
+
+    if (req->file_offset > 0)
+    {
+        /* Next chunk of a file: continue the file opened before */
+        fd = (req->attach_fd >= 0) ? dup(req->attach_fd) :
+                                     open(msg->file, O_WRONLY);
+        if (fd >= 0 && lseek(fd, req->file_offset, SEEK_SET) < 0)
+        {
+            close(fd);
+            fd = -1;
+        }
+        if (fd < 0)
+        {
+            ERROR("Cannot continue file %s at offset %llu, errno %d",
+                  msg->file, (unsigned long long)req->file_offset, errno);
+        }
+        return fd;
+    }
+
+#if HAVE_MEMFD_CREATE
+    if (req->attach_fd_ok && msg->file[0] == '\0')
+    {
+        char name[RCF_MAX_NAME + sizeof("rcf_")];
+
+        TE_SPRINTF(name, "rcf_%s", agent->name);
+        fd = memfd_create(name, MFD_CLOEXEC);
+        if (fd >= 0)
+        {
+            if (req->attach_fd >= 0)
+                close(req->attach_fd);
+            req->attach_fd = dup(fd);
+            if (req->attach_fd >= 0)
+                return fd;
+
+            close(fd);
+        }
+        WARN("Cannot create memory file for attachment, errno %d - "
+             "fall back to a file", errno);
+    }
+#endif
+
+    attachment_file_name(agent, msg);
+    fd = open(msg->file, O_WRONLY | O_CREAT | O_TRUNC,
+              S_IRWXU | S_IRWXG | S_IRWXO);
+    if (fd < 0)
+        ERROR("Cannot open file %s for writing, errno %d", msg->file, errno);
+
+    return fd;
+}
+
+/**
+ * Save binary attachment to the local file.
+ *
+ * @param agent         Test Agent structure
+ * @param req           user request with the message where filename is
+ *                      contained in file field (is file name is empty
+ *                      file is created in
+ *                      ${TE_TMP}/rcf_<taname>_<time>_<unique mark>
+ *                      and its name is put to file parameter, or
+ *                      memory file is created, see attachment_open())
+ * @param cmdlen        command length (including binary attachment)
+ * @param ba            pointer to the first byte after end marker
+ */
+static void
+save_attachment(ta *agent, usrreq *req, size_t cmdlen, char *ba)
+{
+    rcf_msg *msg = req->message;
+    int file = -1;
+    size_t write_len;
+    int len;
 
     assert((ba - cmd) >= 0);
     assert(cmdlen >= (size_t)(ba - cmd));
@@ -1108,11 +1540,7 @@ save_attachment(ta *agent, rcf_msg *msg, size_t cmdlen, char *ba)
     write_len = (cmdlen > sizeof(cmd)) ? (sizeof(cmd) - (ba - cmd)) :
                                          (size_t)len;
 
-    if ((file = open(msg->file, O_WRONLY | O_CREAT | O_TRUNC,
-                     S_IRWXU | S_IRWXG | S_IRWXO)) < 0)
-    {
-        ERROR("Cannot open file %s for writing - skipping", msg->file);
-    }
+    file = attachment_open(agent, req);
 
     if (file >= 0 && write(file, ba, write_len) < 0)
     {
@@ -1165,6 +1593,60 @@ save_attachment(ta *agent, rcf_msg *msg, size_t cmdlen, char *ba)
     EXIT();
 }
 
+/**
+ * Compare size and checksum of the transferred file reported by
+ * the Test Agent with the ones of the local file.
+ *
+ * @param agent         Test Agent structure
+ * @param req           user request (error is set in the message
+ *                      if files differ)
+ * @param ptr           answer of the Test Agent after the status code
+ */
+static void
+file_verify(ta *agent, usrreq *req, const char *ptr)
+{
+    rcf_msg            *msg = req->message;
+    unsigned long long  size;
+    unsigned int        crc;
+    uint64_t            lsize;
+    uint32_t            lcrc;
+    te_errno            rc;
+    int                 fd;
+
+    if (sscanf(ptr, "%llu %x", &size, &crc) != 2)
+    {
+        ERROR("Bad checksum answer '%s' from TA '%s'", ptr, agent->name);
+        msg->error = TE_RC(TE_RCF, TE_EIPC);
+        return;
+    }
+
+    fd = (req->attach_fd >= 0) ? dup(req->attach_fd) :
+                                 open(msg->file, O_RDONLY);
+    if (fd < 0)
+    {
+        msg->error = TE_OS_RC(TE_RCF, errno);
+        ERROR("Cannot open file %s to verify it: %r", msg->file,
+              msg->error);
+        return;
+    }
+    rc = te_file_crc32(fd, &lsize, &lcrc);
+    close(fd);
+    if (rc != 0)
+    {
+        msg->error = TE_RC(TE_RCF, rc);
+        return;
+    }
+
+    if (lsize != size || lcrc != crc)
+    {
+        ERROR("File %s on TA '%s' (%llu bytes, CRC-32 %08x) differs from "
+              "local file %s (%llu bytes, CRC-32 %08x)",
+              msg->data, agent->name, size, crc, msg->file,
+              (unsigned long long)lsize, lcrc);
+        msg->error = TE_RC(TE_RCF, TE_EIO);
+    }
+}
+
 
 /**
  * Send pending command for specified SID.
@@ -1274,6 +1756,107 @@ read_str(char **ptr, char *s)
     *ptr = p;
 }
 
+/**
+ * Start parsing of the answer received from the Test Agent in binary
+ * mode. If the answer does not fit into the command buffer, the rest
+ * of it is received.
+ *
+ * @param agent         Test Agent structure
+ * @param rc            status code returned by the receive method
+ * @param len           length of the answer
+ * @param parser        parser to initialize
+ * @param sid           location for session identifier
+ * @param error         location for status code
+ *
+ * @return Status code.
+ */
+static te_errno
+parse_bin_reply(ta *agent, te_errno rc, size_t len, rcf_bin_parser *parser,
+                int *sid, int *error)
+{
+    /** Buffer for binary answers which do not fit into the command buffer */
+    static te_dbuf buf = TE_DBUF_INIT(0);
+
+    void     *reply = cmd;
+    uint32_t  reply_sid;
+    uint32_t  reply_error;
+
+    if (TE_RC_GET_ERROR(rc) == TE_EPENDING)
+    {
+        size_t rest = len - sizeof(cmd);
+
+        te_dbuf_reset(&buf);
+        te_dbuf_append(&buf, cmd, sizeof(cmd));
+        te_dbuf_append(&buf, NULL, rest);
+
+        rc = (agent->m.receive)(agent->handle, (char *)buf.ptr + sizeof(cmd),
+                                &rest, NULL);
+        if (rc != 0)
+        {
+            ERROR("Failed to receive the rest of binary answer from "
+                  "TA '%s': %r", agent->name, rc);
+            return rc;
+        }
+        reply = buf.ptr;
+    }
+
+    rc = rcf_bin_parse_start(parser, reply, len, &reply_sid, &reply_error);
+    if (rc != 0)
+        return rc;
+
+    *sid = reply_sid;
+    *error = reply_error;
+    return 0;
+}
+
+/**
+ * Get the value from the answer on configuration get command received
+ * in binary mode. The value which does not fit into the message is
+ * saved to the file as binary attachment.
+ *
+ * @param agent         Test Agent structure
+ * @param msg           message to put the value to
+ * @param parser        parser of the answer
+ *
+ * @return Status code.
+ */
+static te_errno
+get_bin_value(ta *agent, usrreq *req, rcf_bin_parser *parser)
+{
+    rcf_msg  *msg = req->message;
+    char     *value;
+    size_t    len;
+    int       file;
+    te_errno  rc;
+
+    rc = rcf_bin_get_str(parser, &value, &len);
+    if (rc != 0)
+        return rc;
+
+    if (len < RCF_MAX_VAL)
+    {
+        memcpy(msg->value, value, len + 1);
+        return 0;
+    }
+
+    if ((file = attachment_open(agent, req)) < 0)
+    {
+        msg->error = TE_OS_RC(TE_RCF, errno);
+        return 0;
+    }
+
+    if (write(file, value, len + 1) != (ssize_t)(len + 1))
+    {
+        rc = TE_OS_RC(TE_RCF, errno);
+        ERROR("Cannot write to file %s: %r", msg->file, rc);
+        msg->error = rc;
+    }
+    close(file);
+
+    msg->flags |= BINARY_ATTACHMENT;
+    return 0;
+}
+
 /**
  * Receive reply from the Test Agent, send answer to user and send pending
  * message if necessary.
@@ -1294,6 +1877,9 @@ process_reply(ta *agent)
     char    *ba = NULL;
     bool ack = false;
     rcf_op_t last_opcode;
+    rcf_bin_parser parser;
+    bool bin;
+    bool more = false;
 
 #define READ_INT(n) \
     do {                                                    \
@@ -1327,21 +1913,48 @@ process_reply(ta *agent)
         return;
     }
 
-    VERB("Answer \"%s\" is received from TA '%s'", cmd, agent->name);
-
-    if (strncmp(ptr, "SID ", strlen("SID ")) != 0)
+    bin = rcf_bin_is_msg(cmd, len);
+    if (bin)
     {
-        if (strstr(ptr, "bad command") != NULL)
+        if (parse_bin_reply(agent, rc, len, &parser, &sid, &error) != 0)
         {
-            ERROR("TA %s received incorrect command", agent->name);
-            return;
+            ERROR("BAD PROTO: %s, %d", __FILE__, __LINE__);
+            goto bad_protocol;
         }
-        ERROR("BAD PROTO: %s, %d", __FILE__, __LINE__);
-        goto bad_protocol;
+        VERB("Binary answer SID %d is received from TA '%s'",
+             sid, agent->name);
     }
+    else
+    {
+        VERB("Answer \"%s\" is received from TA '%s'", cmd, agent->name);
 
-    ptr += strlen("SID ");
-    READ_INT(sid);
+        if (strncmp(ptr, "SID ", strlen("SID ")) != 0)
+        {
+            if (strstr(ptr, "bad command") != NULL)
+            {
+                ERROR("TA %s received incorrect command", agent->name);
+                return;
+            }
+            ERROR("BAD PROTO: %s, %d", __FILE__, __LINE__);
+            goto bad_protocol;
+        }
+
+        ptr += strlen("SID ");
+        READ_INT(sid);
+
+        /* Execution time reported before the answer */
+        if (strncmp(ptr, TE_PROTO_EXEC_TIME " ",
+                    strlen(TE_PROTO_EXEC_TIME " ")) == 0)
+        {
+            req = rcf_find_user_request(&(agent->sent), sid);
+            if (req != NULL)
+            {
+                req->agent_ns = strtoull(ptr + strlen(TE_PROTO_EXEC_TIME),
+                                         NULL, 10) * 1000;
+            }
+            return;
+        }
+    }
 
     if ((req = rcf_find_user_request(&(agent->sent), sid)) == NULL)
     {
@@ -1368,12 +1981,13 @@ process_reply(ta *agent)
          * should be cleared after answer to user.
          */
         msg->file[0] = '\0';
-        save_attachment(agent, msg, len, ba);
+        save_attachment(agent, req, len, ba);
         rcf_answer_user_request(req);
         return;
     }
 
-    READ_INT(error);
+    if (!bin)
+        READ_INT(error);
 
     if (TE_RC_GET_ERROR(error) == TE_EACK)
     {
@@ -1417,7 +2031,6 @@ process_reply(ta *agent)
             case RCFOP_CONFADD:
             case RCFOP_CONFDEL:
             case RCFOP_VWRITE:
-            case RCFOP_FPUT:
             case RCFOP_FDEL:
             case RCFOP_CSAP_DESTROY:
             case RCFOP_KILL:
@@ -1425,8 +2038,17 @@ process_reply(ta *agent)
                 break;
 
             case RCFOP_CONFGET:
-                if (ba != NULL)
-                    save_attachment(agent, msg, len, ba);
+                if (bin)
+                {
+                    if (get_bin_value(agent, req, &parser) != 0 ||
+                        !rcf_bin_parse_end(&parser))
+                    {
+                        ERROR("BAD PROTO: %s, %d", __FILE__, __LINE__);
+                        goto bad_protocol;
+                    }
+                }
+                else if (ba != NULL)
+                    save_attachment(agent, req, len, ba);
                 else
                     read_str(&ptr, msg->value);
                 break;
@@ -1440,7 +2062,7 @@ process_reply(ta *agent)
             {
                 read_str(&ptr, msg->value);
                 if (ba != NULL)
-                    save_attachment(agent, msg, len, ba);
+                    save_attachment(agent, req, len, ba);
                 break;
             }
 
@@ -1479,11 +2101,51 @@ process_reply(ta *agent)
             }
 
             case RCFOP_GET_LOG:
-            case RCFOP_FGET:
                 if (ba == NULL)
                     goto bad_protocol;
-                save_attachment(agent, msg, len, ba);
+                save_attachment(agent, req, len, ba);
+                break;
+
+            case RCFOP_FPUT:
+            case RCFOP_FGET:
+            {
+                uint64_t chunk = req->file_chunk;
+
+                if (req->file_done)
+                {
+                    file_verify(agent, req, ptr);
+                    break;
+                }
+
+                if (msg->opcode == RCFOP_FGET)
+                {
+                    if (ba == NULL)
+                        goto bad_protocol;
+                    save_attachment(agent, req, len, ba);
+                    chunk = len - (ba - cmd);
+                    /*
+                     * The file size is not reported if the whole file
+                     * is passed at once by the Test Agent specific
+                     * handler.
+                     */
+                    if (isdigit(*ptr))
+                        req->file_size = strtoull(ptr, NULL, 10);
+                    else
+                        req->file_size = req->file_offset + chunk;
+                }
+
+                req->file_offset += chunk;
+                if (chunk > 0 && req->file_offset < req->file_size)
+                {
+                    more = true;
+                }
+                else if (req->file_verify)
+                {
+                    req->file_done = true;
+                    more = true;
+                }
                 break;
+            }
 
             case RCFOP_CSAP_CREATE:
                 READ_INT(msg->handle);
@@ -1589,6 +2251,21 @@ process_reply(ta *agent)
         }
     }
 
+    rcf_stats_reply(agent, req);
+
+    if (more)
+    {
+        /*
+         * The next chunk is sent after commands which are already
+         * waiting for the connection, so that they are not blocked
+         * until the whole file is transferred.
+         */
+        QEL_DELETE(req);
+        QEL_INSERT(agent->waiting.prev, req);
+        req->queued_ns = rcf_stats_now();
+        goto push;
+    }
+
     /* This value is necessary for the reboot state machine */
     last_opcode = msg->opcode;
     rcf_answer_user_request(req);
@@ -1610,7 +2287,7 @@ push:
         }
     }
 
-    if (!ack)
+    if (!ack && !more)
         send_pending_command(agent, sid);
 
     return;
@@ -1638,9 +2315,10 @@ bad_protocol:
 static int
 transmit_cmd(ta *agent, usrreq *req)
 {
-    int   rc, len;
-    int   file = -1;
-    char *data = cmd;
+    int       rc, len;
+    int       file = -1;
+    char     *data = cmd;
+    uint64_t  rest = 0;
 
     if (req->message->flags & BINARY_ATTACHMENT &&
         req->message->opcode != RCFOP_RPC)
@@ -1663,12 +2341,32 @@ transmit_cmd(ta *agent, usrreq *req)
             return -1;
         }
 
+        rest = st.st_size;
+        if (req->message->opcode == RCFOP_FPUT)
+        {
+            req->file_size = st.st_size;
+            rest = (req->file_size > req->file_offset) ?
+                   MIN(req->file_size - req->file_offset,
+                       RCF_FILE_CHUNK_SIZE) : 0;
+            req->file_chunk = rest;
+
+            if (lseek(file, req->file_offset, SEEK_SET) < 0)
+            {
+                req->message->error = TE_OS_RC(TE_RCF, errno);
+                ERROR("Cannot seek in file '%s'", req->message->file);
+                rcf_answer_user_request(req);
+                close(file);
+                return -1;
+            }
+        }
+
         TE_SNPRINTF(cmd + strlen(cmd), sizeof(cmd) - strlen(cmd),
-                    " attach %u", (unsigned int)st.st_size);
+                    " attach %u", (unsigned int)rest);
     }
 
     VERB("Transmit command \"%s\" to TA '%s'", cmd, agent->name);
 
+    req->sent_ns = rcf_stats_now();
     len = strlen(cmd) + 1;
     while (true)
     {
@@ -1699,19 +2397,21 @@ transmit_cmd(ta *agent, usrreq *req)
             continue;
         }
 
-        if (file < 0 || (len = read(file, cmd, sizeof(cmd))) == 0)
+        if (file < 0 || rest == 0)
             break;
 
-        if (len < 0)
+        if ((len = read(file, cmd, MIN(rest, sizeof(cmd)))) <= 0)
         {
-            req->message->error = TE_OS_RC(TE_RCF, errno);
+            req->message->error = (len == 0) ?
+                                  TE_RC(TE_RCF, TE_ENODATA) :
+                                  TE_OS_RC(TE_RCF, errno);
             ERROR("Read from file '%s' failed error=%r",
                   req->message->file, req->message->error);
             close(file);
             rcf_answer_user_request(req);
             return -1;
         }
-
+        rest -= len;
     }
 
     if (file != -1)
@@ -1834,6 +2534,98 @@ print_value(char *cmd, size_t size, unsigned char type, void *value)
     return ret;
 }
 
+/**
+ * Check whether the command is sent to the Test Agent in binary mode.
+ *
+ * @param agent         Test Agent structure
+ * @param opcode        operation code
+ *
+ * @return @c true if binary mode is used.
+ */
+static bool
+is_bin_cmd(ta *agent, rcf_op_t opcode)
+{
+    if (!agent->binary_proto)
+        return false;
+
+    switch (opcode)
+    {
+        case RCFOP_CONFGET:
+        case RCFOP_CONFSET:
+        case RCFOP_CONFADD:
+        case RCFOP_CONFDEL:
+        case RCFOP_CONFGRP_START:
+        case RCFOP_CONFGRP_END:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+/**
+ * Send the configuration command to the Test Agent in binary mode.
+ *
+ * @param agent         Test Agent structure
+ * @param req           user request structure
+ *
+ * @return 0 (success) or -1 (failure)
+ */
+static int
+send_cmd_bin(ta *agent, usrreq *req)
+{
+    /** Buffer for binary commands */
+    static te_dbuf buf = TE_DBUF_INIT(0);
+
+    rcf_msg  *msg = req->message;
+    te_errno  rc;
+
+    rcf_bin_start(&buf, msg->sid, msg->opcode);
+    switch (msg->opcode)
+    {
+        case RCFOP_CONFGET:
+        case RCFOP_CONFDEL:
+            rcf_bin_put_str(&buf, msg->id, strnlen(msg->id, RCF_MAX_ID));
+            break;
+
+        case RCFOP_CONFSET:
+        case RCFOP_CONFADD:
+            rcf_bin_put_str(&buf, msg->id, strnlen(msg->id, RCF_MAX_ID));
+            rcf_bin_put_str(&buf, msg->value,
+                            strnlen(msg->value, RCF_MAX_VAL));
+            break;
+
+        default:
+            break;
+    }
+    rcf_bin_finish(&buf);
+
+    req->timeout = (msg->opcode == RCFOP_CONFSET) ? RCF_CONFSET_TIMEOUT :
+                                                    RCF_CMD_TIMEOUT;
+
+    VERB("Transmit binary %s command to TA '%s'",
+         rcf_op_to_string(msg->opcode), agent->name);
+
+    req->sent_ns = rcf_stats_now();
+
+    if ((rc = (agent->m.transmit)(agent->handle, (char *)buf.ptr,
+                                  buf.len)) != 0)
+    {
+        msg->error = TE_RC(TE_RCF, rc);
+        ERROR("Failed to transmit command to TA '%s' errno %r",
+              agent->name, msg->error);
+        rcf_answer_user_request(req);
+        rcf_set_ta_dead(agent);
+        return -1;
+    }
+
+    req->sent = time(NULL);
+    agent->conn_locked = true;
+    agent->lock_sid = msg->sid;
+
+    return 0;
+}
+
 /* See description in rcf.h */
 int
 rcf_send_cmd(ta *agent, usrreq *req)
@@ -1856,7 +2648,15 @@ rcf_send_cmd(ta *agent, usrreq *req)
 
         INFO("Command '%s' is placed to waiting queue of TA %s",
              rcf_op_to_string(req->message->opcode), agent->name);
-        QEL_INSERT(&(agent->waiting), req);
+        QEL_INSERT(agent->waiting.prev, req);
+        return 0;
+    }
+
+    if (is_bin_cmd(agent, msg->opcode))
+    {
+        if (send_cmd_bin(agent, req) == 0)
+            QEL_INSERT(&(agent->sent), req);
+
         return 0;
     }
 
@@ -1969,10 +2769,28 @@ rcf_send_cmd(ta *agent, usrreq *req)
         case RCFOP_FPUT:
         case RCFOP_FGET:
         case RCFOP_FDEL:
-            PUT("%s %s",
-                msg->opcode == RCFOP_FPUT ? TE_PROTO_FPUT :
-                msg->opcode == RCFOP_FDEL ? TE_PROTO_FDEL : TE_PROTO_FGET,
-                msg->data);
+            /* Files are transferred in chunks starting at the offset */
+            msg->flags &= ~BINARY_ATTACHMENT;
+            if (msg->opcode == RCFOP_FDEL)
+            {
+                PUT(TE_PROTO_FDEL " %s", msg->data);
+            }
+            else if (req->file_done)
+            {
+                PUT(TE_PROTO_FGET " %s " TE_PROTO_FILE_CRC32, msg->data);
+            }
+            else if (msg->opcode == RCFOP_FPUT)
+            {
+                PUT(TE_PROTO_FPUT " %s %llu", msg->data,
+                    (unsigned long long)req->file_offset);
+                msg->flags |= BINARY_ATTACHMENT;
+            }
+            else
+            {
+                PUT(TE_PROTO_FGET " %s %llu %u", msg->data,
+                    (unsigned long long)req->file_offset,
+                    RCF_FILE_CHUNK_SIZE);
+            }
             req->timeout = RCF_CMD_TIMEOUT_HUGE;
             break;
 
@@ -2157,6 +2975,8 @@ rcf_alloc_usrreq(void)
 
     req = TE_ALLOC(sizeof(usrreq));
     req->message = TE_ALLOC(sizeof(rcf_msg));
+    req->attach_fd = -1;
+    req->queued_ns = rcf_stats_now();
 
     return req;
 }
@@ -2383,6 +3203,10 @@ process_user_request(usrreq *req)
             return;
         }
 
+        case RCFOP_OP_STATS:
+            rcf_stats_process_request(req);
+            return;
+
         case RCFOP_TACHECK:
             if (ta_checker.req == NULL)
             {
@@ -2637,10 +3461,7 @@ process_user_request(usrreq *req)
 
                         while (time(NULL) - t < RCF_SHUTDOWN_TIMEOUT)
                         {
-                            struct timeval tv  = tv0;
-                            fd_set         set = set0;
-
-                            select(FD_SETSIZE, &set, NULL, NULL, &tv);
+                            rcf_wait_events(&tv0);
 
                             if ((agt->m.is_ready)(agt->handle))
                             {
@@ -2661,7 +3482,7 @@ process_user_request(usrreq *req)
 
                                 INFO("Test Agent '%s' is down", agt->name);
                                 agt->flags |= TA_DOWN;
-                                (agt->m.close)(agt->handle, &set0);
+                                rcf_close_ta_conn(agt);
                                 break; /** Leave current 'while' loop */
                             }
                         }
@@ -2684,6 +3505,7 @@ process_user_request(usrreq *req)
                     RING("Test Agent '%s' is stopped", agt->name);
 
                     /* Free agent */
+                    rcf_unwatch_ta(agt);
                     free(agt->name);
                     free(agt->type);
                     free(agt->libname);
@@ -2815,9 +3637,6 @@ rcf_shutdown(void)
 {
     ta *agent;
 
-    struct timeval tv;
-    fd_set         set;
-
     time_t t = time(NULL);
 
     RING("Shutting down");
@@ -2838,9 +3657,7 @@ rcf_shutdown(void)
 
     while (shutdown_num > 0 && time(NULL) - t < RCF_SHUTDOWN_TIMEOUT)
     {
-        tv = tv0;
-        set = set0;
-        select(FD_SETSIZE, &set, NULL, NULL, &tv);
+        rcf_wait_events(&tv0);
         for (agent = agents; agent != NULL; agent = agent->next)
         {
             if (agent->flags & (TA_DOWN | TA_DEAD))
@@ -2862,7 +3679,7 @@ rcf_shutdown(void)
 
                 INFO("Test Agent '%s' is down", agent->name);
                 agent->flags |= TA_DOWN;
-                (agent->m.close)(agent->handle, &set0);
+                rcf_close_ta_conn(agent);
                 shutdown_num--;
             }
         }
@@ -2907,6 +3724,9 @@ process_cmd_line_opts(int argc, const char **argv)
           "Run in foreground (useful for debugging).", NULL },
         { "tce-conf", '\0', POPT_ARG_STRING, &tce_conf_file, 0,
           "Specify file with TCE configuration.", NULL },
+        { "op-stats", '\0', POPT_ARG_NONE | POPT_BIT_SET, &flags,
+          RCF_OP_STATS,
+          "Log latency statistics of requests on shutdown.", NULL },
 
         POPT_AUTOHELP
         POPT_TABLEEND
@@ -3002,6 +3822,28 @@ main(int argc, const char *argv[])
     tv0.tv_sec = RCF_SELECT_TIMEOUT;
     tv0.tv_usec = 0;
 
+    if ((epoll_fd = epoll_create1(EPOLL_CLOEXEC)) < 0)
+    {
+        ERROR("FATAL ERROR: epoll_create1() failed: %r",
+              TE_OS_RC(TE_RCF, errno));
+        goto exit;
+    }
+
+    {
+        struct epoll_event ev;
+
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.ptr = NULL;
+        if (ipc_get_server_poll_fd(server) < 0 ||
+            epoll_ctl(epoll_fd, EPOLL_CTL_ADD,
+                      ipc_get_server_poll_fd(server), &ev) != 0)
+        {
+            ERROR("FATAL ERROR: failed to watch IPC server");
+            goto exit;
+        }
+    }
+
     INFO("Starting...\n");
 
     if ((tmp_dir = getenv("TE_TMP")) == NULL)
@@ -3027,18 +3869,16 @@ main(int argc, const char *argv[])
     {
         RING("Empty list with TAs");
     }
-    for (agent = agents; agent != NULL; agent = agent->next)
+    if (rcf_init_agents() != 0)
     {
-        if (rcf_init_agent(agent) != 0)
-        {
-            ERROR("FATAL ERROR: TA initialization failed");
-            goto exit;
-        }
+        ERROR("FATAL ERROR: TA initialization failed");
+        goto exit;
     }
 
     /*
      * Go to background, if foreground mode is not requested.
-     * No threads should be created before become a daemon.
+     * No threads should be running when become a daemon
+     * (threads starting Test Agents are joined above).
      */
     if ((~flags & RCF_FOREGROUND) && (rcf_daemon() != 0))
     {
@@ -3049,29 +3889,13 @@ main(int argc, const char *argv[])
     INFO("Initialization is finished");
     while (1)
     {
-        struct timeval  tv = tv0;
-        fd_set          set = set0;
         size_t          len;
         time_t          now;
-        int             select_rc;
 
         req = NULL;
         rc = -1;
 
-        (void)ipc_get_server_fds(server, &set);
-
-        select_rc = select(FD_SETSIZE, &set, NULL, NULL, &tv);
-        if (select_rc < 0)
-        {
-            if (errno != EINTR)
-                ERROR("Unexpected failure of select(): rc=%d, errno=%d",
-                      select_rc, errno);
-            else
-                INFO("select() has been interrupted by signal");
-        }
-
-        if ((select_rc > 0) &&
-            ipc_is_server_ready(server, &set, FD_SETSIZE))
+        if (rcf_wait_events(&tv0) && ipc_is_server_poll_ready(server))
         {
             len = sizeof(rcf_msg);
 
@@ -3114,6 +3938,12 @@ main(int argc, const char *argv[])
                  rcf_op_to_string(req->message->opcode),
                  ipc_server_client_name(req->user));
 
+            req->attach_fd_ok =
+                (req->message->flags & ATTACHMENT_FD) != 0 &&
+                ipc_server_can_pass_fd(server);
+            req->file_verify = (req->message->flags & FILE_VERIFY) != 0;
+            req->queued_ns = rcf_stats_now();
+
             if (req->message->opcode == RCFOP_SHUTDOWN)
             {
                 INFO("Shutdown command is received");
@@ -3128,12 +3958,26 @@ main(int argc, const char *argv[])
 
             /*
             * In all reboot states except @c TA_REBOOT_STATE_REBOOTING,
-            * messages may come from the agent
+            * messages may come from the agent.
+            *
+            * Connections are watched in edge-triggered mode, so only
+            * agents with events are checked and all pending replies
+            * (including already buffered by the communication library)
+            * are processed. Connections which cannot be watched are
+            * checked on each iteration.
             */
-            if ((agent->m.is_ready)(agent->handle) &&
-                 agent->reboot_ctx.state != TA_REBOOT_STATE_REBOOTING)
+            if ((agent->io_ready || !agent->watched) &&
+                agent->reboot_ctx.state != TA_REBOOT_STATE_REBOOTING &&
+                (~agent->flags & TA_DEAD))
             {
-                process_reply(agent);
+                agent->io_ready = false;
+                while (agent->reboot_ctx.state !=
+                           TA_REBOOT_STATE_REBOOTING &&
+                       (~agent->flags & TA_DEAD) &&
+                       (agent->m.is_ready)(agent->handle))
+                {
+                    process_reply(agent);
+                }
             }
 
             rcf_ta_reboot_state_handler(agent);
@@ -3191,6 +4035,10 @@ main(int argc, const char *argv[])
 exit:
     rcf_shutdown();
 
+    if (flags & RCF_OP_STATS)
+        rcf_stats_log();
+    rcf_stats_destroy();
+
     if (req != NULL && req->message->opcode == RCFOP_SHUTDOWN)
         rcf_answer_user_request(req);
 
@@ -3198,6 +4046,8 @@ exit:
 
     free_ta_list();
     ipc_close_server(server);
+    if (epoll_fd >= 0)
+        close(epoll_fd);
 
     rcf_tce_conf_free(tce_conf);
 
@@ -59,6 +59,12 @@ extern "C" {
  */
 #define RCF_CONFSET_TIMEOUT (RCF_CMD_TIMEOUT * 3)
 
+/**
+ * Maximum length of a file chunk transferred by one command. Other
+ * commands to the Test Agent may be sent between chunks.
+ */
+#define RCF_FILE_CHUNK_SIZE     (1024 * 1024)
+
 /** Special session identifiers */
 enum {
     /** Session used for Log gathering */
@@ -93,6 +99,31 @@ struct usrreq {
     uint32_t                  timeout;  /**< Timeout in seconds */
     time_t                    sent;
     userreq_callback          cb;
+    bool                      attach_fd_ok; /**< The user accepts
+                                                 attachments as file
+                                                 descriptors */
+    int                       attach_fd;    /**< Memory file with
+                                                 attachment to be passed
+                                                 with the answer or -1 */
+    uint64_t                  file_offset;  /**< Offset of the next
+                                                 chunk of transferred
+                                                 file */
+    uint64_t                  file_size;    /**< Size of transferred
+                                                 file known so far */
+    size_t                    file_chunk;   /**< Length of the chunk
+                                                 being put */
+    bool                      file_verify;  /**< Checksums of files
+                                                 should be compared
+                                                 after transfer */
+    bool                      file_done;    /**< All chunks are
+                                                 transferred, checksum
+                                                 is requested */
+    uint64_t                  queued_ns;    /**< Time when the request
+                                                 is queued (monotonic) */
+    uint64_t                  sent_ns;      /**< Time when the command
+                                                 is sent to the TA */
+    uint64_t                  agent_ns;     /**< Execution time reported
+                                                 by the TA or 0 */
 };
 
 /** A description for a task/thread to be executed at TA startup */
@@ -211,6 +242,10 @@ struct ta {
     char               *type;               /**< Test Agent type */
     char               *libname;            /**< Dynamic library name */
     bool enable_synch_time;  /**< Enable synchronize time */
+    bool binary_proto_req;   /**< Binary protocol mode is requested
+                                  in the configuration */
+    bool binary_proto;       /**< Binary protocol mode is negotiated
+                                  with the TA */
     te_kvpair_h         conf;               /**< Configurations list of kv_pairs */
     usrreq              sent;               /**< User requests sent
                                                  to the TA */
@@ -241,6 +276,14 @@ struct ta {
     bool dynamic;             /**< Dynamic creation flag */
 
     struct rcf_talib_methods m; /**< TA-specific Methods */
+    rcf_talib_get_fd    get_fd;             /**< Optional method to get
+                                                 connection descriptor */
+    int                 fd;                 /**< Connection descriptor
+                                                 watched by event loop */
+    bool watched;            /**< Connection is watched by
+                                  the event loop */
+    bool io_ready;           /**< Event loop reported data
+                                  on the connection */
 
     ta_reboot_context reboot_ctx; /**< Reboot context */
 };
@@ -254,9 +297,31 @@ typedef struct ta_check {
 } ta_check;
 
 extern ta_check ta_checker;
+/** Select set updated by TA libraries on connect/close */
 extern fd_set set0;
+/** Event loop timeout */
 extern struct timeval tv0;
 
+/**
+ * Wait for events on Test Agent connections and IPC server.
+ * Test Agents with pending data are marked with io_ready flag.
+ *
+ * @param tv            timeout
+ *
+ * @return @c true if IPC server may be ready.
+ */
+extern bool rcf_wait_events(const struct timeval *tv);
+
+/**
+ * Stop watching the Test Agent connection in the event loop and
+ * close it.
+ *
+ * @param agent         Test Agent structure
+ *
+ * @return Status code.
+ */
+extern te_errno rcf_close_ta_conn(ta *agent);
+
 /**
  * Obtain TA structure address by Test Agent name.
  *
@@ -381,6 +446,39 @@ extern void rcf_ta_reboot_init_ctx(ta *agent);
  */
 extern void rcf_ta_reboot_get_next_reboot_type(ta *agent);
 
+/**
+ * Get the time to be used for latency statistics of requests.
+ *
+ * @return Monotonic time in nanoseconds.
+ */
+extern uint64_t rcf_stats_now(void);
+
+/**
+ * Account the reply to a command sent to the Test Agent: time spent
+ * by the request in queues, on the wire and on the Test Agent.
+ *
+ * @param agent Test Agent structure
+ * @param req   User request
+ */
+extern void rcf_stats_reply(ta *agent, usrreq *req);
+
+/**
+ * Process RCFOP_OP_STATS request and answer it.
+ *
+ * @param req   User request
+ */
+extern void rcf_stats_process_request(usrreq *req);
+
+/**
+ * Log collected statistics as an MI artifact.
+ */
+extern void rcf_stats_log(void);
+
+/**
+ * Release all statistics.
+ */
+extern void rcf_stats_destroy(void);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
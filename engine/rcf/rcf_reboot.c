@@ -544,10 +544,7 @@ try_soft_shutdown(ta *agent)
     /* TODO: This should be moved to a separate function */
     while (!is_timed_out(t, RCF_SHUTDOWN_TIMEOUT))
     {
-        struct timeval tv  = tv0;
-        fd_set         set = set0;
-
-        select(FD_SETSIZE, &set, NULL, NULL, &tv);
+        rcf_wait_events(&tv0);
 
         if ((agent->m.is_ready)(agent->handle))
         {
@@ -568,7 +565,7 @@ try_soft_shutdown(ta *agent)
 
             INFO("Test Agent '%s' is down", agent->name);
             agent->flags |= TA_DOWN;
-            (agent->m.close)(agent->handle, &set0);
+            rcf_close_ta_conn(agent);
             break;
         }
     }
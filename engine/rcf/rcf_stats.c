@@ -0,0 +1,317 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/** @file
+ * @brief RCF latency statistics of requests
+ *
+ *
+ * Copyright (C) 2023 OKTET Labs Ltd. All rights reserved.
+ */
+#include "te_config.h"
+
+#include "rcf.h"
+#include "te_alloc.h"
+#include "te_str.h"
+#include "te_string.h"
+#include "te_mi_log.h"
+
+#include "logger_api.h"
+#include "logger_ten.h"
+
+/** Number of chains in the hash table of statistics entries */
+#define RCF_STATS_HASH_SIZE     256
+
+/** Statistics of requests of one type sent to a Test Agent */
+typedef struct rcf_stats_entry {
+    struct rcf_stats_entry *next;   /**< Next entry in the hash chain */
+    rcf_op_t                opcode; /**< Operation code */
+    rcf_op_stats            stats;  /**< Statistics */
+} rcf_stats_entry;
+
+/** Hash table of statistics entries */
+static rcf_stats_entry *rcf_stats_hash[RCF_STATS_HASH_SIZE];
+
+/* See description in rcf.h */
+uint64_t
+rcf_stats_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* Reset statistics of a stage */
+static void
+rcf_stats_hist_reset(rcf_op_hist *hist)
+{
+    memset(hist, 0, sizeof(*hist));
+    hist->min_ns = UINT64_MAX;
+}
+
+/* Account time of a stage */
+static void
+rcf_stats_hist_add(rcf_op_hist *hist, uint64_t ns)
+{
+    uint64_t     us = ns / 1000;
+    unsigned int bucket = 0;
+
+    while (us != 0 && bucket < RCF_OP_STATS_BUCKETS - 1)
+    {
+        us >>= 1;
+        bucket++;
+    }
+
+    hist->count++;
+    hist->sum_ns += ns;
+    hist->min_ns = MIN(hist->min_ns, ns);
+    hist->max_ns = MAX(hist->max_ns, ns);
+    hist->hist[bucket]++;
+}
+
+/**
+ * Find statistics entry and create it if it does not exist.
+ *
+ * @param ta            Test Agent name
+ * @param opcode        operation code
+ *
+ * @return Statistics entry.
+ */
+static rcf_stats_entry *
+rcf_stats_lookup(const char *ta, rcf_op_t opcode)
+{
+    uint32_t         hash = 2166136261;
+    rcf_stats_entry *entry;
+    const char      *p;
+
+    /* FNV-1a */
+    for (p = ta; *p != '\0'; p++)
+    {
+        hash ^= (uint8_t)*p;
+        hash *= 16777619;
+    }
+    hash ^= (uint8_t)opcode;
+    hash *= 16777619;
+    hash %= RCF_STATS_HASH_SIZE;
+
+    for (entry = rcf_stats_hash[hash]; entry != NULL; entry = entry->next)
+    {
+        if (entry->opcode == opcode && strcmp(entry->stats.ta, ta) == 0)
+            return entry;
+    }
+
+    entry = TE_ALLOC(sizeof(*entry));
+    entry->opcode = opcode;
+    te_strlcpy(entry->stats.ta, ta, sizeof(entry->stats.ta));
+    te_strlcpy(entry->stats.op, rcf_op_to_string(opcode),
+               sizeof(entry->stats.op));
+    rcf_stats_hist_reset(&entry->stats.queue);
+    rcf_stats_hist_reset(&entry->stats.wire);
+    rcf_stats_hist_reset(&entry->stats.agent);
+    entry->next = rcf_stats_hash[hash];
+    rcf_stats_hash[hash] = entry;
+
+    return entry;
+}
+
+/* See description in rcf.h */
+void
+rcf_stats_reply(ta *agent, usrreq *req)
+{
+    rcf_stats_entry *entry;
+    uint64_t         rtt = rcf_stats_now() - req->sent_ns;
+
+    entry = rcf_stats_lookup(agent->name, req->message->opcode);
+
+    rcf_stats_hist_add(&entry->stats.queue, req->sent_ns - req->queued_ns);
+    if (req->agent_ns != 0 && req->agent_ns <= rtt)
+    {
+        rcf_stats_hist_add(&entry->stats.agent, req->agent_ns);
+        rtt -= req->agent_ns;
+    }
+    rcf_stats_hist_add(&entry->stats.wire, rtt);
+
+    req->agent_ns = 0;
+}
+
+/* Reset statistics; entries are kept to avoid reallocation */
+static void
+rcf_stats_reset(void)
+{
+    rcf_stats_entry *entry;
+    unsigned int     i;
+
+    for (i = 0; i < RCF_STATS_HASH_SIZE; i++)
+    {
+        for (entry = rcf_stats_hash[i]; entry != NULL; entry = entry->next)
+        {
+            rcf_stats_hist_reset(&entry->stats.queue);
+            rcf_stats_hist_reset(&entry->stats.wire);
+            rcf_stats_hist_reset(&entry->stats.agent);
+        }
+    }
+}
+
+/**
+ * Add measurements of a stage to the MI artifact.
+ *
+ * @param logger        MI logger
+ * @param entry         statistics entry
+ * @param stage         name of the stage
+ * @param hist          statistics of the stage
+ * @param name          buffer for the name of measurements
+ * @param buf           buffer for the histogram
+ */
+static void
+rcf_stats_log_hist(te_mi_logger *logger, const rcf_stats_entry *entry,
+                   const char *stage, const rcf_op_hist *hist,
+                   te_string *name, te_string *buf)
+{
+    unsigned int i;
+
+    if (hist->count == 0)
+        return;
+
+    te_string_reset(name);
+    te_string_append(name, "%s %s %s", entry->stats.op, entry->stats.ta,
+                     stage);
+
+    te_mi_logger_add_meas(logger, NULL, TE_MI_MEAS_LATENCY, name->ptr,
+                          TE_MI_MEAS_AGGR_MIN, hist->min_ns,
+                          TE_MI_MEAS_MULTIPLIER_NANO);
+    te_mi_logger_add_meas(logger, NULL, TE_MI_MEAS_LATENCY, name->ptr,
+                          TE_MI_MEAS_AGGR_MEAN,
+                          (double)hist->sum_ns / hist->count,
+                          TE_MI_MEAS_MULTIPLIER_NANO);
+    te_mi_logger_add_meas(logger, NULL, TE_MI_MEAS_LATENCY, name->ptr,
+                          TE_MI_MEAS_AGGR_MAX, hist->max_ns,
+                          TE_MI_MEAS_MULTIPLIER_NANO);
+    te_mi_logger_add_meas(logger, NULL, TE_MI_MEAS_UNITLESS_VALUE,
+                          name->ptr, TE_MI_MEAS_AGGR_SINGLE, hist->count,
+                          TE_MI_MEAS_MULTIPLIER_PLAIN);
+
+    /* Histogram as "<lower bound in us>:<count>" pairs */
+    te_string_reset(buf);
+    for (i = 0; i < RCF_OP_STATS_BUCKETS; i++)
+    {
+        if (hist->hist[i] == 0)
+            continue;
+        te_string_append(buf, "%s%llu:%llu", buf->len == 0 ? "" : " ",
+                         i == 0 ? 0ULL : 1ULL << (i - 1),
+                         (unsigned long long)hist->hist[i]);
+    }
+    te_mi_logger_add_comment(logger, NULL, name->ptr, "%s", buf->ptr);
+}
+
+/* See description in rcf.h */
+void
+rcf_stats_log(void)
+{
+    te_mi_logger    *logger;
+    te_string        name = TE_STRING_INIT;
+    te_string        buf = TE_STRING_INIT;
+    rcf_stats_entry *entry;
+    unsigned int     i;
+    te_errno         rc;
+
+    rc = te_mi_logger_meas_create("te_rcf", &logger);
+    if (rc != 0)
+    {
+        ERROR("Failed to create MI logger for request statistics: %r",
+              rc);
+        return;
+    }
+
+    for (i = 0; i < RCF_STATS_HASH_SIZE; i++)
+    {
+        for (entry = rcf_stats_hash[i]; entry != NULL; entry = entry->next)
+        {
+            rcf_stats_log_hist(logger, entry, "queue", &entry->stats.queue,
+                               &name, &buf);
+            rcf_stats_log_hist(logger, entry, "wire", &entry->stats.wire,
+                               &name, &buf);
+            rcf_stats_log_hist(logger, entry, "agent", &entry->stats.agent,
+                               &name, &buf);
+        }
+    }
+
+    te_mi_logger_destroy(logger);
+    te_string_free(&name);
+    te_string_free(&buf);
+}
+
+/**
+ * Replace the message of the request with the one containing collected
+ * statistics.
+ *
+ * @param req           user request
+ */
+static void
+rcf_stats_answer(usrreq *req)
+{
+    rcf_stats_entry *entry;
+    rcf_msg         *msg;
+    unsigned int     num = 0;
+    unsigned int     i;
+
+    for (i = 0; i < RCF_STATS_HASH_SIZE; i++)
+    {
+        for (entry = rcf_stats_hash[i]; entry != NULL; entry = entry->next)
+        {
+            if (entry->stats.queue.count != 0)
+                num++;
+        }
+    }
+
+    msg = TE_ALLOC(sizeof(*msg) + num * sizeof(rcf_op_stats));
+    *msg = *req->message;
+    msg->data_len = 0;
+    for (i = 0; i < RCF_STATS_HASH_SIZE; i++)
+    {
+        for (entry = rcf_stats_hash[i]; entry != NULL; entry = entry->next)
+        {
+            if (entry->stats.queue.count == 0)
+                continue;
+            memcpy(msg->data + msg->data_len, &entry->stats,
+                   sizeof(entry->stats));
+            msg->data_len += sizeof(entry->stats);
+        }
+    }
+
+    free(req->message);
+    req->message = msg;
+}
+
+/* See description in rcf.h */
+void
+rcf_stats_process_request(usrreq *req)
+{
+    int flags = req->message->intparm;
+
+    req->message->error = 0;
+    req->message->data_len = 0;
+
+    if (flags & RCF_OP_STATS_GET)
+        rcf_stats_answer(req);
+    if (flags & RCF_OP_STATS_LOG)
+        rcf_stats_log();
+    if (flags & RCF_OP_STATS_RESET)
+        rcf_stats_reset();
+
+    rcf_answer_user_request(req);
+}
+
+/* See description in rcf.h */
+void
+rcf_stats_destroy(void)
+{
+    rcf_stats_entry *entry;
+    unsigned int     i;
+
+    for (i = 0; i < RCF_STATS_HASH_SIZE; i++)
+    {
+        while ((entry = rcf_stats_hash[i]) != NULL)
+        {
+            rcf_stats_hash[i] = entry->next;
+            free(entry);
+        }
+    }
+}
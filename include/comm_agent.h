@@ -12,6 +12,7 @@
 #define __TE_COMM_AGENT_H__
 
 #include "te_errno.h"
+#include "te_dbuf.h"
 
 /** This structure is used to store some context for each connection. */
 struct rcf_comm_connection;
@@ -108,6 +109,37 @@ extern int rcf_comm_agent_wait(rcf_comm_connection *rcc,
 extern int rcf_comm_agent_reply(rcf_comm_connection *rcc,
                                 const void *p_buffer, size_t length);
 
+/**
+ * Send a part of a file as a continuation of the reply. The part is
+ * copied from the file to the connection in the kernel if possible.
+ * If replies of the calling thread are captured (see
+ * rcf_comm_agent_capture()), the captured data are sent first and
+ * the capture buffer is emptied, so the caller should hold the lock
+ * protecting the connection.
+ *
+ * @param rcc           Handler received from rcf_comm_agent_init.
+ * @param fd            File descriptor opened for reading.
+ * @param offset        Offset of the part in the file.
+ * @param length        Length of the part.
+ *
+ * @return Status code.
+ * @retval 0            Success.
+ * @retval TE_ENODATA   The file is shorter than expected.
+ * @retval other value  errno.
+ */
+extern int rcf_comm_agent_reply_file(rcf_comm_connection *rcc, int fd,
+                                     uint64_t offset, size_t length);
+
+/**
+ * Start or stop capturing replies sent by the calling thread.
+ * While capturing is on, rcf_comm_agent_reply() called by the thread
+ * appends data to the buffer instead of sending it, so that a reply
+ * consisting of several parts may be sent later by one call.
+ *
+ * @param buf           Buffer for replies or @c NULL to stop capturing.
+ */
+extern void rcf_comm_agent_capture(te_dbuf *buf);
+
 /**
  * Close connection.
  *
@@ -46,6 +46,14 @@ extern "C" {
 #define HOST_REBOOT            16   /**< Reboot the host with Test Agent
                                          process */
 #define COLD_REBOOT            32   /**< Cold reboot host */
+#define ATTACHMENT_FD          64   /**< In request: the user accepts
+                                         binary attachment as a file
+                                         descriptor passed with
+                                         the answer; in answer:
+                                         the descriptor is passed and
+                                         file is not created */
+#define FILE_VERIFY           128   /**< Compare checksums of files
+                                         after transfer */
 /*@}*/
 
 /** @name Traffic flags */
@@ -56,6 +64,12 @@ extern "C" {
 #define TR_MISMATCH             0x10
 /*@}*/
 
+/** @name Flags of RCFOP_OP_STATS request passed in intparm */
+#define RCF_OP_STATS_GET        1   /**< Return statistics in data */
+#define RCF_OP_STATS_LOG        2   /**< Log statistics as MI artifact */
+#define RCF_OP_STATS_RESET      4   /**< Reset statistics */
+/*@}*/
+
 
 /** RCF operation codes */
 typedef enum {
@@ -98,6 +112,7 @@ typedef enum {
     RCFOP_TADEAD,           /**< Inform RCF that TA is dead */
     RCFOP_GET_SNIFFERS,     /**< Obtain the list of sniffers */
     RCFOP_GET_SNIF_DUMP,    /**< Pull out capture logs of the sniffer */
+    RCFOP_OP_STATS,         /**< Latency statistics of requests */
 } rcf_op_t;
 
 
@@ -125,7 +140,8 @@ typedef struct rcf_msg {
                                        encode data length (RCFOP_RPC);
                                        answer error (RCFOP_TRSEND_RECV);
                                        poll request ID (RCFOP_TRPOLL,
-                                       RCFOP_TRPOLL_CANCEL) */
+                                       RCFOP_TRPOLL_CANCEL);
+                                       flags (RCFOP_OP_STATS) */
     size_t   data_len;          /**< Length of additional data */
     char     id[RCF_MAX_ID];    /**< TA type;
                                      variable name;
@@ -140,6 +156,8 @@ typedef struct rcf_msg {
 
     char  data[0];              /**< Start of additional for commands:
                                      RCFOP_TALIST (list of names);
+                                     RCFOP_OP_STATS (rcf_op_stats
+                                     array);
                                      RCFOP_TAREBOOT (parameters);
                                      RCFOP_CSAP_CREATE (parameters);
                                      RCFOP_EXECUTE (parameters);
@@ -219,6 +237,7 @@ rcf_op_to_string(rcf_op_t op)
         case RCFOP_KILL:            return "kill";
         case RCFOP_GET_SNIFFERS:    return "get sniffers";
         case RCFOP_GET_SNIF_DUMP:   return "get snif dump";
+        case RCFOP_OP_STATS:        return "op stats";
         default:                    return "(unknown)";
     }
 }
@@ -178,6 +178,21 @@ typedef te_errno (* rcf_talib_receive)(rcf_talib_handle handle,
 typedef te_errno (* rcf_talib_close)(rcf_talib_handle  handle,
                                      fd_set           *select_set);
 
+/**
+ * Get the file descriptor of the Test Agent connection which becomes
+ * readable when data from the Test Agent are pending.
+ *
+ * This method is optional and is exported separately from
+ * rcf_talib_methods (see RCF_TALIB_GET_FD_DEFINE()) to keep the
+ * structure layout. If it is not provided, RCF finds the descriptor
+ * added to the select set by the connect method.
+ *
+ * @param handle        TA handle
+ *
+ * @return File descriptor or -1.
+ */
+typedef int (* rcf_talib_get_fd)(rcf_talib_handle handle);
+
 /**
  * Structure to keep RCF TA methods.
  * A library that implements RCF TA communication type
@@ -214,6 +229,20 @@ struct rcf_talib_methods TE_CONCAT(TE_LIB_NAME, _methods) = {            \
     talib_prefix_ ## _receive                                           \
 }
 
+/**
+ * Export optional RCF TA communication library method to get
+ * the connection file descriptor (see rcf_talib_get_fd).
+ *
+ * @param talib_prefix_  Prefix name used in method functions
+ *
+ * @note The method is exported as TE_LIB_NAME with @c _get_fd_method
+ *       suffix.
+ */
+#define RCF_TALIB_GET_FD_DEFINE(talib_prefix_) \
+extern rcf_talib_get_fd TE_CONCAT(TE_LIB_NAME, _get_fd_method);          \
+rcf_talib_get_fd TE_CONCAT(TE_LIB_NAME, _get_fd_method) =               \
+    talib_prefix_ ## _get_fd
+
 #ifdef __cplusplus
 }
 #endif
@@ -16,7 +16,10 @@
 typedef enum {
     RCF_RPC_CALL,       /**< Call non-blocking RPC (if supported) */
     RCF_RPC_WAIT,       /**< Wait until non-blocking RPC is finished */
-    RCF_RPC_CALL_WAIT   /**< Call blocking RPC */
+    RCF_RPC_CALL_WAIT,  /**< Call blocking RPC */
+    RCF_RPC_JOB         /**< Call RPC in a separate thread of RPC server
+                             without waiting for its completion; many
+                             jobs may be in progress at the same time */
 } rcf_rpc_op;
 
 #define RCF_RPC_NAME_LEN    64
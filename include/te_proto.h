@@ -47,8 +47,18 @@
 #define TE_PROTO_THREAD         "thread"
 #define TE_PROTO_PROCESS        "process"
 
+/** Argument of fget requesting checksum of the file instead of data */
+#define TE_PROTO_FILE_CRC32     "crc32"
+
+/**
+ * Message preceding an answer which reports time of command execution
+ * on the Test Agent in microseconds: "SID <sid> time <usec>".
+ */
+#define TE_PROTO_EXEC_TIME      "time"
+
 #define TE_PROTO_GET_SNIFFERS   "get_sniffers"
 #define TE_PROTO_GET_SNIF_DUMP  "get_snif_dump"
+#define TE_PROTO_BINARY         "binary"
 
 #ifdef RCF_NEED_TYPES
 /**
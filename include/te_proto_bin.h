@@ -0,0 +1,325 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/** @file
+ * @brief Test Protocol definitions
+ *
+ * Binary mode of the Test Protocol.
+ *
+ * A binary message consists of a header (@c RCF_BIN_MAGIC byte and
+ * 32-bit length of the body in network byte order) and a body.
+ * The body starts with two 32-bit numbers: session identifier and
+ * code (operation code in commands, status code in answers), then
+ * typed fields follow. Each field starts with one byte of type
+ * (see rcf_var_type_t). Integers are stored in network byte order,
+ * strings are stored as 32-bit length followed by the string including
+ * the terminating zero, so they may be used in place after parsing.
+ *
+ * The magic byte never starts a text command, so binary and text
+ * messages may be mixed on a connection. Binary mode is negotiated
+ * with @c TE_PROTO_BINARY text command.
+ *
+ * Copyright (C) 2004-2023 OKTET Labs Ltd. All rights reserved.
+ */
+
+#ifndef __TE_PROTO_BIN_H__
+#define __TE_PROTO_BIN_H__
+
+#include "te_config.h"
+
+#if HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include "te_stdint.h"
+#include "te_defs.h"
+#include "te_errno.h"
+#include "te_dbuf.h"
+#include "rcf_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** The first byte of a binary message */
+#define RCF_BIN_MAGIC       0xfe
+
+/** Length of the binary message header */
+#define RCF_BIN_HDR_LEN     5
+
+/** Parser of a binary message body */
+typedef struct rcf_bin_parser {
+    uint8_t *ptr;   /**< The first byte which is not parsed yet */
+    uint8_t *end;   /**< The byte following the message */
+} rcf_bin_parser;
+
+/**
+ * Check whether a message is a binary one.
+ *
+ * @param msg       received message
+ * @param len       length of the received part of the message
+ *
+ * @return @c true if the message is binary.
+ */
+static inline bool
+rcf_bin_is_msg(const void *msg, size_t len)
+{
+    return len > 0 && *(const uint8_t *)msg == RCF_BIN_MAGIC;
+}
+
+/**
+ * Get full length of a binary message by its header.
+ *
+ * @param hdr       message header (@c RCF_BIN_HDR_LEN bytes)
+ *
+ * @return Length of the message including the header.
+ */
+static inline size_t
+rcf_bin_msg_len(const void *hdr)
+{
+    const uint8_t *p = (const uint8_t *)hdr + 1;
+
+    return RCF_BIN_HDR_LEN + (((size_t)p[0] << 24) | ((size_t)p[1] << 16) |
+                              ((size_t)p[2] << 8) | (size_t)p[3]);
+}
+
+/**
+ * Get size of an integer field value.
+ *
+ * @param type      integer type
+ *
+ * @return Size in bytes.
+ */
+static inline size_t
+rcf_bin_int_size(rcf_var_type_t type)
+{
+    switch (type)
+    {
+        case RCF_INT8:
+        case RCF_UINT8:
+            return sizeof(uint8_t);
+
+        case RCF_INT16:
+        case RCF_UINT16:
+            return sizeof(uint16_t);
+
+        case RCF_INT32:
+        case RCF_UINT32:
+            return sizeof(uint32_t);
+
+        default:
+            return sizeof(uint64_t);
+    }
+}
+
+/**
+ * Append a big-endian unsigned integer to a buffer.
+ *
+ * @param buf       buffer
+ * @param val       value
+ * @param size      number of bytes
+ */
+static inline void
+rcf_bin_put_be(te_dbuf *buf, uint64_t val, size_t size)
+{
+    uint8_t tmp[sizeof(uint64_t)];
+    size_t  i;
+
+    for (i = 0; i < size; i++)
+        tmp[i] = val >> ((size - i - 1) * 8);
+
+    te_dbuf_append(buf, tmp, size);
+}
+
+/**
+ * Start a binary message. The buffer is reset.
+ *
+ * @param buf       buffer
+ * @param sid       session identifier
+ * @param code      operation code or status code
+ */
+static inline void
+rcf_bin_start(te_dbuf *buf, uint32_t sid, uint32_t code)
+{
+    uint8_t magic = RCF_BIN_MAGIC;
+
+    te_dbuf_reset(buf);
+    te_dbuf_append(buf, &magic, sizeof(magic));
+    rcf_bin_put_be(buf, 0, sizeof(uint32_t));
+    rcf_bin_put_be(buf, sid, sizeof(uint32_t));
+    rcf_bin_put_be(buf, code, sizeof(uint32_t));
+}
+
+/**
+ * Append an integer field to a binary message.
+ *
+ * @param buf       buffer
+ * @param type      integer type (not @c RCF_STRING)
+ * @param val       value
+ */
+static inline void
+rcf_bin_put_int(te_dbuf *buf, rcf_var_type_t type, uint64_t val)
+{
+    uint8_t t = type;
+
+    te_dbuf_append(buf, &t, sizeof(t));
+    rcf_bin_put_be(buf, val, rcf_bin_int_size(type));
+}
+
+/**
+ * Append a string field to a binary message.
+ *
+ * @param buf       buffer
+ * @param str       string
+ * @param len       length of the string without the terminating zero
+ */
+static inline void
+rcf_bin_put_str(te_dbuf *buf, const char *str, size_t len)
+{
+    uint8_t t = RCF_STRING;
+
+    te_dbuf_append(buf, &t, sizeof(t));
+    rcf_bin_put_be(buf, len + 1, sizeof(uint32_t));
+    te_dbuf_append(buf, str, len);
+    te_dbuf_append(buf, NULL, 1);
+}
+
+/**
+ * Finish a binary message filling in its length.
+ *
+ * @param buf       buffer
+ */
+static inline void
+rcf_bin_finish(te_dbuf *buf)
+{
+    size_t  len = buf->len - RCF_BIN_HDR_LEN;
+    size_t  i;
+
+    for (i = 0; i < sizeof(uint32_t); i++)
+        buf->ptr[1 + i] = len >> ((sizeof(uint32_t) - i - 1) * 8);
+}
+
+/**
+ * Get a big-endian unsigned integer from a binary message.
+ *
+ * @param parser    parser
+ * @param size      number of bytes
+ * @param val       location for the value
+ *
+ * @return Status code.
+ */
+static inline te_errno
+rcf_bin_get_be(rcf_bin_parser *parser, size_t size, uint64_t *val)
+{
+    size_t i;
+
+    if ((size_t)(parser->end - parser->ptr) < size)
+        return TE_EFMT;
+
+    for (*val = 0, i = 0; i < size; i++)
+        *val = (*val << 8) | *parser->ptr++;
+
+    return 0;
+}
+
+/**
+ * Start parsing a binary message.
+ *
+ * @param parser    parser to initialize
+ * @param msg       message
+ * @param len       length of the message
+ * @param sid       location for session identifier
+ * @param code      location for operation code or status code
+ *
+ * @return Status code.
+ */
+static inline te_errno
+rcf_bin_parse_start(rcf_bin_parser *parser, void *msg, size_t len,
+                    uint32_t *sid, uint32_t *code)
+{
+    uint64_t val;
+
+    if (len < RCF_BIN_HDR_LEN || !rcf_bin_is_msg(msg, len) ||
+        rcf_bin_msg_len(msg) != len)
+        return TE_EFMT;
+
+    parser->ptr = (uint8_t *)msg + RCF_BIN_HDR_LEN;
+    parser->end = (uint8_t *)msg + len;
+
+    if (rcf_bin_get_be(parser, sizeof(uint32_t), &val) != 0)
+        return TE_EFMT;
+    *sid = val;
+
+    if (rcf_bin_get_be(parser, sizeof(uint32_t), &val) != 0)
+        return TE_EFMT;
+    *code = val;
+
+    return 0;
+}
+
+/**
+ * Check whether all fields of a binary message are parsed.
+ *
+ * @param parser    parser
+ *
+ * @return @c true if there are no more fields.
+ */
+static inline bool
+rcf_bin_parse_end(const rcf_bin_parser *parser)
+{
+    return parser->ptr == parser->end;
+}
+
+/**
+ * Get an integer field from a binary message.
+ *
+ * @param parser    parser
+ * @param type      expected integer type
+ * @param val       location for the value
+ *
+ * @return Status code.
+ */
+static inline te_errno
+rcf_bin_get_int(rcf_bin_parser *parser, rcf_var_type_t type, uint64_t *val)
+{
+    if (parser->ptr == parser->end || *parser->ptr != type ||
+        type >= RCF_STRING)
+        return TE_EFMT;
+
+    parser->ptr++;
+    return rcf_bin_get_be(parser, rcf_bin_int_size(type), val);
+}
+
+/**
+ * Get a string field from a binary message. The string is not copied.
+ *
+ * @param parser    parser
+ * @param str       location for the string pointer
+ * @param len       location for the string length without
+ *                  the terminating zero (may be @c NULL)
+ *
+ * @return Status code.
+ */
+static inline te_errno
+rcf_bin_get_str(rcf_bin_parser *parser, char **str, size_t *len)
+{
+    uint64_t n;
+
+    if (parser->ptr == parser->end || *parser->ptr != RCF_STRING)
+        return TE_EFMT;
+
+    parser->ptr++;
+    if (rcf_bin_get_be(parser, sizeof(uint32_t), &n) != 0 || n == 0 ||
+        (uint64_t)(parser->end - parser->ptr) < n || parser->ptr[n - 1] != 0)
+        return TE_EFMT;
+
+    *str = (char *)parser->ptr;
+    if (len != NULL)
+        *len = n - 1;
+    parser->ptr += n;
+
+    return 0;
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+#endif /* !__TE_PROTO_BIN_H__ */
@@ -51,9 +51,13 @@
 #if HAVE_FCNTL_H
 #include <fcntl.h>
 #endif
+#if HAVE_SYS_SENDFILE_H
+#include <sys/sendfile.h>
+#endif
 
 #include "te_alloc.h"
 #include "te_errno.h"
+#include "te_proto_bin.h"
 #include "comm_agent.h"
 
 
@@ -70,15 +74,29 @@
     } while (0)
 
 
+/** Size of the receive buffer of a connection */
+#define TE_COMM_NET_AGENT_RBUF_SIZE     16384
+
 /** This structure is used to store some context for each connection. */
 struct rcf_comm_connection {
     int     socket;          /**< Connection socket */
     size_t  bytes_to_read;   /**< Number of bytes of attachment to read */
+    size_t  rbuf_start;      /**< Offset of the first unread byte
+                                  in the receive buffer */
+    size_t  rbuf_end;        /**< Offset of the byte following the last
+                                  received one in the receive buffer */
+    char    rbuf[TE_COMM_NET_AGENT_RBUF_SIZE]; /**< Receive buffer */
 };
 
 
 /* Static function declaration. See implementation for comments */
 static int find_attach(char *buf, size_t len);
+static char *find_term(char *buf, size_t len);
+static int fill_rbuf(struct rcf_comm_connection *rcc);
+static int read_conn(struct rcf_comm_connection *rcc, void *buffer,
+                     size_t len);
+static int receive_bin(struct rcf_comm_connection *rcc, char *buffer,
+                       size_t *pbytes, void **pba);
 static int read_socket(int socket, void *buffer, size_t len);
 
 /* See description in comm_agent.h */
@@ -287,6 +305,7 @@ rcf_comm_agent_wait(struct rcf_comm_connection *rcc,
                     char *buffer, size_t *pbytes, void **pba)
 {
     int     ret;
+    int     attach_size;
     size_t  l = 0;
 
     if (rcc->bytes_to_read)
@@ -297,12 +316,12 @@ rcf_comm_agent_wait(struct rcf_comm_connection *rcc,
             /* Enough space */
             *pbytes = rcc->bytes_to_read;
             rcc->bytes_to_read = 0;
-            return read_socket(rcc->socket, buffer, *pbytes);
+            return read_conn(rcc, buffer, *pbytes);
         }
         else
         {
             /* Buffer is too small for the attachment */
-            if ((ret = read_socket(rcc->socket, buffer, *pbytes)) != 0)
+            if ((ret = read_conn(rcc, buffer, *pbytes)) != 0)
                 return ret; /* Some error occurred */
 
             {
@@ -315,100 +334,115 @@ rcf_comm_agent_wait(struct rcf_comm_connection *rcc,
         }
     }
 
+    if (rcc->rbuf_start == rcc->rbuf_end)
+    {
+        if ((ret = fill_rbuf(rcc)) != 0)
+            return ret;
+    }
+    if ((uint8_t)rcc->rbuf[rcc->rbuf_start] == RCF_BIN_MAGIC)
+        return receive_bin(rcc, buffer, pbytes, pba);
+
+    /* Copy the message from the receive buffer up to the terminator */
     while (1)
     {
-        int r;
-        errno = 0;
+        char   *start;
+        char   *term;
+        size_t  n;
 
-        r = recv(rcc->socket, buffer + l, 1, 0);
-        if (r < 0)
+        if (rcc->rbuf_start == rcc->rbuf_end)
         {
-            if (errno == EINTR) /* Valgrind work-around */
-                continue;
-            ERROR("recv() failed\n");
-            return TE_OS_RC(TE_COMM, errno);
+            if ((ret = fill_rbuf(rcc)) != 0)
+                return ret;
         }
-        if (r == 0)
+
+        start = rcc->rbuf + rcc->rbuf_start;
+        n = rcc->rbuf_end - rcc->rbuf_start;
+        term = find_term(start, n);
+        if (term != NULL)
+            n = term - start + 1;
+
+        if (n > *pbytes - l)
         {
-            ERROR("%s(): recv() returned 0, connection is closed\n",
-                  __FUNCTION__);
-            return TE_RC(TE_COMM, TE_EPIPE);
+            /* The terminator (if any) does not fit into the buffer */
+            n = *pbytes - l;
+            term = NULL;
         }
 
-        if (buffer[l] == 0
-#ifdef TE_COMM_DEBUG_PROTO
-            || buffer[l] == '\n'
-#endif
-            )
-        {
-            /* The whole message received */
-            int attach_size;
+        memcpy(buffer + l, start, n);
+        rcc->rbuf_start += n;
+        l += n;
+
+        if (term != NULL)
+            break;
 
+        if (l == *pbytes)
+            return TE_RC(TE_COMM, TE_ESMALLBUF);
+    }
+
+    /* The whole message received */
 #ifdef TE_COMM_DEBUG_PROTO
-            if (buffer[l] == '\n')
-            {
-                buffer[l] = 0;           /* Change '\n' to zero... */
+    if (buffer[l - 1] == '\n')
+    {
+        buffer[l - 1] = 0;           /* Change '\n' to zero... */
 
-                if ((l > 0) && (buffer[l - 1] == '\r'))
-                {
-                    /* ... and change '\r' to the space */
-                    buffer[l - 1] = ' ';
-                }
-            }
+        if ((l > 1) && (buffer[l - 2] == '\r'))
+        {
+            /* ... and change '\r' to the space */
+            buffer[l - 2] = ' ';
+        }
+    }
 #endif
 
-            l++;
+    attach_size = find_attach(buffer, l);
 
-            attach_size = find_attach(buffer, l);
+    if (attach_size == -1)
+    {
+        /* No attachment */
+        *pbytes = l;
 
-            if (attach_size == -1)
-            {
-                /* No attachment */
-                *pbytes = l;
+        /* Set pba to NULL because no attachment attached */
+        if (pba != NULL)
+            *pba = NULL;
 
-                /* Set pba to NULL because no attachment attached */
-                if (pba != NULL)
-                    *pba = NULL;
+        return 0;
+    }
 
-                return 0;
-            }
-            else
-            {
-                /* Attachment found. */
-
-                /* Set pba to the first byte of the attachment */
-                if (pba != NULL)
-                    *pba = buffer + l;
-
-                if (*pbytes >= l + attach_size)
-                {
-                    /* Buffer is enough to write attachment */
-                    *pbytes = l + attach_size;
-                    return read_socket(rcc->socket, buffer + l,
-                                       attach_size);
-                }
-                else
-                {
-                    /* Buffer is too small to write attachment */
-                    size_t to_read = *pbytes - l;
-
-                    ret = read_socket(rcc->socket, buffer + l, to_read);
-                    if (ret != 0)
-                        return ret; /* Some error occurred */
-                    rcc->bytes_to_read = attach_size - to_read;
-                    *pbytes = attach_size + l;
-                    return TE_RC(TE_COMM, TE_EPENDING);
-                }
-            }
-        }
+    /* Attachment found. */
 
-        if (l == (*pbytes - 1))
-            return TE_RC(TE_COMM, TE_ESMALLBUF);
+    /* Set pba to the first byte of the attachment */
+    if (pba != NULL)
+        *pba = buffer + l;
 
-        l += r;
+    if (*pbytes >= l + attach_size)
+    {
+        /* Buffer is enough to write attachment */
+        *pbytes = l + attach_size;
+        return read_conn(rcc, buffer + l, attach_size);
+    }
+    else
+    {
+        /* Buffer is too small to write attachment */
+        size_t to_read = *pbytes - l;
+
+        ret = read_conn(rcc, buffer + l, to_read);
+        if (ret != 0)
+            return ret; /* Some error occurred */
+        rcc->bytes_to_read = attach_size - to_read;
+        *pbytes = attach_size + l;
+        return TE_RC(TE_COMM, TE_EPENDING);
     }
 }
 
+/** Buffer for replies captured by the thread or @c NULL */
+static __thread te_dbuf *capture_buf = NULL;
+
+/* See description in comm_agent.h */
+void
+rcf_comm_agent_capture(te_dbuf *buf)
+{
+    capture_buf = buf;
+}
+
 /**
  * Send reply to the Test Engine side of Network Communication library.
  *
@@ -429,7 +463,12 @@ rcf_comm_agent_reply(struct rcf_comm_connection *rcc, const void *buffer,
 
     if (length == 0)
         return 0;
+
+    if (capture_buf != NULL)
+        return te_dbuf_append(capture_buf, buffer, length);
+
 #ifdef TE_COMM_DEBUG_PROTO
+    if (!rcf_bin_is_msg(buffer, length))
     {
         /* Change \x0 to \n in the user (!!!) buffer before sending */
         int n = strlen((const char *)buffer);
@@ -459,6 +498,60 @@ rcf_comm_agent_reply(struct rcf_comm_connection *rcc, const void *buffer,
 }
 
 
+/* See description in comm_agent.h */
+int
+rcf_comm_agent_reply_file(struct rcf_comm_connection *rcc, int fd,
+                          uint64_t offset, size_t length)
+{
+    ssize_t sent_len;
+
+    if (capture_buf != NULL && capture_buf->len > 0)
+    {
+        te_dbuf *buf = capture_buf;
+        int      rc;
+
+        capture_buf = NULL;
+        rc = rcf_comm_agent_reply(rcc, buf->ptr, buf->len);
+        capture_buf = buf;
+        te_dbuf_reset(buf);
+        if (rc != 0)
+            return rc;
+    }
+
+    while (length > 0)
+    {
+#if HAVE_SYS_SENDFILE_H
+        off_t off = offset;
+
+        sent_len = sendfile(rcc->socket, fd, &off, length);
+#else
+        char buf[16384];
+
+        sent_len = pread(fd, buf, MIN(length, sizeof(buf)), offset);
+        if (sent_len > 0)
+        {
+            int rc = rcf_comm_agent_reply(rcc, buf, sent_len);
+
+            if (rc != 0)
+                return rc;
+        }
+#endif
+        if (sent_len < 0)
+        {
+            ERROR("%s(): sending file to socket %d failed: errno=%d\n",
+                  __FUNCTION__, rcc->socket, errno);
+            return TE_OS_RC(TE_COMM, errno);
+        }
+        if (sent_len == 0)
+            return TE_RC(TE_COMM, TE_ENODATA);
+
+        offset += sent_len;
+        length -= sent_len;
+    }
+
+    return 0;
+}
+
 
 /**
  * Close connection.
@@ -588,6 +681,154 @@ find_attach(char *buf, size_t len)
      return atol(number);
 }
 
+/**
+ * Find the end of a command in received data.
+ *
+ * @param buf           Received data
+ * @param len           Length of the data
+ *
+ * @return Pointer to the terminating character or @c NULL.
+ */
+static char *
+find_term(char *buf, size_t len)
+{
+#ifdef TE_COMM_DEBUG_PROTO
+    size_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        if (buf[i] == 0 || buf[i] == '\n')
+            return buf + i;
+    }
+
+    return NULL;
+#else
+    return memchr(buf, 0, len);
+#endif
+}
+
+/**
+ * Receive as much data as fits into the empty receive buffer of
+ * the connection. Blocks until at least one byte is received.
+ *
+ * @param rcc           Connection handler
+ *
+ * @return Status code.
+ *
+ * @retval 0            Success
+ * @retval other value  errno
+ */
+static int
+fill_rbuf(struct rcf_comm_connection *rcc)
+{
+    ssize_t r;
+
+    assert(rcc->rbuf_start == rcc->rbuf_end);
+
+    while (1)
+    {
+        errno = 0;
+        r = recv(rcc->socket, rcc->rbuf, sizeof(rcc->rbuf), 0);
+        if (r < 0)
+        {
+            if (errno == EINTR) /* Valgrind work-around */
+                continue;
+            ERROR("recv() failed\n");
+            return TE_OS_RC(TE_COMM, errno);
+        }
+        if (r == 0)
+        {
+            ERROR("%s(): recv() returned 0, connection is closed\n",
+                  __FUNCTION__);
+            return TE_RC(TE_COMM, TE_EPIPE);
+        }
+        break;
+    }
+
+    rcc->rbuf_start = 0;
+    rcc->rbuf_end = r;
+
+    return 0;
+}
+
+/**
+ * Read specified number of bytes (not less) from the connection:
+ * the data left in the receive buffer are consumed first, the rest
+ * is read from the socket directly.
+ *
+ * @param rcc           Connection handler
+ * @param buffer        Buffer to store the data
+ * @param len           Number of bytes to read
+ *
+ * @return Status code.
+ *
+ * @retval 0            Success
+ * @retval other value  errno
+ */
+static int
+read_conn(struct rcf_comm_connection *rcc, void *buffer, size_t len)
+{
+    size_t n = rcc->rbuf_end - rcc->rbuf_start;
+
+    if (n > len)
+        n = len;
+
+    memcpy(buffer, rcc->rbuf + rcc->rbuf_start, n);
+    rcc->rbuf_start += n;
+
+    if (n == len)
+        return 0;
+
+    return read_socket(rcc->socket, (uint8_t *)buffer + n, len - n);
+}
+
+/**
+ * Receive a binary message (see te_proto_bin.h). Binary messages are
+ * framed by the length in the header rather than by the terminator.
+ *
+ * @param rcc           Connection handler
+ * @param buffer        Buffer for data
+ * @param pbytes        Size of the buffer on entry, see
+ *                      rcf_comm_agent_wait() for the value on return
+ * @param pba           Location for attachment pointer (set to @c NULL)
+ *
+ * @return Status code (see rcf_comm_agent_wait()).
+ */
+static int
+receive_bin(struct rcf_comm_connection *rcc, char *buffer, size_t *pbytes,
+            void **pba)
+{
+    size_t  len;
+    size_t  to_read;
+    int     ret;
+
+    if (*pbytes < RCF_BIN_HDR_LEN)
+        return TE_RC(TE_COMM, TE_ESMALLBUF);
+
+    if ((ret = read_conn(rcc, buffer, RCF_BIN_HDR_LEN)) != 0)
+        return ret;
+
+    if (pba != NULL)
+        *pba = NULL;
+
+    len = rcf_bin_msg_len(buffer);
+    if (len <= *pbytes)
+    {
+        *pbytes = len;
+        return read_conn(rcc, buffer + RCF_BIN_HDR_LEN,
+                         len - RCF_BIN_HDR_LEN);
+    }
+
+    /* Buffer is too small, the rest is returned by the next calls */
+    to_read = *pbytes - RCF_BIN_HDR_LEN;
+    if ((ret = read_conn(rcc, buffer + RCF_BIN_HDR_LEN, to_read)) != 0)
+        return ret;
+
+    rcc->bytes_to_read = len - *pbytes;
+    *pbytes = len;
+    return TE_RC(TE_COMM, TE_EPENDING);
+}
+
 /**
  * Read specified number of bytes (not less) from the connection.
  *
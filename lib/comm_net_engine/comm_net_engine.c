@@ -40,9 +40,13 @@
 #if HAVE_NETDB_H
 #include <netdb.h>
 #endif
+#if HAVE_POLL_H
+#include <poll.h>
+#endif
 
 #include "te_alloc.h"
 #include "te_errno.h"
+#include "te_proto_bin.h"
 #include "comm_net_engine.h"
 
 
@@ -62,6 +66,9 @@
 
 /*@}*/
 
+/** Size of the receive buffer of a connection */
+#define TE_COMM_NET_ENGINE_RBUF_SIZE        16384
+
 
 /**
  * This structure  stores the information about each connection
@@ -70,11 +77,22 @@
 struct rcf_net_connection{
     int     socket;         /**< Connection socket */
     size_t  bytes_to_read;  /**< Number of bytes of attachment to read */
+    size_t  rbuf_start;     /**< Offset of the first unread byte
+                                 in the receive buffer */
+    size_t  rbuf_end;       /**< Offset of the byte following the last
+                                 received one in the receive buffer */
+    char    rbuf[TE_COMM_NET_ENGINE_RBUF_SIZE]; /**< Receive buffer */
 };
 
 
 /* Static function declaration. See implementation for comments */
 static int find_attach(char *buf, size_t len);
+static char *find_term(char *buf, size_t len);
+static int fill_rbuf(struct rcf_net_connection *rnc);
+static int read_conn(struct rcf_net_connection *rnc, char *buffer,
+                     size_t len);
+static int receive_bin(struct rcf_net_connection *rnc, char *buffer,
+                       size_t *pbytes, char **pba);
 static int read_socket(int socket, char *buffer, size_t len);
 
 
@@ -227,7 +245,9 @@ rcf_net_engine_connect(const char *addr, const char *port,
     }
 #endif /* defined(TCP_NODELAY) || defined(SO_KEEPALIVE) */
 
-    FD_SET(s, p_select_set);
+    /* Descriptors beyond the set capacity are got by rcf_net_engine_fd() */
+    if (p_select_set != NULL && s < FD_SETSIZE)
+        FD_SET(s, p_select_set);
 
     /* Connection established. Let's allocate memory for rnc and fill it*/
     *p_rnc = TE_ALLOC(sizeof(**p_rnc));
@@ -302,23 +322,33 @@ rcf_net_engine_transmit(struct rcf_net_connection *rnc,
 bool
 rcf_net_engine_is_ready(struct rcf_net_connection *rnc)
 {
-    fd_set          rfds;
-    struct timeval  tv;
+    struct pollfd pfd;
 
     if (rnc == NULL)
         return false;
 
-    if (rnc->bytes_to_read > 0)
+    if (rnc->bytes_to_read > 0 || rnc->rbuf_start < rnc->rbuf_end)
         return true;
 
-    FD_ZERO(&rfds);
-    FD_SET(rnc->socket, &rfds);
-    tv.tv_sec = 0;
-    tv.tv_usec = 0;
+    pfd.fd = rnc->socket;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
 
-    select(rnc->socket + 1, &rfds, NULL, NULL, &tv);
+    return poll(&pfd, 1, 0) > 0;
+}
 
-    return FD_ISSET(rnc->socket, &rfds) ? true : false;
+/**
+ * Get the file descriptor of the test agent connection which may be
+ * watched for readability by the caller.
+ *
+ * @param rnc   Handler received from rcf_net_engine_connect.
+ *
+ * @return File descriptor or -1.
+ */
+int
+rcf_net_engine_fd(const struct rcf_net_connection *rnc)
+{
+    return (rnc == NULL) ? -1 : rnc->socket;
 }
 
 /**
@@ -369,6 +399,7 @@ rcf_net_engine_receive(struct rcf_net_connection *rnc, char *buffer,
                        size_t *pbytes, char **pba)
 {
     int     ret;
+    int     attach_size;
     size_t  l = 0;
 
     if (rnc == NULL)
@@ -382,12 +413,12 @@ rcf_net_engine_receive(struct rcf_net_connection *rnc, char *buffer,
             /* Enough space */
             *pbytes = rnc->bytes_to_read;
             rnc->bytes_to_read = 0;
-            return read_socket(rnc->socket, buffer, *pbytes);
+            return read_conn(rnc, buffer, *pbytes);
         }
         else
         {
             /* Buffer is too small for the attachment */
-            if ((ret = read_socket(rnc->socket, buffer, *pbytes)) != 0)
+            if ((ret = read_conn(rnc, buffer, *pbytes)) != 0)
                 return ret; /* Some error occurred */
 
             {
@@ -400,89 +431,105 @@ rcf_net_engine_receive(struct rcf_net_connection *rnc, char *buffer,
         }
     }
 
+    if (rnc->rbuf_start == rnc->rbuf_end)
+    {
+        if ((ret = fill_rbuf(rnc)) != 0)
+            return ret;
+    }
+    if ((uint8_t)rnc->rbuf[rnc->rbuf_start] == RCF_BIN_MAGIC)
+        return receive_bin(rnc, buffer, pbytes, pba);
+
+    /* Copy the message from the receive buffer up to the terminator */
     while (1)
     {
-        int r = recv(rnc->socket, buffer + l, 1, 0);
+        char   *start;
+        char   *term;
+        size_t  n;
 
-        if (r <= 0)
+        if (rnc->rbuf_start == rnc->rbuf_end)
         {
-            return TE_OS_RC(TE_COMM, r == 0 ? EPIPE : errno);
+            if ((ret = fill_rbuf(rnc)) != 0)
+                return ret;
         }
 
-        if (buffer[l] == 0
-#ifdef TE_COMM_DEBUG_PROTO
-            || buffer[l] == '\n'
-#endif
-            )
+        start = rnc->rbuf + rnc->rbuf_start;
+        n = rnc->rbuf_end - rnc->rbuf_start;
+        term = find_term(start, n);
+        if (term != NULL)
+            n = term - start + 1;
+
+        if (n > *pbytes - l)
         {
-            /* The whole message received */
-            int attach_size;
+            /* The terminator (if any) does not fit into the buffer */
+            n = *pbytes - l;
+            term = NULL;
+        }
+
+        memcpy(buffer + l, start, n);
+        rnc->rbuf_start += n;
+        l += n;
+
+        if (term != NULL)
+            break;
 
+        if (l == *pbytes)
+            return TE_RC(TE_COMM, TE_ESMALLBUF);
+    }
+
+    /* The whole message received */
 #ifdef TE_COMM_DEBUG_PROTO
-            if (buffer[l] == '\n')
-            {
-                buffer[l] = 0;           /* Change '\n' to zero... */
+    if (buffer[l - 1] == '\n')
+    {
+        buffer[l - 1] = 0;           /* Change '\n' to zero... */
 
-                if ((l > 0) && (buffer[l - 1] == '\r'))
-                {
-                    /* ... and change '\r' to the space */
-                    buffer[l - 1] = ' ';
-                }
-            }
+        if ((l > 1) && (buffer[l - 2] == '\r'))
+        {
+            /* ... and change '\r' to the space */
+            buffer[l - 2] = ' ';
+        }
+    }
 #endif
 
-            l++;
+    attach_size = find_attach(buffer, l);
 
-            attach_size = find_attach(buffer, l);
+    if (attach_size == -1)
+    {
+        /* No attachment */
+        *pbytes = l;
 
-            if (attach_size == -1)
-            {
-                /* No attachment */
-                *pbytes = l;
+        /* Set pba to NULL because no attachment attached */
+        if (pba != NULL)
+            *pba = NULL;
 
-                /* Set pba to NULL because no attachment attached */
-                if (pba != NULL)
-                    *pba = NULL;
+        return 0;
+    }
 
-                return 0;
-            }
-            else
-            {
-                /* Attachment found. */
-
-                /* Set pba to the first byte of the attachment */
-                if (pba != NULL)
-                    *pba = buffer + l;
-
-                if (*pbytes >= l + attach_size)
-                {
-                    /* Buffer is enough to write attachment */
-                    *pbytes = l + attach_size;
-                    return read_socket(rnc->socket, buffer + l,
-                                       attach_size);
-                }
-                else
-                {
-                    /* Buffer is too small to write attachment */
-                    int to_read = *pbytes - l;
-
-                    ret = read_socket(rnc->socket, buffer + l, to_read);
-                    if (ret != 0)
-                    {
-                        return ret; /* Some error occurred */
-                    }
-
-                    rnc->bytes_to_read = attach_size - to_read;
-                    *pbytes = attach_size + l;
-                    return TE_RC(TE_COMM, TE_EPENDING);
-                }
-            }
-        }
+    /* Attachment found. */
 
-        if (l == (*pbytes - 1))
-            return TE_RC(TE_COMM, TE_ESMALLBUF);
+    /* Set pba to the first byte of the attachment */
+    if (pba != NULL)
+        *pba = buffer + l;
 
-        l += r;
+    if (*pbytes >= l + attach_size)
+    {
+        /* Buffer is enough to write attachment */
+        *pbytes = l + attach_size;
+        return read_conn(rnc, buffer + l, attach_size);
+    }
+    else
+    {
+        /* Buffer is too small to write attachment */
+        int to_read = *pbytes - l;
+
+        ret = read_conn(rnc, buffer + l, to_read);
+        if (ret != 0)
+        {
+            return ret; /* Some error occurred */
+        }
+
+        rnc->bytes_to_read = attach_size - to_read;
+        *pbytes = attach_size + l;
+        return TE_RC(TE_COMM, TE_EPENDING);
     }
 }
 
@@ -511,7 +558,8 @@ rcf_net_engine_close(struct rcf_net_connection **p_rnc,
     if (*p_rnc == NULL)
         return 0;
 
-    FD_CLR((*p_rnc)->socket, p_select_set);
+    if (p_select_set != NULL && (*p_rnc)->socket < FD_SETSIZE)
+        FD_CLR((*p_rnc)->socket, p_select_set);
 
     if (close((*p_rnc)->socket) < 0)
     {
@@ -622,6 +670,139 @@ find_attach(char *buf, size_t len)
     return atol(number);
 }
 
+/**
+ * Find the end of a message in received data.
+ *
+ * @param buf           Received data.
+ * @param len           Length of the data.
+ *
+ * @return
+ *      Pointer to the terminating character or @c NULL.
+ */
+static char *
+find_term(char *buf, size_t len)
+{
+#ifdef TE_COMM_DEBUG_PROTO
+    size_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        if (buf[i] == 0 || buf[i] == '\n')
+            return buf + i;
+    }
+
+    return NULL;
+#else
+    return memchr(buf, 0, len);
+#endif
+}
+
+/**
+ * Receive as much data as fits into the empty receive buffer of
+ * the connection. Blocks until at least one byte is received.
+ *
+ * @param rnc           Connection handler.
+ *
+ * @return
+ *      Status code.
+ *
+ * @retval      0               Success.
+ * @retval      other value     errno.
+ */
+static int
+fill_rbuf(struct rcf_net_connection *rnc)
+{
+    ssize_t r = recv(rnc->socket, rnc->rbuf, sizeof(rnc->rbuf), 0);
+
+    if (r <= 0)
+        return TE_OS_RC(TE_COMM, (r == 0) ? EPIPE : errno);
+
+    rnc->rbuf_start = 0;
+    rnc->rbuf_end = r;
+
+    return 0;
+}
+
+/**
+ * Read specified number of bytes (not less) from the connection:
+ * the data left in the receive buffer are consumed first, the rest
+ * is read from the socket directly.
+ *
+ * @param rnc           Connection handler.
+ * @param buffer        Buffer to store the data.
+ * @param len           Number of bytes to read.
+ *
+ * @return
+ *      Status code.
+ *
+ * @retval      0               Success.
+ * @retval      other value     errno.
+ */
+static int
+read_conn(struct rcf_net_connection *rnc, char *buffer, size_t len)
+{
+    size_t n = rnc->rbuf_end - rnc->rbuf_start;
+
+    if (n > len)
+        n = len;
+
+    memcpy(buffer, rnc->rbuf + rnc->rbuf_start, n);
+    rnc->rbuf_start += n;
+
+    if (n == len)
+        return 0;
+
+    return read_socket(rnc->socket, buffer + n, len - n);
+}
+
+/**
+ * Receive a binary message (see te_proto_bin.h). Binary messages are
+ * framed by the length in the header rather than by the terminator.
+ *
+ * @param rnc           Connection handler.
+ * @param buffer        Buffer for data.
+ * @param pbytes        Size of the buffer on entry, see
+ *                      rcf_net_engine_receive() for the value on return.
+ * @param pba           Location for attachment pointer (set to @c NULL).
+ *
+ * @return
+ *      Status code (see rcf_net_engine_receive()).
+ */
+static int
+receive_bin(struct rcf_net_connection *rnc, char *buffer, size_t *pbytes,
+            char **pba)
+{
+    size_t  len;
+    size_t  to_read;
+    int     ret;
+
+    if (*pbytes < RCF_BIN_HDR_LEN)
+        return TE_RC(TE_COMM, TE_ESMALLBUF);
+
+    if ((ret = read_conn(rnc, buffer, RCF_BIN_HDR_LEN)) != 0)
+        return ret;
+
+    if (pba != NULL)
+        *pba = NULL;
+
+    len = rcf_bin_msg_len(buffer);
+    if (len <= *pbytes)
+    {
+        *pbytes = len;
+        return read_conn(rnc, buffer + RCF_BIN_HDR_LEN,
+                         len - RCF_BIN_HDR_LEN);
+    }
+
+    /* Buffer is too small, the rest is returned by the next calls */
+    to_read = *pbytes - RCF_BIN_HDR_LEN;
+    if ((ret = read_conn(rnc, buffer + RCF_BIN_HDR_LEN, to_read)) != 0)
+        return ret;
+
+    rnc->bytes_to_read = len - *pbytes;
+    *pbytes = len;
+    return TE_RC(TE_COMM, TE_EPENDING);
+}
+
 /**
  * Read specified number of bytes (not less) from the connection
  *
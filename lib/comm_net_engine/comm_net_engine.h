@@ -72,6 +72,16 @@ extern int rcf_net_engine_transmit(struct rcf_net_connection *rnc,
  */
 extern bool rcf_net_engine_is_ready(struct rcf_net_connection *rnc);
 
+/**
+ * Get the file descriptor of the test agent connection which may be
+ * watched for readability by the caller.
+ *
+ * @param rnc       - Handler received from rcf_net_engine_connect.
+ *
+ * @return File descriptor or -1.
+ */
+extern int rcf_net_engine_fd(const struct rcf_net_connection *rnc);
+
 
 /**
  * Receive data from the Test Agent via Network Communication library.
@@ -38,12 +38,18 @@
 #ifdef HAVE_ASSERT_H
 #include <assert.h>
 #endif
+#include <fcntl.h>
+#include <search.h>
+#include <sys/mman.h>
 
 #include "te_alloc.h"
 #include "te_stdint.h"
 #include "te_errno.h"
 #include "te_defs.h"
 #include "te_str.h"
+#include "te_string.h"
+#include "te_dbuf.h"
+#include "te_vector.h"
 #include "logger_api.h"
 #include "te_log_stack.h"
 #include "conf_api.h"
@@ -130,6 +136,279 @@ static te_errno cfg_get_family_member(cfg_handle handle,
 static te_errno kill_all(cfg_handle handle, bool local);
 static te_errno kill(cfg_handle handle, bool local);
 
+/*
+ * Cache of read requests results.
+ *
+ * The Configurator increments the database generation shared via
+ * a mapped file on every change of the database. Cached results are
+ * dropped as soon as the generation differs from the one they were
+ * obtained at, so a cache hit costs a memory load instead of an IPC
+ * round trip. All the cache state is protected by cfgl_lock.
+ */
+
+/** Environment variable to enable the cache */
+#define CFG_API_CACHE_ENV   "TE_CONF_API_CACHE"
+
+/** Cached results of read requests about an object or an instance */
+typedef struct cfgl_cache_entry {
+    cfg_handle      handle;         /**< Object or instance handle */
+    char           *oid;            /**< OID or @c NULL if not cached */
+    bool            descr_valid;    /**< Whether @a descr is cached */
+    cfg_obj_descr   descr;          /**< Object description */
+    bool            family_valid[CFG_SON + 1]; /**< Whether family
+                                                    member is cached */
+    cfg_handle      family[CFG_SON + 1]; /**< Father, brother and son */
+    bool            val_valid;      /**< Whether the value is cached */
+    cfg_val_type    val_type;       /**< Type of the cached value */
+    cfg_inst_val    val;            /**< Cached value */
+} cfgl_cache_entry;
+
+/** Cached handle found by OID */
+typedef struct cfgl_cache_oid {
+    char       *oid;        /**< Object or instance identifier */
+    cfg_handle  handle;     /**< Handle of the object or instance */
+} cfgl_cache_oid;
+
+/** Whether the cache is enabled: -1 means it is not decided yet */
+static int cfgl_cache_enabled = -1;
+/** Database generation shared by the Configurator */
+static cfg_db_gen_shared *cfgl_cache_shared = NULL;
+/** Database generation the cached results are valid for */
+static uint64_t cfgl_cache_gen = CFG_DB_GEN_INVALID;
+/** Cache entries by handle */
+static void *cfgl_cache_by_handle = NULL;
+/** Cached handles by OID */
+static void *cfgl_cache_by_oid = NULL;
+
+/* Comparison function for the tree of entries by handle */
+static int
+cfgl_cache_handle_cmp(const void *a, const void *b)
+{
+    cfg_handle ha = ((const cfgl_cache_entry *)a)->handle;
+    cfg_handle hb = ((const cfgl_cache_entry *)b)->handle;
+
+    return ha < hb ? -1 : ha > hb;
+}
+
+/* Comparison function for the tree of handles by OID */
+static int
+cfgl_cache_oid_cmp(const void *a, const void *b)
+{
+    return strcmp(((const cfgl_cache_oid *)a)->oid,
+                  ((const cfgl_cache_oid *)b)->oid);
+}
+
+/* Free function for the tree of entries by handle */
+static void
+cfgl_cache_entry_free(void *p)
+{
+    cfgl_cache_entry *entry = p;
+
+    if (entry->val_valid)
+        cfg_types[entry->val_type].free(entry->val);
+    free(entry->oid);
+    free(entry);
+}
+
+/* Free function for the tree of handles by OID */
+static void
+cfgl_cache_oid_free(void *p)
+{
+    cfgl_cache_oid *entry = p;
+
+    free(entry->oid);
+    free(entry);
+}
+
+/** Drop all cached results. */
+static void
+cfgl_cache_flush(void)
+{
+    tdestroy(cfgl_cache_by_handle, cfgl_cache_entry_free);
+    cfgl_cache_by_handle = NULL;
+    tdestroy(cfgl_cache_by_oid, cfgl_cache_oid_free);
+    cfgl_cache_by_oid = NULL;
+    cfgl_cache_gen = CFG_DB_GEN_INVALID;
+}
+
+/** Drop all cached results and unmap the database generation. */
+static void
+cfgl_cache_release(void)
+{
+    cfgl_cache_flush();
+    if (cfgl_cache_shared != NULL)
+    {
+        munmap(cfgl_cache_shared, sizeof(*cfgl_cache_shared));
+        cfgl_cache_shared = NULL;
+    }
+}
+
+/**
+ * Map the database generation published by the Configurator.
+ *
+ * @return @c true if the generation is mapped.
+ */
+static bool
+cfgl_cache_map(void)
+{
+    const char *tmp_dir = getenv("TE_TMP");
+    char       *path;
+    void       *shared;
+    int         fd;
+
+    if (tmp_dir == NULL)
+        return false;
+
+    path = te_string_fmt(CFG_DB_GEN_FILE_FMT, tmp_dir, CONFIGURATOR_SERVER);
+    fd = open(path, O_RDONLY);
+    free(path);
+    if (fd < 0)
+        return false;
+
+    shared = mmap(NULL, sizeof(*cfgl_cache_shared), PROT_READ, MAP_SHARED,
+                  fd, 0);
+    close(fd);
+    if (shared == MAP_FAILED)
+        return false;
+
+    cfgl_cache_shared = shared;
+    return true;
+}
+
+/**
+ * Check whether the cache may be used and drop the cached results
+ * if the database is changed since they were obtained.
+ * Must be called before the request is sent to the Configurator, so
+ * that results of the request are never newer than the generation.
+ *
+ * @return @c true if the cache may be used.
+ */
+static bool
+cfgl_cache_check(void)
+{
+    uint64_t gen;
+
+    if (cfgl_cache_enabled < 0)
+    {
+        const char *env = getenv(CFG_API_CACHE_ENV);
+
+        cfgl_cache_enabled = (env != NULL && strcmp(env, "0") != 0);
+    }
+
+    if (!cfgl_cache_enabled)
+        return false;
+
+    if (cfgl_cache_shared == NULL && !cfgl_cache_map())
+        return false;
+
+    gen = __atomic_load_n(&cfgl_cache_shared->gen, __ATOMIC_ACQUIRE);
+    if (gen == CFG_DB_GEN_INVALID)
+    {
+        /* The Configurator is gone, it may be restarted later */
+        cfgl_cache_release();
+        return false;
+    }
+
+    if (gen != cfgl_cache_gen)
+    {
+        cfgl_cache_flush();
+        cfgl_cache_gen = gen;
+    }
+
+    return true;
+}
+
+/**
+ * Find cached results for a handle.
+ *
+ * @param handle    object or instance handle
+ * @param create    create an empty entry if it does not exist
+ *
+ * @return Cache entry or @c NULL.
+ */
+static cfgl_cache_entry *
+cfgl_cache_get(cfg_handle handle, bool create)
+{
+    cfgl_cache_entry   key = { .handle = handle };
+    cfgl_cache_entry  *entry;
+    void              *node;
+
+    node = tfind(&key, &cfgl_cache_by_handle, cfgl_cache_handle_cmp);
+    if (node != NULL)
+        return *(cfgl_cache_entry **)node;
+
+    if (!create)
+        return NULL;
+
+    entry = TE_ALLOC(sizeof(*entry));
+    entry->handle = handle;
+    if (tsearch(entry, &cfgl_cache_by_handle, cfgl_cache_handle_cmp) == NULL)
+    {
+        free(entry);
+        return NULL;
+    }
+
+    return entry;
+}
+
+/**
+ * Find a cached handle of an OID.
+ *
+ * @param oid       object or instance identifier
+ * @param handle    location for the handle
+ *
+ * @return @c true if the handle is cached.
+ */
+static bool
+cfgl_cache_find(const char *oid, cfg_handle *handle)
+{
+    cfgl_cache_oid  key = { .oid = (char *)oid };
+    void           *node;
+
+    node = tfind(&key, &cfgl_cache_by_oid, cfgl_cache_oid_cmp);
+    if (node == NULL)
+        return false;
+
+    *handle = (*(cfgl_cache_oid **)node)->handle;
+    return true;
+}
+
+/**
+ * Put a handle of an OID to the cache.
+ *
+ * @param oid       object or instance identifier
+ * @param handle    handle of the object or instance
+ */
+static void
+cfgl_cache_put_find(const char *oid, cfg_handle handle)
+{
+    cfgl_cache_oid *entry = TE_ALLOC(sizeof(*entry));
+    void           *node;
+
+    entry->oid = TE_STRDUP(oid);
+    entry->handle = handle;
+
+    /* The existing node is returned if the OID is already cached */
+    node = tsearch(entry, &cfgl_cache_by_oid, cfgl_cache_oid_cmp);
+    if (node == NULL || *(cfgl_cache_oid **)node != entry)
+        cfgl_cache_oid_free(entry);
+}
+
+/* See description in conf_api.h */
+void
+cfg_api_cache_enable(bool enable)
+{
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_lock(&cfgl_lock);
+#endif
+    cfgl_cache_enabled = enable;
+    if (!enable)
+        cfgl_cache_release();
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_unlock(&cfgl_lock);
+#endif
+}
+
 
 /* See description in conf_api.h */
 te_errno
@@ -247,9 +526,11 @@ te_errno
 cfg_get_object_descr(cfg_handle handle, cfg_obj_descr *descr)
 {
     cfg_get_descr_msg *msg;
+    cfgl_cache_entry  *entry;
 
     size_t  len;
     int     ret_val = 0;
+    bool    use_cache;
 
     cfg_oid    *oid;
     cfg_handle  object;
@@ -291,6 +572,17 @@ cfg_get_object_descr(cfg_handle handle, cfg_obj_descr *descr)
         return TE_RC(TE_CONF_API, TE_EIPC);
     }
 
+    use_cache = cfgl_cache_check();
+    if (use_cache && (entry = cfgl_cache_get(handle, false)) != NULL &&
+        entry->descr_valid)
+    {
+        *descr = entry->descr;
+#ifdef HAVE_PTHREAD_H
+        pthread_mutex_unlock(&cfgl_lock);
+#endif
+        return 0;
+    }
+
     memset(cfgl_msg_buf, 0, sizeof(cfgl_msg_buf));
     msg = (cfg_get_descr_msg *)cfgl_msg_buf;
 
@@ -306,6 +598,12 @@ cfg_get_object_descr(cfg_handle handle, cfg_obj_descr *descr)
     {
         memcpy((void *)descr, (void *)(&(msg->descr)),
                sizeof(cfg_obj_descr));
+
+        if (use_cache && (entry = cfgl_cache_get(handle, true)) != NULL)
+        {
+            entry->descr = msg->descr;
+            entry->descr_valid = true;
+        }
     }
 #ifdef HAVE_PTHREAD_H
     pthread_mutex_unlock(&cfgl_lock);
@@ -317,10 +615,12 @@ cfg_get_object_descr(cfg_handle handle, cfg_obj_descr *descr)
 te_errno
 cfg_get_oid_str(cfg_handle handle, char **oid)
 {
-    cfg_get_oid_msg *msg;
+    cfg_get_oid_msg  *msg;
+    cfgl_cache_entry *entry;
 
     size_t  len;
     int     ret_val = 0;
+    bool    use_cache;
 
     char *str;
 
@@ -343,6 +643,17 @@ cfg_get_oid_str(cfg_handle handle, char **oid)
         return TE_RC(TE_CONF_API, TE_EIPC);
     }
 
+    use_cache = cfgl_cache_check();
+    if (use_cache && (entry = cfgl_cache_get(handle, false)) != NULL &&
+        entry->oid != NULL)
+    {
+        *oid = TE_STRDUP(entry->oid);
+#ifdef HAVE_PTHREAD_H
+        pthread_mutex_unlock(&cfgl_lock);
+#endif
+        return 0;
+    }
+
     memset(cfgl_msg_buf, 0, sizeof(cfgl_msg_buf));
     msg = (cfg_get_oid_msg *)cfgl_msg_buf;
 
@@ -360,6 +671,9 @@ cfg_get_oid_str(cfg_handle handle, char **oid)
         str = TE_ALLOC(len);
         memcpy((void *)str, (void *)(msg->oid), len);
         *oid = str;
+
+        if (use_cache && (entry = cfgl_cache_get(handle, true)) != NULL)
+            entry->oid = TE_STRDUP(str);
     }
 
 #ifdef HAVE_PTHREAD_H
@@ -565,6 +879,8 @@ cfg_find_str(const char *oid, cfg_handle *handle)
 
     size_t      len;
     te_errno    ret_val = 0;
+    bool        use_cache;
+    cfg_handle  found;
 
     if (oid == NULL)
     {
@@ -583,6 +899,18 @@ cfg_find_str(const char *oid, cfg_handle *handle)
         return TE_RC(TE_CONF_API, TE_EIPC);
     }
 
+    use_cache = cfgl_cache_check();
+    if (use_cache && cfgl_cache_find(oid, &found))
+    {
+#ifdef HAVE_PTHREAD_H
+        pthread_mutex_unlock(&cfgl_lock);
+#endif
+        if (handle != NULL)
+            *handle = found;
+        te_log_stack_push("Operating on oid=%s", oid);
+        return 0;
+    }
+
     memset(cfgl_msg_buf, 0, sizeof(cfgl_msg_buf));
     msg = (cfg_find_msg *)cfgl_msg_buf;
     len = strlen(oid) + 1;
@@ -596,9 +924,12 @@ cfg_find_str(const char *oid, cfg_handle *handle)
     ret_val = ipc_send_message_with_answer(cfgl_ipc_client,
                                            CONFIGURATOR_SERVER,
                                            msg, msg->len, msg, &len);
-    if ((ret_val == 0) && ((ret_val = msg->rc) == 0) && (handle != NULL))
+    if ((ret_val == 0) && ((ret_val = msg->rc) == 0))
     {
-        *handle = msg->handle;
+        if (handle != NULL)
+            *handle = msg->handle;
+        if (use_cache)
+            cfgl_cache_put_find(oid, msg->handle);
     }
 #ifdef HAVE_PTHREAD_H
     pthread_mutex_unlock(&cfgl_lock);
@@ -852,10 +1183,12 @@ cfg_find_pattern_iter_fmt(cfg_handle_cb_func cb_func, void *opaque,
 static te_errno
 cfg_get_family_member(cfg_handle handle, uint8_t who, cfg_handle *member)
 {
-    cfg_family_msg *msg;
+    cfg_family_msg   *msg;
+    cfgl_cache_entry *entry;
 
     size_t  len;
     int     ret_val = 0;
+    bool    use_cache;
 
     if (handle == CFG_HANDLE_INVALID)
     {
@@ -873,6 +1206,17 @@ cfg_get_family_member(cfg_handle handle, uint8_t who, cfg_handle *member)
         return TE_EIPC;
     }
 
+    use_cache = cfgl_cache_check() && who <= CFG_SON;
+    if (use_cache && (entry = cfgl_cache_get(handle, false)) != NULL &&
+        entry->family_valid[who])
+    {
+        *member = entry->family[who];
+#ifdef HAVE_PTHREAD_H
+        pthread_mutex_unlock(&cfgl_lock);
+#endif
+        return 0;
+    }
+
     memset(cfgl_msg_buf, 0, sizeof(cfgl_msg_buf));
     msg = (cfg_family_msg *)cfgl_msg_buf;
 
@@ -888,6 +1232,12 @@ cfg_get_family_member(cfg_handle handle, uint8_t who, cfg_handle *member)
     if ((ret_val == 0) && ((ret_val = msg->rc) == 0))
     {
         *member = msg->handle;
+
+        if (use_cache && (entry = cfgl_cache_get(handle, true)) != NULL)
+        {
+            entry->family[who] = msg->handle;
+            entry->family_valid[who] = true;
+        }
     }
 #ifdef HAVE_PTHREAD_H
     pthread_mutex_unlock(&cfgl_lock);
@@ -1591,6 +1941,9 @@ cfg_commit(const char *oid)
     msg = (cfg_commit_msg *)cfgl_msg_buf;
     msg->type = CFG_COMMIT;
 
+    /* Empty OID requests commit of the whole database */
+    if (oid == NULL)
+        oid = "";
     len = strlen(oid) + 1;
     memcpy(msg->oid, oid, len);
     msg->len = sizeof(cfg_commit_msg) + len;
@@ -1632,11 +1985,14 @@ cfg_commit_fmt(const char *oid_fmt, ...)
 te_errno
 cfg_get_instance(cfg_handle handle, cfg_val_type *type, ...)
 {
-    cfg_get_msg    *msg;
-    va_list         list;
-    cfg_inst_val    value;
-    size_t          len;
-    te_errno        rc = 0;
+    cfg_get_msg      *msg;
+    cfgl_cache_entry *entry;
+    va_list           list;
+    cfg_inst_val      value;
+    cfg_val_type      val_type = CVT_UNSPECIFIED;
+    size_t            len;
+    te_errno          rc = 0;
+    bool              use_cache;
 
     if (handle == CFG_HANDLE_INVALID)
     {
@@ -1655,20 +2011,42 @@ cfg_get_instance(cfg_handle handle, cfg_val_type *type, ...)
         return TE_RC(TE_CONF_API, TE_EIPC);
     }
 
-    memset(cfgl_msg_buf, 0, sizeof(cfgl_msg_buf));
-    msg = (cfg_get_msg *)cfgl_msg_buf;
-    rc = cfg_ipc_mk_get(msg, CFG_MSG_MAX, handle, false);
-    if (rc != 0)
-        return rc;
+    use_cache = cfgl_cache_check();
+    if (use_cache && (entry = cfgl_cache_get(handle, false)) != NULL &&
+        entry->val_valid)
+    {
+        val_type = entry->val_type;
+        rc = cfg_types[val_type].copy(entry->val, &value);
+    }
+    else
+    {
+        memset(cfgl_msg_buf, 0, sizeof(cfgl_msg_buf));
+        msg = (cfg_get_msg *)cfgl_msg_buf;
+        rc = cfg_ipc_mk_get(msg, CFG_MSG_MAX, handle, false);
+        if (rc != 0)
+            return rc;
 
-    len = CFG_MSG_MAX;
+        len = CFG_MSG_MAX;
 
-    rc = ipc_send_message_with_answer(cfgl_ipc_client,
-                                      CONFIGURATOR_SERVER,
-                                      msg, msg->len, msg, &len);
-    if ((rc != 0) || ((rc = msg->rc) != 0) ||
-        ((rc = cfg_types[msg->val_type].get_from_msg((cfg_msg *)msg,
-                                                     &value)) != 0))
+        rc = ipc_send_message_with_answer(cfgl_ipc_client,
+                                          CONFIGURATOR_SERVER,
+                                          msg, msg->len, msg, &len);
+        if (rc == 0 && (rc = msg->rc) == 0)
+        {
+            val_type = msg->val_type;
+            rc = cfg_types[val_type].get_from_msg((cfg_msg *)msg, &value);
+        }
+
+        if (rc == 0 && use_cache && msg->cacheable &&
+            (entry = cfgl_cache_get(handle, true)) != NULL &&
+            cfg_types[val_type].copy(value, &entry->val) == 0)
+        {
+            entry->val_type = val_type;
+            entry->val_valid = true;
+        }
+    }
+
+    if (rc != 0)
     {
 #ifdef HAVE_PTHREAD_H
         pthread_mutex_unlock(&cfgl_lock);
@@ -1676,7 +2054,7 @@ cfg_get_instance(cfg_handle handle, cfg_val_type *type, ...)
         return TE_RC(TE_CONF_API, rc);
     }
 
-    if (type != NULL && *type != CVT_UNSPECIFIED && *type != msg->val_type)
+    if (type != NULL && *type != CVT_UNSPECIFIED && *type != val_type)
     {
 #ifdef HAVE_PTHREAD_H
         pthread_mutex_unlock(&cfgl_lock);
@@ -1696,7 +2074,7 @@ cfg_get_instance(cfg_handle handle, cfg_val_type *type, ...)
             break;                                                         \
         }
 
-    switch (msg->val_type)
+    switch (val_type)
     {
         CASE_INTEGER_TYPE(bool, CVT_BOOL, bool);
         CASE_INTEGER_TYPE(int8, CVT_INT8, int8_t);
@@ -1741,7 +2119,7 @@ cfg_get_instance(cfg_handle handle, cfg_val_type *type, ...)
         default:
         {
             ERROR("Get Configurator instance of unknown type %u",
-                  msg->val_type);
+                  val_type);
             rc = TE_RC(TE_CONF_API, TE_EINVAL);
             break;
         }
@@ -1751,7 +2129,7 @@ cfg_get_instance(cfg_handle handle, cfg_val_type *type, ...)
 
     if ((type != NULL) && (*type == CVT_UNSPECIFIED))
     {
-        *type = msg->val_type;
+        *type = val_type;
     }
 
 #ifdef HAVE_PTHREAD_H
@@ -2056,17 +2434,95 @@ cfg_get_addr_sync(struct sockaddr **val, const char *oid_fmt, ...)
     return cfg_get_instance_sync(handle, &type, val);
 }
 
+/**
+ * Send a request to the Configurator and receive an answer of any
+ * length. The function should be called with cfgl_lock locked if
+ * @p ipcc is the shared IPC client.
+ *
+ * @param ipcc      IPC client
+ * @param msg       request
+ * @param answer    location for the answer, it should be released
+ *                  by the caller
+ *
+ * @return Status code.
+ */
+static te_errno
+cfgl_send_with_long_answer(struct ipc_client *ipcc, const cfg_msg *msg,
+                           cfg_msg **answer)
+{
+    char     *buf = TE_ALLOC(CFG_MSG_MAX);
+    size_t    len = CFG_MSG_MAX;
+    te_errno  rc;
+
+    rc = ipc_send_message_with_answer(ipcc, CONFIGURATOR_SERVER,
+                                      msg, msg->len, buf, &len);
+    if (TE_RC_GET_ERROR(rc) == TE_ESMALLBUF)
+    {
+        size_t rest_len = len - CFG_MSG_MAX;
+
+        assert(len > CFG_MSG_MAX);
+        TE_REALLOC(buf, len);
+        rc = ipc_receive_rest_answer(ipcc, CONFIGURATOR_SERVER,
+                                     buf + CFG_MSG_MAX, &rest_len);
+    }
+    if (rc != 0)
+    {
+        free(buf);
+        return rc;
+    }
+
+    *answer = (cfg_msg *)buf;
+    return 0;
+}
+
+/**
+ * Append a sub-message to CFG_BATCH message.
+ *
+ * @param batch     buffer with the batch
+ * @param sub       sub-message
+ */
+static void
+cfgl_batch_append(te_dbuf *batch, const cfg_msg *sub)
+{
+    te_dbuf_append(batch, sub, sub->len);
+    te_dbuf_append(batch, NULL, TE_ALIGN(sub->len, CFG_BATCH_ALIGN) -
+                                sub->len);
+    ((cfg_batch_msg *)batch->ptr)->num++;
+}
+
+/**
+ * Check that the next sub-message of CFG_BATCH answer is inside it.
+ *
+ * @param ans       answer
+ * @param sub       sub-message
+ *
+ * @return @c true if the sub-message is inside the answer.
+ */
+static bool
+cfgl_batch_sub_valid(const cfg_batch_msg *ans, const cfg_msg *sub)
+{
+    const uint8_t *end = (const uint8_t *)ans + ans->len;
+
+    return (const uint8_t *)sub + sizeof(*sub) <= end &&
+           (const uint8_t *)sub + sub->len <= end;
+}
+
 /* See description in conf_api.h */
 te_errno
-cfg_synchronize(const char *oid, bool subtree)
+cfg_batch_process(cfg_batch_req *reqs, unsigned int num, bool atomic)
 {
-    cfg_sync_msg *msg;
-
-    size_t  len;
-    int     ret_val = 0;
+    te_dbuf         batch = TE_DBUF_INIT(TE_DBUF_DEFAULT_GROW_FACTOR);
+    cfg_batch_msg   header;
+    cfg_batch_msg  *ans = NULL;
+    cfg_msg        *sub;
+    cfg_get_msg    *get;
+    unsigned int    i;
+    te_errno        rc = 0;
 
-    if (oid == NULL)
-        return TE_EINVAL;
+    if (num == 0)
+        return 0;
+    if (reqs == NULL)
+        return TE_RC(TE_CONF_API, TE_EINVAL);
 
 #ifdef HAVE_PTHREAD_H
     pthread_mutex_lock(&cfgl_lock);
@@ -2077,48 +2533,1005 @@ cfg_synchronize(const char *oid, bool subtree)
 #ifdef HAVE_PTHREAD_H
         pthread_mutex_unlock(&cfgl_lock);
 #endif
-        return TE_EIPC;
+        return TE_RC(TE_CONF_API, TE_EIPC);
     }
 
-    memset(cfgl_msg_buf, 0, sizeof(cfgl_msg_buf));
-    msg = (cfg_sync_msg *)cfgl_msg_buf;
-    msg->type = CFG_SYNC;
-    msg->subtree = subtree;
+    memset(&header, 0, sizeof(header));
+    header.type = CFG_BATCH;
+    header.atomic = atomic;
+    te_dbuf_append(&batch, &header, sizeof(header));
+    te_dbuf_append(&batch, NULL, TE_ALIGN(sizeof(header), CFG_BATCH_ALIGN) -
+                                 sizeof(header));
+
+    /*
+     * Every request is a pair of find and get/set: the latter refers
+     * to the handle found by the former.
+     */
+    sub = (cfg_msg *)cfgl_msg_buf;
+    for (i = 0; i < num && rc == 0; i++)
+    {
+        rc = cfg_ipc_mk_find_str((cfg_find_msg *)sub, CFG_MSG_MAX,
+                                 reqs[i].oid);
+        if (rc != 0)
+            break;
+        cfgl_batch_append(&batch, sub);
 
-    len = strlen(oid) + 1;
-    memcpy(msg->oid, oid, len);
-    msg->len = sizeof(cfg_sync_msg) + len;
-    len = CFG_MSG_MAX;
+        switch (reqs[i].op)
+        {
+            case CFG_BATCH_OP_GET:
+                rc = cfg_ipc_mk_get((cfg_get_msg *)sub, CFG_MSG_MAX,
+                                    CFG_HANDLE_INVALID, false);
+                break;
+
+            case CFG_BATCH_OP_SET:
+            case CFG_BATCH_OP_SET_LOCAL:
+                rc = cfg_ipc_mk_set((cfg_set_msg *)sub, CFG_MSG_MAX,
+                                    CFG_HANDLE_INVALID,
+                                    reqs[i].op == CFG_BATCH_OP_SET_LOCAL,
+                                    reqs[i].type, reqs[i].val);
+                break;
+
+            default:
+                ERROR("%s(): unknown operation %d", __FUNCTION__,
+                      reqs[i].op);
+                rc = TE_RC(TE_CONF_API, TE_EINVAL);
+                break;
+        }
+        if (rc == 0)
+            cfgl_batch_append(&batch, sub);
+    }
 
-    ret_val = ipc_send_message_with_answer(cfgl_ipc_client,
-                                           CONFIGURATOR_SERVER,
-                                           msg, msg->len, msg, &len);
-    if (ret_val == 0)
+    if (rc == 0)
     {
-        ret_val = msg->rc;
+        ((cfg_batch_msg *)batch.ptr)->len = batch.len;
+        rc = cfgl_send_with_long_answer(cfgl_ipc_client,
+                                        (cfg_msg *)batch.ptr,
+                                        (cfg_msg **)&ans);
     }
-
 #ifdef HAVE_PTHREAD_H
     pthread_mutex_unlock(&cfgl_lock);
 #endif
-    return TE_RC(TE_CONF_API, ret_val);
+    te_dbuf_free(&batch);
+    if (rc != 0)
+        return TE_RC(TE_CONF_API, rc);
+
+    if (ans->num != num * 2)
+    {
+        rc = (ans->rc != 0) ? ans->rc : TE_EPROTO;
+        free(ans);
+        return TE_RC(TE_CONF_API, rc);
+    }
+
+    for (i = 0, sub = CFG_BATCH_FIRST(ans); i < num; i++)
+    {
+        /* Skip the answer to find */
+        if (!cfgl_batch_sub_valid(ans, sub) ||
+            !cfgl_batch_sub_valid(ans, (sub = CFG_BATCH_NEXT(sub))))
+        {
+            ERROR("%s(): malformed answer", __FUNCTION__);
+            rc = TE_RC(TE_CONF_API, TE_EPROTO);
+            break;
+        }
+
+        reqs[i].rc = TE_RC(TE_CONF_API, sub->rc);
+        if (reqs[i].rc == 0 && reqs[i].op == CFG_BATCH_OP_GET)
+        {
+            get = (cfg_get_msg *)sub;
+            if (reqs[i].type != CVT_UNSPECIFIED &&
+                reqs[i].type != get->val_type)
+            {
+                reqs[i].rc = TE_RC(TE_CONF_API, TE_EBADTYPE);
+            }
+            else
+            {
+                reqs[i].type = get->val_type;
+                reqs[i].rc = cfg_types[get->val_type].get_from_msg(
+                                 sub, &reqs[i].val);
+            }
+        }
+
+        if (rc == 0)
+            rc = reqs[i].rc;
+        sub = CFG_BATCH_NEXT(sub);
+    }
+
+    free(ans);
+    return rc;
 }
 
 /* See description in conf_api.h */
 te_errno
-cfg_synchronize_fmt(bool subtree, const char *oid_fmt, ...)
+cfg_get_subtree_fmt(cfg_subtree_inst **insts, unsigned int *num,
+                    const char *oid_fmt, ...)
 {
-    va_list ap;
-    char    oid[CFG_OID_MAX];
+    cfg_get_subtree_msg *msg;
+    cfg_batch_msg       *ans = NULL;
+    cfg_subtree_inst    *result;
+    cfg_msg             *sub;
+    cfg_get_oid_msg     *oid_msg;
+    unsigned int         n = 0;
+    unsigned int         i;
+    char                 oid[CFG_OID_MAX];
+    va_list              ap;
+    te_errno             rc;
 
     va_start(ap, oid_fmt);
-    vsnprintf(oid, sizeof(oid), oid_fmt, ap);
+    rc = te_vsnprintf(oid, sizeof(oid), oid_fmt, ap);
     va_end(ap);
+    if (rc != 0)
+        return TE_RC(TE_CONF_API, TE_RC_GET_ERROR(rc));
 
-    return cfg_synchronize(oid, subtree);
-}
-
-/* See description in conf_api.h */
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_lock(&cfgl_lock);
+#endif
+    INIT_IPC;
+    if (cfgl_ipc_client == NULL)
+    {
+#ifdef HAVE_PTHREAD_H
+        pthread_mutex_unlock(&cfgl_lock);
+#endif
+        return TE_RC(TE_CONF_API, TE_EIPC);
+    }
+
+    memset(cfgl_msg_buf, 0, sizeof(cfgl_msg_buf));
+    msg = (cfg_get_subtree_msg *)cfgl_msg_buf;
+    msg->type = CFG_GET_SUBTREE;
+    msg->len = sizeof(*msg) + strlen(oid) + 1;
+    strcpy(msg->oid, oid);
+
+    rc = cfgl_send_with_long_answer(cfgl_ipc_client, (cfg_msg *)msg,
+                                    (cfg_msg **)&ans);
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_unlock(&cfgl_lock);
+#endif
+    if (rc != 0)
+        return TE_RC(TE_CONF_API, rc);
+    if ((rc = ans->rc) != 0)
+    {
+        free(ans);
+        return TE_RC(TE_CONF_API, rc);
+    }
+
+    result = TE_ALLOC(ans->num / 2 * sizeof(*result));
+    for (i = 0, sub = CFG_BATCH_FIRST(ans); i < ans->num / 2; i++)
+    {
+        oid_msg = (cfg_get_oid_msg *)sub;
+        if (!cfgl_batch_sub_valid(ans, sub) ||
+            !cfgl_batch_sub_valid(ans, (sub = CFG_BATCH_NEXT(sub))))
+        {
+            ERROR("%s(): malformed answer", __FUNCTION__);
+            rc = TE_EPROTO;
+            break;
+        }
+
+        if ((rc = oid_msg->rc) != 0 || (rc = sub->rc) != 0)
+            break;
+
+        result[n].handle = oid_msg->handle;
+        result[n].type = ((cfg_get_msg *)sub)->val_type;
+        rc = cfg_types[result[n].type].get_from_msg(sub, &result[n].val);
+        if (rc != 0)
+            break;
+        result[n].oid = TE_STRDUP(oid_msg->oid);
+        n++;
+
+        sub = CFG_BATCH_NEXT(sub);
+    }
+    free(ans);
+
+    if (rc != 0)
+    {
+        cfg_subtree_free(result, n);
+        return TE_RC(TE_CONF_API, rc);
+    }
+
+    *insts = result;
+    *num = n;
+    return 0;
+}
+
+/* See description in conf_api.h */
+void
+cfg_subtree_free(cfg_subtree_inst *insts, unsigned int num)
+{
+    unsigned int i;
+
+    if (insts == NULL)
+        return;
+
+    for (i = 0; i < num; i++)
+    {
+        cfg_types[insts[i].type].free(insts[i].val);
+        free(insts[i].oid);
+    }
+    free(insts);
+}
+
+/* See description in conf_api.h */
+te_errno
+cfg_subscribe_fmt(unsigned int *id, unsigned int sync_ms,
+                  const char *pattern_fmt, ...)
+{
+    cfg_subscribe_msg *msg;
+    char               pattern[CFG_OID_MAX];
+    size_t             len;
+    va_list            ap;
+    te_errno           rc;
+
+    if (id == NULL || pattern_fmt == NULL)
+        return TE_RC(TE_CONF_API, TE_EINVAL);
+
+    va_start(ap, pattern_fmt);
+    rc = te_vsnprintf(pattern, sizeof(pattern), pattern_fmt, ap);
+    va_end(ap);
+    if (rc != 0)
+        return TE_RC(TE_CONF_API, TE_RC_GET_ERROR(rc));
+
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_lock(&cfgl_lock);
+#endif
+    INIT_IPC;
+    if (cfgl_ipc_client == NULL)
+    {
+#ifdef HAVE_PTHREAD_H
+        pthread_mutex_unlock(&cfgl_lock);
+#endif
+        return TE_RC(TE_CONF_API, TE_EIPC);
+    }
+
+    memset(cfgl_msg_buf, 0, sizeof(cfgl_msg_buf));
+    msg = (cfg_subscribe_msg *)cfgl_msg_buf;
+    msg->type = CFG_SUBSCRIBE;
+    msg->sync_ms = sync_ms;
+    msg->len = sizeof(*msg) + strlen(pattern) + 1;
+    strcpy(msg->pattern, pattern);
+    len = CFG_MSG_MAX;
+
+    rc = ipc_send_message_with_answer(cfgl_ipc_client, CONFIGURATOR_SERVER,
+                                      msg, msg->len, msg, &len);
+    if (rc == 0 && (rc = msg->rc) == 0)
+        *id = msg->id;
+
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_unlock(&cfgl_lock);
+#endif
+    return TE_RC(TE_CONF_API, rc);
+}
+
+/* See description in conf_api.h */
+te_errno
+cfg_unsubscribe(unsigned int id)
+{
+    cfg_unsubscribe_msg *msg;
+    size_t               len;
+    te_errno             rc;
+
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_lock(&cfgl_lock);
+#endif
+    INIT_IPC;
+    if (cfgl_ipc_client == NULL)
+    {
+#ifdef HAVE_PTHREAD_H
+        pthread_mutex_unlock(&cfgl_lock);
+#endif
+        return TE_RC(TE_CONF_API, TE_EIPC);
+    }
+
+    memset(cfgl_msg_buf, 0, sizeof(cfgl_msg_buf));
+    msg = (cfg_unsubscribe_msg *)cfgl_msg_buf;
+    msg->type = CFG_UNSUBSCRIBE;
+    msg->len = sizeof(*msg);
+    msg->id = id;
+    len = CFG_MSG_MAX;
+
+    rc = ipc_send_message_with_answer(cfgl_ipc_client, CONFIGURATOR_SERVER,
+                                      msg, msg->len, msg, &len);
+    if (rc == 0)
+        rc = msg->rc;
+
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_unlock(&cfgl_lock);
+#endif
+    return TE_RC(TE_CONF_API, rc);
+}
+
+/* See description in conf_api.h */
+te_errno
+cfg_wait_changes_subscr(unsigned int id, unsigned int timeout_ms,
+                        cfg_change **changes, unsigned int *num)
+{
+    static unsigned int  counter = 0;
+
+    struct ipc_client   *ipcc;
+    char                 name[CFG_NAME_MAX];
+    cfg_wait_events_msg  msg = { .rc = 0 };
+    cfg_wait_events_msg *ans = NULL;
+    cfg_change          *result;
+    const char          *ptr;
+    const char          *end;
+    unsigned int         n = 0;
+    te_errno             rc;
+
+    if (changes == NULL || num == NULL)
+        return TE_RC(TE_CONF_API, TE_EINVAL);
+
+    /*
+     * The request may be answered after a long time, so it is sent
+     * through a dedicated IPC client not to block other requests of
+     * the process.
+     */
+    snprintf(name, sizeof(name), "cfg_wait_%u_%u", (unsigned int)getpid(),
+             __atomic_fetch_add(&counter, 1, __ATOMIC_RELAXED));
+    rc = ipc_init_client(name, CONFIGURATOR_IPC, &ipcc);
+    if (rc != 0)
+    {
+        ERROR("%s(): failed to create IPC client: %r", __FUNCTION__, rc);
+        return TE_RC(TE_CONF_API, TE_EIPC);
+    }
+
+    msg.type = CFG_WAIT_EVENTS;
+    msg.len = sizeof(msg);
+    msg.id = id;
+    msg.timeout_ms = timeout_ms;
+
+    rc = cfgl_send_with_long_answer(ipcc, (cfg_msg *)&msg,
+                                    (cfg_msg **)&ans);
+    (void)ipc_close_client(ipcc);
+    if (rc != 0)
+        return TE_RC(TE_CONF_API, rc);
+    if ((rc = ans->rc) != 0)
+    {
+        free(ans);
+        return TE_RC(TE_CONF_API, rc);
+    }
+
+    result = TE_ALLOC((ans->num + 1) * sizeof(*result));
+    ptr = ans->events;
+    end = (const char *)ans + ans->len;
+    for (n = 0; n < ans->num; n++)
+    {
+        size_t avail = ptr < end ? (size_t)(end - ptr) : 0;
+        size_t oid_len;
+
+        /* Kind byte and '\0'-terminated OID should be in the answer */
+        if (avail < 2 ||
+            (oid_len = strnlen(ptr + 1, avail - 1)) == avail - 1)
+        {
+            ERROR("%s(): malformed answer", __FUNCTION__);
+            cfg_changes_free(result, n);
+            free(ans);
+            return TE_RC(TE_CONF_API, TE_EPROTO);
+        }
+        result[n].kind = (uint8_t)*ptr;
+        result[n].oid = TE_STRDUP(ptr + 1);
+        ptr += 1 + oid_len + 1;
+    }
+    if (ans->overflow)
+    {
+        result[n].kind = CFG_CHANGE_LOST;
+        result[n].oid = NULL;
+        n++;
+    }
+    free(ans);
+
+    *changes = result;
+    *num = n;
+    return 0;
+}
+
+/* See description in conf_api.h */
+void
+cfg_changes_free(cfg_change *changes, unsigned int num)
+{
+    unsigned int i;
+
+    if (changes == NULL)
+        return;
+
+    for (i = 0; i < num; i++)
+        free(changes[i].oid);
+    free(changes);
+}
+
+/**
+ * Send CFG_OP_STATS request to the Configurator.
+ *
+ * @param get           whether statistics should be returned
+ * @param log           whether statistics should be logged
+ * @param reset         whether statistics should be reset
+ * @param ans           location for the allocated answer
+ *
+ * @return Status code.
+ */
+static te_errno
+cfgl_op_stats_request(bool get, bool log, bool reset,
+                      cfg_op_stats_msg **ans)
+{
+    cfg_op_stats_msg *msg;
+    te_errno          rc;
+
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_lock(&cfgl_lock);
+#endif
+    INIT_IPC;
+    if (cfgl_ipc_client == NULL)
+    {
+#ifdef HAVE_PTHREAD_H
+        pthread_mutex_unlock(&cfgl_lock);
+#endif
+        return TE_EIPC;
+    }
+
+    memset(cfgl_msg_buf, 0, sizeof(cfgl_msg_buf));
+    msg = (cfg_op_stats_msg *)cfgl_msg_buf;
+    msg->type = CFG_OP_STATS;
+    msg->len = sizeof(*msg);
+    msg->get = get;
+    msg->log = log;
+    msg->reset = reset;
+
+    rc = cfgl_send_with_long_answer(cfgl_ipc_client, (cfg_msg *)msg,
+                                    (cfg_msg **)ans);
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_unlock(&cfgl_lock);
+#endif
+    if (rc == 0 && (rc = (*ans)->rc) != 0)
+        free(*ans);
+
+    return rc;
+}
+
+/**
+ * Get '\0'-terminated string from an entry of CFG_OP_STATS answer.
+ *
+ * @param ptr           location of the string pointer (it is moved
+ *                      past the string)
+ * @param end           end of the entry
+ *
+ * @return The string or @c NULL if it is not terminated.
+ */
+static const char *
+cfgl_op_stats_str(const char **ptr, const char *end)
+{
+    const char *str = *ptr;
+    const char *nul = str < end ? memchr(str, '\0', end - str) : NULL;
+
+    if (nul == NULL)
+        return NULL;
+
+    *ptr = nul + 1;
+    return str;
+}
+
+/* See description in conf_api.h */
+te_errno
+cfg_get_op_stats(cfg_op_stats **stats, unsigned int *num, bool reset)
+{
+    cfg_op_stats_msg   *ans = NULL;
+    cfg_op_stats_entry *entry;
+    cfg_op_stats       *result;
+    const uint8_t      *end;
+    unsigned int        n;
+    te_errno            rc;
+
+    if (stats == NULL || num == NULL)
+        return TE_RC(TE_CONF_API, TE_EINVAL);
+
+    rc = cfgl_op_stats_request(true, false, reset, &ans);
+    if (rc != 0)
+        return TE_RC(TE_CONF_API, rc);
+
+    result = TE_ALLOC((ans->num + 1) * sizeof(*result));
+    end = (const uint8_t *)ans + ans->len;
+    for (n = 0, entry = CFG_OP_STATS_FIRST(ans); n < ans->num;
+         n++, entry = CFG_OP_STATS_NEXT(entry))
+    {
+        const char *ptr = entry->strs;
+        const char *strs_end = (const char *)entry + entry->len;
+        const char *op = NULL;
+        const char *ta = NULL;
+        const char *obj = NULL;
+
+        if ((const uint8_t *)entry + sizeof(*entry) <= end &&
+            entry->len >= sizeof(*entry) &&
+            (const uint8_t *)strs_end <= end)
+        {
+            op = cfgl_op_stats_str(&ptr, strs_end);
+            ta = cfgl_op_stats_str(&ptr, strs_end);
+            obj = cfgl_op_stats_str(&ptr, strs_end);
+        }
+        if (op == NULL || ta == NULL || obj == NULL)
+        {
+            ERROR("%s(): malformed answer", __FUNCTION__);
+            cfg_op_stats_free(result, n);
+            free(ans);
+            return TE_RC(TE_CONF_API, TE_EPROTO);
+        }
+
+        result[n].op = TE_STRDUP(op);
+        result[n].ta = TE_STRDUP(ta);
+        result[n].obj = TE_STRDUP(obj);
+        result[n].count = entry->count;
+        result[n].sum_ns = entry->sum_ns;
+        result[n].min_ns = entry->min_ns;
+        result[n].max_ns = entry->max_ns;
+        memcpy(result[n].hist, entry->hist, sizeof(result[n].hist));
+    }
+    free(ans);
+
+    *stats = result;
+    *num = n;
+    return 0;
+}
+
+/* See description in conf_api.h */
+void
+cfg_op_stats_free(cfg_op_stats *stats, unsigned int num)
+{
+    unsigned int i;
+
+    if (stats == NULL)
+        return;
+
+    for (i = 0; i < num; i++)
+    {
+        free(stats[i].op);
+        free(stats[i].ta);
+        free(stats[i].obj);
+    }
+    free(stats);
+}
+
+/* See description in conf_api.h */
+te_errno
+cfg_log_op_stats(bool reset)
+{
+    cfg_op_stats_msg *ans = NULL;
+    te_errno          rc;
+
+    rc = cfgl_op_stats_request(false, true, reset, &ans);
+    if (rc == 0)
+        free(ans);
+
+    return TE_RC(TE_CONF_API, rc);
+}
+
+/**
+ * Maximum number of requests sent through cfg_async context without
+ * receiving answers.
+ *
+ * Answers are not bounded in size (get may return a long value), so
+ * the Configurator may block sending an answer until the process
+ * receives it. It cannot deadlock: a request is at most two
+ * sub-messages of @c CFG_MSG_MAX, so requests in flight take about
+ * 128 KiB and fit in the socket buffer with default Linux settings
+ * and in the ring of the shared memory transport. Hence sending of
+ * a request does not block and the process reaches cfgl_async_receive()
+ * when the window is full.
+ */
+#define CFG_ASYNC_WINDOW    16
+
+/** Operation of a request issued through cfg_async context */
+typedef enum cfgl_async_op {
+    CFGL_ASYNC_FIND,    /**< Find instance */
+    CFGL_ASYNC_GET,     /**< Get value of instance */
+} cfgl_async_op;
+
+/** Request sent through cfg_async context */
+typedef struct cfgl_async_req {
+    uint64_t        tag;        /**< Tag of the request */
+    cfgl_async_op   op;         /**< Operation */
+    cfg_val_type    type;       /**< Value type */
+    char           *oid;        /**< Instance identifier */
+} cfgl_async_req;
+
+/** Context of pipelined requests */
+struct cfg_async {
+    ipc_client *ipcc;       /**< IPC client with own connection */
+    te_vec      sent;       /**< Requests waiting for answers in order
+                                 of sending (cfgl_async_req) */
+    te_vec      done;       /**< Completions not collected yet
+                                 (cfg_async_compl) */
+    te_dbuf     msg;        /**< Buffer for a request */
+    char       *sub;        /**< Buffer for a sub-message of a batch */
+    char       *ans;        /**< Buffer for an answer */
+    size_t      ans_size;   /**< Size of the answer buffer */
+};
+
+/* See description in conf_api.h */
+te_errno
+cfg_async_open(cfg_async **async)
+{
+    static unsigned int  counter = 0;
+
+    cfg_async           *result;
+    char                 name[CFG_NAME_MAX];
+    te_errno             rc;
+
+    if (async == NULL)
+        return TE_RC(TE_CONF_API, TE_EINVAL);
+
+    result = TE_ALLOC(sizeof(*result));
+    snprintf(name, sizeof(name), "cfg_async_%u_%u",
+             (unsigned int)getpid(), counter++);
+    rc = ipc_init_client(name, CONFIGURATOR_IPC, &result->ipcc);
+    if (rc != 0)
+    {
+        ERROR("%s(): failed to create IPC client: %r", __FUNCTION__, rc);
+        free(result);
+        return TE_RC(TE_CONF_API, TE_EIPC);
+    }
+
+    result->sent = (te_vec)TE_VEC_INIT(cfgl_async_req);
+    result->done = (te_vec)TE_VEC_INIT(cfg_async_compl);
+    result->msg = (te_dbuf)TE_DBUF_INIT(TE_DBUF_DEFAULT_GROW_FACTOR);
+    result->sub = TE_ALLOC(CFG_MSG_MAX);
+    result->ans_size = CFG_MSG_MAX;
+    result->ans = TE_ALLOC(result->ans_size);
+
+    *async = result;
+    return 0;
+}
+
+/**
+ * Get status of a request and its results from the answer.
+ *
+ * @param req       request
+ * @param ans       answer
+ * @param compl     completion to fill in
+ *
+ * @return Status of the request.
+ */
+static te_errno
+cfgl_async_parse(const cfgl_async_req *req, const cfg_msg *ans,
+                 cfg_async_compl *compl)
+{
+    const cfg_batch_msg *batch = (const cfg_batch_msg *)ans;
+    const cfg_msg       *sub;
+    const cfg_get_msg   *get;
+
+    if (req->op == CFGL_ASYNC_FIND)
+    {
+        if (ans->rc == 0)
+            compl->handle = ((const cfg_find_msg *)ans)->handle;
+        return ans->rc;
+    }
+
+    /* Get is a batch of find and get by the handle found */
+    if (ans->rc != 0)
+        return ans->rc;
+
+    sub = CFG_BATCH_FIRST(batch);
+    if (batch->num != 2 || !cfgl_batch_sub_valid(batch, sub) ||
+        !cfgl_batch_sub_valid(batch, CFG_BATCH_NEXT(sub)))
+    {
+        ERROR("%s(): malformed answer", __FUNCTION__);
+        return TE_EPROTO;
+    }
+    if (sub->rc != 0)
+        return sub->rc;
+
+    compl->handle = ((const cfg_find_msg *)sub)->handle;
+    sub = CFG_BATCH_NEXT(sub);
+    if (sub->rc != 0)
+        return sub->rc;
+
+    get = (const cfg_get_msg *)sub;
+    if (req->type != CVT_UNSPECIFIED && req->type != get->val_type)
+        return TE_EBADTYPE;
+
+    compl->type = get->val_type;
+    return cfg_types[get->val_type].get_from_msg((cfg_msg *)sub,
+                                                  &compl->val);
+}
+
+/**
+ * Complete the oldest request sent through the context.
+ *
+ * @param async     context
+ * @param rc        status of receiving the answer
+ * @param ans       answer (unused if @p rc is not zero)
+ */
+static void
+cfgl_async_complete(cfg_async *async, te_errno rc, const cfg_msg *ans)
+{
+    cfgl_async_req  *req = &TE_VEC_GET(cfgl_async_req, &async->sent, 0);
+    cfg_async_compl  compl;
+
+    memset(&compl, 0, sizeof(compl));
+    compl.tag = req->tag;
+    compl.handle = CFG_HANDLE_INVALID;
+    compl.type = CVT_UNSPECIFIED;
+    if (rc == 0)
+        rc = cfgl_async_parse(req, ans, &compl);
+    compl.rc = TE_RC(TE_CONF_API, rc);
+
+    free(req->oid);
+    te_vec_remove_index(&async->sent, 0);
+    TE_VEC_APPEND(&async->done, compl);
+}
+
+/**
+ * Receive the answer to the oldest request sent through the context
+ * and queue its completion. If the answer cannot be received, all
+ * requests waiting for answers are completed with the error.
+ *
+ * @param async     context
+ */
+static void
+cfgl_async_receive(cfg_async *async)
+{
+    size_t      len = async->ans_size;
+    te_errno    rc;
+
+    rc = ipc_receive_answer(async->ipcc, CONFIGURATOR_SERVER,
+                            async->ans, &len);
+    if (TE_RC_GET_ERROR(rc) == TE_ESMALLBUF)
+    {
+        size_t rest_len = len - async->ans_size;
+
+        TE_REALLOC(async->ans, len);
+        rc = ipc_receive_rest_answer(async->ipcc, CONFIGURATOR_SERVER,
+                                     async->ans + async->ans_size,
+                                     &rest_len);
+        async->ans_size = len;
+    }
+
+    if (rc != 0)
+    {
+        ERROR("%s(): failed to receive an answer: %r", __FUNCTION__, rc);
+        while (te_vec_size(&async->sent) > 0)
+            cfgl_async_complete(async, rc, NULL);
+        return;
+    }
+
+    cfgl_async_complete(async, 0, (const cfg_msg *)async->ans);
+}
+
+/**
+ * Issue a request through the context.
+ *
+ * @param async     context
+ * @param tag       tag of the request
+ * @param op        operation
+ * @param type      expected value type for get
+ * @param oid_fmt   format string for the instance identifier
+ * @param ap        arguments for the format string
+ *
+ * @return Status code.
+ */
+static te_errno
+cfgl_async_issue(cfg_async *async, uint64_t tag, cfgl_async_op op,
+                 cfg_val_type type, const char *oid_fmt, va_list ap)
+{
+    cfgl_async_req  req;
+    cfg_batch_msg   header;
+    cfg_msg        *sub = (cfg_msg *)async->sub;
+    char            oid[CFG_OID_MAX];
+    te_errno        rc;
+
+    if (async == NULL || oid_fmt == NULL)
+        return TE_RC(TE_CONF_API, TE_EINVAL);
+
+    rc = te_vsnprintf(oid, sizeof(oid), oid_fmt, ap);
+    if (rc != 0)
+        return TE_RC(TE_CONF_API, TE_RC_GET_ERROR(rc));
+
+    te_dbuf_reset(&async->msg);
+    if (op == CFGL_ASYNC_FIND)
+    {
+        rc = cfg_ipc_mk_find_str((cfg_find_msg *)sub, CFG_MSG_MAX, oid);
+        if (rc == 0)
+            te_dbuf_append(&async->msg, sub, sub->len);
+    }
+    else
+    {
+        /* Get refers to the handle found in the batch */
+        memset(&header, 0, sizeof(header));
+        header.type = CFG_BATCH;
+        te_dbuf_append(&async->msg, &header, sizeof(header));
+        te_dbuf_append(&async->msg, NULL,
+                       TE_ALIGN(sizeof(header), CFG_BATCH_ALIGN) -
+                       sizeof(header));
+
+        rc = cfg_ipc_mk_find_str((cfg_find_msg *)sub, CFG_MSG_MAX, oid);
+        if (rc == 0)
+        {
+            cfgl_batch_append(&async->msg, sub);
+            rc = cfg_ipc_mk_get((cfg_get_msg *)sub, CFG_MSG_MAX,
+                                CFG_HANDLE_INVALID, false);
+        }
+        if (rc == 0)
+        {
+            cfgl_batch_append(&async->msg, sub);
+            ((cfg_msg *)async->msg.ptr)->len = async->msg.len;
+        }
+    }
+    if (rc != 0)
+        return TE_RC(TE_CONF_API, rc);
+
+    if (te_vec_size(&async->sent) >= CFG_ASYNC_WINDOW)
+        cfgl_async_receive(async);
+
+    rc = ipc_send_message(async->ipcc, CONFIGURATOR_SERVER,
+                          async->msg.ptr, async->msg.len);
+    if (rc != 0)
+    {
+        ERROR("%s(): failed to send a request for %s: %r", __FUNCTION__,
+              oid, rc);
+        return TE_RC(TE_CONF_API, rc);
+    }
+
+    memset(&req, 0, sizeof(req));
+    req.tag = tag;
+    req.op = op;
+    req.type = type;
+    req.oid = TE_STRDUP(oid);
+    TE_VEC_APPEND(&async->sent, req);
+
+    return 0;
+}
+
+/* See description in conf_api.h */
+te_errno
+cfg_async_find_fmt(cfg_async *async, uint64_t tag, const char *oid_fmt, ...)
+{
+    va_list         ap;
+    te_errno        rc;
+
+    va_start(ap, oid_fmt);
+    rc = cfgl_async_issue(async, tag, CFGL_ASYNC_FIND, CVT_NONE, oid_fmt, ap);
+    va_end(ap);
+
+    return rc;
+}
+
+/* See description in conf_api.h */
+te_errno
+cfg_async_get_fmt(cfg_async *async, uint64_t tag, cfg_val_type type,
+                  const char *oid_fmt, ...)
+{
+    va_list         ap;
+    te_errno        rc;
+
+    va_start(ap, oid_fmt);
+    rc = cfgl_async_issue(async, tag, CFGL_ASYNC_GET, type, oid_fmt, ap);
+    va_end(ap);
+
+    return rc;
+}
+
+/* See description in conf_api.h */
+unsigned int
+cfg_async_pending(const cfg_async *async)
+{
+    if (async == NULL)
+        return 0;
+
+    return te_vec_size(&async->sent) + te_vec_size(&async->done);
+}
+
+/* See description in conf_api.h */
+te_errno
+cfg_async_wait(cfg_async *async, cfg_async_compl *compl)
+{
+    if (async == NULL || compl == NULL)
+        return TE_RC(TE_CONF_API, TE_EINVAL);
+
+    if (te_vec_size(&async->done) == 0)
+    {
+        if (te_vec_size(&async->sent) == 0)
+            return TE_RC(TE_CONF_API, TE_ENOENT);
+
+        cfgl_async_receive(async);
+    }
+
+    *compl = TE_VEC_GET(cfg_async_compl, &async->done, 0);
+    te_vec_remove_index(&async->done, 0);
+
+    return 0;
+}
+
+/* See description in conf_api.h */
+te_errno
+cfg_async_close(cfg_async *async)
+{
+    cfg_async_compl compl;
+    te_errno        result = 0;
+    int             rc;
+
+    if (async == NULL)
+        return 0;
+
+    while (cfg_async_wait(async, &compl) == 0)
+    {
+        if (compl.rc == 0 && compl.type != CVT_UNSPECIFIED)
+            cfg_types[compl.type].free(compl.val);
+        if (result == 0)
+            result = compl.rc;
+    }
+
+    rc = ipc_close_client(async->ipcc);
+    if (rc != 0)
+    {
+        ERROR("%s(): ipc_close_client() failed with rc=%d",
+              __FUNCTION__, rc);
+    }
+
+    te_vec_free(&async->sent);
+    te_vec_free(&async->done);
+    te_dbuf_free(&async->msg);
+    free(async->sub);
+    free(async->ans);
+    free(async);
+
+    return result;
+}
+
+/* See description in conf_api.h */
+te_errno
+cfg_synchronize(const char *oid, bool subtree)
+{
+    cfg_sync_msg *msg;
+
+    size_t  len;
+    int     ret_val = 0;
+
+    if (oid == NULL)
+        return TE_EINVAL;
+
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_lock(&cfgl_lock);
+#endif
+    INIT_IPC;
+    if (cfgl_ipc_client == NULL)
+    {
+#ifdef HAVE_PTHREAD_H
+        pthread_mutex_unlock(&cfgl_lock);
+#endif
+        return TE_EIPC;
+    }
+
+    memset(cfgl_msg_buf, 0, sizeof(cfgl_msg_buf));
+    msg = (cfg_sync_msg *)cfgl_msg_buf;
+    msg->type = CFG_SYNC;
+    msg->subtree = subtree;
+
+    len = strlen(oid) + 1;
+    memcpy(msg->oid, oid, len);
+    msg->len = sizeof(cfg_sync_msg) + len;
+    len = CFG_MSG_MAX;
+
+    ret_val = ipc_send_message_with_answer(cfgl_ipc_client,
+                                           CONFIGURATOR_SERVER,
+                                           msg, msg->len, msg, &len);
+    if (ret_val == 0)
+    {
+        ret_val = msg->rc;
+    }
+
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_unlock(&cfgl_lock);
+#endif
+    return TE_RC(TE_CONF_API, ret_val);
+}
+
+/* See description in conf_api.h */
+te_errno
+cfg_synchronize_fmt(bool subtree, const char *oid_fmt, ...)
+{
+    va_list ap;
+    char    oid[CFG_OID_MAX];
+
+    va_start(ap, oid_fmt);
+    vsnprintf(oid, sizeof(oid), oid_fmt, ap);
+    va_end(ap);
+
+    return cfg_synchronize(oid, subtree);
+}
+
+/* See description in conf_api.h */
 te_errno
 cfg_enumerate(cfg_handle handle, cfg_inst_handler callback,
               void *user_data)
@@ -2563,6 +3976,8 @@ cfg_api_cleanup(void)
 {
     int rc = ipc_close_client(cfgl_ipc_client);
 
+    cfgl_cache_release();
+
     if (rc != 0)
     {
         ERROR("%s(): ipc_close_client() failed with rc=%d",
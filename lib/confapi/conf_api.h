@@ -612,8 +612,12 @@ extern te_errno cfg_set_instance_local_fmt(cfg_val_type type, const void *val,
 /**
  * Commit Configurator database changes to the Test Agent.
  *
+ * Changes of different Test Agents are committed concurrently and
+ * independently: a failure on one Test Agent does not prevent changes
+ * on the others from being applied.
+ *
  * @param oid       subtree object identifier or NULL if whole
- *                  database should be synchronized
+ *                  database should be committed
  *
  * @return Status code (see te_errno.h)
  */
@@ -843,6 +847,255 @@ extern te_errno cfg_get_addr_sync(struct sockaddr **val,
                                   const char *oid_fmt, ...)
                                   TE_LIKE_PRINTF(2, 3);
 
+/** Operation of a request in a batch */
+typedef enum cfg_batch_op {
+    CFG_BATCH_OP_GET,       /**< Get value of the instance */
+    CFG_BATCH_OP_SET,       /**< Set value of the instance */
+    CFG_BATCH_OP_SET_LOCAL, /**< Set value of the instance locally */
+} cfg_batch_op;
+
+/** Request in a batch processed by cfg_batch_process() */
+typedef struct cfg_batch_req {
+    cfg_batch_op  op;   /**< Operation */
+    const char   *oid;  /**< Instance identifier */
+    cfg_val_type  type; /**< Value type; for get it may be
+                             @c CVT_UNSPECIFIED and is updated with
+                             the type of the instance */
+    cfg_inst_val  val;  /**< Value to set or location for the value
+                             obtained by get (should be released by
+                             the caller using cfg_types[type].free()) */
+    te_errno      rc;   /**< OUT: status of the request */
+} cfg_batch_req;
+
+/**
+ * Process a batch of get and set requests in a single round trip
+ * to the Configurator.
+ *
+ * @param reqs      array of requests
+ * @param num       number of requests
+ * @param atomic    if @c true, processing is stopped on the first
+ *                  failure and values changed by preceding requests
+ *                  are restored; the rest of requests get
+ *                  @c TE_ECANCELED status
+ *
+ * @return Status code: @c 0 if all requests succeed, otherwise
+ *         status of the first failed request.
+ */
+extern te_errno cfg_batch_process(cfg_batch_req *reqs, unsigned int num,
+                                  bool atomic);
+
+/** Object instance obtained by cfg_get_subtree_fmt() */
+typedef struct cfg_subtree_inst {
+    cfg_handle    handle;   /**< Instance handle */
+    char         *oid;      /**< Instance identifier */
+    cfg_val_type  type;     /**< Value type */
+    cfg_inst_val  val;      /**< Value */
+} cfg_subtree_inst;
+
+/**
+ * Get identifiers and values of an instance and all its descendants
+ * in a single round trip to the Configurator.
+ *
+ * @param[out] insts    location for the array of instances in depth-first
+ *                      order, it should be released with cfg_subtree_free()
+ * @param[out] num      location for the number of instances
+ * @param[in]  oid_fmt  format string for the root instance identifier
+ *
+ * @return Status code.
+ */
+extern te_errno cfg_get_subtree_fmt(cfg_subtree_inst **insts,
+                                    unsigned int *num,
+                                    const char *oid_fmt, ...)
+                                    TE_LIKE_PRINTF(3, 4);
+
+/**
+ * Release instances obtained by cfg_get_subtree_fmt().
+ *
+ * @param insts     array of instances
+ * @param num       number of instances
+ */
+extern void cfg_subtree_free(cfg_subtree_inst *insts, unsigned int num);
+
+/** Kind of configuration change reported to subscribers */
+typedef enum cfg_change_kind {
+    CFG_CHANGE_ADD,     /**< Instance is added */
+    CFG_CHANGE_DEL,     /**< Instance is deleted */
+    CFG_CHANGE_SET,     /**< Instance value is changed */
+    CFG_CHANGE_LOST,    /**< Some changes are lost since the subscriber
+                             does not collect them for too long, current
+                             state should be re-read */
+} cfg_change_kind;
+
+/** Configuration change reported to subscribers */
+typedef struct cfg_change {
+    cfg_change_kind  kind;  /**< Kind of the change */
+    char            *oid;   /**< Instance identifier (@c NULL for
+                                 @c CFG_CHANGE_LOST) */
+} cfg_change;
+
+/**
+ * Subscribe to changes of instances matching a pattern. Changes
+ * are queued by the Configurator as it learns about them: on requests
+ * of any test or TAPI and on synchronization with Test Agents.
+ *
+ * @param[out] id       location for the subscription identifier
+ * @param[in]  sync_ms  interval of the subscribed subtree
+ *                      resynchronization by the Configurator while
+ *                      cfg_wait_changes_subscr() waits for changes
+ *                      (for changes on Test Agents not reported by any
+ *                      request) or @c 0 to wait for reported changes only
+ * @param[in]  pattern_fmt  format string for the instance identifier
+ *                      pattern (may contain '*' as instance names and
+ *                      subidentifiers, see cfg_find_pattern())
+ *
+ * @return Status code.
+ */
+extern te_errno cfg_subscribe_fmt(unsigned int *id, unsigned int sync_ms,
+                                  const char *pattern_fmt, ...)
+                                  TE_LIKE_PRINTF(3, 4);
+
+/**
+ * Cancel the subscription. Changes which are not collected are dropped.
+ *
+ * @param id            subscription identifier
+ *
+ * @return Status code.
+ */
+extern te_errno cfg_unsubscribe(unsigned int id);
+
+/**
+ * Wait for changes reported to the subscription. The Configurator
+ * answers as soon as there are changes, so no polling is required.
+ *
+ * The request is sent through a dedicated connection to the
+ * Configurator, so other Configurator API calls of the process are
+ * not blocked while the function waits.
+ *
+ * @param[in]  id           subscription identifier
+ * @param[in]  timeout_ms   maximum time to wait (@c 0 to get changes
+ *                          queued already without waiting)
+ * @param[out] changes      location for the array of changes in the order
+ *                          they happen, it should be released with
+ *                          cfg_changes_free()
+ * @param[out] num          location for the number of changes
+ *
+ * @return Status code.
+ * @retval TE_ETIMEDOUT     there are no changes during @p timeout_ms
+ */
+extern te_errno cfg_wait_changes_subscr(unsigned int id,
+                                        unsigned int timeout_ms,
+                                        cfg_change **changes,
+                                        unsigned int *num);
+
+/**
+ * Release changes obtained by cfg_wait_changes_subscr().
+ *
+ * @param changes       array of changes
+ * @param num           number of changes
+ */
+extern void cfg_changes_free(cfg_change *changes, unsigned int num);
+
+/**
+ * Context of pipelined requests to the Configurator.
+ *
+ * Only lookups (find and get) may be issued through the context. They
+ * are sent without waiting for answers to the previous ones, so
+ * the IPC round trip to the Configurator and switching between
+ * the processes are not paid per request. The Configurator processes
+ * requests one by one, so it pays off for lookups answered from its
+ * database. Get of a volatile instance still waits for synchronization
+ * with the Test Agent, and requests to different Test Agents are not
+ * overlapped. Requests are processed in order they are issued,
+ * completions are collected with cfg_async_wait() in the same order.
+ *
+ * The context has its own connection to the Configurator, it does not
+ * block other Configurator API calls of the process, but it should not
+ * be used by several threads simultaneously.
+ */
+typedef struct cfg_async cfg_async;
+
+/** Completion of a request issued through cfg_async context */
+typedef struct cfg_async_compl {
+    uint64_t      tag;      /**< Tag of the request */
+    te_errno      rc;       /**< Status of the request */
+    cfg_handle    handle;   /**< Handle of the instance found or got */
+    cfg_val_type  type;     /**< Value type obtained by get */
+    cfg_inst_val  val;      /**< Value obtained by get (should be
+                                 released by the caller using
+                                 cfg_types[type].free()) */
+} cfg_async_compl;
+
+/**
+ * Create a context of pipelined requests.
+ *
+ * @param[out] async    location for the context
+ *
+ * @return Status code.
+ */
+extern te_errno cfg_async_open(cfg_async **async);
+
+/**
+ * Wait for completion of all outstanding requests, drop completions
+ * which are not collected and release the context.
+ *
+ * @param async         context
+ *
+ * @return Status code: @c 0 if all dropped requests succeed, otherwise
+ *         status of the first failed one.
+ */
+extern te_errno cfg_async_close(cfg_async *async);
+
+/**
+ * Issue a request to find an instance by its identifier.
+ *
+ * @param async         context
+ * @param tag           tag of the request reported in its completion
+ * @param oid_fmt       format string for the instance identifier
+ *
+ * @return Status code of issuing the request.
+ */
+extern te_errno cfg_async_find_fmt(cfg_async *async, uint64_t tag,
+                                   const char *oid_fmt, ...)
+                                   TE_LIKE_PRINTF(3, 4);
+
+/**
+ * Issue a request to get value of an instance.
+ *
+ * @param async         context
+ * @param tag           tag of the request reported in its completion
+ * @param type          expected value type or @c CVT_UNSPECIFIED
+ * @param oid_fmt       format string for the instance identifier
+ *
+ * @return Status code of issuing the request.
+ */
+extern te_errno cfg_async_get_fmt(cfg_async *async, uint64_t tag,
+                                  cfg_val_type type,
+                                  const char *oid_fmt, ...)
+                                  TE_LIKE_PRINTF(4, 5);
+
+/**
+ * Get the number of requests which are issued but whose completions
+ * are not collected yet.
+ *
+ * @param async         context
+ *
+ * @return Number of requests.
+ */
+extern unsigned int cfg_async_pending(const cfg_async *async);
+
+/**
+ * Collect completion of the oldest request issued through the context
+ * waiting for it if necessary.
+ *
+ * @param[in]  async    context
+ * @param[out] compl    location for the completion
+ *
+ * @return Status code of waiting (status of the request is reported
+ *         in @p compl).
+ * @retval TE_ENOENT    There are no requests to wait for.
+ */
+extern te_errno cfg_async_wait(cfg_async *async, cfg_async_compl *compl);
+
 /**@}*/
 
 /** @defgroup confapi_base_sync Synchronization configuration tree with Test Agent
@@ -1055,6 +1308,20 @@ extern te_errno cfg_tree_print(const char *filename,
  */
 extern void cfg_api_cleanup(void);
 
+/**
+ * Enable or disable caching of read requests results in the process.
+ *
+ * When the cache is enabled, object descriptions, OID to handle
+ * mappings, family links and values of non-volatile instances
+ * obtained from the Configurator are kept in the process memory.
+ * All of them are dropped as soon as the Configurator database
+ * is changed. The cache may be enabled for all processes by
+ * setting @c TE_CONF_API_CACHE environment variable to a non-zero value.
+ *
+ * @param enable    whether the cache should be used
+ */
+extern void cfg_api_cache_enable(bool enable);
+
 /**
  * Copy a subtree pointed to by its OID format string to a
  * destination pointed to by OID of the tree to be created.
@@ -1069,6 +1336,67 @@ extern te_errno cfg_copy_subtree_fmt(const char *dst_oid,
                                      ...)
                 TE_LIKE_PRINTF(2, 3);
 
+/** Number of buckets in latency histograms of Configurator operations */
+#define CFG_OP_STATS_BUCKETS    32
+
+/**
+ * Latency statistics of a Configurator operation.
+ *
+ * Operations are requests processed by the Configurator (named after
+ * the request type, e.g. @c "find", @c "get_sync" or @c "commit") and
+ * RCF calls made by the Configurator to Test Agents (e.g. @c "rcf_get"
+ * or @c "rcf_set"). Statistics are kept separately for each object
+ * which the operation is applied to.
+ */
+typedef struct cfg_op_stats {
+    char       *op;         /**< Operation name */
+    char       *ta;         /**< Test Agent for RCF calls or empty string */
+    char       *obj;        /**< Object identifier or empty string */
+    uint64_t    count;      /**< Number of operations */
+    uint64_t    sum_ns;     /**< Total time of operations */
+    uint64_t    min_ns;     /**< Minimum time of an operation */
+    uint64_t    max_ns;     /**< Maximum time of an operation */
+    /**
+     * Histogram of operation times: the first bucket counts operations
+     * shorter than 1 microsecond, the bucket @a i counts operations
+     * which take from @a 2^(i-1) to @a 2^i microseconds, the last
+     * bucket counts longer operations as well.
+     */
+    uint64_t    hist[CFG_OP_STATS_BUCKETS];
+} cfg_op_stats;
+
+/**
+ * Get latency statistics of operations collected by the Configurator
+ * since its start or the last reset.
+ *
+ * @param[out] stats    location for the array of statistics, it should
+ *                      be released with cfg_op_stats_free()
+ * @param[out] num      location for the number of entries
+ * @param[in]  reset    reset statistics after they are obtained
+ *
+ * @return Status code.
+ */
+extern te_errno cfg_get_op_stats(cfg_op_stats **stats, unsigned int *num,
+                                 bool reset);
+
+/**
+ * Release statistics obtained by cfg_get_op_stats().
+ *
+ * @param stats         array of statistics
+ * @param num           number of entries
+ */
+extern void cfg_op_stats_free(cfg_op_stats *stats, unsigned int num);
+
+/**
+ * Ask the Configurator to log latency statistics of operations
+ * as an MI artifact.
+ *
+ * @param reset         reset statistics after they are logged
+ *
+ * @return Status code.
+ */
+extern te_errno cfg_log_op_stats(bool reset);
+
 /**@}*/
 
 #ifdef __cplusplus
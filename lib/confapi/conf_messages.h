@@ -35,6 +35,30 @@ cs_server_name(void)
 /** Type of IPC used by Configurator */
 #define CONFIGURATOR_IPC        (true) /* Connection-oriented IPC */
 
+/**
+ * Format of the path to the file with the database generation shared
+ * by Configurator with its clients: the first argument is the TE_TMP
+ * directory, the second one is the Configurator server name.
+ */
+#define CFG_DB_GEN_FILE_FMT     "%s/%s.gen"
+
+/**
+ * Database generation which means that the Configurator is gone
+ * and the file with the generation is no longer maintained.
+ */
+#define CFG_DB_GEN_INVALID      UINT64_MAX
+
+/**
+ * Layout of the file with the database generation.
+ *
+ * The generation is incremented by the Configurator on every change
+ * of the database, so clients may cache results of read requests
+ * while the generation stays the same.
+ */
+typedef struct cfg_db_gen_shared {
+    uint64_t gen;   /**< Database generation (accessed atomically) */
+} cfg_db_gen_shared;
+
 /** Message types */
 enum {
     CFG_REGISTER,  /**< Register object: IN: OID, description;
@@ -71,6 +95,17 @@ enum {
     CFG_TREE_PRINT,/**< Print a tree of obj|ins from a prefix */
     CFG_PROCESS_HISTORY,/**< Process history configuration file
                              IN: file name, key-value pairs to substitute */
+    CFG_BATCH,     /**< Batch of requests: IN: requests, atomic flag;
+                        OUT: answers to the requests */
+    CFG_GET_SUBTREE,/**< Get instances of a subtree: IN: OID;
+                         OUT: OIDs and values of instances */
+    CFG_SUBSCRIBE, /**< Subscribe to changes: IN: OID pattern,
+                        resynchronization interval; OUT: identifier */
+    CFG_UNSUBSCRIBE,/**< Cancel subscription: IN: identifier */
+    CFG_WAIT_EVENTS,/**< Wait for changes: IN: subscription identifier,
+                         timeout; OUT: changes */
+    CFG_OP_STATS,  /**< Latency statistics of operations: IN: flags;
+                        OUT: statistics */
 };
 
 /* Set of generic fields of the Configurator message */
@@ -219,6 +254,8 @@ typedef struct cfg_commit_msg {
 typedef struct cfg_get_msg {
     CFG_MSG_FIELDS
     bool sync;        /**< Synchronization get */
+    bool cacheable;   /**< OUT: value may be cached until the database
+                           is changed */
     cfg_handle      handle;      /**< IN */
     cfg_val_type    val_type;    /**< Object value type */
     union {
@@ -330,6 +367,130 @@ typedef struct cfg_process_history_msg {
     char    filename[0]; /**< IN: file name */
 } cfg_process_history_msg;
 
+/** Alignment of sub-messages in CFG_BATCH message */
+#define CFG_BATCH_ALIGN     8
+
+/**
+ * CFG_BATCH message content.
+ *
+ * The header is followed by @a num sub-messages, each of them starts
+ * at an offset aligned to @c CFG_BATCH_ALIGN. The answer has the same
+ * layout with answers to sub-messages in the same order.
+ *
+ * A sub-message with @c CFG_HANDLE_INVALID handle refers to the handle
+ * returned by the last preceding CFG_FIND, CFG_ADD or CFG_FAMILY
+ * sub-message, so that an instance may be looked up and accessed
+ * in the same batch.
+ */
+typedef struct cfg_batch_msg {
+    CFG_MSG_FIELDS
+    bool        atomic; /**< IN: stop on the first failure and restore
+                             values changed by preceding sub-messages */
+    uint32_t    num;    /**< Number of sub-messages */
+} cfg_batch_msg;
+
+/** Get the first sub-message of CFG_BATCH message */
+#define CFG_BATCH_FIRST(_msg) \
+    ((cfg_msg *)((uint8_t *)(_msg) +                                \
+                 TE_ALIGN(sizeof(cfg_batch_msg), CFG_BATCH_ALIGN)))
+
+/** Get the sub-message of CFG_BATCH message following @p _sub */
+#define CFG_BATCH_NEXT(_sub) \
+    ((cfg_msg *)((uint8_t *)(_sub) + TE_ALIGN((_sub)->len, CFG_BATCH_ALIGN)))
+
+/**
+ * CFG_GET_SUBTREE message content.
+ *
+ * The answer has the layout of CFG_BATCH message with pairs of
+ * CFG_GET_OID and CFG_GET answers for the root instance and all its
+ * descendants in depth-first order.
+ */
+typedef struct cfg_get_subtree_msg {
+    CFG_MSG_FIELDS
+    char    oid[0];     /**< IN: root instance identifier */
+} cfg_get_subtree_msg;
+
+/** Maximum number of changes queued for a subscription */
+#define CFG_SUBSCR_EVENTS_MAX   1024
+
+/** CFG_SUBSCRIBE message content */
+typedef struct cfg_subscribe_msg {
+    CFG_MSG_FIELDS
+    uint32_t    sync_ms;    /**< IN: interval of the subtree
+                                 resynchronization while a subscriber
+                                 waits for changes or 0 */
+    uint32_t    id;         /**< OUT: subscription identifier */
+    char        pattern[0]; /**< IN: instance identifier pattern */
+} cfg_subscribe_msg;
+
+/** CFG_UNSUBSCRIBE message content */
+typedef struct cfg_unsubscribe_msg {
+    CFG_MSG_FIELDS
+    uint32_t    id;         /**< IN: subscription identifier */
+} cfg_unsubscribe_msg;
+
+/**
+ * CFG_WAIT_EVENTS message content.
+ *
+ * The answer is sent as soon as there are changes queued for
+ * the subscription or the timeout expires (@c TE_ETIMEDOUT is returned
+ * in this case). Each change is put to @a events as a byte with
+ * cfg_change_kind followed by '\0'-terminated instance identifier.
+ */
+typedef struct cfg_wait_events_msg {
+    CFG_MSG_FIELDS
+    uint32_t    id;         /**< IN: subscription identifier */
+    uint32_t    timeout_ms; /**< IN: maximum time to wait */
+    uint32_t    num;        /**< OUT: number of changes */
+    bool        overflow;   /**< OUT: some changes are lost since
+                                 @c CFG_SUBSCR_EVENTS_MAX limit
+                                 is reached */
+    char        events[0];  /**< OUT: changes */
+} cfg_wait_events_msg;
+
+/** Alignment of entries in CFG_OP_STATS message */
+#define CFG_OP_STATS_ALIGN  8
+
+/**
+ * CFG_OP_STATS message content.
+ *
+ * Statistics are returned if @a get is set, then they are logged
+ * as an MI artifact if @a log is set and reset if @a reset is set.
+ * The answer contains @a num entries, each of them starts at an offset
+ * aligned to @c CFG_OP_STATS_ALIGN.
+ */
+typedef struct cfg_op_stats_msg {
+    CFG_MSG_FIELDS
+    bool        get;        /**< IN: return statistics */
+    bool        log;        /**< IN: log statistics as MI artifact */
+    bool        reset;      /**< IN: reset statistics */
+    uint32_t    num;        /**< OUT: number of entries */
+} cfg_op_stats_msg;
+
+/** Entry of the answer to CFG_OP_STATS message */
+typedef struct cfg_op_stats_entry {
+    uint32_t    len;        /**< Length of the entry with strings */
+    uint64_t    count;      /**< Number of operations */
+    uint64_t    sum_ns;     /**< Total time of operations */
+    uint64_t    min_ns;     /**< Minimum time of an operation */
+    uint64_t    max_ns;     /**< Maximum time of an operation */
+    uint64_t    hist[CFG_OP_STATS_BUCKETS]; /**< Histogram of times */
+    char        strs[0];    /**< Operation name, Test Agent name and
+                                 object identifier, each of them is
+                                 '\0'-terminated */
+} cfg_op_stats_entry;
+
+/** Get the first entry of the answer to CFG_OP_STATS message */
+#define CFG_OP_STATS_FIRST(_msg) \
+    ((cfg_op_stats_entry *)((uint8_t *)(_msg) +                     \
+                            TE_ALIGN(sizeof(cfg_op_stats_msg),      \
+                                     CFG_OP_STATS_ALIGN)))
+
+/** Get the entry of the answer to CFG_OP_STATS message following @p _e */
+#define CFG_OP_STATS_NEXT(_e) \
+    ((cfg_op_stats_entry *)((uint8_t *)(_e) +                       \
+                            TE_ALIGN((_e)->len, CFG_OP_STATS_ALIGN)))
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -130,7 +130,10 @@ struct ipc_client_server {
                                      left to read from the socket and
                                      to return to user.
                                      This field MUST be 4-octets long. */
-
+            int     fd;         /**< File descriptor passed with
+                                     the current message or -1 */
+            ipc_shm *shm;       /**< Shared memory transport or
+                                     @c NULL if the socket is used */
         } stream;
     };
 };
@@ -260,6 +263,8 @@ get_pool_item_by_name(struct ipc_client *ipcc, const char *name)
     if (ipcc->conn)
     {
         (*parent)->stream.socket = -1;
+        (*parent)->stream.fd = -1;
+        (*parent)->stream.shm = NULL;
     }
     else
     {
@@ -290,6 +295,9 @@ ipc_free_client_server_pool(struct ipc_client *ipcc)
         {
             if (ipccs->stream.socket >= 0)
                 close(ipccs->stream.socket);
+            if (ipccs->stream.fd >= 0)
+                close(ipccs->stream.fd);
+            ipc_shm_free(ipccs->stream.shm);
         }
         else
         {
@@ -1322,10 +1330,31 @@ ipc_stream_send_message(struct ipc_client *ipcc, const char *server_name,
                 sleep(IPC_SLEEP);
             }
         }
+
+        if (ipc_shm_enabled(false))
+        {
+            int rc = ipc_shm_offer(server->stream.socket,
+                                   &server->stream.shm);
+
+            if (rc != 0)
+            {
+                fprintf(stderr, "ipc_send_message(): failed to offer "
+                        "shared memory: %s\n", te_rc_err2str(rc));
+                return rc;
+            }
+        }
     }
 
     /* At this point we have established connection. Send data */
 
+    if (server->stream.shm != NULL)
+    {
+        size_t len = msg_len;
+
+        return ipc_shm_write(server->stream.shm, &len, sizeof(len),
+                             msg, msg_len);
+    }
+
     if (msg_len + 8 > IPC_TCP_CLIENT_BUFFER_SIZE)
     {
         /* Message is too long to fit into the internal buffer */
@@ -1358,6 +1387,115 @@ ipc_stream_send_message(struct ipc_client *ipcc, const char *server_name,
 }
 
 
+#ifdef TE_IPC_AF_UNIX
+/**
+ * Read specified number of octets from the server connection
+ * accepting a file descriptor passed with them. The descriptor is
+ * stored in the server entry.
+ *
+ * @param server        The server
+ * @param buffer        Buffer to store the data
+ * @param len           Number of octets to read
+ *
+ * @return Status code.
+ */
+static int
+read_socket_fd(struct ipc_client_server *server, void *buffer, size_t len)
+{
+    union {
+        struct cmsghdr  align;
+        char            buf[CMSG_SPACE(sizeof(int))];
+    } control;
+    struct iovec    iov;
+    struct msghdr   mh;
+    struct cmsghdr *cmsg;
+    ssize_t         r;
+
+    iov.iov_base = buffer;
+    iov.iov_len = len;
+
+    memset(&mh, 0, sizeof(mh));
+    mh.msg_iov = &iov;
+    mh.msg_iovlen = 1;
+    mh.msg_control = control.buf;
+    mh.msg_controllen = sizeof(control.buf);
+
+    r = recvmsg(server->stream.socket, &mh, MSG_CMSG_CLOEXEC);
+    if (r < 0)
+    {
+        te_errno rc = TE_OS_RC(TE_IPC, errno);
+
+        if (TE_RC_GET_ERROR(rc) != TE_ECONNRESET)
+            perror("read_header(): recvmsg() error");
+        return rc;
+    }
+    else if (r == 0)
+    {
+        return TE_RC(TE_IPC, TE_ECONNRESET);
+    }
+
+    for (cmsg = CMSG_FIRSTHDR(&mh); cmsg != NULL;
+         cmsg = CMSG_NXTHDR(&mh, cmsg))
+    {
+        if (cmsg->cmsg_level == SOL_SOCKET &&
+            cmsg->cmsg_type == SCM_RIGHTS &&
+            cmsg->cmsg_len == CMSG_LEN(sizeof(int)))
+        {
+            memcpy(&server->stream.fd, CMSG_DATA(cmsg), sizeof(int));
+        }
+    }
+
+    if ((size_t)r == len)
+        return 0;
+
+    return read_socket(server->stream.socket, (uint8_t *)buffer + r,
+                       len - r);
+}
+#endif
+
+/**
+ * Read the length of the next message from the server connection.
+ * A file descriptor passed by the server with the message
+ * (see ipc_send_answer_fd()) is stored in the server entry.
+ *
+ * @param server        The server
+ *
+ * @return Status code.
+ */
+static int
+read_header(struct ipc_client_server *server)
+{
+#ifdef TE_IPC_AF_UNIX
+    uint8_t marker;
+    int     rc;
+
+    if (server->stream.fd >= 0)
+    {
+        /* The descriptor passed with the previous message is not taken */
+        close(server->stream.fd);
+        server->stream.fd = -1;
+    }
+
+    if (server->stream.shm == NULL)
+    {
+        return read_socket_fd(server, &server->stream.pending,
+                              sizeof(server->stream.pending));
+    }
+
+    rc = ipc_shm_read(server->stream.shm, &server->stream.pending,
+                      sizeof(server->stream.pending));
+    if (rc != 0 || (server->stream.pending & IPC_SHM_FD_FLAG) == 0)
+        return rc;
+
+    /* The descriptor is sent over the socket with a marker byte */
+    server->stream.pending &= ~IPC_SHM_FD_FLAG;
+    return read_socket_fd(server, &marker, sizeof(marker));
+#else
+    return read_socket(server->stream.socket, &server->stream.pending,
+                       sizeof(server->stream.pending));
+#endif
+}
+
 /**
  * Receive answer from server.
  *
@@ -1380,7 +1518,12 @@ ipc_client_int_receive(struct ipc_client_server *server,
     octets_to_read = MIN(*p_buf_len, server->stream.pending);
     if (octets_to_read > 0)
     {
-        int rc = read_socket(server->stream.socket, buf, octets_to_read);
+        int rc;
+
+        if (server->stream.shm != NULL)
+            rc = ipc_shm_read(server->stream.shm, buf, octets_to_read);
+        else
+            rc = read_socket(server->stream.socket, buf, octets_to_read);
 
         /* If we have something to read */
         if (rc != 0)
@@ -1439,8 +1582,7 @@ ipc_stream_receive_answer(struct ipc_client *ipcc, const char *server_name,
      * Let's read the length of the message and call
      * ipc_receive_rest_answer.
      */
-    rc = read_socket(server->stream.socket, &server->stream.pending,
-                     sizeof(server->stream.pending));
+    rc = read_header(server);
     if (rc != 0)
     {
         /* ECONNRESET errno is set when server closes its socket */
@@ -1507,6 +1649,26 @@ ipc_receive_rest_answer(struct ipc_client *ipcc, const char *server_name,
     return ipcc->recv_rest(ipcc, server_name, buf, p_buf_len);
 }
 
+/* See description in ipc_client.h */
+int
+ipc_receive_answer_fd(struct ipc_client *ipcc, const char *server_name)
+{
+    struct ipc_client_server *server;
+    int                       fd;
+
+    if (ipcc == NULL || server_name == NULL || !ipcc->conn)
+        return -1;
+
+    server = get_pool_item_by_name(ipcc, server_name);
+    if (server == NULL)
+        return -1;
+
+    fd = server->stream.fd;
+    server->stream.fd = -1;
+
+    return fd;
+}
+
 /* See description in ipc_client.h */
 int
 ipc_send_message_with_answer(struct ipc_client *ipcc,
@@ -38,6 +38,11 @@ typedef struct ipc_client ipc_client;
  *                      @c true connection-oriented client
  * @param p_client      Location for client handle
  *
+ * If @c TE_IPC_SHM environment variable is set to @c 1 when
+ * a connection-oriented client connects to a server, it offers
+ * shared memory transport which is used instead of the socket for
+ * messages if the server accepts it (Linux only).
+ *
  * @return Status code.
  */
 extern int ipc_init_client(const char *client_name, bool conn,
@@ -170,6 +175,21 @@ extern int ipc_receive_rest_answer(struct ipc_client *ipcc,
                                    const char *server_name,
                                    void *buf, size_t *p_buf_len);
 
+/**
+ * Take a file descriptor passed by the server with the last message
+ * received from it (see ipc_send_answer_fd()). The caller becomes
+ * the owner of the descriptor. A descriptor which is not taken
+ * before the next message is received is closed.
+ *
+ * @param ipcc          Pointer to the ipc_client structure returned
+ *                      by ipc_init_client()
+ * @param server_name   Name of the server
+ *
+ * @return File descriptor or @c -1 if none has been passed.
+ */
+extern int ipc_receive_answer_fd(struct ipc_client *ipcc,
+                                 const char *server_name);
+
 /**
  * Close IPC client.
  *
@@ -30,6 +30,7 @@
 #endif
 
 #include "te_stdint.h"
+#include "te_defs.h"
 #include "te_queue.h"
 
 
@@ -129,6 +130,145 @@ extern int ipc_remember_datagram(struct ipc_datagrams *p_pool,
 #define IPC_TCP_CLIENT_BUFFER_SIZE 500
 /*@}*/
 
+/** Maximum number of events got from the server epoll instance at once */
+#define IPC_SERVER_POLL_EVENTS  64
+
+
+/** @name Shared memory transport of connection-oriented IPC
+ *
+ * A client may offer a shared memory area to the server just after
+ * connecting: it sends @c IPC_SHM_HELLO in place of a message length
+ * with a memory file descriptor and an eventfd attached. The server
+ * answers with a zero @c size_t if it accepts the offer. After that
+ * messages are written in the same format (length and body) to two
+ * single-producer single-consumer rings in the area instead of the
+ * socket. A reader sleeping on an empty ring and a writer sleeping
+ * on a full one are woken up via futex, the server event loop is
+ * woken up via the eventfd which is watched together with the socket.
+ * The socket is kept to detect termination of the peer and to pass
+ * file descriptors.
+ */
+
+/** Message length meaning offer of shared memory transport */
+#define IPC_SHM_HELLO       ((size_t)-1)
+
+/**
+ * Flag in the message length written to a ring meaning that
+ * a file descriptor is passed with the message: it is sent over
+ * the socket with one byte before the message is written.
+ */
+#define IPC_SHM_FD_FLAG     ((size_t)1 << (sizeof(size_t) * 8 - 1))
+
+/** Size of data area of each ring in bytes (must be a power of 2) */
+#define IPC_SHM_RING_SIZE   (256 * 1024)
+
+/*@}*/
+
+/** Shared memory transport of one connection (opaque) */
+typedef struct ipc_shm ipc_shm;
+
+/**
+ * Check whether shared memory transport may be used. It is supported
+ * on Linux only. Clients offer it if @c TE_IPC_SHM environment
+ * variable is set to @c 1, servers accept offers unless it is set
+ * to @c 0.
+ *
+ * @param server    @c true for server side
+ *
+ * @return @c true if shared memory transport may be used.
+ */
+extern bool ipc_shm_enabled(bool server);
+
+/**
+ * Create a shared memory area on the client side and offer it to
+ * the server over the connected socket.
+ *
+ * @param socket    connected socket
+ * @param p_shm     location for the transport (@c NULL if the area
+ *                  cannot be created or the server refused it)
+ *
+ * @return Status code (failure means that the connection is broken).
+ */
+extern int ipc_shm_offer(int socket, ipc_shm **p_shm);
+
+/**
+ * Attach to a shared memory area offered by a client.
+ *
+ * @param socket    connected socket
+ * @param mem_fd    memory file descriptor (closed by the function)
+ * @param notify_fd eventfd to watch for new messages (owned by
+ *                  the transport on success)
+ * @param p_shm     location for the transport
+ *
+ * @return Status code.
+ */
+extern int ipc_shm_attach(int socket, int mem_fd, int notify_fd,
+                          ipc_shm **p_shm);
+
+/**
+ * Release shared memory transport.
+ *
+ * @param shm       transport (may be @c NULL)
+ */
+extern void ipc_shm_free(ipc_shm *shm);
+
+/**
+ * Get file descriptor which is readable when there are messages
+ * for the server.
+ *
+ * @param shm       server side transport
+ *
+ * @return File descriptor.
+ */
+extern int ipc_shm_notify_fd(const ipc_shm *shm);
+
+/**
+ * Check whether there are data to read.
+ *
+ * @param shm       transport
+ *
+ * @return @c true if there are data.
+ */
+extern bool ipc_shm_readable(ipc_shm *shm);
+
+/**
+ * Clear the notification file descriptor if there are no data to read
+ * on the server side.
+ *
+ * @param shm       server side transport
+ */
+extern void ipc_shm_rearm(ipc_shm *shm);
+
+/**
+ * Read specified number of octets (not less), blocking if needed.
+ *
+ * @param shm       transport
+ * @param buf       buffer for data
+ * @param len       number of octets to read
+ *
+ * @return Status code.
+ * @retval TE_ECONNABORTED  client has gone (server side)
+ * @retval TE_ECONNRESET    server has gone (client side)
+ */
+extern int ipc_shm_read(ipc_shm *shm, void *buf, size_t len);
+
+/**
+ * Write a header and data making them visible to the peer at once
+ * if they fit into the ring.
+ *
+ * @param shm       transport
+ * @param hdr       header
+ * @param hdr_len   length of the header
+ * @param buf       data (may be @c NULL if @p len is @c 0)
+ * @param len       length of the data
+ *
+ * @return Status code.
+ * @retval TE_EPIPE         peer has gone
+ * @retval TE_ETIMEDOUT     client does not read answers (server side)
+ */
+extern int ipc_shm_write(ipc_shm *shm, const void *hdr, size_t hdr_len,
+                         const void *buf, size_t len);
+
 
 #ifndef TE_IPC_AF_UNIX
 
@@ -97,6 +97,57 @@ extern int ipc_get_server_fds(const struct ipc_server *ipcs,
 extern bool ipc_is_server_ready(struct ipc_server *ipcs,
                                    const fd_set *set, int max_fd);
 
+/**
+ * Accept a connection to connection-oriented server if it is reported
+ * by ipc_is_server_ready() or ipc_is_server_poll_ready(). Unlike
+ * ipc_receive_message() the function does not wait for a request from
+ * the new client, so the caller may return to its own wait with
+ * a timeout.
+ *
+ * @param ipcs          Pointer to the ipc_server structure returned
+ *                      by ipc_register_server()
+ */
+extern void ipc_server_accept(struct ipc_server *ipcs);
+
+/**
+ * Check whether requests of clients are reported by
+ * ipc_is_server_ready() or ipc_is_server_poll_ready(), so that
+ * ipc_receive_message() does not need to wait for a new connection.
+ *
+ * @param ipcs          Pointer to the ipc_server structure returned
+ *                      by ipc_register_server()
+ *
+ * @return Are requests ready or not?
+ */
+extern bool ipc_server_clients_ready(const struct ipc_server *ipcs);
+
+/**
+ * Get a file descriptor which may be polled for readability to wait
+ * for requests to the server. It is an epoll instance watching the
+ * server socket and sockets of all its clients, so it does not limit
+ * the number of clients as select() does.
+ *
+ * After the descriptor is requested, ipc_is_server_poll_ready() should
+ * be used instead of ipc_get_server_fds() and ipc_is_server_ready().
+ *
+ * @param ipcs          Pointer to the ipc_server structure returned
+ *                      by ipc_register_server()
+ *
+ * @return File descriptor or -1 if it is not supported.
+ */
+extern int ipc_get_server_poll_fd(struct ipc_server *ipcs);
+
+/**
+ * Is server ready on the base of events of the descriptor returned
+ * by ipc_get_server_poll_fd()? The function never blocks.
+ *
+ * @param ipcs          Pointer to the ipc_server structure returned
+ *                      by ipc_register_server()
+ *
+ * @return Is server ready or not?
+ */
+extern bool ipc_is_server_poll_ready(struct ipc_server *ipcs);
+
 /**
  * Get name of the IPC server client.
  *
@@ -108,6 +159,52 @@ extern bool ipc_is_server_ready(struct ipc_server *ipcs,
 extern const char *
     ipc_server_client_name(const struct ipc_server_client *ipcsc);
 
+/**
+ * Get identifier of the IPC server client. Identifiers are unique
+ * within the server and never reused, unlike client pointers.
+ *
+ * @param ipcsc         Pointer to the ipc_server_client structure
+ *                      returned by ipc_receive_message()
+ *
+ * @return Identifier of the client or @c 0 if @p ipcsc is @c NULL
+ */
+extern uint64_t ipc_server_client_id(const struct ipc_server_client *ipcsc);
+
+/**
+ * Check whether the IPC server client is still known to the server.
+ * Clients of connection-oriented servers are forgotten when they close
+ * the connection, so a client pointer kept to send a delayed answer
+ * should be checked before use together with the client identifier
+ * obtained when the pointer was saved.
+ *
+ * @param ipcs          Pointer to the ipc_server structure returned
+ *                      by ipc_register_server()
+ * @param ipcsc         Pointer to the ipc_server_client structure
+ *                      returned by ipc_receive_message()
+ * @param id            Identifier of the client returned by
+ *                      ipc_server_client_id()
+ *
+ * @return Is the client known or not?
+ */
+extern bool ipc_server_client_valid(const struct ipc_server *ipcs,
+                                    const struct ipc_server_client *ipcsc,
+                                    uint64_t id);
+
+/**
+ * Check whether the next message of a client of connection-oriented
+ * server has already arrived, so that it may be received with
+ * ipc_receive_message() for the client without waiting.
+ *
+ * @param ipcs          Pointer to the ipc_server structure returned
+ *                      by ipc_register_server()
+ * @param ipcsc         Pointer to the ipc_server_client structure
+ *                      returned by ipc_receive_message()
+ *
+ * @return Is data available or not?
+ */
+extern bool ipc_server_client_has_data(const struct ipc_server *ipcs,
+                                       const struct ipc_server_client *ipcsc);
+
 /**
  * Receive a message from IPC client.
  *
@@ -153,6 +250,38 @@ extern int ipc_send_answer(struct ipc_server *ipcs,
                            struct ipc_server_client *ipcsc,
                            const void *msg, size_t msg_len);
 
+/**
+ * Check whether the server is able to pass file descriptors to its
+ * clients with ipc_send_answer_fd().
+ *
+ * @param ipcs          Pointer to the ipc_server structure returned
+ *                      by ipc_register_server()
+ *
+ * @return @c true if file descriptors may be passed.
+ */
+extern bool ipc_server_can_pass_fd(const struct ipc_server *ipcs);
+
+/**
+ * Send an answer to the client passing a file descriptor with it.
+ * The client gets the descriptor with ipc_receive_answer_fd() after
+ * receiving the answer. The descriptor is duplicated, so the caller
+ * still owns it.
+ *
+ * @param ipcs          Pointer to the ipc_server structure returned
+ *                      by ipc_register_server()
+ * @param ipcsc         Variable returned by ipc_receive_message() with
+ *                      pointer ipc_server_client structure
+ * @param msg           Pointer to message to send
+ * @param msg_len       Length of the message to send
+ * @param fd            File descriptor to pass
+ *
+ * @return Status code.
+ * @retval TE_EOPNOTSUPP    The server cannot pass file descriptors
+ */
+extern int ipc_send_answer_fd(struct ipc_server *ipcs,
+                              struct ipc_server_client *ipcsc,
+                              const void *msg, size_t msg_len, int fd);
+
 
 /**
  * Close the server. Free all resources allocated by the server.
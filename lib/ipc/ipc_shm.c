@@ -0,0 +1,743 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/** @file
+ * @brief IPC library
+ *
+ * Shared memory transport of connection-oriented IPC
+ * (see description in ipc_internal.h).
+ *
+ *
+ * Copyright (C) 2004-2023 OKTET Labs Ltd. All rights reserved.
+ */
+
+#include "te_config.h"
+
+#include <stdio.h>
+#if HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#if HAVE_STRING_H
+#include <string.h>
+#endif
+#if HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#if HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#if HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#if HAVE_SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+#if HAVE_POLL_H
+#include <poll.h>
+#endif
+#if HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+#if HAVE_SYS_EVENTFD_H
+#include <sys/eventfd.h>
+#endif
+#if HAVE_SYS_SYSCALL_H
+#include <sys/syscall.h>
+#endif
+#if HAVE_LINUX_FUTEX_H
+#include <linux/futex.h>
+#endif
+
+#include "te_alloc.h"
+#include "te_defs.h"
+#include "te_errno.h"
+
+#include "ipc_internal.h"
+
+
+#if defined(TE_IPC_AF_UNIX) && HAVE_LINUX_FUTEX_H && \
+    HAVE_SYS_EVENTFD_H && HAVE_SYS_MMAN_H && HAVE_SYS_SYSCALL_H && \
+    defined(HAVE_MEMFD_CREATE) && defined(SYS_futex)
+#define IPC_SHM_SUPPORTED 1
+#else
+#define IPC_SHM_SUPPORTED 0
+#endif
+
+#if IPC_SHM_SUPPORTED
+
+/** Magic number at the beginning of the shared memory area */
+#define IPC_SHM_MAGIC           0x54454950
+
+/** Size of cache line used to separate fields of producer and consumer */
+#define IPC_SHM_CACHE_LINE      64
+
+/** Interval in milliseconds to check that the peer is alive */
+#define IPC_SHM_CHECK_INTERVAL  1000
+
+/** Time in milliseconds the server waits for space in a full ring */
+#define IPC_SHM_SERVER_TIMEOUT  2000
+
+/** Ring indices in the shared memory area */
+enum {
+    IPC_SHM_TO_SERVER = 0,  /**< Messages from client to server */
+    IPC_SHM_TO_CLIENT,      /**< Answers from server to client */
+    IPC_SHM_RINGS,          /**< Number of rings */
+};
+
+/**
+ * Control part of a ring. Positions are counted in octets since
+ * creation of the ring and never wrap. Sequence numbers are used as
+ * futex words to wait for data or space.
+ */
+typedef struct ipc_shm_ring {
+    /* Updated by the producer */
+    uint64_t    head;           /**< End of published data */
+    uint32_t    data_seq;       /**< Incremented on publishing */
+    uint32_t    reader_waits;   /**< Consumer sleeps on @p data_seq */
+    uint8_t     pad1[IPC_SHM_CACHE_LINE - 16];
+
+    /* Updated by the consumer */
+    uint64_t    tail;           /**< End of consumed data */
+    uint32_t    space_seq;      /**< Incremented on consuming */
+    uint32_t    writer_waits;   /**< Producer sleeps on @p space_seq */
+    uint8_t     pad2[IPC_SHM_CACHE_LINE - 16];
+} ipc_shm_ring;
+
+/** Header of the shared memory area followed by data of the rings */
+typedef struct ipc_shm_area {
+    uint32_t        magic;      /**< @c IPC_SHM_MAGIC */
+    uint32_t        ring_size;  /**< Size of data area of each ring */
+    uint8_t         pad[IPC_SHM_CACHE_LINE - 8];
+
+    ipc_shm_ring    rings[IPC_SHM_RINGS];   /**< Rings */
+} ipc_shm_area;
+
+/** Shared memory transport of one connection */
+struct ipc_shm {
+    bool            server;     /**< Server side? */
+    int             socket;     /**< Connected socket */
+    int             notify_fd;  /**< eventfd signalled on data for
+                                     the server */
+    ipc_shm_area   *area;       /**< Mapped area */
+    size_t          area_len;   /**< Length of the mapped area */
+    uint8_t        *data[IPC_SHM_RINGS];    /**< Data of the rings */
+    size_t          mask;       /**< Ring size minus 1 */
+};
+
+/** Get total size of the area */
+static size_t
+ipc_shm_area_len(size_t ring_size)
+{
+    return sizeof(ipc_shm_area) + IPC_SHM_RINGS * ring_size;
+}
+
+/** Get ring the side reads from */
+static inline unsigned int
+ipc_shm_rx(const ipc_shm *shm)
+{
+    return shm->server ? IPC_SHM_TO_SERVER : IPC_SHM_TO_CLIENT;
+}
+
+/** Get ring the side writes to */
+static inline unsigned int
+ipc_shm_tx(const ipc_shm *shm)
+{
+    return shm->server ? IPC_SHM_TO_CLIENT : IPC_SHM_TO_SERVER;
+}
+
+/**
+ * Sleep until a futex word changes or timeout expires.
+ *
+ * @param addr      futex word
+ * @param val       expected value
+ * @param timeout   timeout in milliseconds
+ *
+ * @return @c true if the timeout has expired.
+ */
+static bool
+ipc_shm_futex_wait(uint32_t *addr, uint32_t val, int timeout)
+{
+    struct timespec ts;
+
+    ts.tv_sec = timeout / 1000;
+    ts.tv_nsec = (long)(timeout % 1000) * 1000000L;
+
+    return syscall(SYS_futex, addr, FUTEX_WAIT, val, &ts, NULL, 0) < 0 &&
+           errno == ETIMEDOUT;
+}
+
+/** Wake up a process sleeping on a futex word */
+static void
+ipc_shm_futex_wake(uint32_t *addr)
+{
+    (void)syscall(SYS_futex, addr, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+/**
+ * Check whether the peer has closed the connection.
+ *
+ * @param shm       transport
+ *
+ * @return @c true if the peer has gone.
+ */
+static bool
+ipc_shm_peer_gone(const ipc_shm *shm)
+{
+    struct pollfd pfd;
+
+    pfd.fd = shm->socket;
+#ifdef POLLRDHUP
+    pfd.events = POLLRDHUP;
+#else
+    pfd.events = 0;
+#endif
+    pfd.revents = 0;
+
+    if (poll(&pfd, 1, 0) < 0)
+        return false;
+
+#ifdef POLLRDHUP
+    return (pfd.revents & (POLLHUP | POLLERR | POLLRDHUP)) != 0;
+#else
+    return (pfd.revents & (POLLHUP | POLLERR)) != 0;
+#endif
+}
+
+/** Signal the server that there are data in the ring */
+static void
+ipc_shm_notify(const ipc_shm *shm)
+{
+    uint64_t one = 1;
+
+    if (write(shm->notify_fd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+        perror("ipc_shm_notify(): write() error");
+}
+
+/**
+ * Publish data written to a ring.
+ *
+ * @param shm       transport
+ * @param head      new head of the ring
+ */
+static void
+ipc_shm_publish(ipc_shm *shm, uint64_t head)
+{
+    ipc_shm_ring *ring = &shm->area->rings[ipc_shm_tx(shm)];
+    uint64_t      old = ring->head;
+
+    __atomic_store_n(&ring->head, head, __ATOMIC_SEQ_CST);
+    __atomic_fetch_add(&ring->data_seq, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring->reader_waits, __ATOMIC_SEQ_CST))
+        ipc_shm_futex_wake(&ring->data_seq);
+
+    /*
+     * The server keeps the eventfd signalled while the ring is not
+     * empty, so it should be signalled only if the ring was drained
+     * (see ipc_shm_rearm()).
+     */
+    if (!shm->server &&
+        __atomic_load_n(&ring->tail, __ATOMIC_SEQ_CST) == old)
+        ipc_shm_notify(shm);
+}
+
+/* See description in ipc_internal.h */
+bool
+ipc_shm_enabled(bool server)
+{
+    const char *val = getenv("TE_IPC_SHM");
+
+    if (server)
+        return val == NULL || strcmp(val, "0") != 0;
+    else
+        return val != NULL && strcmp(val, "1") == 0;
+}
+
+/**
+ * Map shared memory area and allocate the transport.
+ *
+ * @param server    server side?
+ * @param socket    connected socket
+ * @param mem_fd    memory file descriptor
+ * @param ring_size size of each ring
+ * @param p_shm     location for the transport
+ *
+ * @return Status code.
+ */
+static int
+ipc_shm_map(bool server, int socket, int mem_fd, size_t ring_size,
+            ipc_shm **p_shm)
+{
+    ipc_shm *shm;
+    void    *area;
+    size_t   area_len = ipc_shm_area_len(ring_size);
+
+    area = mmap(NULL, area_len, PROT_READ | PROT_WRITE, MAP_SHARED,
+                mem_fd, 0);
+    if (area == MAP_FAILED)
+    {
+        perror("ipc_shm_map(): mmap() error");
+        return TE_OS_RC(TE_IPC, errno);
+    }
+
+    shm = TE_ALLOC(sizeof(*shm));
+    shm->server = server;
+    shm->socket = socket;
+    shm->notify_fd = -1;
+    shm->area = area;
+    shm->area_len = area_len;
+    shm->data[IPC_SHM_TO_SERVER] = (uint8_t *)area + sizeof(ipc_shm_area);
+    shm->data[IPC_SHM_TO_CLIENT] = shm->data[IPC_SHM_TO_SERVER] + ring_size;
+    shm->mask = ring_size - 1;
+
+    *p_shm = shm;
+    return 0;
+}
+
+/* See description in ipc_internal.h */
+int
+ipc_shm_offer(int socket, ipc_shm **p_shm)
+{
+    union {
+        struct cmsghdr  align;
+        char            buf[CMSG_SPACE(2 * sizeof(int))];
+    } control;
+    size_t          hello = IPC_SHM_HELLO;
+    size_t          answer;
+    size_t          got;
+    int             fds[2];
+    ipc_shm        *shm = NULL;
+    struct iovec    iov;
+    struct msghdr   mh;
+    struct cmsghdr *cmsg;
+    ssize_t         r;
+    int             rc;
+
+    *p_shm = NULL;
+
+    /*
+     * Failure to create the area is not fatal: the socket is used
+     * as if the server refused the offer.
+     */
+    fds[0] = memfd_create("te_ipc", MFD_CLOEXEC);
+    if (fds[0] < 0)
+    {
+        perror("ipc_shm_offer(): memfd_create() error");
+        return 0;
+    }
+
+    if (ftruncate(fds[0], ipc_shm_area_len(IPC_SHM_RING_SIZE)) != 0)
+    {
+        perror("ipc_shm_offer(): ftruncate() error");
+        close(fds[0]);
+        return 0;
+    }
+
+    if (ipc_shm_map(false, socket, fds[0], IPC_SHM_RING_SIZE, &shm) != 0)
+    {
+        close(fds[0]);
+        return 0;
+    }
+    shm->area->magic = IPC_SHM_MAGIC;
+    shm->area->ring_size = IPC_SHM_RING_SIZE;
+
+    fds[1] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fds[1] < 0)
+    {
+        perror("ipc_shm_offer(): eventfd() error");
+        close(fds[0]);
+        ipc_shm_free(shm);
+        return 0;
+    }
+    shm->notify_fd = fds[1];
+
+    iov.iov_base = &hello;
+    iov.iov_len = sizeof(hello);
+
+    memset(&mh, 0, sizeof(mh));
+    mh.msg_iov = &iov;
+    mh.msg_iovlen = 1;
+    mh.msg_control = control.buf;
+    mh.msg_controllen = sizeof(control.buf);
+
+    cmsg = CMSG_FIRSTHDR(&mh);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    r = sendmsg(socket, &mh, MSG_NOSIGNAL);
+    /* The mapping keeps the memory, the server has its own descriptor */
+    close(fds[0]);
+    if (r != (ssize_t)sizeof(hello))
+    {
+        rc = (r < 0) ? TE_OS_RC(TE_IPC, errno) : TE_RC(TE_IPC, TE_EIO);
+        ipc_shm_free(shm);
+        return rc;
+    }
+
+    for (got = 0; got < sizeof(answer); got += r)
+    {
+        r = recv(socket, (uint8_t *)&answer + got, sizeof(answer) - got, 0);
+        if (r <= 0)
+        {
+            rc = (r < 0) ? TE_OS_RC(TE_IPC, errno) :
+                           TE_RC(TE_IPC, TE_ECONNRESET);
+            ipc_shm_free(shm);
+            return rc;
+        }
+    }
+
+    if (answer != 0)
+        ipc_shm_free(shm);
+    else
+        *p_shm = shm;
+
+    return 0;
+}
+
+/* See description in ipc_internal.h */
+int
+ipc_shm_attach(int socket, int mem_fd, int notify_fd, ipc_shm **p_shm)
+{
+    const ipc_shm_area *area;
+    struct stat         st;
+    size_t              ring_size;
+    void               *hdr;
+    int                 rc;
+
+    if (fstat(mem_fd, &st) != 0)
+    {
+        rc = TE_OS_RC(TE_IPC, errno);
+        close(mem_fd);
+        return rc;
+    }
+
+    if ((size_t)st.st_size < sizeof(*area))
+    {
+        close(mem_fd);
+        return TE_RC(TE_IPC, TE_EPROTO);
+    }
+
+    hdr = mmap(NULL, sizeof(*area), PROT_READ, MAP_SHARED, mem_fd, 0);
+    if (hdr == MAP_FAILED)
+    {
+        rc = TE_OS_RC(TE_IPC, errno);
+        close(mem_fd);
+        return rc;
+    }
+    area = hdr;
+    ring_size = area->ring_size;
+    rc = (area->magic != IPC_SHM_MAGIC || ring_size == 0 ||
+          (ring_size & (ring_size - 1)) != 0 ||
+          (size_t)st.st_size < ipc_shm_area_len(ring_size)) ?
+         TE_RC(TE_IPC, TE_EPROTO) : 0;
+    munmap(hdr, sizeof(*area));
+
+    if (rc == 0)
+        rc = ipc_shm_map(true, socket, mem_fd, ring_size, p_shm);
+    close(mem_fd);
+    if (rc != 0)
+        return rc;
+
+    (*p_shm)->notify_fd = notify_fd;
+    return 0;
+}
+
+/* See description in ipc_internal.h */
+void
+ipc_shm_free(ipc_shm *shm)
+{
+    if (shm == NULL)
+        return;
+
+    if (shm->notify_fd >= 0)
+        close(shm->notify_fd);
+    munmap(shm->area, shm->area_len);
+    free(shm);
+}
+
+/* See description in ipc_internal.h */
+int
+ipc_shm_notify_fd(const ipc_shm *shm)
+{
+    return shm->notify_fd;
+}
+
+/* See description in ipc_internal.h */
+bool
+ipc_shm_readable(ipc_shm *shm)
+{
+    ipc_shm_ring *ring = &shm->area->rings[ipc_shm_rx(shm)];
+
+    return __atomic_load_n(&ring->head, __ATOMIC_SEQ_CST) != ring->tail;
+}
+
+/* See description in ipc_internal.h */
+void
+ipc_shm_rearm(ipc_shm *shm)
+{
+    uint64_t cnt;
+
+    if (!shm->server || ipc_shm_readable(shm))
+        return;
+
+    if (read(shm->notify_fd, &cnt, sizeof(cnt)) < 0 && errno != EAGAIN)
+        perror("ipc_shm_rearm(): read() error");
+
+    /* The client does not notify if it sees the ring not drained yet */
+    if (ipc_shm_readable(shm))
+        ipc_shm_notify(shm);
+}
+
+/**
+ * Wait for data in the ring to read.
+ *
+ * @param shm       transport
+ * @param ring      ring to read from
+ *
+ * @return Status code.
+ */
+static int
+ipc_shm_wait_data(ipc_shm *shm, ipc_shm_ring *ring)
+{
+    uint32_t seq = __atomic_load_n(&ring->data_seq, __ATOMIC_SEQ_CST);
+    bool     timeout;
+
+    __atomic_store_n(&ring->reader_waits, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring->head, __ATOMIC_SEQ_CST) != ring->tail)
+        timeout = false;
+    else
+        timeout = ipc_shm_futex_wait(&ring->data_seq, seq,
+                                     IPC_SHM_CHECK_INTERVAL);
+    __atomic_store_n(&ring->reader_waits, 0, __ATOMIC_SEQ_CST);
+
+    if (timeout && !ipc_shm_readable(shm) && ipc_shm_peer_gone(shm))
+    {
+        return TE_RC(TE_IPC, shm->server ? TE_ECONNABORTED :
+                                           TE_ECONNRESET);
+    }
+
+    return 0;
+}
+
+/**
+ * Wait for space in the ring to write.
+ *
+ * @param shm       transport
+ * @param ring      ring to write to
+ *
+ * @return Status code.
+ */
+static int
+ipc_shm_wait_space(ipc_shm *shm, ipc_shm_ring *ring)
+{
+    uint32_t seq = __atomic_load_n(&ring->space_seq, __ATOMIC_SEQ_CST);
+    bool     timeout;
+    int      interval = shm->server ? IPC_SHM_SERVER_TIMEOUT :
+                                      IPC_SHM_CHECK_INTERVAL;
+
+    __atomic_store_n(&ring->writer_waits, 1, __ATOMIC_SEQ_CST);
+    if (ring->head - __atomic_load_n(&ring->tail, __ATOMIC_SEQ_CST) <=
+        shm->mask)
+        timeout = false;
+    else
+        timeout = ipc_shm_futex_wait(&ring->space_seq, seq, interval);
+    __atomic_store_n(&ring->writer_waits, 0, __ATOMIC_SEQ_CST);
+
+    if (!timeout ||
+        ring->head - __atomic_load_n(&ring->tail, __ATOMIC_SEQ_CST) <=
+        shm->mask)
+        return 0;
+
+    if (ipc_shm_peer_gone(shm))
+        return TE_RC(TE_IPC, TE_EPIPE);
+
+    /* Too long block - give up as the socket transport does */
+    return shm->server ? TE_RC(TE_IPC, TE_ETIMEDOUT) : 0;
+}
+
+/* See description in ipc_internal.h */
+int
+ipc_shm_read(ipc_shm *shm, void *buf, size_t len)
+{
+    ipc_shm_ring  *ring = &shm->area->rings[ipc_shm_rx(shm)];
+    const uint8_t *data = shm->data[ipc_shm_rx(shm)];
+    uint8_t       *p = buf;
+    uint64_t       tail = ring->tail;
+    int            rc;
+
+    while (len > 0)
+    {
+        uint64_t avail = __atomic_load_n(&ring->head, __ATOMIC_SEQ_CST) -
+                         tail;
+        size_t   off = tail & shm->mask;
+        size_t   n;
+
+        if (avail == 0)
+        {
+            rc = ipc_shm_wait_data(shm, ring);
+            if (rc != 0)
+                return rc;
+            continue;
+        }
+
+        n = MIN(len, avail);
+        n = MIN(n, shm->mask + 1 - off);
+        memcpy(p, data + off, n);
+        p += n;
+        len -= n;
+        tail += n;
+
+        __atomic_store_n(&ring->tail, tail, __ATOMIC_SEQ_CST);
+        __atomic_fetch_add(&ring->space_seq, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&ring->writer_waits, __ATOMIC_SEQ_CST))
+            ipc_shm_futex_wake(&ring->space_seq);
+    }
+
+    ipc_shm_rearm(shm);
+
+    return 0;
+}
+
+/* See description in ipc_internal.h */
+int
+ipc_shm_write(ipc_shm *shm, const void *hdr, size_t hdr_len,
+              const void *buf, size_t len)
+{
+    ipc_shm_ring  *ring = &shm->area->rings[ipc_shm_tx(shm)];
+    uint8_t       *data = shm->data[ipc_shm_tx(shm)];
+    const uint8_t *p = hdr;
+    uint64_t       head = ring->head;
+    int            rc;
+
+    if (hdr_len == 0)
+    {
+        p = buf;
+        hdr_len = len;
+        len = 0;
+    }
+
+    while (hdr_len > 0)
+    {
+        uint64_t used = head - __atomic_load_n(&ring->tail,
+                                               __ATOMIC_SEQ_CST);
+        size_t   off = head & shm->mask;
+        size_t   n;
+
+        if (used > shm->mask)
+        {
+            /* Full ring: let the peer read what is written so far */
+            if (head != ring->head)
+                ipc_shm_publish(shm, head);
+
+            rc = ipc_shm_wait_space(shm, ring);
+            if (rc != 0)
+                return rc;
+            continue;
+        }
+
+        n = MIN(hdr_len, shm->mask + 1 - used);
+        n = MIN(n, shm->mask + 1 - off);
+        memcpy(data + off, p, n);
+        p += n;
+        hdr_len -= n;
+        head += n;
+
+        if (hdr_len == 0 && len > 0)
+        {
+            p = buf;
+            hdr_len = len;
+            len = 0;
+        }
+    }
+
+    ipc_shm_publish(shm, head);
+
+    return 0;
+}
+
+#else /* !IPC_SHM_SUPPORTED */
+
+/* See description in ipc_internal.h */
+bool
+ipc_shm_enabled(bool server)
+{
+    UNUSED(server);
+    return false;
+}
+
+/* See description in ipc_internal.h */
+int
+ipc_shm_offer(int socket, ipc_shm **p_shm)
+{
+    UNUSED(socket);
+    *p_shm = NULL;
+    return TE_RC(TE_IPC, TE_EOPNOTSUPP);
+}
+
+/* See description in ipc_internal.h */
+int
+ipc_shm_attach(int socket, int mem_fd, int notify_fd, ipc_shm **p_shm)
+{
+    UNUSED(socket);
+    UNUSED(notify_fd);
+    close(mem_fd);
+    *p_shm = NULL;
+    return TE_RC(TE_IPC, TE_EOPNOTSUPP);
+}
+
+/* See description in ipc_internal.h */
+void
+ipc_shm_free(ipc_shm *shm)
+{
+    UNUSED(shm);
+}
+
+/* See description in ipc_internal.h */
+int
+ipc_shm_notify_fd(const ipc_shm *shm)
+{
+    UNUSED(shm);
+    return -1;
+}
+
+/* See description in ipc_internal.h */
+bool
+ipc_shm_readable(ipc_shm *shm)
+{
+    UNUSED(shm);
+    return false;
+}
+
+/* See description in ipc_internal.h */
+void
+ipc_shm_rearm(ipc_shm *shm)
+{
+    UNUSED(shm);
+}
+
+/* See description in ipc_internal.h */
+int
+ipc_shm_read(ipc_shm *shm, void *buf, size_t len)
+{
+    UNUSED(shm);
+    UNUSED(buf);
+    UNUSED(len);
+    return TE_RC(TE_IPC, TE_EOPNOTSUPP);
+}
+
+/* See description in ipc_internal.h */
+int
+ipc_shm_write(ipc_shm *shm, const void *hdr, size_t hdr_len,
+              const void *buf, size_t len)
+{
+    UNUSED(shm);
+    UNUSED(hdr);
+    UNUSED(hdr_len);
+    UNUSED(buf);
+    UNUSED(len);
+    return TE_RC(TE_IPC, TE_EOPNOTSUPP);
+}
+
+#endif /* !IPC_SHM_SUPPORTED */
@@ -38,6 +38,9 @@
 #if HAVE_SYS_POLL_H
 #include <sys/poll.h>
 #endif
+#if HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
 
 #ifndef TE_IPC_AF_UNIX
 #if HAVE_NETINET_IN_H
@@ -84,6 +87,8 @@ typedef int (*ipc_send)(struct ipc_server *ipcs,
 struct ipc_server_client {
     /** Links to neighbour clients in the list */
     LIST_ENTRY(ipc_server_client)   links;
+    /** Identifier of the client unique within the server */
+    uint64_t                        id;
 
 #ifdef TE_IPC_AF_UNIX
     struct sockaddr_un  sa;         /**< Address of the sender */
@@ -110,6 +115,8 @@ struct ipc_server_client {
                                          socket and to return to user.
                                          This field MUST be 4-octets
                                          long. */
+            ipc_shm    *shm;        /**< Shared memory transport or
+                                         @c NULL if the socket is used */
         } stream;
     };
 };
@@ -120,9 +127,13 @@ struct ipc_server {
     char    name[UNIX_PATH_MAX];    /**< Name of the server */
     int     socket;                 /**< Server socket */
     bool is_ready;               /**< Is server socket ready? */
+    int     poll_fd;                /**< epoll instance watching server
+                                         and client sockets or -1 */
 
     /** List of "active" IPC clients */
     LIST_HEAD(ipc_server_clients, ipc_server_client) clients;
+    uint64_t    last_client_id; /**< The last allocated client
+                                     identifier */
 
 #ifndef TE_IPC_AF_UNIX
     uint16_t    port;           /**< Port number used for this server */
@@ -218,6 +229,7 @@ ipc_register_server(const char *name, bool conn,
 
     ipcs = TE_ALLOC(sizeof(*ipcs));
     ipcs->conn = conn;
+    ipcs->poll_fd = -1;
 
     strcpy(ipcs->name, name);
     LIST_INIT(&ipcs->clients);
@@ -352,6 +364,13 @@ ipc_get_server_fds(const struct ipc_server *ipcs, fd_set *set)
         {
             FD_SET(client->stream.socket, set);
             max_fd = MAX(max_fd, client->stream.socket);
+            if (client->stream.shm != NULL)
+            {
+                int fd = ipc_shm_notify_fd(client->stream.shm);
+
+                FD_SET(fd, set);
+                max_fd = MAX(max_fd, fd);
+            }
         }
     }
 
@@ -361,20 +380,256 @@ ipc_get_server_fds(const struct ipc_server *ipcs, fd_set *set)
 /**
  * Close IPC server association with client.
  *
+ * @param ipcs      IPC server
  * @param ipcsc     IPC server client
- * @param conn      Is connection-oriented server client or not?
  */
 static void
-ipc_server_close_client(struct ipc_server_client *ipcsc, bool conn)
+ipc_server_close_client(struct ipc_server *ipcs,
+                        struct ipc_server_client *ipcsc)
 {
     LIST_REMOVE(ipcsc, links);
-    if (conn)
+    if (ipcs->conn)
+    {
+#if HAVE_SYS_EPOLL_H
+        /*
+         * The socket may be shared with a child process, so closing
+         * it does not necessarily remove it from the epoll instance.
+         */
+        if (ipcs->poll_fd >= 0)
+        {
+            (void)epoll_ctl(ipcs->poll_fd, EPOLL_CTL_DEL,
+                            ipcsc->stream.socket, NULL);
+            if (ipcsc->stream.shm != NULL)
+            {
+                (void)epoll_ctl(ipcs->poll_fd, EPOLL_CTL_DEL,
+                                ipc_shm_notify_fd(ipcsc->stream.shm),
+                                NULL);
+            }
+        }
+#endif
+        ipc_shm_free(ipcsc->stream.shm);
         close(ipcsc->stream.socket);
+    }
     else
+    {
         free(ipcsc->dgram.buffer);
+    }
     free(ipcsc);
 }
 
+/**
+ * Check a client socket reported readable: if there are no data,
+ * the client has closed the connection and it is closed on the server
+ * side too.
+ *
+ * @param ipcs      IPC server
+ * @param client    IPC server client
+ *
+ * @return @c true if data are available.
+ */
+static bool
+ipc_server_client_check_ready(struct ipc_server *ipcs,
+                              struct ipc_server_client *client)
+{
+    int available = 0;
+
+    if (client->stream.shm != NULL)
+    {
+        struct pollfd pfd = { client->stream.socket, POLLIN, 0 };
+
+        ipc_shm_rearm(client->stream.shm);
+        if (ipc_shm_readable(client->stream.shm))
+            return true;
+
+        /*
+         * Nothing but termination of the client is expected
+         * on the socket when messages go via shared memory.
+         */
+        if (poll(&pfd, 1, 0) <= 0)
+        {
+            client->stream.is_ready = false;
+            return false;
+        }
+
+        ipc_server_close_client(ipcs, client);
+        return false;
+    }
+
+    /*
+     * select() and poll() return read event when data are
+     * available and when client closes its socket.
+     */
+    if (ioctl(client->stream.socket, FIONREAD, &available) < 0)
+        perror("FIONREAD ioctl() failed");
+
+    if (available > 0)
+        return true;
+
+    ipc_server_close_client(ipcs, client);
+    return false;
+}
+
+#if HAVE_SYS_EPOLL_H
+/**
+ * Add a socket to the epoll instance of the server.
+ *
+ * @param ipcs      IPC server
+ * @param socket    socket to add
+ * @param client    client owning the socket or @c NULL for server socket
+ *
+ * @return Status code.
+ */
+static int
+ipc_server_poll_add(struct ipc_server *ipcs, int socket,
+                    struct ipc_server_client *client)
+{
+    struct epoll_event ev;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = client;
+    if (epoll_ctl(ipcs->poll_fd, EPOLL_CTL_ADD, socket, &ev) != 0)
+    {
+        perror("epoll_ctl() failed");
+        return TE_OS_RC(TE_IPC, errno);
+    }
+
+    return 0;
+}
+
+/**
+ * Get events from the epoll instance of the server and mark the server
+ * and clients ready.
+ *
+ * @param ipcs      IPC server
+ * @param timeout   timeout in milliseconds (-1 to wait forever)
+ *
+ * @return Number of ready sockets or -1 in the case of failure.
+ */
+static int
+ipc_server_poll(struct ipc_server *ipcs, int timeout)
+{
+    struct epoll_event          events[IPC_SERVER_POLL_EVENTS];
+    struct ipc_server_client   *client;
+    struct ipc_server_client   *next;
+    int                         n;
+    int                         i;
+    int                         ready = 0;
+
+    n = epoll_wait(ipcs->poll_fd, events, TE_ARRAY_LEN(events), timeout);
+    for (i = 0; i < n; i++)
+    {
+        client = events[i].data.ptr;
+        if (client == NULL)
+        {
+            ipcs->is_ready = true;
+            ready++;
+        }
+        else
+        {
+            client->stream.is_ready = true;
+        }
+    }
+
+    /*
+     * A client using shared memory may be reported twice (by socket
+     * and by eventfd), so clients are checked (and possibly closed)
+     * after all events are processed.
+     */
+    if (n > 0 && ipcs->conn)
+    {
+        LIST_FOREACH_SAFE(client, &ipcs->clients, links, next)
+        {
+            if (client->stream.is_ready &&
+                ipc_server_client_check_ready(ipcs, client))
+                ready++;
+        }
+    }
+
+    return (n < 0) ? -1 : ready;
+}
+#endif
+
+/* See description in ipc_server.h */
+int
+ipc_get_server_poll_fd(struct ipc_server *ipcs)
+{
+#if HAVE_SYS_EPOLL_H
+    struct ipc_server_client *client;
+
+    if (ipcs == NULL)
+        return -1;
+
+    if (ipcs->poll_fd >= 0)
+        return ipcs->poll_fd;
+
+    ipcs->poll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (ipcs->poll_fd < 0)
+    {
+        perror("epoll_create1() failed");
+        return -1;
+    }
+
+    if (ipc_server_poll_add(ipcs, ipcs->socket, NULL) != 0)
+        goto fail;
+
+    if (ipcs->conn)
+    {
+        LIST_FOREACH(client, &ipcs->clients, links)
+        {
+            if (ipc_server_poll_add(ipcs, client->stream.socket,
+                                    client) != 0)
+                goto fail;
+            if (client->stream.shm != NULL &&
+                ipc_server_poll_add(ipcs,
+                                    ipc_shm_notify_fd(client->stream.shm),
+                                    client) != 0)
+                goto fail;
+        }
+    }
+
+    return ipcs->poll_fd;
+
+fail:
+    close(ipcs->poll_fd);
+    ipcs->poll_fd = -1;
+    return -1;
+#else
+    UNUSED(ipcs);
+    return -1;
+#endif
+}
+
+/* See description in ipc_server.h */
+bool
+ipc_is_server_poll_ready(struct ipc_server *ipcs)
+{
+    struct ipc_server_client *client;
+
+    if (ipcs == NULL || ipcs->poll_fd < 0)
+        return false;
+
+#if HAVE_SYS_EPOLL_H
+    if (ipc_server_poll(ipcs, 0) > 0)
+        return true;
+#endif
+
+    /* Readiness may be left from the previous poll */
+    if (ipcs->is_ready)
+        return true;
+
+    if (ipcs->conn)
+    {
+        LIST_FOREACH(client, &ipcs->clients, links)
+        {
+            if (client->stream.is_ready)
+                return true;
+        }
+    }
+
+    return false;
+}
+
 /* See description in ipc_server.h */
 bool
 ipc_is_server_ready(struct ipc_server *ipcs, const fd_set *set, int max_fd)
@@ -398,24 +653,16 @@ ipc_is_server_ready(struct ipc_server *ipcs, const fd_set *set, int max_fd)
             {
                 client->stream.is_ready =
                     FD_ISSET(client->stream.socket, set);
-                if (client->stream.is_ready)
+                if (client->stream.shm != NULL)
                 {
-                    int available = 0;
-
-                    /*
-                     * select() returns read event when data are
-                     * available and when client closes its socket.
-                     */
+                    int fd = ipc_shm_notify_fd(client->stream.shm);
 
-                    if (ioctl(client->stream.socket, FIONREAD,
-                              &available) < 0)
-                        perror("FIONREAD ioctl() failed");
-
-                    if (available > 0)
-                        is_ready = true;
-                    else
-                        ipc_server_close_client(client, ipcs->conn);
+                    if (fd <= max_fd && FD_ISSET(fd, set))
+                        client->stream.is_ready = true;
                 }
+                if (client->stream.is_ready &&
+                    ipc_server_client_check_ready(ipcs, client))
+                    is_ready = true;
             }
         }
     }
@@ -444,6 +691,9 @@ ipc_close_server(struct ipc_server *ipcs)
     if (close(ipcs->socket) != 0)
         fprintf(stderr, "close() failed\n");
 
+    if (ipcs->poll_fd >= 0)
+        close(ipcs->poll_fd);
+
     if (ipcs->conn)
     {
         free(ipcs->stream.out_buffer);
@@ -465,7 +715,7 @@ ipc_close_server(struct ipc_server *ipcs)
     /* Free the pool */
     while ((ipcsc = LIST_FIRST(&ipcs->clients)) != NULL)
     {
-        ipc_server_close_client(ipcsc, ipcs->conn);
+        ipc_server_close_client(ipcs, ipcsc);
     }
 
     /* Free instance */
@@ -489,6 +739,71 @@ ipc_server_client_name(const struct ipc_server_client *ipcsc)
 #endif
 }
 
+/**
+ * Check whether the client is in the list of clients of the server.
+ *
+ * @param ipcs      IPC server
+ * @param ipcsc     IPC server client
+ *
+ * @return @c true if the client is found.
+ */
+static bool
+ipc_server_client_listed(const struct ipc_server *ipcs,
+                         const struct ipc_server_client *ipcsc)
+{
+    const struct ipc_server_client *client;
+
+    if (ipcs == NULL || ipcsc == NULL)
+        return false;
+
+    LIST_FOREACH(client, &ipcs->clients, links)
+    {
+        if (client == ipcsc)
+            return true;
+    }
+
+    return false;
+}
+
+/* See description in ipc_server.h */
+uint64_t
+ipc_server_client_id(const struct ipc_server_client *ipcsc)
+{
+    return (ipcsc == NULL) ? 0 : ipcsc->id;
+}
+
+/* See description in ipc_server.h */
+bool
+ipc_server_client_valid(const struct ipc_server *ipcs,
+                        const struct ipc_server_client *ipcsc, uint64_t id)
+{
+    /*
+     * The memory of a closed client may be reused for a new one,
+     * so the identifier is compared as well.
+     */
+    return ipc_server_client_listed(ipcs, ipcsc) && ipcsc->id == id;
+}
+
+/* See description in ipc_server.h */
+bool
+ipc_server_client_has_data(const struct ipc_server *ipcs,
+                           const struct ipc_server_client *ipcsc)
+{
+    int available = 0;
+
+    if (ipcs == NULL || !ipcs->conn ||
+        !ipc_server_client_listed(ipcs, ipcsc))
+        return false;
+
+    if (ipcsc->stream.shm != NULL)
+        return ipc_shm_readable(ipcsc->stream.shm);
+
+    if (ioctl(ipcsc->stream.socket, FIONREAD, &available) < 0)
+        return false;
+
+    return available > 0;
+}
+
 /* See description in ipc_server.h */
 int
 ipc_receive_message(struct ipc_server *ipcs,
@@ -507,6 +822,100 @@ ipc_send_answer(struct ipc_server *ipcs, struct ipc_server_client *ipcsc,
 }
 
 
+/* See description in ipc_server.h */
+bool
+ipc_server_can_pass_fd(const struct ipc_server *ipcs)
+{
+#ifdef TE_IPC_AF_UNIX
+    return ipcs != NULL && ipcs->conn;
+#else
+    UNUSED(ipcs);
+    return false;
+#endif
+}
+
+/* See description in ipc_server.h */
+int
+ipc_send_answer_fd(struct ipc_server *ipcs, struct ipc_server_client *ipcsc,
+                   const void *msg, size_t msg_len, int fd)
+{
+#ifdef TE_IPC_AF_UNIX
+    union {
+        struct cmsghdr  align;
+        char            buf[CMSG_SPACE(sizeof(int))];
+    } control;
+    size_t          len = msg_len;
+    uint8_t         marker = 0;
+    struct iovec    iov;
+    struct msghdr   mh;
+    struct cmsghdr *cmsg;
+    ssize_t         r;
+
+    if (!ipc_server_can_pass_fd(ipcs))
+        return TE_RC(TE_IPC, TE_EOPNOTSUPP);
+
+    if (ipcsc == NULL || fd < 0 || ((msg == NULL) != (msg_len == 0)))
+        return TE_RC(TE_IPC, TE_EINVAL);
+
+    /*
+     * The descriptor is attached to the message length or to a marker
+     * byte if the message goes via shared memory.
+     */
+    if (ipcsc->stream.shm != NULL)
+    {
+        iov.iov_base = &marker;
+        iov.iov_len = sizeof(marker);
+    }
+    else
+    {
+        iov.iov_base = &len;
+        iov.iov_len = sizeof(len);
+    }
+
+    memset(&mh, 0, sizeof(mh));
+    mh.msg_iov = &iov;
+    mh.msg_iovlen = 1;
+    mh.msg_control = control.buf;
+    mh.msg_controllen = sizeof(control.buf);
+
+    cmsg = CMSG_FIRSTHDR(&mh);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+    r = sendmsg(ipcsc->stream.socket, &mh, 0);
+    if (r < 0)
+    {
+        perror("ipc_send_answer_fd(): sendmsg() error");
+        return TE_OS_RC(TE_IPC, errno);
+    }
+
+    if (ipcsc->stream.shm != NULL)
+    {
+        len |= IPC_SHM_FD_FLAG;
+        return ipc_shm_write(ipcsc->stream.shm, &len, sizeof(len),
+                             msg, msg_len);
+    }
+
+    if ((size_t)r < sizeof(len) &&
+        write_socket(ipcsc->stream.socket, (uint8_t *)&len + r,
+                     sizeof(len) - r) != 0)
+        return TE_OS_RC(TE_IPC, errno);
+
+    return write_socket(ipcsc->stream.socket, msg, msg_len);
+#else
+    UNUSED(ipcs);
+    UNUSED(ipcsc);
+    UNUSED(msg);
+    UNUSED(msg_len);
+    UNUSED(fd);
+
+    return TE_RC(TE_IPC, TE_EOPNOTSUPP);
+#endif
+}
+
+
 /*
  * Local functions implementation
  */
@@ -756,7 +1165,10 @@ ipc_stream_server_receive(struct ipc_server *ipcs,
     assert(ipcsc != NULL);
 
     octets_to_read = MIN(*p_buf_len, ipcsc->stream.pending);
-    rc = read_socket(ipcsc->stream.socket, buf, octets_to_read);
+    if (ipcsc->stream.shm != NULL)
+        rc = ipc_shm_read(ipcsc->stream.shm, buf, octets_to_read);
+    else
+        rc = read_socket(ipcsc->stream.socket, buf, octets_to_read);
     if (rc != 0)
     {
         fprintf(stderr, "ipc_stream_server_receive(): read_socket() "
@@ -777,6 +1189,203 @@ ipc_stream_server_receive(struct ipc_server *ipcs,
     }
 }
 
+/**
+ * Read the length of the next message from a client. An offer of
+ * shared memory transport is processed here and answered.
+ *
+ * @param ipcs          IPC server
+ * @param client        IPC server client
+ *
+ * @return Status code.
+ *
+ * @retval 0            Success
+ * @retval TE_EAGAIN    Shared memory offer is processed, there is
+ *                      no message
+ * @retval errno        Other failure
+ */
+static int
+ipc_stream_read_header(struct ipc_server *ipcs,
+                       struct ipc_server_client *client)
+{
+#ifdef TE_IPC_AF_UNIX
+    union {
+        struct cmsghdr  align;
+        char            buf[CMSG_SPACE(2 * sizeof(int))];
+    } control;
+    int             fds[2] = { -1, -1 };
+    size_t          answer = 1;
+    struct iovec    iov;
+    struct msghdr   mh;
+    struct cmsghdr *cmsg;
+    ssize_t         r;
+    int             rc = 0;
+    unsigned int    i;
+
+    if (client->stream.shm != NULL)
+    {
+        return ipc_shm_read(client->stream.shm, &client->stream.pending,
+                            sizeof(client->stream.pending));
+    }
+
+    iov.iov_base = &client->stream.pending;
+    iov.iov_len = sizeof(client->stream.pending);
+
+    memset(&mh, 0, sizeof(mh));
+    mh.msg_iov = &iov;
+    mh.msg_iovlen = 1;
+    mh.msg_control = control.buf;
+    mh.msg_controllen = sizeof(control.buf);
+
+    r = recvmsg(client->stream.socket, &mh, MSG_CMSG_CLOEXEC);
+    if (r < 0)
+    {
+        perror("ipc_stream_read_header(): recvmsg() error");
+        return TE_OS_RC(TE_IPC, errno);
+    }
+    else if (r == 0)
+    {
+        return TE_RC(TE_IPC, TE_ECONNABORTED);
+    }
+
+    for (cmsg = CMSG_FIRSTHDR(&mh); cmsg != NULL;
+         cmsg = CMSG_NXTHDR(&mh, cmsg))
+    {
+        if (cmsg->cmsg_level == SOL_SOCKET &&
+            cmsg->cmsg_type == SCM_RIGHTS &&
+            cmsg->cmsg_len == CMSG_LEN(sizeof(fds)))
+        {
+            memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+        }
+    }
+
+    if ((size_t)r < sizeof(client->stream.pending))
+    {
+        rc = read_socket(client->stream.socket,
+                         (uint8_t *)&client->stream.pending + r,
+                         sizeof(client->stream.pending) - r);
+    }
+
+    if (rc == 0 && client->stream.pending == IPC_SHM_HELLO)
+    {
+        client->stream.pending = 0;
+
+        if (fds[0] >= 0 && fds[1] >= 0 && ipc_shm_enabled(true))
+        {
+            rc = ipc_shm_attach(client->stream.socket, fds[0], fds[1],
+                                &client->stream.shm);
+            fds[0] = -1;
+            if (rc == 0)
+            {
+                fds[1] = -1;
+                answer = 0;
+            }
+        }
+
+#if HAVE_SYS_EPOLL_H
+        if (answer == 0 && ipcs->poll_fd >= 0 &&
+            ipc_server_poll_add(ipcs,
+                                ipc_shm_notify_fd(client->stream.shm),
+                                client) != 0)
+        {
+            ipc_shm_free(client->stream.shm);
+            client->stream.shm = NULL;
+            answer = 1;
+        }
+#else
+        UNUSED(ipcs);
+#endif
+
+        rc = write_socket(client->stream.socket, &answer, sizeof(answer));
+        if (rc == 0)
+            rc = TE_RC(TE_IPC, TE_EAGAIN);
+    }
+
+    /* Descriptors which are not expected or not taken */
+    for (i = 0; i < TE_ARRAY_LEN(fds); i++)
+    {
+        if (fds[i] >= 0)
+            close(fds[i]);
+    }
+
+    return rc;
+#else
+    UNUSED(ipcs);
+    return read_socket(client->stream.socket, &client->stream.pending,
+                       sizeof(client->stream.pending));
+#endif
+}
+
+/**
+ * Accept a connection requested to connection-oriented server.
+ *
+ * @param ipcs      IPC server with the listening socket reported ready
+ */
+static void
+ipc_stream_accept(struct ipc_server *ipcs)
+{
+    struct ipc_server_client *client;
+
+    ipcs->is_ready = false;
+
+    client = TE_ALLOC(sizeof(*client));
+
+#ifdef TE_IPC_AF_UNIX
+    client->sa_len = sizeof(client->sa);
+#endif
+
+    client->stream.socket = accept(ipcs->socket,
+#ifdef TE_IPC_AF_UNIX
+                                   SA(&client->sa), &client->sa_len
+#else
+                                   NULL, NULL
+#endif
+                                   );
+    if (client->stream.socket < 0)
+    {
+        perror("accept() failed");
+        free(client);
+        return;
+    }
+
+    client->id = ++ipcs->last_client_id;
+    LIST_INSERT_HEAD(&ipcs->clients, client, links);
+#if HAVE_SYS_EPOLL_H
+    if (ipcs->poll_fd >= 0 &&
+        ipc_server_poll_add(ipcs, client->stream.socket, client) != 0)
+    {
+        ipc_server_close_client(ipcs, client);
+    }
+#endif
+}
+
+/* See description in ipc_server.h */
+void
+ipc_server_accept(struct ipc_server *ipcs)
+{
+    if (ipcs != NULL && ipcs->conn && ipcs->is_ready)
+        ipc_stream_accept(ipcs);
+}
+
+/* See description in ipc_server.h */
+bool
+ipc_server_clients_ready(const struct ipc_server *ipcs)
+{
+    const struct ipc_server_client *client;
+
+    if (ipcs == NULL)
+        return false;
+    if (!ipcs->conn)
+        return ipcs->is_ready;
+
+    LIST_FOREACH(client, &ipcs->clients, links)
+    {
+        if (client->stream.is_ready)
+            return true;
+    }
+
+    return false;
+}
+
 /* See description of ipc_receive_message in ipc_server.h */
 static int
 ipc_stream_receive_message(struct ipc_server *ipcs,
@@ -801,9 +1410,9 @@ ipc_stream_receive_message(struct ipc_server *ipcs,
 
         if (client->stream.pending == 0)
         {
-            rc = read_socket(client->stream.socket,
-                             &(client->stream.pending),
-                             sizeof(client->stream.pending));
+            do {
+                rc = ipc_stream_read_header(ipcs, client);
+            } while (rc == TE_RC(TE_IPC, TE_EAGAIN));
             if (rc != 0)
             {
                 if (rc != TE_RC(TE_IPC, TE_ECONNABORTED))
@@ -812,7 +1421,7 @@ ipc_stream_receive_message(struct ipc_server *ipcs,
                 }
                 else
                 {
-                    ipc_server_close_client(client, ipcs->conn);
+                    ipc_server_close_client(ipcs, client);
                     return rc;
                 }
             }
@@ -847,9 +1456,9 @@ ipc_stream_receive_message(struct ipc_server *ipcs,
                  * Let's read the length of the message and call
                  * ipc_receive_rest_message.
                  */
-                rc = read_socket(client->stream.socket,
-                                 &(client->stream.pending),
-                                 sizeof(client->stream.pending));
+                rc = ipc_stream_read_header(ipcs, client);
+                if (rc == TE_RC(TE_IPC, TE_EAGAIN))
+                    continue;
                 if (rc != 0)
                 {
                     if (rc != TE_RC(TE_IPC, TE_ECONNABORTED))
@@ -858,7 +1467,7 @@ ipc_stream_receive_message(struct ipc_server *ipcs,
                     }
                     else
                     {
-                        ipc_server_close_client(client, ipcs->conn);
+                        ipc_server_close_client(ipcs, client);
                         continue;
                     }
                 }
@@ -872,37 +1481,11 @@ ipc_stream_receive_message(struct ipc_server *ipcs,
 
         if (ipcs->is_ready)
         {
-            ipcs->is_ready = false;
-
-            /* New connection requested. Accept it */
-
-            client = TE_ALLOC(sizeof(*client));
-
-#ifdef TE_IPC_AF_UNIX
-            client->sa_len = sizeof(client->sa);
-#endif
-
-            client->stream.socket = accept(ipcs->socket,
-#ifdef TE_IPC_AF_UNIX
-                                           SA(&client->sa), &client->sa_len
-#else
-                                           NULL, NULL
-#endif
-                                    );
-            if (client->stream.socket < 0)
-            {
-                perror("accept() failed");
-                free(client);
-            }
-            else
-            {
-                LIST_INSERT_HEAD(&ipcs->clients, client, links);
-            }
-
             /*
-             * We've accepted the connection but have not receive any
+             * We accept the connection but do not receive any
              * message. So we have to repeat select.
              */
+            ipc_stream_accept(ipcs);
         }
 
         /*
@@ -910,6 +1493,18 @@ ipc_stream_receive_message(struct ipc_server *ipcs,
          *  - client tries to establish connection
          *  - client sends data via established connection
          */
+#if HAVE_SYS_EPOLL_H
+        if (ipcs->poll_fd >= 0)
+        {
+            /* Waiting forever */
+            if (ipc_server_poll(ipcs, -1) < 0)
+            {
+                perror("epoll_wait() error");
+                return TE_OS_RC(TE_IPC, errno);
+            }
+            continue;
+        }
+#endif
         FD_ZERO(&my_set);
         max_fd = ipc_get_server_fds(ipcs, &my_set);
 
@@ -940,6 +1535,12 @@ ipc_stream_send_answer(struct ipc_server *ipcs,
         return TE_RC(TE_IPC, TE_EINVAL);
     }
 
+    if (ipcsc->stream.shm != NULL)
+    {
+        return ipc_shm_write(ipcsc->stream.shm, &len, sizeof(len),
+                             msg, msg_len);
+    }
+
     if ((msg_len + sizeof(len)) > IPC_TCP_SERVER_BUFFER_SIZE)
     {
         /* Message is too long to fit into the internal buffer */
@@ -1046,6 +1647,7 @@ ipc_int_client_by_addr(struct ipc_server *ipcs,
         ipcsc->sa     = *sa_ptr;
         ipcsc->sa_len = sa_len;
         ipcsc->dgram.buffer = TE_ALLOC(IPC_SEGMENT_SIZE);
+        ipcsc->id = ++ipcs->last_client_id;
         LIST_INSERT_HEAD(&ipcs->clients, ipcsc, links);
     }
 
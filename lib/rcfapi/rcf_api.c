@@ -68,6 +68,12 @@
 /** Number of symbols for of int32_t + spaces */
 #define RCF_MAX_INT     12
 
+/**
+ * Prefix of the file name of an attachment passed by RCF as a file
+ * descriptor. The descriptor may be opened by this name in the process.
+ */
+#define RCF_ATTACHMENT_FD_PATH  "/proc/self/fd/"
+
 
 typedef struct msg_buf_entry {
     CIRCLEQ_ENTRY(msg_buf_entry) link;
@@ -179,6 +185,7 @@ rcf_message_match(rcf_msg *msg, void *opaque)
     {
         case RCFOP_TALIST:
         case RCFOP_TACHECK:
+        case RCFOP_OP_STATS:
             /* These requests do not have TA name and SID */
             return 0;
 
@@ -196,6 +203,67 @@ rcf_message_match(rcf_msg *msg, void *opaque)
     }
 }
 
+/**
+ * Release binary attachment of the answer: close the file descriptor
+ * passed by RCF or remove the file saved by RCF.
+ *
+ * @param msg           answer with binary attachment
+ *
+ * @return @c 0 on success or @c -1 on failure (errno is set).
+ */
+static int
+attachment_release(const rcf_msg *msg)
+{
+    int fd;
+
+    if (!(msg->flags & ATTACHMENT_FD))
+        return unlink(msg->file);
+
+    if (sscanf(msg->file, RCF_ATTACHMENT_FD_PATH "%d", &fd) != 1)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    return close(fd);
+}
+
+/**
+ * Bind the file descriptor passed by RCF with the answer to the answer.
+ * File name of the attachment is set to the path of the descriptor,
+ * so the attachment may be opened by its name as a regular file.
+ *
+ * @param ipcc          IPC client the answer is received by
+ * @param msg           received answer
+ */
+static void
+attachment_fd_bind(struct ipc_client *ipcc, rcf_msg *msg)
+{
+    int fd = ipc_receive_answer_fd(ipcc, RCF_SERVER);
+
+    if (!(msg->flags & ATTACHMENT_FD))
+    {
+        if (fd >= 0)
+            close(fd);
+        return;
+    }
+
+    if (fd < 0)
+    {
+        /* Failed request may be answered before a descriptor is opened */
+        if (msg->error == 0)
+        {
+            ERROR("Attachment descriptor is not passed with the answer");
+            msg->error = TE_RC(TE_RCF_API, TE_EIPC);
+        }
+        msg->flags &= ~(ATTACHMENT_FD | BINARY_ATTACHMENT);
+        msg->file[0] = '\0';
+        return;
+    }
+
+    TE_SPRINTF(msg->file, RCF_ATTACHMENT_FD_PATH "%d", fd);
+}
+
 /**
  * Clear RCF message buffer
  *
@@ -214,6 +282,8 @@ msg_buffer_clear(msg_buf_head_t *buf_head)
     while ((entry = buf_head->cqh_first) != (void *)buf_head)
     {
         CIRCLEQ_REMOVE(buf_head, entry, link);
+        if (entry->message->flags & ATTACHMENT_FD)
+            (void)attachment_release(entry->message);
         free(entry->message);
         free(entry);
     }
@@ -318,6 +388,7 @@ rcf_ipc_receive_answer(struct ipc_client *ipcc, rcf_msg *recv_msg,
             (unsigned)recv_msg->seqno, recv_msg->sid,
             rcf_op_to_string(recv_msg->opcode));
 
+        attachment_fd_bind(ipcc, recv_msg);
         if (p_answer != NULL)
             *p_answer = NULL;
         return 0;
@@ -348,6 +419,7 @@ rcf_ipc_receive_answer(struct ipc_client *ipcc, rcf_msg *recv_msg,
         return TE_RC(TE_RCF_API, TE_EIPC);
     }
 
+    attachment_fd_bind(ipcc, *p_answer);
     return 0;
 }
 
@@ -438,6 +510,44 @@ wait_rcf_ipc_message(struct ipc_client *ipcc,
 
 
 
+/**
+ * Send IPC RCF message without waiting for the answer.
+ *
+ * @param ctx             RCF client context
+ * @param send_msg        pointer to the message to be sent
+ * @param send_size       size of message to be sent
+ *
+ * @return zero on success or error code
+ */
+static te_errno
+send_rcf_ipc_message(thread_ctx_t *ctx, rcf_msg *send_buf, size_t send_size)
+{
+    te_errno rc;
+
+    send_buf->seqno = ctx->seqno++;
+
+    INFO("%s: send request %u:%d:'%s'", ipc_client_name(ctx->ipc_handle),
+         (unsigned)send_buf->seqno, send_buf->sid,
+         rcf_op_to_string(send_buf->opcode));
+
+    if ((rc = ipc_send_message(ctx->ipc_handle, RCF_SERVER,
+                               send_buf, send_size)) != 0)
+    {
+        /*
+         * Encountering EPIPE is the only way to know that RCF is down,
+         * so it is a part of normal operation. However, a message should
+         * still be printed for debugging purposes.
+         */
+        if (TE_RC_GET_ERROR(rc) == TE_EPIPE)
+            INFO("%s() failed with rc %r", __FUNCTION__, rc);
+        else
+            ERROR("%s() failed with rc %r", __FUNCTION__, rc);
+        return TE_RC(TE_RCF_API, TE_EIPC);
+    }
+
+    return 0;
+}
+
 /**
  * Send IPC RCF message and receive appropriate answer.
  * If message is too long, the memory is allocated and its address
@@ -477,26 +587,8 @@ send_recv_rcf_ipc_message(thread_ctx_t *ctx,
     match_data.sid = send_buf->sid;
     match_data.opcode = send_buf->opcode;
 
-    send_buf->seqno = ctx->seqno++;
-
-    INFO("%s: send request %u:%d:'%s'", ipc_client_name(ctx->ipc_handle),
-         (unsigned)send_buf->seqno, send_buf->sid,
-         rcf_op_to_string(send_buf->opcode));
-
-    if ((rc = ipc_send_message(ctx->ipc_handle, RCF_SERVER,
-                               send_buf, send_size)) != 0)
-    {
-        /*
-         * Encountering EPIPE is the only way to know that RCF is down,
-         * so it is a part of normal operation. However, a message should
-         * still be printed for debugging purposes.
-         */
-        if (TE_RC_GET_ERROR(rc) == TE_EPIPE)
-            INFO("%s() failed with rc %r", __FUNCTION__, rc);
-        else
-            ERROR("%s() failed with rc %r", __FUNCTION__, rc);
-        return TE_RC(TE_RCF_API, TE_EIPC);
-    }
+    if ((rc = send_rcf_ipc_message(ctx, send_buf, send_size)) != 0)
+        return rc;
 
     if ((rc = rcf_ipc_receive_answer(ctx->ipc_handle, recv_buf,
                                      recv_size, p_answer)) != 0)
@@ -1178,6 +1270,7 @@ rcf_ta_cfg_get(const char *ta_name, int session, const char *oid,
     te_strlcpy(msg.ta, ta_name, sizeof(msg.ta));
     msg.opcode = RCFOP_CONFGET;
     msg.sid = session;
+    msg.flags = ATTACHMENT_FD;
 
     rc = send_recv_rcf_ipc_message(ctx_handle, &msg, sizeof(msg),
                                    &msg, &anslen, NULL);
@@ -1209,14 +1302,15 @@ rcf_ta_cfg_get(const char *ta_name, int session, const char *oid,
             if (read(fd, &tmp, 1) != 0)
             {
                 close(fd);
-                if (unlink(msg.file) != 0)
-                    ERROR("Cannot unlink file %s saved by RCF process", msg.file);
+                if (attachment_release(&msg) != 0)
+                    ERROR("Cannot release file %s saved by RCF process",
+                          msg.file);
                 return TE_RC(TE_RCF_API, TE_ESMALLBUF);
             }
         }
         close(fd);
-        if (unlink(msg.file) != 0)
-            ERROR("Cannot unlink file %s saved by RCF process", msg.file);
+        if (attachment_release(&msg) != 0)
+            ERROR("Cannot release file %s saved by RCF process", msg.file);
     }
     else
     {
@@ -1363,6 +1457,320 @@ rcf_ta_cfg_group(const char *ta_name, int session, bool is_start)
     return rc == 0 ? msg.error : rc;
 }
 
+/** Stage of the configuration commit on a Test Agent */
+typedef enum rcf_cfg_commit_stage {
+    RCF_CFG_COMMIT_START,   /**< Group start request is in flight */
+    RCF_CFG_COMMIT_OP,      /**< Configuration change is in flight */
+    RCF_CFG_COMMIT_END,     /**< Group end request is in flight */
+    RCF_CFG_COMMIT_DONE,    /**< Commit is finished */
+} rcf_cfg_commit_stage;
+
+/** State of the configuration commit on a Test Agent */
+typedef struct rcf_cfg_commit_ta {
+    const char            *ta_name;     /**< Test Agent name */
+    rcf_cfg_commit_stage   stage;       /**< Current stage */
+    unsigned int           first;       /**< Index of the first change */
+    unsigned int           cur;         /**< Index of the current change */
+    unsigned int           last;        /**< Index of the last change */
+    te_errno               rc;          /**< Status of the group */
+} rcf_cfg_commit_ta;
+
+/** Opaque data for matching answers in rcf_ta_cfg_commit() */
+typedef struct rcf_message_match_commit {
+    const rcf_cfg_op    *ops;       /**< Configuration changes */
+    rcf_cfg_commit_ta   *tas;       /**< Test Agents states */
+    unsigned int         n_tas;     /**< Number of Test Agents */
+    unsigned int         matched;   /**< Index of the matched TA */
+} rcf_message_match_commit;
+
+/* RCF operation codes of configuration changes */
+static const rcf_op_t rcf_cfg_op_opcodes[] = {
+    [RCF_CFG_OP_ADD] = RCFOP_CONFADD,
+    [RCF_CFG_OP_SET] = RCFOP_CONFSET,
+    [RCF_CFG_OP_DEL] = RCFOP_CONFDEL,
+};
+
+/* Get operation code of the request in flight on the TA */
+static rcf_op_t
+rcf_cfg_commit_opcode(const rcf_cfg_commit_ta *ta, const rcf_cfg_op *ops)
+{
+    switch (ta->stage)
+    {
+        case RCF_CFG_COMMIT_START:
+            return RCFOP_CONFGRP_START;
+
+        case RCF_CFG_COMMIT_END:
+            return RCFOP_CONFGRP_END;
+
+        default:
+            return rcf_cfg_op_opcodes[ops[ta->cur].type];
+    }
+}
+
+/**
+ * Match an answer to one of requests in flight of rcf_ta_cfg_commit().
+ *
+ * The function complies with rcf_message_match_cb prototype.
+ */
+static int
+rcf_message_match_commit_cb(rcf_msg *msg, void *opaque)
+{
+    rcf_message_match_commit   *data = opaque;
+    unsigned int                i;
+
+    if (msg->sid != 0)
+        return 1;
+
+    for (i = 0; i < data->n_tas; i++)
+    {
+        rcf_cfg_commit_ta *ta = &data->tas[i];
+
+        if (ta->stage != RCF_CFG_COMMIT_DONE &&
+            msg->opcode == rcf_cfg_commit_opcode(ta, data->ops) &&
+            strcmp(msg->ta, ta->ta_name) == 0)
+        {
+            data->matched = i;
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * Send the request of the current stage of the configuration commit
+ * on the TA. Invalid changes are failed without sending.
+ *
+ * @param ctx           RCF client context
+ * @param ta            Test Agent commit state
+ * @param ops           configuration changes
+ *
+ * @return zero on success or error code
+ */
+static te_errno
+rcf_cfg_commit_send(thread_ctx_t *ctx, rcf_cfg_commit_ta *ta,
+                    rcf_cfg_op *ops)
+{
+    rcf_msg     msg;
+    rcf_cfg_op *op = &ops[ta->cur];
+
+    memset(&msg, 0, sizeof(msg));
+    te_strlcpy(msg.ta, ta->ta_name, sizeof(msg.ta));
+    msg.sid = 0;
+
+    if (ta->stage == RCF_CFG_COMMIT_OP)
+    {
+        if (op->oid == NULL || strlen(op->oid) >= RCF_MAX_ID ||
+            (op->val != NULL && strlen(op->val) >= RCF_MAX_VAL) ||
+            (op->val == NULL && op->type == RCF_CFG_OP_SET) ||
+            (unsigned int)op->type >= TE_ARRAY_LEN(rcf_cfg_op_opcodes))
+        {
+            op->rc = TE_RC(TE_RCF_API, TE_EINVAL);
+            ta->stage = RCF_CFG_COMMIT_END;
+        }
+        else
+        {
+            te_strlcpy(msg.id, op->oid, sizeof(msg.id));
+            if (op->type != RCF_CFG_OP_DEL && op->val != NULL)
+                te_strlcpy(msg.value, op->val, sizeof(msg.value));
+        }
+    }
+    msg.opcode = rcf_cfg_commit_opcode(ta, ops);
+
+    return send_rcf_ipc_message(ctx, &msg, sizeof(msg));
+}
+
+/* Log the configuration change if it is requested */
+static void
+rcf_cfg_commit_log(thread_ctx_t *ctx, const rcf_cfg_op *op)
+{
+    unsigned int level = op->rc == 0 ? TE_LL_RING : TE_LL_ERROR;
+
+    if (!ctx->log_cfg_changes)
+        return;
+
+    switch (op->type)
+    {
+        case RCF_CFG_OP_SET:
+            LOG_MSG(level, "Set %s to %s: %r", op->oid, op->val, op->rc);
+            break;
+
+        case RCF_CFG_OP_DEL:
+            LOG_MSG(level, "Delete %s: %r", op->oid, op->rc);
+            break;
+
+        default:
+            if (op->val == NULL || *op->val == '\0')
+                LOG_MSG(level, "Add %s: %r", op->oid, op->rc);
+            else
+                LOG_MSG(level, "Add %s with value %s: %r",
+                        op->oid, op->val, op->rc);
+            break;
+    }
+}
+
+/* See description in rcf_api.h */
+te_errno
+rcf_ta_cfg_commit(rcf_cfg_op *ops, unsigned int n_ops)
+{
+    rcf_message_match_commit    match_data;
+    rcf_cfg_commit_ta          *tas;
+    rcf_cfg_commit_ta          *ta;
+    unsigned int               *next;
+    unsigned int                n_active = 0;
+    unsigned int                i;
+    rcf_msg                     msg;
+    size_t                      anslen;
+    te_errno                    rc;
+
+    RCF_API_INIT;
+
+    if (n_ops == 0)
+        return 0;
+    if (ops == NULL)
+        return TE_RC(TE_RCF_API, TE_EWRONGPTR);
+
+    tas = TE_ALLOC(n_ops * sizeof(*tas));
+    next = TE_ALLOC(n_ops * sizeof(*next));
+
+    match_data.ops = ops;
+    match_data.tas = tas;
+    match_data.n_tas = 0;
+
+    /* Chain changes of each TA preserving their order */
+    for (i = 0; i < n_ops; i++)
+    {
+        const char   *ta_name = ops[i].ta_name;
+        unsigned int  j;
+
+        if (BAD_TA)
+        {
+            free(tas);
+            free(next);
+            return TE_RC(TE_RCF_API, TE_EINVAL);
+        }
+
+        ops[i].rc = TE_RC(TE_RCF_API, TE_ECANCELED);
+        ops[i].ta_rc = 0;
+        next[i] = n_ops;
+
+        for (j = 0; j < match_data.n_tas; j++)
+        {
+            if (strcmp(tas[j].ta_name, ta_name) == 0)
+                break;
+        }
+
+        if (j == match_data.n_tas)
+        {
+            tas[j].ta_name = ta_name;
+            tas[j].stage = RCF_CFG_COMMIT_START;
+            tas[j].first = i;
+            tas[j].cur = i;
+            match_data.n_tas++;
+        }
+        else
+        {
+            next[tas[j].last] = i;
+        }
+        tas[j].last = i;
+    }
+
+    for (i = 0; i < match_data.n_tas; i++)
+    {
+        rc = rcf_cfg_commit_send(ctx_handle, &tas[i], ops);
+        if (rc != 0)
+        {
+            tas[i].rc = rc;
+            tas[i].stage = RCF_CFG_COMMIT_DONE;
+            continue;
+        }
+        n_active++;
+    }
+
+    while (n_active > 0)
+    {
+        anslen = sizeof(msg);
+        rc = wait_rcf_ipc_message(ctx_handle->ipc_handle,
+                                  &ctx_handle->msg_buf_head,
+                                  rcf_message_match_commit_cb, &match_data,
+                                  &msg, &anslen, NULL);
+        if (rc != 0)
+        {
+            /* Results of requests in flight are unknown */
+            for (i = 0; i < match_data.n_tas; i++)
+            {
+                if (tas[i].stage != RCF_CFG_COMMIT_DONE)
+                    tas[i].rc = rc;
+            }
+            break;
+        }
+
+        ta = &tas[match_data.matched];
+        switch (ta->stage)
+        {
+            case RCF_CFG_COMMIT_START:
+                if (msg.error != 0)
+                {
+                    ERROR("Failed(%r) to start group on TA '%s'",
+                          msg.error, ta->ta_name);
+                    ta->rc = msg.error;
+                    ta->stage = RCF_CFG_COMMIT_DONE;
+                }
+                else
+                {
+                    ta->stage = RCF_CFG_COMMIT_OP;
+                }
+                break;
+
+            case RCF_CFG_COMMIT_OP:
+                ops[ta->cur].rc = msg.error;
+                rcf_cfg_commit_log(ctx_handle, &ops[ta->cur]);
+                if (msg.error != 0 || next[ta->cur] == n_ops)
+                    ta->stage = RCF_CFG_COMMIT_END;
+                else
+                    ta->cur = next[ta->cur];
+                break;
+
+            default:
+                if (msg.error != 0)
+                {
+                    ERROR("Failed(%r) to end group on TA '%s'",
+                          msg.error, ta->ta_name);
+                    ta->rc = msg.error;
+                }
+                ta->stage = RCF_CFG_COMMIT_DONE;
+                break;
+        }
+
+        if (ta->stage == RCF_CFG_COMMIT_DONE)
+        {
+            n_active--;
+            continue;
+        }
+
+        rc = rcf_cfg_commit_send(ctx_handle, ta, ops);
+        if (rc != 0)
+        {
+            ta->rc = rc;
+            ta->stage = RCF_CFG_COMMIT_DONE;
+            n_active--;
+        }
+    }
+
+    for (i = 0; i < match_data.n_tas; i++)
+    {
+        unsigned int j;
+
+        for (j = tas[i].first; j < n_ops; j = next[j])
+            ops[j].ta_rc = tas[i].rc;
+    }
+
+    free(tas);
+    free(next);
+
+    return 0;
+}
+
 
 /* See description in rcf_api.h */
 te_errno
@@ -1652,12 +2060,13 @@ rcf_ta_set_var(const char *ta_name, int session, const char *var_name,
  * @param rfile         full name of the file in the TA/NUT file system
  * @param lfile         full name of the file in the TN file system
  * @param opcode        RCFOP_FPUT, RCFOP_FGET or RCFOP_DEL
+ * @param verify        compare checksums of files after transfer
  *
  * @return error code
  */
 static te_errno
 handle_file(const char *ta_name, int session,
-            const char *rfile, const char *lfile, int opcode)
+            const char *rfile, const char *lfile, int opcode, bool verify)
 {
     rcf_msg    *msg;
     size_t      anslen = sizeof(*msg);
@@ -1711,6 +2120,8 @@ handle_file(const char *ta_name, int session,
     msg->sid = session;
     if (opcode == RCFOP_FPUT)
         msg->flags |= BINARY_ATTACHMENT;
+    if (verify)
+        msg->flags |= FILE_VERIFY;
 
     rc = send_recv_rcf_ipc_message(ctx_handle,
                                    msg, sizeof(*msg) + msg->data_len,
@@ -1732,7 +2143,15 @@ te_errno
 rcf_ta_get_file(const char *ta_name, int session,
                 const char *rfile, const char *lfile)
 {
-    return handle_file(ta_name, session, rfile, lfile, RCFOP_FGET);
+    return handle_file(ta_name, session, rfile, lfile, RCFOP_FGET, false);
+}
+
+/* See description in rcf_api.h */
+te_errno
+rcf_ta_get_file_verify(const char *ta_name, int session,
+                       const char *rfile, const char *lfile)
+{
+    return handle_file(ta_name, session, rfile, lfile, RCFOP_FGET, true);
 }
 
 /* See description in rcf_api.h */
@@ -1740,14 +2159,22 @@ te_errno
 rcf_ta_put_file(const char *ta_name, int session,
                 const char *lfile, const char *rfile)
 {
-    return handle_file(ta_name, session, rfile, lfile, RCFOP_FPUT);
+    return handle_file(ta_name, session, rfile, lfile, RCFOP_FPUT, false);
+}
+
+/* See description in rcf_api.h */
+te_errno
+rcf_ta_put_file_verify(const char *ta_name, int session,
+                       const char *lfile, const char *rfile)
+{
+    return handle_file(ta_name, session, rfile, lfile, RCFOP_FPUT, true);
 }
 
 /* See description in rcf_api.h */
 te_errno
 rcf_ta_del_file(const char *ta_name, int session, const char *rfile)
 {
-    return handle_file(ta_name, session, rfile, "", RCFOP_FDEL);
+    return handle_file(ta_name, session, rfile, "", RCFOP_FDEL, false);
 }
 
 
@@ -2101,6 +2528,12 @@ csap_tr_recv_get(const char *ta_name, int session, csap_handle_t csap_id,
     msg.opcode = opcode;
     te_strlcpy(msg.ta, ta_name, sizeof(msg.ta));
     msg.handle = csap_id;
+    /*
+     * The handler is allowed to rename the file with a packet,
+     * so packets are passed as descriptors only if there is no handler.
+     */
+    if (handler == NULL)
+        msg.flags = ATTACHMENT_FD;
 
     anslen = sizeof(msg);
     if ((rc = send_recv_rcf_ipc_message(ctx_handle, &msg, sizeof(msg),
@@ -2125,7 +2558,7 @@ csap_tr_recv_get(const char *ta_name, int session, csap_handle_t csap_id,
          * Delete temporary file if it has not be removed or renamed by
          * the handler specified by the caller.
          */
-        (void)unlink(msg.file);
+        (void)attachment_release(&msg);
 
         anslen = sizeof(msg);
         if ((rc = wait_rcf_ipc_message(ctx_handle->ipc_handle,
@@ -2954,6 +3387,82 @@ rcf_shutdown_call(void)
     return rc == 0 ? msg.error : rc;
 }
 
+/**
+ * Send RCFOP_OP_STATS request to RCF.
+ *
+ * @param flags         RCF_OP_STATS_* flags
+ * @param stats         location for the allocated array of statistics
+ *                      or @c NULL if they are not requested
+ * @param num           location for the number of entries or @c NULL
+ *
+ * @return Status code.
+ */
+static te_errno
+op_stats_request(int flags, rcf_op_stats **stats, unsigned int *num)
+{
+    rcf_msg     msg;
+    rcf_msg    *ans = NULL;
+    size_t      anslen = sizeof(msg);
+    size_t      n;
+    te_errno    rc;
+
+    RCF_API_INIT;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.opcode = RCFOP_OP_STATS;
+    msg.intparm = flags;
+
+    rc = send_recv_rcf_ipc_message(ctx_handle, &msg, sizeof(msg),
+                                   &msg, &anslen, &ans);
+    if (rc != 0)
+        return rc;
+
+    if (ans == NULL)
+        ans = &msg;
+
+    rc = ans->error;
+    if (rc == 0 && stats != NULL)
+    {
+        if (ans->data_len % sizeof(**stats) != 0 ||
+            anslen != sizeof(*ans) + ans->data_len)
+        {
+            ERROR("%s(): malformed answer", __FUNCTION__);
+            rc = TE_RC(TE_RCF_API, TE_EPROTO);
+        }
+        else
+        {
+            n = ans->data_len / sizeof(**stats);
+            *stats = TE_ALLOC((n + 1) * sizeof(**stats));
+            memcpy(*stats, ans->data, ans->data_len);
+            *num = n;
+        }
+    }
+
+    if (ans != &msg)
+        free(ans);
+
+    return rc;
+}
+
+/* See description in rcf_api.h */
+te_errno
+rcf_get_op_stats(rcf_op_stats **stats, unsigned int *num, bool reset)
+{
+    if (stats == NULL || num == NULL)
+        return TE_RC(TE_RCF_API, TE_EWRONGPTR);
+
+    return op_stats_request(RCF_OP_STATS_GET |
+                            (reset ? RCF_OP_STATS_RESET : 0), stats, num);
+}
+
+/* See description in rcf_api.h */
+te_errno
+rcf_log_op_stats(bool reset)
+{
+    return op_stats_request(RCF_OP_STATS_LOG |
+                            (reset ? RCF_OP_STATS_RESET : 0), NULL, NULL);
+}
+
 /**
  * Send/receive RCF message (should not be used directly - only for
  * implementation of RCF API functions outside this C module).
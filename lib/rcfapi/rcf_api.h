@@ -403,6 +403,53 @@ extern te_errno rcf_ta_cfg_del(const char *ta_name, int session,
 extern te_errno rcf_ta_cfg_group(const char *ta_name, int session,
                                  bool is_start);
 
+/** Type of the configuration change applied by rcf_ta_cfg_commit() */
+typedef enum rcf_cfg_op_type {
+    RCF_CFG_OP_ADD,     /**< Add an object instance */
+    RCF_CFG_OP_SET,     /**< Change an object instance value */
+    RCF_CFG_OP_DEL,     /**< Delete an object instance */
+} rcf_cfg_op_type;
+
+/** Configuration change applied by rcf_ta_cfg_commit() */
+typedef struct rcf_cfg_op {
+    const char      *ta_name;   /**< Test Agent name */
+    rcf_cfg_op_type  type;      /**< Type of the change */
+    const char      *oid;       /**< Object instance identifier */
+    const char      *val;       /**< Object instance value (may be @c NULL
+                                     for add and is ignored for delete) */
+    te_errno         rc;        /**< OUT: status of the change,
+                                     @c TE_ECANCELED if the change
+                                     is not applied since the previous
+                                     one on the same TA failed */
+    te_errno         ta_rc;     /**< OUT: status of the group of changes
+                                     on the TA (failure to start or end
+                                     the group or to interact with RCF),
+                                     the same for all changes of the TA */
+} rcf_cfg_op;
+
+/**
+ * Apply a number of configuration changes to possibly different Test
+ * Agents. Changes of each Test Agent are applied in the order of
+ * the array within a group of configuration commands (see
+ * rcf_ta_cfg_group()), a change is requested only when the previous
+ * one on the same Test Agent succeeds. Test Agents are served
+ * concurrently: requests to all of them are in flight at the same time.
+ * Session 0 is used for all requests. Failures are reported per change
+ * and per Test Agent, so a failure on one Test Agent does not affect
+ * results of the others.
+ * The function may be called by Configurator only.
+ *
+ * @param ops           array of changes
+ * @param n_ops         number of changes
+ *
+ * @return error code
+ *
+ * @retval 0            statuses of the changes and of their Test Agents
+ *                      are stored in the array
+ * @retval TE_EINVAL    invalid Test Agent name, nothing is sent
+ */
+extern te_errno rcf_ta_cfg_commit(rcf_cfg_op *ops, unsigned int n_ops);
+
 /**
  * This function is used to pull out capture logs from the sniffer. The only
  * user of this calls is Logger.
@@ -557,6 +604,24 @@ extern te_errno rcf_ta_set_var(const char *ta_name, int session,
 extern te_errno rcf_ta_get_file(const char *ta_name, int session,
                                 const char *rfile, const char *lfile);
 
+/**
+ * The same as rcf_ta_get_file(), but size and CRC-32 of the received
+ * file are compared with the ones of the file on the Test Agent
+ * after transfer.
+ *
+ * @param ta_name       Test Agent name
+ * @param session       TA session or 0
+ * @param rfile         full name of the file in the TA/NUT file system
+ * @param lfile         full name of the file in the TN file system
+ *
+ * @return error code (see rcf_ta_get_file())
+ *
+ * @retval TE_EIO           files differ
+ */
+extern te_errno rcf_ta_get_file_verify(const char *ta_name, int session,
+                                       const char *rfile,
+                                       const char *lfile);
+
 /**
  * This function loads file from the testing node to Test Agent or NUT
  * served by it.
@@ -580,6 +645,24 @@ extern te_errno rcf_ta_get_file(const char *ta_name, int session,
 extern te_errno rcf_ta_put_file(const char *ta_name, int session,
                                 const char *lfile, const char *rfile);
 
+/**
+ * The same as rcf_ta_put_file(), but size and CRC-32 of the file on
+ * the Test Agent are compared with the ones of the local file after
+ * transfer.
+ *
+ * @param ta_name       Test Agent name
+ * @param session       TA session or 0
+ * @param lfile         full name of the file in the TN file system
+ * @param rfile         full name of the file in the TA/NUT file system
+ *
+ * @return error code (see rcf_ta_put_file())
+ *
+ * @retval TE_EIO           files differ
+ */
+extern te_errno rcf_ta_put_file_verify(const char *ta_name, int session,
+                                       const char *lfile,
+                                       const char *rfile);
+
 /**
  * This function deletes file from the Test Agent or NUT served by it.
  *
@@ -1198,6 +1281,68 @@ extern te_errno rcf_foreach_ta(rcf_ta_cb *cb, void *cookie);
  */
 extern te_errno rcf_get_dead_agents(te_vec *dead_agents);
 
+/** Number of buckets in latency histograms of RCF requests */
+#define RCF_OP_STATS_BUCKETS    32
+
+/** Latency statistics of one stage of RCF requests */
+typedef struct rcf_op_hist {
+    uint64_t    count;      /**< Number of requests */
+    uint64_t    sum_ns;     /**< Total time */
+    uint64_t    min_ns;     /**< Minimum time */
+    uint64_t    max_ns;     /**< Maximum time */
+    /**
+     * Histogram of times: the first bucket counts requests shorter
+     * than 1 microsecond, the bucket @a i counts requests which take
+     * from @a 2^(i-1) to @a 2^i microseconds, the last bucket counts
+     * longer requests as well.
+     */
+    uint64_t    hist[RCF_OP_STATS_BUCKETS];
+} rcf_op_hist;
+
+/**
+ * Latency statistics of requests of one type sent by RCF to a Test
+ * Agent. Each command sent to the Test Agent is accounted, so a file
+ * transferred in chunks is accounted once per chunk.
+ */
+typedef struct rcf_op_stats {
+    char        ta[RCF_MAX_NAME];   /**< Test Agent name */
+    char        op[RCF_MAX_NAME];   /**< Operation name */
+    rcf_op_hist queue;  /**< Time spent in RCF queues before the command
+                             is sent to the Test Agent */
+    rcf_op_hist wire;   /**< Round trip time of the command excluding
+                             execution time on the Test Agent (the whole
+                             round trip time if the Test Agent does not
+                             report execution time) */
+    rcf_op_hist agent;  /**< Execution time reported by the Test Agent
+                             (it is reported for commands executed by
+                             worker threads of Portable Command Handler
+                             only, so @a count may be less than in other
+                             stages) */
+} rcf_op_stats;
+
+/**
+ * Get latency statistics of requests collected by RCF since its start
+ * or the last reset.
+ *
+ * @param[out] stats    location for the array of statistics, it should
+ *                      be released with free()
+ * @param[out] num      location for the number of entries
+ * @param[in]  reset    reset statistics after they are obtained
+ *
+ * @return Status code.
+ */
+extern te_errno rcf_get_op_stats(rcf_op_stats **stats, unsigned int *num,
+                                 bool reset);
+
+/**
+ * Ask RCF to log latency statistics of requests as an MI artifact.
+ *
+ * @param reset         reset statistics after they are logged
+ *
+ * @return Status code.
+ */
+extern te_errno rcf_log_op_stats(bool reset);
+
 /**@} <!-- END rcfapi_base --> */
 
 #ifdef __cplusplus
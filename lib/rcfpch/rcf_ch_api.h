@@ -294,6 +294,14 @@ extern int rcf_ch_vwrite(struct rcf_comm_connection *handle,
  * function returns -1, default command processing (using stdio
  * library) is  performed by caller.
  *
+ * If a file is transferred in chunks, the function is called for
+ * every chunk; the offset of the chunk (and the maximum chunk length
+ * for get) follows the file name in the command buffer. A handler
+ * which does not support chunked transfer should either return -1
+ * for all chunks of a file or reject the first one. An answer on get
+ * without the file size (i.e. "0 attach <length>") means that the
+ * whole file is passed at once and no more chunks are requested.
+ *
  * @param handle        connection handle
  * @param cbuf          command buffer
  * @param buflen        length of the command buffer
@@ -33,7 +33,7 @@
 #ifdef HAVE_SYS_TIME_H
 #include <sys/time.h>
 #endif
-#if defined(HAVE_PTHREAD_H) && defined(HAVE_PTHREAD_ATFORK)
+#if HAVE_PTHREAD_H
 #include <pthread.h>
 #endif
 
@@ -41,6 +41,8 @@
 #undef SEND_ANSWER
 
 #include "te_alloc.h"
+#include "te_queue.h"
+#include "te_dbuf.h"
 #include "te_errno.h"
 #include "te_defs.h"
 #include "te_stdint.h"
@@ -58,6 +60,7 @@
 /** Include static array with string representation of types */
 #define RCF_NEED_TYPES
 #include "te_proto.h"
+#include "te_proto_bin.h"
 #undef RCF_NEED_TYPES
 
 
@@ -451,25 +454,91 @@ rcf_pch_attach_vfork(void)
 
 
 /**
- * Start Portable Command Handler.
+ * Process a command received in binary mode and send the answer.
  *
- * @param confstr   configuration string for communication library
- * @param info      if not NULL, the string to be send to the engine
- *                  after initialisation
+ * Only configuration commands are supported in binary mode, they are
+ * executed using the configuration tree directly.
  *
- * @return Status code
+ * @param conn      connection handle
+ * @param msg       received message
+ * @param len       length of the message
+ *
+ * @return 0 or error returned by communication library
  */
-int
-rcf_pch_run(const char *confstr, const char *info)
+static te_errno
+process_bin(struct rcf_comm_connection *conn, void *msg, size_t len)
 {
-    char *cmd = NULL;
-    int   rc = 0;
-    int   sid = 0;
-    int   cmd_buf_len = RCF_MAX_LEN;
+    static te_dbuf reply = TE_DBUF_INIT(0);
+
+    rcf_bin_parser  parser;
+    uint32_t        sid = 0;
+    uint32_t        opcode = 0;
+    rcf_ch_cfg_op_t op;
+    char           *oid = NULL;
+    char           *val = NULL;
+    te_errno        rc;
+
+    rc = rcf_bin_parse_start(&parser, msg, len, &sid, &opcode);
+    if (rc == 0)
+    {
+        switch (opcode)
+        {
+            case RCFOP_CONFGRP_START:
+                op = RCF_CH_CFG_GRP_START;
+                break;
+
+            case RCFOP_CONFGRP_END:
+                op = RCF_CH_CFG_GRP_END;
+                break;
+
+            case RCFOP_CONFGET:
+                op = RCF_CH_CFG_GET;
+                rc = rcf_bin_get_str(&parser, &oid, NULL);
+                break;
+
+            case RCFOP_CONFDEL:
+                op = RCF_CH_CFG_DEL;
+                rc = rcf_bin_get_str(&parser, &oid, NULL);
+                break;
+
+            case RCFOP_CONFSET:
+            case RCFOP_CONFADD:
+                op = (opcode == RCFOP_CONFSET) ? RCF_CH_CFG_SET :
+                                                 RCF_CH_CFG_ADD;
+                rc = rcf_bin_get_str(&parser, &oid, NULL);
+                if (rc == 0)
+                    rc = rcf_bin_get_str(&parser, &val, NULL);
+                break;
+
+            default:
+                ERROR("Command %u is not supported in binary mode",
+                      opcode);
+                rc = TE_EOPNOTSUPP;
+                break;
+        }
+        if (rc == 0 && !rcf_bin_parse_end(&parser))
+            rc = TE_EFMT;
+    }
+
+    if (rc != 0)
+    {
+        if (rc == TE_EFMT)
+            ERROR("Bad binary command is received");
+        rcf_bin_start(&reply, sid, TE_RC(TE_RCF_PCH, rc));
+        rcf_bin_finish(&reply);
+    }
+    else
+    {
+        rcf_pch_configure_bin(&reply, sid, op, oid, val);
+    }
+
+    RCF_CH_LOCK;
+    rc = rcf_comm_agent_reply(conn, reply.ptr, reply.len);
+    RCF_CH_UNLOCK;
+
+    return rc;
+}
 
-    size_t   answer_plen = 0;
-    rcf_op_t opcode = 0;
-    te_errno rc2;
 
 /**
  * Read any integer parameter from the command.
@@ -510,807 +579,1320 @@ rcf_pch_run(const char *confstr, const char *info)
             goto communication_problem;                             \
     } while (false)
 
-    rcf_pch_init_id(confstr);
-
-    VERB("Starting Portable Commands Handler");
+/** Command received from the Test Engine */
+typedef struct rcf_pch_cmd {
+    TAILQ_ENTRY(rcf_pch_cmd) links;     /**< Links in the session queue */
+
+    char       *cmd;            /**< Command buffer */
+    int         cmd_buf_len;    /**< Size of the command buffer */
+    size_t      len;            /**< Length of the received command
+                                     including attachment */
+    void       *ba;             /**< Binary attachment pointer */
+    bool        bin;            /**< The command is a binary message */
+    int         sid;            /**< Session identifier */
+    size_t      answer_plen;    /**< Length of the answer prefix */
+    char       *ptr;            /**< Command arguments */
+    rcf_op_t    opcode;         /**< Operation code */
+    bool        reentrant;      /**< The handler may be executed
+                                     concurrently with other ones */
+} rcf_pch_cmd;
 
-    if (rcf_ch_init() != 0)
+/**
+ * Execute a command and send the answer.
+ *
+ * @param c         command with parsed session identifier and
+ *                  operation code
+ *
+ * @return 0 or error returned by communication library
+ */
+static int
+rcf_pch_exec(rcf_pch_cmd *c)
+{
+    char       *cmd = c->cmd;
+    int         cmd_buf_len = c->cmd_buf_len;
+    size_t      answer_plen = c->answer_plen;
+    size_t      len = c->len;
+    void       *ba = c->ba;
+    int         sid = c->sid;
+    char       *ptr = c->ptr;
+    rcf_op_t    opcode = c->opcode;
+    int         rc = 0;
+
+    if (c->bin)
+        return process_bin(conn, cmd, len);
+
+    switch (opcode)
     {
-        VERB("Initialization of CH library failed");
-        goto exit;
-    }
-    rcf_pch_cfg_init();
+        case RCFOP_REBOOT:
+        {
+            char *params = NULL;
 
-    rc = rcf_ch_tad_init();
-    if (TE_RC_GET_ERROR(rc) == TE_ENOSYS)
-    {
-        WARN("Traffic Application Domain operations are not supported");
-    }
-    else if (rc != 0)
-    {
-        ERROR("Traffic Application Domain initialization failed: %r", rc);
-        /* Continue, but TAD operation will fail */
-    }
+            if (*ptr != 0 && transform_str(&ptr, &params) != 0)
+                goto bad_protocol;
 
-    cmd = TE_ALLOC(RCF_MAX_LEN);
+            if (rcf_ch_reboot(conn, cmd, cmd_buf_len, answer_plen,
+                              ba, len, params) < 0)
+            {
+                ERROR("Reboot is NOT supported by CH");
+                SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, TE_EOPNOTSUPP));
+            }
+            break;
+        }
 
-    if ((rc = rcf_comm_agent_init(confstr, &conn)) != 0 ||
-        (info != NULL &&
-         (rc = rcf_comm_agent_reply(conn, info, strlen(info) + 1)) != 0))
-    {
-        goto communication_problem;
-    }
+        case RCFOP_CONFGRP_START:
+        case RCFOP_CONFGRP_END:
+        {
+            int op = (opcode == RCFOP_CONFGRP_START) ?
+                         RCF_CH_CFG_GRP_START : RCF_CH_CFG_GRP_END;
 
-#if defined(HAVE_PTHREAD_ATFORK)
-    pthread_atfork(NULL, NULL, rcf_pch_detach);
-#endif
-    register_vfork_hook(rcf_pch_detach_vfork, rcf_pch_attach_vfork,
-                        rcf_pch_detach);
+            if (*ptr != 0)
+                goto bad_protocol;
 
-    while (true)
-    {
-        size_t   len = cmd_buf_len;
-        char    *ptr;
-        void    *ba;         /* Binary attachment pointer */
+            rc = rcf_ch_configure(conn, cmd, cmd_buf_len, answer_plen,
+                                  ba, len, op, NULL, NULL);
 
-        answer_plen = 0;
+            if (rc < 0)
+                rc = rcf_pch_configure(conn, cmd, cmd_buf_len,
+                                       answer_plen, ba, len,
+                                       op, NULL, NULL);
 
-        if ((rc = rcf_comm_agent_wait(conn, cmd, &len, &ba)) != 0 &&
-            TE_RC_GET_ERROR(rc) != TE_EPENDING)
-            goto communication_problem;
+            if (rc != 0)
+                goto communication_problem;
+            break;
+        }
 
-        if (TE_RC_GET_ERROR(rc) == TE_EPENDING)
+        case RCFOP_CONFGET:
+        case RCFOP_CONFSET:
+        case RCFOP_CONFADD:
+        case RCFOP_CONFDEL:
         {
-            size_t tmp;
+            int op = opcode == RCFOP_CONFGET ? RCF_CH_CFG_GET :
+                     opcode == RCFOP_CONFSET ? RCF_CH_CFG_SET :
+                     opcode == RCFOP_CONFADD ? RCF_CH_CFG_ADD :
+                     RCF_CH_CFG_DEL;
+            char *oid,
+                 *val = NULL;
 
-            int received = cmd_buf_len;
-            int ba_offset = (ba == NULL) ? 0 :
-                                ((uint8_t *)ba - (uint8_t *)cmd);
+            if (*ptr == 0 || transform_str(&ptr, &oid) != 0)
+                goto bad_protocol;
 
-            char *old_cmd = cmd;
+            if (opcode == RCFOP_CONFGET || opcode == RCFOP_CONFDEL)
+            {
+                if (*ptr != 0)
+                    goto bad_protocol;
+            }
+            else if (*ptr == 0 && ba == NULL)
+            {
+                if (opcode != RCFOP_CONFADD)
+                    goto bad_protocol;
 
-            if ((cmd = realloc(cmd, len)) == NULL)
+                val = "";
+            }
+            else
             {
-                old_cmd[128] = 0;
+                if (ba == NULL &&
+                    (transform_str(&ptr, &val) != 0 || *ptr != 0))
+                    goto bad_protocol;
+            }
 
-                LOG_PRINT("Failed to allocate enough memory for command <%s>",
-                      old_cmd);
+            rc = rcf_ch_configure(conn, cmd, cmd_buf_len, answer_plen,
+                                  ba, len, op, oid, val);
 
-                free(old_cmd);
-                return -1;
-            }
-            cmd_buf_len = len;
-            tmp = len - received;
-            if (ba_offset > 0)
-                ba = (uint8_t *)cmd + ba_offset;
+            if (rc < 0)
+                rc = rcf_pch_configure(conn, cmd, cmd_buf_len,
+                                       answer_plen, ba, len,
+                                       op, oid, val);
 
-            if ((rc = rcf_comm_agent_wait(conn, cmd + received,
-                                          &tmp, NULL)) != 0)
-            {
-                LOG_PRINT("Failed to read binary attachment for command <%s>",
-                      cmd);
+            if (rc != 0)
                 goto communication_problem;
-            }
+            break;
         }
-        VERB("Command <%s> is received", cmd);
 
-        ptr = cmd;
-        /* Skipping SID */
-        if (strncmp(ptr, "SID ", strlen("SID ")) == 0)
-        {
-            ptr += strlen("SID ");
+        case RCFOP_GET_SNIF_DUMP:
+         {
+#ifndef WITH_SNIFFERS
+            SEND_ANSWER("%d sniffers off",
+                        TE_RC(TE_RCF_PCH, TE_ENOPROTOOPT));
+            break;
+#endif
+            char       *var;
+            int         rc;
 
-            READ_INT(sid);
+            if (*ptr == 0 || ba != NULL ||
+                transform_str(&ptr, &var) != 0)
+                goto bad_protocol;
 
-            answer_plen = ptr - cmd;
+            rc = rcf_ch_get_snif_dump(conn, cmd, cmd_buf_len,
+                                      answer_plen, var);
+            if (rc == TE_RC(TE_RCF_PCH, TE_ENOPROTOOPT))
+            {
+                SEND_ANSWER("%d sniffers off",
+                            TE_RC(TE_RCF_PCH, TE_ENOPROTOOPT));
+            }
+            break;
         }
 
-        if (get_opcode(&ptr, &opcode) != 0)
-            goto bad_protocol;
-
-        SKIP_SPACES(ptr);
-        switch (opcode)
+        case RCFOP_GET_SNIFFERS:
         {
-            case RCFOP_SHUTDOWN:
-                if (*ptr != 0 || ba != NULL)
-                    goto bad_protocol;
+#ifndef WITH_SNIFFERS
+            SEND_ANSWER("%d sniffers off",
+                        TE_RC(TE_RCF_PCH, TE_ENOPROTOOPT));
+            break;
+#endif
+            char       *var;
+            int         rc;
 
-                goto exit;
-                break;
+            if (*ptr == 0 || ba != NULL ||
+                transform_str(&ptr, &var) != 0)
+                goto bad_protocol;
 
-            case RCFOP_REBOOT:
+            rc = rcf_ch_get_sniffers(conn, cmd, cmd_buf_len,
+                                     answer_plen, var);
+            if (rc == TE_RC(TE_RCF_PCH, TE_ENOPROTOOPT))
             {
-                char *params = NULL;
+                SEND_ANSWER("%d sniffers off",
+                            TE_RC(TE_RCF_PCH, TE_ENOPROTOOPT));
+            }
+            break;
+        }
 
-                if (*ptr != 0 && transform_str(&ptr, &params) != 0)
-                    goto bad_protocol;
+        case RCFOP_GET_LOG:
+            if (*ptr != 0 || ba != NULL)
+                goto bad_protocol;
 
-                if (rcf_ch_reboot(conn, cmd, cmd_buf_len, answer_plen,
-                                  ba, len, params) < 0)
-                {
-                    ERROR("Reboot is NOT supported by CH");
-                    SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, TE_EOPNOTSUPP));
-                }
-                break;
-            }
+            rc = transmit_log(conn, cmd, cmd_buf_len, answer_plen);
+            if (rc != 0)
+                goto communication_problem;
 
-            case RCFOP_CONFGRP_START:
-            case RCFOP_CONFGRP_END:
-            {
-                int op = (opcode == RCFOP_CONFGRP_START) ?
-                             RCF_CH_CFG_GRP_START : RCF_CH_CFG_GRP_END;
+            break;
 
-                if (*ptr != 0)
-                    goto bad_protocol;
+        case RCFOP_VREAD:
+        case RCFOP_VWRITE:
+        {
+            char *var;
+            int   type;
 
-                rc = rcf_ch_configure(conn, cmd, cmd_buf_len, answer_plen,
-                                      ba, len, op, NULL, NULL);
+            if (*ptr == 0 || ba != NULL ||
+                transform_str(&ptr, &var) != 0)
+                goto bad_protocol;
 
-                if (rc < 0)
-                    rc = rcf_pch_configure(conn, cmd, cmd_buf_len,
-                                           answer_plen, ba, len,
-                                           op, NULL, NULL);
+            if (*ptr == 0)
+                type = RCF_STRING;
+            else
+            {
+                char *ptr0 = ptr;
 
-                if (rc != 0)
-                    goto communication_problem;
-                break;
+                if ((type = get_type(&ptr0)) == RCF_TYPE_TOTAL)
+                    type = RCF_STRING;
+                else
+                    ptr = ptr0;
             }
 
-            case RCFOP_CONFGET:
-            case RCFOP_CONFSET:
-            case RCFOP_CONFADD:
-            case RCFOP_CONFDEL:
+            if (opcode == RCFOP_VWRITE)
             {
-                int op = opcode == RCFOP_CONFGET ? RCF_CH_CFG_GET :
-                         opcode == RCFOP_CONFSET ? RCF_CH_CFG_SET :
-                         opcode == RCFOP_CONFADD ? RCF_CH_CFG_ADD :
-                         RCF_CH_CFG_DEL;
-                char *oid,
-                     *val = NULL;
-
-                if (*ptr == 0 || transform_str(&ptr, &oid) != 0)
-                    goto bad_protocol;
+                char       *val_string = NULL;
+                uint64_t    val_int = 0;
 
-                if (opcode == RCFOP_CONFGET || opcode == RCFOP_CONFDEL)
+                if (type == RCF_STRING)
                 {
-                    if (*ptr != 0)
+                    if (transform_str(&ptr, &val_string) != 0)
                         goto bad_protocol;
                 }
-                else if (*ptr == 0 && ba == NULL)
+                else
                 {
-                    if (opcode != RCFOP_CONFADD)
+                    char *tmp;
+
+                    val_int = strtoll(ptr, &tmp, 10);
+                    if (tmp == ptr || (*tmp != ' ' && *tmp != 0))
                         goto bad_protocol;
+                    ptr = tmp;
+                    SKIP_SPACES(ptr);
+                }
+                if (*ptr != 0)
+                    goto bad_protocol;
 
-                    val = "";
+                if (type == RCF_STRING)
+                {
+                    rc = rcf_ch_vwrite(conn, cmd, cmd_buf_len,
+                                       answer_plen, type, var,
+                                       val_string);
+                    if (rc < 0)
+                        rc = rcf_pch_vwrite(conn, cmd, cmd_buf_len,
+                                            answer_plen, type, var,
+                                            val_string);
                 }
                 else
                 {
-                    if (ba == NULL &&
-                        (transform_str(&ptr, &val) != 0 || *ptr != 0))
-                        goto bad_protocol;
+                    rc = rcf_ch_vwrite(conn, cmd, cmd_buf_len,
+                                       answer_plen, type, var,
+                                       val_int);
+                    if (rc < 0)
+                        rc = rcf_pch_vwrite(conn, cmd, cmd_buf_len,
+                                            answer_plen, type, var,
+                                            val_int);
                 }
-
-                rc = rcf_ch_configure(conn, cmd, cmd_buf_len, answer_plen,
-                                      ba, len, op, oid, val);
-
-                if (rc < 0)
-                    rc = rcf_pch_configure(conn, cmd, cmd_buf_len,
-                                           answer_plen, ba, len,
-                                           op, oid, val);
-
                 if (rc != 0)
                     goto communication_problem;
-                break;
             }
-
-            case RCFOP_GET_SNIF_DUMP:
-             {
-#ifndef WITH_SNIFFERS
-                SEND_ANSWER("%d sniffers off",
-                            TE_RC(TE_RCF_PCH, TE_ENOPROTOOPT));
-                break;
-#endif
-                char       *var;
-                int         rc;
-
-                if (*ptr == 0 || ba != NULL ||
-                    transform_str(&ptr, &var) != 0)
+            else
+            {
+                if (*ptr != 0)
                     goto bad_protocol;
 
-                rc = rcf_ch_get_snif_dump(conn, cmd, cmd_buf_len,
-                                          answer_plen, var);
-                if (rc == TE_RC(TE_RCF_PCH, TE_ENOPROTOOPT))
-                {
-                    SEND_ANSWER("%d sniffers off",
-                                TE_RC(TE_RCF_PCH, TE_ENOPROTOOPT));
-                }
-                break;
+                rc = rcf_ch_vread(conn, cmd, cmd_buf_len,
+                                  answer_plen, type, var);
+                if (rc < 0)
+                    rc = rcf_pch_vread(conn, cmd, cmd_buf_len,
+                                       answer_plen, type, var);
+                if (rc != 0)
+                    goto communication_problem;
             }
+            break;
+        }
 
-            case RCFOP_GET_SNIFFERS:
+        case RCFOP_FPUT:
+        case RCFOP_FGET:
+        case RCFOP_FDEL:
+        {
+            char              *filename;
+            char              *end;
+            int                put = opcode == RCFOP_FPUT;
+            bool               chunk = false;
+            unsigned long long offset = 0;
+            unsigned long      chunk_len = 0;
+
+            if (*ptr == '\0' ||
+                transform_str(&ptr, &filename) != 0 ||
+                (put != (ba != NULL)))
+                goto bad_protocol;
+
+            if (opcode == RCFOP_FGET &&
+                strcmp(ptr, TE_PROTO_FILE_CRC32) == 0)
             {
-#ifndef WITH_SNIFFERS
-                SEND_ANSWER("%d sniffers off",
-                            TE_RC(TE_RCF_PCH, TE_ENOPROTOOPT));
+                rc = rcf_pch_file_crc32(conn, cmd, cmd_buf_len,
+                                        answer_plen, filename);
+                if (rc != 0)
+                    goto communication_problem;
                 break;
-#endif
-                char       *var;
-                int         rc;
+            }
 
-                if (*ptr == 0 || ba != NULL ||
-                    transform_str(&ptr, &var) != 0)
+            /*
+             * Offset of the chunk follows the file name in chunked
+             * transfer, get command also specifies its maximum length.
+             */
+            if (*ptr != '\0' && opcode != RCFOP_FDEL)
+            {
+                offset = strtoull(ptr, &end, 10);
+                if (end == ptr)
                     goto bad_protocol;
+                ptr = end;
+                SKIP_SPACES(ptr);
 
-                rc = rcf_ch_get_sniffers(conn, cmd, cmd_buf_len,
-                                         answer_plen, var);
-                if (rc == TE_RC(TE_RCF_PCH, TE_ENOPROTOOPT))
+                if (opcode == RCFOP_FGET)
                 {
-                    SEND_ANSWER("%d sniffers off",
-                                TE_RC(TE_RCF_PCH, TE_ENOPROTOOPT));
+                    chunk_len = strtoul(ptr, &end, 10);
+                    if (end == ptr)
+                        goto bad_protocol;
+                    ptr = end;
+                    SKIP_SPACES(ptr);
                 }
-                break;
+                chunk = true;
+            }
+            if (*ptr != '\0')
+                goto bad_protocol;
+
+            /*
+             * Every chunk is offered to the custom handler, so that
+             * a transfer it has started is never continued by the
+             * default one.
+             */
+            rc = rcf_ch_file(conn, cmd, cmd_buf_len, answer_plen,
+                             ba, len, opcode, filename);
+            if (rc < 0 && chunk)
+            {
+                rc = rcf_pch_file_chunk(conn, cmd, cmd_buf_len, answer_plen,
+                                        ba, len, opcode, filename,
+                                        offset, chunk_len);
+            }
+            else if (rc < 0)
+            {
+                rc = rcf_pch_file(conn, cmd, cmd_buf_len, answer_plen,
+                                  ba, len, opcode, filename);
             }
 
-            case RCFOP_GET_LOG:
-                if (*ptr != 0 || ba != NULL)
-                    goto bad_protocol;
+            if (rc != 0)
+                goto communication_problem;
 
-                rc = transmit_log(conn, cmd, cmd_buf_len, answer_plen);
-                if (rc != 0)
-                    goto communication_problem;
+            break;
+        }
 
-                break;
+        case RCFOP_CSAP_CREATE:
+        {
+            char *params = NULL;
+            char *stack;
 
-            case RCFOP_VREAD:
-            case RCFOP_VWRITE:
-            {
-                char *var;
-                int   type;
+            if (*ptr == 0 || transform_str(&ptr, &stack) != 0)
+                goto bad_protocol;
 
-                if (*ptr == 0 || ba != NULL ||
-                    transform_str(&ptr, &var) != 0)
+            if (ba == NULL)
+            {
+                if (*ptr == 0 || transform_str(&ptr, &params) != 0 ||
+                    *ptr != 0)
                     goto bad_protocol;
+            }
+            else
+            {
+                if (*ptr != 0)
+                    goto bad_protocol;
+            }
 
-                if (*ptr == 0)
-                    type = RCF_STRING;
-                else
-                {
-                    char *ptr0 = ptr;
-
-                    if ((type = get_type(&ptr0)) == RCF_TYPE_TOTAL)
-                        type = RCF_STRING;
-                    else
-                        ptr = ptr0;
-                }
-
-                if (opcode == RCFOP_VWRITE)
-                {
-                    char       *val_string = NULL;
-                    uint64_t    val_int = 0;
+            if (rcf_ch_csap_create(conn, cmd, cmd_buf_len, answer_plen,
+                                   ba, len, stack, params) < 0)
+            {
+                ERROR("CSAP stack %s (%s) is NOT supported", stack,
+                      params);
+                SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, TE_EOPNOTSUPP));
+            }
+            break;
+        }
 
-                    if (type == RCF_STRING)
-                    {
-                        if (transform_str(&ptr, &val_string) != 0)
-                            goto bad_protocol;
-                    }
-                    else
-                    {
-                        char *tmp;
+        case RCFOP_CSAP_PARAM:
+        {
+            int handle;
+            char *var;
 
-                        val_int = strtoll(ptr, &tmp, 10);
-                        if (tmp == ptr || (*tmp != ' ' && *tmp != 0))
-                            goto bad_protocol;
-                        ptr = tmp;
-                        SKIP_SPACES(ptr);
-                    }
-                    if (*ptr != 0)
-                        goto bad_protocol;
+            if (*ptr == 0 || ba != NULL)
+                goto bad_protocol;
 
-                    if (type == RCF_STRING)
-                    {
-                        rc = rcf_ch_vwrite(conn, cmd, cmd_buf_len,
-                                           answer_plen, type, var,
-                                           val_string);
-                        if (rc < 0)
-                            rc = rcf_pch_vwrite(conn, cmd, cmd_buf_len,
-                                                answer_plen, type, var,
-                                                val_string);
-                    }
-                    else
-                    {
-                        rc = rcf_ch_vwrite(conn, cmd, cmd_buf_len,
-                                           answer_plen, type, var,
-                                           val_int);
-                        if (rc < 0)
-                            rc = rcf_pch_vwrite(conn, cmd, cmd_buf_len,
-                                                answer_plen, type, var,
-                                                val_int);
-                    }
-                    if (rc != 0)
-                        goto communication_problem;
-                }
-                else
-                {
-                    if (*ptr != 0)
-                        goto bad_protocol;
+            READ_INT(handle);
 
-                    rc = rcf_ch_vread(conn, cmd, cmd_buf_len,
-                                      answer_plen, type, var);
-                    if (rc < 0)
-                        rc = rcf_pch_vread(conn, cmd, cmd_buf_len,
-                                           answer_plen, type, var);
-                    if (rc != 0)
-                        goto communication_problem;
-                }
-                break;
-            }
+            if (*ptr == 0 || transform_str(&ptr, &var) != 0 ||
+                *ptr != 0)
+                goto bad_protocol;
 
-            case RCFOP_FPUT:
-            case RCFOP_FGET:
-            case RCFOP_FDEL:
+            if (rcf_ch_csap_param(conn, cmd, cmd_buf_len,
+                                  answer_plen, handle, var) < 0)
             {
-                char *filename;
-                int   put = opcode == RCFOP_FPUT;
+                ERROR("CSAP parameter '%s' is NOT supported",
+                                  var);
+                SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, TE_EOPNOTSUPP));
+            }
 
-                if (*ptr == '\0' ||
-                    transform_str(&ptr, &filename) != 0 ||
-                    *ptr != '\0' ||
-                    (put != (ba != NULL)))
-                    goto bad_protocol;
+            break;
+        }
 
-                rc = rcf_ch_file(conn, cmd, cmd_buf_len, answer_plen,
-                                 ba, len, opcode, filename);
-                if (rc < 0)
-                    rc = rcf_pch_file(conn, cmd, cmd_buf_len, answer_plen,
-                                      ba, len, opcode, filename);
+        case RCFOP_CSAP_DESTROY:
+        case RCFOP_TRSEND_STOP:
+        case RCFOP_TRRECV_STOP:
+        case RCFOP_TRRECV_WAIT:
+        case RCFOP_TRRECV_GET:
+        {
+            int (*rtn)(struct rcf_comm_connection *, char *,
+                       size_t, size_t, csap_handle_t) = NULL;
+            int   handle;
 
-                if (rc != 0)
-                    goto communication_problem;
+            if (*ptr == 0 || ba != NULL)
+                goto bad_protocol;
 
-                break;
-            }
+            READ_INT(handle);
+            if (*ptr != 0)
+                goto bad_protocol;
 
-            case RCFOP_CSAP_CREATE:
+            switch (opcode)
             {
-                char *params = NULL;
-                char *stack;
+                case RCFOP_CSAP_DESTROY:
+                    rtn = rcf_ch_csap_destroy;
+                    break;
 
-                if (*ptr == 0 || transform_str(&ptr, &stack) != 0)
-                    goto bad_protocol;
+                case RCFOP_TRSEND_STOP:
+                    rtn = rcf_ch_trsend_stop;
+                    break;
 
-                if (ba == NULL)
-                {
-                    if (*ptr == 0 || transform_str(&ptr, &params) != 0 ||
-                        *ptr != 0)
-                        goto bad_protocol;
-                }
-                else
-                {
-                    if (*ptr != 0)
-                        goto bad_protocol;
-                }
+                case RCFOP_TRRECV_STOP:
+                    rtn = rcf_ch_trrecv_stop;
+                    break;
 
-                if (rcf_ch_csap_create(conn, cmd, cmd_buf_len, answer_plen,
-                                       ba, len, stack, params) < 0)
-                {
-                    ERROR("CSAP stack %s (%s) is NOT supported", stack,
-                          params);
-                    SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, TE_EOPNOTSUPP));
-                }
-                break;
-            }
+                case RCFOP_TRRECV_GET:
+                    rtn = rcf_ch_trrecv_get;
+                    break;
 
-            case RCFOP_CSAP_PARAM:
-            {
-                int handle;
-                char *var;
+                case RCFOP_TRRECV_WAIT:
+                    rtn = rcf_ch_trrecv_wait;
+                    break;
 
-                if (*ptr == 0 || ba != NULL)
-                    goto bad_protocol;
+                default:
+                    assert(false);
+             }
 
-                READ_INT(handle);
+            if (rtn(conn, cmd, cmd_buf_len, answer_plen, handle) < 0)
+                SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, TE_EOPNOTSUPP));
 
-                if (*ptr == 0 || transform_str(&ptr, &var) != 0 ||
-                    *ptr != 0)
-                    goto bad_protocol;
+            break;
+        }
 
-                if (rcf_ch_csap_param(conn, cmd, cmd_buf_len,
-                                      answer_plen, handle, var) < 0)
-                {
-                    ERROR("CSAP parameter '%s' is NOT supported",
-                                      var);
-                    SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, TE_EOPNOTSUPP));
-                }
+        case RCFOP_TRPOLL:
+        case RCFOP_TRPOLL_CANCEL:
+        {
+            int (*rtn)(struct rcf_comm_connection *, char *,
+                       size_t, size_t, csap_handle_t, unsigned int);
 
-                break;
-            }
+            int   handle;
+            int   intparam;
+
+            if (*ptr == 0 || ba != NULL)
+                goto bad_protocol;
+
+            READ_INT(handle);
+            READ_INT(intparam);
+            if (*ptr != 0)
+                goto bad_protocol;
 
-            case RCFOP_CSAP_DESTROY:
-            case RCFOP_TRSEND_STOP:
-            case RCFOP_TRRECV_STOP:
-            case RCFOP_TRRECV_WAIT:
-            case RCFOP_TRRECV_GET:
+            switch (opcode)
             {
-                int (*rtn)(struct rcf_comm_connection *, char *,
-                           size_t, size_t, csap_handle_t) = NULL;
-                int   handle;
+                case RCFOP_TRPOLL:
+                    rtn = rcf_ch_trpoll;
+                    break;
 
-                if (*ptr == 0 || ba != NULL)
-                    goto bad_protocol;
+                case RCFOP_TRPOLL_CANCEL:
+                    rtn = rcf_ch_trpoll_cancel;
+                    break;
 
-                READ_INT(handle);
-                if (*ptr != 0)
-                    goto bad_protocol;
+                default:
+                    assert(false);
+                    rtn = NULL;
+             }
 
-                switch (opcode)
-                {
-                    case RCFOP_CSAP_DESTROY:
-                        rtn = rcf_ch_csap_destroy;
-                        break;
+            if (rtn(conn, cmd, cmd_buf_len, answer_plen,
+                    handle, intparam) < 0)
+                SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, TE_EOPNOTSUPP));
 
-                    case RCFOP_TRSEND_STOP:
-                        rtn = rcf_ch_trsend_stop;
-                        break;
+            break;
+        }
+
+        case RCFOP_TRSEND_START:
+        {
+            int handle;
+            int postponed = 0;
+
+            if (*ptr == 0 || ba == NULL)
+                goto bad_protocol;
+
+            READ_INT(handle);
+            if (strcmp_start("postponed", ptr) == 0)
+            {
+                postponed = 1;
+                ptr += strlen("postponed");
+                SKIP_SPACES(ptr);
+            }
+            if (*ptr != 0)
+                goto bad_protocol;
 
-                    case RCFOP_TRRECV_STOP:
-                        rtn = rcf_ch_trrecv_stop;
-                        break;
+            if (rcf_ch_trsend_start(conn, cmd, cmd_buf_len,
+                                    answer_plen, ba, len, handle,
+                                    postponed) < 0)
+            {
+                ERROR("rcf_ch_trsend_start() returns - "
+                                  "no support");
+                SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, TE_EOPNOTSUPP));
+            }
 
-                    case RCFOP_TRRECV_GET:
-                        rtn = rcf_ch_trrecv_get;
-                        break;
+            break;
+        }
 
-                    case RCFOP_TRRECV_WAIT:
-                        rtn = rcf_ch_trrecv_wait;
-                        break;
+        case RCFOP_TRRECV_START:
+        {
+            int          handle;
+            int          num = 1;
+            unsigned int timeout = TAD_TIMEOUT_INF;
+            unsigned int mode = 0;
 
-                    default:
-                        assert(false);
-                 }
+            if (*ptr == 0 || ba == NULL)
+                goto bad_protocol;
 
-                if (rtn(conn, cmd, cmd_buf_len, answer_plen, handle) < 0)
-                    SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, TE_EOPNOTSUPP));
+            READ_INT(handle);
+            READ_INT(num);
+            READ_INT(timeout);
 
-                break;
+            if (strncmp(ptr, "results", strlen("results")) == 0)
+            {
+                mode |= RCF_CH_TRRECV_PACKETS;
+                ptr += strlen("results");
+                SKIP_SPACES(ptr);
+                if (strncmp(ptr, "no-payload",
+                            strlen("no-payload")) == 0)
+                {
+                    mode |= RCF_CH_TRRECV_PACKETS_NO_PAYLOAD;
+                    ptr += strlen("no-payload");
+                    SKIP_SPACES(ptr);
+                }
             }
 
-            case RCFOP_TRPOLL:
-            case RCFOP_TRPOLL_CANCEL:
+            if (strncmp(ptr, "seq-match", strlen("seq-match")) == 0)
             {
-                int (*rtn)(struct rcf_comm_connection *, char *,
-                           size_t, size_t, csap_handle_t, unsigned int);
+                mode |= RCF_CH_TRRECV_PACKETS_SEQ_MATCH;
+                ptr += strlen("seq-match");
+                SKIP_SPACES(ptr);
+            }
 
-                int   handle;
-                int   intparam;
+            if (strncmp(ptr, "mismatch", strlen("mismatch")) == 0)
+            {
+                mode |= RCF_CH_TRRECV_MISMATCH;
+                ptr += strlen("mismatch");
+                SKIP_SPACES(ptr);
+            }
 
-                if (*ptr == 0 || ba != NULL)
-                    goto bad_protocol;
+            if (*ptr != 0)
+                goto bad_protocol;
 
-                READ_INT(handle);
-                READ_INT(intparam);
-                if (*ptr != 0)
-                    goto bad_protocol;
+            if (rcf_ch_trrecv_start(conn, cmd, cmd_buf_len,
+                                    answer_plen, ba, len, handle,
+                                    num, timeout, mode) < 0)
+            {
+                ERROR("rcf_ch_trrecv_start() returns - no support");
+                SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, TE_EOPNOTSUPP));
+            }
 
-                switch (opcode)
-                {
-                    case RCFOP_TRPOLL:
-                        rtn = rcf_ch_trpoll;
-                        break;
+            break;
+        }
 
-                    case RCFOP_TRPOLL_CANCEL:
-                        rtn = rcf_ch_trpoll_cancel;
-                        break;
+        case RCFOP_TRSEND_RECV:
+        {
+            int             handle;
+            int             timeout;
+            unsigned int    mode = 0;
 
-                    default:
-                        assert(false);
-                        rtn = NULL;
-                 }
+            if (*ptr == 0 || ba == NULL)
+                goto bad_protocol;
 
-                if (rtn(conn, cmd, cmd_buf_len, answer_plen,
-                        handle, intparam) < 0)
-                    SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, TE_EOPNOTSUPP));
+            READ_INT(handle);
+            READ_INT(timeout);
 
-                break;
+            if (strcmp_start("results", ptr) == 0)
+            {
+                mode |= RCF_CH_TRRECV_PACKETS;
+                ptr += strlen("results");
+                SKIP_SPACES(ptr);
             }
 
-            case RCFOP_TRSEND_START:
+            if (*ptr != 0)
+                goto bad_protocol;
+
+            if (rcf_ch_trsend_recv(conn, cmd, cmd_buf_len,
+                                   answer_plen, ba, len, handle,
+                                   timeout, mode) < 0)
             {
-                int handle;
-                int postponed = 0;
+                ERROR("rcf_ch_trsend_recv() returns - no support");
+                SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, TE_EOPNOTSUPP));
+            }
 
-                if (*ptr == 0 || ba == NULL)
-                    goto bad_protocol;
+            break;
+        }
 
-                READ_INT(handle);
-                if (strcmp_start("postponed", ptr) == 0)
-                {
-                    postponed = 1;
-                    ptr += strlen("postponed");
-                    SKIP_SPACES(ptr);
-                }
-                if (*ptr != 0)
-                    goto bad_protocol;
+        case RCFOP_EXECUTE:
+        {
+            void    *param[RCF_MAX_PARAMS];
+            char    *rtn;
+            int      argc;
+            bool is_argv;
+            int      priority = -1;
 
-                if (rcf_ch_trsend_start(conn, cmd, cmd_buf_len,
-                                        answer_plen, ba, len, handle,
-                                        postponed) < 0)
-                {
-                    ERROR("rcf_ch_trsend_start() returns - "
-                                      "no support");
-                    SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, TE_EOPNOTSUPP));
-                }
+            rcf_execute_mode mode;
 
-                break;
+            if (strcmp_start(TE_PROTO_FUNC " ", ptr) == 0)
+            {
+                mode = RCF_FUNC;
+                ptr += strlen(TE_PROTO_FUNC);
+            }
+            else if(strcmp_start(TE_PROTO_THREAD " ", ptr) == 0)
+            {
+                mode = RCF_THREAD;
+                ptr += strlen(TE_PROTO_THREAD);
+            }
+            else if(strcmp_start(TE_PROTO_PROCESS " ", ptr) == 0)
+            {
+                mode = RCF_PROCESS;
+                ptr += strlen(TE_PROTO_PROCESS);
+            }
+            else
+            {
+                goto bad_protocol;
             }
+            SKIP_SPACES(ptr);
 
-            case RCFOP_TRRECV_START:
+            if (*ptr == 0 || ba != NULL ||
+                transform_str(&ptr, &rtn) != 0)
             {
-                int          handle;
-                int          num = 1;
-                unsigned int timeout = TAD_TIMEOUT_INF;
-                unsigned int mode = 0;
+                goto bad_protocol;
+            }
 
-                if (*ptr == 0 || ba == NULL)
-                    goto bad_protocol;
+            if (isdigit(*ptr))
+                READ_INT(priority);
 
-                READ_INT(handle);
-                READ_INT(num);
-                READ_INT(timeout);
+            if (parse_parameters(ptr, &is_argv, &argc, param) != 0)
+            {
+                goto bad_protocol;
+            }
 
-                if (strncmp(ptr, "results", strlen("results")) == 0)
+            switch(mode)
+            {
+                case RCF_FUNC:
                 {
-                    mode |= RCF_CH_TRRECV_PACKETS;
-                    ptr += strlen("results");
-                    SKIP_SPACES(ptr);
-                    if (strncmp(ptr, "no-payload",
-                                strlen("no-payload")) == 0)
-                    {
-                        mode |= RCF_CH_TRRECV_PACKETS_NO_PAYLOAD;
-                        ptr += strlen("no-payload");
-                        SKIP_SPACES(ptr);
-                    }
+                    rc = rcf_ch_call(conn, cmd, cmd_buf_len,
+                                     answer_plen,
+                                     rtn, is_argv, argc, param);
+                    if (rc < 0)
+                        rc = rcf_pch_call(conn, cmd, cmd_buf_len,
+                                          answer_plen,
+                                          rtn, is_argv, argc, param);
+
+                    if (rc != 0)
+                        goto communication_problem;
+
+                    break;
                 }
 
-                if (strncmp(ptr, "seq-match", strlen("seq-match")) == 0)
+                case RCF_PROCESS:
                 {
-                    mode |= RCF_CH_TRRECV_PACKETS_SEQ_MATCH;
-                    ptr += strlen("seq-match");
-                    SKIP_SPACES(ptr);
+                    pid_t pid;
+
+                    if ((rc = rcf_ch_start_process(&pid, priority,
+                                                   rtn, is_argv,
+                                                   argc, param)) != 0)
+                    {
+                        SEND_ANSWER("%d", rc);
+                    }
+                    else
+                    {
+                        SEND_ANSWER("0 %ld", (long)pid);
+                    }
+
+                    break;
                 }
 
-                if (strncmp(ptr, "mismatch", strlen("mismatch")) == 0)
+                case RCF_THREAD:
                 {
-                    mode |= RCF_CH_TRRECV_MISMATCH;
-                    ptr += strlen("mismatch");
-                    SKIP_SPACES(ptr);
-                }
+                    int tid;
 
-                if (*ptr != 0)
-                    goto bad_protocol;
+                    if ((rc = rcf_ch_start_thread(&tid, priority,
+                                                  rtn, is_argv,
+                                                  argc, param)) != 0)
+                    {
+                        SEND_ANSWER("%d", rc);
+                    }
+                    else
+                    {
+                        SEND_ANSWER("0 %d", tid);
+                    }
 
-                if (rcf_ch_trrecv_start(conn, cmd, cmd_buf_len,
-                                        answer_plen, ba, len, handle,
-                                        num, timeout, mode) < 0)
-                {
-                    ERROR("rcf_ch_trrecv_start() returns - no support");
-                    SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, TE_EOPNOTSUPP));
+                    break;
                 }
 
-                break;
+                default:
+                    SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, TE_EOPNOTSUPP));
             }
+            break;
+        }
+
+        case RCFOP_RPC:
+        {
+            char    *server;
+            uint32_t timeout;
+
+            if (*ptr == 0 || transform_str(&ptr, &server) != 0)
+                goto bad_protocol;
 
-            case RCFOP_TRSEND_RECV:
+            READ_INT(timeout);
+
+            if (ba != NULL)
+            {
+                len -= ((uint8_t *)ba - (uint8_t *)cmd);
+                ptr = (char *)ba;
+            }
+            else
             {
-                int             handle;
-                int             timeout;
-                unsigned int    mode = 0;
+                /* XML */
+                char *tmp;
 
-                if (*ptr == 0 || ba == NULL)
+                if (transform_str(&ptr, &tmp) != 0)
                     goto bad_protocol;
+                ptr = tmp;
+                len = strlen(ptr);
+            }
 
-                READ_INT(handle);
-                READ_INT(timeout);
+            rc = rcf_pch_rpc(conn, sid, ptr, len, server, timeout);
 
-                if (strcmp_start("results", ptr) == 0)
-                {
-                    mode |= RCF_CH_TRRECV_PACKETS;
-                    ptr += strlen("results");
-                    SKIP_SPACES(ptr);
-                }
+            if (rc != 0)
+                 goto communication_problem;
 
-                if (*ptr != 0)
-                    goto bad_protocol;
+            break;
+        }
 
-                if (rcf_ch_trsend_recv(conn, cmd, cmd_buf_len,
-                                       answer_plen, ba, len, handle,
-                                       timeout, mode) < 0)
-                {
-                    ERROR("rcf_ch_trsend_recv() returns - no support");
-                    SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, TE_EOPNOTSUPP));
-                }
+        case RCFOP_KILL:
+        {
+            unsigned int pid;
 
-                break;
-            }
+            rcf_execute_mode mode;
 
-            case RCFOP_EXECUTE:
+            if (*ptr == 0 || ba != NULL)
+                goto bad_protocol;
+
+            if(strcmp_start(TE_PROTO_THREAD " ", ptr) == 0)
+            {
+                mode = RCF_THREAD;
+                ptr += strlen(TE_PROTO_THREAD);
+            }
+            else if(strcmp_start(TE_PROTO_PROCESS " ", ptr) == 0)
             {
-                void    *param[RCF_MAX_PARAMS];
-                char    *rtn;
-                int      argc;
-                bool is_argv;
-                int      priority = -1;
+                mode = RCF_PROCESS;
+                ptr += strlen(TE_PROTO_PROCESS);
+            }
+            else
+            {
+                goto bad_protocol;
+            }
+            SKIP_SPACES(ptr);
 
-                rcf_execute_mode mode;
+            READ_INT(pid);
+            if (*ptr != 0)
+                goto bad_protocol;
 
-                if (strcmp_start(TE_PROTO_FUNC " ", ptr) == 0)
-                {
-                    mode = RCF_FUNC;
-                    ptr += strlen(TE_PROTO_FUNC);
-                }
-                else if(strcmp_start(TE_PROTO_THREAD " ", ptr) == 0)
-                {
-                    mode = RCF_THREAD;
-                    ptr += strlen(TE_PROTO_THREAD);
-                }
-                else if(strcmp_start(TE_PROTO_PROCESS " ", ptr) == 0)
-                {
-                    mode = RCF_PROCESS;
-                    ptr += strlen(TE_PROTO_PROCESS);
-                }
-                else
-                {
-                    goto bad_protocol;
-                }
-                SKIP_SPACES(ptr);
+            if (mode == RCF_PROCESS)
+                SEND_ANSWER("%d", rcf_ch_kill_process(pid));
+            else
+                SEND_ANSWER("%d", rcf_ch_kill_thread(pid));
 
-                if (*ptr == 0 || ba != NULL ||
-                    transform_str(&ptr, &rtn) != 0)
-                {
-                    goto bad_protocol;
-                }
+            break;
+        }
 
-                if (isdigit(*ptr))
-                    READ_INT(priority);
+        default:
+            assert(false);
+    }
+    return 0;
 
-                if (parse_parameters(ptr, &is_argv, &argc, param) != 0)
-                {
-                    goto bad_protocol;
-                }
+bad_protocol:
+    ERROR("Bad protocol command <%s> is received", cmd);
+    SEND_ANSWER("%d bad command", TE_RC(TE_RCF_PCH, TE_EFMT));
+    return 0;
 
-                switch(mode)
-                {
-                    case RCF_FUNC:
-                    {
-                        rc = rcf_ch_call(conn, cmd, cmd_buf_len,
-                                         answer_plen,
-                                         rtn, is_argv, argc, param);
-                        if (rc < 0)
-                            rc = rcf_pch_call(conn, cmd, cmd_buf_len,
-                                              answer_plen,
-                                              rtn, is_argv, argc, param);
-
-                        if (rc != 0)
-                            goto communication_problem;
-
-                        break;
-                    }
+communication_problem:
+    return rc;
+}
 
-                    case RCF_PROCESS:
-                    {
-                        pid_t pid;
-
-                        if ((rc = rcf_ch_start_process(&pid, priority,
-                                                       rtn, is_argv,
-                                                       argc, param)) != 0)
-                        {
-                            SEND_ANSWER("%d", rc);
-                        }
-                        else
-                        {
-                            SEND_ANSWER("0 %ld", (long)pid);
-                        }
-
-                        break;
-                    }
+/** Default number of threads executing commands */
+#define RCF_PCH_WORKERS_DEF     4
+
+/** Maximum number of threads executing commands */
+#define RCF_PCH_WORKERS_MAX     64
+
+/** Commands of a session which are passed to workers */
+typedef struct rcf_pch_session {
+    TAILQ_ENTRY(rcf_pch_session) links; /**< Links in the list */
+    TAILQ_HEAD(, rcf_pch_cmd)    cmds;  /**< Queued commands, the first
+                                             one is executed if the
+                                             session is running */
+    int                          sid;   /**< Session identifier */
+    bool                         running; /**< A worker executes
+                                               a command of the
+                                               session */
+} rcf_pch_session;
+
+/** Worker threads */
+static pthread_t rcf_pch_workers[RCF_PCH_WORKERS_MAX];
+/** Number of started worker threads */
+static unsigned int rcf_pch_n_workers = 0;
+/** Workers should exit when all queued commands are executed */
+static bool rcf_pch_workers_stop = false;
+
+/** Sessions having commands which are queued or executed by workers */
+static TAILQ_HEAD(, rcf_pch_session) rcf_pch_sessions =
+    TAILQ_HEAD_INITIALIZER(rcf_pch_sessions);
+
+/** Lock protecting the list of sessions */
+static pthread_mutex_t rcf_pch_sessions_lock = PTHREAD_MUTEX_INITIALIZER;
+/** Signalled when a command may be taken by a worker */
+static pthread_cond_t rcf_pch_sessions_ready = PTHREAD_COND_INITIALIZER;
+/** Signalled when the list of sessions becomes empty */
+static pthread_cond_t rcf_pch_sessions_idle = PTHREAD_COND_INITIALIZER;
+
+/** Lock serializing handlers which are not reentrant */
+static pthread_mutex_t rcf_pch_serial_lock = PTHREAD_MUTEX_INITIALIZER;
 
-                    case RCF_THREAD:
-                    {
-                        int tid;
-
-                        if ((rc = rcf_ch_start_thread(&tid, priority,
-                                                      rtn, is_argv,
-                                                      argc, param)) != 0)
-                        {
-                            SEND_ANSWER("%d", rc);
-                        }
-                        else
-                        {
-                            SEND_ANSWER("0 %d", tid);
-                        }
-
-                        break;
-                    }
+/**
+ * Check whether a command should be passed to workers and whether
+ * its handler is reentrant.
+ *
+ * Configuration, variables, TAD and routine execution handlers
+ * used to be called from one thread only, so they are serialized.
+ * Sniffer and kill handlers share the lists of sniffers and processes
+ * with configuration handlers, so they are serialized with them as
+ * well. Files are accessed via private descriptors, so file handlers
+ * may run concurrently. The rest of commands are fast or asynchronous
+ * and protect their state by themselves (e.g. the log buffer is locked),
+ * they are executed by the main thread unless their session has
+ * commands passed to workers.
+ *
+ * @param c         command (reentrant flag is filled in)
+ *
+ * @return @c true if the command should be passed to workers.
+ */
+static bool
+rcf_pch_cmd_offload(rcf_pch_cmd *c)
+{
+    c->reentrant = false;
+    if (c->bin)
+        return true;
 
-                    default:
-                        SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, TE_EOPNOTSUPP));
-                }
-                break;
-            }
+    switch (c->opcode)
+    {
+        case RCFOP_FPUT:
+        case RCFOP_FGET:
+        case RCFOP_FDEL:
+            c->reentrant = true;
+            return true;
+
+        case RCFOP_CONFGRP_START:
+        case RCFOP_CONFGRP_END:
+        case RCFOP_CONFGET:
+        case RCFOP_CONFSET:
+        case RCFOP_CONFADD:
+        case RCFOP_CONFDEL:
+        case RCFOP_VREAD:
+        case RCFOP_VWRITE:
+        case RCFOP_CSAP_CREATE:
+        case RCFOP_CSAP_PARAM:
+        case RCFOP_CSAP_DESTROY:
+        case RCFOP_TRSEND_START:
+        case RCFOP_TRSEND_STOP:
+        case RCFOP_TRRECV_START:
+        case RCFOP_TRRECV_STOP:
+        case RCFOP_TRRECV_GET:
+        case RCFOP_TRRECV_WAIT:
+        case RCFOP_TRSEND_RECV:
+        case RCFOP_TRPOLL:
+        case RCFOP_TRPOLL_CANCEL:
+        case RCFOP_EXECUTE:
+        case RCFOP_GET_SNIF_DUMP:
+        case RCFOP_GET_SNIFFERS:
+        case RCFOP_KILL:
+            return true;
+
+        default:
+            c->reentrant = true;
+            return false;
+    }
+}
 
-            case RCFOP_RPC:
-            {
-                char    *server;
-                uint32_t timeout;
+/**
+ * Execute a command in a worker thread. The answer is captured and
+ * sent at once, so that it is not mixed with answers sent by other
+ * threads. The answer is preceded by a message with execution time
+ * of the command used by RCF for latency statistics. It is not sent
+ * if the answer is flushed before the command is completed.
+ *
+ * @param c         command
+ */
+static void
+rcf_pch_worker_exec(rcf_pch_cmd *c)
+{
+    te_dbuf         reply = TE_DBUF_INIT(0);
+    struct timespec start;
+    struct timespec end;
+    char            time_msg[64];
+    int             rc;
 
-                if (*ptr == 0 || transform_str(&ptr, &server) != 0)
-                    goto bad_protocol;
+    if (!c->reentrant)
+        pthread_mutex_lock(&rcf_pch_serial_lock);
 
-                READ_INT(timeout);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    rcf_comm_agent_capture(&reply);
+    rc = rcf_pch_exec(c);
+    rcf_comm_agent_capture(NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
 
-                if (ba != NULL)
-                {
-                    len -= ((uint8_t *)ba - (uint8_t *)cmd);
-                    ptr = (char *)ba;
-                }
-                else
-                {
-                    /* XML */
-                    char *tmp;
+    if (!c->reentrant)
+        pthread_mutex_unlock(&rcf_pch_serial_lock);
 
-                    if (transform_str(&ptr, &tmp) != 0)
-                        goto bad_protocol;
-                    ptr = tmp;
-                    len = strlen(ptr);
-                }
+    if (rc == 0 && reply.len > 0)
+    {
+        TE_SPRINTF(time_msg, "SID %d %s %llu", c->sid, TE_PROTO_EXEC_TIME,
+                   (unsigned long long)
+                   ((end.tv_sec - start.tv_sec) * 1000000LL +
+                    (end.tv_nsec - start.tv_nsec) / 1000));
+
+        RCF_CH_LOCK;
+        rc = rcf_comm_agent_reply(conn, time_msg, strlen(time_msg) + 1);
+        if (rc == 0)
+            rc = rcf_comm_agent_reply(conn, reply.ptr, reply.len);
+        RCF_CH_UNLOCK;
+    }
+    te_dbuf_free(&reply);
+
+    if (rc != 0)
+    {
+        ERROR("Failed to send answer in session %d: %r", c->sid, rc);
+        LOG_PRINT("Failed to send answer in session %d: %s", c->sid,
+                  te_rc_err2str(rc));
+    }
+}
 
-                rc = rcf_pch_rpc(conn, sid, ptr, len, server, timeout);
+/**
+ * Worker thread: execute commands of sessions which are not running.
+ *
+ * @param arg       unused
+ *
+ * @return @c NULL
+ */
+static void *
+rcf_pch_worker(void *arg)
+{
+    UNUSED(arg);
 
-                if (rc != 0)
-                     goto communication_problem;
+    pthread_mutex_lock(&rcf_pch_sessions_lock);
+    while (true)
+    {
+        rcf_pch_session *s;
+        rcf_pch_cmd     *c;
+
+        TAILQ_FOREACH(s, &rcf_pch_sessions, links)
+        {
+            if (!s->running)
+                break;
+        }
 
+        if (s == NULL)
+        {
+            if (rcf_pch_workers_stop)
                 break;
+
+            pthread_cond_wait(&rcf_pch_sessions_ready,
+                              &rcf_pch_sessions_lock);
+            continue;
+        }
+
+        s->running = true;
+        c = TAILQ_FIRST(&s->cmds);
+        pthread_mutex_unlock(&rcf_pch_sessions_lock);
+
+        rcf_pch_worker_exec(c);
+
+        pthread_mutex_lock(&rcf_pch_sessions_lock);
+        TAILQ_REMOVE(&s->cmds, c, links);
+        s->running = false;
+        if (TAILQ_EMPTY(&s->cmds))
+        {
+            TAILQ_REMOVE(&rcf_pch_sessions, s, links);
+            free(s);
+            if (TAILQ_EMPTY(&rcf_pch_sessions))
+                pthread_cond_broadcast(&rcf_pch_sessions_idle);
+        }
+        else
+        {
+            pthread_cond_signal(&rcf_pch_sessions_ready);
+        }
+
+        free(c->cmd);
+        free(c);
+    }
+    pthread_mutex_unlock(&rcf_pch_sessions_lock);
+
+    return NULL;
+}
+
+/**
+ * Start worker threads. Number of workers is taken from
+ * @c TE_RCF_PCH_WORKERS environment variable, zero means that all
+ * commands are executed by the main thread one by one.
+ */
+static void
+rcf_pch_workers_start(void)
+{
+    const char   *str = getenv("TE_RCF_PCH_WORKERS");
+    unsigned int  n = RCF_PCH_WORKERS_DEF;
+    int           ret;
+
+    if (str != NULL && te_strtoui(str, 0, &n) != 0)
+    {
+        WARN("Invalid TE_RCF_PCH_WORKERS value '%s', use %u",
+             str, RCF_PCH_WORKERS_DEF);
+        n = RCF_PCH_WORKERS_DEF;
+    }
+    n = MIN(n, RCF_PCH_WORKERS_MAX);
+
+    rcf_pch_workers_stop = false;
+    for (rcf_pch_n_workers = 0; rcf_pch_n_workers < n; rcf_pch_n_workers++)
+    {
+        ret = pthread_create(&rcf_pch_workers[rcf_pch_n_workers], NULL,
+                             rcf_pch_worker, NULL);
+        if (ret != 0)
+        {
+            ERROR("Failed to start command worker: %r",
+                  TE_OS_RC(TE_RCF_PCH, ret));
+            break;
+        }
+    }
+}
+
+/** Wait until workers execute all queued commands and stop them. */
+static void
+rcf_pch_workers_finish(void)
+{
+    unsigned int i;
+
+    pthread_mutex_lock(&rcf_pch_sessions_lock);
+    rcf_pch_workers_stop = true;
+    pthread_cond_broadcast(&rcf_pch_sessions_ready);
+    pthread_mutex_unlock(&rcf_pch_sessions_lock);
+
+    for (i = 0; i < rcf_pch_n_workers; i++)
+        pthread_join(rcf_pch_workers[i], NULL);
+
+    rcf_pch_n_workers = 0;
+}
+
+/** Wait until workers execute all queued commands. */
+static void
+rcf_pch_workers_wait(void)
+{
+    pthread_mutex_lock(&rcf_pch_sessions_lock);
+    while (!TAILQ_EMPTY(&rcf_pch_sessions))
+    {
+        pthread_cond_wait(&rcf_pch_sessions_idle,
+                          &rcf_pch_sessions_lock);
+    }
+    pthread_mutex_unlock(&rcf_pch_sessions_lock);
+}
+
+/**
+ * Pass a command to workers if it should be executed by them or if
+ * its session has commands queued or executed by workers (so that
+ * commands of a session are executed in order). On success
+ * the command buffer is owned by workers.
+ *
+ * @param c         command
+ *
+ * @return @c true if the command is passed to workers.
+ */
+static bool
+rcf_pch_dispatch(rcf_pch_cmd *c)
+{
+    rcf_pch_session *s;
+    rcf_pch_cmd     *job;
+    bool             offload;
+
+    if (rcf_pch_n_workers == 0)
+        return false;
+
+    offload = rcf_pch_cmd_offload(c);
+
+    pthread_mutex_lock(&rcf_pch_sessions_lock);
+    TAILQ_FOREACH(s, &rcf_pch_sessions, links)
+    {
+        if (s->sid == c->sid)
+            break;
+    }
+
+    if (s == NULL)
+    {
+        if (!offload)
+        {
+            pthread_mutex_unlock(&rcf_pch_sessions_lock);
+            return false;
+        }
+
+        s = TE_ALLOC(sizeof(*s));
+        s->sid = c->sid;
+        TAILQ_INIT(&s->cmds);
+        TAILQ_INSERT_TAIL(&rcf_pch_sessions, s, links);
+    }
+
+    job = TE_ALLOC(sizeof(*job));
+    *job = *c;
+    TAILQ_INSERT_TAIL(&s->cmds, job, links);
+    pthread_cond_signal(&rcf_pch_sessions_ready);
+    pthread_mutex_unlock(&rcf_pch_sessions_lock);
+
+    return true;
+}
+
+/**
+ * Start Portable Command Handler.
+ *
+ * @param confstr   configuration string for communication library
+ * @param info      if not NULL, the string to be send to the engine
+ *                  after initialisation
+ *
+ * @return Status code
+ */
+int
+rcf_pch_run(const char *confstr, const char *info)
+{
+    char *cmd = NULL;
+    int   rc = 0;
+    int   sid = 0;
+    int   cmd_buf_len = RCF_MAX_LEN;
+
+    size_t   answer_plen = 0;
+    rcf_op_t opcode = 0;
+    te_errno rc2;
+
+    rcf_pch_init_id(confstr);
+
+    VERB("Starting Portable Commands Handler");
+
+    if (rcf_ch_init() != 0)
+    {
+        VERB("Initialization of CH library failed");
+        goto exit;
+    }
+    rcf_pch_cfg_init();
+
+    rc = rcf_ch_tad_init();
+    if (TE_RC_GET_ERROR(rc) == TE_ENOSYS)
+    {
+        WARN("Traffic Application Domain operations are not supported");
+    }
+    else if (rc != 0)
+    {
+        ERROR("Traffic Application Domain initialization failed: %r", rc);
+        /* Continue, but TAD operation will fail */
+    }
+
+    cmd = TE_ALLOC(RCF_MAX_LEN);
+
+    if ((rc = rcf_comm_agent_init(confstr, &conn)) != 0 ||
+        (info != NULL &&
+         (rc = rcf_comm_agent_reply(conn, info, strlen(info) + 1)) != 0))
+    {
+        goto communication_problem;
+    }
+
+#if defined(HAVE_PTHREAD_ATFORK)
+    pthread_atfork(NULL, NULL, rcf_pch_detach);
+#endif
+    register_vfork_hook(rcf_pch_detach_vfork, rcf_pch_attach_vfork,
+                        rcf_pch_detach);
+    rcf_pch_workers_start();
+
+    while (true)
+    {
+        size_t   len = cmd_buf_len;
+        char    *ptr;
+        void    *ba;         /* Binary attachment pointer */
+        bool     has_sid = false;
+
+        rcf_pch_cmd c;
+
+        answer_plen = 0;
+
+        if ((rc = rcf_comm_agent_wait(conn, cmd, &len, &ba)) != 0 &&
+            TE_RC_GET_ERROR(rc) != TE_EPENDING)
+            goto communication_problem;
+
+        if (TE_RC_GET_ERROR(rc) == TE_EPENDING)
+        {
+            size_t tmp;
+
+            int received = cmd_buf_len;
+            int ba_offset = (ba == NULL) ? 0 :
+                                ((uint8_t *)ba - (uint8_t *)cmd);
+
+            char *old_cmd = cmd;
+
+            if ((cmd = realloc(cmd, len)) == NULL)
+            {
+                old_cmd[128] = 0;
+
+                LOG_PRINT("Failed to allocate enough memory for command <%s>",
+                      old_cmd);
+
+                free(old_cmd);
+                return -1;
             }
+            cmd_buf_len = len;
+            tmp = len - received;
+            if (ba_offset > 0)
+                ba = (uint8_t *)cmd + ba_offset;
 
-            case RCFOP_KILL:
+            if ((rc = rcf_comm_agent_wait(conn, cmd + received,
+                                          &tmp, NULL)) != 0)
             {
-                unsigned int pid;
+                LOG_PRINT("Failed to read binary attachment for command <%s>",
+                      cmd);
+                goto communication_problem;
+            }
+        }
 
-                rcf_execute_mode mode;
+        memset(&c, 0, sizeof(c));
+        c.cmd = cmd;
+        c.cmd_buf_len = cmd_buf_len;
+        c.len = len;
+        c.ba = ba;
 
-                if (*ptr == 0 || ba != NULL)
-                    goto bad_protocol;
+        if (rcf_bin_is_msg(cmd, len))
+        {
+            rcf_bin_parser  parser;
+            uint32_t        bin_sid = 0;
+            uint32_t        code;
+
+            /* Errors are reported when the message is processed */
+            (void)rcf_bin_parse_start(&parser, cmd, len, &bin_sid, &code);
+            c.bin = true;
+            c.sid = bin_sid;
+        }
+        else
+        {
+            VERB("Command <%s> is received", cmd);
 
-                if(strcmp_start(TE_PROTO_THREAD " ", ptr) == 0)
-                {
-                    mode = RCF_THREAD;
-                    ptr += strlen(TE_PROTO_THREAD);
-                }
-                else if(strcmp_start(TE_PROTO_PROCESS " ", ptr) == 0)
-                {
-                    mode = RCF_PROCESS;
-                    ptr += strlen(TE_PROTO_PROCESS);
-                }
-                else
-                {
-                    goto bad_protocol;
-                }
-                SKIP_SPACES(ptr);
+            ptr = cmd;
+            /* Skipping SID */
+            if (strncmp(ptr, "SID ", strlen("SID ")) == 0)
+            {
+                ptr += strlen("SID ");
 
-                READ_INT(pid);
-                if (*ptr != 0)
-                    goto bad_protocol;
+                READ_INT(sid);
 
-                if (mode == RCF_PROCESS)
-                    SEND_ANSWER("%d", rcf_ch_kill_process(pid));
-                else
-                    SEND_ANSWER("%d", rcf_ch_kill_thread(pid));
+                answer_plen = ptr - cmd;
+                has_sid = true;
+            }
 
-                break;
+            /* Binary mode negotiation: it is always supported */
+            if (strcmp(ptr, TE_PROTO_BINARY) == 0)
+            {
+                SEND_ANSWER("0");
+                continue;
             }
 
-            default:
-                assert(false);
+            if (get_opcode(&ptr, &opcode) != 0)
+                goto bad_protocol;
+
+            SKIP_SPACES(ptr);
+            if (opcode == RCFOP_SHUTDOWN)
+            {
+                if (*ptr != 0 || ba != NULL)
+                    goto bad_protocol;
+
+                goto exit;
+            }
+
+            /* Reboot is done when all other commands are completed */
+            if (opcode == RCFOP_REBOOT)
+                rcf_pch_workers_wait();
+
+            c.sid = sid;
+            c.answer_plen = answer_plen;
+            c.ptr = ptr;
+            c.opcode = opcode;
         }
+
+        if ((c.bin || has_sid) && rcf_pch_dispatch(&c))
+        {
+            cmd = TE_ALLOC(RCF_MAX_LEN);
+            cmd_buf_len = RCF_MAX_LEN;
+            continue;
+        }
+
+        if ((rc = rcf_pch_exec(&c)) != 0)
+            goto communication_problem;
         continue;
 
     bad_protocol:
@@ -1323,6 +1905,7 @@ communication_problem:
     LOG_PRINT("Fatal communication error %s", te_rc_err2str(rc));
 
 exit:
+    rcf_pch_workers_finish();
     rc2 = rcf_ch_tad_shutdown();
     if (rc2 != 0)
     {
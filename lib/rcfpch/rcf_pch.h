@@ -42,6 +42,12 @@ extern "C" {
  * Custom and default command handlers are called when commands via
  * Test Protocol are received.
  *
+ * Commands of different sessions may be executed concurrently by
+ * worker threads (@c TE_RCF_PCH_WORKERS environment variable sets
+ * number of workers, zero disables them). Commands of one session are
+ * executed in order. Configuration, variables, TAD and routine
+ * execution handlers are never called concurrently with each other.
+ *
  * @param confstr   configuration string for communication library
  * @param info      if not NULL, the string to be send to the engine
  *                  after initialisation
@@ -176,6 +182,53 @@ extern int rcf_pch_file(struct rcf_comm_connection *conn,
                         const uint8_t *ba, size_t cmdlen,
                         rcf_op_t op, const char *filename);
 
+/**
+ * Default handler of file transfer in chunks. A chunk put at zero
+ * offset truncates the file. The answer on get is
+ * "0 <file size> attach <chunk length>", the chunk is shorter than
+ * requested at the end of file.
+ *
+ * @param conn          connection handle
+ * @param cbuf          command buffer
+ * @param buflen        length of the command buffer
+ * @param answer_plen   number of bytes in the command buffer to be
+ *                      copied to the answer
+ * @param ba            pointer to the chunk to put in the command
+ *                      buffer or @c NULL for get
+ * @param cmdlen        full length of the command including binary
+ *                      attachment (the whole command should be in
+ *                      the buffer)
+ * @param op            @c RCFOP_FPUT or @c RCFOP_FGET
+ * @param filename      full name of the file in TA or NUT file system
+ * @param offset        offset of the chunk in the file
+ * @param len           maximum length of the chunk to get
+ *
+ * @return 0 or error returned by communication library
+ */
+extern int rcf_pch_file_chunk(struct rcf_comm_connection *conn,
+                              char *cbuf, size_t buflen,
+                              size_t answer_plen,
+                              const uint8_t *ba, size_t cmdlen,
+                              rcf_op_t op, const char *filename,
+                              uint64_t offset, size_t len);
+
+/**
+ * Default handler of file checksum request. The answer is
+ * "0 <file size> <CRC-32 in hex>".
+ *
+ * @param conn          connection handle
+ * @param cbuf          command buffer
+ * @param buflen        length of the command buffer
+ * @param answer_plen   number of bytes in the command buffer to be
+ *                      copied to the answer
+ * @param filename      full name of the file in TA or NUT file system
+ *
+ * @return 0 or error returned by communication library
+ */
+extern int rcf_pch_file_crc32(struct rcf_comm_connection *conn,
+                              char *cbuf, size_t buflen,
+                              size_t answer_plen, const char *filename);
+
 /**
  * Default routine call handler.
  *
@@ -57,6 +57,7 @@
 #include "te_sleep.h"
 #include "te_string.h"
 #include "cs_common.h"
+#include "te_proto_bin.h"
 
 #define OID_ETC "/..."
 
@@ -537,29 +538,20 @@ convert_to_answer(olist *list, char **answer)
 }
 
 /**
- * Process wildcard configure get request.
+ * Get the list of object or instance identifiers matching a wildcard.
  *
- * @param conn            connection handle
- * @param cbuf            command buffer
- * @param buflen          length of the command buffer
- * @param answer_plen     number of bytes in the command buffer
- *                        to be copied to the answer
- *
- * @param oid             object or instance identifier
+ * @param oid             wildcard object or instance identifier
+ * @param answer          location for the list (allocated by the routine)
  *
- *
- * @return 0 or error returned by communication library
+ * @return Status code.
  */
 static te_errno
-process_wildcard(struct rcf_comm_connection *conn, char *cbuf,
-                 size_t buflen, size_t answer_plen, const char *oid)
+wildcard_list(const char *oid, char **answer)
 {
     int    rc;
     char   copy[CFG_OID_MAX];
-    char  *tmp;
     olist *list = NULL;
 
-    ENTRY("OID='%s'", oid);
     VERB("Process wildcard request");
 
     strcpy(copy, oid);
@@ -579,15 +571,39 @@ process_wildcard(struct rcf_comm_connection *conn, char *cbuf,
 
     VERB("Wildcard processing result rc=%d list=0x%08x", rc, list);
 
-    if ((rc != 0 )|| ((rc = convert_to_answer(list, &tmp)) != 0))
-        SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, rc));
+    if (rc != 0)
+        return rc;
+
+    return convert_to_answer(list, answer);
+}
+
+/**
+ * Send the answer to wildcard configure get request.
+ *
+ * @param conn            connection handle
+ * @param cbuf            command buffer
+ * @param buflen          length of the command buffer
+ * @param answer_plen     number of bytes in the command buffer
+ *                        to be copied to the answer
+ *
+ * @param list            list of identifiers matching the wildcard
+ *                        (it is released by the routine)
+ *
+ *
+ * @return 0 or error returned by communication library
+ */
+static te_errno
+send_wildcard_list(struct rcf_comm_connection *conn, char *cbuf,
+                   size_t buflen, size_t answer_plen, char *list)
+{
+    int rc;
 
     if ((size_t)snprintf(cbuf + answer_plen, buflen - answer_plen,
                          "0 attach %u",
-                         (unsigned int)(strlen(tmp) + 1)) >=
+                         (unsigned int)(strlen(list) + 1)) >=
             (buflen - answer_plen))
     {
-        free(tmp);
+        free(list);
         ERROR("Command buffer too small for reply");
         SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, TE_E2BIG));
     }
@@ -598,12 +614,12 @@ process_wildcard(struct rcf_comm_connection *conn, char *cbuf,
          cbuf,  strlen(cbuf) + 1, rc);
     if (rc == 0)
     {
-        rc = rcf_comm_agent_reply(conn, tmp, strlen(tmp) + 1);
-        VERB("Sent binary attachment len=%u rc=%d", strlen(tmp) + 1, rc);
+        rc = rcf_comm_agent_reply(conn, list, strlen(list) + 1);
+        VERB("Sent binary attachment len=%u rc=%d", strlen(list) + 1, rc);
     }
     RCF_CH_UNLOCK;
 
-    free(tmp);
+    free(list);
 
     return rc;
 }
@@ -943,12 +959,23 @@ out:
     return rc;
 }
 
-/* See description in rcf_pch.h */
-int
-rcf_pch_configure(struct rcf_comm_connection *conn,
-                  char *cbuf, size_t buflen, size_t answer_plen,
-                  const uint8_t *ba, size_t cmdlen,
-                  rcf_ch_cfg_op_t op, const char *oid, const char *val)
+/**
+ * Execute configuration operation.
+ *
+ * @param op        configuration operation
+ * @param oid       object or instance identifier
+ * @param val       value to set or add
+ * @param value     location for the value got (RCF_MAX_VAL bytes);
+ *                  it is left empty if no value is provided
+ * @param list      location for the list of identifiers matching
+ *                  a wildcard (allocated by the routine), it is set
+ *                  in get requests with wildcards only
+ *
+ * @return Status code to be sent in the answer.
+ */
+static te_errno
+configure_op(rcf_ch_cfg_op_t op, const char *oid, const char *val,
+             char *value, char **list)
 {
 /** All instance names */
 #define ALL_INST_NAMES \
@@ -967,13 +994,13 @@ rcf_pch_configure(struct rcf_comm_connection *conn,
     unsigned int        i;
     int                 rc;
 
-    UNUSED(ba);
-    UNUSED(cmdlen);
-
     ENTRY("op=%d id='%s' val='%s'", op, (oid == NULL) ? "NULL" : oid,
                                         (val == NULL) ? "NULL" : val);
     VERB("Default configuration handler is executed");
 
+    *value = '\0';
+    *list = NULL;
+
     if (oid != 0)
     {
         /* Now parse the oid and look for the object */
@@ -982,14 +1009,14 @@ rcf_pch_configure(struct rcf_comm_connection *conn,
             if (op != RCF_CH_CFG_GET)
             {
                 ERROR("Wildcards allowed in get requests only");
-                SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, TE_EINVAL));
+                return TE_RC(TE_RCF_PCH, TE_EINVAL);
             }
 
-            rc = process_wildcard(conn, cbuf, buflen, answer_plen, oid);
+            rc = wildcard_list(oid, list);
 
             EXIT("%r", rc);
 
-            return rc;
+            return TE_RC(TE_RCF_PCH, rc);
         }
 
         p_oid = cfg_convert_oid_str(oid);
@@ -998,7 +1025,7 @@ rcf_pch_configure(struct rcf_comm_connection *conn,
             /* It may be memory allocation failure, but it's unlikely */
             ERROR("Failed to convert OID string '%s' to structured "
                   "representation", oid);
-            SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, TE_EFMT));
+            return TE_RC(TE_RCF_PCH, TE_EFMT);
         }
         VERB("Parsed %s ID with %u parts ptr=0x%x",
              (p_oid->inst) ? "instance" : "object",
@@ -1007,13 +1034,13 @@ rcf_pch_configure(struct rcf_comm_connection *conn,
         {
             cfg_free_oid(p_oid);
             ERROR("Instance identifier expected");
-            SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, TE_EINVAL));
+            return TE_RC(TE_RCF_PCH, TE_EINVAL);
         }
         if (p_oid->len == 0)
         {
             cfg_free_oid(p_oid);
             ERROR("Zero length OID");
-            SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, TE_EINVAL));
+            return TE_RC(TE_RCF_PCH, TE_EINVAL);
         }
 
         memset(inst_names, 0, sizeof(inst_names));
@@ -1051,7 +1078,7 @@ rcf_pch_configure(struct rcf_comm_connection *conn,
         {
             cfg_free_oid(p_oid);
             VERB("Requested OID not found");
-            SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, TE_ENOENT));
+            return TE_RC(TE_RCF_PCH, TE_ENOENT);
         }
     }
 
@@ -1069,31 +1096,26 @@ rcf_pch_configure(struct rcf_comm_connection *conn,
         case RCF_CH_CFG_GRP_START:
             VERB("Configuration group %u start", gid);
             is_group = true;
-            SEND_ANSWER("0");
-            break;
+            return 0;
 
         case RCF_CH_CFG_GRP_END:
             VERB("Configuration group %u end", gid);
             is_group = false;
-            SEND_ANSWER("%d", commit_all_postponed());
-            break;
+            return commit_all_postponed();
 
         case RCF_CH_CFG_GET:
-        {
-            char value[RCF_MAX_VAL] = "";
-            char ret_val[RCF_MAX_VAL * 2 + 2];
-
             if (obj->get == NULL)
             {
                 cfg_free_oid(p_oid);
-                SEND_ANSWER("0");
+                return 0;
             }
 
             rc = (obj->get)(gid, oid, value, ALL_INST_NAMES);
             if (rc != 0)
             {
+                *value = '\0';
                 cfg_free_oid(p_oid);
-                SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, rc));
+                return TE_RC(TE_RCF_PCH, rc);
             }
 
             if (obj->subst != NULL)
@@ -1102,16 +1124,14 @@ rcf_pch_configure(struct rcf_comm_connection *conn,
                 if (rc != 0)
                 {
                     ERROR("Failed to replace value in %s rc=%r", value, rc);
+                    *value = '\0';
                     cfg_free_oid(p_oid);
-                    SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, rc));
+                    return TE_RC(TE_RCF_PCH, rc);
                 }
             }
 
             cfg_free_oid(p_oid);
-            write_str_in_quotes(ret_val, value, RCF_MAX_VAL);
-            SEND_ANSWER("0 %s", ret_val);
-            break;
-        }
+            return 0;
 
         case RCF_CH_CFG_SET:
             rc = (obj->set == NULL) ? TE_EOPNOTSUPP :
@@ -1121,8 +1141,7 @@ rcf_pch_configure(struct rcf_comm_connection *conn,
                 rc = commit(commit_obj, &p_oid);
             }
             cfg_free_oid(p_oid);
-            SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, rc));
-            break;
+            return TE_RC(TE_RCF_PCH, rc);
 
         case RCF_CH_CFG_ADD:
             rc = (obj->add == NULL) ? TE_EOPNOTSUPP :
@@ -1132,8 +1151,7 @@ rcf_pch_configure(struct rcf_comm_connection *conn,
                 rc = commit(commit_obj, &p_oid);
             }
             cfg_free_oid(p_oid);
-            SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, rc));
-            break;
+            return TE_RC(TE_RCF_PCH, rc);
 
         case RCF_CH_CFG_DEL:
             rc = (obj->del == NULL) ? TE_EOPNOTSUPP :
@@ -1143,22 +1161,71 @@ rcf_pch_configure(struct rcf_comm_connection *conn,
                 rc = commit(commit_obj, &p_oid);
             }
             cfg_free_oid(p_oid);
-            SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, rc));
-            break;
+            return TE_RC(TE_RCF_PCH, rc);
 
         default:
             ERROR("Unknown configure operation: op=%d id='%s' val='%s'",
                   op, oid, val);
-            SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, TE_EINVAL));
+            cfg_free_oid(p_oid);
+            return TE_RC(TE_RCF_PCH, TE_EINVAL);
     }
 
-    /* Unreachable */
-    assert(false);
-    return 0;
-
 #undef ALL_INST_NAMES
 }
 
+/* See description in rcf_pch.h */
+int
+rcf_pch_configure(struct rcf_comm_connection *conn,
+                  char *cbuf, size_t buflen, size_t answer_plen,
+                  const uint8_t *ba, size_t cmdlen,
+                  rcf_ch_cfg_op_t op, const char *oid, const char *val)
+{
+    char        value[RCF_MAX_VAL];
+    char        ret_val[RCF_MAX_VAL * 2 + 2];
+    char       *list;
+    te_errno    rc;
+
+    UNUSED(ba);
+    UNUSED(cmdlen);
+
+    rc = configure_op(op, oid, val, value, &list);
+    if (rc != 0 || op != RCF_CH_CFG_GET)
+        SEND_ANSWER("%d", rc);
+
+    if (list != NULL)
+        return send_wildcard_list(conn, cbuf, buflen, answer_plen, list);
+
+    write_str_in_quotes(ret_val, value, RCF_MAX_VAL);
+    SEND_ANSWER("0 %s", ret_val);
+}
+
+/* See description in rcf_pch_internal.h */
+void
+rcf_pch_configure_bin(te_dbuf *reply, uint32_t sid, rcf_ch_cfg_op_t op,
+                      const char *oid, const char *val)
+{
+    char        value[RCF_MAX_VAL];
+    char       *list;
+    te_errno    rc;
+
+    rc = configure_op(op, oid, val, value, &list);
+
+    rcf_bin_start(reply, sid, rc);
+    if (rc == 0 && op == RCF_CH_CFG_GET)
+    {
+        if (list != NULL)
+        {
+            rcf_bin_put_str(reply, list, strlen(list));
+            free(list);
+        }
+        else
+        {
+            rcf_bin_put_str(reply, value, strlen(value));
+        }
+    }
+    rcf_bin_finish(reply);
+}
+
 /* See description in rcf_pch.h */
 te_errno
 rcf_pch_find_node(const char *oid_str, rcf_pch_cfg_object **node)
@@ -41,6 +41,7 @@
 #include "te_errno.h"
 #include "te_defs.h"
 #include "te_stdint.h"
+#include "te_file.h"
 #include "comm_agent.h"
 #include "agentlib.h"
 #include "rcf_pch.h"
@@ -197,3 +198,122 @@ reject:
     SEND_ANSWER("%d", rc);
     /* Unreachable */
 }
+
+/* See description in rcf_pch.h */
+int
+rcf_pch_file_chunk(struct rcf_comm_connection *conn, char *cbuf,
+                   size_t buflen, size_t answer_plen, const uint8_t *ba,
+                   size_t cmdlen, rcf_op_t op, const char *filename,
+                   uint64_t offset, size_t len)
+{
+    struct stat stat_buf;
+    int         rc;
+    int         fd;
+
+    ENTRY("filename=%s op=%d offset=%llu len=%u", filename, op,
+          (unsigned long long)offset, len);
+
+    if (op == RCFOP_FPUT)
+    {
+        const uint8_t *data = ba;
+        size_t         rest = cmdlen - (ba - (uint8_t *)cbuf);
+        ssize_t        res;
+
+        /*
+         * The chunk is already in the command buffer, so it is
+         * written as is instead of splicing it from the connection.
+         */
+        fd = open(filename, O_WRONLY | O_CREAT | (offset == 0 ? O_TRUNC : 0),
+                  S_IRWXU | S_IRWXG | S_IRWXO);
+        if (fd < 0)
+        {
+            rc = TE_OS_RC(TE_RCF_PCH, errno);
+            SEND_ANSWER("%d", rc);
+        }
+
+        while (rest > 0)
+        {
+            res = pwrite(fd, data, rest, offset);
+            if (res <= 0)
+            {
+                rc = TE_OS_RC(TE_RCF_PCH, res < 0 ? errno : ENOSPC);
+                ERROR("Failed to write to file '%s': %r", filename, rc);
+                close(fd);
+                SEND_ANSWER("%d", rc);
+            }
+            data += res;
+            rest -= res;
+            offset += res;
+        }
+        close(fd);
+        SEND_ANSWER("0");
+    }
+
+    fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        rc = TE_OS_RC(TE_RCF_PCH, errno);
+        SEND_ANSWER("%d", rc);
+    }
+    if (fstat(fd, &stat_buf) != 0)
+    {
+        rc = TE_OS_RC(TE_RCF_PCH, errno);
+        ERROR("fstat() failed %r", rc);
+        close(fd);
+        SEND_ANSWER("%d", rc);
+    }
+
+    if ((uint64_t)stat_buf.st_size <= offset)
+        len = 0;
+    else if ((uint64_t)stat_buf.st_size - offset < len)
+        len = stat_buf.st_size - offset;
+
+    if ((size_t)snprintf(cbuf + answer_plen, buflen - answer_plen,
+                         "0 %llu attach %u",
+                         (unsigned long long)stat_buf.st_size,
+                         (unsigned int)len) >= buflen - answer_plen)
+    {
+        ERROR("Command buffer too small for reply");
+        close(fd);
+        SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, TE_E2BIG));
+    }
+
+    /* Header and data must not be mixed with answers of other threads */
+    RCF_CH_LOCK;
+    rc = rcf_comm_agent_reply(conn, cbuf, strlen(cbuf) + 1);
+    if (rc == 0)
+        rc = rcf_comm_agent_reply_file(conn, fd, offset, len);
+    RCF_CH_UNLOCK;
+    close(fd);
+
+    if (rc != 0)
+        ERROR("Failed to send chunk of file '%s': %r", filename, rc);
+
+    EXIT("%r", rc);
+    return rc;
+}
+
+/* See description in rcf_pch.h */
+int
+rcf_pch_file_crc32(struct rcf_comm_connection *conn, char *cbuf,
+                   size_t buflen, size_t answer_plen, const char *filename)
+{
+    uint64_t size;
+    uint32_t crc;
+    int      rc;
+    int      fd;
+
+    fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        rc = TE_OS_RC(TE_RCF_PCH, errno);
+        SEND_ANSWER("%d", rc);
+    }
+
+    rc = te_file_crc32(fd, &size, &crc);
+    close(fd);
+    if (rc != 0)
+        SEND_ANSWER("%d", TE_RC(TE_RCF_PCH, rc));
+
+    SEND_ANSWER("0 %llu %08x", (unsigned long long)size, crc);
+}
@@ -21,6 +21,7 @@
 #include "comm_agent.h"
 #include "rcf_ch_api.h"
 #include "logger_api.h"
+#include "te_dbuf.h"
 
 /**
  * Size of the log data sent in one request.
@@ -95,6 +96,20 @@ extern "C" {
  */
 extern void write_str_in_quotes(char *dst, const char *src, size_t len);
 
+/**
+ * Execute configuration command received in binary mode using
+ * the configuration tree and build the binary answer.
+ *
+ * @param reply     buffer for the answer
+ * @param sid       session identifier
+ * @param op        configuration operation
+ * @param oid       object or instance identifier
+ * @param val       value to set or add (@c NULL for other operations)
+ */
+extern void rcf_pch_configure_bin(te_dbuf *reply, uint32_t sid,
+                                  rcf_ch_cfg_op_t op, const char *oid,
+                                  const char *val);
+
 /*
  * When ANSI C compiler mode is enabled, the following functions are
  * missing in standard headers 'string.h' and 'stdlib.h'.
@@ -39,6 +39,18 @@
 #if HAVE_SIGNAL_H
 #include <signal.h>
 #endif
+#if HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#if HAVE_SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+#if HAVE_NETINET_IN_H
+#include <netinet/in.h>
+#endif
+#if HAVE_NETINET_TCP_H
+#include <netinet/tcp.h>
+#endif
 
 #include "rcf_pch_internal.h"
 
@@ -71,6 +83,24 @@
  */
 #define WAITPID_DELAY 1
 
+/** Length of the token authenticating direct connection from a test */
+#define RPC_DIRECT_TOKEN_LEN    32
+
+/**
+ * Length of the header of messages received and sent via direct
+ * connection: timeout of the request or status of the reply.
+ */
+#define RPC_DIRECT_HDR_LEN      sizeof(uint32_t)
+
+/** How long wait for authentication of direct connection, seconds */
+#define RPC_DIRECT_AUTH_TIMEOUT 5
+
+/** Maximum number of direct connections waiting for authentication */
+#define RPC_DIRECT_PENDING_MAX  8
+
+/** Maximum number of jobs in progress on one RPC server */
+#define RPC_MAX_JOBS            64
+
 /**
  * Macro-wrapper to call @c gettimeofday(). It reports error and returns
  * from a function with TE errno code in case of fail.
@@ -88,6 +118,12 @@ do {                                                                       \
 
 
 
+/** Job (RPC called with RCF_RPC_JOB) in progress on RPC server */
+typedef struct rpc_job {
+    uint64_t jobid;     /**< Job identifier */
+    bool     done;      /**< Completion is notified by RPC server */
+} rpc_job;
+
 /** Data corresponding to one RPC server */
 typedef struct rpcserver {
     struct rpcserver *next;   /**< Next server in the list */
@@ -121,12 +157,46 @@ typedef struct rpcserver {
 
     rcf_rpc_op  last_rpc_op; /** Operation type of last rpc call **/
     char        last_rpc_name[RCF_MAX_NAME]; /** Name of last rpc call **/
+
+    bool        job_call;  /**< The request in progress starts a job */
+    uint64_t    wait_jobid; /**< Job waited by the request in progress
+                                 or 0 */
+    rpc_job     jobs[RPC_MAX_JOBS]; /**< Jobs which are not waited yet */
+    unsigned int n_jobs;   /**< Number of jobs which are not waited yet */
+
+    int       direct;      /**< Socket of direct connection from a test
+                                or -1 */
+    bool      direct_call; /**< The request in progress is received via
+                                direct connection */
+    char      direct_token[RPC_DIRECT_TOKEN_LEN + 1]; /**< One-time token
+                                to authenticate direct connection or
+                                empty string */
 } rpcserver;
 
 static rpcserver *list;        /**< List of all RPC servers */
-static uint8_t   *rpc_buf;     /**< Buffer for receiving of RPC answers;
-                                    may be used in dispatch thread
-                                    context only */
+static uint8_t   *rpc_buf;     /**< Buffer for receiving of RPC answers
+                                    with room for the header of direct
+                                    connection replies; may be used in
+                                    dispatch thread context only */
+
+/** Socket listening for direct connections from tests or -1 */
+static int direct_listener = -1;
+/** Port of the socket listening for direct connections */
+static unsigned int direct_port;
+
+/** Direct connection accepted but not authenticated yet */
+typedef struct direct_pending {
+    int     s;      /**< Socket */
+    time_t  since;  /**< Time when the connection is accepted */
+} direct_pending;
+
+/**
+ * Direct connections waiting for authentication; may be used in
+ * dispatch thread context only.
+ */
+static direct_pending direct_pendings[RPC_DIRECT_PENDING_MAX];
+/** Number of direct connections waiting for authentication */
+static unsigned int direct_n_pending = 0;
 
 /**
  * Name of the application to serve RPC requests.
@@ -177,6 +247,8 @@ static te_errno rpcserver_sid_get(unsigned int, const char *, char *,
                                   const char *);
 static te_errno rpcserver_sid_set(unsigned int, const char *, const char *,
                                   const char *);
+static te_errno rpcserver_direct_get(unsigned int, const char *, char *,
+                                     const char *);
 
 static rcf_pch_cfg_object node_rpcprovider =
     { "rpcprovider", 0, NULL, NULL,
@@ -190,8 +262,13 @@ static rcf_pch_cfg_object node_rpc_default_timeout =
       (rcf_ch_cfg_set)rpc_default_timeout_set,
       NULL, NULL, NULL, NULL, NULL, NULL};
 
+static rcf_pch_cfg_object node_rpcserver_direct =
+    { "direct", 0, NULL, NULL,
+      (rcf_ch_cfg_get)rpcserver_direct_get, NULL,
+      NULL, NULL, NULL, NULL, NULL, NULL};
+
 static rcf_pch_cfg_object node_rpcserver_sid =
-    { "sid", 0, NULL, NULL,
+    { "sid", 0, NULL, &node_rpcserver_direct,
       (rcf_ch_cfg_get)rpcserver_sid_get,
       (rcf_ch_cfg_set)rpcserver_sid_set,
       NULL, NULL, NULL, NULL, NULL, NULL};
@@ -296,6 +373,119 @@ check_rpc_call(rpcserver *rpcs, rcf_rpc_op op, const char *rpc_name)
     return false;
 }
 
+/**
+ * Find a job of RPC server which is not waited yet.
+ *
+ * @param rpcs      RPC server structure
+ * @param jobid     job identifier
+ *
+ * @return Job or @c NULL.
+ */
+static rpc_job *
+job_find(rpcserver *rpcs, uint64_t jobid)
+{
+    unsigned int i;
+
+    if (jobid == 0)
+        return NULL;
+
+    for (i = 0; i < rpcs->n_jobs; i++)
+    {
+        if (rpcs->jobs[i].jobid == jobid)
+            return &rpcs->jobs[i];
+    }
+
+    return NULL;
+}
+
+/**
+ * Account the reply of RPC server in the jobs of the server.
+ *
+ * @param rpcs          RPC server structure
+ * @param jobid         job identifier from the reply
+ * @param unsolicited   the reply is a notification about completion
+ *                      of a deferred call
+ *
+ * @return @c true if the reply is a notification about completion
+ *         of a job.
+ */
+static bool
+job_reply(rpcserver *rpcs, uint64_t jobid, bool unsolicited)
+{
+    rpc_job *job = job_find(rpcs, unsolicited ? jobid : rpcs->wait_jobid);
+
+    if (unsolicited)
+    {
+        if (job == NULL)
+            return false;
+        job->done = true;
+        return true;
+    }
+
+    if (job != NULL)
+        *job = rpcs->jobs[--rpcs->n_jobs];
+    else if (rpcs->job_call && jobid != 0)
+        rpcs->jobs[rpcs->n_jobs++] = (rpc_job){ .jobid = jobid };
+
+    rpcs->job_call = false;
+    rpcs->wait_jobid = 0;
+
+    return false;
+}
+
+/**
+ * Account RPC call which is going to be forwarded to the RPC server.
+ *
+ * @param rpcs          RPC server structure
+ * @param common_arg    common input arguments of the call
+ * @param rpc_name      the name of RPC function
+ *
+ * @return Status code.
+ */
+static te_errno
+track_rpc_call(rpcserver *rpcs, const tarpc_in_arg *common_arg,
+               const char *rpc_name)
+{
+    rpcs->job_call = false;
+    rpcs->wait_jobid = 0;
+
+    /* Jobs do not affect state of ordinary calls */
+    if (common_arg->op == RCF_RPC_JOB)
+    {
+        if (rpcs->n_jobs == RPC_MAX_JOBS)
+        {
+            ERROR("RPC server %s cannot start one more job, %u jobs "
+                  "are not waited yet", rpcs->name, rpcs->n_jobs);
+            return TE_ENOBUFS;
+        }
+        rpcs->job_call = true;
+        return 0;
+    }
+    if (common_arg->op == RCF_RPC_WAIT &&
+        job_find(rpcs, common_arg->jobid) != NULL)
+    {
+        rpcs->wait_jobid = common_arg->jobid;
+        return 0;
+    }
+
+    /*
+     * Bug 8924: wrong call does not stop the execution, just logs
+     * the error message. This behaviour allows to collect statistics
+     * about rpc calls.
+     */
+    (void)check_rpc_call(rpcs, common_arg->op, rpc_name);
+    rpcs->last_rpc_op = common_arg->op;
+    te_strlcpy(rpcs->last_rpc_name, rpc_name, RCF_MAX_NAME);
+
+    if (common_arg->op == RCF_RPC_CALL)
+    {
+        rpcs->async_call = true;
+        rpcs->last_jobid = 0;
+    }
+
+    return 0;
+}
+
 /**
  * Call RPC on the specified RPC server.
  *
@@ -630,7 +820,49 @@ connect_getpid(rpcserver *rpcs)
 }
 
 /**
- * Send error to RCF if RPC server is dead.
+ * Close direct connection from a test to the RPC server.
+ *
+ * @param rpcs  RPC server handle
+ */
+static void
+direct_close(rpcserver *rpcs)
+{
+    if (rpcs->direct >= 0)
+    {
+        close(rpcs->direct);
+        rpcs->direct = -1;
+    }
+}
+
+/**
+ * Send reply to the request received via direct connection.
+ *
+ * @param rpcs  RPC server handle
+ * @param rc    status of the request
+ * @param msg   buffer starting with @c RPC_DIRECT_HDR_LEN bytes reserved
+ *              for the status followed by encoded RPC result
+ * @param len   length of encoded RPC result (@c 0 if @p rc is not zero)
+ */
+static void
+direct_reply(rpcserver *rpcs, te_errno rc, uint8_t *msg, size_t len)
+{
+    uint32_t status = htonl(rc);
+
+    if (rpcs->direct < 0)
+        return;
+
+    memcpy(msg, &status, sizeof(status));
+    if (rpc_transport_send(rpcs->direct, msg,
+                           RPC_DIRECT_HDR_LEN + len) != 0)
+    {
+        WARN("Direct connection to RPC server %s is broken", rpcs->name);
+        direct_close(rpcs);
+    }
+}
+
+/**
+ * Send error to RCF (or to the test via direct connection) if RPC
+ * server is dead.
  *
  * @param rpcs  RPC server handle
  * @param rc    error code
@@ -643,6 +875,12 @@ rpc_error(rpcserver *rpcs, int rc)
 
     rc = TE_RC(TE_RCF_PCH, rc);
 
+    if (rpcs->direct_call)
+    {
+        direct_reply(rpcs, rc, (uint8_t *)error_buf, 0);
+        return;
+    }
+
     n = snprintf(error_buf, sizeof(error_buf),
                  "SID %d %d", rpcs->last_sid, rc) + 1;
     RCF_CH_LOCK;
@@ -716,6 +954,214 @@ get_out_arg_props(void *rpc_buf, size_t len,
     return rc;
 }
 
+/**
+ * Accept direct connection from a test. The connection is authenticated
+ * when the authentication message arrives, so the dispatch thread does
+ * not wait for it.
+ *
+ * @param now       current time
+ */
+static void
+direct_accept(time_t now)
+{
+    int optval = 1;
+    int s;
+
+    s = accept(direct_listener, NULL, NULL);
+    if (s < 0)
+    {
+        WARN("Failed to accept direct connection: %r",
+             TE_OS_RC(TE_RCF_PCH, errno));
+        return;
+    }
+
+    if (direct_n_pending == RPC_DIRECT_PENDING_MAX)
+    {
+        WARN("Too many direct connections wait for authentication");
+        close(s);
+        return;
+    }
+
+#if HAVE_FCNTL_H
+    (void)fcntl(s, F_SETFD, FD_CLOEXEC);
+#endif
+#if HAVE_NETINET_TCP_H
+    (void)setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &optval, sizeof(optval));
+#endif
+
+    direct_pendings[direct_n_pending].s = s;
+    direct_pendings[direct_n_pending].since = now;
+    direct_n_pending++;
+}
+
+/**
+ * Authenticate direct connection from a test by the token the test
+ * obtained from the RPC server @c direct node via RCF. The function
+ * is called when the authentication message arrives.
+ *
+ * @param s         socket of the connection
+ */
+static void
+direct_auth(int s)
+{
+    char        auth[RCF_MAX_ID + RPC_DIRECT_TOKEN_LEN + 2];
+    size_t      len = sizeof(auth) - 1;
+    uint8_t     msg[RPC_DIRECT_HDR_LEN];
+    uint32_t    status;
+    rpcserver  *rpcs = NULL;
+    char       *token;
+    te_errno    rc = TE_RC(TE_RCF_PCH, TE_EPERM);
+
+    /* Authentication message is "<RPC server name> <token>" */
+    if (rpc_transport_recv(s, (uint8_t *)auth, &len, 0) != 0)
+    {
+        WARN("Direct connection is closed before authentication");
+        close(s);
+        return;
+    }
+    auth[len] = '\0';
+
+    token = strchr(auth, ' ');
+    if (token != NULL)
+    {
+        *token++ = '\0';
+        rpcs = rcf_pch_find_rpcserver(auth);
+    }
+
+    if (rpcs != NULL && rpcs->direct_token[0] != '\0' &&
+        strcmp(token, rpcs->direct_token) == 0)
+    {
+        rc = 0;
+    }
+    else
+    {
+        ERROR("Failed to authenticate direct connection to RPC server "
+              "'%s'", auth);
+    }
+
+    status = htonl(rc);
+    memcpy(msg, &status, sizeof(status));
+    if (rpc_transport_send(s, msg, sizeof(msg)) != 0 || rc != 0)
+    {
+        close(s);
+        return;
+    }
+
+    /* The token is one-time, the previous connection is replaced */
+    rpcs->direct_token[0] = '\0';
+    direct_close(rpcs);
+    rpcs->direct = s;
+}
+
+/**
+ * Authenticate direct connections which authentication messages
+ * arrived for and close the ones which are not authenticated in time.
+ *
+ * @param now       current time
+ */
+static void
+direct_pending_process(time_t now)
+{
+    unsigned int i = 0;
+
+    while (i < direct_n_pending)
+    {
+        int s = direct_pendings[i].s;
+
+        if (rpc_transport_is_readable(s))
+        {
+            direct_auth(s);
+        }
+        else if (now - direct_pendings[i].since > RPC_DIRECT_AUTH_TIMEOUT)
+        {
+            WARN("Direct connection is not authenticated in time");
+            close(s);
+        }
+        else
+        {
+            i++;
+            continue;
+        }
+
+        direct_pendings[i] = direct_pendings[--direct_n_pending];
+    }
+}
+
+/**
+ * Receive RPC request from direct connection of the RPC server and
+ * pass it to the server. The answer is sent back by the dispatch thread
+ * in the same way as answers to requests received via RCF.
+ *
+ * @param rpcs  RPC server handle
+ */
+static void
+direct_request(rpcserver *rpcs)
+{
+    uint8_t      hdr[RPC_DIRECT_HDR_LEN];
+    uint8_t     *data = rpc_buf + RPC_DIRECT_HDR_LEN;
+    size_t       len = RCF_RPC_HUGE_BUF_LEN;
+    uint32_t     timeout;
+    char         rpc_name[RCF_MAX_NAME];
+    tarpc_in_arg common_arg;
+    te_errno     rc;
+
+    /* Request is timeout in milliseconds followed by encoded RPC call */
+    rc = rpc_transport_recv(rpcs->direct, rpc_buf, &len, 0);
+    if (TE_RC_GET_ERROR(rc) == TE_ETIMEDOUT)
+        return;
+    if (rc != 0 || len < RPC_DIRECT_HDR_LEN)
+    {
+        direct_close(rpcs);
+        return;
+    }
+    memcpy(&timeout, rpc_buf, sizeof(timeout));
+    timeout = ntohl(timeout);
+    len -= RPC_DIRECT_HDR_LEN;
+
+    rc = rpc_xdr_inspect_call(data, len, rpc_name, &common_arg);
+    if (rc != 0)
+    {
+        ERROR("Cannot decode RPC call for RPC server %s: %r",
+              rpcs->name, rc);
+    }
+    else if (rpcs->dead)
+    {
+        ERROR("Request to dead RPC server %s", rpcs->name);
+        rc = TE_ERPCDEAD;
+    }
+    else if (rpcs->sent != 0)
+    {
+        ERROR("RPC server %s is busy", rpcs->name);
+        rc = TE_EBUSY;
+    }
+    else if (is_special_rpc(rpc_name) || timeout == 0xFFFFFFFF)
+    {
+        /* These requests need RCF session state, they go via RCF */
+        rc = TE_EOPNOTSUPP;
+    }
+    else
+    {
+        rc = track_rpc_call(rpcs, &common_arg, rpc_name);
+    }
+    if (rc != 0)
+    {
+        direct_reply(rpcs, TE_RC(TE_RCF_PCH, rc), hdr, 0);
+        return;
+    }
+
+    if (rpc_transport_send(rpcs->handle, data, len) != 0)
+    {
+        ERROR("Failed to send RPC data to the server %s", rpcs->name);
+        direct_reply(rpcs, TE_RC(TE_RCF_PCH, TE_ESUNRPC), hdr, 0);
+        return;
+    }
+
+    rpcs->sent = time(NULL);
+    rpcs->last_sid = 0;
+    rpcs->direct_call = true;
+    rpcs->timeout = timeout / 1000;
+}
+
 /**
  * Entry point for the thread forwarding answers from RPC servers
  * to RCF. The thread should not release memory allocated for
@@ -728,15 +1174,21 @@ dispatch(void *arg)
 
     while (true)
     {
+        uint8_t   *data = rpc_buf + RPC_DIRECT_HDR_LEN;
         rpcserver *rpcs;
         time_t     now;
         size_t     len;
         te_errno   rc;
         uint32_t   pass_time = 0;
+        unsigned int i;
 
         rpc_transport_read_set_init();
 
         pthread_mutex_lock(&lock);
+        if (direct_listener >= 0)
+            rpc_transport_read_set_add(direct_listener);
+        for (i = 0; i < direct_n_pending; i++)
+            rpc_transport_read_set_add(direct_pendings[i].s);
         for (rpcs = list; rpcs != NULL; rpcs = rpcs->next)
         {
             /*
@@ -747,18 +1199,30 @@ dispatch(void *arg)
              */
             if (!rpcs->dead)
                 rpc_transport_read_set_add(rpcs->handle);
+            if (rpcs->direct >= 0)
+                rpc_transport_read_set_add(rpcs->direct);
         }
         pthread_mutex_unlock(&lock);
 
         rpc_transport_read_set_wait(1);
         pthread_mutex_lock(&lock);
         now = time(NULL);
+        direct_pending_process(now);
+        if (direct_listener >= 0 &&
+            rpc_transport_is_readable(direct_listener))
+        {
+            direct_accept(now);
+        }
         for (rpcs = list; rpcs != NULL; rpcs = rpcs->next)
         {
             uint64_t jobid;
             bool unsolicited;
 
-            if (rpcs->dead || (rpcs->sent == 0 && !rpcs->async_call))
+            if (rpcs->direct >= 0 && rpc_transport_is_readable(rpcs->direct))
+                direct_request(rpcs);
+
+            if (rpcs->dead ||
+                (rpcs->sent == 0 && !rpcs->async_call && rpcs->n_jobs == 0))
                 continue;
 
             if (rpcs->sent != 0)
@@ -787,7 +1251,7 @@ dispatch(void *arg)
             }
 
             len = RCF_RPC_HUGE_BUF_LEN;
-            rc = rpc_transport_recv(rpcs->handle, rpc_buf, &len, 0);
+            rc = rpc_transport_recv(rpcs->handle, data, &len, 0);
             if (rc != 0)
             {
                 if (TE_RC_GET_ERROR(rc) == TE_ETIMEDOUT)
@@ -798,7 +1262,7 @@ dispatch(void *arg)
                 continue;
             }
 
-            rc = get_out_arg_props(rpc_buf, len, &jobid, &unsolicited);
+            rc = get_out_arg_props(data, len, &jobid, &unsolicited);
             if (rc != 0)
             {
                 ERROR("Cannot get out argument properties: %r", rc);
@@ -806,6 +1270,9 @@ dispatch(void *arg)
                 continue;
             }
 
+            if (job_reply(rpcs, jobid, unsolicited))
+                continue;
+
             if (rpcs->async_call)
             {
                 if (rpcs->last_jobid != 0 &&
@@ -820,7 +1287,10 @@ dispatch(void *arg)
                 continue;
             }
 
-            send_response(rpcs, conn_saved, rpc_buf, len);
+            if (rpcs->direct_call)
+                direct_reply(rpcs, 0, rpc_buf, len);
+            else
+                send_response(rpcs, conn_saved, data, len);
 
             if (rpcs->timeout == 0xFFFFFFFF) /* execve() */
             {
@@ -848,6 +1318,7 @@ dispatch(void *arg)
             }
 
             rpcs->timeout = rpcs->sent = rpcs->last_sid = 0;
+            rpcs->direct_call = false;
         }
         pthread_mutex_unlock(&lock);
     }
@@ -869,7 +1340,7 @@ rcf_pch_rpc_init(const char *tmp_path)
     if (rpc_transport_init(rpc_dir_path) != 0)
         return;
 
-    rpc_buf = TE_ALLOC(RCF_RPC_HUGE_BUF_LEN);
+    rpc_buf = TE_ALLOC(RPC_DIRECT_HDR_LEN + RCF_RPC_HUGE_BUF_LEN);
 
     if (pthread_create(&tid, NULL, dispatch, NULL) != 0)
     {
@@ -884,15 +1355,29 @@ rcf_pch_rpc_init(const char *tmp_path)
 }
 
 /**
- * Close all RCF RPC connections.
+ * Close all RCF RPC connections including direct connections from tests.
  */
 static void
 rcf_pch_rpc_close_connections(void)
 {
-    rpcserver *rpcs;
+    rpcserver    *rpcs;
+    unsigned int  i;
 
     for (rpcs = list; rpcs != NULL; rpcs = rpcs->next)
+    {
         rpc_transport_close(rpcs->handle);
+        direct_close(rpcs);
+    }
+
+    for (i = 0; i < direct_n_pending; i++)
+        close(direct_pendings[i].s);
+    direct_n_pending = 0;
+
+    if (direct_listener >= 0)
+    {
+        close(direct_listener);
+        direct_listener = -1;
+    }
 }
 
 /* See description in rcf_pch.h */
@@ -1369,6 +1854,134 @@ rpcserver_sid_set(unsigned int gid, const char *oid, const char *value,
     return rc;
 }
 
+/**
+ * Create the socket listening for direct connections from tests
+ * if it is not created yet.
+ *
+ * @return Status code
+ */
+static te_errno
+direct_listen(void)
+{
+    struct sockaddr_in addr;
+    socklen_t          addrlen = sizeof(addr);
+    te_errno           rc;
+    int                s;
+
+    if (direct_listener >= 0)
+        return 0;
+
+    rc = rcf_comm_agent_create_listener(0, &s);
+    if (rc != 0)
+    {
+        ERROR("Failed to create socket for direct connections: %r", rc);
+        return rc;
+    }
+
+    if (getsockname(s, (struct sockaddr *)&addr, &addrlen) != 0)
+    {
+        rc = TE_OS_RC(TE_RCF_PCH, errno);
+        ERROR("getsockname() failed for direct connections socket: %r",
+              rc);
+        close(s);
+        return rc;
+    }
+
+#if HAVE_FCNTL_H
+    (void)fcntl(s, F_SETFD, FD_CLOEXEC);
+#endif
+
+    direct_port = ntohs(addr.sin_port);
+    direct_listener = s;
+
+    return 0;
+}
+
+/**
+ * Generate random token to authenticate direct connection.
+ *
+ * @param token     buffer of @c RPC_DIRECT_TOKEN_LEN + 1 bytes
+ *
+ * @return Status code
+ */
+static te_errno
+direct_token_generate(char *token)
+{
+    uint8_t  rnd[RPC_DIRECT_TOKEN_LEN / 2];
+    te_errno rc = 0;
+    size_t   i;
+    int      fd;
+
+    fd = open("/dev/urandom", O_RDONLY);
+    if (fd < 0)
+        return TE_OS_RC(TE_RCF_PCH, errno);
+
+    if (read(fd, rnd, sizeof(rnd)) != (ssize_t)sizeof(rnd))
+        rc = TE_RC(TE_RCF_PCH, TE_EIO);
+    close(fd);
+    if (rc != 0)
+        return rc;
+
+    for (i = 0; i < sizeof(rnd); i++)
+        sprintf(token + 2 * i, "%02x", rnd[i]);
+
+    return 0;
+}
+
+/**
+ * Get parameters of direct connection to RPC server: port to connect to
+ * and one-time token to authenticate the connection. A new token is
+ * generated on every request, so only the one who has just obtained it
+ * via RCF may connect.
+ *
+ * @param gid           group identifier (unused)
+ * @param oid           full object instance identifier (unused)
+ * @param value         value location ("<port> <token>")
+ * @param name          RPC server name
+ *
+ * @return Status code
+ */
+static te_errno
+rpcserver_direct_get(unsigned int gid, const char *oid, char *value,
+                     const char *name)
+{
+    rpcserver *rpcs;
+    te_errno   rc;
+
+    UNUSED(gid);
+    UNUSED(oid);
+
+#if (defined(__CYGWIN__) || defined(WINDOWS)) && \
+    !defined(ENABLE_TCP_TRANSPORT)
+    /* Direct connections are served by POSIX RPC transport only */
+    UNUSED(value);
+    UNUSED(name);
+    return TE_RC(TE_RCF_PCH, TE_EOPNOTSUPP);
+#endif
+
+    pthread_mutex_lock(&lock);
+
+    rpcs = rcf_pch_find_rpcserver(name);
+    if (rpcs == NULL)
+    {
+        pthread_mutex_unlock(&lock);
+        return TE_RC(TE_RCF_PCH, TE_ENOENT);
+    }
+
+    rc = direct_listen();
+    if (rc == 0)
+        rc = direct_token_generate(rpcs->direct_token);
+    if (rc == 0)
+    {
+        snprintf(value, RCF_MAX_VAL, "%u %s", direct_port,
+                 rpcs->direct_token);
+    }
+
+    pthread_mutex_unlock(&lock);
+
+    return rc;
+}
+
 
 /**
  * Get RPC server value (father name).
@@ -1545,6 +2158,7 @@ rpcserver_add(unsigned int gid, const char *oid, const char *value,
     strcpy(rpcs->value, value);
     rpcs->father = father;
     rpcs->last_rpc_op = RCF_RPC_CALL_WAIT;
+    rpcs->direct = -1;
 
     if (registration)
         goto connect;
@@ -1728,6 +2342,7 @@ rpcserver_del(unsigned int gid, const char *oid, const char *name)
     }
 
     rpc_transport_close(rpcs->handle);
+    direct_close(rpcs);
     pthread_mutex_unlock(&lock);
 
     free(rpcs);
@@ -1866,25 +2481,17 @@ rcf_pch_rpc(struct rcf_comm_connection *conn, int sid,
 
     if (!is_special_rpc(rpc_name))
     {
-        if (!check_rpc_call(rpcs, common_arg.op, rpc_name))
+        rc = track_rpc_call(rpcs, &common_arg, rpc_name);
+        if (rc != 0)
         {
-            /* Bug 8924: wrong call does not stop the execution, just logs
-             * the error message. This behaviour allows to collect statistics
-             * about rpc calls.
-             */
-            if (false)
-            {
-                pthread_mutex_unlock(&lock);
-                RETERR(TE_EBUSY);
-            }
+            pthread_mutex_unlock(&lock);
+            RETERR(rc);
         }
-
-        rpcs->last_rpc_op = common_arg.op;
-        te_strlcpy(rpcs->last_rpc_name, rpc_name, RCF_MAX_NAME);
     }
 
     rpcs->sent = time(NULL);
     rpcs->last_sid = sid;
+    rpcs->direct_call = false;
     rpcs->timeout = timeout == 0xFFFFFFFF ? timeout : timeout / 1000;
     pthread_mutex_unlock(&lock);
 
@@ -1902,15 +2509,29 @@ rcf_pch_rpc(struct rcf_comm_connection *conn, int sid,
     if (strcmp(rpc_name, "rpc_is_op_done") == 0)
     {
         tarpc_rpc_is_op_done_out result;
+        rpc_job *job;
 
         memset(&result, 0, sizeof(result));
+        pthread_mutex_lock(&lock);
+        job = job_find(rpcs, common_arg.jobid);
         if (common_arg.op != RCF_RPC_CALL_WAIT)
+        {
             result.common._errno = TE_RC(TE_TA_UNIX, TE_EINVAL);
-        else if (common_arg.jobid != rpcs->last_jobid)
-            result.common._errno = TE_RC(TE_TA_UNIX, TE_ESRCH);
+        }
+        else if (job != NULL)
+        {
+            result.common.jobid = job->jobid;
+            result.done = job->done;
+        }
+        else
+        {
+            if (common_arg.jobid != rpcs->last_jobid)
+                result.common._errno = TE_RC(TE_TA_UNIX, TE_ESRCH);
 
-        result.common.jobid = rpcs->last_jobid;
-        result.done = !rpcs->async_call;
+            result.common.jobid = rpcs->last_jobid;
+            result.done = !rpcs->async_call;
+        }
+        pthread_mutex_unlock(&lock);
 
         rc = rpc_xdr_encode_result(rpc_name, true, enc_result, &enc_len,
                                    &result);
@@ -1959,11 +2580,6 @@ rcf_pch_rpc(struct rcf_comm_connection *conn, int sid,
 
         return 0;
     }
-    else if (common_arg.op == RCF_RPC_CALL)
-    {
-        rpcs->async_call = true;
-        rpcs->last_jobid = 0;
-    }
 
     /* Send encoded data to server */
     if (rpc_transport_send(rpcs->handle, (uint8_t *)data,
@@ -45,6 +45,18 @@
 #ifdef HAVE_SYS_WAIT_H
 #include <sys/wait.h>
 #endif
+#ifdef HAVE_NETINET_IN_H
+#include <netinet/in.h>
+#endif
+#ifdef HAVE_NETINET_TCP_H
+#include <netinet/tcp.h>
+#endif
+#ifdef HAVE_NETDB_H
+#include <netdb.h>
+#endif
+#ifdef HAVE_POLL_H
+#include <poll.h>
+#endif
 #ifdef HAVE_SEMAPHORE_H
 #include <semaphore.h>
 #else
@@ -55,6 +67,8 @@
 #include "te_stdint.h"
 #include "te_errno.h"
 #include "te_str.h"
+#include "te_string.h"
+#include "te_kvpair.h"
 #include "logger_api.h"
 #include "conf_api.h"
 #include "rcf_api.h"
@@ -64,6 +78,27 @@
 #include "tarpc.h"
 #include "te_rpc_errno.h"
 
+/**
+ * Length of the header of messages sent and received via direct
+ * connection to Test Agent: timeout of the request or status of the reply.
+ */
+#define RCF_RPC_DIRECT_HDR_LEN      sizeof(uint32_t)
+
+/**
+ * How long wait for the reply via direct connection in addition to
+ * RPC timeout, milliseconds. Test Agent reports RPC timeout itself.
+ */
+#define RCF_RPC_DIRECT_MARGIN       10000
+
+/** How long wait for establishment of direct connection, seconds */
+#define RCF_RPC_DIRECT_CONN_TIMEOUT 5
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL    0
+#endif
+#ifndef MSG_MORE
+#define MSG_MORE        0
+#endif
 
 static rcf_rpc_server_hooks rcf_rpc_server_hooks_list;
 
@@ -361,6 +396,7 @@ rcf_rpc_server_get(const char *ta, const char *name,
     rpcs->def_timeout = default_timeout;
     rpcs->timeout = RCF_RPC_UNSPEC_TIMEOUT;
     rpcs->sid = sid;
+    rpcs->direct = -1;
     rpcs->seqno = 0;
 
     rcf_rpc_server_hooks_run(rpcs);
@@ -616,8 +652,10 @@ rcf_rpc_server_destroy(rcf_rpc_server *rpcs)
         return rc;
     }
 
+    rcf_rpc_server_direct_close(rpcs);
     rcf_rpc_namespace_free_cache(rpcs);
     free(rpcs->nv_lib);
+    free(rpcs->msg_buf);
     free(rpcs);
 
     VERB("RPC server is destroyed successfully");
@@ -625,254 +663,414 @@ rcf_rpc_server_destroy(rcf_rpc_server *rpcs)
     return 0;
 }
 
-/* See description in rcf_rpc.h */
-void
-rcf_rpc_call(rcf_rpc_server *rpcs, const char *proc,
-             void *in_arg, void *out_arg)
+/**
+ * Read exactly @p len bytes from direct connection to Test Agent.
+ *
+ * @param s             socket of the connection
+ * @param buf           buffer to read to
+ * @param len           number of bytes to read
+ * @param timeout       timeout in milliseconds or @c -1
+ *
+ * @return Status code
+ */
+static te_errno
+rcf_rpc_direct_read(int s, void *buf, size_t len, int timeout)
 {
-    tarpc_in_arg  *in = (tarpc_in_arg *)in_arg;
-    tarpc_out_arg *out = (tarpc_out_arg *)out_arg;
-
-    bool op_is_done;
-    bool is_alive;
-
-    if (rpcs == NULL)
-    {
-        ERROR("Invalid RPC server handle is passed to rcf_rpc_call()");
-        return;
-    }
-
-    if (in_arg == NULL || out_arg == NULL || proc == NULL)
-    {
-        rpcs->_errno = TE_RC(TE_RCF_API, TE_EINVAL);
-        return;
-    }
-
-    op_is_done = (strcmp(proc, "rpc_is_op_done") == 0);
-    is_alive = (strcmp(proc, "rpc_is_alive") == 0);
-
-    VERB("Calling RPC %s", proc);
-
-#ifdef HAVE_PTHREAD_H
-    pthread_mutex_lock(&rpcs->lock);
-#endif
-    rpcs->_errno = 0;
-    rpcs->err_msg[0] = '\0';
-    rpcs->err_log = false;
-    if (rpcs->timeout == RCF_RPC_UNSPEC_TIMEOUT)
-        rpcs->timeout = rpcs->def_timeout;
+    struct pollfd pfd = { .fd = s, .events = POLLIN };
+    size_t        rcvd = 0;
+    ssize_t       rc;
 
-    if (!op_is_done && !is_alive &&
-        (rpcs->op == RCF_RPC_CALL ||
-         rpcs->op == RCF_RPC_CALL_WAIT))
-    {
-        if (rpcs->jobid0 != 0)
-        {
-            rpcs->_errno = TE_RC(TE_RCF_API, TE_EBUSY);
-            rpcs->timed_out = true;
-#ifdef HAVE_PTHREAD_H
-            pthread_mutex_unlock(&rpcs->lock);
-#endif
-            return;
-        }
-    }
-    else if (!is_alive)
+    while (rcvd < len)
     {
-        if (rpcs->jobid0 == 0)
-        {
-            ERROR("Try to wait not called RPC");
-            rpcs->_errno = TE_RC(TE_RCF_API, TE_EALREADY);
-            rpcs->timed_out = true;
-#ifdef HAVE_PTHREAD_H
-            pthread_mutex_unlock(&rpcs->lock);
-#endif
-            return;
-        }
-        else if (strcmp(rpcs->proc, proc) != 0 && !op_is_done)
+        rc = poll(&pfd, 1, timeout);
+        if (rc == 0)
+            return TE_RC(TE_RCF_API, TE_ETIMEDOUT);
+        if (rc < 0)
         {
-            ERROR("Try to wait RPC %s instead called RPC %s",
-                  proc, rpcs->proc);
-            rpcs->_errno = TE_RC(TE_RCF_API, TE_EPERM);
-            rpcs->timed_out = true;
-#ifdef HAVE_PTHREAD_H
-            pthread_mutex_unlock(&rpcs->lock);
-#endif
-            return;
+            if (errno == EINTR)
+                continue;
+            return TE_OS_RC(TE_RCF_API, errno);
         }
+
+        rc = recv(s, (uint8_t *)buf + rcvd, len - rcvd, 0);
+        if (rc <= 0)
+            return TE_RC(TE_RCF_API, TE_ECONNRESET);
+        rcvd += rc;
     }
 
-    in->start = rpcs->start;
-    in->op = rpcs->op;
-    in->jobid = rpcs->jobid0;
-    in->lib_flags = TARPC_LIB_DEFAULT;
-    if (rpcs->op != RCF_RPC_WAIT)
-        rpcs->seqno++;
-    in->seqno = rpcs->seqno;
-    if (rpcs->use_libc || rpcs->use_libc_once)
-        in->lib_flags |= TARPC_LIB_USE_LIBC;
-    if (rpcs->use_syscall)
-        in->lib_flags |= TARPC_LIB_USE_SYSCALL;
+    return 0;
+}
 
-    rpcs->last_op = rpcs->op;
-    rpcs->last_use_libc = rpcs->use_libc_once;
+/**
+ * Receive a message from direct connection to Test Agent. Messages
+ * are prefixed by their length in the same way as messages between
+ * Test Agent and RPC servers.
+ *
+ * @param s             socket of the connection
+ * @param buf           buffer to receive the message to
+ * @param size          size of @p buf
+ * @param p_msg         location for the message: @p buf or allocated
+ *                      buffer if the message does not fit in @p buf
+ * @param p_len         location for the length of the message
+ * @param timeout       timeout in milliseconds or @c -1
+ *
+ * @return Status code
+ */
+static te_errno
+rcf_rpc_direct_recv(int s, void *buf, size_t size, void **p_msg,
+                    size_t *p_len, int timeout)
+{
+    uint32_t len;
+    void    *msg = buf;
+    te_errno rc;
 
-    if (!op_is_done && !is_alive)
-        strcpy(rpcs->proc, proc);
+    rc = rcf_rpc_direct_read(s, &len, sizeof(len), timeout);
+    if (rc != 0)
+        return rc;
 
-    rpcs->_errno = rcf_ta_call_rpc(rpcs->ta, rpcs->sid, rpcs->name,
-                                   rpcs->timeout, proc, in, out);
+    len = ntohl(len);
+    if (len > size)
+        msg = TE_ALLOC(len);
 
-    if (rpcs->op != RCF_RPC_CALL)
-        rpcs->timeout = RCF_RPC_UNSPEC_TIMEOUT;
-    rpcs->start = 0;
-    rpcs->use_libc_once = false;
-    if (TE_RC_GET_ERROR(rpcs->_errno) == TE_ERPCTIMEOUT ||
-        TE_RC_GET_ERROR(rpcs->_errno) == TE_ETIMEDOUT ||
-        TE_RC_GET_ERROR(rpcs->_errno) == TE_ERPCDEAD)
+    rc = rcf_rpc_direct_read(s, msg, len, timeout);
+    if (rc != 0)
     {
-        rpcs->timed_out = true;
+        if (msg != buf)
+            free(msg);
+        return rc;
     }
 
-    if (rpcs->_errno == 0)
-    {
-        rpcs->duration = out->duration;
-        rpcs->_errno = out->_errno;
-
-        if (out->err_str.err_str_len > 0)
-        {
-            TE_STRLCPY(rpcs->err_msg, out->err_str.err_str_val,
-		       RPC_ERROR_MAX_LEN);
-        }
-
-        rpcs->timed_out = false;
-        if (rpcs->op == RCF_RPC_CALL)
-        {
-            rpcs->jobid0 = out->jobid;
-            rpcs->op = RCF_RPC_WAIT;
-        }
-        else if (rpcs->op == RCF_RPC_WAIT)
-        {
-            rpcs->jobid0 = 0;
-            rpcs->op = RCF_RPC_CALL_WAIT;
-        }
-    }
+    *p_msg = msg;
+    *p_len = len;
 
-#ifdef HAVE_PTHREAD_H
-    pthread_mutex_unlock(&rpcs->lock);
-#endif
+    return 0;
 }
 
-/* See description in rcf_rpc.h */
-te_errno
-rcf_rpc_server_is_op_done(rcf_rpc_server *rpcs, bool *done)
+/**
+ * Send a message prefixed by its length via direct connection to
+ * Test Agent.
+ *
+ * @param s             socket of the connection
+ * @param buf           message
+ * @param len           length of the message
+ *
+ * @return Status code
+ */
+static te_errno
+rcf_rpc_direct_send(int s, const void *buf, size_t len)
 {
-    tarpc_rpc_is_op_done_in  in;
-    tarpc_rpc_is_op_done_out out;
-    rcf_rpc_op               old_op;
-
-    if (rpcs == NULL || done == NULL)
-        return TE_RC(TE_RCF, TE_EINVAL);
+    uint32_t hdr = htonl(len);
 
-    memset(&in, 0, sizeof(in));
-    memset(&out, 0, sizeof(out));
-
-    old_op = rpcs->op;
-    rpcs->op = RCF_RPC_CALL_WAIT;
-    rcf_rpc_call(rpcs, "rpc_is_op_done", &in, &out);
-    rpcs->op = old_op;
-
-    if (rpcs->_errno != 0)
+    if (send(s, &hdr, sizeof(hdr), MSG_MORE | MSG_NOSIGNAL) !=
+            (ssize_t)sizeof(hdr) ||
+        send(s, buf, len, MSG_NOSIGNAL) != (ssize_t)len)
     {
-        ERROR("Failed to call rpc_is_op_done() on the RPC server %s: %r",
-              rpcs->name, rpcs->_errno);
-        return rpcs->_errno;
+        return TE_RC(TE_RCF_API, TE_ECONNRESET);
     }
 
-    *done = (out.done != 0);
-
     return 0;
 }
 
-/* See description in rcf_rpc.h */
-bool
-rcf_rpc_server_is_alive(rcf_rpc_server *rpcs)
+/**
+ * Get address of Test Agent which RCF connects to.
+ *
+ * @param ta            Test Agent name
+ * @param port          port to connect to
+ * @param p_ai          location for the address
+ *
+ * @return Status code
+ */
+static te_errno
+rcf_rpc_direct_ta_addr(const char *ta, const char *port,
+                       struct addrinfo **p_ai)
 {
-    tarpc_rpc_is_alive_in   in;
-    tarpc_rpc_is_alive_out  out;
-    rcf_rpc_op              old_op;
+    struct addrinfo hints;
+    te_kvpair_h     conf;
+    char           *confstr = NULL;
+    const char     *host;
+    const char     *at;
+    te_errno        rc;
+    int             ret;
 
-    if (rpcs == NULL)
-        return false;
+    rc = rcf_get_ta(ta, NULL, NULL, &confstr, NULL);
+    if (rc != 0)
+    {
+        ERROR("Failed to get configuration of Test Agent %s: %r", ta, rc);
+        return rc;
+    }
 
-    memset(&in, 0, sizeof(in));
-    memset(&out, 0, sizeof(out));
+    te_kvpair_init(&conf);
+    rc = te_kvpair_from_str(confstr, &conf);
+    free(confstr);
+    if (rc != 0)
+    {
+        ERROR("Failed to parse configuration of Test Agent %s: %r", ta, rc);
+        te_kvpair_fini(&conf);
+        return TE_RC(TE_RCF_API, rc);
+    }
 
-    old_op = rpcs->op;
-    rpcs->op = RCF_RPC_CALL_WAIT;
-    rcf_rpc_call(rpcs, "rpc_is_alive", &in, &out);
-    rpcs->op = old_op;
+    if (te_kvpairs_get(&conf, "ssh_proxy") != NULL)
+    {
+        te_kvpair_fini(&conf);
+        return TE_RC(TE_RCF_API, TE_EOPNOTSUPP);
+    }
 
-    if (rpcs->_errno != 0)
+    /* The same choice of address as made by rcfunix */
+    host = te_kvpairs_get(&conf, "connect");
+    if (te_str_is_null_or_empty(host))
+        host = te_kvpairs_get(&conf, "host");
+    if (te_str_is_null_or_empty(host))
+        host = "localhost";
+    else if ((at = strrchr(host, '@')) != NULL)
+        host = at + 1;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    ret = getaddrinfo(host, port, &hints, p_ai);
+    if (ret != 0)
     {
-        ERROR("Failed to call rpc_is_alive() on the RPC server %s: %r",
-              rpcs->name, rpcs->_errno);
-        return false;
+        ERROR("Failed to resolve address '%s' of Test Agent %s: %s",
+              host, ta, gai_strerror(ret));
+        rc = TE_RC(TE_RCF_API, TE_EHOSTUNREACH);
     }
-    else
-        RING("RPC server %s is alive", rpcs->name);
 
-    return true;
+    te_kvpair_fini(&conf);
+
+    return rc;
 }
 
 /* See description in rcf_rpc.h */
 te_errno
-rcf_rpc_setlibname(rcf_rpc_server *rpcs, const char *libname)
+rcf_rpc_server_direct_open(rcf_rpc_server *rpcs)
 {
-    tarpc_setlibname_in  in;
-    tarpc_setlibname_out out;
-    rcf_rpc_op           old_op;
-
-    memset(&in, 0, sizeof(in));
-    memset(&out, 0, sizeof(out));
+    struct timeval   tv = { RCF_RPC_DIRECT_CONN_TIMEOUT, 0 };
+    struct addrinfo *ai = NULL;
+    te_string        auth = TE_STRING_INIT;
+    char             oid[RCF_MAX_ID];
+    char             val[RCF_MAX_VAL];
+    char             hdr[RCF_RPC_DIRECT_HDR_LEN];
+    void            *reply = NULL;
+    size_t           len;
+    char            *token;
+    uint32_t         status;
+    int              optval = 1;
+    int              s = -1;
+    te_errno         rc;
 
     if (rpcs == NULL)
+        return TE_RC(TE_RCF_API, TE_EINVAL);
+
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_lock(&rpcs->lock);
+#endif
+
+    if (rpcs->direct >= 0)
     {
-        ERROR("%s(): Invalid RPC server handle", __FUNCTION__);
-        return -1;
+        rc = 0;
+        goto exit;
     }
 
-    in.libname.libname_len = (libname == NULL) ? 0 : (strlen(libname) + 1);
-    in.libname.libname_val = (char *)libname;
-
-    old_op = rpcs->op;
-    rpcs->op = RCF_RPC_CALL_WAIT;
-    rcf_rpc_call(rpcs, "setlibname", &in, &out);
-    rpcs->op = old_op;
+    /* Port and one-time token are only available via RCF */
+    TE_SPRINTF(oid, "/agent:%s/rpcserver:%s/direct:", rpcs->ta, rpcs->name);
+    rc = rcf_ta_cfg_get(rpcs->ta, 0, oid, val, sizeof(val));
+    if (rc != 0)
+    {
+        ERROR("Failed to get parameters of direct connection to RPC server "
+              "%s: %r", rpcs->name, rc);
+        goto exit;
+    }
 
-    if (!RPC_IS_CALL_OK(rpcs))
-        out.retval = -1;
+    token = strchr(val, ' ');
+    if (token == NULL)
+    {
+        ERROR("Invalid parameters of direct connection to RPC server %s: "
+              "'%s'", rpcs->name, val);
+        rc = TE_RC(TE_RCF_API, TE_EPROTO);
+        goto exit;
+    }
+    *token++ = '\0';
 
-    LOG_MSG(out.retval != 0 ? TE_LL_ERROR : TE_LL_RING,
-            "RPC (%s,%s) setlibname(%s) -> %d (%s)",
-            rpcs->ta, rpcs->name, libname ? : "(NULL)",
-            out.retval, errno_rpc2str(RPC_ERRNO(rpcs)));
+    rc = rcf_rpc_direct_ta_addr(rpcs->ta, val, &ai);
+    if (rc != 0)
+        goto exit;
 
-    if (out.retval == 0)
+    s = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (s < 0)
     {
-        free(rpcs->nv_lib);
-        rpcs->nv_lib = (libname != NULL) ? strdup(libname) : NULL;
-        assert((rpcs->nv_lib == NULL) == (libname == NULL));
+        rc = TE_OS_RC(TE_RCF_API, errno);
+        goto exit;
     }
+    (void)fcntl(s, F_SETFD, FD_CLOEXEC);
+    (void)setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &optval, sizeof(optval));
+    /* Limit time of connect() */
+    (void)setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
 
-    return out.retval;
-}
+    if (connect(s, ai->ai_addr, ai->ai_addrlen) != 0)
+    {
+        rc = TE_OS_RC(TE_RCF_API, errno);
+        ERROR("Failed to connect to Test Agent %s for RPC server %s: %r",
+              rpcs->ta, rpcs->name, rc);
+        goto exit;
+    }
 
-extern int rcf_send_recv_msg(rcf_msg *send_buf, size_t send_size,
+    te_string_append(&auth, "%s %s", rpcs->name, token);
+    rc = rcf_rpc_direct_send(s, auth.ptr, auth.len);
+    if (rc == 0)
+    {
+        rc = rcf_rpc_direct_recv(s, hdr, sizeof(hdr), &reply, &len,
+                                 RCF_RPC_DIRECT_CONN_TIMEOUT * 1000);
+    }
+    if (rc == 0 && len != sizeof(status))
+        rc = TE_RC(TE_RCF_API, TE_EPROTO);
+    if (rc == 0)
+    {
+        memcpy(&status, reply, sizeof(status));
+        rc = ntohl(status);
+    }
+    if (rc != 0)
+    {
+        ERROR("Failed to authenticate direct connection to RPC server %s: "
+              "%r", rpcs->name, rc);
+        goto exit;
+    }
+
+    tv.tv_sec = 0;
+    (void)setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    rpcs->direct = s;
+    s = -1;
+    RING("RPC calls on %s:%s go via direct connection",
+         rpcs->ta, rpcs->name);
+
+exit:
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_unlock(&rpcs->lock);
+#endif
+    if (reply != (void *)hdr)
+        free(reply);
+    if (s >= 0)
+        close(s);
+    if (ai != NULL)
+        freeaddrinfo(ai);
+    te_string_free(&auth);
+
+    return rc;
+}
+
+/* See description in rcf_rpc.h */
+void
+rcf_rpc_server_direct_close(rcf_rpc_server *rpcs)
+{
+    if (rpcs == NULL)
+        return;
+
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_lock(&rpcs->lock);
+#endif
+    if (rpcs->direct >= 0)
+    {
+        close(rpcs->direct);
+        rpcs->direct = -1;
+    }
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_unlock(&rpcs->lock);
+#endif
+}
+
+extern int rcf_send_recv_msg(rcf_msg *send_buf, size_t send_size,
                              rcf_msg *recv_buf, size_t *recv_size,
                              rcf_msg **p_answer);
 
+/** Length of RPC data inside RCF message */
+#define RCF_RPC_INSIDE_LEN \
+    (sizeof(((rcf_msg *)0)->file) + sizeof(((rcf_msg *)0)->value))
+
+/** Length of RCF message part before RPC data */
+#define RCF_RPC_PREFIX_LEN  \
+    (sizeof(rcf_msg) - RCF_RPC_INSIDE_LEN)
+
 /**
- * Call SUN RPC on the TA.
+ * Size of requests and replies which is considered small: the buffer
+ * of this size is kept by RPC server handle regardless of calls.
+ */
+#define RCF_RPC_BUF_KEEP_LEN    (64 * 1024)
+
+/**
+ * Maximum size of the buffer kept by RPC server handle between calls.
+ * Calls with larger requests or replies allocate memory every time.
+ */
+#define RCF_RPC_BUF_KEEP_MAX    (4 * 1024 * 1024)
+
+/**
+ * Number of consecutive calls with small requests and replies after
+ * which the buffer larger than @ref RCF_RPC_BUF_KEEP_LEN is released.
+ */
+#define RCF_RPC_BUF_SHRINK_CALLS    32
+
+/**
+ * Make sure that the buffer reused by RPC calls has at least the
+ * requested size. The buffer is not shrunk here, so that calls with
+ * similar arguments do not allocate memory (see rcf_rpc_buf_shrink()).
+ *
+ * @param buf           buffer (its contents is not kept)
+ * @param buflen        size of the buffer
+ * @param size          requested size
+ */
+static void
+rcf_rpc_buf_reserve(void **buf, size_t *buflen, size_t size)
+{
+    if (*buflen >= size)
+        return;
+
+    /* Avoid many small reallocations while arguments are growing */
+    size = MAX(size, *buflen * 2);
+
+    free(*buf);
+    *buf = TE_ALLOC(size);
+    *buflen = size;
+}
+
+/**
+ * Release the buffer reused by RPC calls of the server if it is too
+ * large to be kept, or if it has not been needed by a number of
+ * consecutive calls. So calls with large arguments (e.g. big buffers
+ * or many iovecs) reuse the buffer, but a single huge call does not
+ * pin its memory for the lifetime of RPC server handle.
+ *
+ * @param rpcs          RPC server handle
+ * @param used          size of the request or the reply of the last
+ *                      call, whichever is larger
+ */
+static void
+rcf_rpc_buf_shrink(rcf_rpc_server *rpcs, size_t used)
+{
+    if (rpcs->msg_buf_len <= RCF_RPC_BUF_KEEP_LEN)
+    {
+        rpcs->msg_buf_small = 0;
+        return;
+    }
+
+    if (used > RCF_RPC_BUF_KEEP_LEN)
+        rpcs->msg_buf_small = 0;
+    else
+        rpcs->msg_buf_small++;
+
+    if (rpcs->msg_buf_len > RCF_RPC_BUF_KEEP_MAX ||
+        rpcs->msg_buf_small >= RCF_RPC_BUF_SHRINK_CALLS)
+    {
+        free(rpcs->msg_buf);
+        rpcs->msg_buf = NULL;
+        rpcs->msg_buf_len = 0;
+        rpcs->msg_buf_small = 0;
+    }
+}
+
+/**
+ * Call SUN RPC on the TA using buffer reused by calls. Size of the
+ * encoded call is computed beforehand, so that the call is encoded
+ * exactly once. If the reply does not fit in the buffer, memory
+ * allocated for it replaces the buffer.
  *
  * @param ta_name       Test Agent name
  * @param session       TA session or 0
@@ -881,27 +1079,24 @@ extern int rcf_send_recv_msg(rcf_msg *send_buf, size_t send_size,
  * @param rpc_name      Name of the RPC (e.g. "bind")
  * @param in            Input parameter C structure
  * @param out           Output parameter C structure
+ * @param buf           Location of buffer reused by calls (@c NULL
+ *                      if it is not allocated yet)
+ * @param buflen        Location of size of the buffer
+ * @param used          Location for the size of the request or the
+ *                      reply, whichever is larger
  *
  * @return Status code
  */
-te_errno
-rcf_ta_call_rpc(const char *ta_name, int session,
-                const char *rpcserver, int timeout,
-                const char *rpc_name, void *in, void *out)
+static te_errno
+rcf_ta_call_rpc_buf(const char *ta_name, int session,
+                    const char *rpcserver, int timeout,
+                    const char *rpc_name, void *in, void *out,
+                    void **buf, size_t *buflen, size_t *used)
 {
-/** Length of RPC data inside the message */
-#define INSIDE_LEN \
-    (sizeof(((rcf_msg *)0)->file) + sizeof(((rcf_msg *)0)->value))
-
-/** Length of message part before RPC data */
-#define PREFIX_LEN  \
-    (sizeof(rcf_msg) - INSIDE_LEN)
-
-    char     msg_buf[PREFIX_LEN + RCF_RPC_BUF_LEN];
-    rcf_msg *msg = (rcf_msg *)msg_buf;
+    rcf_msg *msg;
     rcf_msg *ans = NULL;
     int      rc;
-    size_t   anslen = sizeof(msg_buf);
+    size_t   anslen;
     size_t   len;
 
     if (ta_name == NULL || strlen(ta_name) >= RCF_MAX_NAME ||
@@ -918,68 +1113,900 @@ rcf_ta_call_rpc(const char *ta_name, int session,
         return TE_RC(TE_RCF_API, TE_EINVAL);
     }
 
-    len = RCF_RPC_BUF_LEN;
-    if ((rc = rpc_xdr_encode_call(rpc_name, msg->file, &len, in)) != 0)
+    if ((rc = rpc_xdr_sizeof_call(rpc_name, in, &len)) != 0)
     {
         if (TE_RC_GET_ERROR(rc) == TE_ENOENT)
-        {
             ERROR("Unknown RPC %s", rpc_name);
-            return rc;
-        }
-
-        /* Try to allocate more memory */
-        len = RCF_RPC_HUGE_BUF_LEN;
-        anslen = PREFIX_LEN + RCF_RPC_HUGE_BUF_LEN;
-        msg = TE_ALLOC(anslen);
-
-        if ((rc = rpc_xdr_encode_call(rpc_name, msg->file, &len, in)) != 0)
-        {
+        else
             ERROR("Encoding of RPC %s input parameters failed: error %r",
                   rpc_name, rc);
-            free(msg);
-            return rc;
-        }
+        return rc;
+    }
+
+    rcf_rpc_buf_reserve(buf, buflen,
+                        RCF_RPC_PREFIX_LEN + MAX(len, RCF_RPC_BUF_LEN));
+    msg = *buf;
+
+    len = *buflen - RCF_RPC_PREFIX_LEN;
+    if ((rc = rpc_xdr_encode_call(rpc_name, msg->file, &len, in)) != 0)
+    {
+        ERROR("Encoding of RPC %s input parameters failed: error %r",
+              rpc_name, rc);
+        return rc;
     }
 
-    memset(msg, 0, PREFIX_LEN);
+    memset(msg, 0, RCF_RPC_PREFIX_LEN);
     msg->opcode = RCFOP_RPC;
     msg->sid = session;
     strcpy(msg->ta, ta_name);
     strcpy(msg->id, rpcserver);
     msg->timeout = timeout;
     msg->intparm = len;
-    msg->data_len = len - INSIDE_LEN;
+    msg->data_len = len - RCF_RPC_INSIDE_LEN;
 
-    rc = rcf_send_recv_msg(msg, PREFIX_LEN + len, msg, &anslen, &ans);
+    anslen = *buflen;
+    rc = rcf_send_recv_msg(msg, RCF_RPC_PREFIX_LEN + len, msg, &anslen,
+                           &ans);
+    *used = RCF_RPC_PREFIX_LEN + len;
+    if (rc == 0)
+        *used = MAX(*used, anslen);
 
     if (ans != NULL)
     {
-        if ((char *)msg != msg_buf)
-            free(msg);
-
+        /* Keep memory allocated for the long reply for further calls */
+        free(*buf);
+        *buf = ans;
+        *buflen = anslen;
         msg = ans;
     }
 
     if (rc != 0 || (rc = msg->error) != 0)
+        return rc;
+
+    rc = rpc_xdr_decode_result(rpc_name, msg->file, msg->intparm, out);
+
+    if (rc != 0)
+        ERROR("Decoding of RPC %s output parameters failed: error %r",
+              rpc_name, rc);
+
+    return rc;
+}
+
+/**
+ * Call RPC via direct connection to Test Agent. If the connection
+ * breaks, it is closed and subsequent calls go via RCF.
+ *
+ * @param rpcs          RPC server
+ * @param rpc_name      name of the RPC (e.g. "bind")
+ * @param in            input parameter C structure
+ * @param out           output parameter C structure
+ * @param used          location for the size of the request or the
+ *                      reply, whichever is larger
+ *
+ * @return Status code
+ */
+static te_errno
+rcf_rpc_direct_call(rcf_rpc_server *rpcs, const char *rpc_name,
+                    void *in, void *out, size_t *used)
+{
+    uint8_t  *req;
+    void     *reply;
+    size_t    len;
+    uint32_t  val;
+    int       timeout;
+    te_errno  rc;
+
+    rc = rpc_xdr_sizeof_call(rpc_name, in, &len);
+    if (rc == 0)
     {
-       if ((char *)msg != msg_buf)
-            free(msg);
+        rcf_rpc_buf_reserve(&rpcs->msg_buf, &rpcs->msg_buf_len,
+                            RCF_RPC_DIRECT_HDR_LEN +
+                            MAX(len, RCF_RPC_BUF_LEN));
+        req = rpcs->msg_buf;
+        len = rpcs->msg_buf_len - RCF_RPC_DIRECT_HDR_LEN;
+        rc = rpc_xdr_encode_call(rpc_name, req + RCF_RPC_DIRECT_HDR_LEN,
+                                 &len, in);
+    }
+    if (rc != 0)
+    {
+        ERROR("Encoding of RPC %s input parameters failed: error %r",
+              rpc_name, rc);
         return rc;
     }
 
-    rc = rpc_xdr_decode_result(rpc_name, msg->file, msg->intparm, out);
+    /* Request is RPC timeout followed by encoded RPC call */
+    val = htonl(rpcs->timeout);
+    memcpy(req, &val, sizeof(val));
+
+    timeout = rpcs->timeout > INT_MAX - RCF_RPC_DIRECT_MARGIN ?
+              -1 : (int)rpcs->timeout + RCF_RPC_DIRECT_MARGIN;
+
+    rc = rcf_rpc_direct_send(rpcs->direct, req,
+                             RCF_RPC_DIRECT_HDR_LEN + len);
+    *used = RCF_RPC_DIRECT_HDR_LEN + len;
+    if (rc == 0)
+    {
+        rc = rcf_rpc_direct_recv(rpcs->direct, rpcs->msg_buf,
+                                 rpcs->msg_buf_len, &reply, &len, timeout);
+    }
+    if (rc == 0)
+        *used = MAX(*used, len);
+    if (rc == 0 && reply != rpcs->msg_buf)
+    {
+        /* Keep memory allocated for the long reply for further calls */
+        free(rpcs->msg_buf);
+        rpcs->msg_buf = reply;
+        rpcs->msg_buf_len = len;
+    }
+    if (rc == 0 && len < RCF_RPC_DIRECT_HDR_LEN)
+        rc = TE_RC(TE_RCF_API, TE_EPROTO);
+    if (rc != 0)
+    {
+        ERROR("Direct connection to RPC server %s is broken, RPC calls "
+              "go via RCF: %r", rpcs->name, rc);
+        rcf_rpc_server_direct_close(rpcs);
+        return rc;
+    }
+
+    /* Reply is status followed by encoded RPC result */
+    memcpy(&val, reply, sizeof(val));
+    rc = ntohl(val);
+    if (rc != 0)
+        return rc;
 
+    rc = rpc_xdr_decode_result(rpc_name,
+                               (uint8_t *)reply + RCF_RPC_DIRECT_HDR_LEN,
+                               len - RCF_RPC_DIRECT_HDR_LEN, out);
     if (rc != 0)
         ERROR("Decoding of RPC %s output parameters failed: error %r",
               rpc_name, rc);
 
-    if ((char *)msg != msg_buf)
-        free(msg);
+    return rc;
+}
+
+/**
+ * Fill in common input arguments, make RPC call and get its status.
+ * Should be called with the lock of RPC server held.
+ *
+ * @param rpcs          RPC server
+ * @param proc          RPC to be called
+ * @param op            RPC operation
+ * @param jobid         job identifier of the operation
+ * @param direct        whether direct connection may be used
+ * @param in_arg        input argument
+ * @param out_arg       output argument
+ *
+ * @return Status code of the request (status of the call is saved
+ *         in rpcs _errno).
+ */
+static te_errno
+rcf_rpc_call_op(rcf_rpc_server *rpcs, const char *proc, rcf_rpc_op op,
+                uint64_t jobid, bool direct, void *in_arg, void *out_arg)
+{
+    tarpc_in_arg  *in = (tarpc_in_arg *)in_arg;
+    tarpc_out_arg *out = (tarpc_out_arg *)out_arg;
+    size_t         used = 0;
+    te_errno       rc;
+
+    in->start = rpcs->start;
+    in->op = op;
+    in->jobid = jobid;
+    in->lib_flags = TARPC_LIB_DEFAULT;
+    if (op != RCF_RPC_WAIT)
+        rpcs->seqno++;
+    in->seqno = rpcs->seqno;
+    if (rpcs->use_libc || rpcs->use_libc_once)
+        in->lib_flags |= TARPC_LIB_USE_LIBC;
+    if (rpcs->use_syscall)
+        in->lib_flags |= TARPC_LIB_USE_SYSCALL;
+
+    rpcs->last_op = op;
+    rpcs->last_use_libc = rpcs->use_libc_once;
+
+    if (rpcs->direct >= 0 && direct)
+        rc = rcf_rpc_direct_call(rpcs, proc, in, out, &used);
+    else
+        rc = rcf_ta_call_rpc_buf(rpcs->ta, rpcs->sid, rpcs->name,
+                                 rpcs->timeout, proc, in, out,
+                                 &rpcs->msg_buf, &rpcs->msg_buf_len,
+                                 &used);
+    rcf_rpc_buf_shrink(rpcs, used);
+    rpcs->_errno = rc;
+
+    if (op != RCF_RPC_CALL)
+        rpcs->timeout = RCF_RPC_UNSPEC_TIMEOUT;
+    rpcs->start = 0;
+    rpcs->use_libc_once = false;
+    if (TE_RC_GET_ERROR(rc) == TE_ERPCTIMEOUT ||
+        TE_RC_GET_ERROR(rc) == TE_ETIMEDOUT ||
+        TE_RC_GET_ERROR(rc) == TE_ERPCDEAD)
+    {
+        rpcs->timed_out = true;
+    }
+
+    if (rc == 0)
+    {
+        rpcs->duration = out->duration;
+        rpcs->_errno = out->_errno;
+
+        if (out->err_str.err_str_len > 0)
+        {
+            TE_STRLCPY(rpcs->err_msg, out->err_str.err_str_val,
+		       RPC_ERROR_MAX_LEN);
+        }
+
+        rpcs->timed_out = false;
+    }
 
     return rc;
+}
 
-#undef INSIDE_LEN
-#undef PREFIX_LEN
+/* See description in rcf_rpc.h */
+void
+rcf_rpc_call(rcf_rpc_server *rpcs, const char *proc,
+             void *in_arg, void *out_arg)
+{
+    tarpc_out_arg *out = (tarpc_out_arg *)out_arg;
+
+    bool op_is_done;
+    bool is_alive;
+
+    if (rpcs == NULL)
+    {
+        ERROR("Invalid RPC server handle is passed to rcf_rpc_call()");
+        return;
+    }
+
+    if (in_arg == NULL || out_arg == NULL || proc == NULL)
+    {
+        rpcs->_errno = TE_RC(TE_RCF_API, TE_EINVAL);
+        return;
+    }
+
+    op_is_done = (strcmp(proc, "rpc_is_op_done") == 0);
+    is_alive = (strcmp(proc, "rpc_is_alive") == 0);
+
+    VERB("Calling RPC %s", proc);
+
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_lock(&rpcs->lock);
+#endif
+    rpcs->_errno = 0;
+    rpcs->err_msg[0] = '\0';
+    rpcs->err_log = false;
+    if (rpcs->timeout == RCF_RPC_UNSPEC_TIMEOUT)
+        rpcs->timeout = rpcs->def_timeout;
+
+    if (!op_is_done && !is_alive &&
+        (rpcs->op == RCF_RPC_CALL ||
+         rpcs->op == RCF_RPC_CALL_WAIT))
+    {
+        if (rpcs->jobid0 != 0)
+        {
+            rpcs->_errno = TE_RC(TE_RCF_API, TE_EBUSY);
+            rpcs->timed_out = true;
+#ifdef HAVE_PTHREAD_H
+            pthread_mutex_unlock(&rpcs->lock);
+#endif
+            return;
+        }
+    }
+    else if (!is_alive)
+    {
+        if (rpcs->jobid0 == 0)
+        {
+            ERROR("Try to wait not called RPC");
+            rpcs->_errno = TE_RC(TE_RCF_API, TE_EALREADY);
+            rpcs->timed_out = true;
+#ifdef HAVE_PTHREAD_H
+            pthread_mutex_unlock(&rpcs->lock);
+#endif
+            return;
+        }
+        else if (strcmp(rpcs->proc, proc) != 0 && !op_is_done)
+        {
+            ERROR("Try to wait RPC %s instead called RPC %s",
+                  proc, rpcs->proc);
+            rpcs->_errno = TE_RC(TE_RCF_API, TE_EPERM);
+            rpcs->timed_out = true;
+#ifdef HAVE_PTHREAD_H
+            pthread_mutex_unlock(&rpcs->lock);
+#endif
+            return;
+        }
+    }
+
+    if (!op_is_done && !is_alive)
+        strcpy(rpcs->proc, proc);
+
+    if (rcf_rpc_call_op(rpcs, proc, rpcs->op, rpcs->jobid0,
+                        !op_is_done && !is_alive, in_arg, out_arg) == 0)
+    {
+        if (rpcs->op == RCF_RPC_CALL)
+        {
+            rpcs->jobid0 = out->jobid;
+            rpcs->op = RCF_RPC_WAIT;
+        }
+        else if (rpcs->op == RCF_RPC_WAIT)
+        {
+            rpcs->jobid0 = 0;
+            rpcs->op = RCF_RPC_CALL_WAIT;
+        }
+    }
+
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_unlock(&rpcs->lock);
+#endif
+}
+
+/* See description in rcf_rpc.h */
+te_errno
+rcf_rpc_server_is_op_done(rcf_rpc_server *rpcs, bool *done)
+{
+    tarpc_rpc_is_op_done_in  in;
+    tarpc_rpc_is_op_done_out out;
+    rcf_rpc_op               old_op;
+
+    if (rpcs == NULL || done == NULL)
+        return TE_RC(TE_RCF, TE_EINVAL);
+
+    memset(&in, 0, sizeof(in));
+    memset(&out, 0, sizeof(out));
+
+    old_op = rpcs->op;
+    rpcs->op = RCF_RPC_CALL_WAIT;
+    rcf_rpc_call(rpcs, "rpc_is_op_done", &in, &out);
+    rpcs->op = old_op;
+
+    if (rpcs->_errno != 0)
+    {
+        ERROR("Failed to call rpc_is_op_done() on the RPC server %s: %r",
+              rpcs->name, rpcs->_errno);
+        return rpcs->_errno;
+    }
+
+    *done = (out.done != 0);
+
+    return 0;
+}
+
+/**
+ * Prepare RPC server for a call of job API: lock it and reset status of
+ * the last operation.
+ *
+ * @param rpcs          RPC server
+ */
+static void
+rcf_rpc_job_lock(rcf_rpc_server *rpcs)
+{
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_lock(&rpcs->lock);
+#endif
+    rpcs->_errno = 0;
+    rpcs->err_msg[0] = '\0';
+    rpcs->err_log = false;
+    if (rpcs->timeout == RCF_RPC_UNSPEC_TIMEOUT)
+        rpcs->timeout = rpcs->def_timeout;
+}
+
+/**
+ * Finish a call of job API started by rcf_rpc_job_lock().
+ *
+ * @param rpcs          RPC server
+ */
+static void
+rcf_rpc_job_unlock(rcf_rpc_server *rpcs)
+{
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_unlock(&rpcs->lock);
+#endif
+}
+
+/* See description in rcf_rpc.h */
+void
+rcf_rpc_job_call(rcf_rpc_server *rpcs, const char *proc, void *in_arg,
+                 rcf_rpc_job *job)
+{
+    rpc_info      *info;
+    tarpc_out_arg *out;
+
+    if (rpcs == NULL)
+    {
+        ERROR("Invalid RPC server handle is passed to %s()", __func__);
+        return;
+    }
+
+    if (in_arg == NULL || proc == NULL || job == NULL)
+    {
+        rpcs->_errno = TE_RC(TE_RCF_API, TE_EINVAL);
+        return;
+    }
+
+    info = rpc_find_info(proc);
+    if (info == NULL)
+    {
+        ERROR("Unknown RPC %s is called as a job", proc);
+        rpcs->_errno = TE_RC(TE_RCF_API, TE_ENOENT);
+        return;
+    }
+    out = TE_ALLOC(info->out_len);
+
+    VERB("Calling RPC %s as a job", proc);
+
+    memset(job, 0, sizeof(*job));
+    rcf_rpc_job_lock(rpcs);
+    if (rcf_rpc_call_op(rpcs, proc, RCF_RPC_JOB, 0, true,
+                        in_arg, out) == 0 && rpcs->_errno == 0)
+    {
+        if (out->jobid == 0)
+        {
+            ERROR("RPC %s cannot be called as a job", proc);
+            rpcs->_errno = TE_RC(TE_RCF_API, TE_EOPNOTSUPP);
+        }
+        else
+        {
+            job->jobid = out->jobid;
+            te_strlcpy(job->proc, proc, sizeof(job->proc));
+        }
+    }
+    rcf_rpc_job_unlock(rpcs);
+
+    rpc_xdr_free(info->out, out);
+    free(out);
+}
+
+/* See description in rcf_rpc.h */
+te_errno
+rcf_rpc_job_is_done(rcf_rpc_server *rpcs, const rcf_rpc_job *job,
+                    bool *done)
+{
+    tarpc_rpc_is_op_done_in  in;
+    tarpc_rpc_is_op_done_out out;
+    te_errno                 rc;
+
+    if (rpcs == NULL || job == NULL || job->jobid == 0 || done == NULL)
+        return TE_RC(TE_RCF_API, TE_EINVAL);
+
+    memset(&in, 0, sizeof(in));
+    memset(&out, 0, sizeof(out));
+
+    rcf_rpc_job_lock(rpcs);
+    rc = rcf_rpc_call_op(rpcs, "rpc_is_op_done", RCF_RPC_CALL_WAIT,
+                         job->jobid, false, &in, &out);
+    if (rc == 0)
+        rc = rpcs->_errno;
+    rcf_rpc_job_unlock(rpcs);
+
+    if (rc != 0)
+    {
+        ERROR("Failed to check status of job %s() on the RPC server %s: "
+              "%r", job->proc, rpcs->name, rc);
+        return rc;
+    }
+
+    *done = (out.done != 0);
+
+    return 0;
+}
+
+/* See description in rcf_rpc.h */
+void
+rcf_rpc_job_wait(rcf_rpc_server *rpcs, const rcf_rpc_job *job,
+                 void *out_arg)
+{
+    rpc_info *info;
+    void     *in;
+
+    if (rpcs == NULL)
+    {
+        ERROR("Invalid RPC server handle is passed to %s()", __func__);
+        return;
+    }
+
+    if (job == NULL || out_arg == NULL)
+    {
+        rpcs->_errno = TE_RC(TE_RCF_API, TE_EINVAL);
+        return;
+    }
+
+    if (job->jobid == 0 || (info = rpc_find_info(job->proc)) == NULL)
+    {
+        ERROR("Try to wait not started job");
+        rpcs->_errno = TE_RC(TE_RCF_API, TE_EALREADY);
+        return;
+    }
+
+    /* Input arguments of the job are kept by RPC server */
+    in = TE_ALLOC(info->in_len);
+
+    VERB("Waiting for job %s", job->proc);
+
+    rcf_rpc_job_lock(rpcs);
+    rcf_rpc_call_op(rpcs, job->proc, RCF_RPC_WAIT, job->jobid, true,
+                    in, out_arg);
+    rcf_rpc_job_unlock(rpcs);
+
+    free(in);
+}
+
+/** Call of a batch as known to the caller */
+typedef struct rcf_rpc_batch_entry {
+    char        proc[RCF_MAX_NAME]; /**< Called RPC */
+    void       *in;                 /**< Input argument */
+    void       *out;                /**< Location for output argument */
+} rcf_rpc_batch_entry;
+
+/** Batch of RPC calls */
+struct rcf_rpc_batch {
+    bool                 stop_on_error; /**< Stop at the first failed
+                                             call */
+    unsigned int         n_calls;       /**< Number of calls */
+    tarpc_batch_call    *calls;         /**< Encoded calls */
+    rcf_rpc_batch_entry *entries;       /**< Arguments of calls */
+};
+
+/**
+ * Encode RPC call into a buffer of the exact size. Size of the encoded
+ * call is computed beforehand, so that the call is encoded once.
+ *
+ * @param proc          RPC name
+ * @param in_arg        input argument
+ * @param buf           buffer (reallocated)
+ * @param len           location for the length of encoded call
+ *
+ * @return Status code.
+ */
+static te_errno
+rcf_rpc_batch_encode(const char *proc, void *in_arg, uint8_t **buf,
+                     size_t *len)
+{
+    te_errno rc;
+
+    rc = rpc_xdr_sizeof_call(proc, in_arg, len);
+    if (rc != 0)
+        return rc;
+
+    TE_REALLOC(*buf, *len);
+    return rpc_xdr_encode_call(proc, *buf, len, in_arg);
+}
+
+/* See description in rcf_rpc.h */
+rcf_rpc_batch *
+rcf_rpc_batch_create(bool stop_on_error)
+{
+    rcf_rpc_batch *batch = TE_ALLOC(sizeof(*batch));
+
+    batch->stop_on_error = stop_on_error;
+
+    return batch;
+}
+
+/* See description in rcf_rpc.h */
+te_errno
+rcf_rpc_batch_add(rcf_rpc_batch *batch, const char *proc, void *in_arg,
+                  void *out_arg)
+{
+    tarpc_in_arg        *in = (tarpc_in_arg *)in_arg;
+    tarpc_batch_call    *call;
+    rcf_rpc_batch_entry *entry;
+    rpc_info            *info;
+    size_t               len;
+    te_errno             rc;
+
+    if (batch == NULL || proc == NULL || in_arg == NULL || out_arg == NULL)
+        return TE_RC(TE_RCF_API, TE_EINVAL);
+
+    info = rpc_find_info(proc);
+    if (info == NULL)
+    {
+        ERROR("Unknown RPC %s is added to the batch", proc);
+        return TE_RC(TE_RCF_API, TE_ENOENT);
+    }
+    if (batch->stop_on_error && !info->int_retval)
+    {
+        ERROR("RPC %s has no integer return value to check it in "
+              "a batch stopped on error", proc);
+        return TE_RC(TE_RCF_API, TE_EINVAL);
+    }
+
+    in->op = RCF_RPC_CALL_WAIT;
+    in->jobid = 0;
+    in->lib_flags = TARPC_LIB_DEFAULT;
+
+    TE_REALLOC(batch->calls, (batch->n_calls + 1) * sizeof(*batch->calls));
+    TE_REALLOC(batch->entries,
+               (batch->n_calls + 1) * sizeof(*batch->entries));
+    call = &batch->calls[batch->n_calls];
+    entry = &batch->entries[batch->n_calls];
+    memset(call, 0, sizeof(*call));
+
+    rc = rcf_rpc_batch_encode(proc, in_arg, &call->call.call_val, &len);
+    if (rc != 0)
+    {
+        ERROR("Failed to encode RPC %s for the batch: %r", proc, rc);
+        free(call->call.call_val);
+        return rc;
+    }
+    call->call.call_len = len;
+
+    te_strlcpy(entry->proc, proc, sizeof(entry->proc));
+    entry->in = in_arg;
+    entry->out = out_arg;
+    batch->n_calls++;
+
+    return 0;
+}
+
+/* See description in rcf_rpc.h */
+te_errno
+rcf_rpc_batch_subst(rcf_rpc_batch *batch, unsigned int src, tarpc_int *arg)
+{
+    rcf_rpc_batch_entry *entry;
+    tarpc_batch_call    *call;
+    rpc_info            *info;
+    tarpc_int            saved;
+    uint8_t             *zeros = NULL;
+    uint8_t             *ones = NULL;
+    size_t               zeros_len;
+    size_t               ones_len;
+    size_t               offset;
+    te_errno             rc;
+
+    if (batch == NULL || batch->n_calls == 0 ||
+        src >= batch->n_calls - 1 || arg == NULL)
+        return TE_RC(TE_RCF_API, TE_EINVAL);
+
+    if (!rpc_find_info(batch->entries[src].proc)->int_retval)
+    {
+        ERROR("RPC %s has no integer return value to substitute",
+              batch->entries[src].proc);
+        return TE_RC(TE_RCF_API, TE_EINVAL);
+    }
+
+    entry = &batch->entries[batch->n_calls - 1];
+    call = &batch->calls[batch->n_calls - 1];
+    info = rpc_find_info(entry->proc);
+    if ((uint8_t *)arg < (uint8_t *)entry->in ||
+        (uint8_t *)(arg + 1) > (uint8_t *)entry->in + info->in_len)
+    {
+        ERROR("Substituted argument is not in input of RPC %s",
+              entry->proc);
+        return TE_RC(TE_RCF_API, TE_EINVAL);
+    }
+
+    /*
+     * Find the argument in the encoded call by encoding it with
+     * all bits cleared and set.
+     */
+    saved = *arg;
+    *arg = 0;
+    rc = rcf_rpc_batch_encode(entry->proc, entry->in, &zeros, &zeros_len);
+    if (rc == 0)
+    {
+        *arg = -1;
+        rc = rcf_rpc_batch_encode(entry->proc, entry->in, &ones,
+                                  &ones_len);
+    }
+    *arg = saved;
+
+    if (rc == 0)
+    {
+        for (offset = 0; offset < zeros_len && offset < ones_len &&
+                         zeros[offset] == ones[offset]; offset++)
+            ;
+
+        if (zeros_len != ones_len ||
+            offset + sizeof(*arg) > zeros_len ||
+            memcmp(zeros + offset + sizeof(*arg),
+                   ones + offset + sizeof(*arg),
+                   zeros_len - offset - sizeof(*arg)) != 0)
+        {
+            ERROR("Substituted argument of RPC %s is not encoded as "
+                  "32-bit integer", entry->proc);
+            rc = TE_RC(TE_RCF_API, TE_EINVAL);
+        }
+    }
+
+    if (rc == 0)
+    {
+        TE_REALLOC(call->subst.subst_val,
+                   (call->subst.subst_len + 1) *
+                   sizeof(*call->subst.subst_val));
+        call->subst.subst_val[call->subst.subst_len++] =
+            (tarpc_batch_subst){ .src = src, .offset = offset };
+    }
+
+    free(zeros);
+    free(ones);
+
+    return rc;
+}
+
+/* See description in rcf_rpc.h */
+void
+rcf_rpc_batch_run(rcf_rpc_server *rpcs, rcf_rpc_batch *batch,
+                  unsigned int *n_done)
+{
+    tarpc_rpc_batch_in   in;
+    tarpc_rpc_batch_out  out;
+    tarpc_batch_result  *result;
+    unsigned int         i;
+    te_errno             rc;
+
+    if (rpcs == NULL)
+    {
+        ERROR("Invalid RPC server handle is passed to %s()", __func__);
+        return;
+    }
+
+    if (n_done != NULL)
+        *n_done = 0;
+
+    if (batch == NULL)
+    {
+        rpcs->_errno = TE_RC(TE_RCF_API, TE_EINVAL);
+        return;
+    }
+
+    if (rpcs->op != RCF_RPC_CALL_WAIT)
+    {
+        ERROR("Batch of RPC calls cannot be called non-blocking");
+        rpcs->_errno = TE_RC(TE_RCF_API, TE_EOPNOTSUPP);
+        return;
+    }
+
+    memset(&in, 0, sizeof(in));
+    memset(&out, 0, sizeof(out));
+    in.stop_on_error = batch->stop_on_error;
+    in.calls.calls_len = batch->n_calls;
+    in.calls.calls_val = batch->calls;
+
+    rcf_rpc_call(rpcs, "rpc_batch", &in, &out);
+
+    /* Results of executed calls are decoded even if the batch failed */
+    for (i = 0; i < out.results.results_len && i < batch->n_calls; i++)
+    {
+        result = &out.results.results_val[i];
+        rc = rpc_xdr_decode_result(batch->entries[i].proc,
+                                   result->result.result_val,
+                                   result->result.result_len,
+                                   batch->entries[i].out);
+        if (rc != 0)
+        {
+            ERROR("Decoding of result of RPC %s in the batch failed: %r",
+                  batch->entries[i].proc, rc);
+            if (rpcs->_errno == 0)
+                rpcs->_errno = rc;
+            break;
+        }
+    }
+    if (n_done != NULL)
+        *n_done = i;
+
+    rcf_rpc_free_result(&out, (xdrproc_t)xdr_tarpc_rpc_batch_out);
+}
+
+/* See description in rcf_rpc.h */
+void
+rcf_rpc_batch_free(rcf_rpc_batch *batch)
+{
+    unsigned int i;
+
+    if (batch == NULL)
+        return;
+
+    for (i = 0; i < batch->n_calls; i++)
+    {
+        free(batch->calls[i].call.call_val);
+        free(batch->calls[i].subst.subst_val);
+    }
+    free(batch->calls);
+    free(batch->entries);
+    free(batch);
+}
+
+/* See description in rcf_rpc.h */
+bool
+rcf_rpc_server_is_alive(rcf_rpc_server *rpcs)
+{
+    tarpc_rpc_is_alive_in   in;
+    tarpc_rpc_is_alive_out  out;
+    rcf_rpc_op              old_op;
+
+    if (rpcs == NULL)
+        return false;
+
+    memset(&in, 0, sizeof(in));
+    memset(&out, 0, sizeof(out));
+
+    old_op = rpcs->op;
+    rpcs->op = RCF_RPC_CALL_WAIT;
+    rcf_rpc_call(rpcs, "rpc_is_alive", &in, &out);
+    rpcs->op = old_op;
+
+    if (rpcs->_errno != 0)
+    {
+        ERROR("Failed to call rpc_is_alive() on the RPC server %s: %r",
+              rpcs->name, rpcs->_errno);
+        return false;
+    }
+    else
+        RING("RPC server %s is alive", rpcs->name);
+
+    return true;
+}
+
+/* See description in rcf_rpc.h */
+te_errno
+rcf_rpc_setlibname(rcf_rpc_server *rpcs, const char *libname)
+{
+    tarpc_setlibname_in  in;
+    tarpc_setlibname_out out;
+    rcf_rpc_op           old_op;
+
+    memset(&in, 0, sizeof(in));
+    memset(&out, 0, sizeof(out));
+
+    if (rpcs == NULL)
+    {
+        ERROR("%s(): Invalid RPC server handle", __FUNCTION__);
+        return -1;
+    }
+
+    in.libname.libname_len = (libname == NULL) ? 0 : (strlen(libname) + 1);
+    in.libname.libname_val = (char *)libname;
+
+    old_op = rpcs->op;
+    rpcs->op = RCF_RPC_CALL_WAIT;
+    rcf_rpc_call(rpcs, "setlibname", &in, &out);
+    rpcs->op = old_op;
+
+    if (!RPC_IS_CALL_OK(rpcs))
+        out.retval = -1;
+
+    LOG_MSG(out.retval != 0 ? TE_LL_ERROR : TE_LL_RING,
+            "RPC (%s,%s) setlibname(%s) -> %d (%s)",
+            rpcs->ta, rpcs->name, libname ? : "(NULL)",
+            out.retval, errno_rpc2str(RPC_ERRNO(rpcs)));
+
+    if (out.retval == 0)
+    {
+        free(rpcs->nv_lib);
+        rpcs->nv_lib = (libname != NULL) ? strdup(libname) : NULL;
+        assert((rpcs->nv_lib == NULL) == (libname == NULL));
+    }
+
+    return out.retval;
+}
+
+/**
+ * Call SUN RPC on the TA.
+ *
+ * @param ta_name       Test Agent name
+ * @param session       TA session or 0
+ * @param rpcserver     Name of the RPC server
+ * @param timeout       RPC timeout in milliseconds or 0 (unlimited)
+ * @param rpc_name      Name of the RPC (e.g. "bind")
+ * @param in            Input parameter C structure
+ * @param out           Output parameter C structure
+ *
+ * @return Status code
+ */
+te_errno
+rcf_ta_call_rpc(const char *ta_name, int session,
+                const char *rpcserver, int timeout,
+                const char *rpc_name, void *in, void *out)
+{
+    void    *buf = NULL;
+    size_t   buflen = 0;
+    size_t   used = 0;
+    te_errno rc;
+
+    rc = rcf_ta_call_rpc_buf(ta_name, session, rpcserver, timeout,
+                             rpc_name, in, out, &buf, &buflen, &used);
+    free(buf);
+
+    return rc;
 }
 
 /* See description in rcf_rpc.h */
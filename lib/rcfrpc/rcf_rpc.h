@@ -170,6 +170,8 @@ typedef struct rcf_rpc_server {
     char        ta[RCF_MAX_NAME];   /**< Test Agent name */
     char        name[RCF_MAX_NAME]; /**< RPC server name */
     int         sid;                /**< RCF session identifier */
+    int         direct;             /**< Socket of direct connection to
+                                         Test Agent or -1 */
 
     /* Returned read-only fields with status of the last operation */
     uint64_t        duration;   /**< Call Duration in microseconds */
@@ -197,6 +199,13 @@ typedef struct rcf_rpc_server {
     char          **namespaces;     /**< Array of namespaces for memory
                                      * pointers (rpc_ptr). */
     size_t          namespaces_len; /**< Amount of elements in @p namespaces */
+
+    void           *msg_buf;        /**< Buffer for RPC requests and replies
+                                         reused by calls */
+    size_t          msg_buf_len;    /**< Size of @p msg_buf */
+    unsigned int    msg_buf_small;  /**< Number of consecutive calls which
+                                         used a small part of large
+                                         @p msg_buf */
 } rcf_rpc_server;
 
 
@@ -470,9 +479,10 @@ rcf_rpc_server_finished(rcf_rpc_server *rpcs)
 }
 
 /**
- * Call SUN RPC on the TA via RCF. The function is also used for
- * checking of status of non-blocking RPC call and waiting for
- * the finish of the non-blocking RPC call.
+ * Call SUN RPC on the TA via RCF (or via direct connection to Test Agent
+ * if it is opened with rcf_rpc_server_direct_open()). The function is
+ * also used for checking of status of non-blocking RPC call and waiting
+ * for the finish of the non-blocking RPC call.
  *
  * @param rpcs          RPC server
  * @param proc          RPC to be called
@@ -505,6 +515,159 @@ extern te_errno rcf_rpc_server_is_op_done(rcf_rpc_server *rpcs,
  */
 extern bool rcf_rpc_server_is_alive(rcf_rpc_server *rpcs);
 
+/** Handle of RPC called as a job */
+typedef struct rcf_rpc_job {
+    uint64_t    jobid;              /**< Job identifier on RPC server */
+    char        proc[RCF_MAX_NAME]; /**< Called RPC */
+} rcf_rpc_job;
+
+/**
+ * Call RPC as a job: the call is executed in a separate thread of
+ * the RPC server and the function returns without waiting for its
+ * completion. Many jobs may be in progress on the same RPC server
+ * at the same time, results are collected by rcf_rpc_job_wait() in any
+ * order. Jobs do not affect non-blocking RPC calls made by
+ * rcf_rpc_call(), ordinary RPC calls may be made on the server while
+ * jobs are in progress.
+ *
+ * @param rpcs          RPC server
+ * @param proc          RPC to be called
+ * @param in_arg        input argument
+ * @param job           location for the handle of the job
+ *
+ * @attention The Status code is returned in rpcs _errno.
+ *            If rpcs is NULL the function does nothing.
+ */
+extern void rcf_rpc_job_call(rcf_rpc_server *rpcs, const char *proc,
+                             void *in_arg, rcf_rpc_job *job);
+
+/**
+ * Check whether a job has been done.
+ *
+ * @param rpcs          RPC server
+ * @param job           handle of the job
+ * @param done          location for the result
+ *
+ * @return Status code
+ */
+extern te_errno rcf_rpc_job_is_done(rcf_rpc_server *rpcs,
+                                    const rcf_rpc_job *job, bool *done);
+
+/**
+ * Wait for completion of a job and get its output. The output should
+ * be released with rcf_rpc_free_result().
+ *
+ * @param rpcs          RPC server
+ * @param job           handle of the job
+ * @param out_arg       output argument
+ *
+ * @attention The Status code is returned in rpcs _errno.
+ *            If rpcs is NULL the function does nothing.
+ */
+extern void rcf_rpc_job_wait(rcf_rpc_server *rpcs, const rcf_rpc_job *job,
+                             void *out_arg);
+
+/** Batch of RPC calls executed on RPC server in one request */
+typedef struct rcf_rpc_batch rcf_rpc_batch;
+
+/**
+ * Create an empty batch of RPC calls.
+ *
+ * @param stop_on_error Do not execute calls following the first failed
+ *                      one. A call is failed if its return value (integer
+ *                      following common output arguments as for socket(),
+ *                      bind(), etc.) is negative. Only RPCs having such
+ *                      return value may be added to the batch.
+ *
+ * @return Batch to be released with rcf_rpc_batch_free().
+ */
+extern rcf_rpc_batch *rcf_rpc_batch_create(bool stop_on_error);
+
+/**
+ * Add RPC call to the batch. Input argument is encoded immediately,
+ * default library is used to resolve the function.
+ *
+ * @param batch         batch of RPC calls
+ * @param proc          RPC to be called
+ * @param in_arg        input argument (should be valid until the next
+ *                      call is added to let rcf_rpc_batch_subst() use it)
+ * @param out_arg       location for output argument filled by
+ *                      rcf_rpc_batch_run(), it should be released with
+ *                      rcf_rpc_free_result()
+ *
+ * @return Status code.
+ * @retval TE_EINVAL    The batch is stopped on error, but @p proc has
+ *                      no integer return value to check it.
+ */
+extern te_errno rcf_rpc_batch_add(rcf_rpc_batch *batch, const char *proc,
+                                  void *in_arg, void *out_arg);
+
+/**
+ * Substitute the return value of an earlier call of the batch
+ * (e.g. socket descriptor returned by socket()) to an argument of
+ * the last added call before its execution.
+ *
+ * @param batch         batch of RPC calls
+ * @param src           index of the earlier call in the batch
+ * @param arg           argument in the input of the last added call
+ *
+ * @return Status code.
+ * @retval TE_EINVAL    The earlier call has no integer return value
+ *                      following common output arguments, or @p arg
+ *                      is not in the input of the last added call.
+ */
+extern te_errno rcf_rpc_batch_subst(rcf_rpc_batch *batch, unsigned int src,
+                                    tarpc_int *arg);
+
+/**
+ * Execute all calls of the batch one after another on RPC server in one
+ * request and get their outputs. The batch may be executed many times.
+ *
+ * @param rpcs          RPC server
+ * @param batch         batch of RPC calls
+ * @param n_done        location for the number of executed calls or
+ *                      @c NULL
+ *
+ * @attention The Status code is returned in rpcs _errno, statuses of
+ *            calls are returned in their outputs.
+ */
+extern void rcf_rpc_batch_run(rcf_rpc_server *rpcs, rcf_rpc_batch *batch,
+                              unsigned int *n_done);
+
+/**
+ * Release a batch of RPC calls.
+ *
+ * @param batch         batch of RPC calls
+ */
+extern void rcf_rpc_batch_free(rcf_rpc_batch *batch);
+
+/**
+ * Open direct connection to Test Agent for RPC calls on the server.
+ *
+ * RPC calls made by rcf_rpc_call() are passed over the connection to
+ * the RPC dispatcher of Test Agent bypassing RCF. The connection is
+ * authenticated by a one-time token obtained from Test Agent via RCF
+ * and is established to the address RCF uses to reach Test Agent.
+ * RCF is still used to create and destroy the server, for execve(),
+ * rpc_is_op_done() and rpc_is_alive(). If the connection breaks,
+ * subsequent calls go via RCF.
+ *
+ * @param rpcs          RPC server handle
+ *
+ * @return Status code.
+ * @retval TE_EOPNOTSUPP    Test Agent is reachable via SSH proxy only or
+ *                          does not support direct connections
+ */
+extern te_errno rcf_rpc_server_direct_open(rcf_rpc_server *rpcs);
+
+/**
+ * Close direct connection to Test Agent, subsequent RPC calls on
+ * the server go via RCF.
+ *
+ * @param rpcs          RPC server handle
+ */
+extern void rcf_rpc_server_direct_close(rcf_rpc_server *rpcs);
+
 /** Free memory allocated by rcf_rpc_call */
 static inline void
 rcf_rpc_free_result(void *out_arg, xdrproc_t out_proc)
@@ -529,6 +692,7 @@ rpcop2str(rcf_rpc_op op)
         case RCF_RPC_CALL:      return " call";
         case RCF_RPC_WAIT:      return " wait";
         case RCF_RPC_CALL_WAIT: return "";
+        case RCF_RPC_JOB:       return " job";
         default:                assert(false);
     }
     return " (unknown)";
@@ -28,6 +28,7 @@
  * [:@attr_name{ssh_proxy}=@attr_val{<ssh-proxy>}]
  * [:@attr_name{copy_timeout}=@attr_val{<timeout>}]
  * [:@attr_name{copy_tries}=@attr_val{<number_of_tries>}]
+ * [:@attr_name{image_cache}=@attr_val{yes|no}]
  * [:@attr_name{kill_timeout}=@attr_val{<timeout>}]
  * [:@attr_val{sudo}][:@attr_val{<shell>}][:@attr_val{<parameters>}]
  * </pre>
@@ -59,6 +60,15 @@
  *   RCFUNIX_COPY_RETRY_SLEEP_FIRST_SEC to RCFUNIX_COPY_RETRY_SLEEP_MAX_SEC
  *   with every next try. If all copy tries fail, Test Agent
  *   start-up procedure fails;
+ * - @attr_name{image_cache} - whether Test Agent image should be copied
+ *   to a remote host via the cache in
+ *   @path{/tmp/te_ta_cache_<user>/<ta_type>} on that host (default is
+ *   @attr_val{yes}). The cache keeps a manifest with checksums of image
+ *   files: if it matches the local image, nothing is copied over the
+ *   network, otherwise only changed files are copied. The run directory
+ *   of the Test Agent is then filled in from the cache on the host.
+ *   The cache is shared by RCF runs of the user, so it is locked with
+ *   @prog{flock} on the host while it is checked and used;
  * - @attr_name{kill_timeout} - specifies the maximum time duration
  *   (in seconds) that is allowed for Test Agent termination procedure;
  * - @attr_val{sudo} - specify this option when we need to run agent under
@@ -179,6 +189,12 @@
 #if HAVE_SYS_WAIT_H
 #include <sys/wait.h>
 #endif
+#if HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#if HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
 
 #include <dirent.h>
 
@@ -186,6 +202,8 @@
 #include "te_defs.h"
 #include "te_stdint.h"
 #include "te_errno.h"
+#include "te_queue.h"
+#include "te_file.h"
 #include "te_shell_cmd.h"
 #include "te_sleep.h"
 #include "te_string.h"
@@ -238,6 +256,11 @@
 
 #define RCFUNIX_DEF_CORE_PATTERN "/var/tmp/core.te.%h-%p-%t"
 
+/** Directory of TA image caches on TA hosts (user name is appended) */
+#define RCFUNIX_IMAGE_CACHE_DIR "/tmp/te_ta_cache_"
+/** Name of TA image manifest file in TA image cache */
+#define RCFUNIX_IMAGE_MANIFEST  ".te_manifest"
+
 /*
  * This library is appropriate for usual and proxy UNIX agents.
  * All agents which type has postfix "ctl" are assumed as proxy.
@@ -270,6 +293,7 @@ typedef struct unix_ta {
                                          copy TA image */
     unsigned int    kill_timeout;   /**< TA kill timeout */
 
+    bool image_cache; /**< Copy TA image via cache on TA host */
     bool sudo;       /**< Manipulate process using sudo */
     bool is_local;   /**< TA is started on the local PC */
 
@@ -875,6 +899,440 @@ stop_core_watcher(unix_ta *ta)
     ta->core_watcher_pid = -1;
 }
 
+/**
+ * Run command copying TA image, retrying it on failure as
+ * configured for the Test Agent.
+ *
+ * @param ta            Test Agent
+ * @param cmd           command to run
+ *
+ * @return Status code.
+ */
+static te_errno
+rcfunix_copy_with_retries(unix_ta *ta, const char *cmd)
+{
+    unsigned int sleep_sec = RCFUNIX_COPY_RETRY_SLEEP_FIRST_SEC;
+    unsigned int i;
+    te_errno     rc;
+
+    for (rc = TE_RC(TE_RCF_UNIX, TE_EFAIL), i = 0; i < ta->copy_tries; i++)
+    {
+        rc = system_with_timeout(ta->copy_timeout, NULL, "%s", cmd);
+        if (rc == 0)
+            break;
+        te_sleep(sleep_sec);
+
+        sleep_sec = MIN(RCFUNIX_COPY_RETRY_SLEEP_MAX_SEC, sleep_sec * 2);
+    }
+
+    return rc;
+}
+
+/** Lock serializing updates of TA image cache on a host */
+typedef struct rcfunix_cache_lock {
+    SLIST_ENTRY(rcfunix_cache_lock) links;  /**< List links */
+    char            host[RCF_MAX_NAME];     /**< Test Agent host */
+    char            ta_type[RCF_MAX_NAME];  /**< Test Agent type */
+    pthread_mutex_t mutex;                  /**< The lock */
+} rcfunix_cache_lock;
+
+/** Locks of TA image caches */
+static SLIST_HEAD(, rcfunix_cache_lock) cache_locks =
+    SLIST_HEAD_INITIALIZER(cache_locks);
+
+/** Lock protecting library-wide data since TAs may be started in parallel */
+static pthread_mutex_t rcfunix_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/** Lock of TA image cache held while the cache is checked and used */
+typedef struct rcfunix_cache_hold {
+    pthread_mutex_t *mutex;     /**< Lock inside RCF process */
+    pid_t            pid;       /**< Shell command holding @prog{flock}
+                                     on TA host */
+    int              in_fd;     /**< Standard input of the command,
+                                     closing it releases the lock */
+} rcfunix_cache_hold;
+
+/**
+ * Get the lock of TA image cache on the host of the Test Agent,
+ * so that agents of the same type on the same host started in parallel
+ * do not update the cache simultaneously.
+ *
+ * @param ta            Test Agent
+ *
+ * @return The lock.
+ */
+static pthread_mutex_t *
+rcfunix_cache_lock_get(const unix_ta *ta)
+{
+    rcfunix_cache_lock *lock;
+
+    pthread_mutex_lock(&rcfunix_lock);
+    SLIST_FOREACH(lock, &cache_locks, links)
+    {
+        if (strcmp(lock->host, ta->host) == 0 &&
+            strcmp(lock->ta_type, ta->ta_type) == 0)
+            break;
+    }
+    if (lock == NULL)
+    {
+        lock = TE_ALLOC(sizeof(*lock));
+        te_strlcpy(lock->host, ta->host, sizeof(lock->host));
+        te_strlcpy(lock->ta_type, ta->ta_type, sizeof(lock->ta_type));
+        pthread_mutex_init(&lock->mutex, NULL);
+        SLIST_INSERT_HEAD(&cache_locks, lock, links);
+    }
+    pthread_mutex_unlock(&rcfunix_lock);
+
+    return &lock->mutex;
+}
+
+/**
+ * Release the lock of TA image cache taken by rcfunix_cache_acquire().
+ *
+ * @param hold          the lock
+ */
+static void
+rcfunix_cache_release(rcfunix_cache_hold *hold)
+{
+    unsigned int i;
+
+    if (hold->in_fd >= 0)
+    {
+        /* Lock holder on TA host exits on EOF */
+        close(hold->in_fd);
+        hold->in_fd = -1;
+    }
+    if (hold->pid > 0)
+    {
+        for (i = 0; i < RCFUNIX_WAITPID_N_MAX; i++)
+        {
+            if (waitpid(hold->pid, NULL, WNOHANG) != 0)
+                break;
+            usleep(RCFUNIX_WAITPID_SLEEP_US);
+        }
+        if (i == RCFUNIX_WAITPID_N_MAX)
+        {
+            killpg(getpgid(hold->pid), SIGKILL);
+            waitpid(hold->pid, NULL, 0);
+        }
+        hold->pid = -1;
+    }
+    if (hold->mutex != NULL)
+    {
+        pthread_mutex_unlock(hold->mutex);
+        hold->mutex = NULL;
+    }
+}
+
+/**
+ * Lock TA image cache on the host of the Test Agent. The cache is
+ * shared by all RCF runs of the user on the host, so besides the lock
+ * inside RCF process, @prog{flock} is taken on the TA host by a shell
+ * command which keeps it until its standard input is closed.
+ *
+ * @param ta            Test Agent
+ * @param cache_dir     cache directory on the TA host
+ * @param hold          location for the lock
+ *
+ * @return Status code.
+ */
+static te_errno
+rcfunix_cache_acquire(unix_ta *ta, const char *cache_dir,
+                      rcfunix_cache_hold *hold)
+{
+    te_string       cmd = TE_STRING_INIT;
+    int             out_fd = -1;
+    char            buf[16] = { 0, };
+    size_t          len = 0;
+    ssize_t         read_rc;
+    struct timeval  tv;
+    fd_set          set;
+    te_errno        rc = 0;
+
+    hold->pid = -1;
+    hold->in_fd = -1;
+    hold->mutex = rcfunix_cache_lock_get(ta);
+    pthread_mutex_lock(hold->mutex);
+
+    te_string_append(&cmd, "%smkdir -p %.*s && exec flock %s.lock "
+                     "sh -c 'echo locked && exec cat >/dev/null'%s",
+                     ta->cmd_prefix.ptr,
+                     (int)(strrchr(cache_dir, '/') - cache_dir), cache_dir,
+                     cache_dir, ta->cmd_suffix);
+    hold->pid = te_shell_cmd(cmd.ptr, -1, &hold->in_fd, &out_fd, NULL);
+    if (hold->pid < 0)
+    {
+        rc = TE_OS_RC(TE_RCF_UNIX, errno);
+        ERROR("Failed to lock TA image cache %s:%s: %r",
+              ta->host, cache_dir, rc);
+        goto out;
+    }
+
+    /* Wait until the lock is taken */
+    while (strncmp(buf, "locked\n", len) == 0 && len < strlen("locked\n"))
+    {
+        tv.tv_sec = ta->copy_timeout;
+        tv.tv_usec = 0;
+        FD_ZERO(&set);
+        FD_SET(out_fd, &set);
+
+        if (select(out_fd + 1, &set, NULL, NULL, &tv) <= 0)
+        {
+            rc = TE_RC(TE_RCF_UNIX, TE_ETIMEDOUT);
+            break;
+        }
+        read_rc = read(out_fd, buf + len, sizeof(buf) - 1 - len);
+        if (read_rc <= 0)
+        {
+            rc = TE_RC(TE_RCF_UNIX, TE_ESHCMD);
+            break;
+        }
+        len += read_rc;
+    }
+    if (rc == 0 && strncmp(buf, "locked\n", len) != 0)
+        rc = TE_RC(TE_RCF_UNIX, TE_ESHCMD);
+    if (rc != 0)
+        ERROR("Failed to lock TA image cache %s:%s: %r",
+              ta->host, cache_dir, rc);
+
+out:
+    if (out_fd >= 0)
+        close(out_fd);
+    te_string_free(&cmd);
+    if (rc != 0)
+        rcfunix_cache_release(hold);
+
+    return rc;
+}
+
+/**
+ * Check whether a manifest contains the line or the file.
+ * Manifest lines are in @prog{md5sum} output format:
+ * "<checksum>  <path>".
+ *
+ * @param manifest      manifest
+ * @param str           line (without newline) or path
+ * @param len           length of @p str
+ * @param path_only     @p str is a path
+ *
+ * @return @c true if found.
+ */
+static bool
+rcfunix_manifest_has(const char *manifest, const char *str, size_t len,
+                     bool path_only)
+{
+    const char *line;
+    const char *end;
+
+    for (line = manifest; *line != '\0'; line = end + (*end != '\0'))
+    {
+        const char *item = line;
+
+        for (end = line; *end != '\n' && *end != '\0'; end++)
+            ;
+
+        if (path_only)
+        {
+            item = strstr(line, "  ");
+            if (item == NULL || item > end)
+                continue;
+            item += 2;
+        }
+
+        if ((size_t)(end - item) == len && strncmp(item, str, len) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * Bring TA image cache on the host of the Test Agent in line with
+ * the local TA image.
+ *
+ * The cache keeps the image and its manifest (checksums of all files).
+ * If the manifest of the cache matches the manifest of the local image,
+ * nothing is copied. Otherwise only new and changed files are copied,
+ * and files which are not in the image any more are removed.
+ * The manifest is removed before the update and written after it, so
+ * an interrupted update is never taken for a valid cache.
+ * The cache should be locked with rcfunix_cache_acquire().
+ *
+ * @param ta            Test Agent
+ * @param ta_type_dir   local directory with TA image
+ * @param cache_dir     cache directory on the TA host
+ *
+ * @return Status code.
+ */
+static te_errno
+rcfunix_update_image_cache(unix_ta *ta, const char *ta_type_dir,
+                           const char *cache_dir)
+{
+    te_string       local = TE_STRING_INIT;
+    te_string       remote = TE_STRING_INIT;
+    te_string       batch = TE_STRING_INIT;
+    te_string       dirs = TE_STRING_INIT;
+    te_string       cmd = TE_STRING_INIT;
+    const char     *tmp_dir = getenv("TE_TMP");
+    const char     *line;
+    const char     *end;
+    char           *manifest_file = NULL;
+    char           *batch_file = NULL;
+    unsigned int    n_put = 0;
+    unsigned int    n_del = 0;
+    te_errno        rc;
+
+    if (tmp_dir == NULL)
+        tmp_dir = "/tmp";
+
+    rc = system_with_timeout(ta->copy_timeout, &local,
+                             "cd %s && find . -type f ! -name %s -print0 | "
+                             "LC_ALL=C sort -z | xargs -0 -r md5sum",
+                             ta_type_dir, RCFUNIX_IMAGE_MANIFEST);
+    if (rc != 0)
+    {
+        ERROR("Failed to make manifest of TA image %s: %r", ta_type_dir, rc);
+        goto out;
+    }
+    /* md5sum escapes special file names with backslash */
+    if (local.len == 0 || strpbrk(local.ptr, "\\\"") != NULL)
+    {
+        WARN("TA image %s cannot be cached", ta_type_dir);
+        rc = TE_RC(TE_RCF_UNIX, TE_EOPNOTSUPP);
+        goto out;
+    }
+
+    rc = system_with_timeout(ta->copy_timeout, &remote,
+                             "%scat %s/%s 2>/dev/null; true%s",
+                             ta->cmd_prefix.ptr, cache_dir,
+                             RCFUNIX_IMAGE_MANIFEST, ta->cmd_suffix);
+    if (rc != 0)
+    {
+        ERROR("Failed to get manifest of TA image cache %s:%s: %r",
+              ta->host, cache_dir, rc);
+        goto out;
+    }
+
+    if (strcmp(local.ptr, te_string_value(&remote)) == 0)
+    {
+        RING("TA image cache %s:%s is up to date", ta->host, cache_dir);
+        goto out;
+    }
+
+    te_string_append(&batch, "-mkdir %.*s\n-mkdir %s\n-rm %s/%s\n",
+                     (int)(strrchr(cache_dir, '/') - cache_dir), cache_dir,
+                     cache_dir, cache_dir, RCFUNIX_IMAGE_MANIFEST);
+
+    for (line = local.ptr; *line != '\0'; line = end + (*end != '\0'))
+    {
+        const char *path;
+        const char *slash;
+
+        end = strchr(line, '\n');
+        if (end == NULL)
+            end = line + strlen(line);
+
+        path = strstr(line, "  ");
+        if (path == NULL || path > end)
+            continue;
+        path += 2;
+
+        /* Paths start with "./", create parent directories */
+        for (slash = strchr(path + 2, '/'); slash != NULL && slash < end;
+             slash = strchr(slash + 1, '/'))
+        {
+            size_t len = slash - path;
+
+            if (rcfunix_manifest_has(te_string_value(&dirs), path, len,
+                                     false))
+                continue;
+
+            te_string_append(&dirs, "%.*s\n", (int)len, path);
+            te_string_append(&batch, "-mkdir \"%s/%.*s\"\n",
+                             cache_dir, (int)len, path);
+        }
+
+        if (rcfunix_manifest_has(te_string_value(&remote), line, end - line,
+                                 false))
+            continue;
+
+        te_string_append(&batch, "put -p \"%s%.*s\" \"%s/%.*s\"\n",
+                         ta_type_dir, (int)(end - path), path,
+                         cache_dir, (int)(end - path), path);
+        n_put++;
+    }
+
+    for (line = te_string_value(&remote); *line != '\0';
+         line = end + (*end != '\0'))
+    {
+        const char *path;
+
+        end = strchr(line, '\n');
+        if (end == NULL)
+            end = line + strlen(line);
+
+        path = strstr(line, "  ");
+        if (path == NULL || path > end)
+            continue;
+        path += 2;
+
+        if (rcfunix_manifest_has(local.ptr, path, end - path, true) ||
+            memchr(path, '"', end - path) != NULL)
+            continue;
+
+        te_string_append(&batch, "-rm \"%s/%.*s\"\n",
+                         cache_dir, (int)(end - path), path);
+        n_del++;
+    }
+
+    manifest_file = te_string_fmt("%s/rcfunix_%s.manifest",
+                                  tmp_dir, ta->ta_name);
+    batch_file = te_string_fmt("%s/rcfunix_%s.batch", tmp_dir, ta->ta_name);
+
+    te_string_append(&batch, "put %s %s/%s\n",
+                     manifest_file, cache_dir, RCFUNIX_IMAGE_MANIFEST);
+
+    rc = te_file_write_string(&local, 0, O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR,
+                              "%s", manifest_file);
+    if (rc == 0)
+    {
+        rc = te_file_write_string(&batch, 0, O_CREAT | O_TRUNC,
+                                  S_IRUSR | S_IWUSR, "%s", batch_file);
+    }
+    if (rc != 0)
+    {
+        ERROR("Failed to write TA image cache update files: %r", rc);
+        goto out;
+    }
+
+    te_string_append(&cmd, "sftp -pq -b %s", batch_file);
+    if (ta->ssh_port != 0)
+        te_string_append(&cmd, " -P %u", ta->ssh_port);
+    te_string_append(&cmd, "%s", ta->ssh_opts.ptr);
+
+    RING("Update TA image cache %s:%s: %u file(s) to copy, %u to remove",
+         ta->host, cache_dir, n_put, n_del);
+    rc = rcfunix_copy_with_retries(ta, cmd.ptr);
+    if (rc != 0)
+        ERROR("Failed to update TA image cache %s:%s: %r",
+              ta->host, cache_dir, rc);
+
+out:
+    if (manifest_file != NULL)
+        unlink(manifest_file);
+    if (batch_file != NULL)
+        unlink(batch_file);
+    free(manifest_file);
+    free(batch_file);
+    te_string_free(&local);
+    te_string_free(&remote);
+    te_string_free(&batch);
+    te_string_free(&dirs);
+    te_string_free(&cmd);
+
+    return rc;
+}
+
 /**
  * Start the Test Agent. Note that it's not necessary
  * to restart the proxy Test Agents after rebooting of
@@ -913,6 +1371,7 @@ rcfunix_start(const char *ta_name, const char *ta_type,
     bool shell_is_bash = true;
 
     unsigned int timestamp;
+    unsigned int ta_seqno;
 
     if (ta_name == NULL || ta_type == NULL ||
         ta_name[0] == '\0' || strlen(ta_name) >= RCF_MAX_NAME ||
@@ -968,14 +1427,18 @@ rcfunix_start(const char *ta_name, const char *ta_type,
     if (logname == NULL)
         logname = "";
     timestamp = (unsigned int)time(NULL);
+    pthread_mutex_lock(&rcfunix_lock);
+    ta_seqno = ++seqno;
+    pthread_mutex_unlock(&rcfunix_lock);
     if (snprintf(ta->run_dir, sizeof(ta->run_dir), "/tmp/%.*s_%s_%u_%u_%u",
                  rcfunix_ta_type_prefix_len(ta_type), ta_type, logname,
-                 (unsigned int)getpid(), timestamp, ++seqno) >=
+                 (unsigned int)getpid(), timestamp, ta_seqno) >=
         (int)sizeof(ta->run_dir))
     {
         ERROR("Failed to compose TA run directory '/tmp/%s_%s_%u_%u_%u' - "
               "provided buffer too small",
-              ta_type, logname, (unsigned int)getpid(), timestamp, seqno);
+              ta_type, logname, (unsigned int)getpid(), timestamp,
+              ta_seqno);
         te_string_free(&cfg_str);
         rcfunix_ta_free(ta);
         return TE_ESMALLBUF;
@@ -1045,6 +1508,15 @@ rcfunix_start(const char *ta_name, const char *ta_type,
             goto bad_conf;
     }
 
+    ta->image_cache = true;
+    if (!te_str_is_null_or_empty(val = te_kvpairs_get(conf, "image_cache")))
+    {
+        if (strcasecmp(val, "no") == 0)
+            ta->image_cache = false;
+        else if (strcasecmp(val, "yes") != 0)
+            goto bad_conf;
+    }
+
     if ((val = te_kvpairs_get(conf, "notcopy")) != NULL)
         WARN("The deprecated RCF parameter 'notcopy' is skipped");
 
@@ -1123,7 +1595,54 @@ rcfunix_start(const char *ta_name, const char *ta_type,
      * DO NOT redirect output to te_tee to see it in logs, since
      * pipeline breaks coping return status.
      */
-    if (ta->is_local)
+    rc = TE_RC(TE_RCF_UNIX, TE_EFAIL);
+    if (!ta->is_local && ta->image_cache && !(*flags & TA_FAKE))
+    {
+        char               cache_dir[RCF_MAX_PATH];
+        rcfunix_cache_hold cache_hold;
+
+        TE_SPRINTF(cache_dir, "%s%s/%s", RCFUNIX_IMAGE_CACHE_DIR,
+                   logname[0] == '\0' ? "te" : logname, ta_type);
+
+        /* Other RCF runs may update the cache while it is used */
+        rc = rcfunix_cache_acquire(ta, cache_dir, &cache_hold);
+        if (rc == 0)
+            rc = rcfunix_update_image_cache(ta, ta_type_dir, cache_dir);
+        if (rc == 0)
+        {
+            /*
+             * Copy on the TA host is cheap. Remove the run directory
+             * if it fails to fall back to copy from the engine host.
+             */
+            te_string_append(&cmd, "%smkdir %s && (cp -a %s/. %s && "
+                             "rm -f %s/%s || (rm -rf %s; false))%s",
+                             ta->cmd_prefix.ptr, ta->run_dir, cache_dir,
+                             ta->run_dir, ta->run_dir,
+                             RCFUNIX_IMAGE_MANIFEST, ta->run_dir,
+                             ta->cmd_suffix);
+            RING("CMD to copy from cache: %s", cmd.ptr);
+            rc = rcfunix_copy_with_retries(ta, cmd.ptr);
+            te_string_reset(&cmd);
+        }
+        rcfunix_cache_release(&cache_hold);
+        if (rc != 0)
+        {
+            WARN("Failed to copy TA image via cache, copy it directly");
+            /*
+             * A timed out copy may leave the run directory which
+             * would break mkdir of the direct copy.
+             */
+            (void)system_with_timeout(ta->copy_timeout, NULL,
+                                      "%srm -rf %s%s", ta->cmd_prefix.ptr,
+                                      ta->run_dir, ta->cmd_suffix);
+        }
+    }
+
+    if (rc == 0)
+    {
+        VERB("TA image is copied from the cache");
+    }
+    else if (ta->is_local)
     {
         /*
          * Do mkdir without -p to be sure that the directory does not
@@ -1157,31 +1676,23 @@ rcfunix_start(const char *ta_name, const char *ta_type,
                          ta->ssh_opts.ptr);
     }
 
-    RING("CMD to copy: %s", cmd.ptr);
-    if (!(*flags & TA_FAKE))
+    if (rc != 0)
     {
-        unsigned int sleep_sec = RCFUNIX_COPY_RETRY_SLEEP_FIRST_SEC;
-        unsigned int i;
-
-        for (rc = TE_RC(TE_RCF_UNIX, TE_EFAIL), i = 0; i < ta->copy_tries; i++)
-        {
-            rc = system_with_timeout(ta->copy_timeout, NULL, "%s", cmd.ptr);
-            if (rc == 0)
-                break;
-            te_sleep(sleep_sec);
-
-            sleep_sec = MIN(RCFUNIX_COPY_RETRY_SLEEP_MAX_SEC, sleep_sec * 2);
-        }
-        if (rc != 0)
-        {
-            ERROR("Failed to copy TA images/data %s to the %s:/tmp: %r",
-                  ta_type, ta->host, rc);
-            ERROR("Failed cmd: %s", cmd.ptr);
-            te_string_free(&cfg_str);
-            te_string_free(&cmd);
-            rcfunix_ta_free(ta);
-            return rc;
-        }
+        RING("CMD to copy: %s", cmd.ptr);
+        if (!(*flags & TA_FAKE))
+            rc = rcfunix_copy_with_retries(ta, cmd.ptr);
+        else
+            rc = 0;
+    }
+    if (rc != 0)
+    {
+        ERROR("Failed to copy TA images/data %s to the %s:/tmp: %r",
+              ta_type, ta->host, rc);
+        ERROR("Failed cmd: %s", cmd.ptr);
+        te_string_free(&cfg_str);
+        te_string_free(&cmd);
+        rcfunix_ta_free(ta);
+        return rc;
     }
 
     /*
@@ -1340,7 +1851,10 @@ rcfunix_start(const char *ta_name, const char *ta_type,
 
     if ((ta_list_file = getenv("TE_TA_LIST_FILE")) != NULL)
     {
-        FILE *f = fopen(ta_list_file, "a");
+        FILE *f;
+
+        pthread_mutex_lock(&rcfunix_lock);
+        f = fopen(ta_list_file, "a");
         if (f != NULL)
         {
             fprintf(f, "%s\t\t%s\t\t%s\t\t%s",
@@ -1349,6 +1863,7 @@ rcfunix_start(const char *ta_name, const char *ta_type,
         }
         else
             ERROR("Failed to open '%s' for writing", ta_list_file);
+        pthread_mutex_unlock(&rcfunix_lock);
     }
 
     return 0;
@@ -1708,4 +2223,19 @@ rcfunix_receive(rcf_talib_handle handle, char *buf, size_t *len, char **pba)
     return rcf_net_engine_receive(((unix_ta *)handle)->conn, buf, len, pba);
 }
 
+/**
+ * Get the file descriptor of the Test Agent connection.
+ *
+ * @param handle        TA handle
+ *
+ * @return File descriptor or -1.
+ */
+static int
+rcfunix_get_fd(rcf_talib_handle handle)
+{
+    return (handle == NULL) ? -1 :
+               rcf_net_engine_fd(((unix_ta *)handle)->conn);
+}
+
 RCF_TALIB_METHODS_DEFINE(rcfunix);
+RCF_TALIB_GET_FD_DEFINE(rcfunix);
@@ -264,10 +264,76 @@ typedef struct deferred_call {
     TAILQ_ENTRY(deferred_call) next;
     uintptr_t      jobid;
     rpc_call_data *call;
+    bool           job;     /**< The call should be executed in own
+                                 thread */
+    bool           started; /**< Thread executing the job is started */
+    pthread_t      thread;  /**< Thread executing the job */
+    rpc_transport_handle handle; /**< Connection to notify TA about
+                                      completion of the job */
 } deferred_call;
 
 TAILQ_HEAD(deferred_call_list, deferred_call);
 
+/**
+ * Lock to serialize messages sent to TA by the main loop of RPC server
+ * and by threads executing jobs.
+ */
+static pthread_mutex_t tarpc_send_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Send a message to TA.
+ *
+ * @param handle        connection handle
+ * @param buf           message
+ * @param len           length of the message
+ *
+ * @return Status code.
+ */
+static te_errno
+tarpc_send(rpc_transport_handle handle, const uint8_t *buf, size_t len)
+{
+    te_errno rc;
+
+    pthread_mutex_lock(&tarpc_send_lock);
+    rc = rpc_transport_send(handle, buf, len);
+    pthread_mutex_unlock(&tarpc_send_lock);
+
+    return rc;
+}
+
+/**
+ * Notify TA that a deferred call is completed.
+ *
+ * @param handle        connection handle
+ * @param jobid         job identifier of the call
+ */
+static void
+tarpc_notify_done(rpc_transport_handle handle, uintptr_t jobid)
+{
+    tarpc_rpc_is_op_done_out result;
+    char enc_result[RCF_MAX_VAL];
+    size_t enc_len = sizeof(enc_result);
+    te_errno rc;
+
+    memset(&result, 0, sizeof(result));
+    result.common.jobid = jobid;
+    result.common.unsolicited = true;
+    result.done = true;
+
+    rc = rpc_xdr_encode_result("rpc_is_op_done", true,
+                               enc_result, &enc_len,
+                               &result);
+    if (rc != 0)
+    {
+        ERROR("Cannot encode rpc_op_is_done result: %r", rc);
+        return;
+    }
+
+    rc = tarpc_send(handle, (uint8_t *)enc_result, enc_len);
+    if (rc != 0)
+        ERROR("Cannot send async call notification: %r", rc);
+}
+
 te_errno
 tarpc_defer_call(deferred_call_list *list,
                  uintptr_t jobid, rpc_call_data *call)
@@ -281,12 +347,51 @@ tarpc_defer_call(deferred_call_list *list,
     return 0;
 }
 
+/** Entry point of the thread executing a job */
+static void *
+tarpc_job_thread(void *arg)
+{
+    deferred_call *defer = arg;
+
+    defer->call->info->wrapper(defer->call);
+    __atomic_store_n(&defer->call->done, true, __ATOMIC_RELEASE);
+    tarpc_notify_done(defer->handle, defer->jobid);
+
+    return NULL;
+}
+
+/**
+ * Start execution of a job in its own thread, so that the RPC server
+ * may receive other calls (and jobs) meanwhile. If the thread cannot
+ * be created, the job is executed as an ordinary deferred call.
+ *
+ * @param defer         deferred call
+ * @param handle        connection to notify TA about completion
+ */
+static void
+tarpc_start_job(deferred_call *defer, rpc_transport_handle handle)
+{
+    int rc;
+
+    defer->handle = handle;
+    rc = pthread_create(&defer->thread, NULL, tarpc_job_thread, defer);
+    if (rc != 0)
+    {
+        ERROR("Failed to start thread for job %s(): %r",
+              defer->call->info->funcname, TE_OS_RC(TE_TA_UNIX, rc));
+        defer->job = false;
+        return;
+    }
+
+    defer->started = true;
+}
+
 bool
 tarpc_has_deferred_calls(const deferred_call_list *list)
 {
     deferred_call *defer = NULL;
     TAILQ_FOREACH(defer, list, next)
-        if (!defer->call->done)
+        if (!__atomic_load_n(&defer->call->done, __ATOMIC_ACQUIRE))
             return true;
     return false;
 }
@@ -309,7 +414,9 @@ tarpc_find_deferred(deferred_call_list *list,
     call = defer->call;
     if (complete)
     {
-        if (!defer->call->done)
+        if (defer->started)
+            pthread_join(defer->thread, NULL);
+        else if (!defer->call->done)
             defer->call->info->wrapper(defer->call);
 
         TAILQ_REMOVE(list, defer, next);
@@ -322,39 +429,25 @@ static void
 tarpc_run_deferred(deferred_call_list *list, rpc_transport_handle handle)
 {
     deferred_call *defer = NULL;
-    tarpc_rpc_is_op_done_out result;
-    char enc_result[RCF_MAX_VAL];
-    size_t enc_len;
-    te_errno rc;
 
+    /*
+     * Jobs are started only after the reply to the call is sent,
+     * so that TA knows the job before its completion is notified.
+     */
     TAILQ_FOREACH(defer, list, next)
     {
-        if (!defer->call->done)
+        if (defer->job && !defer->started)
+            tarpc_start_job(defer, handle);
+    }
+
+    TAILQ_FOREACH(defer, list, next)
+    {
+        if (!defer->started && !defer->call->done)
         {
             defer->call->info->wrapper(defer->call);
             defer->call->done = true;
 
-            enc_len = sizeof(enc_result);
-            memset(&result, 0, sizeof(result));
-            result.common.jobid = defer->jobid;
-            result.common.unsolicited = true;
-            result.done = true;
-
-            rc = rpc_xdr_encode_result("rpc_is_op_done", true,
-                                       enc_result, &enc_len,
-                                       &result);
-            if (rc != 0)
-            {
-                ERROR("Cannot encode rpc_op_is_done result: %r", rc);
-            }
-            else
-            {
-                rc = rpc_transport_send(handle, (uint8_t *)enc_result, enc_len);
-                if (rc != 0)
-                {
-                    ERROR("Cannot send async call notification: %r", rc);
-                }
-            }
+            tarpc_notify_done(handle, defer->jobid);
         }
     }
 }
@@ -396,10 +489,12 @@ tarpc_generic_service(deferred_call_list *async_list, rpc_call_data *call)
             break;
         }
         case RCF_RPC_CALL:
+        case RCF_RPC_JOB:
         {
             rpc_call_data *copy_call;
 
-            VERB("%s(): CALL", call->info->funcname);
+            VERB("%s(): %s", call->info->funcname,
+                 in_common->op == RCF_RPC_JOB ? "JOB" : "CALL");
 
             copy_call = TE_ALLOC(sizeof(*copy_call) +
                                  call->info->in_size +
@@ -422,6 +517,9 @@ tarpc_generic_service(deferred_call_list *async_list, rpc_call_data *call)
                 break;
             }
 
+            if (in_common->op == RCF_RPC_JOB)
+                TAILQ_LAST(async_list, deferred_call_list)->job = true;
+
             /*
              * Preset 'in' and 'out' with zeros to avoid any
              * resource deallocations by the caller.
@@ -795,8 +893,8 @@ rcf_pch_rpc_server(const char *name)
                 reply = "FAILED";
 #endif
 
-            if (rpc_transport_send(handle, (uint8_t *)reply,
-                                   strlen(reply) + 1) == 0)
+            if (tarpc_send(handle, (uint8_t *)reply,
+                           strlen(reply) + 1) == 0)
                 RING("RPC server '%s' finishing status: %s", name, reply);
             else
                 ERROR("Failed to send 'OK' in response to 'FIN'");
@@ -835,7 +933,7 @@ rcf_pch_rpc_server(const char *name)
             rpc_xdr_free(info->out, out);
         free(out);
 
-        if (rpc_transport_send(handle, buf, len) != 0)
+        if (tarpc_send(handle, buf, len) != 0)
             STOP("Sending data failed in main RPC server loop");
 
         tarpc_run_deferred(&deferred_calls, handle);
@@ -617,6 +617,170 @@ _rpc_find_func_1_svc(tarpc_rpc_find_func_in  *in,
     return true;
 }
 
+/*-------------- rpc_batch() ----------------------------*/
+
+/**
+ * Encode result of a call of a batch. Size of the encoded result is
+ * computed beforehand, so that it is encoded exactly once.
+ *
+ * @param name      RPC name
+ * @param rc        value returned by RPC
+ * @param out       output arguments of the call
+ * @param result    location for the encoded result
+ *
+ * @return Status code.
+ */
+static te_errno
+batch_encode_result(const char *name, bool rc, void *out,
+                    tarpc_batch_result *result)
+{
+    size_t   len;
+    te_errno enc_rc;
+
+    enc_rc = rpc_xdr_sizeof_result(name, rc, out, &len);
+    if (enc_rc != 0)
+        return enc_rc;
+    if (len > RCF_RPC_HUGE_BUF_LEN)
+        return TE_RC(TE_TA_UNIX, TE_E2BIG);
+
+    result->result.result_val = TE_ALLOC(len);
+    enc_rc = rpc_xdr_encode_result(name, rc,
+                                   (char *)result->result.result_val,
+                                   &len, out);
+    if (enc_rc != 0)
+    {
+        free(result->result.result_val);
+        result->result.result_val = NULL;
+        return enc_rc;
+    }
+    result->result.result_len = len;
+
+    return 0;
+}
+
+bool_t
+_rpc_batch_1_svc(tarpc_rpc_batch_in *in, tarpc_rpc_batch_out *out,
+                 struct svc_req *rqstp)
+{
+    unsigned int  n_calls = in->calls.calls_len;
+    tarpc_int    *retvals;
+    bool         *has_retval;
+    unsigned int  i;
+    unsigned int  j;
+
+    memset(out, 0, sizeof(*out));
+    if (n_calls == 0)
+        return true;
+
+    retvals = TE_ALLOC(n_calls * sizeof(*retvals));
+    has_retval = TE_ALLOC(n_calls * sizeof(*has_retval));
+    out->results.results_val =
+        TE_ALLOC(n_calls * sizeof(*out->results.results_val));
+
+    for (i = 0; i < n_calls; i++)
+    {
+        tarpc_batch_call *call = &in->calls.calls_val[i];
+        char              name[RCF_RPC_MAX_NAME];
+        void             *call_in = NULL;
+        void             *call_out;
+        tarpc_out_arg    *call_common;
+        rpc_info         *info;
+        bool_t            result;
+        bool              failed;
+        te_errno          rc;
+
+        for (j = 0; j < call->subst.subst_len; j++)
+        {
+            tarpc_batch_subst *subst = &call->subst.subst_val[j];
+            uint32_t           val;
+
+            if (subst->src >= i || call->call.call_len < sizeof(val) ||
+                subst->offset > call->call.call_len - sizeof(val))
+            {
+                ERROR("Invalid substitution to call %u of the batch", i);
+                out->common._errno = TE_RC(TE_TA_UNIX, TE_EINVAL);
+                goto finish;
+            }
+            if (!has_retval[subst->src])
+            {
+                ERROR("Call %u of the batch has no integer return value "
+                      "to substitute to call %u", subst->src, i);
+                out->common._errno = TE_RC(TE_TA_UNIX, TE_EINVAL);
+                goto finish;
+            }
+            val = htonl((uint32_t)retvals[subst->src]);
+            memcpy(call->call.call_val + subst->offset, &val, sizeof(val));
+        }
+
+        rc = rpc_xdr_decode_call(call->call.call_val, call->call.call_len,
+                                 name, &call_in);
+        if (rc != 0)
+        {
+            ERROR("Decoding of call %u of the batch failed: %r", i, rc);
+            out->common._errno = TE_RC(TE_TA_UNIX, TE_EINVAL);
+            goto finish;
+        }
+        info = rpc_find_info(name);
+        assert(info != NULL);
+
+        if (in->stop_on_error && !info->int_retval)
+        {
+            ERROR("RPC %s has no integer return value to check it in "
+                  "a batch stopped on error", name);
+            rpc_xdr_free(info->in, call_in);
+            free(call_in);
+            out->common._errno = TE_RC(TE_TA_UNIX, TE_EINVAL);
+            goto finish;
+        }
+
+        /* Calls of a batch are executed one after another */
+        ((tarpc_in_arg *)call_in)->op = RCF_RPC_CALL_WAIT;
+
+        call_out = TE_ALLOC(info->out_len);
+        call_common = call_out;
+        result = info->rpc(call_in, call_out, rqstp);
+
+        /*
+         * Return value is the integer following common output
+         * arguments as for socket(), bind(), setsockopt(), etc.
+         */
+        if (info->int_retval)
+        {
+            retvals[i] = *(tarpc_int *)((uint8_t *)call_out +
+                                        sizeof(tarpc_out_arg));
+            has_retval[i] = true;
+        }
+        failed = !result || retvals[i] < 0 ||
+                 (call_common->_errno != 0 &&
+                  !RPC_IS_ERRNO_RPC(call_common->_errno));
+
+        rc = batch_encode_result(name, result, call_out,
+                                 &out->results.results_val[i]);
+
+        rpc_xdr_free(info->in, call_in);
+        free(call_in);
+        rpc_xdr_free(info->out, call_out);
+        free(call_out);
+
+        if (rc != 0)
+        {
+            ERROR("Encoding of result of call %u of the batch failed: %r",
+                  i, rc);
+            out->common._errno = rc;
+            goto finish;
+        }
+        out->results.results_len = i + 1;
+
+        if (failed && in->stop_on_error)
+            break;
+    }
+
+finish:
+    free(retvals);
+    free(has_retval);
+    return true;
+}
+
 /*-------------- sizeof() -------------------------------*/
 #define MAX_TYPE_NAME_SIZE 30
 typedef struct {
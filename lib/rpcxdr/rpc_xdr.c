@@ -56,6 +56,7 @@
 
 /**
  * Find information corresponding to RPC function by its name.
+ * The table is sorted by names, so binary search is used.
  *
  * @param name  base function name
  *
@@ -64,11 +65,21 @@
 rpc_info *
 rpc_find_info(const char *name)
 {
-    int i;
+    unsigned int lo = 0;
+    unsigned int hi = tarpc_functions_num;
 
-    for (i = 0; tarpc_functions[i].name != NULL; i++)
-        if (strcmp(name, tarpc_functions[i].name) == 0)
-            return tarpc_functions + i;
+    while (lo < hi)
+    {
+        unsigned int mid = lo + (hi - lo) / 2;
+        int          cmp = strcmp(name, tarpc_functions[mid].name);
+
+        if (cmp == 0)
+            return tarpc_functions + mid;
+        if (cmp < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
 
     return NULL;
 }
@@ -125,6 +136,33 @@ rpc_xdr_encode_call(const char *name, void *buf, size_t *buflen, void *objp)
     return 0;
 }
 
+/* See description in rpc_xdr.h */
+int
+rpc_xdr_sizeof_call(const char *name, void *objp, size_t *len)
+{
+    rpc_info     *info;
+    unsigned long size;
+
+    if ((info = rpc_find_info(name)) == NULL)
+        return TE_RC(TE_RCF_RPC, TE_ENOENT);
+
+#ifdef RPC_XML
+    UNUSED(objp);
+    UNUSED(len);
+    UNUSED(size);
+    return TE_RC(TE_RCF_RPC, TE_EOPNOTSUPP);
+#else
+    size = xdr_sizeof((xdrproc_t)info->in, objp);
+    if (size == 0)
+        return TE_RC(TE_RCF_RPC, TE_ESUNRPC);
+
+    /* Length and bytes of routine name precede the argument */
+    *len = sizeof(uint32_t) + strlen(name) + 1 + size;
+
+    return 0;
+#endif
+}
+
 static te_errno
 decode_result_start(XDR *xdrp, const void *buf, size_t buflen)
 {
@@ -337,6 +375,37 @@ rpc_xdr_encode_result(const char *name, bool rc,
     return 0;
 }
 
+/* See description in rpc_xdr.h */
+int
+rpc_xdr_sizeof_result(const char *name, bool rc, void *objp, size_t *len)
+{
+    rpc_info     *info;
+    unsigned long size = 0;
+
+    if ((info = rpc_find_info(name)) == NULL)
+        return TE_RC(TE_RCF_RPC, TE_ENOENT);
+
+#ifdef RPC_XML
+    UNUSED(rc);
+    UNUSED(objp);
+    UNUSED(len);
+    UNUSED(size);
+    return TE_RC(TE_RCF_RPC, TE_EOPNOTSUPP);
+#else
+    if (rc)
+    {
+        size = xdr_sizeof((xdrproc_t)info->out, objp);
+        if (size == 0)
+            return TE_RC(TE_RCF_RPC, TE_ESUNRPC);
+    }
+
+    /* Return code precedes the result */
+    *len = sizeof(uint32_t) + size;
+
+    return 0;
+#endif
+}
+
 te_errno
 rpc_xdr_inspect_call(const void *buf, size_t buflen, char *name,
                      struct tarpc_in_arg *common)
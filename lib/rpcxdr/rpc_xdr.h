@@ -44,13 +44,20 @@ typedef struct {
     int           in_len;  /**< Size of the input argument structure */
     rpc_arg_func  out;     /**< Address of output argument encoder/decoder */
     int           out_len; /**< Size of the output argument structure */
+    bool          int_retval; /**< Output argument has tarpc_int return
+                                   value right after common output
+                                   arguments (as for socket(), bind(),
+                                   etc.) */
 } rpc_info;
 
-/** RPC functions table; generated automatically
+/** RPC functions table sorted by names; generated automatically
  *  @note This will be soon moved to another library
  */
 extern rpc_info tarpc_functions[];
 
+/** Number of entries in RPC functions table (excluding terminating one) */
+extern const unsigned int tarpc_functions_num;
+
 /**
  * Find information corresponding to RPC function by its name.
  *
@@ -77,6 +84,19 @@ extern rpc_info *rpc_find_info(const char *name);
 extern int rpc_xdr_encode_call(const char *name, void *buf, size_t *buflen,
                                void *objp);
 
+/**
+ * Get length of RPC call encoded by rpc_xdr_encode_call().
+ *
+ * @param name          RPC name
+ * @param objp          input parameters structure
+ * @param len           location for the length
+ *
+ * @return Status code
+ * @retval TE_ENOENT    No such function
+ * @retval TE_ESUNRPC   Encoding error
+ */
+extern int rpc_xdr_sizeof_call(const char *name, void *objp, size_t *len);
+
 /**
  * Encode RPC result.
  *
@@ -94,6 +114,21 @@ extern int rpc_xdr_encode_call(const char *name, void *buf, size_t *buflen,
 extern int rpc_xdr_encode_result(const char *name, bool rc,
                                  void *buf, size_t *buflen, void *objp);
 
+/**
+ * Get length of RPC result encoded by rpc_xdr_encode_result().
+ *
+ * @param name          RPC name
+ * @param rc            value returned by RPC
+ * @param objp          output parameters structure
+ * @param len           location for the length
+ *
+ * @return Status code
+ * @retval TE_ENOENT    No such function
+ * @retval TE_ESUNRPC   Encoding error
+ */
+extern int rpc_xdr_sizeof_result(const char *name, bool rc, void *objp,
+                                 size_t *len);
+
 
 /**
  * Decode RPC call.
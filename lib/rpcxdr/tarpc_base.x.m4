@@ -534,6 +534,49 @@ struct tarpc_rpc_is_op_done_out {
 typedef struct tarpc_void_in  tarpc_rpc_is_alive_in;
 typedef struct tarpc_void_out tarpc_rpc_is_alive_out;
 
+/* rpc_batch() */
+
+/**
+ * Substitution of the return value of an earlier call of a batch
+ * to an argument of a later call.
+ */
+struct tarpc_batch_subst {
+    tarpc_uint  src;        /**< Index of the call which return value
+                                 is substituted */
+    tarpc_uint  offset;     /**< Offset of 32-bit integer argument in
+                                 the encoded call */
+};
+
+/** Call of a batch */
+struct tarpc_batch_call {
+    uint8_t                     call<>;     /**< Call encoded by
+                                                 rpc_xdr_encode_call() */
+    struct tarpc_batch_subst    subst<>;    /**< Substitutions to the
+                                                 call */
+};
+
+/** Result of a call of a batch */
+struct tarpc_batch_result {
+    uint8_t     result<>;   /**< Result encoded by
+                                 rpc_xdr_encode_result() */
+};
+
+struct tarpc_rpc_batch_in {
+    struct tarpc_in_arg common;
+
+    tarpc_bool                  stop_on_error;  /**< Do not execute
+                                                     calls after the first
+                                                     failed one */
+    struct tarpc_batch_call     calls<>;        /**< Calls of the batch */
+};
+
+struct tarpc_rpc_batch_out {
+    struct tarpc_out_arg common;
+
+    struct tarpc_batch_result   results<>;  /**< Results of executed
+                                                 calls */
+};
+
 /* setlibname() */
 
 struct tarpc_setlibname_in {
@@ -5548,6 +5591,7 @@ program tarpc
         RPC_DEF(rpc_find_func)
         RPC_DEF(rpc_is_op_done)
         RPC_DEF(rpc_is_alive)
+        RPC_DEF(rpc_batch)
         RPC_DEF(setlibname)
 
         RPC_DEF(get_sizeof)
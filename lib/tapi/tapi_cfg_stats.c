@@ -79,7 +79,29 @@ tapi_cfg_stats_if_stats_get(const char          *ta,
                             const char          *ifname,
                             tapi_cfg_if_stats   *stats)
 {
+#define TAPI_CFG_STATS_IF_COUNTER(_counter_) \
+    { #_counter_, offsetof(tapi_cfg_if_stats, _counter_) }
+    static const struct {
+        const char *name;
+        size_t      offset;
+    } counters[] = {
+        TAPI_CFG_STATS_IF_COUNTER(in_octets),
+        TAPI_CFG_STATS_IF_COUNTER(in_ucast_pkts),
+        TAPI_CFG_STATS_IF_COUNTER(in_nucast_pkts),
+        TAPI_CFG_STATS_IF_COUNTER(in_discards),
+        TAPI_CFG_STATS_IF_COUNTER(in_errors),
+        TAPI_CFG_STATS_IF_COUNTER(in_unknown_protos),
+        TAPI_CFG_STATS_IF_COUNTER(out_octets),
+        TAPI_CFG_STATS_IF_COUNTER(out_ucast_pkts),
+        TAPI_CFG_STATS_IF_COUNTER(out_nucast_pkts),
+        TAPI_CFG_STATS_IF_COUNTER(out_discards),
+        TAPI_CFG_STATS_IF_COUNTER(out_errors),
+    };
+#undef TAPI_CFG_STATS_IF_COUNTER
+
+    cfg_batch_req       reqs[TE_ARRAY_LEN(counters)];
     te_errno            rc;
+    unsigned int        i;
 
     VERB("%s(ta=%s, ifname=%s, stats=%x) started",
          __FUNCTION__, ta, ifname, stats);
@@ -107,37 +129,34 @@ tapi_cfg_stats_if_stats_get(const char          *ta,
 
     VERB("Get stats counters");
 
-#define TAPI_CFG_STATS_IF_COUNTER_GET(_counter_) \
-    do                                                      \
-    {                                                       \
-        VERB("IF_COUNTER_GET(%s)", #_counter_);             \
-        rc = cfg_get_instance_uint64_fmt(&stats->_counter_, \
-                 "/agent:%s/interface:%s/stats:/%s:",       \
-                 ta, ifname, #_counter_);                   \
-        if (rc != 0)                                        \
-        {                                                   \
-            ERROR("Failed to get %s counter for "           \
-                  "interface %s on %s Test Agent: %r",      \
-                  #_counter_, ifname, ta, rc);              \
-            return rc;                                      \
-        }                                                   \
-    } while (0)
-
-    TAPI_CFG_STATS_IF_COUNTER_GET(in_octets);
-    TAPI_CFG_STATS_IF_COUNTER_GET(in_ucast_pkts);
-    TAPI_CFG_STATS_IF_COUNTER_GET(in_nucast_pkts);
-    TAPI_CFG_STATS_IF_COUNTER_GET(in_discards);
-    TAPI_CFG_STATS_IF_COUNTER_GET(in_errors);
-    TAPI_CFG_STATS_IF_COUNTER_GET(in_unknown_protos);
-    TAPI_CFG_STATS_IF_COUNTER_GET(out_octets);
-    TAPI_CFG_STATS_IF_COUNTER_GET(out_ucast_pkts);
-    TAPI_CFG_STATS_IF_COUNTER_GET(out_nucast_pkts);
-    TAPI_CFG_STATS_IF_COUNTER_GET(out_discards);
-    TAPI_CFG_STATS_IF_COUNTER_GET(out_errors);
+    /* All counters are obtained in a single request */
+    memset(reqs, 0, sizeof(reqs));
+    for (i = 0; i < TE_ARRAY_LEN(counters); i++)
+    {
+        reqs[i].op = CFG_BATCH_OP_GET;
+        reqs[i].oid = te_string_fmt("/agent:%s/interface:%s/stats:/%s:",
+                                    ta, ifname, counters[i].name);
+        reqs[i].type = CVT_UINT64;
+    }
 
-#undef TAPI_CFG_STATS_IF_COUNTER_GET
+    rc = cfg_batch_process(reqs, TE_ARRAY_LEN(counters), false);
+    for (i = 0; i < TE_ARRAY_LEN(counters); i++)
+    {
+        if (reqs[i].rc == 0)
+        {
+            *(uint64_t *)((uint8_t *)stats + counters[i].offset) =
+                reqs[i].val.val_uint64;
+        }
+        else if (rc != 0)
+        {
+            ERROR("Failed to get %s counter for "
+                  "interface %s on %s Test Agent: %r",
+                  counters[i].name, ifname, ta, reqs[i].rc);
+        }
+        free((char *)reqs[i].oid);
+    }
 
-    return 0;
+    return rc;
 }
 
 /* See description in tapi_cfg_stats.h */
@@ -147,9 +166,9 @@ tapi_cfg_stats_if_xstats_get(const char         *ta,
                              tapi_cfg_if_xstats *xstats)
 {
     te_errno            rc;
-    unsigned int        n_xstats;
-    cfg_handle         *xstats_handles;
-    size_t              req_size;
+    unsigned int        n_insts;
+    cfg_subtree_inst   *insts;
+    unsigned int        n_xstats = 0;
     tapi_cfg_if_xstat  *result;
     unsigned int        i;
 
@@ -176,68 +195,61 @@ tapi_cfg_stats_if_xstats_get(const char         *ta,
         return rc;
 
     VERB("Get xstats counters");
-    rc = cfg_find_pattern_fmt(&n_xstats, &xstats_handles,
-                              "/agent:%s/interface:%s/xstats:/xstat:*",
-                              ta, ifname);
 
-    if ((rc != 0 && TE_RC_GET_ERROR(rc) == TE_ENOENT) ||
-        (rc == 0 && n_xstats == 0))
+    /* OIDs and values of all counters are obtained in a single request */
+    rc = cfg_get_subtree_fmt(&insts, &n_insts,
+                             "/agent:%s/interface:%s/xstats:", ta, ifname);
+    if (TE_RC_GET_ERROR(rc) == TE_ENOENT)
     {
         xstats->num = 0;
         return 0;
     }
     if (rc != 0)
     {
-        ERROR("cfg_find_pattern_fmt(/agent/interface/xstats/xstat) failed %r",
-              rc);
+        ERROR("cfg_get_subtree_fmt(/agent/interface/xstats) failed %r", rc);
         return rc;
     }
 
-    req_size = sizeof(tapi_cfg_if_xstat) * n_xstats;
-    result = TE_ALLOC(req_size);
+    result = TE_ALLOC(sizeof(tapi_cfg_if_xstat) * n_insts);
 
-    for (i = 0; i < n_xstats; i++)
+    for (i = 0; i < n_insts; i++)
     {
-        uint64_t  xstat_val;
-        char     *xstat_oid = NULL;
-        char     *xstat_name;
+        const char *last_subid = strrchr(insts[i].oid, '/');
+        char       *xstat_name;
 
-        /* Get net OID as string */
-        rc = cfg_get_oid_str(xstats_handles[i], &xstat_oid);
-        if (rc != 0)
-        {
-            ERROR("%s(): cfg_get_oid_str() failed %r", __FUNCTION__, rc);
-            break;
-        }
+        if (last_subid == NULL ||
+            strcmp_start("/xstat:", last_subid) != 0)
+            continue;
 
-        rc = cfg_get_uint64(&xstat_val, "%s", xstat_oid);
-        if (rc != 0)
+        if (insts[i].type != CVT_UINT64)
         {
-            ERROR("%s(): failed to get value for %s", __FUNCTION__, xstat_oid);
-            free(xstat_oid);
+            ERROR("%s(): unexpected type of %s", __FUNCTION__,
+                  insts[i].oid);
+            rc = TE_RC(TE_TAPI, TE_EBADTYPE);
             break;
         }
 
-        xstat_name = cfg_oid_str_get_inst_name(xstat_oid, -1);
+        xstat_name = cfg_oid_str_get_inst_name(insts[i].oid, -1);
         if (xstat_name == NULL)
         {
             ERROR("%s(): Failed to get the last instance name from OID '%s'",
-                  __FUNCTION__, xstat_oid);
-            free(xstat_oid);
+                  __FUNCTION__, insts[i].oid);
             rc = TE_RC(TE_TAPI, TE_EFAULT);
             break;
         }
 
-        te_strlcpy(result[i].name, xstat_name, TAPI_CFG_MAX_XSTAT_NAME);
-        result[i].value = xstat_val;
-        free(xstat_oid);
+        te_strlcpy(result[n_xstats].name, xstat_name,
+                   TAPI_CFG_MAX_XSTAT_NAME);
+        result[n_xstats].value = insts[i].val.val_uint64;
+        n_xstats++;
         free(xstat_name);
     }
 
-    free(xstats_handles);
-    if (rc != 0)
+    cfg_subtree_free(insts, n_insts);
+    if (rc != 0 || n_xstats == 0)
     {
         free(result);
+        xstats->num = 0;
     }
     else
     {
@@ -38,32 +38,25 @@ maybe_open_dev_null(const int *fd_arg, bool input, int *dev_null_fd)
 }
 
 /**
- * Create a pipe, set close-on-exec flag on a descriptor that will
- * be used (meaning will remain opened after the call) by parent process
- * (write end of input pipe or read end of output pipe).
+ * Create a pipe with close-on-exec flag set on both ends atomically.
+ * Children may be forked by several threads at once (e.g. when Test
+ * Agents are started in parallel), so a pipe must never be visible
+ * without the flag, otherwise a child of another thread inherits it
+ * and the reader of the pipe does not get EOF until that child exits.
+ * The flag is cleared on the end used by the child after fork().
  */
 static int
-pipe_cloexec_parent_end(int pipe_fd[2], bool input)
+pipe_cloexec(int pipe_fd[2])
 {
-    int rc;
-    int result[2];
-    int parent_end;
-
-    if ((rc = pipe(result)) != 0)
-        return rc;
-
-    parent_end = input ? result[1] : result[0];
-
-    if ((rc = fcntl(parent_end, F_SETFD, FD_CLOEXEC)) < 0)
-    {
-        close(result[0]);
-        close(result[1]);
-    }
-
-    pipe_fd[0] = result[0];
-    pipe_fd[1] = result[1];
+    return pipe2(pipe_fd, O_CLOEXEC);
+}
 
-    return 0;
+/** Clear close-on-exec flag on the pipe end used by the child */
+static void
+child_end_keep(int fd)
+{
+    if (fcntl(fd, F_SETFD, 0) < 0)
+        ERROR("Failed to clear close-on-exec flag: %s", strerror(errno));
 }
 
 static te_errno
@@ -208,9 +201,9 @@ te_exec_child(const char *file, char *const argv[],
         errno = EINVAL;
         return -1;
     }
-    if (VALID_FD_PTR(in_fd) && pipe_cloexec_parent_end(in_pipe, true) != 0)
+    if (VALID_FD_PTR(in_fd) && pipe_cloexec(in_pipe) != 0)
         return -1;
-    if (VALID_FD_PTR(out_fd) && pipe_cloexec_parent_end(out_pipe, false) != 0)
+    if (VALID_FD_PTR(out_fd) && pipe_cloexec(out_pipe) != 0)
     {
         if (VALID_FD_PTR(in_fd))
         {
@@ -219,7 +212,7 @@ te_exec_child(const char *file, char *const argv[],
         }
         return -1;
     }
-    if (VALID_FD_PTR(err_fd) && pipe_cloexec_parent_end(err_pipe, false) != 0)
+    if (VALID_FD_PTR(err_fd) && pipe_cloexec(err_pipe) != 0)
     {
         if (VALID_FD_PTR(in_fd))
         {
@@ -259,6 +252,7 @@ te_exec_child(const char *file, char *const argv[],
         if (VALID_FD_PTR(in_fd))
         {
             close(in_pipe[1]);
+            child_end_keep(in_pipe[0]);
             pipe_fd[0] = in_pipe[0];
         }
         else if (in_fd == TE_EXEC_CHILD_DEV_NULL_FD && dev_null_fd[0] >= 0)
@@ -269,6 +263,7 @@ te_exec_child(const char *file, char *const argv[],
         if (VALID_FD_PTR(out_fd))
         {
             close(out_pipe[0]);
+            child_end_keep(out_pipe[1]);
             pipe_fd[1] = out_pipe[1];
         }
         else if (out_fd == TE_EXEC_CHILD_DEV_NULL_FD && dev_null_fd[1] >= 0)
@@ -279,6 +274,7 @@ te_exec_child(const char *file, char *const argv[],
         if (VALID_FD_PTR(err_fd))
         {
             close(err_pipe[0]);
+            child_end_keep(err_pipe[1]);
             pipe_fd[2] = err_pipe[1];
         }
         else if (err_fd == TE_EXEC_CHILD_DEV_NULL_FD && dev_null_fd[2] >= 0)
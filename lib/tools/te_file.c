@@ -825,3 +825,49 @@ te_file_extract_glob(const char *filename, const char *pattern,
 
     return result;
 }
+
+/* See description in te_file.h */
+te_errno
+te_file_crc32(int fd, uint64_t *size, uint32_t *crc)
+{
+    static const size_t bufsize = 65536;
+    uint32_t table[256];
+    uint32_t value = UINT32_MAX;
+    uint64_t total = 0;
+    uint8_t *buf;
+    ssize_t len;
+    unsigned int i;
+    unsigned int j;
+
+    for (i = 0; i < TE_ARRAY_LEN(table); i++)
+    {
+        uint32_t c = i;
+
+        for (j = 0; j < 8; j++)
+            c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+        table[i] = c;
+    }
+
+    buf = TE_ALLOC(bufsize);
+    while ((len = pread(fd, buf, bufsize, total)) > 0)
+    {
+        for (i = 0; i < (size_t)len; i++)
+            value = table[(value ^ buf[i]) & 0xFF] ^ (value >> 8);
+        total += len;
+    }
+    free(buf);
+
+    if (len < 0)
+    {
+        te_errno rc = TE_OS_RC(TE_MODULE_NONE, errno);
+
+        ERROR("%s(): pread() failed: %r", __func__, rc);
+        return rc;
+    }
+
+    if (size != NULL)
+        *size = total;
+    *crc = ~value;
+
+    return 0;
+}
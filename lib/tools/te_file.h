@@ -453,6 +453,20 @@ extern te_errno te_file_scandir(const char *dirname,
 extern char *te_file_extract_glob(const char *filename, const char *pattern,
                                   bool basename);
 
+/**
+ * Compute CRC-32 (the polynomial used by Ethernet and zlib) of
+ * the contents of a file from its beginning up to the end.
+ * The current file offset is not changed.
+ *
+ * @param[in]  fd       file descriptor opened for reading
+ * @param[out] size     location for the number of bytes read
+ *                      (may be @c NULL)
+ * @param[out] crc      location for the checksum
+ *
+ * @return Status code
+ */
+extern te_errno te_file_crc32(int fd, uint64_t *size, uint32_t *crc);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
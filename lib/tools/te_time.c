@@ -60,3 +60,13 @@ te_timersub(const struct timeval *a, const struct timeval *b,
     difference_us = TE_SEC2US(a->tv_sec - b->tv_sec) + a->tv_usec - b->tv_usec;
     TE_US2TV(difference_us, res);
 }
+
+/* See description in te_time.h */
+uint64_t
+te_time_monotonic_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return TE_SEC2NS((uint64_t)ts.tv_sec) + ts.tv_nsec;
+}
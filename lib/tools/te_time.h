@@ -56,6 +56,14 @@ extern te_errno te_gettimeofday(struct timeval *tv, struct timezone *tz);
 extern void te_timersub(const struct timeval *a, const struct timeval *b,
                         struct timeval *res);
 
+/**
+ * Get current time of the monotonic clock in nanoseconds. It is
+ * suitable to measure durations, but not to get the date.
+ *
+ * @return Time in nanoseconds since an unspecified point in the past.
+ */
+extern uint64_t te_time_monotonic_ns(void);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
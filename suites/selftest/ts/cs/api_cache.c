@@ -0,0 +1,154 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/* Copyright (C) 2023 OKTET Labs Ltd. All rights reserved. */
+/** @file
+ * @brief Cache of read requests in confapi
+ *
+ * Check that results of read requests cached in the process are
+ * dropped when the Configurator database is changed.
+ */
+
+/** @page cs-api_cache Cache of read requests in confapi
+ *
+ * @objective Check that values cached by confapi are returned until
+ *            the Configurator database is changed and the new value
+ *            is returned after the change made by the process itself
+ *            or learned by the Configurator from the Test Agent.
+ *
+ * @param pco_iut   RPC server on IUT
+ * @param n_reads   number of reads for measurement
+ *
+ * @par Scenario:
+ */
+
+#define TE_TEST_NAME "cs/api_cache"
+
+#ifndef TEST_START_VARS
+#define TEST_START_VARS TEST_START_ENV_VARS
+#endif
+
+#ifndef TEST_START_SPECIFIC
+#define TEST_START_SPECIFIC TEST_START_ENV
+#endif
+
+#ifndef TEST_END_SPECIFIC
+#define TEST_END_SPECIFIC TEST_END_ENV
+#endif
+
+#include "te_config.h"
+
+
+#include "tapi_test.h"
+#include "tapi_env.h"
+#include "conf_api.h"
+#include "te_mi_log.h"
+#include "te_time.h"
+#include "tapi_rpc_stdio.h"
+
+/** Object instance changed by the test */
+#define API_CACHE_OID   "/agent:%s/sys:/net:/core:/somaxconn:"
+
+/**
+ * Read the value @p n_reads times and measure the mean time of read.
+ *
+ * @param ta            Test Agent name
+ * @param n_reads       number of reads
+ *
+ * @return Mean time of read in nanoseconds.
+ */
+static double
+measure_reads(const char *ta, unsigned int n_reads)
+{
+    uint64_t     start = te_time_monotonic_ns();
+    int32_t      value;
+    unsigned int i;
+
+    for (i = 0; i < n_reads; i++)
+        CHECK_RC(cfg_get_int32(&value, API_CACHE_OID, ta));
+
+    return (double)(te_time_monotonic_ns() - start) / MAX(n_reads, 1);
+}
+
+/**
+ * Check that the value read via confapi is expected.
+ *
+ * @param ta            Test Agent name
+ * @param expected      expected value
+ * @param stage         description of the check for verdict
+ */
+static void
+check_value(const char *ta, int32_t expected, const char *stage)
+{
+    int32_t value;
+
+    CHECK_RC(cfg_get_int32(&value, API_CACHE_OID, ta));
+    if (value != expected)
+    {
+        TEST_VERDICT("%s: %d is read instead of %d", stage, value,
+                     expected);
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+    rcf_rpc_server  *pco_iut = NULL;
+    unsigned int     n_reads;
+    int32_t          old_value;
+    int32_t          new_value;
+    char             cmd[RCF_MAX_VAL];
+    rpc_wait_status  st;
+    double           cached_ns;
+    double           uncached_ns;
+    te_mi_logger    *logger = NULL;
+
+    TEST_START;
+    TEST_GET_PCO(pco_iut);
+    TEST_GET_UINT_PARAM(n_reads);
+
+    TEST_STEP("Enable the cache and read the value twice");
+    cfg_api_cache_enable(true);
+    CHECK_RC(cfg_get_int32(&old_value, API_CACHE_OID, pco_iut->ta));
+    check_value(pco_iut->ta, old_value, "Repeated read");
+
+    TEST_STEP("Change the value via confapi and check that the new value "
+              "is read");
+    new_value = old_value + 1;
+    CHECK_RC(cfg_set_instance_fmt(CFG_VAL(INT32, new_value), API_CACHE_OID,
+                                  pco_iut->ta));
+    check_value(pco_iut->ta, new_value, "Read after set");
+
+    TEST_STEP("Change the value on the Test Agent bypassing the "
+              "Configurator, synchronize the Configurator and check "
+              "that the value changed by the Configurator is read");
+    new_value++;
+    TE_SPRINTF(cmd, "echo %d >/proc/sys/net/core/somaxconn", new_value);
+    st = rpc_system(pco_iut, cmd);
+    if (st.flag != RPC_WAIT_STATUS_EXITED || st.value != 0)
+        TEST_FAIL("Failed to change the value on the Test Agent");
+    CHECK_RC(cfg_synchronize_fmt(false, API_CACHE_OID, pco_iut->ta));
+    check_value(pco_iut->ta, new_value, "Read after synchronization");
+
+    TEST_STEP("Measure time of read with and without the cache");
+    cached_ns = measure_reads(pco_iut->ta, n_reads);
+    cfg_api_cache_enable(false);
+    uncached_ns = measure_reads(pco_iut->ta, n_reads);
+
+    RING("Read takes %.1f ns with the cache and %.1f ns without it",
+         cached_ns, uncached_ns);
+
+    CHECK_RC(te_mi_logger_meas_create(TE_TEST_NAME, &logger));
+    te_mi_logger_add_meas(logger, NULL, TE_MI_MEAS_LATENCY, "cached read",
+                          TE_MI_MEAS_AGGR_MEAN, cached_ns,
+                          TE_MI_MEAS_MULTIPLIER_NANO);
+    te_mi_logger_add_meas(logger, NULL, TE_MI_MEAS_LATENCY, "uncached read",
+                          TE_MI_MEAS_AGGR_MEAN, uncached_ns,
+                          TE_MI_MEAS_MULTIPLIER_NANO);
+
+    TEST_SUCCESS;
+
+cleanup:
+    cfg_api_cache_enable(false);
+    te_mi_logger_destroy(logger);
+
+    TEST_END;
+}
@@ -0,0 +1,185 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/* Copyright (C) 2023 OKTET Labs Ltd. All rights reserved. */
+/** @file
+ * @brief Batched Configurator requests
+ *
+ * Check batches of get/set requests and fetch of a subtree.
+ */
+
+/** @page cs-batch Batched Configurator requests
+ *
+ * @objective Check that batches of get and set requests are processed
+ *            in one request, atomic batches are rolled back on failure
+ *            and a subtree is fetched with all values.
+ *
+ * @param n_insts   number of instances accessed by batches
+ *
+ * @par Scenario:
+ */
+
+#define TE_TEST_NAME "cs/batch"
+
+#include "te_config.h"
+
+#include "tapi_test.h"
+#include "conf_api.h"
+
+/** Format of OIDs of instances accessed by the test */
+#define BATCH_OID_FMT   "/local:/env:batch_%u"
+
+/**
+ * Fill in requests for all instances and a missing one at the end.
+ *
+ * @param reqs          requests (@p n_insts + 1), values of previous
+ *                      requests are released
+ * @param oids          OIDs of instances
+ * @param n_insts       number of instances
+ * @param op            operation
+ * @param prefix        prefix of values to set
+ */
+static void
+fill_reqs(cfg_batch_req *reqs, char (*oids)[CFG_OID_MAX],
+          unsigned int n_insts, cfg_batch_op op, const char *prefix)
+{
+    unsigned int i;
+
+    for (i = 0; i <= n_insts; i++)
+    {
+        free(reqs[i].val.val_str);
+        memset(&reqs[i], 0, sizeof(reqs[i]));
+        reqs[i].op = op;
+        reqs[i].oid = oids[i];
+        reqs[i].type = CVT_STRING;
+        if (op != CFG_BATCH_OP_GET)
+            reqs[i].val.val_str = te_sprintf("%s%u", prefix, i);
+    }
+}
+
+/**
+ * Check values of instances read by separate requests.
+ *
+ * @param n_insts       number of instances
+ * @param prefix        prefix of expected values
+ * @param stage         description of the check for verdict
+ */
+static void
+check_values(unsigned int n_insts, const char *prefix, const char *stage)
+{
+    char        *val;
+    char        *expected;
+    unsigned int i;
+
+    for (i = 0; i < n_insts; i++)
+    {
+        CHECK_RC(cfg_get_string(&val, BATCH_OID_FMT, i));
+        expected = te_sprintf("%s%u", prefix, i);
+        if (strcmp(val, expected) != 0)
+            TEST_VERDICT("%s: unexpected value '%s' of instance", stage, val);
+        free(val);
+        free(expected);
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+    unsigned int      n_insts;
+    char            (*oids)[CFG_OID_MAX] = NULL;
+    cfg_batch_req    *reqs = NULL;
+    cfg_subtree_inst *insts = NULL;
+    unsigned int      num = 0;
+    unsigned int      found;
+    unsigned int      i;
+    unsigned int      j;
+    char             *expected;
+
+    TEST_START;
+    TEST_GET_UINT_PARAM(n_insts);
+
+    oids = TE_ALLOC((n_insts + 1) * sizeof(*oids));
+    reqs = TE_ALLOC((n_insts + 1) * sizeof(*reqs));
+
+    TEST_STEP("Add @p n_insts instances with values by separate requests");
+    for (i = 0; i < n_insts; i++)
+    {
+        TE_SPRINTF(oids[i], BATCH_OID_FMT, i);
+        expected = te_sprintf("init%u", i);
+        CHECK_RC(cfg_add_instance_str(oids[i], NULL,
+                                      CFG_VAL(STRING, expected)));
+        free(expected);
+    }
+    TE_SPRINTF(oids[n_insts], BATCH_OID_FMT, n_insts);
+
+    TEST_STEP("Get values of all instances and a missing one in a batch "
+              "and check them");
+    fill_reqs(reqs, oids, n_insts, CFG_BATCH_OP_GET, NULL);
+    rc = cfg_batch_process(reqs, n_insts + 1, false);
+    if (TE_RC_GET_ERROR(rc) != TE_ENOENT ||
+        TE_RC_GET_ERROR(reqs[n_insts].rc) != TE_ENOENT)
+        TEST_VERDICT("Get of missing instance in a batch did not fail");
+    for (i = 0; i < n_insts; i++)
+    {
+        CHECK_RC(reqs[i].rc);
+        expected = te_sprintf("init%u", i);
+        if (strcmp(reqs[i].val.val_str, expected) != 0)
+            TEST_VERDICT("Batch get returned unexpected value");
+        free(expected);
+        free(reqs[i].val.val_str);
+        reqs[i].val.val_str = NULL;
+    }
+
+    TEST_STEP("Set values of all instances and a missing one in an atomic "
+              "batch and check that values are not changed");
+    fill_reqs(reqs, oids, n_insts, CFG_BATCH_OP_SET, "atomic");
+    rc = cfg_batch_process(reqs, n_insts + 1, true);
+    if (TE_RC_GET_ERROR(rc) != TE_ENOENT)
+        TEST_VERDICT("Atomic batch with missing instance did not fail");
+    check_values(n_insts, "init", "Atomic batch");
+
+    TEST_STEP("Set values of all instances and a missing one in "
+              "a non-atomic batch and check that values are changed");
+    fill_reqs(reqs, oids, n_insts, CFG_BATCH_OP_SET, "set");
+    rc = cfg_batch_process(reqs, n_insts + 1, false);
+    if (TE_RC_GET_ERROR(rc) != TE_ENOENT)
+        TEST_VERDICT("Non-atomic batch with missing instance did not fail");
+    for (i = 0; i < n_insts; i++)
+        CHECK_RC(reqs[i].rc);
+    check_values(n_insts, "set", "Non-atomic batch");
+
+    TEST_STEP("Fetch /local:/env: subtree and check that it contains "
+              "all instances with their values");
+    CHECK_RC(cfg_get_subtree_fmt(&insts, &num, "/local:"));
+    for (i = 0, found = 0; i < n_insts; i++)
+    {
+        expected = te_sprintf("set%u", i);
+        for (j = 0; j < num; j++)
+        {
+            if (strcmp(insts[j].oid, oids[i]) != 0)
+                continue;
+            if (insts[j].type != CVT_STRING ||
+                strcmp(insts[j].val.val_str, expected) != 0)
+                TEST_VERDICT("Subtree contains unexpected value");
+            found++;
+        }
+        free(expected);
+    }
+    if (found != n_insts)
+        TEST_VERDICT("Not all instances are found in the subtree");
+
+    TEST_SUCCESS;
+
+cleanup:
+    cfg_subtree_free(insts, num);
+    for (i = 0; reqs != NULL && i <= n_insts; i++)
+        free(reqs[i].val.val_str);
+    for (i = 0; oids != NULL && i < n_insts && oids[i][0] != '\0'; i++)
+    {
+        rc = cfg_del_instance_fmt(false, "%s", oids[i]);
+        if (TE_RC_GET_ERROR(rc) != TE_ENOENT)
+            CLEANUP_CHECK_RC(rc);
+    }
+    free(reqs);
+    free(oids);
+
+    TEST_END;
+}
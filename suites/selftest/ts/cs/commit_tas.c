@@ -0,0 +1,117 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/* Copyright (C) 2023 OKTET Labs Ltd. All rights reserved. */
+/** @file
+ * @brief Test Environment
+ *
+ * Check commit of local changes to several Test Agents
+ */
+
+/** @page cs-commit_tas Commit of local changes to several Test Agents
+ *
+ * @objective Check that a failure to commit changes on one Test Agent
+ *            is reported and leaves the database consistent with
+ *            all Test Agents.
+ *
+ * @param env       Testing environment with two Test Agents
+ *
+ * @par Scenario:
+ *
+ */
+
+#define TE_TEST_NAME "cs/commit_tas"
+
+#ifndef TEST_START_VARS
+#define TEST_START_VARS TEST_START_ENV_VARS
+#endif
+
+#ifndef TEST_START_SPECIFIC
+#define TEST_START_SPECIFIC TEST_START_ENV
+#endif
+
+#ifndef TEST_END_SPECIFIC
+#define TEST_END_SPECIFIC TEST_END_ENV
+#endif
+
+#include "te_config.h"
+
+#include "tapi_test.h"
+#include "tapi_env.h"
+#include "conf_api.h"
+
+/** Environment variable which may be added on a Test Agent */
+#define COMMIT_TAS_VAR      "TE_COMMIT_TAS"
+/** Environment variable which the Test Agent refuses to add */
+#define COMMIT_TAS_HIDDEN   "BASH_FUNC_te_commit_tas"
+
+/**
+ * Check that the presence of an environment variable in the
+ * Configurator database is not changed by the synchronization with
+ * the Test Agent.
+ *
+ * @param ta        Test Agent name
+ * @param name      Variable name
+ */
+static void
+check_env_consistent(const char *ta, const char *name)
+{
+    cfg_handle handle;
+    bool       in_db;
+    bool       on_ta;
+
+    in_db = (cfg_find_fmt(&handle, "/agent:%s/env:%s", ta, name) == 0);
+    CHECK_RC(cfg_synchronize_fmt(true, "/agent:%s/env:", ta));
+    on_ta = (cfg_find_fmt(&handle, "/agent:%s/env:%s", ta, name) == 0);
+
+    if (in_db != on_ta)
+    {
+        TEST_VERDICT("Variable %s is %s in the database, but %s on TA %s",
+                     name, in_db ? "present" : "absent",
+                     on_ta ? "present" : "absent", ta);
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+    rcf_rpc_server *pco_iut = NULL;
+    rcf_rpc_server *pco_tst = NULL;
+
+    TEST_START;
+
+    TEST_GET_PCO(pco_iut);
+    TEST_GET_PCO(pco_tst);
+
+    TEST_STEP("Add a variable on IUT and a variable which cannot be "
+              "added on tester locally");
+    CHECK_RC(cfg_add_instance_local_fmt(NULL, CFG_VAL(STRING, "iut"),
+                                        "/agent:%s/env:%s",
+                                        pco_iut->ta, COMMIT_TAS_VAR));
+    CHECK_RC(cfg_add_instance_local_fmt(NULL, CFG_VAL(STRING, "tst"),
+                                        "/agent:%s/env:%s",
+                                        pco_tst->ta, COMMIT_TAS_HIDDEN));
+
+    TEST_STEP("Commit the whole database and check that the failure "
+              "on tester is reported");
+    rc = cfg_commit(NULL);
+    if (rc == 0)
+        TEST_VERDICT("Commit unexpectedly succeeded");
+    if (TE_RC_GET_ERROR(rc) != TE_EPERM)
+        TEST_VERDICT("Commit failed with unexpected error %r", rc);
+
+    TEST_STEP("Check that the database is consistent with both agents");
+    check_env_consistent(pco_iut->ta, COMMIT_TAS_VAR);
+    check_env_consistent(pco_tst->ta, COMMIT_TAS_HIDDEN);
+
+    TEST_SUCCESS;
+
+cleanup:
+    if (pco_iut != NULL)
+    {
+        rc = cfg_del_instance_fmt(false, "/agent:%s/env:%s",
+                                  pco_iut->ta, COMMIT_TAS_VAR);
+        if (rc != 0 && TE_RC_GET_ERROR(rc) != TE_ENOENT)
+            CLEANUP_CHECK_RC(rc);
+    }
+
+    TEST_END;
+}
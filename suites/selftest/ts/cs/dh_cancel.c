@@ -0,0 +1,111 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/* Copyright (C) 2023 OKTET Labs Ltd. All rights reserved. */
+/** @file
+ * @brief Cancellation of add/delete pairs in history
+ *
+ * Check that commands adding and deleting the same instance are
+ * removed from the history of commands.
+ */
+
+/** @page cs-dh_cancel Cancellation of add/delete pairs in history
+ *
+ * @objective Check that adding of an instance, changes of it and its
+ *            deletion are removed from the history of commands and
+ *            that the configuration is restored properly after that.
+ *
+ * @par Scenario:
+ */
+
+#define TE_TEST_NAME "cs/dh_cancel"
+
+#include "te_config.h"
+
+#include "te_file.h"
+#include "te_string.h"
+#include "tapi_test.h"
+#include "conf_api.h"
+
+/** Instance which is added and deleted */
+#define DH_CANCEL_OID   "/local:/env:te_dh_cancel"
+/** Instance which is added and kept */
+#define DH_KEEP_OID     "/local:/env:te_dh_keep"
+
+/**
+ * Check whether the instance is mentioned in the history of commands.
+ *
+ * @param history       history dumped to a file
+ * @param oid           instance identifier
+ *
+ * @return @c true if the instance is found.
+ */
+static bool
+history_has(const te_string *history, const char *oid)
+{
+    char *quoted = te_sprintf("\"%s\"", oid);
+    bool  found = strstr(history->ptr, quoted) != NULL;
+
+    free(quoted);
+    return found;
+}
+
+int
+main(int argc, char **argv)
+{
+    char      *backup = NULL;
+    char      *history_file = NULL;
+    te_string  history = TE_STRING_INIT;
+    cfg_handle handle;
+
+    TEST_START;
+
+    TEST_STEP("Create a backup to stop cancellation of the previous "
+              "commands");
+    CHECK_RC(cfg_create_backup(&backup));
+
+    TEST_STEP("Add an instance, change it and delete it");
+    CHECK_RC(cfg_add_instance_fmt(NULL, CFG_VAL(STRING, "1"),
+                                  DH_CANCEL_OID));
+    CHECK_RC(cfg_set_instance_fmt(CFG_VAL(STRING, "2"), DH_CANCEL_OID));
+    CHECK_RC(cfg_del_instance_fmt(false, DH_CANCEL_OID));
+
+    TEST_STEP("Add another instance which is kept");
+    CHECK_RC(cfg_add_instance_fmt(NULL, CFG_VAL(STRING, "keep"),
+                                  DH_KEEP_OID));
+
+    TEST_STEP("Dump the history and check that commands of the deleted "
+              "instance are removed from it");
+    CHECK_NOT_NULL(history_file = te_file_create_unique("/tmp/te_dh_",
+                                                        ".xml"));
+    CHECK_RC(cfg_create_config(history_file, true));
+    CHECK_RC(te_file_read_string(&history, false, 0, "%s", history_file));
+    if (!history_has(&history, DH_KEEP_OID))
+        TEST_VERDICT("History does not contain the kept instance");
+    if (history_has(&history, DH_CANCEL_OID))
+        TEST_VERDICT("History contains the deleted instance");
+
+    TEST_STEP("Restore the backup and check that neither instance "
+              "exists");
+    CHECK_RC(cfg_restore_backup(backup));
+    if (cfg_find_fmt(&handle, DH_CANCEL_OID) == 0)
+        TEST_VERDICT("The deleted instance is restored");
+    if (cfg_find_fmt(&handle, DH_KEEP_OID) == 0)
+        TEST_VERDICT("The kept instance is not removed on restore");
+
+    TEST_SUCCESS;
+
+cleanup:
+    rc = cfg_del_instance_fmt(false, DH_CANCEL_OID);
+    if (TE_RC_GET_ERROR(rc) != TE_ENOENT)
+        CLEANUP_CHECK_RC(rc);
+    rc = cfg_del_instance_fmt(false, DH_KEEP_OID);
+    if (TE_RC_GET_ERROR(rc) != TE_ENOENT)
+        CLEANUP_CHECK_RC(rc);
+    if (backup != NULL)
+        CLEANUP_CHECK_RC(cfg_release_backup(&backup));
+    if (history_file != NULL)
+        unlink(history_file);
+    free(history_file);
+    te_string_free(&history);
+
+    TEST_END;
+}
@@ -0,0 +1,120 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/* Copyright (C) 2023 OKTET Labs Ltd. All rights reserved. */
+/** @file
+ * @brief IPC throughput
+ *
+ * Measure the rate of IPC requests to the Configurator.
+ */
+
+/** @page ipc_throughput IPC throughput
+ *
+ * @objective Measure the rate of IPC round trips between a test and
+ *            the Configurator with socket and shared memory transports.
+ *
+ * @param ta        Test Agent name
+ * @param n_reqs    number of requests to send
+ * @param window    maximum number of requests in flight
+ * @param shm       whether shared memory transport should be offered
+ *
+ * Find requests are used since they are processed by the Configurator
+ * without Test Agents, so the rate is limited by IPC and request
+ * processing in the Configurator only.
+ *
+ * @par Test sequence:
+ */
+
+#define TE_TEST_NAME    "ipc/throughput"
+
+#include "te_config.h"
+
+#include <stdlib.h>
+
+#include "tapi_test.h"
+#include "te_mi_log.h"
+#include "te_time.h"
+#include "conf_api.h"
+
+/**
+ * Collect the oldest completion and check it.
+ *
+ * @param async     context
+ *
+ * @return Status code.
+ */
+static te_errno
+collect(cfg_async *async)
+{
+    cfg_async_compl compl;
+    te_errno        rc;
+
+    rc = cfg_async_wait(async, &compl);
+    return rc != 0 ? rc : compl.rc;
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *ta = NULL;
+    unsigned int n_reqs = 0;
+    unsigned int window = 0;
+    bool shm = false;
+    cfg_async *async = NULL;
+    unsigned int i;
+    uint64_t start;
+    uint64_t elapsed;
+    te_mi_logger *logger = NULL;
+
+    TEST_START;
+    TEST_GET_STRING_PARAM(ta);
+    TEST_GET_UINT_PARAM(n_reqs);
+    TEST_GET_UINT_PARAM(window);
+    TEST_GET_BOOL_PARAM(shm);
+
+    if (n_reqs == 0 || window == 0)
+        TEST_FAIL("Number of requests and window must be positive");
+
+    TEST_STEP("Open a new connection to the Configurator offering "
+              "shared memory transport if @p shm is @c TRUE");
+    if (setenv("TE_IPC_SHM", shm ? "1" : "0", 1) != 0)
+        TEST_FAIL("Failed to set TE_IPC_SHM");
+    CHECK_RC(cfg_async_open(&async));
+    CHECK_RC(cfg_async_find_fmt(async, 0, "/agent:%s", ta));
+    CHECK_RC(collect(async));
+
+    TEST_STEP("Send @p n_reqs find requests keeping up to @p window "
+              "of them in flight");
+    start = te_time_monotonic_ns();
+    for (i = 0; i < n_reqs; i++)
+    {
+        if (cfg_async_pending(async) == window)
+            CHECK_RC(collect(async));
+        CHECK_RC(cfg_async_find_fmt(async, i, "/agent:%s", ta));
+    }
+    while (cfg_async_pending(async) > 0)
+        CHECK_RC(collect(async));
+    elapsed = te_time_monotonic_ns() - start;
+    if (elapsed == 0)
+        elapsed = 1;
+
+    RING("%u requests are processed via %s in %.3f ms", n_reqs,
+         shm ? "shared memory" : "socket", elapsed / 1000000.0);
+
+    TEST_STEP("Log the rate of requests and mean time of a request");
+    CHECK_RC(te_mi_logger_meas_create(TE_TEST_NAME, &logger));
+    te_mi_logger_add_meas(logger, NULL, TE_MI_MEAS_RPS, "IPC requests",
+                          TE_MI_MEAS_AGGR_MEAN,
+                          n_reqs * 1000000000.0 / elapsed,
+                          TE_MI_MEAS_MULTIPLIER_PLAIN);
+    te_mi_logger_add_meas(logger, NULL, TE_MI_MEAS_LATENCY, "IPC requests",
+                          TE_MI_MEAS_AGGR_MEAN, (double)elapsed / n_reqs,
+                          TE_MI_MEAS_MULTIPLIER_NANO);
+
+    TEST_SUCCESS;
+
+cleanup:
+    if (async != NULL)
+        CLEANUP_CHECK_RC(cfg_async_close(async));
+    te_mi_logger_destroy(logger);
+
+    TEST_END;
+}
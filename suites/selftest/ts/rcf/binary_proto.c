@@ -0,0 +1,138 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/* Copyright (C) 2023 OKTET Labs Ltd. All rights reserved. */
+/** @file
+ * @brief RCF binary protocol mode
+ *
+ * Check that configuration commands give the same results in text and
+ * binary modes of the Test Protocol.
+ */
+
+/** @page rcf_binary_proto RCF binary protocol mode
+ *
+ * @objective Check that configuration requests to a Test Agent using
+ *            binary mode of the Test Protocol give the same results as
+ *            requests to a Test Agent using text mode, including values
+ *            which require escaping in text mode, groups of changes and
+ *            error codes.
+ *
+ * @param ta_text   Test Agent using text mode
+ * @param ta_bin    Test Agent with binary mode requested in RCF
+ *                  configuration
+ *
+ * @par Test sequence:
+ */
+
+#define TE_TEST_NAME    "rcf/binary_proto"
+
+#include "te_config.h"
+
+#include "te_string.h"
+#include "tapi_test.h"
+#include "rcf_api.h"
+
+/** Name of the environment variable used by the test */
+#define BINARY_PROTO_VAR    "TE_BINARY_PROTO"
+
+/** Value which requires quoting and escaping in text mode */
+#define BINARY_PROTO_VAL    "a \"quoted\" value with \\ and\ttab"
+
+/**
+ * Check the value of the environment variable on the Test Agent.
+ *
+ * @param ta            Test Agent name
+ * @param oid           instance identifier
+ * @param expected      expected value
+ */
+static void
+check_value(const char *ta, const char *oid, const char *expected)
+{
+    char val[RCF_MAX_VAL];
+
+    CHECK_RC(rcf_ta_cfg_get(ta, 0, oid, val, sizeof(val)));
+    if (strcmp(val, expected) != 0)
+    {
+        ERROR("TA %s: got '%s', expected '%s'", ta, val, expected);
+        TEST_VERDICT("Unexpected value is got from TA %s", ta);
+    }
+}
+
+/**
+ * Run configuration requests on the Test Agent and check results.
+ *
+ * @param ta            Test Agent name
+ * @param long_val      value of maximum length
+ */
+static void
+check_cfg_ops(const char *ta, const char *long_val)
+{
+    char     oid[RCF_MAX_ID];
+    char     val[RCF_MAX_VAL];
+    te_errno rc;
+
+    TE_SPRINTF(oid, "/agent:%s/env:%s", ta, BINARY_PROTO_VAR);
+
+    rc = rcf_ta_cfg_get(ta, 0, oid, val, sizeof(val));
+    if (TE_RC_GET_ERROR(rc) != TE_ENOENT)
+        TEST_VERDICT("TA %s: get of a missing instance returned %r", ta, rc);
+
+    CHECK_RC(rcf_ta_cfg_add(ta, 0, oid, BINARY_PROTO_VAL));
+    check_value(ta, oid, BINARY_PROTO_VAL);
+
+    rc = rcf_ta_cfg_add(ta, 0, oid, "");
+    if (TE_RC_GET_ERROR(rc) != TE_EEXIST)
+        TEST_VERDICT("TA %s: add of an existing instance returned %r",
+                     ta, rc);
+
+    CHECK_RC(rcf_ta_cfg_set(ta, 0, oid, long_val));
+    check_value(ta, oid, long_val);
+
+    CHECK_RC(rcf_ta_cfg_group(ta, 0, true));
+    CHECK_RC(rcf_ta_cfg_set(ta, 0, oid, ""));
+    CHECK_RC(rcf_ta_cfg_group(ta, 0, false));
+    check_value(ta, oid, "");
+
+    CHECK_RC(rcf_ta_cfg_del(ta, 0, oid));
+    rc = rcf_ta_cfg_get(ta, 0, oid, val, sizeof(val));
+    if (TE_RC_GET_ERROR(rc) != TE_ENOENT)
+        TEST_VERDICT("TA %s: get of a deleted instance returned %r", ta, rc);
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *ta_text = NULL;
+    const char *ta_bin = NULL;
+    te_string   long_val = TE_STRING_INIT;
+    char        oid[RCF_MAX_ID];
+
+    TEST_START;
+    TEST_GET_STRING_PARAM(ta_text);
+    TEST_GET_STRING_PARAM(ta_bin);
+
+    while (long_val.len < RCF_MAX_VAL - 1)
+        te_string_append_chk(&long_val, "%c", 'a' + long_val.len % 26);
+
+    TEST_STEP("Check configuration requests to @p ta_text");
+    check_cfg_ops(ta_text, long_val.ptr);
+
+    TEST_STEP("Check that the same requests to @p ta_bin give the same "
+              "results");
+    check_cfg_ops(ta_bin, long_val.ptr);
+
+    TEST_SUCCESS;
+
+cleanup:
+    if (ta_text != NULL)
+    {
+        TE_SPRINTF(oid, "/agent:%s/env:%s", ta_text, BINARY_PROTO_VAR);
+        (void)rcf_ta_cfg_del(ta_text, 0, oid);
+    }
+    if (ta_bin != NULL)
+    {
+        TE_SPRINTF(oid, "/agent:%s/env:%s", ta_bin, BINARY_PROTO_VAR);
+        (void)rcf_ta_cfg_del(ta_bin, 0, oid);
+    }
+    te_string_free(&long_val);
+
+    TEST_END;
+}
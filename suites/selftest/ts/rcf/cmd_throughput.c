@@ -0,0 +1,87 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/* Copyright (C) 2023 OKTET Labs Ltd. All rights reserved. */
+/** @file
+ * @brief RCF command throughput
+ *
+ * Measure the rate of RCF commands sent to a Test Agent.
+ */
+
+/** @page rcf_cmd_throughput RCF command throughput
+ *
+ * @objective Measure the rate of RCF command round trips between
+ *            the Test Engine and a Test Agent.
+ *
+ * @param ta        Test Agent name
+ * @param n_cmds    number of commands to send
+ *
+ * The test is useful to estimate overhead of RCF and communication
+ * libraries when the Test Agent is run on the same host, so commands
+ * and replies go over loopback.
+ *
+ * @par Test sequence:
+ */
+
+#define TE_TEST_NAME    "rcf/cmd_throughput"
+
+#include "te_config.h"
+
+
+#include "tapi_test.h"
+#include "te_mi_log.h"
+#include "te_time.h"
+#include "te_str.h"
+#include "rcf_api.h"
+
+int
+main(int argc, char **argv)
+{
+    const char *ta = NULL;
+    unsigned int n_cmds = 0;
+    unsigned int i;
+    uint64_t start;
+    uint64_t elapsed;
+    te_mi_logger *logger = NULL;
+    char oid[RCF_MAX_ID];
+    char val[RCF_MAX_VAL];
+
+    TEST_START;
+    TEST_GET_STRING_PARAM(ta);
+    TEST_GET_UINT_PARAM(n_cmds);
+
+    if (n_cmds == 0)
+        TEST_FAIL("Number of commands must be positive");
+
+    TEST_STEP("Check that the Test Agent replies to configuration "
+              "requests");
+    TE_SPRINTF(oid, "/agent:%s/uname:", ta);
+    CHECK_RC(rcf_ta_cfg_get(ta, 0, oid, val, sizeof(val)));
+
+    TEST_STEP("Send @p n_cmds configuration get commands one by one "
+              "waiting for replies");
+    start = te_time_monotonic_ns();
+    for (i = 0; i < n_cmds; i++)
+        CHECK_RC(rcf_ta_cfg_get(ta, 0, oid, val, sizeof(val)));
+    elapsed = te_time_monotonic_ns() - start;
+    if (elapsed == 0)
+        elapsed = 1;
+
+    RING("%u commands are processed by %s in %.3f ms", n_cmds, ta,
+         elapsed / 1000000.0);
+
+    TEST_STEP("Log the rate of commands and mean round trip time");
+    CHECK_RC(te_mi_logger_meas_create(TE_TEST_NAME, &logger));
+    te_mi_logger_add_meas(logger, NULL, TE_MI_MEAS_RPS, "RCF commands",
+                          TE_MI_MEAS_AGGR_MEAN,
+                          n_cmds * 1000000000.0 / elapsed,
+                          TE_MI_MEAS_MULTIPLIER_PLAIN);
+    te_mi_logger_add_meas(logger, NULL, TE_MI_MEAS_RTT, "RCF commands",
+                          TE_MI_MEAS_AGGR_MEAN, (double)elapsed / n_cmds,
+                          TE_MI_MEAS_MULTIPLIER_NANO);
+
+    TEST_SUCCESS;
+
+cleanup:
+    te_mi_logger_destroy(logger);
+
+    TEST_END;
+}
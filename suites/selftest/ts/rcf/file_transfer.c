@@ -0,0 +1,186 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/* Copyright (C) 2023 OKTET Labs Ltd. All rights reserved. */
+/** @file
+ * @brief RCF file transfer
+ *
+ * Check transfer of big files to and from a Test Agent.
+ */
+
+/** @page rcf_file_transfer RCF file transfer
+ *
+ * @objective Check that big files are transferred to and from a Test
+ *            Agent correctly and other commands to the Test Agent are
+ *            not blocked until the end of transfer.
+ *
+ * @param ta        Test Agent name
+ * @param size      size of the file in bytes
+ * @param verify    whether checksums should be compared by RCF
+ *
+ * @par Test sequence:
+ */
+
+#define TE_TEST_NAME    "rcf/file_transfer"
+
+#include "te_config.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include "tapi_test.h"
+#include "te_bufs.h"
+#include "te_file.h"
+#include "te_mi_log.h"
+#include "te_time.h"
+#include "te_str.h"
+#include "rcf_api.h"
+
+/** Context of the thread transferring files */
+typedef struct transfer_ctx {
+    const char *ta;         /**< Test Agent name */
+    bool        verify;     /**< Compare checksums */
+    const char *lfile;      /**< Local file to put */
+    const char *rfile;      /**< File on the Test Agent */
+    const char *back;       /**< Local file to get to */
+    uint64_t    put_ns;     /**< Duration of put */
+    uint64_t    get_ns;     /**< Duration of get */
+    te_errno    rc;         /**< Status of transfer */
+    bool        done;       /**< Transfer is finished */
+} transfer_ctx;
+
+/** Put a file to the Test Agent and get it back in own session */
+static void *
+transfer(void *arg)
+{
+    transfer_ctx *ctx = arg;
+    uint64_t start;
+    int sid;
+
+    ctx->rc = rcf_ta_create_session(ctx->ta, &sid);
+    if (ctx->rc == 0)
+    {
+        start = te_time_monotonic_ns();
+        ctx->rc = ctx->verify ?
+            rcf_ta_put_file_verify(ctx->ta, sid, ctx->lfile, ctx->rfile) :
+            rcf_ta_put_file(ctx->ta, sid, ctx->lfile, ctx->rfile);
+        ctx->put_ns = te_time_monotonic_ns() - start;
+    }
+    if (ctx->rc == 0)
+    {
+        start = te_time_monotonic_ns();
+        ctx->rc = ctx->verify ?
+            rcf_ta_get_file_verify(ctx->ta, sid, ctx->rfile, ctx->back) :
+            rcf_ta_get_file(ctx->ta, sid, ctx->rfile, ctx->back);
+        ctx->get_ns = te_time_monotonic_ns() - start;
+    }
+
+    __atomic_store_n(&ctx->done, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *ta = NULL;
+    unsigned int size = 0;
+    bool verify;
+    char *lfile = NULL;
+    char *back = NULL;
+    char *rfile = NULL;
+    uint8_t *data = NULL;
+    te_string sent = TE_STRING_INIT;
+    te_string got = TE_STRING_INIT;
+    transfer_ctx ctx;
+    pthread_t thread;
+    bool started = false;
+    unsigned int n_cmds = 0;
+    uint64_t max_rtt = 0;
+    te_mi_logger *logger = NULL;
+    char oid[RCF_MAX_ID];
+    char val[RCF_MAX_VAL];
+
+    TEST_START;
+    TEST_GET_STRING_PARAM(ta);
+    TEST_GET_UINT_PARAM(size);
+    TEST_GET_BOOL_PARAM(verify);
+
+    TEST_STEP("Create a local file with random contents");
+    CHECK_NOT_NULL(lfile = te_file_create_unique("/tmp/te_rcf_put_", NULL));
+    CHECK_NOT_NULL(back = te_file_create_unique("/tmp/te_rcf_get_", NULL));
+    data = te_make_buf_by_len(size);
+    te_string_append_buf(&sent, (const char *)data, size);
+    CHECK_RC(te_file_write_string(&sent, 0, 0, 0, "%s", lfile));
+    rfile = te_string_fmt("/tmp/te_rcf_file_%d", getpid());
+
+    TEST_STEP("Put the file to @p ta and get it back in a separate "
+              "thread and session");
+    ctx = (transfer_ctx){ .ta = ta, .verify = verify, .lfile = lfile,
+                          .rfile = rfile, .back = back };
+    if (pthread_create(&thread, NULL, transfer, &ctx) != 0)
+        TEST_FAIL("Failed to create transfer thread");
+    started = true;
+
+    TEST_STEP("Send configuration requests in the default session while "
+              "files are transferred and remember the maximum round "
+              "trip time");
+    TE_SPRINTF(oid, "/agent:%s/uname:", ta);
+    while (!__atomic_load_n(&ctx.done, __ATOMIC_ACQUIRE))
+    {
+        uint64_t start = te_time_monotonic_ns();
+        uint64_t rtt;
+
+        CHECK_RC(rcf_ta_cfg_get(ta, 0, oid, val, sizeof(val)));
+        rtt = te_time_monotonic_ns() - start;
+        if (rtt > max_rtt)
+            max_rtt = rtt;
+        n_cmds++;
+    }
+    pthread_join(thread, NULL);
+    started = false;
+    CHECK_RC(ctx.rc);
+
+    RING("%u bytes are put in %.3f ms and got in %.3f ms, %u commands are "
+         "processed meanwhile with maximum round trip time %.3f ms",
+         size, ctx.put_ns / 1000000.0, ctx.get_ns / 1000000.0, n_cmds,
+         max_rtt / 1000000.0);
+
+    TEST_STEP("Check that the received file is the same as the sent one");
+    CHECK_RC(te_file_read_string(&got, true, 0, "%s", back));
+    if (!te_compare_bufs(data, size, 1, got.ptr, got.len, TE_LL_ERROR))
+        TEST_VERDICT("The received file differs from the sent one");
+
+    TEST_STEP("Log throughput of transfer and maximum round trip time "
+              "of concurrent commands");
+    CHECK_RC(te_mi_logger_meas_create(TE_TEST_NAME, &logger));
+    te_mi_logger_add_meas(logger, NULL, TE_MI_MEAS_THROUGHPUT, "put",
+                          TE_MI_MEAS_AGGR_SINGLE,
+                          size * 8 * 1000000000.0 / MAX(ctx.put_ns, 1),
+                          TE_MI_MEAS_MULTIPLIER_PLAIN);
+    te_mi_logger_add_meas(logger, NULL, TE_MI_MEAS_THROUGHPUT, "get",
+                          TE_MI_MEAS_AGGR_SINGLE,
+                          size * 8 * 1000000000.0 / MAX(ctx.get_ns, 1),
+                          TE_MI_MEAS_MULTIPLIER_PLAIN);
+    te_mi_logger_add_meas(logger, NULL, TE_MI_MEAS_RTT, "RCF commands",
+                          TE_MI_MEAS_AGGR_MAX, (double)max_rtt,
+                          TE_MI_MEAS_MULTIPLIER_NANO);
+
+    TEST_SUCCESS;
+
+cleanup:
+    if (started)
+        pthread_join(thread, NULL);
+    if (rfile != NULL)
+        rcf_ta_del_file(ta, 0, rfile);
+    if (lfile != NULL)
+        unlink(lfile);
+    if (back != NULL)
+        unlink(back);
+    te_mi_logger_destroy(logger);
+    te_string_free(&sent);
+    te_string_free(&got);
+    free(data);
+    free(lfile);
+    free(back);
+    free(rfile);
+
+    TEST_END;
+}
@@ -0,0 +1,139 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/* Copyright (C) 2023 OKTET Labs Ltd. All rights reserved. */
+/** @file
+ * @brief RCF latency statistics of requests
+ *
+ * Check that RCF accounts requests in latency statistics.
+ */
+
+/** @page rcf_op_stats RCF latency statistics of requests
+ *
+ * @objective Check that requests to a Test Agent are accounted in
+ *            latency statistics of RCF and statistics are reset
+ *            on request.
+ *
+ * @param ta        Test Agent name
+ * @param n_cmds    number of configuration requests
+ *
+ * @par Test sequence:
+ */
+
+#define TE_TEST_NAME    "rcf/op_stats"
+
+#include "te_config.h"
+
+#include "tapi_test.h"
+#include "rcf_api.h"
+
+/**
+ * Find statistics entry.
+ *
+ * @param stats         array of statistics
+ * @param num           number of entries
+ * @param ta            Test Agent name
+ * @param op            operation name
+ *
+ * @return Statistics entry or @c NULL.
+ */
+static const rcf_op_stats *
+op_stats_find(const rcf_op_stats *stats, unsigned int num, const char *ta,
+              const char *op)
+{
+    unsigned int i;
+
+    for (i = 0; i < num; i++)
+    {
+        if (strcmp(stats[i].ta, ta) == 0 && strcmp(stats[i].op, op) == 0)
+            return &stats[i];
+    }
+
+    return NULL;
+}
+
+/**
+ * Check that statistics of a stage are consistent.
+ *
+ * @param hist          statistics of a stage
+ *
+ * @return @c true if statistics are consistent.
+ */
+static bool
+op_hist_valid(const rcf_op_hist *hist)
+{
+    uint64_t     count = 0;
+    unsigned int i;
+
+    for (i = 0; i < RCF_OP_STATS_BUCKETS; i++)
+        count += hist->hist[i];
+
+    return count == hist->count &&
+           (hist->count == 0 ||
+            (hist->min_ns <= hist->max_ns && hist->sum_ns >= hist->max_ns));
+}
+
+int
+main(int argc, char **argv)
+{
+    const char         *ta = NULL;
+    unsigned int        n_cmds;
+    rcf_op_stats       *stats = NULL;
+    unsigned int        num = 0;
+    const rcf_op_stats *entry;
+    char                oid[RCF_MAX_ID];
+    char                val[RCF_MAX_VAL];
+    unsigned int        i;
+
+    TEST_START;
+    TEST_GET_STRING_PARAM(ta);
+    TEST_GET_UINT_PARAM(n_cmds);
+
+    TEST_STEP("Reset statistics collected so far");
+    CHECK_RC(rcf_get_op_stats(&stats, &num, true));
+    free(stats);
+    stats = NULL;
+
+    TEST_STEP("Send @p n_cmds configuration requests to @p ta");
+    TE_SPRINTF(oid, "/agent:%s/uname:", ta);
+    for (i = 0; i < n_cmds; i++)
+        CHECK_RC(rcf_ta_cfg_get(ta, 0, oid, val, sizeof(val)));
+
+    TEST_STEP("Check that the requests are accounted in all stages and "
+              "statistics are consistent");
+    CHECK_RC(rcf_get_op_stats(&stats, &num, false));
+    entry = op_stats_find(stats, num, ta, "configure get");
+    if (entry == NULL)
+        TEST_VERDICT("Configuration requests are not accounted");
+    if (entry->queue.count < n_cmds || entry->wire.count < n_cmds)
+        TEST_VERDICT("Not all configuration requests are accounted");
+    if (entry->agent.count == 0)
+        WARN("Test Agent does not report execution time of commands");
+    if (!op_hist_valid(&entry->queue) || !op_hist_valid(&entry->wire) ||
+        !op_hist_valid(&entry->agent))
+        TEST_VERDICT("Statistics are inconsistent");
+
+    RING("%llu requests: mean queue time %.1f us, mean wire time %.1f us, "
+         "mean agent time %.1f us",
+         (unsigned long long)entry->wire.count,
+         entry->queue.sum_ns / 1000.0 / entry->queue.count,
+         entry->wire.sum_ns / 1000.0 / entry->wire.count,
+         entry->agent.count == 0 ? 0.0 :
+         entry->agent.sum_ns / 1000.0 / entry->agent.count);
+
+    TEST_STEP("Log statistics as MI artifact and reset them");
+    CHECK_RC(rcf_log_op_stats(true));
+
+    TEST_STEP("Check that statistics are reset");
+    free(stats);
+    stats = NULL;
+    CHECK_RC(rcf_get_op_stats(&stats, &num, false));
+    entry = op_stats_find(stats, num, ta, "configure get");
+    if (entry != NULL && entry->queue.count >= n_cmds)
+        TEST_VERDICT("Statistics are not reset");
+
+    TEST_SUCCESS;
+
+cleanup:
+    free(stats);
+
+    TEST_END;
+}
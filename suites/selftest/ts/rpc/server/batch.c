@@ -0,0 +1,167 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/** @file
+ * @brief Test Environment
+ *
+ * Batch of RPC calls executed in one request.
+ *
+ * Copyright (C) 2023 OKTET Labs Ltd. All rights reserved.
+ */
+
+/** @page server_batch Batch of RPC calls executed in one request
+ *
+ * @objective Check that a batch of RPC calls is executed on RPC server
+ *            in one request, results of earlier calls are substituted
+ *            to arguments of later ones and the batch is stopped at
+ *            the first failed call if requested.
+ *
+ * @param pco_iut   RPC server on IUT
+ * @param n_socks   number of sockets created and closed
+ *
+ * @par Test sequence:
+ */
+
+#define TE_TEST_NAME    "batch"
+
+#include "rpc_suite.h"
+
+#include "te_mi_log.h"
+#include "te_time.h"
+#include "tapi_rpc_socket.h"
+#include "tapi_rpc_unistd.h"
+
+int
+main(int argc, char **argv)
+{
+    rcf_rpc_server     *pco_iut = NULL;
+    unsigned int        n_socks;
+    rcf_rpc_batch      *batch = NULL;
+    tarpc_socket_in    *socket_in = NULL;
+    tarpc_socket_out   *socket_out = NULL;
+    tarpc_close_in     *close_in = NULL;
+    tarpc_close_out    *close_out = NULL;
+    tarpc_write_in      write_in;
+    tarpc_write_out     write_out;
+    unsigned int        n_done;
+    uint64_t            start;
+    uint64_t            batch_ns;
+    uint64_t            single_ns;
+    unsigned int        i;
+    int                 fd;
+    te_mi_logger       *logger = NULL;
+
+    TEST_START;
+    TEST_GET_PCO(pco_iut);
+    TEST_GET_UINT_PARAM(n_socks);
+
+    socket_in = TE_ALLOC(n_socks * sizeof(*socket_in));
+    socket_out = TE_ALLOC(n_socks * sizeof(*socket_out));
+    close_in = TE_ALLOC(n_socks * sizeof(*close_in));
+    close_out = TE_ALLOC(n_socks * sizeof(*close_out));
+
+    TEST_STEP("Create a batch of @p n_socks pairs of socket() and "
+              "close() of the socket returned by it");
+    batch = rcf_rpc_batch_create(true);
+    for (i = 0; i < n_socks; i++)
+    {
+        socket_in[i].domain = RPC_PF_INET;
+        socket_in[i].type = RPC_SOCK_DGRAM;
+        socket_in[i].proto = RPC_PROTO_DEF;
+        CHECK_RC(rcf_rpc_batch_add(batch, "socket", &socket_in[i],
+                                   &socket_out[i]));
+        CHECK_RC(rcf_rpc_batch_add(batch, "close", &close_in[i],
+                                   &close_out[i]));
+        CHECK_RC(rcf_rpc_batch_subst(batch, 2 * i, &close_in[i].fd));
+    }
+
+    TEST_STEP("Run the batch on @p pco_iut and check that all calls "
+              "succeeded");
+    start = te_time_monotonic_ns();
+    rcf_rpc_batch_run(pco_iut, batch, &n_done);
+    batch_ns = te_time_monotonic_ns() - start;
+    if (RPC_ERRNO(pco_iut) != 0)
+    {
+        TEST_VERDICT("Batch failed: " RPC_ERROR_FMT,
+                     RPC_ERROR_ARGS(pco_iut));
+    }
+    if (n_done != 2 * n_socks)
+        TEST_VERDICT("Not all calls of the batch are executed");
+    for (i = 0; i < n_socks; i++)
+    {
+        if (socket_out[i].fd < 0)
+            TEST_VERDICT("socket() in the batch failed");
+        if (close_out[i].retval != 0)
+            TEST_VERDICT("close() of the socket in the batch failed");
+    }
+
+    TEST_STEP("Create and close the same sockets by separate calls");
+    start = te_time_monotonic_ns();
+    for (i = 0; i < n_socks; i++)
+    {
+        fd = rpc_socket(pco_iut, RPC_PF_INET, RPC_SOCK_DGRAM,
+                        RPC_PROTO_DEF);
+        rpc_close(pco_iut, fd);
+    }
+    single_ns = te_time_monotonic_ns() - start;
+
+    RING("%u sockets are created and closed in %.3f ms by the batch and "
+         "in %.3f ms by separate calls", n_socks, batch_ns / 1000000.0,
+         single_ns / 1000000.0);
+
+    TEST_STEP("Check that the batch is stopped at the first failed call");
+    rcf_rpc_batch_free(batch);
+    batch = rcf_rpc_batch_create(true);
+    close_in[0].fd = -1;
+    CHECK_RC(rcf_rpc_batch_add(batch, "close", &close_in[0],
+                               &close_out[0]));
+    CHECK_RC(rcf_rpc_batch_add(batch, "socket", &socket_in[0],
+                               &socket_out[0]));
+    rcf_rpc_batch_run(pco_iut, batch, &n_done);
+    if (RPC_ERRNO(pco_iut) != 0)
+    {
+        TEST_VERDICT("Batch with failed call failed: " RPC_ERROR_FMT,
+                     RPC_ERROR_ARGS(pco_iut));
+    }
+    if (n_done != 1)
+        TEST_VERDICT("Batch is not stopped at the failed call");
+    if (close_out[0].retval != -1 ||
+        close_out[0].common._errno != RPC_EBADF)
+        TEST_VERDICT("close(-1) in the batch did not fail with EBADF");
+
+    TEST_STEP("Check that RPC without integer return value cannot be "
+              "added to the batch stopped on error and its result "
+              "cannot be substituted");
+    memset(&write_in, 0, sizeof(write_in));
+    memset(&write_out, 0, sizeof(write_out));
+    rc = rcf_rpc_batch_add(batch, "write", &write_in, &write_out);
+    if (TE_RC_GET_ERROR(rc) != TE_EINVAL)
+        TEST_VERDICT("write() is added to the batch stopped on error");
+    rcf_rpc_batch_free(batch);
+    batch = rcf_rpc_batch_create(false);
+    CHECK_RC(rcf_rpc_batch_add(batch, "write", &write_in, &write_out));
+    CHECK_RC(rcf_rpc_batch_add(batch, "close", &close_in[0],
+                               &close_out[0]));
+    rc = rcf_rpc_batch_subst(batch, 0, &close_in[0].fd);
+    if (TE_RC_GET_ERROR(rc) != TE_EINVAL)
+        TEST_VERDICT("Result of write() is substituted in the batch");
+
+    TEST_STEP("Log durations of the batch and separate calls");
+    CHECK_RC(te_mi_logger_meas_create(TE_TEST_NAME, &logger));
+    te_mi_logger_add_meas(logger, NULL, TE_MI_MEAS_LATENCY, "batch",
+                          TE_MI_MEAS_AGGR_SINGLE, (double)batch_ns,
+                          TE_MI_MEAS_MULTIPLIER_NANO);
+    te_mi_logger_add_meas(logger, NULL, TE_MI_MEAS_LATENCY, "separate calls",
+                          TE_MI_MEAS_AGGR_SINGLE, (double)single_ns,
+                          TE_MI_MEAS_MULTIPLIER_NANO);
+
+    TEST_SUCCESS;
+
+cleanup:
+    te_mi_logger_destroy(logger);
+    rcf_rpc_batch_free(batch);
+    free(socket_in);
+    free(socket_out);
+    free(close_in);
+    free(close_out);
+
+    TEST_END;
+}
@@ -0,0 +1,114 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/** @file
+ * @brief Test Environment
+ *
+ * RPC calls via direct connection to Test Agent.
+ *
+ * Copyright (C) 2023 OKTET Labs Ltd. All rights reserved.
+ */
+
+/** @page server_direct RPC calls via direct connection to Test Agent
+ *
+ * @objective Check that RPC calls made via direct connection to Test
+ *            Agent give the same results as calls made via RCF and
+ *            compare their latency.
+ *
+ * @param pco_iut   RPC server on IUT
+ * @param n_calls   number of RPC calls to measure
+ *
+ * @par Test sequence:
+ */
+
+#define TE_TEST_NAME    "direct"
+
+#include "rpc_suite.h"
+
+#include "te_mi_log.h"
+#include "te_time.h"
+#include "tapi_rpc_unistd.h"
+
+/**
+ * Call getpid() @p n_calls times and check the result.
+ *
+ * @param rpcs      RPC server
+ * @param pid       expected process ID
+ * @param n_calls   number of calls
+ *
+ * @return Mean duration of the call in nanoseconds.
+ */
+static double
+measure(rcf_rpc_server *rpcs, pid_t pid, unsigned int n_calls)
+{
+    uint64_t     start = te_time_monotonic_ns();
+    unsigned int i;
+
+    for (i = 0; i < n_calls; i++)
+    {
+        if (rpc_getpid(rpcs) != pid)
+            TEST_VERDICT("getpid() returned unexpected process ID");
+    }
+
+    return (double)(te_time_monotonic_ns() - start) / MAX(n_calls, 1);
+}
+
+int
+main(int argc, char **argv)
+{
+    rcf_rpc_server *pco_iut = NULL;
+    unsigned int    n_calls;
+    pid_t           pid;
+    double          rcf_ns;
+    double          direct_ns;
+    te_mi_logger   *logger = NULL;
+
+    TEST_START;
+    TEST_GET_PCO(pco_iut);
+    TEST_GET_UINT_PARAM(n_calls);
+
+    TEST_STEP("Measure latency of getpid() called via RCF");
+    pid = rpc_getpid(pco_iut);
+    rcf_ns = measure(pco_iut, pid, n_calls);
+
+    TEST_STEP("Open direct connection to the Test Agent of @p pco_iut");
+    CHECK_RC(rcf_rpc_server_direct_open(pco_iut));
+
+    TEST_STEP("Measure latency of getpid() called via direct connection "
+              "and check that it returns the same process ID");
+    direct_ns = measure(pco_iut, pid, n_calls);
+    if (pco_iut->direct < 0)
+        TEST_VERDICT("Direct connection is closed unexpectedly");
+
+    TEST_STEP("Check that failed call is reported via direct connection");
+    RPC_AWAIT_ERROR(pco_iut);
+    if (rpc_close(pco_iut, -1) != -1 ||
+        RPC_ERRNO(pco_iut) != RPC_EBADF)
+    {
+        TEST_VERDICT("close(-1) via direct connection returned unexpected "
+                     "result");
+    }
+
+    TEST_STEP("Close direct connection and check that calls go via RCF");
+    rcf_rpc_server_direct_close(pco_iut);
+    if (rpc_getpid(pco_iut) != pid)
+        TEST_VERDICT("getpid() returned unexpected process ID");
+
+    RING("%u calls of getpid(): %.1f us via RCF, %.1f us via direct "
+         "connection", n_calls, rcf_ns / 1000, direct_ns / 1000);
+
+    TEST_STEP("Log latency of RPC calls");
+    CHECK_RC(te_mi_logger_meas_create(TE_TEST_NAME, &logger));
+    te_mi_logger_add_meas(logger, NULL, TE_MI_MEAS_LATENCY, "RCF",
+                          TE_MI_MEAS_AGGR_MEAN, rcf_ns,
+                          TE_MI_MEAS_MULTIPLIER_NANO);
+    te_mi_logger_add_meas(logger, NULL, TE_MI_MEAS_LATENCY, "direct",
+                          TE_MI_MEAS_AGGR_MEAN, direct_ns,
+                          TE_MI_MEAS_MULTIPLIER_NANO);
+
+    TEST_SUCCESS;
+
+cleanup:
+    rcf_rpc_server_direct_close(pco_iut);
+    te_mi_logger_destroy(logger);
+
+    TEST_END;
+}
@@ -0,0 +1,112 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/** @file
+ * @brief Test Environment
+ *
+ * Many RPC calls in progress on one RPC server.
+ *
+ * Copyright (C) 2023 OKTET Labs Ltd. All rights reserved.
+ */
+
+/** @page server_jobs Many RPC calls in progress on one RPC server
+ *
+ * @objective Check that many RPC calls made as jobs are executed on one
+ *            RPC server at the same time and may be waited in any order.
+ *
+ * @param pco_iut   RPC server on IUT
+ * @param n_jobs    number of jobs
+ * @param delay     duration of each job in milliseconds
+ *
+ * @par Test sequence:
+ */
+
+#define TE_TEST_NAME    "jobs"
+
+#include "rpc_suite.h"
+
+#include "te_mi_log.h"
+#include "te_time.h"
+#include "tapi_rpc_unistd.h"
+
+int
+main(int argc, char **argv)
+{
+    rcf_rpc_server  *pco_iut = NULL;
+    unsigned int     n_jobs;
+    unsigned int     delay;
+    rcf_rpc_job     *jobs = NULL;
+    tarpc_poll_in    in;
+    tarpc_poll_out   out;
+    pid_t            pid;
+    bool             done;
+    uint64_t         start;
+    uint64_t         elapsed;
+    unsigned int     i;
+    te_mi_logger    *logger = NULL;
+
+    TEST_START;
+    TEST_GET_PCO(pco_iut);
+    TEST_GET_UINT_PARAM(n_jobs);
+    TEST_GET_UINT_PARAM(delay);
+
+    jobs = TE_ALLOC(n_jobs * sizeof(*jobs));
+    pid = rpc_getpid(pco_iut);
+
+    TEST_STEP("Start @p n_jobs jobs calling poll() without file "
+              "descriptors for @p delay milliseconds on @p pco_iut");
+    start = te_time_monotonic_ns();
+    for (i = 0; i < n_jobs; i++)
+    {
+        memset(&in, 0, sizeof(in));
+        in.timeout = delay;
+        rcf_rpc_job_call(pco_iut, "poll", &in, &jobs[i]);
+        if (RPC_ERRNO(pco_iut) != 0)
+        {
+            TEST_VERDICT("Failed to start job: " RPC_ERROR_FMT,
+                         RPC_ERROR_ARGS(pco_iut));
+        }
+    }
+
+    TEST_STEP("Check that the first job is not done yet and ordinary "
+              "RPC calls are made while jobs are in progress");
+    CHECK_RC(rcf_rpc_job_is_done(pco_iut, &jobs[0], &done));
+    if (done)
+        WARN("The first job is done before all jobs are started");
+    if (rpc_getpid(pco_iut) != pid)
+        TEST_VERDICT("getpid() returned unexpected process ID");
+
+    TEST_STEP("Wait for the jobs in reverse order and check results");
+    for (i = n_jobs; i-- > 0; )
+    {
+        memset(&out, 0, sizeof(out));
+        pco_iut->timeout = delay + pco_iut->def_timeout;
+        rcf_rpc_job_wait(pco_iut, &jobs[i], &out);
+        if (RPC_ERRNO(pco_iut) != 0 || out.retval != 0)
+        {
+            TEST_VERDICT("Job poll() failed: " RPC_ERROR_FMT,
+                         RPC_ERROR_ARGS(pco_iut));
+        }
+        rcf_rpc_free_result(&out, (xdrproc_t)xdr_tarpc_poll_out);
+    }
+    elapsed = te_time_monotonic_ns() - start;
+
+    RING("%u jobs of %u ms are done in %.3f ms", n_jobs, delay,
+         elapsed / 1000000.0);
+
+    TEST_STEP("Check that the jobs are executed at the same time");
+    if (n_jobs > 1 && elapsed >= (uint64_t)n_jobs * delay * 1000000)
+        TEST_VERDICT("Jobs are executed one after another");
+
+    TEST_STEP("Log total duration of the jobs");
+    CHECK_RC(te_mi_logger_meas_create(TE_TEST_NAME, &logger));
+    te_mi_logger_add_meas(logger, NULL, TE_MI_MEAS_LATENCY, "jobs",
+                          TE_MI_MEAS_AGGR_SINGLE, (double)elapsed,
+                          TE_MI_MEAS_MULTIPLIER_NANO);
+
+    TEST_SUCCESS;
+
+cleanup:
+    te_mi_logger_destroy(logger);
+    free(jobs);
+
+    TEST_END;
+}
@@ -0,0 +1,129 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/* Copyright (C) 2023 OKTET Labs Ltd. All rights reserved. */
+/** @file
+ * @brief Lookup of RPC functions
+ *
+ * Check and measure lookup of RPC functions by name.
+ */
+
+/** @page xdr_find_info Lookup of RPC functions
+ *
+ * @objective Check that rpc_find_info() finds every RPC function
+ *            and measure the time of lookup.
+ *
+ * @param n_iters   number of times all RPC functions are looked up
+ *
+ * Time of lookup is compared with linear scan of the table which was
+ * used before the table was sorted.
+ *
+ * @par Test sequence:
+ */
+
+#define TE_TEST_NAME    "xdr/find_info"
+
+#include "te_config.h"
+
+
+#include "tapi_test.h"
+#include "te_mi_log.h"
+#include "te_time.h"
+#include "rpc_xdr.h"
+
+/** Find RPC function by linear scan of the table */
+static rpc_info *
+find_info_linear(const char *name)
+{
+    unsigned int i;
+
+    for (i = 0; tarpc_functions[i].name != NULL; i++)
+    {
+        if (strcmp(name, tarpc_functions[i].name) == 0)
+            return tarpc_functions + i;
+    }
+
+    return NULL;
+}
+
+/**
+ * Look up all RPC functions @p n_iters times.
+ *
+ * @param find          lookup function
+ * @param n_iters       number of iterations
+ *
+ * @return Mean time of lookup in nanoseconds.
+ */
+static double
+measure(rpc_info *(*find)(const char *), unsigned int n_iters)
+{
+    uint64_t     start = te_time_monotonic_ns();
+    unsigned int found = 0;
+    unsigned int i;
+    unsigned int j;
+
+    for (i = 0; i < n_iters; i++)
+    {
+        for (j = 0; j < tarpc_functions_num; j++)
+            found += find(tarpc_functions[j].name) != NULL;
+    }
+
+    if (found != n_iters * tarpc_functions_num)
+        TEST_FAIL("Not all RPC functions are found");
+
+    return (double)(te_time_monotonic_ns() - start) / MAX(found, 1);
+}
+
+int
+main(int argc, char **argv)
+{
+    unsigned int  n_iters;
+    unsigned int  i;
+    double        sorted_ns;
+    double        linear_ns;
+    te_mi_logger *logger = NULL;
+
+    TEST_START;
+    TEST_GET_UINT_PARAM(n_iters);
+
+    TEST_STEP("Check that the table of RPC functions is sorted and "
+              "every function is found by its name");
+    if (tarpc_functions[tarpc_functions_num].name != NULL)
+        TEST_FAIL("Number of RPC functions does not match the table");
+    for (i = 0; i < tarpc_functions_num; i++)
+    {
+        if (i > 0 && strcmp(tarpc_functions[i - 1].name,
+                            tarpc_functions[i].name) >= 0)
+        {
+            TEST_VERDICT("RPC functions table is not sorted");
+        }
+        if (rpc_find_info(tarpc_functions[i].name) != tarpc_functions + i)
+            TEST_VERDICT("RPC function '%s' is not found",
+                         tarpc_functions[i].name);
+    }
+
+    TEST_STEP("Check that unknown function is not found");
+    if (rpc_find_info("no_such_rpc") != NULL || rpc_find_info("") != NULL)
+        TEST_VERDICT("Unknown RPC function is found");
+
+    TEST_STEP("Measure time of lookup by rpc_find_info() and by linear "
+              "scan of the table");
+    sorted_ns = measure(rpc_find_info, n_iters);
+    linear_ns = measure(find_info_linear, n_iters);
+
+    RING("%u RPC functions: lookup takes %.1f ns, linear scan %.1f ns",
+         tarpc_functions_num, sorted_ns, linear_ns);
+
+    CHECK_RC(te_mi_logger_meas_create(TE_TEST_NAME, &logger));
+    te_mi_logger_add_meas(logger, NULL, TE_MI_MEAS_LATENCY,
+                          "rpc_find_info", TE_MI_MEAS_AGGR_MEAN,
+                          sorted_ns, TE_MI_MEAS_MULTIPLIER_NANO);
+    te_mi_logger_add_meas(logger, NULL, TE_MI_MEAS_LATENCY,
+                          "linear scan", TE_MI_MEAS_AGGR_MEAN,
+                          linear_ns, TE_MI_MEAS_MULTIPLIER_NANO);
+
+    TEST_SUCCESS;
+
+cleanup:
+    te_mi_logger_destroy(logger);
+
+    TEST_END;
+}
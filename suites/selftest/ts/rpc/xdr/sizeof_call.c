@@ -0,0 +1,124 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/* Copyright (C) 2023 OKTET Labs Ltd. All rights reserved. */
+/** @file
+ * @brief Length of encoded RPC calls
+ *
+ * Check computation of length of encoded RPC calls.
+ */
+
+/** @page xdr_sizeof_call Length of encoded RPC calls
+ *
+ * @objective Check that rpc_xdr_sizeof_call() returns exactly the length
+ *            of RPC call encoded by rpc_xdr_encode_call(), so that calls
+ *            are encoded once into a buffer of this length.
+ *
+ * @param max_len   maximum length of data passed in the call
+ * @param n_iters   number of times the call is encoded for measurement
+ *
+ * @par Test sequence:
+ */
+
+#define TE_TEST_NAME    "xdr/sizeof_call"
+
+#include "te_config.h"
+
+
+#include "tapi_test.h"
+#include "te_mi_log.h"
+#include "te_time.h"
+#include "rpc_xdr.h"
+
+int
+main(int argc, char **argv)
+{
+    unsigned int    max_len;
+    unsigned int    n_iters;
+    tarpc_write_in  in;
+    uint8_t        *data = NULL;
+    uint8_t        *buf = NULL;
+    size_t          size;
+    size_t          len;
+    unsigned int    data_len;
+    unsigned int    i;
+    uint64_t        start;
+    double          sizeof_ns;
+    double          encode_ns;
+    te_mi_logger   *logger = NULL;
+
+    TEST_START;
+    TEST_GET_UINT_PARAM(max_len);
+    TEST_GET_UINT_PARAM(n_iters);
+
+    data = TE_ALLOC(max_len);
+    memset(&in, 0, sizeof(in));
+    in.buf.buf_val = data;
+
+    TEST_STEP("Check that unknown RPC is reported");
+    if (TE_RC_GET_ERROR(rpc_xdr_sizeof_call("no_such_rpc", &in,
+                                            &size)) != TE_ENOENT)
+        TEST_VERDICT("Length of unknown RPC call is computed");
+
+    TEST_STEP("Check that write() calls with data of lengths up to "
+              "@p max_len are encoded exactly in the computed length");
+    for (data_len = 0; data_len <= max_len;
+         data_len = data_len < 8 ? data_len + 1 : data_len * 2 + 1)
+    {
+        in.buf.buf_len = data_len;
+        in.len = data_len;
+
+        CHECK_RC(rpc_xdr_sizeof_call("write", &in, &size));
+        TE_REALLOC(buf, size);
+
+        len = size - 1;
+        if (rpc_xdr_encode_call("write", buf, &len, &in) == 0)
+            TEST_VERDICT("Call is encoded in less than computed length");
+
+        len = size;
+        CHECK_RC(rpc_xdr_encode_call("write", buf, &len, &in));
+        if (len != size)
+        {
+            TEST_VERDICT("Length of encoded call differs from the "
+                         "computed one");
+        }
+    }
+
+    TEST_STEP("Measure time of computation of the length and of "
+              "encoding of the call with @p max_len bytes of data");
+    in.buf.buf_len = max_len;
+    in.len = max_len;
+    CHECK_RC(rpc_xdr_sizeof_call("write", &in, &size));
+    TE_REALLOC(buf, size);
+
+    start = te_time_monotonic_ns();
+    for (i = 0; i < n_iters; i++)
+        CHECK_RC(rpc_xdr_sizeof_call("write", &in, &len));
+    sizeof_ns = (double)(te_time_monotonic_ns() - start) / MAX(n_iters, 1);
+
+    start = te_time_monotonic_ns();
+    for (i = 0; i < n_iters; i++)
+    {
+        len = size;
+        CHECK_RC(rpc_xdr_encode_call("write", buf, &len, &in));
+    }
+    encode_ns = (double)(te_time_monotonic_ns() - start) / MAX(n_iters, 1);
+
+    RING("Call with %u bytes of data: computation of length takes %.1f ns, "
+         "encoding %.1f ns", max_len, sizeof_ns, encode_ns);
+
+    CHECK_RC(te_mi_logger_meas_create(TE_TEST_NAME, &logger));
+    te_mi_logger_add_meas(logger, NULL, TE_MI_MEAS_LATENCY,
+                          "rpc_xdr_sizeof_call", TE_MI_MEAS_AGGR_MEAN,
+                          sizeof_ns, TE_MI_MEAS_MULTIPLIER_NANO);
+    te_mi_logger_add_meas(logger, NULL, TE_MI_MEAS_LATENCY,
+                          "rpc_xdr_encode_call", TE_MI_MEAS_AGGR_MEAN,
+                          encode_ns, TE_MI_MEAS_MULTIPLIER_NANO);
+
+    TEST_SUCCESS;
+
+cleanup:
+    te_mi_logger_destroy(logger);
+    free(data);
+    free(buf);
+
+    TEST_END;
+}